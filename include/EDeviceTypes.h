@@ -56,7 +56,15 @@ namespace irr
 		to your operating system. If this is unavailable then the X11, SDL and then console device
 		will be tried. This ensures that Irrlicht will run even if your platform is unsupported,
 		although it may not be able to render anything. */
-		EIDT_BEST
+		EIDT_BEST,
+
+		//! A device without window which renders into memory
+		/** Needs no windowing system, so it can be used for rendering on servers.
+		The frames presented by the software drivers are passed to
+		SIrrlichtCreationParameters::FrameReceiver and/or streamed to
+		SIrrlichtCreationParameters::FrameStreamFile. It has no input and is never
+		selected by EIDT_BEST. */
+		EIDT_OFFSCREEN
 	};
 
 } // end namespace irr
@@ -70,6 +70,19 @@ namespace scene
 		//! Get name of md2 animation.
 		/** \param nr: Zero based index of animation. */
 		virtual const c8* getAnimationName(s32 nr) const = 0;
+
+		//! Set how many interpolated frames are kept for reuse
+		/** Scene nodes showing the mesh at a frame which was interpolated
+		shortly before share the result instead of interpolating again. Each
+		kept frame has its own copy of the mesh buffers, the material of the
+		last used copy is taken over when another one is returned. Changed
+		vertex colors, texture coordinates and indices are copied into all
+		kept frames once the changed mesh buffer was set dirty.
+		\param count Number of kept frames, at least 1. The default is 16. */
+		virtual void setInterpolationCacheSize(u32 count) = 0;
+
+		//! Get how many interpolated frames are kept for reuse
+		virtual u32 getInterpolationCacheSize() const = 0;
 	};
 
 } // end namespace scene
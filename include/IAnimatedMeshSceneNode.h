@@ -9,6 +9,7 @@
 #include "IBoneSceneNode.h"
 #include "IAnimatedMeshMD2.h"
 #include "IAnimatedMeshMD3.h"
+#include "ISkinnedMesh.h"
 
 namespace irr
 {
@@ -217,6 +218,17 @@ namespace scene
 		/** Culling is unaffected. */
 		virtual void setRenderFromIdentity( bool On )=0;
 
+		//! Sets layers of animation which are blended for skinned meshes
+		/** Instead of the current frame, the layers are blended with
+		ISkinnedMesh::animateMeshLayers whenever the node animates the mesh.
+		The node does not advance the frames of the layers, change them with
+		getAnimationLayers. Set an empty array to play the frame loop again.
+		The joint weights of the layers are not copied and must stay valid. */
+		virtual void setAnimationLayers(const core::array<ISkinnedMesh::SAnimationLayer>& layers) = 0;
+
+		//! Returns the layers of animation, which can be changed
+		virtual core::array<ISkinnedMesh::SAnimationLayer>& getAnimationLayers() = 0;
+
 		//! Creates a clone of this scene node and its children.
 		/** \param newParent An optional new parent.
 		\param newManager An optional new scene manager.
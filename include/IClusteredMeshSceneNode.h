@@ -0,0 +1,64 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_CLUSTERED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_CLUSTERED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IMeshSceneNode.h"
+#include "SMeshCluster.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A scene node drawing only the visible parts of a very large static mesh
+/** The triangles of the mesh are sorted into small clusters with
+IMeshManipulator::createClusteredMesh() when the mesh is set. Each frame the
+clusters outside of the view frustum, and those facing away from the camera
+in mesh buffers with back face culling, are removed on the CPU, split over
+several threads for meshes with many clusters. The remaining clusters of a
+mesh buffer are drawn with one call.
+This helps when only a part of the mesh can be seen, for example when the
+camera is inside of a large level or close to a large object. getMesh() returns
+the mesh which was set, the node draws a clustered copy of it. */
+class IClusteredMeshSceneNode : public IMeshSceneNode
+{
+public:
+
+	//! Constructor
+	/** Use setMesh() to set the mesh to display.
+	*/
+	IClusteredMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: IMeshSceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Sets the largest number of triangles in a cluster and clusters the mesh again
+	/** Smaller clusters are culled more exactly, but cost more time for
+	the culling. The default is 128. */
+	virtual void setClusterSize(u32 maxTriangles) = 0;
+
+	//! Get the largest number of triangles in a cluster
+	virtual u32 getClusterSize() const = 0;
+
+	//! Get the number of clusters
+	virtual u32 getClusterCount() const = 0;
+
+	//! Get a cluster, the indices refer to the mesh returned by getClusteredMesh()
+	virtual const SMeshCluster& getCluster(u32 index) const = 0;
+
+	//! Get the clustered copy of the mesh which is drawn
+	virtual IMesh* getClusteredMesh() const = 0;
+
+	//! Get the number of clusters which were not culled when the node was drawn the last time
+	virtual u32 getVisibleClusterCount() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,50 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_FRAME_RECEIVER_H_INCLUDED__
+#define __I_FRAME_RECEIVER_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+	class IImage;
+}
+
+	//! Formats in which the offscreen device can stream frames to a file descriptor
+	enum E_FRAME_STREAM_FORMAT
+	{
+		//! Rows of 8 bit red, green and blue values, top row first, without any header
+		EFSF_RAW = 0,
+
+		//! Binary portable pixmap (P6), a header followed by the same data as EFSF_RAW
+		EFSF_PPM
+	};
+
+	//! Interface of an object which receives the frames rendered by the offscreen device
+	/** Set it in SIrrlichtCreationParameters::FrameReceiver and create the device
+	with EIDT_OFFSCREEN. */
+	class IFrameReceiver
+	{
+	public:
+
+		//! Destructor
+		virtual ~IFrameReceiver() {}
+
+		//! Called for every frame presented by the video driver
+		/** When the engine is compiled with _IRR_COMPILE_WITH_PARALLEL_JOBS_
+		this is called on the writer thread of the device while the
+		application already renders the next frame. Frames are passed in
+		the order in which they were rendered.
+		\param frame Image in ECF_R8G8B8 format, only valid during the call.
+		\param frameNumber Number of the frame, starting with 0. */
+		virtual void OnFrame(const video::IImage* frame, u32 frameNumber) = 0;
+	};
+
+} // end namespace irr
+
+#endif
+
@@ -95,6 +95,7 @@ public:
 
 		DesiredRect = r;
 		updateAbsolutePosition();
+		markDirty();
 	}
 
 	//! Sets the relative rectangle of this element, maintaining its current width and height
@@ -152,6 +153,7 @@ public:
 	{
 		NoClip = noClip;
 		updateAbsolutePosition();
+		markDirty();
 	}
 
 
@@ -169,6 +171,7 @@ public:
 	{
 		MaxSize = size;
 		updateAbsolutePosition();
+		markDirty();
 	}
 
 
@@ -181,6 +184,7 @@ public:
 		if (MinSize.Height < 1)
 			MinSize.Height = 1;
 		updateAbsolutePosition();
+		markDirty();
 	}
 
 
@@ -292,6 +296,7 @@ public:
 				(*it)->Parent = 0;
 				(*it)->drop();
 				Children.erase(it);
+				markDirty();
 				return;
 			}
 	}
@@ -317,6 +322,16 @@ public:
 	}
 
 
+	//! Tells the environment that the element changed and has to be drawn again
+	/** Only needed in retained mode, see IGUIEnvironment::setRetainedMode().
+	Elements call this themselves when their state changes. */
+	void markDirty()
+	{
+		if (Environment)
+			Environment->markDirty(this);
+	}
+
+
 	//! animate the element and its children.
 	virtual void OnPostRender(u32 timeMs)
 	{
@@ -359,6 +374,8 @@ public:
 	//! Sets the visible state of this element.
 	virtual void setVisible(bool visible)
 	{
+		if (IsVisible != visible)
+			markDirty();
 		IsVisible = visible;
 	}
 
@@ -477,6 +494,8 @@ public:
 	//! Sets the enabled state of this element.
 	virtual void setEnabled(bool enabled)
 	{
+		if (IsEnabled != enabled)
+			markDirty();
 		IsEnabled = enabled;
 	}
 
@@ -485,6 +504,7 @@ public:
 	virtual void setText(const wchar_t* text)
 	{
 		Text = text;
+		markDirty();
 	}
 
 
@@ -541,6 +561,7 @@ public:
 			{
 				Children.erase(it);
 				Children.push_back(element);
+				markDirty();
 				return true;
 			}
 		}
@@ -562,6 +583,7 @@ public:
 			{
 				Children.erase(it);
 				Children.push_front(child);
+				markDirty();
 				return true;
 			}
 		}
@@ -831,6 +853,7 @@ protected:
 			child->LastParentRect = getAbsolutePosition();
 			child->Parent = this;
 			Children.push_back(child);
+			child->markDirty();
 		}
 	}
 
@@ -76,6 +76,31 @@ public:
 	//! Draws all gui elements by traversing the GUI environment starting at the root node.
 	virtual void drawAll() = 0;
 
+	//! Sets if the top level elements are drawn from cached render target textures
+	/** In retained mode each visible child of the root element is drawn
+	with its children into an own render target texture. drawAll() only
+	draws the elements again when one of them was marked as changed,
+	otherwise the textures of the last frame are drawn to the screen.
+	Elements mark themselves when their state changes or they get input
+	events. Changes the elements don't know about, for example changed
+	skin colors or a render target texture shown by an image, need a call
+	to markDirty(). The textures keep alpha premultiplied colors, so
+	translucent colors look the same as without retained mode. The
+	blending uses the 2d override material of the driver, which is
+	disabled after drawAll(). Drivers without render targets or without
+	separate blending of the alpha channel always draw directly.
+	\param retained True to enable the retained mode, false to draw all
+	elements each frame, which is the default. */
+	virtual void setRetainedMode(bool retained) = 0;
+
+	//! Returns if the top level elements are drawn from cached textures
+	virtual bool isRetainedMode() const = 0;
+
+	//! Marks an element as changed, so it is drawn again in retained mode
+	/** \param element Changed element, the top level element containing
+	it is drawn again with all its children. 0 marks all elements. */
+	virtual void markDirty(IGUIElement* element=0) = 0;
+
 	//! Sets the focus to an element.
 	/** Causes a EGET_ELEMENT_FOCUS_LOST event followed by a
 	EGET_ELEMENT_FOCUSED event. If someone absorbed either of the events,
@@ -17,6 +17,22 @@ namespace irr
 namespace video
 {
 
+//! Filters for IImage::copyToScalingFiltered
+enum E_IMAGE_SCALING_FILTER
+{
+	//! Nearest pixel, same as IImage::copyToScaling
+	EISF_NEAREST = 0,
+
+	//! Average of the covered pixels, same as IImage::copyToScalingBoxFilter
+	EISF_BOX,
+
+	//! Linear interpolation, a triangle filter when scaling down
+	EISF_BILINEAR,
+
+	//! Lanczos filter with 3 lobes. Sharpest results, but slowest.
+	EISF_LANCZOS
+};
+
 //! Interface for software image data.
 /** Image loaders create these images from files. IVideoDrivers convert
 these images into their (hardware) textures.
@@ -279,6 +295,11 @@ public:
 	//! copies this surface into another, scaling it to fit, applying a box filter
 	virtual void copyToScalingBoxFilter(IImage* target, s32 bias = 0, bool blend = false) = 0;
 
+	//! copies this surface into another, scaling it to fit with the given filter
+	/** Bilinear and Lanczos filtering are separable and work on each color channel
+	independently, like the box filter. Large images are filtered by several threads. */
+	virtual void copyToScalingFiltered(IImage* target, E_IMAGE_SCALING_FILTER filter) = 0;
+
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) =0;
 
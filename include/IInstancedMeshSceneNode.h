@@ -0,0 +1,77 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IMeshSceneNode.h"
+#include "matrix4.h"
+#include "SColor.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A scene node drawing many copies of one static mesh
+/** Each copy, called instance, has a transformation relative to the node and
+a color, which is multiplied with the vertex colors. This is much cheaper than
+one mesh scene node for each copy: the instances outside of the view frustum are
+culled together, and the vertices of the visible ones are copied into one
+vertex array per mesh buffer, which is drawn with a single call as long as it has
+less than 65536 vertices. Mesh buffers with primitive types which can't be
+joined like this (strips and fans) are drawn once per instance instead, without
+the instance color.
+The copied vertices are only updated when the visible instances changed, so a
+static camera costs just the culling. */
+class IInstancedMeshSceneNode : public IMeshSceneNode
+{
+public:
+
+	//! Constructor
+	/** Use setMesh() to set the mesh to display.
+	*/
+	IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: IMeshSceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Adds an instance of the mesh
+	/** \param transformation Transformation of the instance relative to the node.
+	Normals are normalized again when it contains a scale.
+	\param color Multiplied with the vertex colors of the instance.
+	\return Index of the instance. */
+	virtual u32 addInstance(const core::matrix4& transformation,
+		video::SColor color=video::SColor(255,255,255,255)) = 0;
+
+	//! Changes the transformation and color of an instance
+	virtual void setInstance(u32 index, const core::matrix4& transformation,
+		video::SColor color=video::SColor(255,255,255,255)) = 0;
+
+	//! Removes an instance
+	/** The last instance takes over the index of the removed one. */
+	virtual void removeInstance(u32 index) = 0;
+
+	//! Removes all instances
+	virtual void clearInstances() = 0;
+
+	//! Get the number of instances
+	virtual u32 getInstanceCount() const = 0;
+
+	//! Get the transformation of an instance relative to the node
+	virtual const core::matrix4& getInstanceTransformation(u32 index) const = 0;
+
+	//! Get the color of an instance
+	virtual video::SColor getInstanceColor(u32 index) const = 0;
+
+	//! Get the number of instances which were not culled when the node was drawn the last time
+	virtual u32 getVisibleInstanceCount() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
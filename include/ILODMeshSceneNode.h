@@ -0,0 +1,107 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_LOD_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_LOD_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IMeshSceneNode.h"
+#include "path.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A mesh scene node which draws simpler versions of its mesh when it is far away
+/** The levels of detail are meshes with the same mesh buffers and materials
+as the mesh of the node, but fewer triangles. Each one has a geometric error,
+the distance by which its surface deviates from the full mesh. Before
+drawing, the node projects these errors onto the screen of the active camera
+and chooses the simplest level whose error stays below a number of pixels.
+Levels can be generated with IMeshManipulator::createSimplifiedMesh() by
+generateLODs(), added by hand, or saved to and loaded from files, because
+generating them for large meshes takes a while.
+When a fade time is set, the previous level fades out over the new one
+after a switch. This uses the vertex alpha of a copy of the previous level,
+so it only works for solid materials and vertex colors with full alpha.
+*/
+class ILODMeshSceneNode : public IMeshSceneNode
+{
+public:
+
+	//! Constructor
+	/** Use setMesh() to set the mesh to display.
+	*/
+	ILODMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: IMeshSceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Adds a level of detail
+	/** Levels have to be added from detailed to simple ones.
+	\param mesh Mesh with one mesh buffer for each mesh buffer of the mesh of the node.
+	\param error Geometric error of the mesh, in the units of the node. */
+	virtual void addLOD(IMesh* mesh, f32 error) = 0;
+
+	//! Creates levels of detail by simplifying the mesh of the node again and again
+	/** Each level has reduction times the triangles of the one before. The
+	generation stops early when a mesh can't be simplified any further.
+	\param count Number of levels to add, the mesh of the node not included.
+	\param reduction Part of the triangles kept from one level to the next.
+	\param cacheFile When not empty, the levels are loaded from this file if it
+	exists and belongs to the mesh, otherwise they are generated and written to it.
+	\return Number of levels after the generation, including the mesh of the node. */
+	virtual u32 generateLODs(u32 count, f32 reduction=0.5f, const io::path& cacheFile="") = 0;
+
+	//! Removes all levels of detail except the mesh of the node
+	virtual void clearLODs() = 0;
+
+	//! Writes the levels of detail to files
+	/** The file stores the errors and a key of the mesh of the node: the
+	number of mesh buffers, vertices and triangles, the bounding box and a
+	hash of the vertices and indices. The meshes are written as .irrmesh
+	files next to it.
+	\param filename Name of the file with the list of levels.
+	\return True if all files were written. */
+	virtual bool writeLODs(const io::path& filename) = 0;
+
+	//! Replaces the levels of detail with those stored by writeLODs()
+	/** \return False if the files couldn't be read or were written for
+	another mesh, or the mesh changed since. The levels are not changed in
+	this case. */
+	virtual bool loadLODs(const io::path& filename) = 0;
+
+	//! Get the number of levels, including the mesh of the node
+	virtual u32 getLODCount() const = 0;
+
+	//! Get the mesh of a level, level 0 is the mesh of the node
+	virtual IMesh* getLODMesh(u32 level) const = 0;
+
+	//! Get the geometric error of a level
+	virtual f32 getLODError(u32 level) const = 0;
+
+	//! Get the level chosen when the node was registered for rendering the last time
+	virtual u32 getCurrentLOD() const = 0;
+
+	//! Sets the largest error on screen in pixels which is accepted for a simpler level
+	/** Default is 1 pixel. */
+	virtual void setMaxScreenError(f32 pixels) = 0;
+
+	//! Get the largest error on screen in pixels which is accepted for a simpler level
+	virtual f32 getMaxScreenError() const = 0;
+
+	//! Sets the time in milliseconds in which the previous level fades out after a switch
+	/** Default is 0, which switches immediately. */
+	virtual void setFadeTime(u32 milliseconds) = 0;
+
+	//! Get the time in milliseconds in which the previous level fades out
+	virtual u32 getFadeTime() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -12,6 +12,8 @@
 #include "IAnimatedMesh.h"
 #include "IMeshBuffer.h"
 #include "SVertexManipulator.h"
+#include "SMeshCluster.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -145,7 +147,7 @@ namespace scene
 		//! Applies a transformation to a mesh
 		/** \param mesh Mesh on which the operation is performed.
 		\param m transformation matrix. */
-		void transform(IMesh* mesh, const core::matrix4& m) const
+		virtual void transform(IMesh* mesh, const core::matrix4& m) const
 		{
 			apply(SVertexPositionTransformManipulator(m), mesh, true);
 		}
@@ -153,7 +155,7 @@ namespace scene
 		//! Applies a transformation to a meshbuffer
 		/** \param buffer Meshbuffer on which the operation is performed.
 		\param m transformation matrix. */
-		void transform(IMeshBuffer* buffer, const core::matrix4& m) const
+		virtual void transform(IMeshBuffer* buffer, const core::matrix4& m) const
 		{
 			apply(SVertexPositionTransformManipulator(m), buffer, true);
 		}
@@ -264,6 +266,46 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual IMesh* createMeshWelded(IMesh* mesh, f32 tolerance=core::ROUNDING_ERROR_f32) const = 0;
 
+		//! Creates a copy of a mesh with fewer triangles
+		/** Edges are collapsed in the order of their quadric error (Garland
+		and Heckbert), each collapse moves one vertex onto a neighbour. The
+		vertices keep their normals, texture coordinates and colors, so no
+		new vertices are created. Borders of open surfaces are kept, and
+		vertices on seams in the texture coordinates or normals are only
+		collapsed along the seam. Meshes with separate vertices for each
+		face, like flat shaded ones, should be welded with smooth normals
+		first, otherwise they can't be simplified much.
+		Mesh buffers are simplified separately, those which are no triangle
+		lists are copied.
+		\param mesh Input mesh
+		\param ratio Part of the triangles to keep, between 0 and 1.
+		\param error Receives the deviation of the simplified surface, in
+		the units of the mesh. This is the root mean square distance of the
+		moved vertices to their original planes, so it is an estimate, not
+		a bound.
+		\return Simplified mesh. If you no longer need it, you should call
+		IMesh::drop(). See IReferenceCounted::drop() for more information. */
+		virtual IMesh* createSimplifiedMesh(IMesh* mesh, f32 ratio, f32* error=0) const = 0;
+
+		//! Creates a copy of a mesh with its triangles sorted into small clusters
+		/** Each cluster is a group of up to maxTriangles neighbouring
+		triangles facing in similar directions, stored as one range of
+		indices. Scene nodes can cull such clusters against the view frustum
+		and by their normals, so only parts of a very large mesh are drawn,
+		see ISceneManager::addClusteredMeshSceneNode(). The vertices are
+		copied in the order in which the clusters use them.
+		Mesh buffers which are no triangle lists are copied and get no
+		clusters.
+		\param mesh Input mesh
+		\param clusters Receives the clusters of all mesh buffers, sorted by
+		mesh buffer.
+		\param maxTriangles Largest number of triangles in a cluster.
+		\return Mesh with the clustered triangles. If you no longer need it,
+		you should call IMesh::drop(). See IReferenceCounted::drop() for more
+		information. */
+		virtual IMesh* createClusteredMesh(IMesh* mesh, core::array<SMeshCluster>& clusters,
+			u32 maxTriangles=128) const = 0;
+
 		//! Get amount of polygons in mesh.
 		/** \param mesh Input mesh
 		\return Number of polygons in mesh. */
@@ -30,8 +30,8 @@ enum EOCTREENODE_VBO
 	//! In most cases the other 2 options should work better with an octree.
 	EOV_USE_VBO,
 
-	//! VBO's used. The index-buffer information is updated each frame
-	//! with only the visible parts of a tree-node.
+	//! VBO's used. The index-buffer information is updated with only the
+	//! visible parts of a tree-node when they change.
 	//! So the vertex-buffer is static and the index-buffer is dynamic.
 	//! This is the default
 	EOV_USE_VBO_WITH_VISIBITLY
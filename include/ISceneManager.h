@@ -108,6 +108,9 @@ namespace scene
 	class IMeshLoader;
 	class IMeshManipulator;
 	class IMeshSceneNode;
+	class IInstancedMeshSceneNode;
+	class ILODMeshSceneNode;
+	class IClusteredMeshSceneNode;
 	class IMeshWriter;
 	class IMetaTriangleSelector;
 	class IOctreeSceneNode;
@@ -509,6 +512,68 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) = 0;
 
+		//! Adds a scene node for rendering many instances of a static mesh.
+		/** Use this instead of many mesh scene nodes with the same mesh, for
+		example for trees or rocks. Add the instances with
+		IInstancedMeshSceneNode::addInstance().
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\param alsoAddIfMeshPointerZero: Add the scene node even if a 0 pointer is passed.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) = 0;
+
+		//! Adds a scene node for rendering a static mesh with levels of detail.
+		/** The node draws simpler versions of the mesh when they don't look
+		different from far away. Create them with ILODMeshSceneNode::generateLODs()
+		or add them with ILODMeshSceneNode::addLOD(), without levels the node
+		works like a mesh scene node.
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\param alsoAddIfMeshPointerZero: Add the scene node even if a 0 pointer is passed.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual ILODMeshSceneNode* addLODMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) = 0;
+
+		//! Adds a scene node for rendering only the visible parts of a very large static mesh.
+		/** The triangles of the mesh are sorted into small clusters, which
+		are culled against the view frustum and by their normals each frame.
+		Use this for meshes which are often only partly visible, like large
+		levels or buildings, see IClusteredMeshSceneNode.
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\param alsoAddIfMeshPointerZero: Add the scene node even if a 0 pointer is passed.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IClusteredMeshSceneNode* addClusteredMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) = 0;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		/** Looks really good when the Material type EMT_TRANSPARENT_REFLECTION
 		is used.
@@ -1541,6 +1606,8 @@ namespace scene
 		an xml based format. .irr files can Be edited with the Irrlicht
 		Engine Editor, irrEdit (http://www.ambiera.com/irredit/). To
 		load .irr files again, see ISceneManager::loadScene().
+		Files with the extension .irrb are written in a binary format
+		instead, which contains the same data but loads much faster.
 		\param filename Name of the file.
 		\param userDataSerializer If you want to save some user data
 		for every scene node into the file, implement the
@@ -1559,6 +1626,8 @@ namespace scene
 		an xml based format. .irr files can Be edited with the Irrlicht
 		Engine Editor, irrEdit (http://www.ambiera.com/irredit/). To
 		load .irr files again, see ISceneManager::loadScene().
+		Files with the extension .irrb are written in a binary format
+		instead, which contains the same data but loads much faster.
 		\param file File where the scene is saved into.
 		\param userDataSerializer If you want to save some user data
 		for every scene node into the file, implement the
@@ -1593,7 +1662,8 @@ namespace scene
 
 		//! Loads a scene. Note that the current scene is not cleared before.
 		/** The scene is usually loaded from an .irr file, an xml based
-		format, but other scene formats can be added to the engine via
+		format, or from its binary counterpart .irrb. Other scene
+		formats can be added to the engine via
 		ISceneManager::addExternalSceneLoader. .irr files can Be edited
 		with the Irrlicht Engine Editor, irrEdit
 		(http://www.ambiera.com/irredit/) or saved directly by the engine
@@ -1612,7 +1682,8 @@ namespace scene
 
 		//! Loads a scene. Note that the current scene is not cleared before.
 		/** The scene is usually loaded from an .irr file, an xml based
-		format, but other scene formats can be added to the engine via
+		format, or from its binary counterpart .irrb. Other scene
+		formats can be added to the engine via
 		ISceneManager::addExternalSceneLoader. .irr files can Be edited
 		with the Irrlicht Engine Editor, irrEdit
 		(http://www.ambiera.com/irredit/) or saved directly by the engine
@@ -1650,6 +1721,26 @@ namespace scene
 			current callbacks manager and restore the default behavior. */
 		virtual void setLightManager(ILightManager* lightManager) = 0;
 
+		//! Creates a light manager which lights each scene node with the most relevant lights.
+		/** All point and spot lights are sorted into a uniform grid by their
+		radius of influence once per frame. Before a node is rendered, only the
+		lights which reach its bounding box and contribute most at its position
+		are switched on. Directional lights are always preferred. Without light
+		manager all nodes are lit by the lights closest to the camera.
+		Set it with setLightManager().
+		\code
+		scene::ILightManager* lights = smgr->createGridLightManager(4);
+		smgr->setLightManager(lights);
+		lights->drop();
+		\endcode
+		\param lightsPerNode Maximal number of lights switched on for a node,
+		0 uses IVideoDriver::getMaximalDynamicLightAmount().
+		\param cellSize Size of the grid cells, 0 to choose it from the radius
+		of the lights.
+		\return The light manager. This pointer should be dropped, See
+		IReferenceCounted::drop() for more information. */
+		virtual ILightManager* createGridLightManager(u32 lightsPerNode=0, f32 cellSize=0.f) = 0;
+
 		//! Get current render pass.
 		virtual E_SCENE_NODE_RENDER_PASS getCurrentRenderPass() const =0;
 
@@ -1671,6 +1762,29 @@ namespace scene
 		\return True if node is not visible in the current scene, else
 		false. */
 		virtual bool isCulled(const ISceneNode* node) const =0;
+
+		//! Adds an occluder for software occlusion culling
+		/** Before the scene nodes register for rendering, all occluders
+		are drawn on the CPU into a small depth buffer as seen by the
+		active camera. Scene nodes using the culling type EAC_OCC_SOFTWARE
+		are culled when their bounding box lies completely behind the
+		occluders. Unlike occlusion queries the results are available in
+		the same frame and need no hardware support. Occluders should be
+		simple meshes covering large parts of the screen, like walls or
+		buildings, and must not be larger than the geometry they stand for.
+		\param node Scene node giving the absolute transformation of the
+		occluder. The occluder is only drawn while the node is visible.
+		Calling this again for the same node replaces its mesh.
+		\param mesh Occluder geometry in the space of the node. If 0 the
+		mesh of a mesh, octree, cube or sphere scene node or the first
+		frame of an animated mesh scene node is used. */
+		virtual void addOccluder(ISceneNode* node, const IMesh* mesh=0) =0;
+
+		//! Removes the occluder of a scene node
+		virtual void removeOccluder(ISceneNode* node) =0;
+
+		//! Removes all occluders
+		virtual void removeAllOccluders() =0;
 	};
 
 
@@ -50,10 +50,13 @@ namespace scene
 
 		//! Use animation from another mesh
 		/** The animation is linked (not copied) based on joint names
-		so make sure they are unique.
+		so make sure they are unique. The other mesh is kept as long as
+		this mesh uses its animation. Meshes with a baked animation have
+		no keys left to link, see bakeAnimation().
 		\return True if all joints in this mesh were
 		matched up (empty names will not be matched, and it's case
-		sensitive). Unmatched joints will not be animated. */
+		sensitive). Unmatched joints will not be animated. False without
+		any change if the other mesh has a baked animation. */
 		virtual bool useAnimationFrom(const ISkinnedMesh *mesh) = 0;
 
 		//! Update Normals when Animating
@@ -65,9 +68,71 @@ namespace scene
 		//! Sets Interpolation Mode
 		virtual void setInterpolationMode(E_INTERPOLATION_MODE mode) = 0;
 
+		//! Bakes the animation keys into compressed samples
+		/** The keys of all joints are resampled at a fixed rate, with the
+		current interpolation mode. Positions and scales are stored with 16
+		bit per component within the range of each joint. Rotations are
+		stored as the smallest three quaternion components with 15 bit
+		each, the remaining bits tell which component was left out.
+		Animating the mesh only has to look at two samples then, instead of
+		searching the keys, which makes seeking and jumping in the
+		animation cheap. Values which never change are not stored per
+		sample. Two keys on the same frame are smoothed over one sample,
+		and clips with few keys can get larger, use less samples per frame
+		for those.
+		The keys of the joints are removed afterwards. So a mesh whose
+		animation is used by other meshes with useAnimationFrom() is not
+		baked, and a baked mesh can't be passed to useAnimationFrom().
+		Calling useAnimationFrom() on this mesh with another mesh drops the
+		baked samples.
+		\param samplesPerFrame Samples taken per animation frame.
+		\return True if the mesh had animation keys to bake, false if it
+		had none or other meshes use its animation. */
+		virtual bool bakeAnimation(f32 samplesPerFrame=1.f) = 0;
+
+		//! Returns if the animation was baked by bakeAnimation
+		virtual bool isAnimationBaked() const = 0;
+
 		//! Animates this mesh's joints based on frame input
 		virtual void animateMesh(f32 frame, f32 blend)=0;
 
+		//! A layer of animation for animateMeshLayers
+		struct SAnimationLayer
+		{
+			SAnimationLayer(f32 frame=0.f, f32 weight=1.f)
+				: Frame(frame), Weight(weight), ReferenceFrame(0.f), JointWeights(0), Additive(false) {}
+
+			//! Frame of the animation sampled by this layer
+			f32 Frame;
+
+			//! Weight of the layer
+			f32 Weight;
+
+			//! Frame of the animation which additive layers take their difference to
+			f32 ReferenceFrame;
+
+			//! Optional weight for each joint, which is multiplied with Weight
+			/** Must have getJointCount() entries, or be 0 to use Weight for all joints. */
+			const f32* JointWeights;
+
+			//! Add the difference between Frame and ReferenceFrame instead of blending the frame
+			bool Additive;
+		};
+
+		//! Animates this mesh's joints with a blend of several layers
+		/** The layers which are not additive are blended by their weights,
+		which don't have to sum up to 1. Joints without weight in any of them
+		keep their current transformation. Then the additive layers add their
+		difference between Frame and ReferenceFrame in the given order, so a
+		layer with Frame equal to ReferenceFrame changes nothing.
+		All joints are evaluated together for each layer, so masking joints
+		with JointWeights is cheaper than controlling them through bone scene
+		nodes. Like animateMesh, this updates the local matrices of the
+		joints, skinMesh has to be called afterwards.
+		\param layers Array of layers.
+		\param layerCount Amount of layers in the array. */
+		virtual void animateMeshLayers(const SAnimationLayer* layers, u32 layerCount) = 0;
+
 		//! Preforms a software skin on this mesh based of joint positions
 		virtual void skinMesh() = 0;
 
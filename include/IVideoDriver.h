@@ -1038,6 +1038,11 @@ namespace video
 		\return Size of render target or screen/window */
 		virtual const core::dimension2d<u32>& getCurrentRenderTargetSize() const =0;
 
+		//! Get the current render target
+		/** \return Render target set by setRenderTargetEx() or
+		setRenderTarget(), 0 if the screen is the render target. */
+		virtual IRenderTarget* getCurrentRenderTarget() const =0;
+
 		//! Returns current frames per second value.
 		/** This value is updated approximately every 1.5 seconds and
 		is only intended to provide a rough guide to the average frame
@@ -33,6 +33,7 @@
 //! _IRR_COMPILE_WITH_SDL_DEVICE_ for platform independent SDL framework
 //! _IRR_COMPILE_WITH_GLFW3_DEVICE_ for platform independent GLFW3 framework
 //! _IRR_COMPILE_WITH_CONSOLE_DEVICE_ for no windowing system, used as a fallback
+//! _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_ for rendering into memory without windowing system
 //! _IRR_COMPILE_WITH_FB_DEVICE_ for framebuffer systems
 
 //! Passing defines to the compiler which have NO in front of the _IRR definename is an alternative
@@ -60,6 +61,12 @@
 #undef _IRR_COMPILE_WITH_CONSOLE_DEVICE_
 #endif
 
+//! Comment this line to compile without the offscreen device.
+#define _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+#ifdef NO_IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+#undef _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+#endif
+
 //! WIN32 for Windows32
 //! WIN64 for Windows64
 // The windows platform and API support SDL and WINDOW device
@@ -141,6 +148,26 @@ while it runs and enabling it will slow down the engine. */
 #undef _IRR_COMPILE_WITH_PROFILING_
 #endif
 
+//! Define _IRR_COMPILE_WITH_PARALLEL_JOBS_ to allow some bulk operations to use worker threads.
+/** Used for example by mesh loaders which can split their work into independent parts.
+Without this define all work is done on the calling thread.
+On older Posix systems you might have to link with -lpthread. */
+#define _IRR_COMPILE_WITH_PARALLEL_JOBS_
+#ifdef NO_IRR_COMPILE_WITH_PARALLEL_JOBS_
+#undef _IRR_COMPILE_WITH_PARALLEL_JOBS_
+#endif
+
+//! Define _IRR_COMPILE_WITH_SSE2_ to use SSE2 instructions in the software blitters, color converters
+//! and baked skinned mesh animations.
+/** Enabled when the compiler generates code for cpus which have SSE2, like all x86-64 cpus.
+The results are the same as without it. */
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define _IRR_COMPILE_WITH_SSE2_
+#endif
+#ifdef NO_IRR_COMPILE_WITH_SSE2_
+#undef _IRR_COMPILE_WITH_SSE2_
+#endif
+
 //! Define _IRR_COMPILE_WITH_DIRECT3D_9_ to compile the Irrlicht engine with DIRECT3D9.
 /** If you only want to use the software device or opengl you can disable those defines.
 This switch is mostly disabled because people do not get the g++ compiler compile
@@ -232,6 +259,13 @@ define out. */
 #undef _IRR_LINUX_X11_RANDR_
 #endif
 
+//! The software drivers present their frames through the MIT-SHM extension when the X server supports it.
+//! This avoids sending each frame over the X connection. Needs the Xext library.
+#define _IRR_LINUX_X11_SHM_
+#ifdef NO_IRR_LINUX_X11_SHM_
+#undef _IRR_LINUX_X11_SHM_
+#endif
+
 //! X11 has by default only monochrome cursors, but using the Xcursor library we can also get color cursor support.
 //! If you have the need for custom color cursors on X11 then enable this and make sure you also link
 //! to the Xcursor library in your Makefile/Projectfile.
@@ -362,6 +396,13 @@ tool <http://developer.nvidia.com/object/nvperfhud_home.html>. */
 #undef _IRR_COMPILE_WITH_IRR_SCENE_LOADER_
 #endif
 
+//! Define _IRR_COMPILE_WITH_IRRB_SCENE_ if you want to be able to load and save
+/** binary .irrb scenes using ISceneManager::loadScene and ISceneManager::saveScene */
+#define _IRR_COMPILE_WITH_IRRB_SCENE_
+#ifdef NO_IRR_COMPILE_WITH_IRRB_SCENE_
+#undef _IRR_COMPILE_WITH_IRRB_SCENE_
+#endif
+
 //! Define _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_ if you want to use bone based
 /** animated meshes. If you compile without this, you will be unable to load
 B3D, MS3D or X meshes */
@@ -7,6 +7,7 @@
 
 #include "EDriverTypes.h"
 #include "EDeviceTypes.h"
+#include "IFrameReceiver.h"
 #include "dimension2d.h"
 #include "ILogger.h"
 #include "position2d.h"
@@ -47,6 +48,10 @@ namespace irr
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
 			UsePerformanceTimer(true),
+			FrameReceiver(0),
+			FrameStreamFile(-1),
+			FrameStreamFormat(EFSF_PPM),
+			WorkerThreads(0),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
 		}
@@ -79,6 +84,10 @@ namespace irr
 			DriverMultithreaded = other.DriverMultithreaded;
 			DisplayAdapter = other.DisplayAdapter;
 			UsePerformanceTimer = other.UsePerformanceTimer;
+			FrameReceiver = other.FrameReceiver;
+			FrameStreamFile = other.FrameStreamFile;
+			FrameStreamFormat = other.FrameStreamFormat;
+			WorkerThreads = other.WorkerThreads;
 			return *this;
 		}
 
@@ -92,6 +101,7 @@ namespace irr
 		EIDT_SDL is available on most systems if compiled in,
 		EIDT_GLFW3 is available on most systems if compiled in,
 		EIDT_CONSOLE is usually available but can only render to text,
+		EIDT_OFFSCREEN is usually available and passes the rendered frames to FrameReceiver or FrameStreamFile,
 		EIDT_BEST will select the best available device for your operating system.
 		Default: EIDT_BEST. */
 		E_DEVICE_TYPE DeviceType;
@@ -289,6 +299,30 @@ namespace irr
 		*/
 		bool UsePerformanceTimer;
 
+		//! Receives the frames rendered with the offscreen device.
+		/** Only used by EIDT_OFFSCREEN. The receiver is not dropped or
+		deleted by the device. Default: 0 */
+		IFrameReceiver* FrameReceiver;
+
+		//! File descriptor to which the offscreen device streams its frames.
+		/** Only used by EIDT_OFFSCREEN. Can be a file, pipe or socket, it is
+		not closed by the device. Frames are written in FrameStreamFormat.
+		Default: -1, no stream */
+		s32 FrameStreamFile;
+
+		//! Format of the frames written to FrameStreamFile. Default: EFSF_PPM
+		E_FRAME_STREAM_FORMAT FrameStreamFormat;
+
+		//! Number of threads used by the engine for work split into parts.
+		/** Mesh manipulation and similar jobs are shared between this many
+		threads, including the calling one. 1 does all work on the calling
+		thread, at most 64 threads are used. Only has an effect when the engine
+		is compiled with _IRR_COMPILE_WITH_PARALLEL_JOBS_.
+		The setting is process wide, like the logger: each new device sets it
+		for all devices, the last created device decides.
+		Default: 0, one thread per processor core */
+		u32 WorkerThreads;
+
 		//! Don't use or change this parameter.
 		/** Always set it to IRRLICHT_SDK_VERSION, which is done by default.
 		This is needed for sdk version checks. */
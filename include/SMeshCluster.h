@@ -0,0 +1,53 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_MESH_CLUSTER_H_INCLUDED__
+#define __S_MESH_CLUSTER_H_INCLUDED__
+
+#include "vector3d.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A small group of neighbouring triangles of a mesh buffer, culled as a whole
+/** Created by IMeshManipulator::createClusteredMesh(). The triangles of a
+cluster are stored one after the other in the index buffer, so each cluster is
+one range of indices. */
+struct SMeshCluster
+{
+	SMeshCluster() : MeshBuffer(0), FirstIndex(0), IndexCount(0), Radius(0.f),
+		ConeCutoff(1.f) {}
+
+	//! Index of the mesh buffer with the triangles
+	u32 MeshBuffer;
+
+	//! First index of the triangles in the index buffer
+	u32 FirstIndex;
+
+	//! Number of indices, three for each triangle
+	u32 IndexCount;
+
+	//! Center of a sphere around all vertices of the cluster
+	core::vector3df Center;
+
+	//! Radius of the sphere around all vertices of the cluster
+	f32 Radius;
+
+	//! Average normal of the triangles
+	core::vector3df ConeAxis;
+
+	//! Sine of the largest angle between a triangle normal and ConeAxis
+	/** 1 when the normals are spread too far, then the cluster is never
+	back facing. Otherwise all triangles face away from a camera at position
+	p when (Center-p).dotProduct(ConeAxis) >= ConeCutoff*(Center-p).getLength()+Radius */
+	f32 ConeCutoff;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -137,6 +137,18 @@ namespace scene
 	const c8* const OBJ_LOADER_IGNORE_MATERIAL_FILES = "OBJ_IgnoreMaterialFiles";
 
 
+	//! Flag to read the vertex data of large .obj files with several threads
+	/** The file is split into line-aligned parts which are parsed in parallel
+	in a first pass, faces are then built in a second pass. The resulting mesh
+	is identical to the one from single-threaded loading.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::OBJ_LOADER_PARALLEL_PARSING, true);
+	\endcode
+	**/
+	const c8* const OBJ_LOADER_PARALLEL_PARSING = "OBJ_ParallelParsing";
+
+
 	//! Flag to ignore the b3d file's mipmapping flag
 	/** Instead Irrlicht's texture creation flag is used. Use it like this:
 	\code
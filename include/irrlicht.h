@@ -71,6 +71,7 @@
 #include "IEventReceiver.h"
 #include "IFileList.h"
 #include "IFileSystem.h"
+#include "IFrameReceiver.h"
 #include "IGeometryCreator.h"
 #include "IGPUProgrammingServices.h"
 #include "IGUIButton.h"
@@ -114,6 +115,9 @@
 #include "IMeshLoader.h"
 #include "IMeshManipulator.h"
 #include "IMeshSceneNode.h"
+#include "IInstancedMeshSceneNode.h"
+#include "ILODMeshSceneNode.h"
+#include "IClusteredMeshSceneNode.h"
 #include "IMeshWriter.h"
 #include "IOctreeSceneNode.h"
 #include "IColladaMeshWriter.h"
@@ -181,6 +185,7 @@
 #include "SMaterial.h"
 #include "SMesh.h"
 #include "SMeshBuffer.h"
+#include "SMeshCluster.h"
 #include "SMeshBufferLightMap.h"
 #include "SMeshBufferTangents.h"
 #include "SParticle.h"
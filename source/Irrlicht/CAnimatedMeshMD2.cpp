@@ -220,13 +220,19 @@ static const SMD2AnimationType MD2AnimationTypeList[21] =
 //! constructor
 CAnimatedMeshMD2::CAnimatedMeshMD2()
 	: InterpolationBuffer(0), InterpolationFirstFrame(-1), InterpolationSecondFrame(-1), InterpolationFrameDiv(0.f)
-	, FrameList(0), FrameCount(0), FramesPerSecond((f32)(MD2AnimationTypeList[0].fps << MD2_FRAME_SHIFT))
+	, FrameList(0), FrameCount(0), InterpolationCacheSize(16), InterpolationUse(0)
+	, FramesPerSecond((f32)(MD2AnimationTypeList[0].fps << MD2_FRAME_SHIFT))
 {
 	#ifdef _DEBUG
 	IAnimatedMesh::setDebugName("CAnimatedMeshMD2 IAnimatedMesh");
 	IMesh::setDebugName("CAnimatedMeshMD2 IMesh");
 	#endif
 	InterpolationBuffer = new SMeshBuffer;
+
+	// the loader fills this buffer, the others are copied from it
+	SInterpolation first;
+	first.Buffer = InterpolationBuffer;
+	Interpolations.push_back(first);
 }
 
 
@@ -234,8 +240,8 @@ CAnimatedMeshMD2::CAnimatedMeshMD2()
 CAnimatedMeshMD2::~CAnimatedMeshMD2()
 {
 	delete [] FrameList;
-	if (InterpolationBuffer)
-		InterpolationBuffer->drop();
+	for (u32 i=0; i<Interpolations.size(); ++i)
+		Interpolations[i].Buffer->drop();
 }
 
 
@@ -321,44 +327,117 @@ void CAnimatedMeshMD2::updateInterpolationBuffer(s32 frame, s32 startFrameLoop,
 		div = frame * MD2_FRAME_SHIFT_RECIPROCAL;
 	}
 
-	if ( firstFrame != InterpolationFirstFrame || secondFrame != InterpolationSecondFrame || div != InterpolationFrameDiv )
+	if ( firstFrame == InterpolationFirstFrame && secondFrame == InterpolationSecondFrame && div == InterpolationFrameDiv )
+		return;
+
+	keepChanges();
+
+	// look for the frames in the interpolations kept for reuse,
+	// otherwise replace an unused or the least recently used one
+	u32 found = Interpolations.size();
+	u32 oldest = 0;
+	for (u32 i=0; i<Interpolations.size(); ++i)
+	{
+		const SInterpolation& ipol = Interpolations[i];
+		if (ipol.LastUse && ipol.FirstFrame == firstFrame && ipol.SecondFrame == secondFrame && ipol.FrameDiv == div)
+		{
+			found = i;
+			break;
+		}
+		if (ipol.LastUse < Interpolations[oldest].LastUse)
+			oldest = i;
+	}
+
+	if (found == Interpolations.size())
 	{
-		InterpolationFirstFrame = firstFrame;
-		InterpolationSecondFrame = secondFrame;
-		InterpolationFrameDiv = div;
+		if (Interpolations[oldest].LastUse && Interpolations.size() < InterpolationCacheSize)
+		{
+			SInterpolation ipol;
+			ipol.Buffer = new SMeshBuffer;
+			ipol.Buffer->Vertices = InterpolationBuffer->Vertices;
+			ipol.Buffer->Indices = InterpolationBuffer->Indices;
+			ipol.Buffer->setHardwareMappingHint(InterpolationBuffer->getHardwareMappingHint_Vertex(), EBT_VERTEX);
+			ipol.Buffer->setHardwareMappingHint(InterpolationBuffer->getHardwareMappingHint_Index(), EBT_INDEX);
+			Interpolations.push_back(ipol);
+		}
+		else
+			found = oldest;
+
+		SInterpolation& ipol = Interpolations[found];
+		ipol.FirstFrame = firstFrame;
+		ipol.SecondFrame = secondFrame;
+		ipol.FrameDiv = div;
 
-		video::S3DVertex* target = static_cast<video::S3DVertex*>(InterpolationBuffer->getVertices());
-		SMD2Vert* first = FrameList[firstFrame].pointer();
-		SMD2Vert* second = FrameList[secondFrame].pointer();
+		if (Frames.getFrameCount() != FrameCount)
+			buildFrames();
 
 		// interpolate both frames
-		const u32 count = FrameList[firstFrame].size();
+		if (ipol.Buffer->Vertices.size() >= Frames.getVertexCount())
+			Frames.interpolate(firstFrame, secondFrame, div, ipol.Buffer->Vertices.pointer(), sizeof(video::S3DVertex));
+
+		//update bounding box
+		ipol.Buffer->setBoundingBox(BoxList[secondFrame].getInterpolated(BoxList[firstFrame], div));
+		ipol.Buffer->setDirty(EBT_VERTEX);
+		ipol.ChangedID = ipol.Buffer->getChangedID_Vertex() + ipol.Buffer->getChangedID_Index();
+	}
+
+	SInterpolation& ipol = Interpolations[found];
+	ipol.LastUse = ++InterpolationUse;
+	if (ipol.Buffer != InterpolationBuffer)
+	{
+		ipol.Buffer->Material = InterpolationBuffer->Material;
+		InterpolationBuffer = ipol.Buffer;
+	}
+
+	InterpolationFirstFrame = firstFrame;
+	InterpolationSecondFrame = secondFrame;
+	InterpolationFrameDiv = div;
+}
+
+
+//! decodes the positions and normals of all key frames
+void CAnimatedMeshMD2::buildFrames()
+{
+	Frames.reset(FrameCount, FrameCount ? FrameList[0].size() : 0);
+
+	for (u32 f=0; f<FrameCount; ++f)
+	{
+		const SKeyFrameTransform& transform = FrameTransforms[f];
+		const core::array<SMD2Vert>& vertices = FrameList[f];
+		const u32 count = core::min_(vertices.size(), Frames.getVertexCount());
 		for (u32 i=0; i<count; ++i)
 		{
-			const core::vector3df one = core::vector3df(f32(first->Pos.X) * FrameTransforms[firstFrame].scale.X + FrameTransforms[firstFrame].translate.X,
-					f32(first->Pos.Y) * FrameTransforms[firstFrame].scale.Y + FrameTransforms[firstFrame].translate.Y,
-					f32(first->Pos.Z) * FrameTransforms[firstFrame].scale.Z + FrameTransforms[firstFrame].translate.Z);
-			const core::vector3df two = core::vector3df(f32(second->Pos.X) * FrameTransforms[secondFrame].scale.X + FrameTransforms[secondFrame].translate.X,
-					f32(second->Pos.Y) * FrameTransforms[secondFrame].scale.Y + FrameTransforms[secondFrame].translate.Y,
-					f32(second->Pos.Z) * FrameTransforms[secondFrame].scale.Z + FrameTransforms[secondFrame].translate.Z);
-			target->Pos = two.getInterpolated(one, div);
-			const core::vector3df n1(
-					Q2_VERTEX_NORMAL_TABLE[first->NormalIdx][0],
-					Q2_VERTEX_NORMAL_TABLE[first->NormalIdx][2],
-					Q2_VERTEX_NORMAL_TABLE[first->NormalIdx][1]);
-			const core::vector3df n2(
-					Q2_VERTEX_NORMAL_TABLE[second->NormalIdx][0],
-					Q2_VERTEX_NORMAL_TABLE[second->NormalIdx][2],
-					Q2_VERTEX_NORMAL_TABLE[second->NormalIdx][1]);
-			target->Normal = n2.getInterpolated(n1, div);
-			++target;
-			++first;
-			++second;
+			const SMD2Vert& v = vertices[i];
+			Frames.setVertex(f, i,
+				core::vector3df(f32(v.Pos.X) * transform.scale.X + transform.translate.X,
+					f32(v.Pos.Y) * transform.scale.Y + transform.translate.Y,
+					f32(v.Pos.Z) * transform.scale.Z + transform.translate.Z),
+				core::vector3df(Q2_VERTEX_NORMAL_TABLE[v.NormalIdx][0],
+					Q2_VERTEX_NORMAL_TABLE[v.NormalIdx][2],
+					Q2_VERTEX_NORMAL_TABLE[v.NormalIdx][1]));
 		}
+	}
+}
 
-		//update bounding box
-		InterpolationBuffer->setBoundingBox(BoxList[secondFrame].getInterpolated(BoxList[firstFrame], div));
-		InterpolationBuffer->setDirty();
+
+//! copies changes of the user to InterpolationBuffer into all kept frames
+/** Vertices and indices changed without setting the buffer dirty are lost
+when another frame is returned. */
+void CAnimatedMeshMD2::keepChanges()
+{
+	u32 current = 0;
+	while (current < Interpolations.size() && Interpolations[current].Buffer != InterpolationBuffer)
+		++current;
+	const u32 changedID = InterpolationBuffer->getChangedID_Vertex() + InterpolationBuffer->getChangedID_Index();
+	if (current == Interpolations.size() || Interpolations[current].ChangedID == changedID)
+		return;
+
+	for (u32 i=0; i<Interpolations.size(); ++i)
+	{
+		SMeshBuffer* buffer = Interpolations[i].Buffer;
+		if (i != current)
+			CKeyFrameStreams::copyUnanimated(buffer, InterpolationBuffer);
+		Interpolations[i].ChangedID = buffer->getChangedID_Vertex() + buffer->getChangedID_Index();
 	}
 }
 
@@ -374,14 +453,16 @@ void CAnimatedMeshMD2::setMaterialFlag(video::E_MATERIAL_FLAG flag, bool newvalu
 void CAnimatedMeshMD2::setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint,
 		E_BUFFER_TYPE buffer)
 {
-	InterpolationBuffer->setHardwareMappingHint(newMappingHint, buffer);
+	for (u32 i=0; i<Interpolations.size(); ++i)
+		Interpolations[i].Buffer->setHardwareMappingHint(newMappingHint, buffer);
 }
 
 
 //! flags the meshbuffer as changed, reloads hardware buffers
 void CAnimatedMeshMD2::setDirty(E_BUFFER_TYPE buffer)
 {
-	InterpolationBuffer->setDirty(buffer);
+	for (u32 i=0; i<Interpolations.size(); ++i)
+		Interpolations[i].Buffer->setDirty(buffer);
 }
 
 
@@ -459,6 +540,34 @@ const c8* CAnimatedMeshMD2::getAnimationName(s32 nr) const
 }
 
 
+//! Set how many interpolated frames are kept for reuse
+void CAnimatedMeshMD2::setInterpolationCacheSize(u32 count)
+{
+	InterpolationCacheSize = core::max_(count, 1u);
+
+	// drop the least recently used frames, but never the current one
+	while (Interpolations.size() > InterpolationCacheSize)
+	{
+		u32 oldest = Interpolations[0].Buffer == InterpolationBuffer ? 1 : 0;
+		for (u32 i=oldest+1; i<Interpolations.size(); ++i)
+		{
+			if (Interpolations[i].Buffer != InterpolationBuffer &&
+				Interpolations[i].LastUse < Interpolations[oldest].LastUse)
+				oldest = i;
+		}
+		Interpolations[oldest].Buffer->drop();
+		Interpolations.erase(oldest);
+	}
+}
+
+
+//! Get how many interpolated frames are kept for reuse
+u32 CAnimatedMeshMD2::getInterpolationCacheSize() const
+{
+	return InterpolationCacheSize;
+}
+
+
 } // end namespace scene
 } // end namespace irr
 
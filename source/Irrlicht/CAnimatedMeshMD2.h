@@ -8,6 +8,7 @@
 #include "IAnimatedMeshMD2.h"
 #include "IMesh.h"
 #include "CMeshBuffer.h"
+#include "CKeyFrameStreams.h"
 #include "IReadFile.h"
 #include "S3DVertex.h"
 #include "irrArray.h"
@@ -94,6 +95,11 @@ namespace scene
 		//! \param nr: Zero based index of animation.
 		virtual const c8* getAnimationName(s32 nr) const _IRR_OVERRIDE_;
 
+		//! Set how many interpolated frames are kept for reuse
+		virtual void setInterpolationCacheSize(u32 count) _IRR_OVERRIDE_;
+
+		//! Get how many interpolated frames are kept for reuse
+		virtual u32 getInterpolationCacheSize() const _IRR_OVERRIDE_;
 
 		//
 		// exposed for loader
@@ -145,9 +151,38 @@ namespace scene
 
 	private:
 
+		//! an interpolated frame kept for reuse
+		struct SInterpolation
+		{
+			SInterpolation() : Buffer(0), FirstFrame(-1), SecondFrame(-1),
+				FrameDiv(0.f), LastUse(0), ChangedID(0) {}
+
+			SMeshBuffer* Buffer;
+			u32 FirstFrame, SecondFrame;
+			f32 FrameDiv;
+			//! 0 when nothing was interpolated into Buffer yet
+			u32 LastUse;
+			//! sum of the changed ids of Buffer when it was last updated here
+			u32 ChangedID;
+		};
+
 		//! updates the interpolation buffer
 		void updateInterpolationBuffer(s32 frame, s32 startFrame, s32 endFrame);
 
+		//! decodes FrameList into Frames
+		void buildFrames();
+
+		//! copies changes of the user to InterpolationBuffer into all kept frames
+		void keepChanges();
+
+		//! decoded positions and normals of all key frames
+		CKeyFrameStreams Frames;
+
+		//! interpolated frames, InterpolationBuffer is one of them
+		core::array<SInterpolation> Interpolations;
+		u32 InterpolationCacheSize;
+		u32 InterpolationUse;
+
 		f32 FramesPerSecond;
 	};
 
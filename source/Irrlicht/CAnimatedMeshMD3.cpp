@@ -49,7 +49,8 @@ struct SMD3Shader
 
 //! Constructor
 CAnimatedMeshMD3::CAnimatedMeshMD3()
-:Mesh(0), IPolShift(0), LoopMode(0), Scaling(1.f)//, FramesPerSecond(25.f)
+:Mesh(0), IPolShift(0), LoopMode(0), Scaling(1.f), CurrentInterpolation(0),
+	InterpolationCacheSize(16), InterpolationUse(0)//, FramesPerSecond(25.f)
 {
 #ifdef _DEBUG
 	setDebugName("CAnimatedMeshMD3");
@@ -58,6 +59,11 @@ CAnimatedMeshMD3::CAnimatedMeshMD3()
 	Mesh = new SMD3Mesh();
 	MeshIPol = new SMesh();
 	setInterpolationShift(0, 0);
+
+	// the loader fills this mesh, the others are copied from it
+	SInterpolation first;
+	first.Mesh = MeshIPol;
+	Interpolations.push_back(first);
 }
 
 
@@ -66,8 +72,8 @@ CAnimatedMeshMD3::~CAnimatedMeshMD3()
 {
 	if (Mesh)
 		Mesh->drop();
-	if (MeshIPol)
-		MeshIPol->drop();
+	for (u32 i = 0; i != Interpolations.size(); ++i)
+		Interpolations[i].Mesh->drop();
 }
 
 
@@ -117,14 +123,45 @@ void CAnimatedMeshMD3::setMaterialFlag(video::E_MATERIAL_FLAG flag, bool newvalu
 void CAnimatedMeshMD3::setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint,
 		E_BUFFER_TYPE buffer)
 {
-	MeshIPol->setHardwareMappingHint(newMappingHint, buffer);
+	for (u32 i = 0; i != Interpolations.size(); ++i)
+		Interpolations[i].Mesh->setHardwareMappingHint(newMappingHint, buffer);
 }
 
 
 //! flags the meshbuffer as changed, reloads hardware buffers
 void CAnimatedMeshMD3::setDirty(E_BUFFER_TYPE buffer)
 {
-	MeshIPol->setDirty(buffer);
+	for (u32 i = 0; i != Interpolations.size(); ++i)
+		Interpolations[i].Mesh->setDirty(buffer);
+}
+
+
+//! Set how many interpolated frames are kept for reuse
+void CAnimatedMeshMD3::setInterpolationCacheSize(u32 count)
+{
+	InterpolationCacheSize = core::max_(count, 1u);
+
+	// drop the least recently used frames, but never the current one
+	while (Interpolations.size() > InterpolationCacheSize)
+	{
+		u32 oldest = CurrentInterpolation ? 0 : 1;
+		for (u32 i = oldest + 1; i != Interpolations.size(); ++i)
+		{
+			if (i != CurrentInterpolation && Interpolations[i].LastUse < Interpolations[oldest].LastUse)
+				oldest = i;
+		}
+		Interpolations[oldest].Mesh->drop();
+		Interpolations.erase(oldest);
+		if (oldest < CurrentInterpolation)
+			--CurrentInterpolation;
+	}
+}
+
+
+//! Get how many interpolated frames are kept for reuse
+u32 CAnimatedMeshMD3::getInterpolationCacheSize() const
+{
+	return InterpolationCacheSize;
 }
 
 
@@ -142,7 +179,7 @@ SMD3QuaternionTagList *CAnimatedMeshMD3::getTagList(s32 frame, s32 detailLevel,
 		return 0;
 
 	getMesh(frame, detailLevel, startFrameLoop, endFrameLoop);
-	return &TagListIPol;
+	return &Interpolations[CurrentInterpolation].TagList;
 }
 
 
@@ -192,23 +229,115 @@ IMesh* CAnimatedMeshMD3::getMesh(s32 frame, s32 detailLevel, s32 startFrameLoop,
 		frameB = core::s32_min(frameA + 1, endFrameLoop);
 	}
 
-	// build current vertex
-	for (u32 i = 0; i!= Mesh->Buffer.size(); ++i)
+	keepChanges();
+
+	// look for the frames in the interpolations kept for reuse,
+	// otherwise replace an unused or the least recently used one
+	u32 found = Interpolations.size();
+	u32 oldest = 0;
+	for (u32 i = 0; i != Interpolations.size(); ++i)
 	{
-		buildVertexArray(frameA, frameB, iPol,
-					Mesh->Buffer[i],
-					(SMeshBufferLightMap*) MeshIPol->getMeshBuffer(i));
+		const SInterpolation &ipol = Interpolations[i];
+		if (ipol.LastUse && ipol.FrameA == frameA && ipol.FrameB == frameB && ipol.IPol == iPol)
+		{
+			found = i;
+			break;
+		}
+		if (ipol.LastUse < Interpolations[oldest].LastUse)
+			oldest = i;
 	}
-	MeshIPol->recalculateBoundingBox();
 
-	// build current tags
-	buildTagArray(frameA, frameB, iPol);
+	if (found == Interpolations.size())
+	{
+		if (Interpolations[oldest].LastUse && Interpolations.size() < InterpolationCacheSize)
+		{
+			SInterpolation ipol;
+			ipol.Mesh = new SMesh();
+			for (u32 i = 0; i != MeshIPol->getMeshBufferCount(); ++i)
+			{
+				const SMeshBufferLightMap* source = (SMeshBufferLightMap*) MeshIPol->getMeshBuffer(i);
+				SMeshBufferLightMap* dest = new SMeshBufferLightMap();
+				dest->Vertices = source->Vertices;
+				dest->Indices = source->Indices;
+				dest->Material = source->Material;
+				dest->setHardwareMappingHint(source->getHardwareMappingHint_Vertex(), EBT_VERTEX);
+				dest->setHardwareMappingHint(source->getHardwareMappingHint_Index(), EBT_INDEX);
+				ipol.Mesh->addMeshBuffer(dest);
+				dest->drop();
+			}
+			ipol.TagList = Interpolations[CurrentInterpolation].TagList;
+			Interpolations.push_back(ipol);
+		}
+		else
+			found = oldest;
+
+		SInterpolation &ipol = Interpolations[found];
+		ipol.FrameA = frameA;
+		ipol.FrameB = frameB;
+		ipol.IPol = iPol;
+
+		// build current vertex
+		for (u32 i = 0; i!= Frames.size(); ++i)
+		{
+			buildVertexArray(frameA, frameB, iPol,
+						Frames[i],
+						(SMeshBufferLightMap*) ipol.Mesh->getMeshBuffer(i));
+		}
+		ipol.Mesh->recalculateBoundingBox();
+		ipol.ChangedID = getChangedID(ipol.Mesh);
+
+		// build current tags
+		buildTagArray(frameA, frameB, iPol, ipol.TagList);
+	}
+
+	SInterpolation &ipol = Interpolations[found];
+	ipol.LastUse = ++InterpolationUse;
+	if (found != CurrentInterpolation)
+	{
+		// keep the materials of the mesh returned before
+		for (u32 i = 0; i != ipol.Mesh->getMeshBufferCount(); ++i)
+			ipol.Mesh->getMeshBuffer(i)->getMaterial() = MeshIPol->getMeshBuffer(i)->getMaterial();
+		CurrentInterpolation = found;
+		MeshIPol = ipol.Mesh;
+	}
 
 	Current = candidate;
 	return MeshIPol;
 }
 
 
+//! sum of the changed ids of all buffers of a mesh
+u32 CAnimatedMeshMD3::getChangedID(const SMesh* mesh)
+{
+	u32 changedID = 0;
+	for (u32 i = 0; i != mesh->getMeshBufferCount(); ++i)
+		changedID += mesh->getMeshBuffer(i)->getChangedID_Vertex() + mesh->getMeshBuffer(i)->getChangedID_Index();
+	return changedID;
+}
+
+
+//! copies changes of the user to MeshIPol into all kept frames
+/** Vertices and indices changed without setting the buffers dirty are lost
+when another frame is returned. */
+void CAnimatedMeshMD3::keepChanges()
+{
+	if (Interpolations[CurrentInterpolation].ChangedID == getChangedID(MeshIPol))
+		return;
+
+	for (u32 i = 0; i != Interpolations.size(); ++i)
+	{
+		SMesh* mesh = Interpolations[i].Mesh;
+		if (i != CurrentInterpolation)
+		{
+			for (u32 b = 0; b != mesh->getMeshBufferCount(); ++b)
+				CKeyFrameStreams::copyUnanimated((SMeshBufferLightMap*) mesh->getMeshBuffer(b),
+					(const SMeshBufferLightMap*) MeshIPol->getMeshBuffer(b));
+		}
+		Interpolations[i].ChangedID = getChangedID(mesh);
+	}
+}
+
+
 //! create a Irrlicht MeshBuffer for a MD3 MeshBuffer
 IMeshBuffer * CAnimatedMeshMD3::createMeshBuffer(const SMD3MeshBuffer* source,
 							 io::IFileSystem* fs, video::IVideoDriver * driver)
@@ -250,49 +379,50 @@ IMeshBuffer * CAnimatedMeshMD3::createMeshBuffer(const SMD3MeshBuffer* source,
 }
 
 
-//! build final mesh's vertices from frames frameA and frameB with linear interpolation.
-void CAnimatedMeshMD3::buildVertexArray(u32 frameA, u32 frameB, f32 interpolate,
-					const SMD3MeshBuffer* source,
-					SMeshBufferLightMap* dest)
+//! decodes the vertices of all frames of a MD3 MeshBuffer
+void CAnimatedMeshMD3::buildFrames(const SMD3MeshBuffer* source, CKeyFrameStreams& frames)
 {
-	const u32 frameOffsetA = frameA * source->MeshHeader.numVertices;
-	const u32 frameOffsetB = frameB * source->MeshHeader.numVertices;
+	const u32 vertexCount = source->MeshHeader.numVertices;
 	const f32 scale = (1.f/ 64.f);
 
-	for (s32 i = 0; i != source->MeshHeader.numVertices; ++i)
+	frames.reset(Mesh->MD3Header.numFrames, vertexCount);
+	for (s32 f = 0; f != Mesh->MD3Header.numFrames; ++f)
 	{
-		video::S3DVertex2TCoords &v = dest->Vertices [ i ];
-
-		const SMD3Vertex &vA = source->Vertices [ frameOffsetA + i ];
-		const SMD3Vertex &vB = source->Vertices [ frameOffsetB + i ];
-
-		// position
-		v.Pos.X = scale * (vA.position[0] + interpolate * (vB.position[0] - vA.position[0]));
-		v.Pos.Y = scale * (vA.position[2] + interpolate * (vB.position[2] - vA.position[2]));
-		v.Pos.Z = scale * (vA.position[1] + interpolate * (vB.position[1] - vA.position[1]));
+		const SMD3Vertex* v = &source->Vertices [ f * vertexCount ];
+		for (u32 i = 0; i != vertexCount; ++i)
+		{
+			const core::vector3df n(quake3::getMD3Normal(v[i].normal[0], v[i].normal[1]));
+			frames.setVertex(f, i,
+				core::vector3df(scale * v[i].position[0], scale * v[i].position[2], scale * v[i].position[1]),
+				core::vector3df(n.X, n.Z, n.Y));
+		}
+	}
+}
 
-		// normal
-		const core::vector3df nA(quake3::getMD3Normal(vA.normal[0], vA.normal[1]));
-		const core::vector3df nB(quake3::getMD3Normal(vB.normal[0], vB.normal[1]));
 
-		v.Normal.X = nA.X + interpolate * (nB.X - nA.X);
-		v.Normal.Y = nA.Z + interpolate * (nB.Z - nA.Z);
-		v.Normal.Z = nA.Y + interpolate * (nB.Y - nA.Y);
-	}
+//! build final mesh's vertices from frames frameA and frameB with linear interpolation.
+void CAnimatedMeshMD3::buildVertexArray(u32 frameA, u32 frameB, f32 interpolate,
+					const CKeyFrameStreams& frames,
+					SMeshBufferLightMap* dest)
+{
+	if (dest->Vertices.size() >= frames.getVertexCount())
+		frames.interpolate(frameA, frameB, interpolate, dest->Vertices.pointer(), sizeof(video::S3DVertex2TCoords));
 
 	dest->recalculateBoundingBox();
+	dest->setDirty(EBT_VERTEX);
 }
 
 
 //! build final mesh's tag from frames frameA and frameB with linear interpolation.
-void CAnimatedMeshMD3::buildTagArray(u32 frameA, u32 frameB, f32 interpolate)
+void CAnimatedMeshMD3::buildTagArray(u32 frameA, u32 frameB, f32 interpolate,
+					SMD3QuaternionTagList& dest)
 {
 	const u32 frameOffsetA = frameA * Mesh->MD3Header.numTags;
 	const u32 frameOffsetB = frameB * Mesh->MD3Header.numTags;
 
 	for (s32 i = 0; i != Mesh->MD3Header.numTags; ++i)
 	{
-		SMD3QuaternionTag &d = TagListIPol [ i ];
+		SMD3QuaternionTag &d = dest [ i ];
 
 		const SMD3QuaternionTag &qA = Mesh->TagList[ frameOffsetA + i];
 		const SMD3QuaternionTag &qB = Mesh->TagList[ frameOffsetB + i];
@@ -432,10 +562,18 @@ bool CAnimatedMeshMD3::loadModelFile(u32 modelIndex, io::IReadFile* file,
 	}
 	MeshIPol->recalculateBoundingBox();
 
+	// decode the frames for the interpolation
+	Frames.clear();
+	for (i = 0; i != Mesh->Buffer.size(); ++i)
+	{
+		Frames.push_back(CKeyFrameStreams());
+		buildFrames(Mesh->Buffer[i], Frames.getLast());
+	}
+
 	// Init Tag Interpolation
 	for (i = 0; i != (u32)Mesh->MD3Header.numTags; ++i)
 	{
-		TagListIPol.push_back(Mesh->TagList[i]);
+		Interpolations[CurrentInterpolation].TagList.push_back(Mesh->TagList[i]);
 	}
 
 	return true;
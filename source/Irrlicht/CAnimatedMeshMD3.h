@@ -13,6 +13,7 @@
 #include "SMesh.h"
 #include "SMeshBuffer.h"
 #include "IQ3Shader.h"
+#include "CKeyFrameStreams.h"
 
 namespace irr
 {
@@ -37,6 +38,8 @@ namespace scene
 		virtual void setInterpolationShift(u32 shift, u32 loopMode) _IRR_OVERRIDE_;
 		virtual SMD3Mesh* getOriginalMesh() _IRR_OVERRIDE_;
 		virtual SMD3QuaternionTagList* getTagList(s32 frame, s32 detailLevel, s32 startFrameLoop, s32 endFrameLoop) _IRR_OVERRIDE_;
+		virtual void setInterpolationCacheSize(u32 count) _IRR_OVERRIDE_;
+		virtual u32 getInterpolationCacheSize() const _IRR_OVERRIDE_;
 
 		//IAnimatedMesh
 		virtual u32 getFrameCount() const _IRR_OVERRIDE_;
@@ -112,18 +115,52 @@ namespace scene
 		};
 		SCacheInfo Current;
 
+		//! an interpolated frame kept for reuse
+		struct SInterpolation
+		{
+			SInterpolation() : FrameA(-1), FrameB(-1), IPol(0.f), Mesh(0), LastUse(0), ChangedID(0) {}
+
+			s32 FrameA;
+			s32 FrameB;
+			f32 IPol;
+			SMesh* Mesh;
+			SMD3QuaternionTagList TagList;
+			//! 0 when nothing was interpolated into Mesh yet
+			u32 LastUse;
+			//! sum of the changed ids of the buffers when Mesh was last updated here
+			u32 ChangedID;
+		};
+
+		//! sum of the changed ids of all buffers of a mesh
+		static u32 getChangedID(const SMesh* mesh);
+
+		//! copies changes of the user to MeshIPol into all kept frames
+		void keepChanges();
+
+		//! interpolated frames, MeshIPol is the mesh of the current one
+		core::array<SInterpolation> Interpolations;
+		u32 CurrentInterpolation;
+		u32 InterpolationCacheSize;
+		u32 InterpolationUse;
+
 		//! return a Mesh per frame
 		SMesh* MeshIPol;
-		SMD3QuaternionTagList TagListIPol;
+
+		//! decoded positions and normals of the key frames of each buffer
+		core::array<CKeyFrameStreams> Frames;
 
 		IMeshBuffer* createMeshBuffer(const SMD3MeshBuffer* source,
 				io::IFileSystem* fs, video::IVideoDriver* driver);
 
+		//! decodes the vertices of all frames of a MD3 MeshBuffer
+		void buildFrames(const SMD3MeshBuffer* source, CKeyFrameStreams& frames);
+
 		void buildVertexArray(u32 frameA, u32 frameB, f32 interpolate,
-					const SMD3MeshBuffer* source,
+					const CKeyFrameStreams& frames,
 					SMeshBufferLightMap* dest);
 
-		void buildTagArray(u32 frameA, u32 frameB, f32 interpolate);
+		void buildTagArray(u32 frameA, u32 frameB, f32 interpolate,
+					SMD3QuaternionTagList& dest);
 		f32 FramesPerSecond;
 	};
 
@@ -206,6 +206,8 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 
 		if (JointMode == EJUOR_CONTROL)//write to mesh
 			skinnedMesh->transferJointsToMesh(JointChildSceneNodes);
+		else if (AnimationLayers.size())
+			skinnedMesh->animateMeshLayers(AnimationLayers.const_pointer(), AnimationLayers.size());
 		else
 			skinnedMesh->animateMesh(getFrameNr(), 1.0f);
 
@@ -935,6 +937,20 @@ void CAnimatedMeshSceneNode::setRenderFromIdentity(bool enable)
 }
 
 
+//! Sets layers of animation which are blended for skinned meshes
+void CAnimatedMeshSceneNode::setAnimationLayers(const core::array<ISkinnedMesh::SAnimationLayer>& layers)
+{
+	AnimationLayers = layers;
+}
+
+
+//! Returns the layers of animation, which can be changed
+core::array<ISkinnedMesh::SAnimationLayer>& CAnimatedMeshSceneNode::getAnimationLayers()
+{
+	return AnimationLayers;
+}
+
+
 //! updates the joint positions of this mesh
 void CAnimatedMeshSceneNode::animateJoints(bool CalculateAbsolutePositions)
 {
@@ -949,7 +965,10 @@ void CAnimatedMeshSceneNode::animateJoints(bool CalculateAbsolutePositions)
 		CSkinnedMesh* skinnedMesh=reinterpret_cast<CSkinnedMesh*>(Mesh);
 
 		skinnedMesh->transferOnlyJointsHintsToMesh( JointChildSceneNodes );
-		skinnedMesh->animateMesh(frame, 1.0f);
+		if (AnimationLayers.size())
+			skinnedMesh->animateMeshLayers(AnimationLayers.const_pointer(), AnimationLayers.size());
+		else
+			skinnedMesh->animateMesh(frame, 1.0f);
 		skinnedMesh->recoverJointsFromMesh( JointChildSceneNodes);
 
 		//-----------------------------------------
@@ -1101,6 +1120,7 @@ ISceneNode* CAnimatedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager*
 	newNode->TransitionTime = TransitionTime;
 	newNode->Transiting = Transiting;
 	newNode->TransitingBlend = TransitingBlend;
+	newNode->AnimationLayers = AnimationLayers;
 	newNode->Looping = Looping;
 	newNode->ReadOnlyMaterials = ReadOnlyMaterials;
 	newNode->LoopCallBack = LoopCallBack;
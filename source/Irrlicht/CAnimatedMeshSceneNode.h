@@ -155,6 +155,12 @@ namespace scene
 		//! render mesh ignoring its transformation. Used with ragdolls. (culling is unaffected)
 		virtual void setRenderFromIdentity( bool On ) _IRR_OVERRIDE_;
 
+		//! Sets layers of animation which are blended for skinned meshes
+		virtual void setAnimationLayers(const core::array<ISkinnedMesh::SAnimationLayer>& layers) _IRR_OVERRIDE_;
+
+		//! Returns the layers of animation, which can be changed
+		virtual core::array<ISkinnedMesh::SAnimationLayer>& getAnimationLayers() _IRR_OVERRIDE_;
+
 		//! Creates a clone of this scene node and its children.
 		/** \param newParent An optional new parent.
 		\param newManager An optional new scene manager.
@@ -200,6 +206,8 @@ namespace scene
 		core::array<IBoneSceneNode* > JointChildSceneNodes;
 		core::array<core::matrix4> PretransitingSave;
 
+		core::array<ISkinnedMesh::SAnimationLayer> AnimationLayers;
+
 		// Quake3 Model
 		struct SMD3Special : public virtual IReferenceCounted
 		{
@@ -44,6 +44,94 @@ void CAttributes::clear()
 		Attributes[i]->drop();
 
 	Attributes.clear();
+	NameIndex.clear();
+}
+
+
+namespace
+{
+	//! Below this number of attributes names are searched linearly
+	const u32 NAME_INDEX_MIN_ATTRIBUTES = 8;
+
+	//! FNV-1a hash of an attribute name
+	inline u32 hashAttributeName(const c8* name)
+	{
+		u32 hash = 2166136261u;
+		while (*name)
+		{
+			hash ^= (u8)*name++;
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+}
+
+
+//! Appends an attribute and adds it to the name index
+void CAttributes::addAttribute(IAttribute* attribute)
+{
+	Attributes.push_back(attribute);
+
+	if (NameIndex.empty())
+	{
+		if (Attributes.size() >= NAME_INDEX_MIN_ATTRIBUTES)
+			rebuildNameIndex();
+	}
+	else if (Attributes.size()*2 > NameIndex.size())
+		rebuildNameIndex();
+	else
+		insertIntoNameIndex(Attributes.size()-1);
+}
+
+
+//! Removes an attribute and updates the name index
+void CAttributes::removeAttribute(u32 index)
+{
+	Attributes[index]->drop();
+	Attributes.erase(index);
+
+	// indices behind the removed one have changed
+	if (!NameIndex.empty())
+	{
+		if (Attributes.size() < NAME_INDEX_MIN_ATTRIBUTES)
+			NameIndex.clear();
+		else
+			rebuildNameIndex();
+	}
+}
+
+
+//! Adds the attribute at index to the name index unless an earlier attribute has the same name
+void CAttributes::insertIntoNameIndex(u32 index)
+{
+	const core::stringc& name = Attributes[index]->Name;
+	const u32 mask = NameIndex.size()-1;
+	u32 slot = hashAttributeName(name.c_str()) & mask;
+
+	while (NameIndex[slot] != -1)
+	{
+		// lookups return the first attribute with a name, like a linear search
+		if (Attributes[NameIndex[slot]]->Name == name)
+			return;
+		slot = (slot+1) & mask;
+	}
+	NameIndex[slot] = (s32)index;
+}
+
+
+//! Recreates the name index for all attributes
+void CAttributes::rebuildNameIndex()
+{
+	u32 size = 32;
+	while (size < Attributes.size()*4)
+		size <<= 1;
+
+	NameIndex.set_used(size);
+	for (u32 i=0; i<size; ++i)
+		NameIndex[i] = -1;
+
+	for (u32 i=0; i<Attributes.size(); ++i)
+		insertIntoNameIndex(i);
 }
 
 
@@ -52,23 +140,20 @@ void CAttributes::clear()
 //! \param value: Value for the attribute. Set this to 0 to delete the attribute
 void CAttributes::setAttribute(const c8* attributeName, const c8* value)
 {
-	for (u32 i=0; i<Attributes.size(); ++i)
-		if (Attributes[i]->Name == attributeName)
-		{
-			if (!value)
-			{
-				Attributes[i]->drop();
-				Attributes.erase(i);
-			}
-			else
-				Attributes[i]->setString(value);
+	const s32 i = findAttribute(attributeName);
+	if (i >= 0)
+	{
+		if (!value)
+			removeAttribute(i);
+		else
+			Attributes[i]->setString(value);
 
-			return;
-		}
+		return;
+	}
 
 	if (value)
 	{
-		Attributes.push_back(new CStringAttribute(attributeName, value));
+		addAttribute(new CStringAttribute(attributeName, value));
 	}
 }
 
@@ -118,25 +203,20 @@ core::stringc CAttributes::getAttributeAsString(s32 index) const
 //! \param value: Value for the attribute. Set this to 0 to delete the attribute
 void CAttributes::setAttribute(const c8* attributeName, const wchar_t* value)
 {
-	for (u32 i=0; i<Attributes.size(); ++i)
+	const s32 i = findAttribute(attributeName);
+	if (i >= 0)
 	{
-		if (Attributes[i]->Name == attributeName)
-		{
-			if (!value)
-			{
-				Attributes[i]->drop();
-				Attributes.erase(i);
-			}
-			else
-				Attributes[i]->setString(value);
+		if (!value)
+			removeAttribute(i);
+		else
+			Attributes[i]->setString(value);
 
-			return;
-		}
+		return;
 	}
 
 	if (value)
 	{
-		Attributes.push_back(new CStringAttribute(attributeName, value));
+		addAttribute(new CStringAttribute(attributeName, value));
 	}
 }
 
@@ -183,7 +263,7 @@ core::stringw CAttributes::getAttributeAsStringW(s32 index) const
 //! Adds an attribute as an array of wide strings
 void CAttributes::addArray(const c8* attributeName, const core::array<core::stringw>& value)
 {
-	Attributes.push_back(new CStringWArrayAttribute(attributeName, value));
+	addAttribute(new CStringWArrayAttribute(attributeName, value));
 }
 
 //! Sets an attribute value as an array of wide strings.
@@ -194,7 +274,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::array<core::
 		att->setArray(value);
 	else
 	{
-		Attributes.push_back(new CStringWArrayAttribute(attributeName, value));
+		addAttribute(new CStringWArrayAttribute(attributeName, value));
 	}
 }
 
@@ -232,9 +312,27 @@ void CAttributes::setAttribute(s32 index, const core::array<core::stringw>& valu
 //! Returns attribute index from name, -1 if not found
 s32 CAttributes::findAttribute(const c8* attributeName) const
 {
-	for (u32 i=0; i<Attributes.size(); ++i)
-		if (Attributes[i]->Name == attributeName)
-			return i;
+	if (!attributeName)
+		return -1;
+
+	if (NameIndex.empty())
+	{
+		for (u32 i=0; i<Attributes.size(); ++i)
+			if (Attributes[i]->Name == attributeName)
+				return i;
+
+		return -1;
+	}
+
+	const u32 mask = NameIndex.size()-1;
+	u32 slot = hashAttributeName(attributeName) & mask;
+
+	while (NameIndex[slot] != -1)
+	{
+		if (Attributes[NameIndex[slot]]->Name == attributeName)
+			return NameIndex[slot];
+		slot = (slot+1) & mask;
+	}
 
 	return -1;
 }
@@ -242,11 +340,8 @@ s32 CAttributes::findAttribute(const c8* attributeName) const
 
 IAttribute* CAttributes::getAttributeP(const c8* attributeName) const
 {
-	for (u32 i=0; i<Attributes.size(); ++i)
-		if (Attributes[i]->Name == attributeName)
-			return Attributes[i];
-
-	return 0;
+	const s32 i = findAttribute(attributeName);
+	return i >= 0 ? Attributes[i] : 0;
 }
 
 
@@ -258,7 +353,7 @@ void CAttributes::setAttribute(const c8* attributeName, bool value)
 		att->setBool(value);
 	else
 	{
-		Attributes.push_back(new CBoolAttribute(attributeName, value));
+		addAttribute(new CBoolAttribute(attributeName, value));
 	}
 }
 
@@ -283,7 +378,7 @@ void CAttributes::setAttribute(const c8* attributeName, s32 value)
 		att->setInt(value);
 	else
 	{
-		Attributes.push_back(new CIntAttribute(attributeName, value));
+		addAttribute(new CIntAttribute(attributeName, value));
 	}
 }
 
@@ -307,7 +402,7 @@ void CAttributes::setAttribute(const c8* attributeName, f32 value)
 	if (att)
 		att->setFloat(value);
 	else
-		Attributes.push_back(new CFloatAttribute(attributeName, value));
+		addAttribute(new CFloatAttribute(attributeName, value));
 }
 
 //! Gets a attribute as integer value
@@ -330,7 +425,7 @@ void CAttributes::setAttribute(const c8* attributeName, video::SColor value)
 	if (att)
 		att->setColor(value);
 	else
-		Attributes.push_back(new CColorAttribute(attributeName, value));
+		addAttribute(new CColorAttribute(attributeName, value));
 }
 
 //! Gets an attribute as color
@@ -352,7 +447,7 @@ void CAttributes::setAttribute(const c8* attributeName, video::SColorf value)
 	if (att)
 		att->setColor(value);
 	else
-		Attributes.push_back(new CColorfAttribute(attributeName, value));
+		addAttribute(new CColorfAttribute(attributeName, value));
 }
 
 //! Gets an attribute as floating point color
@@ -374,7 +469,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::position2di&
 	if (att)
 		att->setPosition(value);
 	else
-		Attributes.push_back(new CPosition2DAttribute(attributeName, value));
+		addAttribute(new CPosition2DAttribute(attributeName, value));
 }
 
 //! Gets an attribute as 2d position
@@ -396,7 +491,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::rect<s32>& v
 	if (att)
 		att->setRect(value);
 	else
-		Attributes.push_back(new CRectAttribute(attributeName, value));
+		addAttribute(new CRectAttribute(attributeName, value));
 }
 
 //! Gets an attribute as rectangle
@@ -418,7 +513,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::dimension2d<
 	if (att)
 		att->setDimension2d(value);
 	else
-		Attributes.push_back(new CDimension2dAttribute(attributeName, value));
+		addAttribute(new CDimension2dAttribute(attributeName, value));
 }
 
 //! Gets an attribute as dimension2d
@@ -440,7 +535,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::vector3df& v
 	if (att)
 		att->setVector(value);
 	else
-		Attributes.push_back(new CVector3DAttribute(attributeName, value));
+		addAttribute(new CVector3DAttribute(attributeName, value));
 }
 
 //! Sets a attribute as vector
@@ -450,7 +545,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::vector2df& v
 	if (att)
 		att->setVector2d(value);
 	else
-		Attributes.push_back(new CVector2DAttribute(attributeName, value));
+		addAttribute(new CVector2DAttribute(attributeName, value));
 }
 
 //! Gets an attribute as vector
@@ -482,7 +577,7 @@ void CAttributes::setAttribute(const c8* attributeName, void* data, s32 dataSize
 	if (att)
 		att->setBinary(data, dataSizeInBytes);
 	else
-		Attributes.push_back(new CBinaryAttribute(attributeName, data, dataSizeInBytes));
+		addAttribute(new CBinaryAttribute(attributeName, data, dataSizeInBytes));
 }
 
 //! Gets an attribute as binary data
@@ -501,7 +596,7 @@ void CAttributes::setAttribute(const c8* attributeName, const char* enumValue, c
 	if (att)
 		att->setEnum(enumValue, enumerationLiterals);
 	else
-		Attributes.push_back(new CEnumAttribute(attributeName, enumValue, enumerationLiterals));
+		addAttribute(new CEnumAttribute(attributeName, enumValue, enumerationLiterals));
 }
 
 //! Gets an attribute as enumeration
@@ -552,7 +647,7 @@ void CAttributes::setAttribute(const c8* attributeName, video::ITexture* value,
 	if (att)
 		att->setTexture(value, filename);
 	else
-		Attributes.push_back(new CTextureAttribute(attributeName, value, Driver, filename));
+		addAttribute(new CTextureAttribute(attributeName, value, Driver, filename));
 }
 
 
@@ -796,37 +891,37 @@ void CAttributes::getAttributeEnumerationLiteralsOfEnumeration(s32 index, core::
 //! Adds an attribute as integer
 void CAttributes::addInt(const c8* attributeName, s32 value)
 {
-	Attributes.push_back(new CIntAttribute(attributeName, value));
+	addAttribute(new CIntAttribute(attributeName, value));
 }
 
 //! Adds an attribute as float
 void CAttributes::addFloat(const c8* attributeName, f32 value)
 {
-	Attributes.push_back(new CFloatAttribute(attributeName, value));
+	addAttribute(new CFloatAttribute(attributeName, value));
 }
 
 //! Adds an attribute as string
 void CAttributes::addString(const c8* attributeName, const char* value)
 {
-	Attributes.push_back(new CStringAttribute(attributeName, value));
+	addAttribute(new CStringAttribute(attributeName, value));
 }
 
 //! Adds an attribute as wchar string
 void CAttributes::addString(const c8* attributeName, const wchar_t* value)
 {
-	Attributes.push_back(new CStringAttribute(attributeName, value));
+	addAttribute(new CStringAttribute(attributeName, value));
 }
 
 //! Adds an attribute as bool
 void CAttributes::addBool(const c8* attributeName, bool value)
 {
-	Attributes.push_back(new CBoolAttribute(attributeName, value));
+	addAttribute(new CBoolAttribute(attributeName, value));
 }
 
 //! Adds an attribute as enum
 void CAttributes::addEnum(const c8* attributeName, const char* enumValue, const char* const* enumerationLiterals)
 {
-	Attributes.push_back(new CEnumAttribute(attributeName, enumValue, enumerationLiterals));
+	addAttribute(new CEnumAttribute(attributeName, enumValue, enumerationLiterals));
 }
 
 //! Adds an attribute as enum
@@ -839,56 +934,56 @@ void CAttributes::addEnum(const c8* attributeName, s32 enumValue, const char* co
 //! Adds an attribute as color
 void CAttributes::addColor(const c8* attributeName, video::SColor value)
 {
-	Attributes.push_back(new CColorAttribute(attributeName, value));
+	addAttribute(new CColorAttribute(attributeName, value));
 }
 
 //! Adds an attribute as floating point color
 void CAttributes::addColorf(const c8* attributeName, video::SColorf value)
 {
-	Attributes.push_back(new CColorfAttribute(attributeName, value));
+	addAttribute(new CColorfAttribute(attributeName, value));
 }
 
 //! Adds an attribute as 3d vector
 void CAttributes::addVector3d(const c8* attributeName, const core::vector3df& value)
 {
-	Attributes.push_back(new CVector3DAttribute(attributeName, value));
+	addAttribute(new CVector3DAttribute(attributeName, value));
 }
 
 //! Adds an attribute as 2d vector
 void CAttributes::addVector2d(const c8* attributeName, const core::vector2df& value)
 {
-	Attributes.push_back(new CVector2DAttribute(attributeName, value));
+	addAttribute(new CVector2DAttribute(attributeName, value));
 }
 
 
 //! Adds an attribute as 2d position
 void CAttributes::addPosition2d(const c8* attributeName, const core::position2di& value)
 {
-	Attributes.push_back(new CPosition2DAttribute(attributeName, value));
+	addAttribute(new CPosition2DAttribute(attributeName, value));
 }
 
 //! Adds an attribute as rectangle
 void CAttributes::addRect(const c8* attributeName, const core::rect<s32>& value)
 {
-	Attributes.push_back(new CRectAttribute(attributeName, value));
+	addAttribute(new CRectAttribute(attributeName, value));
 }
 
 //! Adds an attribute as dimension2d
 void CAttributes::addDimension2d(const c8* attributeName, const core::dimension2d<u32>& value)
 {
-	Attributes.push_back(new CDimension2dAttribute(attributeName, value));
+	addAttribute(new CDimension2dAttribute(attributeName, value));
 }
 
 //! Adds an attribute as binary data
 void CAttributes::addBinary(const c8* attributeName, void* data, s32 dataSizeInBytes)
 {
-	Attributes.push_back(new CBinaryAttribute(attributeName, data, dataSizeInBytes));
+	addAttribute(new CBinaryAttribute(attributeName, data, dataSizeInBytes));
 }
 
 //! Adds an attribute as texture reference
 void CAttributes::addTexture(const c8* attributeName, video::ITexture* texture, const io::path& filename)
 {
-	Attributes.push_back(new CTextureAttribute(attributeName, texture, Driver, filename));
+	addAttribute(new CTextureAttribute(attributeName, texture, Driver, filename));
 }
 
 //! Returns if an attribute with a name exists
@@ -1010,7 +1105,7 @@ void CAttributes::setAttribute(s32 index, video::ITexture* texture, const io::pa
 //! Adds an attribute as matrix
 void CAttributes::addMatrix(const c8* attributeName, const core::matrix4& v)
 {
-	Attributes.push_back(new CMatrixAttribute(attributeName, v));
+	addAttribute(new CMatrixAttribute(attributeName, v));
 }
 
 
@@ -1021,7 +1116,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::matrix4& v)
 	if (att)
 		att->setMatrix(v);
 	else
-		Attributes.push_back(new CMatrixAttribute(attributeName, v));
+		addAttribute(new CMatrixAttribute(attributeName, v));
 }
 
 //! Gets an attribute as a matrix4
@@ -1055,7 +1150,7 @@ void CAttributes::setAttribute(s32 index, const core::matrix4& v)
 //! Adds an attribute as quaternion
 void CAttributes::addQuaternion(const c8* attributeName, const core::quaternion& v)
 {
-	Attributes.push_back(new CQuaternionAttribute(attributeName, v));
+	addAttribute(new CQuaternionAttribute(attributeName, v));
 }
 
 
@@ -1067,7 +1162,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::quaternion&
 		att->setQuaternion(v);
 	else
 	{
-		Attributes.push_back(new CQuaternionAttribute(attributeName, v));
+		addAttribute(new CQuaternionAttribute(attributeName, v));
 	}
 }
 
@@ -1102,7 +1197,7 @@ if (index >= 0 && index < (s32)Attributes.size() )
 //! Adds an attribute as axis aligned bounding box
 void CAttributes::addBox3d(const c8* attributeName, const core::aabbox3df& v)
 {
-	Attributes.push_back(new CBBoxAttribute(attributeName, v));
+	addAttribute(new CBBoxAttribute(attributeName, v));
 }
 
 //! Sets an attribute as axis aligned bounding box
@@ -1113,7 +1208,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::aabbox3df& v
 		att->setBBox(v);
 	else
 	{
-		Attributes.push_back(new CBBoxAttribute(attributeName, v));
+		addAttribute(new CBBoxAttribute(attributeName, v));
 	}
 }
 
@@ -1148,7 +1243,7 @@ if (index >= 0 && index < (s32)Attributes.size() )
 //! Adds an attribute as 3d plane
 void CAttributes::addPlane3d(const c8* attributeName, const core::plane3df& v)
 {
-	Attributes.push_back(new CPlaneAttribute(attributeName, v));
+	addAttribute(new CPlaneAttribute(attributeName, v));
 }
 
 //! Sets an attribute as 3d plane
@@ -1159,7 +1254,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::plane3df& v)
 		att->setPlane(v);
 	else
 	{
-		Attributes.push_back(new CPlaneAttribute(attributeName, v));
+		addAttribute(new CPlaneAttribute(attributeName, v));
 	}
 }
 
@@ -1194,7 +1289,7 @@ void CAttributes::setAttribute(s32 index, const core::plane3df& v)
 //! Adds an attribute as 3d triangle
 void CAttributes::addTriangle3d(const c8* attributeName, const core::triangle3df& v)
 {
-	Attributes.push_back(new CTriangleAttribute(attributeName, v));
+	addAttribute(new CTriangleAttribute(attributeName, v));
 }
 
 //! Sets an attribute as 3d triangle
@@ -1205,7 +1300,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::triangle3df&
 		att->setTriangle(v);
 	else
 	{
-		Attributes.push_back(new CTriangleAttribute(attributeName, v));
+		addAttribute(new CTriangleAttribute(attributeName, v));
 	}
 }
 
@@ -1241,7 +1336,7 @@ void CAttributes::setAttribute(s32 index, const core::triangle3df& v)
 //! Adds an attribute as a 2d line
 void CAttributes::addLine2d(const c8* attributeName, const core::line2df& v)
 {
-	Attributes.push_back(new CLine2dAttribute(attributeName, v));
+	addAttribute(new CLine2dAttribute(attributeName, v));
 }
 
 //! Sets an attribute as a 2d line
@@ -1252,7 +1347,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::line2df& v)
 		att->setLine2d(v);
 	else
 	{
-		Attributes.push_back(new CLine2dAttribute(attributeName, v));
+		addAttribute(new CLine2dAttribute(attributeName, v));
 	}
 }
 
@@ -1287,7 +1382,7 @@ void CAttributes::setAttribute(s32 index, const core::line2df& v)
 //! Adds an attribute as a 3d line
 void CAttributes::addLine3d(const c8* attributeName, const core::line3df& v)
 {
-	Attributes.push_back(new CLine3dAttribute(attributeName, v));
+	addAttribute(new CLine3dAttribute(attributeName, v));
 }
 
 //! Sets an attribute as a 3d line
@@ -1298,7 +1393,7 @@ void CAttributes::setAttribute(const c8* attributeName, const core::line3df& v)
 		att->setLine3d(v);
 	else
 	{
-		Attributes.push_back(new CLine3dAttribute(attributeName, v));
+		addAttribute(new CLine3dAttribute(attributeName, v));
 	}
 }
 
@@ -1335,7 +1430,7 @@ void CAttributes::setAttribute(s32 index, const core::line3df& v)
 //! Adds an attribute as user pointer
 void CAttributes::addUserPointer(const c8* attributeName, void* userPointer)
 {
-	Attributes.push_back(new CUserPointerAttribute(attributeName, userPointer));
+	addAttribute(new CUserPointerAttribute(attributeName, userPointer));
 }
 
 //! Sets an attribute as user pointer
@@ -1346,7 +1441,7 @@ void CAttributes::setAttribute(const c8* attributeName, void* userPointer)
 		att->setUserPointer(userPointer);
 	else
 	{
-		Attributes.push_back(new CUserPointerAttribute(attributeName, userPointer));
+		addAttribute(new CUserPointerAttribute(attributeName, userPointer));
 	}
 }
 
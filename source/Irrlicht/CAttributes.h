@@ -724,8 +724,25 @@ protected:
 
 	void readAttributeFromXML(io::IXMLReader* reader);
 
+	//! Appends an attribute and adds it to the name index
+	void addAttribute(IAttribute* attribute);
+
+	//! Removes an attribute and updates the name index
+	void removeAttribute(u32 index);
+
+	//! Adds the attribute at index to the name index unless an earlier attribute has the same name
+	void insertIntoNameIndex(u32 index);
+
+	//! Recreates the name index for all attributes
+	void rebuildNameIndex();
+
 	core::array<IAttribute*> Attributes;
 
+	//! Hash table with indices into Attributes for lookups by name, -1 marks empty slots.
+	/** Open addressing with linear probing, the size is a power of 2.
+	Stays empty for small lists where a linear search is faster. */
+	core::array<s32> NameIndex;
+
 	IAttribute* getAttributeP(const c8* attributeName) const;
 
 	video::IVideoDriver* Driver;
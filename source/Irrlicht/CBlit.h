@@ -6,6 +6,11 @@
 #define _C_BLIT_H_INCLUDED_
 
 #include "SoftwareDriver2_helper.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include "ColorSSE2.h"
+#endif
 
 namespace irr
 {
@@ -33,7 +38,7 @@ namespace irr
 		float x_stretch;
 		float y_stretch;
 
-		SBlitJob() : stretch(false) {}
+		SBlitJob() : src(0), dst(0), stretch(false) {}
 	};
 
 	// Bitfields Cohen Sutherland
@@ -206,6 +211,226 @@ inline u32 PixelLerp32(const u32 source, const u32 value)
 }
 
 
+/*
+	Row kernels of the hot 32 bit blitters.
+	The SSE2 versions work on 4 pixels with 16 bit per channel and give
+	the same results as the scalar pixel functions used for the rest of a row.
+*/
+#ifdef _IRR_COMPILE_WITH_SSE2_
+
+//! alpha of both pixels in all their channels, stretched to [0;256] like extractAlpha
+static inline __m128i blitAlpha16(__m128i c)
+{
+	c = _mm_shufflelo_epi16(c, _MM_SHUFFLE(3,3,3,3));
+	c = _mm_shufflehi_epi16(c, _MM_SHUFFLE(3,3,3,3));
+	return _mm_add_epi16(c, _mm_srli_epi16(c, 7));
+}
+
+//! dest * ( 1 - alpha ) + source * alpha for all channels, alpha [0;256]
+static inline __m128i blitLerp16(__m128i dest, __m128i source, __m128i alpha)
+{
+	const __m128i invAlpha = _mm_sub_epi16(_mm_set1_epi16(256), alpha);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dest, invAlpha), _mm_mullo_epi16(source, alpha)), 8);
+}
+
+//! source * color per channel as PixelMul32_2
+static inline __m128i blitMul16(__m128i source, __m128i color)
+{
+	return _mm_srli_epi16(_mm_mullo_epi16(source, color), 8);
+}
+
+//! alpha premultiplied color with full alpha, as used for 16 bit targets
+static inline __m128i blitPremultiply32(__m128i c)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_or_si128(c, _mm_set1_epi32(0xFF000000));
+	const __m128i lo = blitMul16(_mm_unpacklo_epi8(opaque, zero), blitAlpha16(_mm_unpacklo_epi8(c, zero)));
+	const __m128i hi = blitMul16(_mm_unpackhi_epi8(opaque, zero), blitAlpha16(_mm_unpackhi_epi8(c, zero)));
+	return _mm_packus_epi16(lo, hi);
+}
+
+#endif // _IRR_COMPILE_WITH_SSE2_
+
+//! dst = PixelBlend32( dst, src )
+static inline void blendRow32(u32* dst, const u32* src, u32 count)
+{
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i sl = _mm_unpacklo_epi8(s, zero);
+		const __m128i sh = _mm_unpackhi_epi8(s, zero);
+		__m128i c = _mm_packus_epi16(blitLerp16(_mm_unpacklo_epi8(d, zero), sl, blitAlpha16(sl)),
+			blitLerp16(_mm_unpackhi_epi8(d, zero), sh, blitAlpha16(sh)));
+
+		// alpha of the source, the destination is kept where the source is transparent
+		const __m128i sa = _mm_and_si128(s, alphaMask);
+		c = _mm_or_si128(_mm_andnot_si128(alphaMask, c), sa);
+		const __m128i keep = _mm_cmpeq_epi32(sa, zero);
+		c = _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, c));
+		_mm_storeu_si128((__m128i*)(dst + i), c);
+	}
+#endif
+	for ( ; i < count; ++i )
+		dst[i] = PixelBlend32( dst[i], src[i] );
+}
+
+//! dst = PixelBlend32( dst, PixelMul32_2( src, color ) )
+static inline void blendColorRow32(u32* dst, const u32* src, u32 count, u32 color)
+{
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i sl = blitMul16(_mm_unpacklo_epi8(s, zero), color16);
+		const __m128i sh = blitMul16(_mm_unpackhi_epi8(s, zero), color16);
+		__m128i c = _mm_packus_epi16(blitLerp16(_mm_unpacklo_epi8(d, zero), sl, blitAlpha16(sl)),
+			blitLerp16(_mm_unpackhi_epi8(d, zero), sh, blitAlpha16(sh)));
+
+		const __m128i sa = _mm_and_si128(_mm_packus_epi16(sl, sh), alphaMask);
+		c = _mm_or_si128(_mm_andnot_si128(alphaMask, c), sa);
+		const __m128i keep = _mm_cmpeq_epi32(sa, zero);
+		c = _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, c));
+		_mm_storeu_si128((__m128i*)(dst + i), c);
+	}
+#endif
+	for ( ; i < count; ++i )
+		dst[i] = PixelBlend32( dst[i], PixelMul32_2( src[i], color ) );
+}
+
+//! dst = PixelCombine32( dst, PixelMul32_2( src, color ) )
+static inline void combineColorRow32(u32* dst, const u32* src, u32 count, u32 color)
+{
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i part[2];
+		for ( u32 p = 0; p < 2; ++p )
+		{
+			const __m128i s16 = blitMul16(p ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero), color16);
+			const __m128i d16 = p ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+			const __m128i alpha = blitAlpha16(s16);
+
+			// alpha = sourceAlpha + destAlpha * ( 1 - sourceAlpha )
+			const __m128i a16 = _mm_srli_epi16(_mm_add_epi16(_mm_slli_epi16(s16, 8),
+				_mm_mullo_epi16(d16, _mm_sub_epi16(_mm_set1_epi16(256), alpha))), 8);
+			const __m128i c16 = blitLerp16(d16, s16, alpha);
+			part[p] = _mm_or_si128(_mm_and_si128(alphaLanes, a16), _mm_andnot_si128(alphaLanes, c16));
+		}
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(part[0], part[1]));
+	}
+#endif
+	for ( ; i < count; ++i )
+		dst[i] = PixelCombine32( dst[i], PixelMul32_2( src[i], color ) );
+}
+
+//! dst = PixelBlendPremultiplied32( dst, PixelMul32_2( src, color ) ), src is kept for a white color
+static inline void blendPremultipliedRow32(u32* dst, const u32* src, u32 count, u32 color)
+{
+	const bool modulate = color != 0xFFFFFFFF;
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	const __m128i one = _mm_set1_epi16(256);
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i sl = _mm_unpacklo_epi8(s, zero);
+		__m128i sh = _mm_unpackhi_epi8(s, zero);
+		if ( modulate )
+		{
+			sl = blitMul16(sl, color16);
+			sh = blitMul16(sh, color16);
+		}
+
+		// dest * ( 1 - sourceAlpha ) + source, saturated
+		const __m128i dl = blitMul16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(one, blitAlpha16(sl)));
+		const __m128i dh = blitMul16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(one, blitAlpha16(sh)));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epu8(_mm_packus_epi16(dl, dh), _mm_packus_epi16(sl, sh)));
+	}
+#endif
+	for ( ; i < count; ++i )
+		dst[i] = PixelBlendPremultiplied32( dst[i], modulate ? PixelMul32_2( src[i], color ) : src[i] );
+}
+
+//! dst = alpha of color | PixelBlend32( dst, color, alpha )
+static inline void blendConstantRow32(u32* dst, u32 count, u32 color)
+{
+	const u32 alpha = extractAlpha( color );
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+	const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	const __m128i alpha16 = _mm_set1_epi16((s16)alpha);
+	const __m128i colorAlpha = _mm_set1_epi32(color & 0xFF000000);
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		const __m128i c = _mm_packus_epi16(blitLerp16(_mm_unpacklo_epi8(d, zero), color16, alpha16),
+			blitLerp16(_mm_unpackhi_epi8(d, zero), color16, alpha16));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_andnot_si128(alphaMask, c), colorAlpha));
+	}
+#endif
+	for ( ; i < count; ++i )
+		dst[i] = (color & 0xFF000000 ) | PixelBlend32( dst[i], color, alpha );
+}
+
+//! dst = A1R5G5B5toA8R8G8B8( src )
+static inline void convertRow16to32(u32* dst, const u16* src, u32 count)
+{
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128i zero = _mm_setzero_si128();
+	for ( ; i + 8 <= count; i += 8 )
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		_mm_storeu_si128((__m128i*)(dst + i), video::expandA1R5G5B5(_mm_unpacklo_epi16(s, zero)));
+		_mm_storeu_si128((__m128i*)(dst + i + 4), video::expandA1R5G5B5(_mm_unpackhi_epi16(s, zero)));
+	}
+#endif
+	for ( ; i < count; ++i )
+		dst[i] = video::A1R5G5B5toA8R8G8B8( src[i] );
+}
+
+//! dst = A8R8G8B8toA1R5G5B5 of the alpha premultiplied src
+static inline void convertRow32to16(u16* dst, const u32* src, u32 count)
+{
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	for ( ; i + 8 <= count; i += 8 )
+	{
+		const __m128i lo = video::reduceToA1R5G5B5(blitPremultiply32(_mm_loadu_si128((const __m128i*)(src + i))));
+		const __m128i hi = video::reduceToA1R5G5B5(blitPremultiply32(_mm_loadu_si128((const __m128i*)(src + i + 4))));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(video::signExtend16(lo), video::signExtend16(hi)));
+	}
+#endif
+	for ( ; i < count; ++i )
+	{
+		//16 bit Blitter depends on pre-multiplied color
+		const u32 s = PixelLerp32( src[i] | 0xFF000000, extractAlpha( src[i] ) );
+		dst[i] = video::A8R8G8B8toA1R5G5B5( s );
+	}
+}
+
+
 /*
 */
 static void RenderLine32_Decal(video::IImage *t,
@@ -538,12 +763,7 @@ static void executeBlit_TextureCopy_32_to_16( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
-			{
-				//16 bit Blitter depends on pre-multiplied color
-				const u32 s = PixelLerp32( src[dx] | 0xFF000000, extractAlpha( src[dx] ) );
-				dst[dx] = video::A8R8G8B8toA1R5G5B5( s );
-			}
+			convertRow32to16( dst, src, w );
 
 			src = (u32*) ( (u8*) (src) + job->srcPitch );
 			dst = (u16*) ( (u8*) (dst) + job->dstPitch );
@@ -627,10 +847,7 @@ static void executeBlit_TextureCopy_16_to_32( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
-			{
-				dst[dx] = video::A1R5G5B5toA8R8G8B8( src[dx] );
-			}
+			convertRow16to32( dst, src, w );
 
 			src = (u16*) ( (u8*) (src) + job->srcPitch );
 			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
@@ -863,10 +1080,7 @@ static void executeBlit_TextureBlend_32_to_32( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
-			{
-				dst[dx] = PixelBlend32( dst[dx], src[dx] );
-			}
+			blendRow32( dst, src, w );
 			src = (u32*) ( (u8*) (src) + job->srcPitch );
 			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
 		}
@@ -905,10 +1119,7 @@ static void executeBlit_TextureBlendColor_32_to_32( const SBlitJob * job )
 
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
-		{
-			dst[dx] = PixelBlend32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
-		}
+		blendColorRow32( dst, src, job->width, job->argb );
 		src = (u32*) ( (u8*) (src) + job->srcPitch );
 		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
 	}
@@ -968,15 +1179,9 @@ static void executeBlit_ColorAlpha_32_to_32( const SBlitJob * job )
 {
 	u32 *dst = (u32*) job->dst;
 
-	const u32 alpha = extractAlpha( job->argb );
-	const u32 src = job->argb;
-
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
-		{
-			dst[dx] = (job->argb & 0xFF000000 ) | PixelBlend32( dst[dx], src, alpha );
-		}
+		blendConstantRow32( dst, job->width, job->argb );
 		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
 	}
 }
@@ -1130,17 +1335,100 @@ static void executeBlit_TextureCombineColor_32_to_32( const SBlitJob * job )
 	u32 *src = (u32*) job->src;
 	u32 *dst = (u32*) job->dst;
 
+	if (job->stretch)
+	{
+		const float wscale = 1.f/job->x_stretch;
+		const float hscale = 1.f/job->y_stretch;
+		for ( s32 dy = 0; dy != job->height; ++dy )
+		{
+			const u32 src_y = (u32)(dy*hscale);
+			src = (u32*) ( (u8*) (job->src) + job->srcPitch*src_y );
+
+			for ( s32 dx = 0; dx != job->width; ++dx )
+			{
+				const u32 src_x = (u32)(dx*wscale);
+				dst[dx] = PixelCombine32( dst[dx], PixelMul32_2( src[src_x], job->argb ) );
+			}
+
+			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+		}
+		return;
+	}
+
 	for ( s32 dy = 0; dy != job->height; ++dy )
 	{
-		for ( s32 dx = 0; dx != job->width; ++dx )
+		combineColorRow32( dst, src, job->width, job->argb );
+		src = (u32*) ( (u8*) (src) + job->srcPitch );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+	Blend a source with alpha premultiplied color
+*/
+static void executeBlit_TexturePremultiplied_32_to_32( const SBlitJob * job )
+{
+	u32 *src = (u32*) job->src;
+	u32 *dst = (u32*) job->dst;
+
+	if (job->stretch)
+	{
+		const float wscale = 1.f/job->x_stretch;
+		const float hscale = 1.f/job->y_stretch;
+		for ( s32 dy = 0; dy != job->height; ++dy )
 		{
-			dst[dx] = PixelCombine32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
+			const u32 src_y = (u32)(dy*hscale);
+			src = (u32*) ( (u8*) (job->src) + job->srcPitch*src_y );
+
+			for ( s32 dx = 0; dx != job->width; ++dx )
+			{
+				const u32 src_x = (u32)(dx*wscale);
+				blendPremultipliedRow32( dst + dx, src + src_x, 1, job->argb );
+			}
+
+			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
 		}
+		return;
+	}
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		blendPremultipliedRow32( dst, src, job->width, job->argb );
 		src = (u32*) ( (u8*) (src) + job->srcPitch );
 		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
 	}
 }
 
+/*!
+	Combine alpha channels of a color and the destination
+*/
+static void executeBlit_ColorCombine_32_to_32( const SBlitJob * job )
+{
+	u32 *dst = (u32*) job->dst;
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		for ( s32 dx = 0; dx != job->width; ++dx )
+			dst[dx] = PixelCombine32( dst[dx], job->argb );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
+/*!
+	Blend an alpha premultiplied color
+*/
+static void executeBlit_ColorPremultiplied_32_to_32( const SBlitJob * job )
+{
+	u32 *dst = (u32*) job->dst;
+
+	for ( s32 dy = 0; dy != job->height; ++dy )
+	{
+		for ( s32 dx = 0; dx != job->width; ++dx )
+			dst[dx] = PixelBlendPremultiplied32( dst[dx], job->argb );
+		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
+	}
+}
+
 // Blitter Operation
 enum eBlitter
 {
@@ -1151,6 +1439,9 @@ enum eBlitter
 	BLITTER_TEXTURE_ALPHA_BLEND,
 	BLITTER_TEXTURE_ALPHA_COLOR_BLEND,
 	BLITTER_TEXTURE_COMBINE_ALPHA,
+	BLITTER_TEXTURE_PREMULTIPLIED_BLEND,
+	BLITTER_COLOR_COMBINE_ALPHA,
+	BLITTER_COLOR_PREMULTIPLIED_BLEND,
 };
 
 typedef void (*tExecuteBlit) ( const SBlitJob * job );
@@ -1191,6 +1482,9 @@ static const blitterTable blitTable[] =
 	{ BLITTER_TEXTURE_COMBINE_ALPHA, video::ECF_A1R5G5B5, video::ECF_A1R5G5B5, executeBlit_TextureCombineColor_16_to_16 },
 	{ BLITTER_TEXTURE_COMBINE_ALPHA, video::ECF_A1R5G5B5, video::ECF_R8G8B8, executeBlit_TextureCopy_24_to_16 },
 	{ BLITTER_TEXTURE_COMBINE_ALPHA, video::ECF_R8G8B8, video::ECF_A1R5G5B5, executeBlit_TextureCombineColor_16_to_24 },
+	{ BLITTER_TEXTURE_PREMULTIPLIED_BLEND, video::ECF_A8R8G8B8, video::ECF_A8R8G8B8, executeBlit_TexturePremultiplied_32_to_32 },
+	{ BLITTER_COLOR_COMBINE_ALPHA, video::ECF_A8R8G8B8, -1, executeBlit_ColorCombine_32_to_32 },
+	{ BLITTER_COLOR_PREMULTIPLIED_BLEND, video::ECF_A8R8G8B8, -1, executeBlit_ColorPremultiplied_32_to_32 },
 	{ BLITTER_INVALID, -1, -1, 0 }
 };
 
@@ -1219,6 +1513,72 @@ static inline tExecuteBlit getBlitter2( eBlitter operation,const video::IImage *
 }
 
 
+//! blits with less pixels are not split into bands
+static const s32 BLIT_BAND_MIN_PIXELS = 256*256;
+//! rows of a band at least
+static const s32 BLIT_BAND_MIN_ROWS = 32;
+
+//! Runs a blit job split into bands of rows
+struct SBlitBands : public os::IParallelJob
+{
+	SBlitBands(tExecuteBlit blitter, const SBlitJob& job, u32 count)
+		: Blitter(blitter), Job(job), Count(count) {}
+
+	virtual void run(u32 index) _IRR_OVERRIDE_
+	{
+		const s32 y0 = (s32)( (u64)Job.height * index / Count );
+		const s32 y1 = (s32)( (u64)Job.height * (index+1) / Count );
+
+		SBlitJob band = Job;
+		band.height = y1 - y0;
+		band.Dest.y0 = Job.Dest.y0 + y0;
+		band.Dest.y1 = Job.Dest.y0 + y1;
+		band.Source.y0 = Job.Source.y0 + y0;
+		band.Source.y1 = Job.Source.y0 + y1;
+		band.dst = (u8*) Job.dst + y0 * Job.dstPitch;
+		if ( Job.src )
+			band.src = (u8*) Job.src + y0 * Job.srcPitch;
+		Blitter( &band );
+	}
+
+	tExecuteBlit Blitter;
+	const SBlitJob& Job;
+	u32 Count;
+};
+
+//! executes a blit job, large ones in bands of rows on several threads
+static inline void executeBlit( tExecuteBlit blitter, const SBlitJob& job )
+{
+	u32 bands = 1;
+
+	// stretched jobs compute their source rows from the destination row and stay in one piece
+	if ( !job.stretch && job.width * job.height >= BLIT_BAND_MIN_PIXELS )
+	{
+		bands = core::min_( os::Parallel::getThreadCount(), (u32)( job.height / BLIT_BAND_MIN_ROWS ) );
+
+		// rows of overlapping copies within one image have to be done in order
+		if ( job.src )
+		{
+			const u8* srcBegin = (const u8*) job.src;
+			const u8* srcEnd = srcBegin + job.height * job.srcPitch;
+			const u8* dstBegin = (const u8*) job.dst;
+			const u8* dstEnd = dstBegin + job.height * job.dstPitch;
+			if ( srcBegin < dstEnd && dstBegin < srcEnd )
+				bands = 1;
+		}
+	}
+
+	if ( bands <= 1 )
+	{
+		blitter( &job );
+		return;
+	}
+
+	SBlitBands parts( blitter, job, bands );
+	os::Parallel::run( parts, bands );
+}
+
+
 // bounce clipping to texture
 inline void setClip ( AbsRectangle &out, const core::rect<s32> *clip,
 					const video::IImage * tex, s32 passnative )
@@ -1312,7 +1672,7 @@ static s32 Blit(eBlitter operation,
 	job.dstPixelMul = dest->getBytesPerPixel();
 	job.dst = (void*) ( (u8*) dest->getData() + ( job.Dest.y0 * job.dstPitch ) + ( job.Dest.x0 * job.dstPixelMul ) );
 
-	blitter( &job );
+	executeBlit( blitter, job );
 
 	return 1;
 }
@@ -1360,7 +1720,7 @@ static s32 StretchBlit(eBlitter operation,
 	job.dstPixelMul = dest->getBytesPerPixel();
 	job.dst = (void*) ( (u8*) dest->getData() + ( job.Dest.y0 * job.dstPitch ) + ( job.Dest.x0 * job.dstPixelMul ) );
 
-	blitter( &job );
+	executeBlit( blitter, job );
 
 	return 1;
 }
@@ -0,0 +1,591 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CClusteredMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "SViewFrustum.h"
+#include "IMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IMaterialRenderer.h"
+#include "IMeshManipulator.h"
+#include "IFileSystem.h"
+#include "CShadowVolumeSceneNode.h"
+#include "os.h"
+
+#include <string.h>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	// clusters culled by one thread, fewer are culled on the calling thread
+	const u32 CLUSTERS_PER_PART = 2048;
+
+	//! Culls the clusters against the frustum and by their normal cones, all in node space
+	class CClusterCullJob : public os::IParallelJob
+	{
+	public:
+
+		CClusterCullJob() : Clusters(0), Count(0), Culled(0), ConeCulling(0),
+			FrustumCulling(false), Orthogonal(false) {}
+
+		virtual void run(u32 index) _IRR_OVERRIDE_
+		{
+			const u32 end = core::min_(Count, (index + 1) * CLUSTERS_PER_PART);
+			for (u32 i=index*CLUSTERS_PER_PART; i<end; ++i)
+			{
+				const SMeshCluster& cluster = Clusters[i];
+				u8 culled = 0;
+
+				if (FrustumCulling)
+				{
+					for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT && !culled; ++p)
+						culled = (u8)(Planes[p].Normal.dotProduct(cluster.Center) + Planes[p].D > cluster.Radius);
+				}
+
+				// all triangles of the cluster face away from the camera
+				if (!culled && cluster.ConeCutoff < 1.f && ConeCulling[cluster.MeshBuffer])
+				{
+					if (Orthogonal)
+						culled = (u8)(Camera.dotProduct(cluster.ConeAxis) >= cluster.ConeCutoff);
+					else
+					{
+						const core::vector3df v = cluster.Center - Camera;
+						culled = (u8)(v.dotProduct(cluster.ConeAxis) >= cluster.ConeCutoff * v.getLength() + cluster.Radius);
+					}
+				}
+
+				Culled[i] = culled;
+			}
+		}
+
+		const SMeshCluster* Clusters;
+		u32 Count;
+		u8* Culled;
+		//! for each mesh buffer, if its back faces are culled
+		const u8* ConeCulling;
+
+		//! frustum planes with normalized normals
+		core::plane3df Planes[SViewFrustum::VF_PLANE_COUNT];
+		//! position of the camera, or view direction for orthogonal cameras
+		core::vector3df Camera;
+		bool FrustumCulling;
+		bool Orthogonal;
+	};
+}
+
+
+//! constructor
+CClusteredMeshSceneNode::CClusteredMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IClusteredMeshSceneNode(parent, mgr, id, position, rotation, scale), Box(core::vector3df(0.f, 0.f, 0.f)),
+	Mesh(0), ClusteredMesh(0), Shadow(0), ClusterSize(128), VisibleClusters(0), PassCount(0),
+	ReadOnlyMaterials(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CClusteredMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CClusteredMeshSceneNode::~CClusteredMeshSceneNode()
+{
+	if (Shadow)
+		Shadow->drop();
+	if (ClusteredMesh)
+		ClusteredMesh->drop();
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CClusteredMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && ClusteredMesh)
+	{
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+		PassCount = 0;
+		int transparentCount = 0;
+		int solidCount = 0;
+
+		// count transparent and solid materials in this scene node
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+			video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+			if ((rnd && rnd->isTransparent()) || material.isTransparent())
+				++transparentCount;
+			else
+				++solidCount;
+
+			if (solidCount && transparentCount)
+				break;
+		}
+
+		if (solidCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparentCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CClusteredMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!ClusteredMesh || !driver)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	// the clusters are culled once per frame, also for nodes with solid and transparent buffers
+	if (PassCount == 1)
+	{
+		cullClusters();
+		if (Shadow)
+			Shadow->updateShadowVolumes();
+	}
+
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	for (u32 i=0; i<Draws.size(); ++i)
+	{
+		const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		const bool transparent = (rnd && rnd->isTransparent()) || material.isTransparent();
+		if (transparent != isTransparentPass)
+			continue;
+
+		driver->setMaterial(material);
+		drawBuffer(driver, i);
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+		}
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			// spheres of the visible clusters
+			for (u32 i=0; i<Clusters.size(); ++i)
+			{
+				if (Culled[i])
+					continue;
+				const core::vector3df radius(Clusters[i].Radius, Clusters[i].Radius, Clusters[i].Radius);
+				driver->draw3DBox(core::aabbox3df(Clusters[i].Center - radius, Clusters[i].Center + radius),
+					video::SColor(255,190,128,128));
+			}
+		}
+	}
+}
+
+
+//! draws the visible ranges of one mesh buffer
+void CClusteredMeshSceneNode::drawBuffer(video::IVideoDriver* driver, u32 buffer)
+{
+	IMeshBuffer* mb = ClusteredMesh->getMeshBuffer(buffer);
+	SBufferDraw& draw = Draws[buffer];
+
+	// everything visible, drawn like in a mesh scene node with its hardware buffers
+	if (!draw.ClusterCount || (draw.Ranges.size() == 2 && draw.Ranges[1] == mb->getIndexCount()))
+	{
+		driver->drawMeshBuffer(mb);
+		return;
+	}
+	if (draw.Ranges.empty())
+		return;
+
+	const u32 indexSize = mb->getIndexType() == video::EIT_32BIT ? sizeof(u32) : sizeof(u16);
+	const void* indices = 0;
+	u32 indexCount = 0;
+
+	// one range is drawn from the indices of the mesh buffer directly
+	if (draw.Ranges.size() == 2)
+	{
+		indices = (const u8*)mb->getIndices() + draw.Ranges[0] * indexSize;
+		indexCount = draw.Ranges[1];
+	}
+	else
+	{
+		// several ranges are copied, but only when other clusters are visible
+		if (draw.Ranges != draw.CopiedRanges)
+		{
+			u32 size = 0;
+			for (u32 r=1; r<draw.Ranges.size(); r+=2)
+				size += draw.Ranges[r];
+			draw.VisibleIndices.set_used(size * indexSize);
+
+			u8* dst = draw.VisibleIndices.pointer();
+			for (u32 r=0; r<draw.Ranges.size(); r+=2)
+			{
+				memcpy(dst, (const u8*)mb->getIndices() + draw.Ranges[r] * indexSize, draw.Ranges[r+1] * indexSize);
+				dst += draw.Ranges[r+1] * indexSize;
+			}
+			draw.CopiedRanges = draw.Ranges;
+		}
+		indices = draw.VisibleIndices.const_pointer();
+		indexCount = draw.VisibleIndices.size() / indexSize;
+	}
+
+	driver->drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), indices, indexCount / 3,
+		mb->getVertexType(), scene::EPT_TRIANGLES, mb->getIndexType());
+}
+
+
+//! finds the visible clusters and joins them into ranges of indices
+void CClusteredMeshSceneNode::cullClusters()
+{
+	const u32 count = Clusters.size();
+	Culled.set_used(count);
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (camera && AutomaticCullingState != EAC_OFF && count)
+	{
+		core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+
+		CClusterCullJob job;
+		job.Clusters = Clusters.const_pointer();
+		job.Count = count;
+		job.Culled = Culled.pointer();
+		job.FrustumCulling = true;
+
+		// the spheres are tested in node space, where the transformed planes are not normalized
+		SViewFrustum frustum = *camera->getViewFrustum();
+		frustum.transform(invTrans);
+		for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			const f32 length = frustum.planes[p].Normal.getLength();
+			job.Planes[p].Normal = frustum.planes[p].Normal / length;
+			job.Planes[p].D = frustum.planes[p].D / length;
+		}
+
+		// a mirroring transformation turns the triangles around on the screen
+		const f32* m = AbsoluteTransformation.pointer();
+		const core::vector3df x(m[0], m[1], m[2]);
+		const core::vector3df y(m[4], m[5], m[6]);
+		const core::vector3df z(m[8], m[9], m[10]);
+		const bool mirrored = x.crossProduct(y).dotProduct(z) < 0.f;
+
+		core::array<u8> coneCulling(Draws.size());
+		for (u32 i=0; i<Draws.size(); ++i)
+		{
+			const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+			coneCulling.push_back((u8)(!mirrored && material.BackfaceCulling && !material.FrontfaceCulling));
+		}
+		job.ConeCulling = coneCulling.const_pointer();
+
+		job.Orthogonal = camera->isOrthogonal();
+		if (job.Orthogonal)
+		{
+			job.Camera = camera->getTarget() - camera->getAbsolutePosition();
+			invTrans.rotateVect(job.Camera);
+			job.Camera.normalize();
+		}
+		else
+		{
+			job.Camera = camera->getAbsolutePosition();
+			invTrans.transformVect(job.Camera);
+		}
+
+		os::Parallel::run(job, (count + CLUSTERS_PER_PART - 1) / CLUSTERS_PER_PART);
+	}
+	else
+	{
+		for (u32 i=0; i<count; ++i)
+			Culled[i] = 0;
+	}
+
+	// neighbouring visible clusters are one range
+	VisibleClusters = 0;
+	for (u32 b=0; b<Draws.size(); ++b)
+	{
+		SBufferDraw& draw = Draws[b];
+		draw.Ranges.set_used(0);
+		for (u32 i=draw.FirstCluster; i<draw.FirstCluster+draw.ClusterCount; ++i)
+		{
+			if (Culled[i])
+				continue;
+			++VisibleClusters;
+
+			const SMeshCluster& cluster = Clusters[i];
+			if (draw.Ranges.size() && draw.Ranges[draw.Ranges.size()-2] + draw.Ranges.getLast() == cluster.FirstIndex)
+				draw.Ranges.getLast() += cluster.IndexCount;
+			else
+			{
+				draw.Ranges.push_back(cluster.FirstIndex);
+				draw.Ranges.push_back(cluster.IndexCount);
+			}
+		}
+	}
+}
+
+
+//! creates the clustered mesh
+void CClusteredMeshSceneNode::clusterMesh()
+{
+	if (ClusteredMesh)
+		ClusteredMesh->drop();
+	ClusteredMesh = 0;
+	Clusters.clear();
+	Draws.clear();
+	VisibleClusters = 0;
+
+	if (!Mesh)
+		return;
+
+	ClusteredMesh = SceneManager->getMeshManipulator()->createClusteredMesh(Mesh, Clusters, ClusterSize);
+
+	for (u32 b=0; b<ClusteredMesh->getMeshBufferCount(); ++b)
+		Draws.push_back(SBufferDraw());
+
+	// the clusters are sorted by mesh buffer
+	for (u32 i=0; i<Clusters.size(); ++i)
+	{
+		SBufferDraw& draw = Draws[Clusters[i].MeshBuffer];
+		if (!draw.ClusterCount)
+			draw.FirstCluster = i;
+		++draw.ClusterCount;
+	}
+	Culled.set_used(Clusters.size());
+	memset(Culled.pointer(), 0, Culled.size());
+}
+
+
+//! Removes a child from this scene node.
+//! Implemented here, to be able to remove the shadow properly, if there is one,
+//! or to remove attached childs.
+bool CClusteredMeshSceneNode::removeChild(ISceneNode* child)
+{
+	if (child && Shadow == child)
+	{
+		Shadow->drop();
+		Shadow = 0;
+	}
+
+	return ISceneNode::removeChild(child);
+}
+
+
+//! returns the axis aligned bounding box of this node
+const core::aabbox3d<f32>& CClusteredMeshSceneNode::getBoundingBox() const
+{
+	return Mesh ? Mesh->getBoundingBox() : Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CClusteredMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CClusteredMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh and clusters it
+void CClusteredMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		Box = Mesh->getBoundingBox();
+		copyMaterials();
+		clusterMesh();
+	}
+}
+
+
+//! Sets the largest number of triangles in a cluster and clusters the mesh again
+void CClusteredMeshSceneNode::setClusterSize(u32 maxTriangles)
+{
+	maxTriangles = core::max_(maxTriangles, 1u);
+	if (maxTriangles == ClusterSize)
+		return;
+
+	ClusterSize = maxTriangles;
+	clusterMesh();
+}
+
+
+//! Creates shadow volume scene node as child of this node
+//! and returns a pointer to it.
+IShadowVolumeSceneNode* CClusteredMeshSceneNode::addShadowVolumeSceneNode(
+		const IMesh* shadowMesh, s32 id, bool zfailmethod, f32 infinity)
+{
+	if (!SceneManager->getVideoDriver()->queryFeature(video::EVDF_STENCIL_BUFFER))
+		return 0;
+
+	if (!shadowMesh)
+		shadowMesh = Mesh; // if null is given, use the mesh of node
+
+	if (Shadow)
+		Shadow->drop();
+
+	Shadow = new CShadowVolumeSceneNode(shadowMesh, this, SceneManager, id,  zfailmethod, infinity);
+	return Shadow;
+}
+
+
+void CClusteredMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Writes attributes of the scene node.
+void CClusteredMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	IClusteredMeshSceneNode::serializeAttributes(out, options);
+
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(Mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(Mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+	out->addInt("ClusterSize", ClusterSize);
+}
+
+
+//! Reads attributes of the scene node.
+void CClusteredMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(Mesh);
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+
+	// the size is set before the mesh, so a new mesh is only clustered once
+	if (in->existsAttribute("ClusterSize"))
+	{
+		const u32 size = (u32)core::max_(in->getAttributeAsInt("ClusterSize"), 1);
+		if (newMeshStr != "" && oldMeshStr != newMeshStr)
+			ClusterSize = size;
+		else
+			setClusterSize(size);
+	}
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IMesh* newMesh = 0;
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+
+		if (newAnimatedMesh)
+			newMesh = newAnimatedMesh->getMesh(0);
+
+		if (newMesh)
+			setMesh(newMesh);
+	}
+
+	IClusteredMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CClusteredMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CClusteredMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CClusteredMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CClusteredMeshSceneNode* nb = new CClusteredMeshSceneNode(0, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ClusterSize = ClusterSize;
+	nb->setMesh(Mesh);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
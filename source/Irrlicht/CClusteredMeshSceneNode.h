@@ -0,0 +1,148 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CLUSTERED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_CLUSTERED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IClusteredMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+}
+namespace scene
+{
+
+	class CClusteredMeshSceneNode : public IClusteredMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CClusteredMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CClusteredMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of this node
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0) _IRR_OVERRIDE_;
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_CLUSTERED_MESH; }
+
+		//! Sets a new mesh and clusters it
+		virtual void setMesh(IMesh* mesh) _IRR_OVERRIDE_;
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) _IRR_OVERRIDE_ { return Mesh; }
+
+		//! Creates shadow volume scene node as child of this node.
+		virtual IShadowVolumeSceneNode* addShadowVolumeSceneNode(const IMesh* shadowMesh,
+			s32 id, bool zfailmethod=true, f32 infinity=10000.0f) _IRR_OVERRIDE_;
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly) _IRR_OVERRIDE_;
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+		//! Removes a child from this scene node.
+		virtual bool removeChild(ISceneNode* child) _IRR_OVERRIDE_;
+
+		//! Sets the largest number of triangles in a cluster and clusters the mesh again
+		virtual void setClusterSize(u32 maxTriangles) _IRR_OVERRIDE_;
+
+		//! Get the largest number of triangles in a cluster
+		virtual u32 getClusterSize() const _IRR_OVERRIDE_ { return ClusterSize; }
+
+		//! Get the number of clusters
+		virtual u32 getClusterCount() const _IRR_OVERRIDE_ { return Clusters.size(); }
+
+		//! Get a cluster
+		virtual const SMeshCluster& getCluster(u32 index) const _IRR_OVERRIDE_ { return Clusters[index]; }
+
+		//! Get the clustered copy of the mesh which is drawn
+		virtual IMesh* getClusteredMesh() const _IRR_OVERRIDE_ { return ClusteredMesh; }
+
+		//! Get the number of clusters which were not culled when the node was drawn the last time
+		virtual u32 getVisibleClusterCount() const _IRR_OVERRIDE_ { return VisibleClusters; }
+
+	private:
+
+		//! visible index ranges of one mesh buffer
+		struct SBufferDraw
+		{
+			SBufferDraw() : FirstCluster(0), ClusterCount(0) {}
+
+			u32 FirstCluster;
+			//! 0 for mesh buffers without clusters, they are always drawn completely
+			u32 ClusterCount;
+			//! first index and index count of each range of visible clusters
+			core::array<u32> Ranges;
+			//! ranges which were copied into VisibleIndices
+			core::array<u32> CopiedRanges;
+			//! indices of the visible ranges, with the index size of the mesh buffer
+			core::array<u8> VisibleIndices;
+		};
+
+		void copyMaterials();
+
+		//! creates the clustered mesh
+		void clusterMesh();
+
+		//! finds the visible clusters and joins them into ranges of indices
+		void cullClusters();
+
+		//! draws the visible ranges of one mesh buffer
+		void drawBuffer(video::IVideoDriver* driver, u32 buffer);
+
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+		core::aabbox3d<f32> Box;
+
+		IMesh* Mesh;
+		IMesh* ClusteredMesh;
+		IShadowVolumeSceneNode* Shadow;
+
+		core::array<SMeshCluster> Clusters;
+		core::array<u8> Culled;
+		core::array<SBufferDraw> Draws;
+
+		u32 ClusterSize;
+		u32 VisibleClusters;
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -7,11 +7,201 @@
 #include "os.h"
 #include "irrString.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include "ColorSSE2.h"
+
+// the 24 bit conversions need pshufb, SSSE3 is checked at runtime
+#if defined(__SSSE3__) || defined(_MSC_VER) || defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define IRR_CONVERT_WITH_SSSE3
+#include <tmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif !defined(__SSSE3__)
+#include <cpuid.h>
+#endif
+#if defined(__GNUC__) && !defined(__SSSE3__)
+#define IRR_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define IRR_TARGET_SSSE3
+#endif
+#endif
+#endif
+
 namespace irr
 {
 namespace video
 {
 
+namespace
+{
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+
+// The functions below convert blocks of pixels and return how many were
+// converted, the scalar converters do the rest.
+
+s32 convertSIMD_16to32(const u16* in, s32 count, u32* out, bool r5g6b5)
+{
+	const __m128i zero = _mm_setzero_si128();
+	s32 x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)(in + x));
+		const __m128i lo = _mm_unpacklo_epi16(c, zero);
+		const __m128i hi = _mm_unpackhi_epi16(c, zero);
+		_mm_storeu_si128((__m128i*)(out + x), r5g6b5 ? expandR5G6B5(lo) : expandA1R5G5B5(lo));
+		_mm_storeu_si128((__m128i*)(out + x + 4), r5g6b5 ? expandR5G6B5(hi) : expandA1R5G5B5(hi));
+	}
+	return x;
+}
+
+s32 convertSIMD_32to16(const u32* in, s32 count, u16* out, bool r5g6b5)
+{
+	s32 x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		const __m128i c0 = _mm_loadu_si128((const __m128i*)(in + x));
+		const __m128i c1 = _mm_loadu_si128((const __m128i*)(in + x + 4));
+		const __m128i d0 = r5g6b5 ? reduceToR5G6B5(c0) : reduceToA1R5G5B5(c0);
+		const __m128i d1 = r5g6b5 ? reduceToR5G6B5(c1) : reduceToA1R5G5B5(c1);
+		_mm_storeu_si128((__m128i*)(out + x), _mm_packs_epi32(signExtend16(d0), signExtend16(d1)));
+	}
+	return x;
+}
+
+s32 convertSIMD_A1R5G5B5toR5G6B5(const u16* in, s32 count, u16* out)
+{
+	s32 x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)(in + x));
+		_mm_storeu_si128((__m128i*)(out + x), _mm_or_si128(
+			_mm_slli_epi16(_mm_and_si128(c, _mm_set1_epi16(0x7FE0)), 1),
+			_mm_and_si128(c, _mm_set1_epi16(0x001F))));
+	}
+	return x;
+}
+
+s32 convertSIMD_R5G6B5toA1R5G5B5(const u16* in, s32 count, u16* out)
+{
+	s32 x = 0;
+	for (; x + 8 <= count; x += 8)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)(in + x));
+		_mm_storeu_si128((__m128i*)(out + x), _mm_or_si128(_mm_set1_epi16((s16)0x8000),
+			_mm_or_si128(_mm_srli_epi16(_mm_and_si128(c, _mm_set1_epi16((s16)0xFFC0)), 1),
+				_mm_and_si128(c, _mm_set1_epi16(0x001F)))));
+	}
+	return x;
+}
+
+//! swaps the red and blue byte of each 32 bit color
+s32 convertSIMD_swapRedBlue(const u32* in, s32 count, u32* out)
+{
+	s32 x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)(in + x));
+		_mm_storeu_si128((__m128i*)(out + x), _mm_or_si128(_mm_and_si128(c, _mm_set1_epi32((s32)0xFF00FF00)),
+			_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00FF0000)), 16),
+				_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000FF)), 16))));
+	}
+	return x;
+}
+
+//! reverses the bytes of each 32 bit color
+s32 convertSIMD_swapBytes(const u32* in, s32 count, u32* out)
+{
+	s32 x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)(in + x));
+		_mm_storeu_si128((__m128i*)(out + x), _mm_or_si128(
+			_mm_or_si128(_mm_slli_epi32(c, 24), _mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000FF00)), 8)),
+			_mm_or_si128(_mm_and_si128(_mm_srli_epi32(c, 8), _mm_set1_epi32(0x0000FF00)), _mm_srli_epi32(c, 24))));
+	}
+	return x;
+}
+
+#ifdef IRR_CONVERT_WITH_SSSE3
+
+bool detectSSSE3()
+{
+#if defined(__SSSE3__)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	unsigned int a, b, c, d;
+	return __get_cpuid(1, &a, &b, &c, &d) && (c & (1 << 9));
+#endif
+}
+
+const bool HasSSSE3 = detectSSSE3();
+
+//! 24 to 32 bit, shuffle picks the bytes of four colors from 12 bytes
+IRR_TARGET_SSSE3 s32 convertSSSE3_24to32(const u8* in, s32 count, u32* out, bool bgr)
+{
+	const __m128i shuffle = bgr ?
+		_mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128) :
+		_mm_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128);
+	const __m128i alpha = _mm_set1_epi32((s32)0xFF000000);
+
+	// each load reads 16 bytes of which 12 are used, so stop two colors early
+	s32 x = 0;
+	for (; x + 6 <= count; x += 4)
+	{
+		const __m128i c = _mm_loadu_si128((const __m128i*)(in + x * 3));
+		_mm_storeu_si128((__m128i*)(out + x), _mm_or_si128(_mm_shuffle_epi8(c, shuffle), alpha));
+	}
+	return x;
+}
+
+//! 32 to 24 bit, four colors are packed into the lower 12 bytes
+IRR_TARGET_SSSE3 s32 convertSSSE3_32to24(const u32* in, s32 count, u8* out, bool bgr)
+{
+	const __m128i shuffle = bgr ?
+		_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128) :
+		_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -128, -128, -128, -128);
+
+	s32 x = 0;
+	for (; x + 4 <= count; x += 4)
+	{
+		const __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(in + x)), shuffle);
+		_mm_storel_epi64((__m128i*)(out + x * 3), c);
+		const s32 last = _mm_cvtsi128_si32(_mm_srli_si128(c, 8));
+		memcpy(out + x * 3 + 8, &last, 4);
+	}
+	return x;
+}
+
+#endif // IRR_CONVERT_WITH_SSSE3
+
+s32 convertSIMD_24to32(const u8* in, s32 count, u32* out, bool bgr)
+{
+#ifdef IRR_CONVERT_WITH_SSSE3
+	if (HasSSSE3)
+		return convertSSSE3_24to32(in, count, out, bgr);
+#endif
+	return 0;
+}
+
+s32 convertSIMD_32to24(const u32* in, s32 count, u8* out, bool bgr)
+{
+#ifdef IRR_CONVERT_WITH_SSSE3
+	if (HasSSSE3)
+		return convertSSSE3_32to24(in, count, out, bgr);
+#endif
+	return 0;
+}
+
+#endif // _IRR_COMPILE_WITH_SSE2_
+
+} // end anonymous namespace
+
+
 //! converts a monochrome bitmap to A1R5G5B5 data
 void CColorConverter::convert1BitTo16Bit(const u8* in, s16* out, s32 width, s32 height, s32 linepad, bool flip)
 {
@@ -363,7 +553,14 @@ void CColorConverter::convert_A1R5G5B5toA8R8G8B8(const void* sP, s32 sN, void* d
 	u16* sB = (u16*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_16to32(sB, sN, dB, false);
+	sB += x;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 		*dB++ = A1R5G5B5toA8R8G8B8(*sB++);
 }
 
@@ -377,7 +574,14 @@ void CColorConverter::convert_A1R5G5B5toR5G6B5(const void* sP, s32 sN, void* dP)
 	u16* sB = (u16*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_A1R5G5B5toR5G6B5(sB, sN, dB);
+	sB += x;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 		*dB++ = A1R5G5B5toR5G6B5(*sB++);
 }
 
@@ -386,7 +590,14 @@ void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, s32 sN, void* dP)
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_32to24((const u32*)sB, sN, dB, false);
+	sB += x * 4;
+	dB += x * 3;
+#endif
+
+	for (; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[2];
@@ -403,7 +614,14 @@ void CColorConverter::convert_A8R8G8B8toB8G8R8(const void* sP, s32 sN, void* dP)
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_32to24((const u32*)sB, sN, dB, true);
+	sB += x * 4;
+	dB += x * 3;
+#endif
+
+	for (; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[0];
@@ -425,7 +643,14 @@ void CColorConverter::convert_A8R8G8B8toA1R5G5B5(const void* sP, s32 sN, void* d
 	u32* sB = (u32*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_32to16(sB, sN, dB, false);
+	sB += x;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 		*dB++ = A8R8G8B8toA1R5G5B5(*sB++);
 }
 
@@ -453,7 +678,14 @@ void CColorConverter::convert_A8R8G8B8toR5G6B5(const void* sP, s32 sN, void* dP)
 	u8 * sB = (u8 *)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_32to16((const u32*)sB, sN, dB, true);
+	sB += x * 4;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 	{
 		s32 r = sB[2] >> 3;
 		s32 g = sB[1] >> 2;
@@ -494,7 +726,14 @@ void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_24to32(sB, sN, dB, false);
+	sB += x * 3;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[0]<<16) | (sB[1]<<8) | sB[2];
 
@@ -526,7 +765,14 @@ void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_24to32(sB, sN, dB, true);
+	sB += x * 3;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[2]<<16) | (sB[1]<<8) | sB[0];
 
@@ -540,7 +786,14 @@ void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, s32 sN, void* d
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_swapBytes((const u32*)sB, sN, (u32*)dB);
+	sB += x * 4;
+	dB += x * 4;
+#endif
+
+	for (; x < sN; ++x)
 	{
 		dB[0] = sB[3];
 		dB[1] = sB[2];
@@ -558,7 +811,14 @@ void CColorConverter::convert_A8R8G8B8toA8B8G8R8(const void* sP, s32 sN, void* d
 	const u32* sB = (const u32*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_swapRedBlue(sB, sN, dB);
+	sB += x;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 	{
 		*dB++ = (*sB & 0xff00ff00) | ((*sB & 0x00ff0000) >> 16) | ((*sB & 0x000000ff) << 16);
 		++sB;
@@ -625,7 +885,14 @@ void CColorConverter::convert_R5G6B5toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u16* sB = (u16*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_16to32(sB, sN, dB, true);
+	sB += x;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 		*dB++ = R5G6B5toA8R8G8B8(*sB++);
 }
 
@@ -634,13 +901,91 @@ void CColorConverter::convert_R5G6B5toA1R5G5B5(const void* sP, s32 sN, void* dP)
 	u16* sB = (u16*)sP;
 	u16* dB = (u16*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	s32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	x = convertSIMD_R5G6B5toA1R5G5B5(sB, sN, dB);
+	sB += x;
+	dB += x;
+#endif
+
+	for (; x < sN; ++x)
 		*dB++ = R5G6B5toA1R5G5B5(*sB++);
 }
 
 
+namespace
+{
+
+//! conversions are split into parts of at least this many pixels
+const s32 CONVERT_PART_MIN_PIXELS = 64*1024;
+
+//! bytes per pixel of the formats convert_viaFormat handles, 0 for others
+u32 getConvertBytesPerPixel(ECOLOR_FORMAT format)
+{
+	switch (format)
+	{
+		case ECF_A1R5G5B5:
+		case ECF_R5G6B5:
+			return 2;
+		case ECF_R8G8B8:
+			return 3;
+		case ECF_A8R8G8B8:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+//! Runs a conversion split into parts
+struct SConvertParts : public os::IParallelJob
+{
+	SConvertParts(const void* sP, ECOLOR_FORMAT sF, s32 sN, void* dP, ECOLOR_FORMAT dF, u32 count)
+		: Source((const u8*)sP), SourceFormat(sF), Pixels(sN),
+		Dest((u8*)dP), DestFormat(dF), Count(count)
+	{
+		SourceBytes = getConvertBytesPerPixel(sF);
+		DestBytes = getConvertBytesPerPixel(dF);
+	}
+
+	virtual void run(u32 index) _IRR_OVERRIDE_
+	{
+		const s32 begin = (s32)((u64)Pixels * index / Count);
+		const s32 end = (s32)((u64)Pixels * (index+1) / Count);
+		CColorConverter::convert_viaFormatPart(Source + begin * SourceBytes, SourceFormat,
+			end - begin, Dest + begin * DestBytes, DestFormat);
+	}
+
+	const u8* Source;
+	ECOLOR_FORMAT SourceFormat;
+	s32 Pixels;
+	u8* Dest;
+	ECOLOR_FORMAT DestFormat;
+	u32 Count;
+	u32 SourceBytes;
+	u32 DestBytes;
+};
+
+} // end anonymous namespace
+
 void CColorConverter::convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, s32 sN,
 				void* dP, ECOLOR_FORMAT dF)
+{
+	u32 parts = 1;
+	if (sN >= 2 * CONVERT_PART_MIN_PIXELS && getConvertBytesPerPixel(sF) && getConvertBytesPerPixel(dF))
+		parts = core::min_(os::Parallel::getThreadCount(), (u32)(sN / CONVERT_PART_MIN_PIXELS));
+
+	if (parts <= 1)
+	{
+		convert_viaFormatPart(sP, sF, sN, dP, dF);
+		return;
+	}
+
+	SConvertParts job(sP, sF, sN, dP, dF, parts);
+	os::Parallel::run(job, parts);
+}
+
+void CColorConverter::convert_viaFormatPart(const void* sP, ECOLOR_FORMAT sF, s32 sN,
+				void* dP, ECOLOR_FORMAT dF)
 {
 	switch (sF)
 	{
@@ -57,6 +57,7 @@ public:
 	//! \param sN number of source pixels to copy
 	//! \param dP pointer to destination data buffer. must be big enough
 	//! to hold sN pixels in the output format.
+	//! The common conversions use SSE2, or SSSE3 when the cpu has it, and give the same results.
 	static void convert_A1R5G5B5toR8G8B8(const void* sP, s32 sN, void* dP);
 	static void convert_A1R5G5B5toB8G8R8(const void* sP, s32 sN, void* dP);
 	static void convert_A1R5G5B5toA8R8G8B8(const void* sP, s32 sN, void* dP);
@@ -84,8 +85,14 @@ public:
 	static void convert_R5G6B5toB8G8R8(const void* sP, s32 sN, void* dP);
 	static void convert_R5G6B5toA8R8G8B8(const void* sP, s32 sN, void* dP);
 	static void convert_R5G6B5toA1R5G5B5(const void* sP, s32 sN, void* dP);
+
+	//! Converts between the 16, 24 and 32 bit formats, large conversions are split over several threads
 	static void convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, s32 sN,
 				void* dP, ECOLOR_FORMAT dF);
+
+	//! Same as convert_viaFormat, but always on the calling thread
+	static void convert_viaFormatPart(const void* sP, ECOLOR_FORMAT sF, s32 sN,
+				void* dP, ECOLOR_FORMAT dF);
 };
 
 
@@ -1183,87 +1183,54 @@ void CD3D9Driver::addOcclusionQuery(scene::ISceneNode* node,
 	if (!queryFeature(EVDF_OCCLUSION_QUERY))
 		return;
 	CNullDriver::addOcclusionQuery(node, mesh);
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = findOcclusionQuery(node);
 	if ((index != -1) && (OcclusionQueries[index].PID == 0))
 		pID3DDevice->CreateQuery(D3DQUERYTYPE_OCCLUSION, reinterpret_cast<IDirect3DQuery9**>(&OcclusionQueries[index].PID));
 }
 
 
-//! Remove occlusion query.
-void CD3D9Driver::removeOcclusionQuery(scene::ISceneNode* node)
+//! Deletes the hardware query in the slot
+void CD3D9Driver::removeOcclusionQuerySlot(u32 index)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
-	{
-		if (OcclusionQueries[index].PID != 0)
-			reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Release();
-		CNullDriver::removeOcclusionQuery(node);
-	}
+	if (OcclusionQueries[index].PID != 0)
+		reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Release();
+	CNullDriver::removeOcclusionQuerySlot(index);
 }
 
 
-//! Run occlusion query. Draws mesh stored in query.
-/** If the mesh shall not be rendered visible, use
-overrideMaterial to disable the color and depth buffer. */
-void CD3D9Driver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
+//! Runs the occlusion query in the slot inside a hardware query
+void CD3D9Driver::runOcclusionQuerySlot(u32 index, bool visible)
 {
-	if (!node)
-		return;
-
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
-	{
-		if (OcclusionQueries[index].PID)
-			reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Issue(D3DISSUE_BEGIN);
-		CNullDriver::runOcclusionQuery(node,visible);
-		if (OcclusionQueries[index].PID)
-			reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Issue(D3DISSUE_END);
-	}
+	if (OcclusionQueries[index].PID)
+		reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Issue(D3DISSUE_BEGIN);
+	CNullDriver::runOcclusionQuerySlot(index, visible);
+	if (OcclusionQueries[index].PID)
+		reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Issue(D3DISSUE_END);
 }
 
 
-//! Update occlusion query. Retrieves results from GPU.
-/** If the query shall not block, set the flag to false.
-Update might not occur in this case, though */
-void CD3D9Driver::updateOcclusionQuery(scene::ISceneNode* node, bool block)
+//! Retrieves the result of the hardware query in the slot
+void CD3D9Driver::updateOcclusionQuerySlot(u32 index, bool block)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
+	// not yet started
+	if (OcclusionQueries[index].Run==u32(~0))
+		return;
+	bool available = block?true:false;
+	int tmp=0;
+	if (!block)
+		available=(reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->GetData(&tmp, sizeof(DWORD), 0)==S_OK);
+	else
 	{
-		// not yet started
-		if (OcclusionQueries[index].Run==u32(~0))
-			return;
-		bool available = block?true:false;
-		int tmp=0;
-		if (!block)
-			available=(reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->GetData(&tmp, sizeof(DWORD), 0)==S_OK);
-		else
+		do
 		{
-			do
-			{
-				HRESULT hr = reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->GetData(&tmp, sizeof(DWORD), D3DGETDATA_FLUSH);
-				available = (hr == S_OK);
-				if (hr!=S_FALSE)
-					break;
-			} while (!available);
-		}
-		if (available)
-			OcclusionQueries[index].Result = tmp;
+			HRESULT hr = reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->GetData(&tmp, sizeof(DWORD), D3DGETDATA_FLUSH);
+			available = (hr == S_OK);
+			if (hr!=S_FALSE)
+				break;
+		} while (!available);
 	}
-}
-
-
-//! Return query result.
-/** Return value is the number of visible pixels/fragments.
-The value is a safe approximation, i.e. can be larger than the
-actual value of pixels. */
-u32 CD3D9Driver::getOcclusionQueryResult(scene::ISceneNode* node) const
-{
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
-		return OcclusionQueries[index].Result;
-	else
-		return ~0;
+	if (available)
+		OcclusionQueries[index].Result = tmp;
 }
 
 
@@ -2549,7 +2516,9 @@ void CD3D9Driver::setRenderStates2DMode(bool alpha, bool texture, bool alphaChan
 	if (alpha || alphaChannel)
 	{
 		BridgeCalls->setBlend(true);
-		BridgeCalls->setBlendFunc(D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA);
+		// keep the blend factor of the override material, set by setBasicRenderStates
+		if (!OverrideMaterial2DEnabled || !(IR(OverrideMaterial2D.BlendFactor) & 0xFFFFFFFF))
+			BridgeCalls->setBlendFunc(D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA);
 	}
 	else
 		BridgeCalls->setBlend(false);
@@ -2978,7 +2947,8 @@ bool CD3D9Driver::reset()
 	// restore occlusion queries
 	for (i=0; i<OcclusionQueries.size(); ++i)
 	{
-		pID3DDevice->CreateQuery(D3DQUERYTYPE_OCCLUSION, reinterpret_cast<IDirect3DQuery9**>(&OcclusionQueries[i].PID));
+		if (OcclusionQueries[i].Node)
+			pID3DDevice->CreateQuery(D3DQUERYTYPE_OCCLUSION, reinterpret_cast<IDirect3DQuery9**>(&OcclusionQueries[i].PID));
 	}
 
 	if (FAILED(hr))
@@ -101,25 +101,6 @@ namespace video
 		virtual void addOcclusionQuery(scene::ISceneNode* node,
 				const scene::IMesh* mesh=0) _IRR_OVERRIDE_;
 
-		//! Remove occlusion query.
-		virtual void removeOcclusionQuery(scene::ISceneNode* node) _IRR_OVERRIDE_;
-
-		//! Run occlusion query. Draws mesh stored in query.
-		/** If the mesh shall not be rendered visible, use
-		overrideMaterial to disable the color and depth buffer. */
-		virtual void runOcclusionQuery(scene::ISceneNode* node, bool visible=false) _IRR_OVERRIDE_;
-
-		//! Update occlusion query. Retrieves results from GPU.
-		/** If the query shall not block, set the flag to false.
-		Update might not occur in this case, though */
-		virtual void updateOcclusionQuery(scene::ISceneNode* node, bool block=true) _IRR_OVERRIDE_;
-
-		//! Return query result.
-		/** Return value is the number of visible pixels/fragments.
-		The value is a safe approximation, i.e. can be larger then the
-		actual value of pixels. */
-		virtual u32 getOcclusionQueryResult(scene::ISceneNode* node) const _IRR_OVERRIDE_;
-
 		//! Create render target.
 		virtual IRenderTarget* addRenderTarget() _IRR_OVERRIDE_;
 
@@ -317,6 +298,15 @@ namespace video
 
 	private:
 
+		//! Runs the occlusion query in the slot inside a hardware query
+		virtual void runOcclusionQuerySlot(u32 index, bool visible) _IRR_OVERRIDE_;
+
+		//! Retrieves the result of the hardware query in the slot
+		virtual void updateOcclusionQuerySlot(u32 index, bool block) _IRR_OVERRIDE_;
+
+		//! Deletes the hardware query in the slot
+		virtual void removeOcclusionQuerySlot(u32 index) _IRR_OVERRIDE_;
+
 		//! enumeration for rendering modes such as 2d and 3d for minizing the switching of renderStates.
 		enum E_RENDER_MODE
 		{
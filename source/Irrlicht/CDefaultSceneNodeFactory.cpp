@@ -15,6 +15,9 @@
 #include "ILightSceneNode.h"
 #include "IMeshSceneNode.h"
 #include "IOctreeSceneNode.h"
+#include "IInstancedMeshSceneNode.h"
+#include "ILODMeshSceneNode.h"
+#include "IClusteredMeshSceneNode.h"
 
 namespace irr
 {
@@ -45,6 +48,9 @@ CDefaultSceneNodeFactory::CDefaultSceneNodeFactory(ISceneManager* mgr)
 	// Legacy support
 	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_OCTREE, "octTree"));
 	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_MESH, "mesh"));
+	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_INSTANCED_MESH, "instancedMesh"));
+	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_LOD_MESH, "lodMesh"));
+	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_CLUSTERED_MESH, "clusteredMesh"));
 	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_LIGHT, "light"));
 	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_EMPTY, "empty"));
 	SupportedSceneNodeTypes.push_back(SSceneNodeTypePair(ESNT_DUMMY_TRANSFORMATION, "dummyTransformation"));
@@ -95,6 +101,15 @@ ISceneNode* CDefaultSceneNodeFactory::addSceneNode(ESCENE_NODE_TYPE type, IScene
 	case ESNT_MESH:
 		return Manager->addMeshSceneNode(0, parent, -1, core::vector3df(),
 										 core::vector3df(), core::vector3df(1,1,1), true);
+	case ESNT_INSTANCED_MESH:
+		return Manager->addInstancedMeshSceneNode(0, parent, -1, core::vector3df(),
+										 core::vector3df(), core::vector3df(1,1,1), true);
+	case ESNT_LOD_MESH:
+		return Manager->addLODMeshSceneNode(0, parent, -1, core::vector3df(),
+										 core::vector3df(), core::vector3df(1,1,1), true);
+	case ESNT_CLUSTERED_MESH:
+		return Manager->addClusteredMeshSceneNode(0, parent, -1, core::vector3df(),
+										 core::vector3df(), core::vector3df(1,1,1), true);
 	case ESNT_LIGHT:
 		return Manager->addLightSceneNode(parent);
 	case ESNT_EMPTY:
@@ -52,6 +52,7 @@ CGUIButton::~CGUIButton()
 //! Sets if the images should be scaled to fit the button
 void CGUIButton::setScaleImage(bool scaleImage)
 {
+	markDirty();
 	ScaleImage = scaleImage;
 }
 
@@ -66,12 +67,14 @@ bool CGUIButton::isScalingImage() const
 //! Sets if the button should use the skin to draw its border
 void CGUIButton::setDrawBorder(bool border)
 {
+	markDirty();
 	DrawBorder = border;
 }
 
 
 void CGUIButton::setSpriteBank(IGUISpriteBank* sprites)
 {
+	markDirty();
 	if (sprites)
 		sprites->grab();
 
@@ -84,6 +87,7 @@ void CGUIButton::setSpriteBank(IGUISpriteBank* sprites)
 
 void CGUIButton::setSprite(EGUI_BUTTON_STATE state, s32 index, video::SColor color, bool loop, bool scale)
 {
+	markDirty();
 	ButtonSprites[(u32)state].Index	= index;
 	ButtonSprites[(u32)state].Color	= color;
 	ButtonSprites[(u32)state].Loop	= loop;
@@ -353,6 +357,16 @@ void CGUIButton::drawSprite(EGUI_BUTTON_STATE state, u32 startTime, const core::
 				&AbsoluteClippingRect, ButtonSprites[stateIdx].Color, startTime, os::Timer::getTime(),
 				ButtonSprites[stateIdx].Loop, true);
 		}
+
+		// animated sprites have to be drawn again by a retained environment
+		const u32 index = (u32)ButtonSprites[stateIdx].Index;
+		if (index < SpriteBank->getSprites().size())
+		{
+			const SGUISprite& sprite = SpriteBank->getSprites()[index];
+			if (sprite.Frames.size() > 1 && sprite.frameTime && (ButtonSprites[stateIdx].Loop ||
+				os::Timer::getTime()-startTime < sprite.Frames.size()*sprite.frameTime))
+				markDirty();
+		}
 	}
 }
 
@@ -425,6 +439,7 @@ EGUI_BUTTON_IMAGE_STATE CGUIButton::getImageState(bool pressed) const
 //! sets another skin independent font. if this is set to zero, the button uses the font of the skin.
 void CGUIButton::setOverrideFont(IGUIFont* font)
 {
+	markDirty();
 	if (OverrideFont == font)
 		return;
 
@@ -457,6 +472,7 @@ IGUIFont* CGUIButton::getActiveFont() const
 //! Sets another color for the text.
 void CGUIButton::setOverrideColor(video::SColor color)
 {
+	markDirty();
 	OverrideColor = color;
 	OverrideColorEnabled = true;
 }
@@ -468,6 +484,7 @@ video::SColor CGUIButton::getOverrideColor() const
 
 void CGUIButton::enableOverrideColor(bool enable)
 {
+	markDirty();
 	OverrideColorEnabled = enable;
 }
 
@@ -478,6 +495,7 @@ bool CGUIButton::isOverrideColorEnabled() const
 
 void CGUIButton::setImage(EGUI_BUTTON_IMAGE_STATE state, video::ITexture* image, const core::rect<s32>& sourceRect)
 {
+	markDirty();
 	if ( state >= EGBIS_COUNT )
 		return;
 
@@ -511,6 +529,7 @@ bool CGUIButton::isPressed() const
 //! Sets the pressed state of the button if this is a pushbutton
 void CGUIButton::setPressed(bool pressed)
 {
+	markDirty();
 	if (Pressed != pressed)
 	{
 		ClickTime = os::Timer::getTime();
@@ -529,6 +548,7 @@ bool CGUIButton::isPushButton() const
 //! Sets if the alpha channel should be used for drawing images on the button (default is false)
 void CGUIButton::setUseAlphaChannel(bool useAlphaChannel)
 {
+	markDirty();
 	UseAlphaChannel = useAlphaChannel;
 }
 
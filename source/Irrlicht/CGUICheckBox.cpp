@@ -190,6 +190,7 @@ void CGUICheckBox::draw()
 //! set if box is checked
 void CGUICheckBox::setChecked(bool checked)
 {
+	markDirty();
 	Checked = checked;
 }
 
@@ -203,6 +204,7 @@ bool CGUICheckBox::isChecked() const
 //! Sets whether to draw the background
 void CGUICheckBox::setDrawBackground(bool draw)
 {
+	markDirty();
 	Background = draw;
 }
 
@@ -215,6 +217,7 @@ bool CGUICheckBox::isDrawBackgroundEnabled() const
 //! Sets whether to draw the border
 void CGUICheckBox::setDrawBorder(bool draw)
 {
+	markDirty();
 	Border = draw;
 }
 
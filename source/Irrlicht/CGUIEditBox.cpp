@@ -34,7 +34,7 @@ CGUIEditBox::CGUIEditBox(const wchar_t* text, bool border,
 	: IGUIEditBox(environment, parent, id, rectangle), OverwriteMode(false), MouseMarking(false),
 	Border(border), Background(true), OverrideColorEnabled(false), MarkBegin(0), MarkEnd(0),
 	OverrideColor(video::SColor(101,255,255,255)), OverrideFont(0), LastBreakFont(0),
-	Operator(0), BlinkStartTime(0), CursorBlinkTime(350), CursorChar(L"_"), CursorPos(0), HScrollPos(0), VScrollPos(0), Max(0),
+	Operator(0), BlinkStartTime(0), CursorBlinkTime(350), CursorVisible(false), CursorChar(L"_"), CursorPos(0), HScrollPos(0), VScrollPos(0), Max(0),
 	WordWrap(false), MultiLine(false), AutoScroll(true), PasswordBox(false),
 	PasswordChar(L'*'), HAlign(EGUIA_UPPERLEFT), VAlign(EGUIA_CENTER),
 	CurrentTextRect(0,0,1,1), FrameRect(rectangle)
@@ -76,6 +76,7 @@ CGUIEditBox::~CGUIEditBox()
 //! Sets another skin independent font.
 void CGUIEditBox::setOverrideFont(IGUIFont* font)
 {
+	markDirty();
 	if (OverrideFont == font)
 		return;
 
@@ -110,6 +111,7 @@ IGUIFont* CGUIEditBox::getActiveFont() const
 //! Sets another color for the text.
 void CGUIEditBox::setOverrideColor(video::SColor color)
 {
+	markDirty();
 	OverrideColor = color;
 	OverrideColorEnabled = true;
 }
@@ -124,6 +126,7 @@ video::SColor CGUIEditBox::getOverrideColor() const
 //! Turns the border on or off
 void CGUIEditBox::setDrawBorder(bool border)
 {
+	markDirty();
 	Border = border;
 }
 
@@ -136,6 +139,7 @@ bool CGUIEditBox::isDrawBorderEnabled() const
 //! Sets whether to draw the background
 void CGUIEditBox::setDrawBackground(bool draw)
 {
+	markDirty();
 	Background = draw;
 }
 
@@ -148,6 +152,7 @@ bool CGUIEditBox::isDrawBackgroundEnabled() const
 //! Sets if the text should use the override color or the color in the gui skin.
 void CGUIEditBox::enableOverrideColor(bool enable)
 {
+	markDirty();
 	OverrideColorEnabled = enable;
 }
 
@@ -159,6 +164,7 @@ bool CGUIEditBox::isOverrideColorEnabled() const
 //! Enables or disables word wrap
 void CGUIEditBox::setWordWrap(bool enable)
 {
+	markDirty();
 	WordWrap = enable;
 	breakText();
 }
@@ -187,6 +193,7 @@ bool CGUIEditBox::isWordWrapEnabled() const
 //! Enables or disables newlines.
 void CGUIEditBox::setMultiLine(bool enable)
 {
+	markDirty();
 	MultiLine = enable;
 	breakText();
 }
@@ -201,6 +208,7 @@ bool CGUIEditBox::isMultiLineEnabled() const
 
 void CGUIEditBox::setPasswordBox(bool passwordBox, wchar_t passwordChar)
 {
+	markDirty();
 	PasswordBox = passwordBox;
 	if (PasswordBox)
 	{
@@ -221,6 +229,7 @@ bool CGUIEditBox::isPasswordBox() const
 //! Sets text justification
 void CGUIEditBox::setTextAlignment(EGUI_ALIGNMENT horizontal, EGUI_ALIGNMENT vertical)
 {
+	markDirty();
 	HAlign = horizontal;
 	VAlign = vertical;
 }
@@ -776,6 +785,7 @@ void CGUIEditBox::draw()
 		return;
 
 	const bool focus = Environment->hasFocus(this);
+	CursorVisible = isCursorVisible();
 
 	IGUISkin* skin = Environment->getSkin();
 	if (!skin)
@@ -949,7 +959,7 @@ void CGUIEditBox::draw()
 			charcursorpos = font->getDimension(s.c_str()).Width +
 				font->getKerningWidth(CursorChar.c_str(), CursorPos-startPos > 0 ? &((*txtLine)[CursorPos-startPos-1]) : 0);
 
-			if (focus && (CursorBlinkTime == 0 || (os::Timer::getTime() - BlinkStartTime) % (2*CursorBlinkTime) < CursorBlinkTime))
+			if (CursorVisible)
 			{
 				setTextRect(cursorLine);
 				CurrentTextRect.UpperLeftCorner.X += charcursorpos;
@@ -982,9 +992,28 @@ void CGUIEditBox::draw()
 }
 
 
+//! marks the edit box dirty when the cursor blinks
+void CGUIEditBox::OnPostRender(u32 timeMs)
+{
+	if (IsVisible && isCursorVisible() != CursorVisible)
+		markDirty();
+
+	IGUIElement::OnPostRender(timeMs);
+}
+
+
+//! Returns if the cursor is shown at the current time
+bool CGUIEditBox::isCursorVisible() const
+{
+	return Environment->hasFocus(this) && (CursorBlinkTime == 0 ||
+		(os::Timer::getTime() - BlinkStartTime) % (2*CursorBlinkTime) < CursorBlinkTime);
+}
+
+
 //! Sets the new caption of this element.
 void CGUIEditBox::setText(const wchar_t* text)
 {
+	markDirty();
 	Text = text;
 	if (u32(CursorPos) > Text.size())
 		CursorPos = Text.size();
@@ -1034,6 +1063,7 @@ core::dimension2du CGUIEditBox::getTextDimension()
 //! infinity.
 void CGUIEditBox::setMax(u32 max)
 {
+	markDirty();
 	Max = max;
 
 	if (Text.size() > Max && Max != 0)
@@ -1051,6 +1081,7 @@ u32 CGUIEditBox::getMax() const
 /** By default it's "_" */
 void CGUIEditBox::setCursorChar(const wchar_t cursorChar)
 {
+	markDirty();
 	CursorChar[0] = cursorChar;
 }
 
@@ -1063,6 +1094,7 @@ wchar_t CGUIEditBox::getCursorChar() const
 //! Set the blinktime for the cursor. 2x blinktime is one full cycle.
 void CGUIEditBox::setCursorBlinkTime(irr::u32 timeMs)
 {
+	markDirty();
 	CursorBlinkTime = timeMs;
 }
 
@@ -1606,6 +1638,7 @@ void CGUIEditBox::calculateFrameRect()
 //! set text markers
 void CGUIEditBox::setTextMarkers(s32 begin, s32 end)
 {
+	markDirty();
 	if ( begin != MarkBegin || end != MarkEnd )
 	{
 		MarkBegin = begin;
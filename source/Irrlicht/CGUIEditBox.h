@@ -102,6 +102,9 @@ namespace gui
 		//! draws the element and its children
 		virtual void draw() _IRR_OVERRIDE_;
 
+		//! marks the edit box dirty when the cursor blinks
+		virtual void OnPostRender(u32 timeMs) _IRR_OVERRIDE_;
+
 		//! Sets the new caption of this element.
 		virtual void setText(const wchar_t* text) _IRR_OVERRIDE_;
 
@@ -150,6 +153,8 @@ namespace gui
 		void breakText();
 		//! sets the area of the given line
 		void setTextRect(s32 line);
+		//! Returns if the cursor is shown at the current time
+		bool isCursorVisible() const;
 		//! returns the line number that the cursor is on
 		s32 getLineFromPos(s32 pos);
 		//! adds a letter to the edit box
@@ -183,6 +188,7 @@ namespace gui
 
 		u32 BlinkStartTime;
 		irr::u32 CursorBlinkTime;
+		bool CursorVisible; // blink state of the last draw
 		core::stringw CursorChar; // IGUIFont::draw needs stringw instead of wchar_t
 		s32 CursorPos;
 		s32 HScrollPos, VScrollPos; // scroll position in characters
@@ -8,6 +8,7 @@
 #ifdef _IRR_COMPILE_WITH_GUI_
 
 #include "IVideoDriver.h"
+#include "IRenderTarget.h"
 
 #include "CGUISkin.h"
 #include "CGUIButton.h"
@@ -59,7 +60,8 @@ const io::path CGUIEnvironment::DefaultFontName = "#DefaultFont";
 CGUIEnvironment::CGUIEnvironment(io::IFileSystem* fs, video::IVideoDriver* driver, IOSOperator* op)
 : IGUIElement(EGUIET_ROOT, 0, 0, 0, core::rect<s32>(driver ? core::dimension2d<s32>(driver->getScreenSize()) : core::dimension2d<s32>(0,0))),
 	Driver(driver), Hovered(0), HoveredNoSubelement(0), Focus(0), LastHoveredMousePos(0,0), CurrentSkin(0),
-	FileSystem(fs), UserReceiver(0), Operator(op), FocusFlags(EFF_SET_ON_LMOUSE_DOWN|EFF_SET_ON_TAB)
+	FileSystem(fs), UserReceiver(0), Operator(op), FocusFlags(EFF_SET_ON_LMOUSE_DOWN|EFF_SET_ON_TAB),
+	LayerTarget(0), LayerTextureCount(0), RetainedMode(false), MovingLayer(false)
 {
 	if (Driver)
 		Driver->grab();
@@ -125,6 +127,8 @@ CGUIEnvironment::~CGUIEnvironment()
 		ToolTip.Element = 0;
 	}
 
+	removeLayers();
+
 	// drop skin
 	if (CurrentSkin)
 	{
@@ -204,6 +208,7 @@ void CGUIEnvironment::drawAll()
 			AbsoluteClippingRect = DesiredRect;
 			AbsoluteRect = DesiredRect;
 			updateAbsolutePosition();
+			markDirty(0);
 		}
 	}
 
@@ -211,11 +216,268 @@ void CGUIEnvironment::drawAll()
 	if (ToolTip.Element)
 		bringToFront(ToolTip.Element);
 
-	draw();
+	// layers need blending with separate alpha factors, which Burnings does in its 2d methods
+	if (RetainedMode && Driver && Driver->queryFeature(video::EVDF_RENDER_TO_TARGET) &&
+		(Driver->queryFeature(video::EVDF_BLEND_SEPARATE) || Driver->getDriverType() == video::EDT_BURNINGSVIDEO))
+		drawRetained();
+	else
+		draw();
+
 	OnPostRender ( os::Timer::getTime () );
 }
 
 
+//! Sets if the top level elements are drawn from cached render target textures
+void CGUIEnvironment::setRetainedMode(bool retained)
+{
+	if (!retained)
+		removeLayers();
+
+	RetainedMode = retained;
+}
+
+
+//! Returns if the top level elements are drawn from cached textures
+bool CGUIEnvironment::isRetainedMode() const
+{
+	return RetainedMode;
+}
+
+
+//! Marks an element as changed, so it is drawn again in retained mode
+void CGUIEnvironment::markDirty(IGUIElement* element)
+{
+	if (!RetainedMode || MovingLayer)
+		return;
+
+	if (!element)
+	{
+		for (u32 i=0; i<Layers.size(); ++i)
+			Layers[i].Dirty = true;
+		return;
+	}
+
+	// layers belong to the children of the root, which get new layers when they are added
+	IGUIElement* top = element;
+	while (top->getParent() && top->getParent() != this)
+		top = top->getParent();
+	if (top->getParent() != this)
+		return;
+
+	for (u32 i=0; i<Layers.size(); ++i)
+	{
+		if (Layers[i].Element == top)
+		{
+			Layers[i].Dirty = true;
+			return;
+		}
+	}
+}
+
+
+//! Draws the visible top level elements from their layers, draws changed ones first
+void CGUIEnvironment::drawRetained()
+{
+	removeUnusedLayers();
+
+	// the layers keep alpha premultiplied colors, so translucent colors are blended only once.
+	// the blending is set by the 2d override material, which is only enabled while it is needed
+	video::SMaterial& material = Driver->getMaterial2D();
+	const video::E_BLEND_OPERATION blendOperation = material.BlendOperation;
+	const f32 blendFactor = material.BlendFactor;
+	material.BlendOperation = video::EBO_ADD;
+	material.BlendFactor = video::pack_textureBlendFuncSeparate(video::EBF_SRC_ALPHA, video::EBF_ONE_MINUS_SRC_ALPHA,
+		video::EBF_ONE, video::EBF_ONE_MINUS_SRC_ALPHA);
+
+	// all changed layers are drawn before the previous render target is set again
+	video::IRenderTarget* target = Driver->getCurrentRenderTarget();
+	bool targetChanged = false;
+	core::list<IGUIElement*>::Iterator it = Children.begin();
+	for (; it != Children.end(); ++it)
+	{
+		if (!(*it)->isVisible())
+			continue;
+
+		SRetainedLayer& layer = getLayer(*it);
+		if (layer.Dirty)
+		{
+			drawLayer(layer);
+			targetChanged = true;
+		}
+	}
+
+	if (targetChanged)
+		Driver->setRenderTargetEx(target, 0);
+
+	material.BlendFactor = video::pack_textureBlendFunc(video::EBF_ONE, video::EBF_ONE_MINUS_SRC_ALPHA);
+	for (it = Children.begin(); it != Children.end(); ++it)
+	{
+		if (!(*it)->isVisible())
+			continue;
+
+		const SRetainedLayer& layer = getLayer(*it);
+		if (!layer.Texture)
+			(*it)->draw();
+		else if (layer.Rect.getArea() > 0)
+		{
+			Driver->enableMaterial2D();
+			Driver->draw2DImage(layer.Texture, layer.Rect.UpperLeftCorner,
+				core::rect<s32>(core::position2d<s32>(0,0), layer.Rect.getSize()), 0,
+				video::SColor(255,255,255,255), true);
+			Driver->enableMaterial2D(false);
+		}
+	}
+
+	material.BlendOperation = blendOperation;
+	material.BlendFactor = blendFactor;
+}
+
+
+//! Draws a top level element and its children into its layer texture
+void CGUIEnvironment::drawLayer(SRetainedLayer& layer)
+{
+	layer.Dirty = false;
+
+	// the layer covers the visible area of the element and its children
+	layer.Rect = core::rect<s32>(0,0,0,0);
+	bool first = true;
+	core::array<IGUIElement*> stack;
+	stack.push_back(layer.Element);
+	while (stack.size())
+	{
+		IGUIElement* element = stack.getLast();
+		stack.erase(stack.size()-1);
+
+		const core::rect<s32> clip = element->getAbsoluteClippingRect();
+		if (clip.isValid() && clip.getArea() > 0)
+		{
+			if (first)
+				layer.Rect = clip;
+			else
+			{
+				layer.Rect.addInternalPoint(clip.UpperLeftCorner);
+				layer.Rect.addInternalPoint(clip.LowerRightCorner);
+			}
+			first = false;
+		}
+
+		core::list<IGUIElement*>::ConstIterator it = element->getChildren().begin();
+		for (; it != element->getChildren().end(); ++it)
+		{
+			if ((*it)->isVisible())
+				stack.push_back(*it);
+		}
+	}
+	layer.Rect.clipAgainst(AbsoluteRect);
+	if (!layer.Rect.isValid() || layer.Rect.getArea() <= 0)
+		return;
+
+	// the texture grows in steps and is kept when elements move or grow a bit
+	const core::dimension2du needed(layer.Rect.getWidth(), layer.Rect.getHeight());
+	if (!layer.Texture || layer.Texture->getSize().Width < needed.Width || layer.Texture->getSize().Height < needed.Height)
+	{
+		if (layer.Texture)
+			Driver->removeTexture(layer.Texture);
+
+		const core::dimension2du size(
+			core::min_((needed.Width + 63) & ~63u, (u32)AbsoluteRect.getWidth()),
+			core::min_((needed.Height + 63) & ~63u, (u32)AbsoluteRect.getHeight()));
+		layer.Texture = Driver->addRenderTargetTexture(size,
+			io::path("<GUI layer ") + io::path(LayerTextureCount++) + ">", video::ECF_A8R8G8B8);
+
+		if (!layer.Texture)
+		{
+			os::Printer::log("Could not create texture for retained GUI, drawing directly.", ELL_WARNING);
+			return;
+		}
+	}
+
+	if (!LayerTarget)
+		LayerTarget = Driver->addRenderTarget();
+	LayerTarget->setTexture(layer.Texture, 0);
+
+	if (!Driver->setRenderTargetEx(LayerTarget, video::ECBF_COLOR, video::SColor(0,0,0,0)))
+		return;
+
+	// the elements are moved to the corner of the texture by moving the root, its size stays the same
+	const core::rect<s32> absoluteRect = AbsoluteRect;
+	const core::rect<s32> absoluteClippingRect = AbsoluteClippingRect;
+	MovingLayer = true;
+	AbsoluteRect -= layer.Rect.UpperLeftCorner;
+	AbsoluteClippingRect -= layer.Rect.UpperLeftCorner;
+	layer.Element->updateAbsolutePosition();
+	MovingLayer = false;
+
+	Driver->enableMaterial2D();
+	layer.Element->draw();
+	Driver->enableMaterial2D(false);
+
+	MovingLayer = true;
+	AbsoluteRect = absoluteRect;
+	AbsoluteClippingRect = absoluteClippingRect;
+	layer.Element->updateAbsolutePosition();
+	MovingLayer = false;
+}
+
+
+//! Returns the layer of a top level element, creates it if needed
+CGUIEnvironment::SRetainedLayer& CGUIEnvironment::getLayer(IGUIElement* element)
+{
+	for (u32 i=0; i<Layers.size(); ++i)
+	{
+		if (Layers[i].Element == element)
+			return Layers[i];
+	}
+
+	// the element is kept, so a new element can't get the layer of a deleted one
+	SRetainedLayer layer;
+	layer.Element = element;
+	layer.Element->grab();
+	layer.Texture = 0;
+	layer.Dirty = true;
+	Layers.push_back(layer);
+
+	return Layers.getLast();
+}
+
+
+//! Removes the layers of elements which are no children of the root anymore
+void CGUIEnvironment::removeUnusedLayers()
+{
+	for (u32 i=0; i<Layers.size();)
+	{
+		if (Layers[i].Element->getParent() != this)
+		{
+			if (Layers[i].Texture)
+				Driver->removeTexture(Layers[i].Texture);
+			Layers[i].Element->drop();
+			Layers.erase(i);
+		}
+		else
+			++i;
+	}
+}
+
+
+//! Removes all layers and their textures
+void CGUIEnvironment::removeLayers()
+{
+	for (u32 i=0; i<Layers.size(); ++i)
+	{
+		if (Layers[i].Texture)
+			Driver->removeTexture(Layers[i].Texture);
+		Layers[i].Element->drop();
+	}
+	Layers.clear();
+
+	if (LayerTarget)
+	{
+		Driver->removeRenderTarget(LayerTarget);
+		LayerTarget = 0;
+	}
+}
+
+
 //! sets the focus to an element
 bool CGUIEnvironment::setFocus(IGUIElement* element)
 {
@@ -280,10 +542,15 @@ bool CGUIEnvironment::setFocus(IGUIElement* element)
 		currentFocus->drop();
 
 	if (Focus)
+	{
+		markDirty(Focus);
 		Focus->drop();
+	}
 
 	// element is the new focus so it doesn't have to be dropped
 	Focus = element;
+	if (Focus)
+		markDirty(Focus);
 
 	return true;
 }
@@ -510,6 +777,11 @@ void CGUIEnvironment::updateHoveredElement(core::position2d<s32> mousePos)
 		SEvent event;
 		event.EventType = EET_GUI_EVENT;
 
+		if (lastHovered)
+			markDirty(lastHovered);
+		if (Hovered)
+			markDirty(Hovered);
+
 		if (lastHovered)
 		{
 			event.GUIEvent.Caller = lastHovered;
@@ -573,6 +845,12 @@ bool CGUIEnvironment::postEventFromUser(const SEvent& event)
 
 		updateHoveredElement(core::position2d<s32>(event.MouseInput.X, event.MouseInput.Y));
 
+		// elements receiving input usually change. Moving the mouse only changes the focus while dragging
+		if (Hovered)
+			markDirty(Hovered);
+		if (Focus && (event.MouseInput.Event != EMIE_MOUSE_MOVED || event.MouseInput.ButtonStates))
+			markDirty(Focus);
+
 		if ( Hovered != Focus )
 		{
 			IGUIElement * focusCandidate = Hovered;
@@ -612,6 +890,9 @@ bool CGUIEnvironment::postEventFromUser(const SEvent& event)
 		break;
 	case EET_KEY_INPUT_EVENT:
 		{
+			if (Focus)
+				markDirty(Focus);
+
 			if (Focus && Focus->OnEvent(event))
 				return true;
 
@@ -659,6 +940,8 @@ void CGUIEnvironment::setSkin(IGUISkin* skin)
 
 	if (CurrentSkin)
 		CurrentSkin->grab();
+
+	markDirty(0);
 }
 
 
@@ -20,6 +20,10 @@ namespace io
 {
 	class IXMLWriter;
 }
+namespace video
+{
+	class IRenderTarget;
+}
 namespace gui
 {
 
@@ -36,6 +40,15 @@ public:
 	//! draws all gui elements
 	virtual void drawAll() _IRR_OVERRIDE_;
 
+	//! Sets if the top level elements are drawn from cached render target textures
+	virtual void setRetainedMode(bool retained) _IRR_OVERRIDE_;
+
+	//! Returns if the top level elements are drawn from cached textures
+	virtual bool isRetainedMode() const _IRR_OVERRIDE_;
+
+	//! Marks an element as changed, so it is drawn again in retained mode
+	virtual void markDirty(IGUIElement* element=0) _IRR_OVERRIDE_;
+
 	//! returns the current video driver
 	virtual video::IVideoDriver* getVideoDriver() const _IRR_OVERRIDE_;
 
@@ -278,6 +291,31 @@ private:
 
 	void loadBuiltInFont();
 
+	//! Cached drawing of a top level element and its children
+	struct SRetainedLayer
+	{
+		IGUIElement* Element;
+		video::ITexture* Texture;
+		//! area of the screen drawn into the upper left corner of the texture
+		core::rect<s32> Rect;
+		bool Dirty;
+	};
+
+	//! Draws the visible top level elements from their layers, draws changed ones first
+	void drawRetained();
+
+	//! Draws a top level element and its children into its layer texture
+	void drawLayer(SRetainedLayer& layer);
+
+	//! Returns the layer of a top level element, creates it if needed
+	SRetainedLayer& getLayer(IGUIElement* element);
+
+	//! Removes the layers of elements which are no children of the root anymore
+	void removeUnusedLayers();
+
+	//! Removes all layers and their textures
+	void removeLayers();
+
 	struct SFont
 	{
 		io::SNamedPath NamedPath;
@@ -325,6 +363,14 @@ private:
 	IEventReceiver* UserReceiver;
 	IOSOperator* Operator;
 	u32 FocusFlags;
+
+	core::array<SRetainedLayer> Layers;
+	video::IRenderTarget* LayerTarget;
+	u32 LayerTextureCount;
+	bool RetainedMode;
+	//! elements moved into their layer texture don't mark it as changed
+	bool MovingLayer;
+
 	static const io::path DefaultFontName;
 };
 
@@ -37,6 +37,7 @@ CGUIImage::~CGUIImage()
 //! sets an image
 void CGUIImage::setImage(video::ITexture* image)
 {
+	markDirty();
 	if (image == Texture)
 		return;
 
@@ -58,6 +59,7 @@ video::ITexture* CGUIImage::getImage() const
 //! sets the color of the image
 void CGUIImage::setColor(video::SColor color)
 {
+	markDirty();
 	Color = color;
 }
 
@@ -119,6 +121,7 @@ void CGUIImage::draw()
 //! sets if the image should use its alpha channel to draw itself
 void CGUIImage::setUseAlphaChannel(bool use)
 {
+	markDirty();
 	UseAlphaChannel = use;
 }
 
@@ -126,6 +129,7 @@ void CGUIImage::setUseAlphaChannel(bool use)
 //! sets if the image should use its alpha channel to draw itself
 void CGUIImage::setScaleImage(bool scale)
 {
+	markDirty();
 	ScaleImage = scale;
 }
 
@@ -145,6 +149,7 @@ bool CGUIImage::isAlphaChannelUsed() const
 //! Sets the source rectangle of the image. By default the full image is used.
 void CGUIImage::setSourceRect(const core::rect<s32>& sourceRect)
 {
+	markDirty();
 	SourceRect = sourceRect;
 }
 
@@ -157,6 +162,7 @@ core::rect<s32> CGUIImage::getSourceRect() const
 //! Restrict target drawing-area.
 void CGUIImage::setDrawBounds(const core::rect<f32>& drawBoundUVs)
 {
+	markDirty();
 	DrawBounds = drawBoundUVs;
 	DrawBounds.UpperLeftCorner.X = core::clamp(DrawBounds.UpperLeftCorner.X, 0.f, 1.f);
 	DrawBounds.UpperLeftCorner.Y = core::clamp(DrawBounds.UpperLeftCorner.Y, 0.f, 1.f);
@@ -59,6 +59,10 @@ void CGUIInOutFader::draw()
 		driver->draw2DRectangle(newCol, AbsoluteRect, &AbsoluteClippingRect);
 	}
 
+	// a retained environment has to draw the fader again until it is done
+	if (now <= EndTime)
+		markDirty();
+
 	IGUIElement::draw();
 }
 
@@ -103,6 +107,7 @@ void CGUIInOutFader::setColor(video::SColor color)
 
 void CGUIInOutFader::setColor(video::SColor source, video::SColor dest)
 {
+	markDirty();
 	Color[0] = source;
 	Color[1] = dest;
 
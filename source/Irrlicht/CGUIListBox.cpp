@@ -99,6 +99,7 @@ s32 CGUIListBox::getIcon(u32 id) const
 //! adds a list item, returns id of item
 u32 CGUIListBox::addItem(const wchar_t* text)
 {
+	markDirty();
 	return addItem(text, -1);
 }
 
@@ -106,6 +107,7 @@ u32 CGUIListBox::addItem(const wchar_t* text)
 //! adds a list item, returns id of item
 void CGUIListBox::removeItem(u32 id)
 {
+	markDirty();
 	if (id >= Items.size())
 		return;
 
@@ -145,6 +147,7 @@ s32 CGUIListBox::getItemAt(s32 xpos, s32 ypos) const
 //! clears the list
 void CGUIListBox::clear()
 {
+	markDirty();
 	Items.clear();
 	ItemsIconWidth = 0;
 	Selected = -1;
@@ -201,6 +204,7 @@ s32 CGUIListBox::getSelected() const
 //! sets the selected item. Set this to -1 if no item should be selected
 void CGUIListBox::setSelected(s32 id)
 {
+	markDirty();
 	if ((u32)id>=Items.size())
 		Selected = -1;
 	else
@@ -214,6 +218,7 @@ void CGUIListBox::setSelected(s32 id)
 //! sets the selected item. Set this to -1 if no item should be selected
 void CGUIListBox::setSelected(const wchar_t *item)
 {
+	markDirty();
 	s32 index = -1;
 
 	if ( item )
@@ -597,6 +602,7 @@ void CGUIListBox::draw()
 //! adds an list item with an icon
 u32 CGUIListBox::addItem(const wchar_t* text, s32 icon)
 {
+	markDirty();
 	ListItem i;
 	i.Text = text;
 	i.Icon = icon;
@@ -611,6 +617,7 @@ u32 CGUIListBox::addItem(const wchar_t* text, s32 icon)
 
 void CGUIListBox::setSpriteBank(IGUISpriteBank* bank)
 {
+	markDirty();
 	if ( bank == IconBank )
 		return;
 	if (IconBank)
@@ -776,6 +783,7 @@ void CGUIListBox::recalculateItemWidth(s32 icon)
 
 void CGUIListBox::setItem(u32 index, const wchar_t* text, s32 icon)
 {
+	markDirty();
 	if ( index >= Items.size() )
 		return;
 
@@ -791,6 +799,7 @@ void CGUIListBox::setItem(u32 index, const wchar_t* text, s32 icon)
 //! Return the index on success or -1 on failure.
 s32 CGUIListBox::insertItem(u32 index, const wchar_t* text, s32 icon)
 {
+	markDirty();
 	ListItem i;
 	i.Text = text;
 	i.Icon = icon;
@@ -805,6 +814,7 @@ s32 CGUIListBox::insertItem(u32 index, const wchar_t* text, s32 icon)
 
 void CGUIListBox::swapItems(u32 index1, u32 index2)
 {
+	markDirty();
 	if ( index1 >= Items.size() || index2 >= Items.size() )
 		return;
 
@@ -816,6 +826,7 @@ void CGUIListBox::swapItems(u32 index1, u32 index2)
 
 void CGUIListBox::setItemOverrideColor(u32 index, video::SColor color)
 {
+	markDirty();
 	for ( u32 c=0; c < EGUI_LBC_COUNT; ++c )
 	{
 		Items[index].OverrideColors[c].Use = true;
@@ -826,6 +837,7 @@ void CGUIListBox::setItemOverrideColor(u32 index, video::SColor color)
 
 void CGUIListBox::setItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType, video::SColor color)
 {
+	markDirty();
 	if ( index >= Items.size() || colorType < 0 || colorType >= EGUI_LBC_COUNT )
 		return;
 
@@ -836,6 +848,7 @@ void CGUIListBox::setItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType,
 
 void CGUIListBox::clearItemOverrideColor(u32 index)
 {
+	markDirty();
 	for (u32 c=0; c < (u32)EGUI_LBC_COUNT; ++c )
 	{
 		Items[index].OverrideColors[c].Use = false;
@@ -845,6 +858,7 @@ void CGUIListBox::clearItemOverrideColor(u32 index)
 
 void CGUIListBox::clearItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType)
 {
+	markDirty();
 	if ( index >= Items.size() || colorType < 0 || colorType >= EGUI_LBC_COUNT )
 		return;
 
@@ -894,6 +908,7 @@ video::SColor CGUIListBox::getItemDefaultColor(EGUI_LISTBOX_COLOR colorType) con
 //! set global itemHeight
 void CGUIListBox::setItemHeight( s32 height )
 {
+	markDirty();
 	ItemHeight = height;
 	ItemHeightOverride = 1;
 }
@@ -902,6 +917,7 @@ void CGUIListBox::setItemHeight( s32 height )
 //! Sets whether to draw the background
 void CGUIListBox::setDrawBackground(bool draw)
 {
+	markDirty();
     DrawBack = draw;
 }
 
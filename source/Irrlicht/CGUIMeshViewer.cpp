@@ -46,6 +46,7 @@ void CGUIMeshViewer::setMesh(scene::IAnimatedMesh* mesh)
 		Mesh->drop();
 
 	Mesh = mesh;
+	markDirty();
 
 	/* This might be used for proper transformation etc.
 	core::vector3df center(0.0f,0.0f,0.0f);
@@ -147,6 +148,8 @@ void CGUIMeshViewer::draw()
 		u32 frame = 0;
 		if(Mesh->getFrameCount())
 			frame = (os::Timer::getTime()/20)%Mesh->getFrameCount();
+		if (Mesh->getFrameCount() > 1)
+			markDirty();
 		const scene::IMesh* const m = Mesh->getMesh(frame);
 		for (u32 i=0; i<m->getMeshBufferCount(); ++i)
 		{
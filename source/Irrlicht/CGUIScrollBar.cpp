@@ -346,6 +346,7 @@ s32 CGUIScrollBar::getPosFromMousePos(const core::position2di &pos) const
 //! sets the position of the scrollbar
 void CGUIScrollBar::setPos(s32 pos)
 {
+	markDirty();
 	Pos = core::s32_clamp ( pos, Min, Max );
 
 	if ( core::isnotzero ( range() ) )
@@ -411,6 +412,7 @@ s32 CGUIScrollBar::getMax() const
 //! sets the maximum value of the scrollbar.
 void CGUIScrollBar::setMax(s32 max)
 {
+	markDirty();
 	Max = max;
 	if ( Min > Max )
 		Min = Max;
@@ -431,6 +433,7 @@ s32 CGUIScrollBar::getMin() const
 //! sets the minimum value of the scrollbar.
 void CGUIScrollBar::setMin(s32 min)
 {
+	markDirty();
 	Min = min;
 	if ( Max < Min )
 		Max = Min;
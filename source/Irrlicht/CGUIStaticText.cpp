@@ -146,6 +146,7 @@ void CGUIStaticText::draw()
 //! Sets another skin independent font.
 void CGUIStaticText::setOverrideFont(IGUIFont* font)
 {
+	markDirty();
 	if (OverrideFont == font)
 		return;
 
@@ -180,6 +181,7 @@ IGUIFont* CGUIStaticText::getActiveFont() const
 //! Sets another color for the text.
 void CGUIStaticText::setOverrideColor(video::SColor color)
 {
+	markDirty();
 	OverrideColor = color;
 	OverrideColorEnabled = true;
 }
@@ -188,6 +190,7 @@ void CGUIStaticText::setOverrideColor(video::SColor color)
 //! Sets another color for the text.
 void CGUIStaticText::setBackgroundColor(video::SColor color)
 {
+	markDirty();
 	BGColor = color;
 	OverrideBGColorEnabled = true;
 	Background = true;
@@ -197,6 +200,7 @@ void CGUIStaticText::setBackgroundColor(video::SColor color)
 //! Sets whether to draw the background
 void CGUIStaticText::setDrawBackground(bool draw)
 {
+	markDirty();
 	Background = draw;
 }
 
@@ -218,6 +222,7 @@ bool CGUIStaticText::isDrawBackgroundEnabled() const
 //! Sets whether to draw the border
 void CGUIStaticText::setDrawBorder(bool draw)
 {
+	markDirty();
 	Border = draw;
 }
 
@@ -231,6 +236,7 @@ bool CGUIStaticText::isDrawBorderEnabled() const
 
 void CGUIStaticText::setTextRestrainedInside(bool restrainTextInside)
 {
+	markDirty();
 	RestrainTextInside = restrainTextInside;
 }
 
@@ -243,6 +249,7 @@ bool CGUIStaticText::isTextRestrainedInside() const
 
 void CGUIStaticText::setTextAlignment(EGUI_ALIGNMENT horizontal, EGUI_ALIGNMENT vertical)
 {
+	markDirty();
 	HAlign = horizontal;
 	VAlign = vertical;
 }
@@ -258,6 +265,7 @@ video::SColor CGUIStaticText::getOverrideColor() const
 //! color in the gui skin.
 void CGUIStaticText::enableOverrideColor(bool enable)
 {
+	markDirty();
 	OverrideColorEnabled = enable;
 }
 
@@ -272,6 +280,7 @@ bool CGUIStaticText::isOverrideColorEnabled() const
 //! multiline text control.
 void CGUIStaticText::setWordWrap(bool enable)
 {
+	markDirty();
 	WordWrap = enable;
 	breakText();
 }
@@ -285,6 +294,7 @@ bool CGUIStaticText::isWordWrapEnabled() const
 
 void CGUIStaticText::setRightToLeft(bool rtl)
 {
+	markDirty();
 	if (RightToLeft != rtl)
 	{
 		RightToLeft = rtl;
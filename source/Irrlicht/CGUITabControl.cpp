@@ -80,6 +80,7 @@ void CGUITab::draw()
 //! sets if the tab should draw its background
 void CGUITab::setDrawBackground(bool draw)
 {
+	markDirty();
 	DrawBackground = draw;
 }
 
@@ -87,6 +88,7 @@ void CGUITab::setDrawBackground(bool draw)
 //! sets the color of the background, if it should be drawn.
 void CGUITab::setBackgroundColor(video::SColor c)
 {
+	markDirty();
 	BackColor = c;
 }
 
@@ -94,6 +96,7 @@ void CGUITab::setBackgroundColor(video::SColor c)
 //! sets the color of the text
 void CGUITab::setTextColor(video::SColor c)
 {
+	markDirty();
 	OverrideTextColorEnabled = true;
 	TextColor = c;
 }
@@ -253,6 +256,7 @@ void CGUITabControl::refreshSprites()
 //! Adds a tab
 IGUITab* CGUITabControl::addTab(const wchar_t* caption, s32 id)
 {
+	markDirty();
 	CGUITab* tab = new CGUITab(Tabs.size(), Environment, this, calcTabPos(), id);
 
 	tab->setText(caption);
@@ -275,6 +279,7 @@ IGUITab* CGUITabControl::addTab(const wchar_t* caption, s32 id)
 //! adds a tab which has been created elsewhere
 void CGUITabControl::addTab(CGUITab* tab)
 {
+	markDirty();
 	if (!tab)
 		return;
 
@@ -313,6 +318,7 @@ void CGUITabControl::addTab(CGUITab* tab)
 //! Insert the tab at the given index
 IGUITab* CGUITabControl::insertTab(s32 idx, const wchar_t* caption, s32 id)
 {
+	markDirty();
 	if ( idx < 0 || idx > (s32)Tabs.size() )	// idx == Tabs.size() is indeed ok here as core::array can handle that
 		return NULL;
 
@@ -342,6 +348,7 @@ IGUITab* CGUITabControl::insertTab(s32 idx, const wchar_t* caption, s32 id)
 //! Removes a tab from the tabcontrol
 void CGUITabControl::removeTab(s32 idx)
 {
+	markDirty();
 	if ( idx < 0 || idx >= (s32)Tabs.size() )
 		return;
 
@@ -356,6 +363,7 @@ void CGUITabControl::removeTab(s32 idx)
 //! Clears the tabcontrol removing all tabs
 void CGUITabControl::clear()
 {
+	markDirty();
 	for (u32 i=0; i<Tabs.size(); ++i)
 	{
 		if (Tabs[i])
@@ -747,6 +755,7 @@ void CGUITabControl::draw()
 //! Set the height of the tabs
 void CGUITabControl::setTabHeight( s32 height )
 {
+	markDirty();
 	if ( height < 0 )
 		height = 0;
 
@@ -766,6 +775,7 @@ s32 CGUITabControl::getTabHeight() const
 //! set the maximal width of a tab. Per default width is 0 which means "no width restriction".
 void CGUITabControl::setTabMaxWidth(s32 width )
 {
+	markDirty();
 	TabMaxWidth = width;
 }
 
@@ -779,6 +789,7 @@ s32 CGUITabControl::getTabMaxWidth() const
 //! Set the extra width added to tabs on each side of the text
 void CGUITabControl::setTabExtraWidth( s32 extraWidth )
 {
+	markDirty();
 	if ( extraWidth < 0 )
 		extraWidth = 0;
 
@@ -820,6 +831,7 @@ void CGUITabControl::recalculateScrollBar()
 //! Set the alignment of the tabs
 void CGUITabControl::setTabVerticalAlignment( EGUI_ALIGNMENT alignment )
 {
+	markDirty();
 	VerticalAlignment = alignment;
 
 	recalculateScrollButtonPlacement();
@@ -932,6 +944,7 @@ s32 CGUITabControl::getActiveTab() const
 //! Brings a tab to front.
 bool CGUITabControl::setActiveTab(s32 idx)
 {
+	markDirty();
 	if ((u32)idx >= Tabs.size())
 		return false;
 
@@ -959,6 +972,7 @@ bool CGUITabControl::setActiveTab(s32 idx)
 
 bool CGUITabControl::setActiveTab(IGUITab *tab)
 {
+	markDirty();
 	for (s32 i=0; i<(s32)Tabs.size(); ++i)
 		if (Tabs[i] == tab)
 			return setActiveTab(i);
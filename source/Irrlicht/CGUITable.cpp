@@ -74,6 +74,7 @@ CGUITable::~CGUITable()
 
 void CGUITable::addColumn(const wchar_t* caption, s32 columnIndex)
 {
+	markDirty();
 	Column tabHeader;
 	tabHeader.Name = caption;
 	tabHeader.Width = getActiveFont()->getDimension(caption).Width + (CellWidthPadding * 2) + ARROW_PAD;
@@ -108,6 +109,7 @@ void CGUITable::addColumn(const wchar_t* caption, s32 columnIndex)
 //! remove a column from the table
 void CGUITable::removeColumn(u32 columnIndex)
 {
+	markDirty();
 	if ( columnIndex < Columns.size() )
 	{
 		Columns.erase(columnIndex);
@@ -137,6 +139,7 @@ s32 CGUITable::getRowCount() const
 
 bool CGUITable::setActiveColumn(s32 idx, bool doOrder )
 {
+	markDirty();
 	if ( idx >= (s32)Columns.size() )
 		idx = -1;
 
@@ -213,6 +216,7 @@ EGUI_ORDERING_MODE CGUITable::getActiveColumnOrdering() const
 
 void CGUITable::setColumnWidth(u32 columnIndex, u32 width)
 {
+	markDirty();
 	if ( columnIndex < Columns.size() )
 	{
 		const u32 MIN_WIDTH = getActiveFont()->getDimension(Columns[columnIndex].Name.c_str() ).Width + (CellWidthPadding * 2);
@@ -252,6 +256,7 @@ bool CGUITable::hasResizableColumns() const
 
 u32 CGUITable::addRow(u32 rowIndex)
 {
+	markDirty();
 	if ( rowIndex > Rows.size() )
 	{
 		rowIndex = Rows.size();
@@ -277,6 +282,7 @@ u32 CGUITable::addRow(u32 rowIndex)
 
 void CGUITable::removeRow(u32 rowIndex)
 {
+	markDirty();
 	if ( rowIndex > Rows.size() )
 		return;
 
@@ -292,6 +298,7 @@ void CGUITable::removeRow(u32 rowIndex)
 //! adds an list item, returns id of item
 void CGUITable::setCellText(u32 rowIndex, u32 columnIndex, const core::stringw& text)
 {
+	markDirty();
 	if ( rowIndex < Rows.size() && columnIndex < Columns.size() )
 	{
 		Rows[rowIndex].Items[columnIndex].Text = text;
@@ -305,6 +312,7 @@ void CGUITable::setCellText(u32 rowIndex, u32 columnIndex, const core::stringw&
 
 void CGUITable::setCellText(u32 rowIndex, u32 columnIndex, const core::stringw& text, video::SColor color)
 {
+	markDirty();
 	if ( rowIndex < Rows.size() && columnIndex < Columns.size() )
 	{
 		Rows[rowIndex].Items[columnIndex].Text = text;
@@ -317,6 +325,7 @@ void CGUITable::setCellText(u32 rowIndex, u32 columnIndex, const core::stringw&
 
 void CGUITable::setCellColor(u32 rowIndex, u32 columnIndex, video::SColor color)
 {
+	markDirty();
 	if ( rowIndex < Rows.size() && columnIndex < Columns.size() )
 	{
 		Rows[rowIndex].Items[columnIndex].Color = color;
@@ -359,6 +368,7 @@ void* CGUITable::getCellData(u32 rowIndex, u32 columnIndex ) const
 //! clears the list
 void CGUITable::clear()
 {
+	markDirty();
     Selected = -1;
 	Rows.clear();
 	Columns.clear();
@@ -375,6 +385,7 @@ void CGUITable::clear()
 
 void CGUITable::clearRows()
 {
+	markDirty();
     Selected = -1;
 	Rows.clear();
 
@@ -395,6 +406,7 @@ s32 CGUITable::getSelected() const
 //! set which row is currently selected
 void CGUITable::setSelected( s32 index )
 {
+	markDirty();
 	Selected = -1;
 	if ( index >= 0 && index < (s32) Rows.size() )
 		Selected = index;
@@ -657,6 +669,7 @@ bool CGUITable::OnEvent(const SEvent &event)
 
 void CGUITable::setColumnOrdering(u32 columnIndex, EGUI_COLUMN_ORDERING mode)
 {
+	markDirty();
 	if ( columnIndex < Columns.size() )
 		Columns[columnIndex].OrderingMode = mode;
 }
@@ -664,6 +677,7 @@ void CGUITable::setColumnOrdering(u32 columnIndex, EGUI_COLUMN_ORDERING mode)
 
 void CGUITable::swapRows(u32 rowIndexA, u32 rowIndexB)
 {
+	markDirty();
 	if ( rowIndexA >= Rows.size() )
 		return;
 
@@ -765,6 +779,7 @@ bool CGUITable::selectColumnHeader(s32 xpos, s32 ypos)
 
 void CGUITable::orderRows(s32 columnIndex, EGUI_ORDERING_MODE mode)
 {
+	markDirty();
 	Row swap;
 
 	if ( columnIndex == -1 )
@@ -1055,6 +1070,7 @@ void CGUITable::breakText(const core::stringw& text, core::stringw& brokenText,
 //! Set some flags influencing the layout of the table
 void CGUITable::setDrawFlags(s32 flags)
 {
+	markDirty();
 	DrawFlags = flags;
 }
 
@@ -1068,6 +1084,7 @@ s32 CGUITable::getDrawFlags() const
 //! Sets another skin independent font.
 void CGUITable::setOverrideFont(IGUIFont* font)
 {
+	markDirty();
 	if (OverrideFont == font)
 		return;
 
@@ -1120,6 +1137,7 @@ IGUIScrollBar* CGUITable::getHorizontalScrollBar() const
 //! Sets whether to draw the background.
 void CGUITable::setDrawBackground(bool draw)
 {
+	markDirty();
 	DrawBack = draw;
 }
 
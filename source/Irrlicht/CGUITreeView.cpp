@@ -56,16 +56,31 @@ IGUITreeViewNode* CGUITreeViewNode::getParent() const
 
 void CGUITreeViewNode::setText( const wchar_t* text )
 {
+	Owner->markDirty();
 	Text = text;
 }
 
 void CGUITreeViewNode::setIcon( const wchar_t* icon )
 {
+	Owner->markDirty();
 	Icon = icon;
 }
 
+void CGUITreeViewNode::setImageIndex( u32 imageIndex )
+{
+	Owner->markDirty();
+	ImageIndex = imageIndex;
+}
+
+void CGUITreeViewNode::setSelectedImageIndex( u32 imageIndex )
+{
+	Owner->markDirty();
+	SelectedImageIndex = imageIndex;
+}
+
 void CGUITreeViewNode::clearChildren()
 {
+	Owner->markDirty();
 	core::list<CGUITreeViewNode*>::Iterator	it;
 
 	for( it = Children.begin(); it != Children.end(); it++ )
@@ -83,6 +98,7 @@ IGUITreeViewNode* CGUITreeViewNode::addChildBack(
 	void*					data /*= 0*/,
 	IReferenceCounted*			data2 /*= 0*/ )
 {
+	Owner->markDirty();
 	CGUITreeViewNode*	newChild = new CGUITreeViewNode( Owner, this );
 
 	Children.push_back( newChild );
@@ -107,6 +123,7 @@ IGUITreeViewNode* CGUITreeViewNode::addChildFront(
 	void*					data /*= 0*/,
 	IReferenceCounted*			data2 /*= 0*/ )
 {
+	Owner->markDirty();
 	CGUITreeViewNode*	newChild = new CGUITreeViewNode( Owner, this );
 
 	Children.push_front( newChild );
@@ -132,6 +149,7 @@ IGUITreeViewNode* CGUITreeViewNode::insertChildAfter(
 	void*					data /*= 0*/,
 	IReferenceCounted*			data2/* = 0*/ )
 {
+	Owner->markDirty();
 	core::list<CGUITreeViewNode*>::Iterator	itOther;
 	CGUITreeViewNode*									newChild = 0;
 
@@ -166,6 +184,7 @@ IGUITreeViewNode* CGUITreeViewNode::insertChildBefore(
 	void*					data /*= 0*/,
 	IReferenceCounted*			data2/* = 0*/ )
 {
+	Owner->markDirty();
 	core::list<CGUITreeViewNode*>::Iterator	itOther;
 	CGUITreeViewNode*									newChild = 0;
 
@@ -290,6 +309,7 @@ IGUITreeViewNode* CGUITreeViewNode::getNextVisible() const
 
 bool CGUITreeViewNode::deleteChild( IGUITreeViewNode* child )
 {
+	Owner->markDirty();
 	core::list<CGUITreeViewNode*>::Iterator	itChild;
 	bool	deleted = false;
 
@@ -308,6 +328,7 @@ bool CGUITreeViewNode::deleteChild( IGUITreeViewNode* child )
 
 bool CGUITreeViewNode::moveChildUp( IGUITreeViewNode* child )
 {
+	Owner->markDirty();
 	core::list<CGUITreeViewNode*>::Iterator	itChild;
 	core::list<CGUITreeViewNode*>::Iterator	itOther;
 	CGUITreeViewNode*									nodeTmp;
@@ -333,6 +354,7 @@ bool CGUITreeViewNode::moveChildUp( IGUITreeViewNode* child )
 
 bool CGUITreeViewNode::moveChildDown( IGUITreeViewNode* child )
 {
+	Owner->markDirty();
 	core::list<CGUITreeViewNode*>::Iterator	itChild;
 	core::list<CGUITreeViewNode*>::Iterator	itOther;
 	CGUITreeViewNode*									nodeTmp;
@@ -359,6 +381,7 @@ bool CGUITreeViewNode::moveChildDown( IGUITreeViewNode* child )
 
 void CGUITreeViewNode::setExpanded( bool expanded )
 {
+	Owner->markDirty();
 	Expanded = expanded;
 }
 
@@ -366,6 +389,7 @@ void CGUITreeViewNode::setSelected( bool selected )
 {
 	if( Owner )
 	{
+		Owner->markDirty();
 		if( selected )
 		{
 			Owner->Selected = this;
@@ -526,6 +550,7 @@ CGUITreeView::~CGUITreeView()
 //! Sets another skin independent font.
 void CGUITreeView::setOverrideFont(IGUIFont* font)
 {
+	markDirty();
 	if (OverrideFont == font)
 		return;
 
@@ -1081,6 +1106,7 @@ void CGUITreeView::draw()
 //! Irrlicht engine as icon font, the icon strings defined in GUIIcons.h can be used.
 void CGUITreeView::setIconFont( IGUIFont* font )
 {
+	markDirty();
 	s32	height;
 
 	if ( font )
@@ -1105,6 +1131,7 @@ void CGUITreeView::setIconFont( IGUIFont* font )
 //! The default is 0 (no images).
 void CGUITreeView::setImageList( IGUIImageList* imageList )
 {
+	markDirty();
 	if (imageList )
 		imageList->grab();
 	if( ImageList )
@@ -54,16 +54,14 @@ namespace gui
 		{ return ImageIndex; }
 
 		//! sets the image index of the node
-		virtual void setImageIndex( u32 imageIndex ) _IRR_OVERRIDE_
-		{ ImageIndex = imageIndex; }
+		virtual void setImageIndex( u32 imageIndex ) _IRR_OVERRIDE_;
 
 		//! returns the image index of the node
 		virtual u32 getSelectedImageIndex() const _IRR_OVERRIDE_
 		{ return SelectedImageIndex; }
 
 		//! sets the image index of the node
-		virtual void setSelectedImageIndex( u32 imageIndex ) _IRR_OVERRIDE_
-		{ SelectedImageIndex = imageIndex; }
+		virtual void setSelectedImageIndex( u32 imageIndex ) _IRR_OVERRIDE_;
 
 		//! returns the user data (void*) of this node
 		virtual void* getData() const _IRR_OVERRIDE_
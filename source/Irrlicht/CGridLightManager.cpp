@@ -0,0 +1,304 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CGridLightManager.h"
+#include "ISceneManager.h"
+#include "ILightSceneNode.h"
+#include "IVideoDriver.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! grid cells per axis are limited, lights far apart only make the grid sparse
+static const u32 MAX_GRID_SIZE = 64;
+
+//! constructor
+CGridLightManager::CGridLightManager(ISceneManager* smgr, u32 lightsPerNode, f32 cellSize)
+	: SceneManager(smgr), Driver(smgr->getVideoDriver()),
+	LightsPerNode(lightsPerNode), CellSize(cellSize), LightList(0),
+	GridCellSize(1.f), QueryCount(0), Managing(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CGridLightManager");
+	#endif
+
+	GridSize[0] = GridSize[1] = GridSize[2] = 0;
+
+	if (!LightsPerNode && Driver)
+		LightsPerNode = Driver->getMaximalDynamicLightAmount();
+	if (!LightsPerNode)
+		LightsPerNode = 8;
+}
+
+
+//! Builds the grid from the lights of the frame
+void CGridLightManager::OnPreRender(core::array<ISceneNode*>& lightList)
+{
+	LightList = &lightList;
+	Managing = false;
+
+	Lights.set_used(0);
+	DirectionalLights.set_used(0);
+	f32 radiusSum = 0.f;
+	u32 pointLights = 0;
+
+	for (u32 i=0; i<lightList.size(); ++i)
+	{
+		// other nodes rendered in the light pass are left alone
+		if (lightList[i]->getType() != ESNT_LIGHT)
+			continue;
+
+		const video::SLight& data = static_cast<ILightSceneNode*>(lightList[i])->getLightData();
+
+		SGridLight light;
+		light.Position = data.Position;
+		light.Attenuation = data.Attenuation;
+		light.Radius = core::max_(data.Radius, 0.f);
+		light.Brightness = data.DiffuseColor.r + data.DiffuseColor.g + data.DiffuseColor.b;
+		light.Index = i;
+		light.Directional = data.Type == video::ELT_DIRECTIONAL;
+
+		if (light.Directional)
+		{
+			DirectionalLights.push_back(Lights.size());
+		}
+		else
+		{
+			const core::vector3df extent(light.Radius, light.Radius, light.Radius);
+			if (pointLights)
+				GridBox.addInternalPoint(light.Position - extent);
+			else
+				GridBox.reset(light.Position - extent);
+			GridBox.addInternalPoint(light.Position + extent);
+			radiusSum += light.Radius;
+			++pointLights;
+		}
+		Lights.push_back(light);
+	}
+
+	LightQuery.set_used(Lights.size());
+	for (u32 i=0; i<LightQuery.size(); ++i)
+		LightQuery[i] = 0;
+	QueryCount = 0;
+
+	// all lights are switched on when they are added to the driver
+	LightOn.set_used(Lights.size());
+	for (u32 i=0; i<LightOn.size(); ++i)
+		LightOn[i] = true;
+	SwitchedOn.set_used(0);
+
+	GridSize[0] = GridSize[1] = GridSize[2] = 0;
+	CellStart.set_used(0);
+	CellLights.set_used(0);
+	if (!pointLights)
+		return;
+
+	// about one light radius per cell unless set by the user
+	const core::vector3df extent = GridBox.getExtent();
+	GridCellSize = CellSize > 0.f ? CellSize : 2.f * radiusSum / pointLights;
+	GridCellSize = core::max_(GridCellSize,
+		core::max_(extent.X, extent.Y, extent.Z) / MAX_GRID_SIZE);
+	if (GridCellSize <= 0.f)
+		GridCellSize = 1.f;
+
+	const f32 size[3] = { extent.X, extent.Y, extent.Z };
+	u32 cellCount = 1;
+	for (u32 a=0; a<3; ++a)
+	{
+		GridSize[a] = core::clamp((u32)core::ceil32(size[a] / GridCellSize), (u32)1, MAX_GRID_SIZE);
+		cellCount *= GridSize[a];
+	}
+
+	// count the lights per cell, then fill each cell from its end
+	CellStart.set_used(cellCount+1);
+	for (u32 i=0; i<=cellCount; ++i)
+		CellStart[i] = 0;
+
+	for (u32 pass=0; pass<2; ++pass)
+	{
+		for (u32 i=0; i<Lights.size(); ++i)
+		{
+			const SGridLight& light = Lights[i];
+			if (light.Directional)
+				continue;
+
+			u32 from[3];
+			u32 to[3];
+			for (u32 a=0; a<3; ++a)
+			{
+				const f32 p = (&light.Position.X)[a] - (&GridBox.MinEdge.X)[a];
+				from[a] = core::clamp((s32)((p - light.Radius) / GridCellSize), 0, (s32)GridSize[a]-1);
+				to[a] = core::clamp((s32)((p + light.Radius) / GridCellSize), 0, (s32)GridSize[a]-1);
+			}
+
+			for (u32 z=from[2]; z<=to[2]; ++z)
+			for (u32 y=from[1]; y<=to[1]; ++y)
+			for (u32 x=from[0]; x<=to[0]; ++x)
+			{
+				const u32 cell = (z*GridSize[1] + y)*GridSize[0] + x;
+				if (pass == 0)
+					++CellStart[cell];
+				else
+					CellLights[--CellStart[cell]] = i;
+			}
+		}
+
+		if (pass == 0)
+		{
+			// CellStart[i] is the end of cell i now
+			for (u32 i=1; i<=cellCount; ++i)
+				CellStart[i] += CellStart[i-1];
+			CellLights.set_used(CellStart[cellCount]);
+		}
+	}
+}
+
+
+//! Switches all lights off after the driver lights were created
+void CGridLightManager::OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass)
+{
+	if (renderPass != ESNRP_LIGHT || !LightList || Lights.empty())
+		return;
+
+	// the nodes know their driver light, so lights the driver could not
+	// enable yet are switched on as well when a node selects them
+	Managing = true;
+	for (u32 i=0; i<Lights.size(); ++i)
+		switchLight(i, false);
+}
+
+
+//! Switches on the lights for the node
+void CGridLightManager::OnNodePreRender(ISceneNode* node)
+{
+	if (!Managing)
+		return;
+
+	selectLights(node->getTransformedBoundingBox());
+
+	// only switch the lights which differ from the last node
+	++QueryCount;
+	for (u32 i=0; i<Selected.size(); ++i)
+		LightQuery[Selected[i]] = QueryCount;
+
+	for (u32 i=0; i<SwitchedOn.size(); ++i)
+	{
+		if (LightQuery[SwitchedOn[i]] != QueryCount)
+			switchLight(SwitchedOn[i], false);
+	}
+
+	for (u32 i=0; i<Selected.size(); ++i)
+	{
+		if (!LightOn[Selected[i]])
+			switchLight(Selected[i], true);
+	}
+
+	SwitchedOn.swap(Selected);
+}
+
+
+//! Switches all lights on again
+void CGridLightManager::OnPostRender(void)
+{
+	if (Managing)
+	{
+		for (u32 i=0; i<Lights.size(); ++i)
+		{
+			if (!LightOn[i])
+				switchLight(i, true);
+		}
+	}
+
+	Managing = false;
+	LightList = 0;
+}
+
+
+//! Collects the lights for a bounding box into Selected, most relevant first
+void CGridLightManager::selectLights(const core::aabbox3df& box)
+{
+	Selected.set_used(0);
+	SelectedScore.set_used(0);
+
+	for (u32 i=0; i<DirectionalLights.size(); ++i)
+		addCandidate(DirectionalLights[i], FLT_MAX, LightsPerNode);
+
+	if (!GridSize[0] || !box.intersectsWithBox(GridBox))
+		return;
+
+	u32 from[3];
+	u32 to[3];
+	for (u32 a=0; a<3; ++a)
+	{
+		const f32 gridMin = (&GridBox.MinEdge.X)[a];
+		from[a] = core::clamp((s32)(((&box.MinEdge.X)[a] - gridMin) / GridCellSize), 0, (s32)GridSize[a]-1);
+		to[a] = core::clamp((s32)(((&box.MaxEdge.X)[a] - gridMin) / GridCellSize), 0, (s32)GridSize[a]-1);
+	}
+
+	++QueryCount;
+	for (u32 z=from[2]; z<=to[2]; ++z)
+	for (u32 y=from[1]; y<=to[1]; ++y)
+	for (u32 x=from[0]; x<=to[0]; ++x)
+	{
+		const u32 cell = (z*GridSize[1] + y)*GridSize[0] + x;
+		for (u32 c=CellStart[cell]; c<CellStart[cell+1]; ++c)
+		{
+			const u32 l = CellLights[c];
+			if (LightQuery[l] == QueryCount)
+				continue;
+			LightQuery[l] = QueryCount;
+
+			// distance from the light to the closest point of the box
+			const SGridLight& light = Lights[l];
+			f32 distanceSQ = 0.f;
+			for (u32 a=0; a<3; ++a)
+			{
+				const f32 p = (&light.Position.X)[a];
+				const f32 d = core::max_((&box.MinEdge.X)[a] - p, p - (&box.MaxEdge.X)[a], 0.f);
+				distanceSQ += d * d;
+			}
+			if (distanceSQ > light.Radius * light.Radius)
+				continue;
+
+			const f32 distance = core::squareroot(distanceSQ);
+			const f32 attenuation = light.Attenuation.X + light.Attenuation.Y * distance +
+				light.Attenuation.Z * distanceSQ;
+			addCandidate(l, attenuation > 0.f ? light.Brightness / attenuation : light.Brightness, LightsPerNode);
+		}
+	}
+}
+
+
+//! Adds a light to Selected if it is more relevant than the ones there
+void CGridLightManager::addCandidate(u32 light, f32 score, u32 maxCount)
+{
+	u32 pos = Selected.size();
+	while (pos > 0 && SelectedScore[pos-1] < score)
+		--pos;
+	if (pos >= maxCount)
+		return;
+
+	if (Selected.size() == maxCount)
+	{
+		Selected.erase(maxCount-1);
+		SelectedScore.erase(maxCount-1);
+	}
+	Selected.insert(light, pos);
+	SelectedScore.insert(score, pos);
+}
+
+
+//! Switches a light on or off through its scene node
+void CGridLightManager::switchLight(u32 light, bool on)
+{
+	LightOn[light] = on;
+	(*LightList)[Lights[light].Index]->setVisible(on);
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
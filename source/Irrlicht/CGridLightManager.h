@@ -0,0 +1,112 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_GRID_LIGHT_MANAGER_H_INCLUDED__
+#define __C_GRID_LIGHT_MANAGER_H_INCLUDED__
+
+#include "ISceneManager.h"
+#include "ILightManager.h"
+#include "vector3d.h"
+#include "aabbox3d.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+}
+namespace scene
+{
+
+	//! Light manager which switches on the most relevant lights for each node
+	/** The point and spot lights of a frame are binned into a uniform grid
+	by their radius of influence, so a node only has to look at the lights of
+	the cells its bounding box overlaps. Lights are switched with
+	ILightSceneNode::setVisible(), so it also works when the driver has more
+	lights than it can enable at once. */
+	class CGridLightManager : public ILightManager
+	{
+	public:
+
+		//! constructor
+		CGridLightManager(ISceneManager* smgr, u32 lightsPerNode, f32 cellSize);
+
+		//! Builds the grid from the lights of the frame
+		virtual void OnPreRender(core::array<ISceneNode*>& lightList) _IRR_OVERRIDE_;
+
+		//! Switches all lights on again
+		virtual void OnPostRender(void) _IRR_OVERRIDE_;
+
+		//! Does nothing
+		virtual void OnRenderPassPreRender(E_SCENE_NODE_RENDER_PASS renderPass) _IRR_OVERRIDE_ {}
+
+		//! Switches all lights off after the driver lights were created
+		virtual void OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass) _IRR_OVERRIDE_;
+
+		//! Switches on the lights for the node
+		virtual void OnNodePreRender(ISceneNode* node) _IRR_OVERRIDE_;
+
+		//! Does nothing, the lights stay on in case the next node needs them as well
+		virtual void OnNodePostRender(ISceneNode* node) _IRR_OVERRIDE_ {}
+
+	private:
+
+		struct SGridLight
+		{
+			core::vector3df Position;
+			core::vector3df Attenuation;
+			f32 Radius;
+			//! sum of the diffuse color
+			f32 Brightness;
+			//! index of the light node in the light list
+			u32 Index;
+			bool Directional;
+		};
+
+		//! Collects the lights for a bounding box into Selected, most relevant first
+		void selectLights(const core::aabbox3df& box);
+
+		//! Adds a light to Selected if it is more relevant than the ones there
+		void addCandidate(u32 light, f32 score, u32 maxCount);
+
+		//! Switches a light on or off through its scene node
+		void switchLight(u32 light, bool on);
+
+		ISceneManager* SceneManager;
+		video::IVideoDriver* Driver;
+
+		u32 LightsPerNode;
+		f32 CellSize;
+
+		core::array<ISceneNode*>* LightList;
+		core::array<SGridLight> Lights;
+		core::array<u32> DirectionalLights;
+
+		//! grid over the influence of all point and spot lights
+		core::aabbox3df GridBox;
+		f32 GridCellSize;
+		u32 GridSize[3];
+		//! lights of cell i are CellLights[CellStart[i]] to CellLights[CellStart[i+1]-1]
+		core::array<u32> CellStart;
+		core::array<u32> CellLights;
+
+		//! query in which a light was last looked at, avoids testing it twice
+		core::array<u32> LightQuery;
+		u32 QueryCount;
+
+		core::array<u32> Selected;
+		core::array<f32> SelectedScore;
+
+		//! lights switched on in the driver, per light
+		core::array<bool> LightOn;
+		core::array<u32> SwitchedOn;
+
+		bool Managing;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -7,6 +7,9 @@
 #include "CColorConverter.h"
 #include "CBlit.h"
 #include "os.h"
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include "ColorSSE2.h"
+#endif
 
 namespace irr
 {
@@ -257,6 +260,193 @@ void CImage::copyToScaling(IImage* target)
 }
 
 
+namespace
+{
+	//! Formats the box filter can read and write without getPixel and setPixel
+	inline bool isDirectBoxFilterFormat(ECOLOR_FORMAT format)
+	{
+		return format == ECF_A8R8G8B8 || format == ECF_A1R5G5B5;
+	}
+
+	//! Returns how many rows of the target image are filtered as one part of a parallel job
+	/** Parts should be large enough that splitting the work is worth it. */
+	inline u32 getRowsPerPart(u32 samplesPerRow)
+	{
+		return core::max_(65536u / core::max_(samplesPerRow, 1u), 1u);
+	}
+
+	//! Box filter for A8R8G8B8 and A1R5G5B5 images
+	/** Gives the same results as the generic version in CImage::copyToScalingBoxFilter,
+	but reads and writes the image memory directly. For up to 256 samples per
+	pixel alpha/green and red/blue are summed as two 16 bit lanes of an u32.
+	Images scaled to exactly half their size, like mipmap levels, are filtered
+	with SSE2 when it's available. */
+	class CBoxFilterJob : public os::IParallelJob
+	{
+	public:
+
+		CBoxFilterJob(const IImage* source, IImage* target, const core::array<s32>& x,
+			const core::array<s32>& y, s32 fx, s32 fy, s32 bias, u32 rowsPerPart)
+			: SourceData((const u8*)source->getData()), SourcePitch(source->getPitch()),
+			SourceWidth((s32)source->getDimension().Width), SourceHeight((s32)source->getDimension().Height),
+			SourceFormat(source->getColorFormat()),
+			TargetData((u8*)target->getData()), TargetPitch(target->getPitch()),
+			TargetSize(target->getDimension()), TargetFormat(target->getColorFormat()),
+			X(x), Y(y), FX(fx), FY(fy), Bias(bias), Shift(s32_log2_s32(fx*fy)),
+			Packed(fx*fy <= 256), RowsPerPart(rowsPerPart)
+		{
+			Half = (u32)SourceWidth == TargetSize.Width*2 && (u32)SourceHeight == TargetSize.Height*2;
+		}
+
+		virtual void run(u32 index) _IRR_OVERRIDE_
+		{
+			const u32 end = core::min_((index+1)*RowsPerPart, TargetSize.Height);
+			for (u32 y=index*RowsPerPart; y<end; ++y)
+				filterRow(y);
+		}
+
+	private:
+
+		inline u32 getSourcePixel(const u8* row, s32 x) const
+		{
+			if (SourceFormat == ECF_A8R8G8B8)
+				return ((const u32*)row)[x];
+			return A1R5G5B5toA8R8G8B8(((const u16*)row)[x]);
+		}
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		//! reads 4 pixels as A8R8G8B8
+		inline __m128i loadSource4(const u8* row, u32 x) const
+		{
+			if (SourceFormat == ECF_A8R8G8B8)
+				return _mm_loadu_si128((const __m128i*)(row + x*4));
+			return expandA1R5G5B5(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)(row + x*2)), _mm_setzero_si128()));
+		}
+
+		//! filters 2x2 pixels of the source into each target pixel, 4 at a time
+		/** Returns the number of target pixels done, the rest is done by filterRow. */
+		u32 filterRowHalf(u8* target, u32 y) const
+		{
+			const __m128i zero = _mm_setzero_si128();
+			// the sums shifted by 2 are at most 255, so the clamp is the same with a smaller bias
+			const __m128i bias = _mm_set1_epi16((s16)core::s32_clamp(Bias, -256, 256));
+			const u8* row0 = SourceData + y*2*SourcePitch;
+			const u8* row1 = row0 + SourcePitch;
+
+			u32 x = 0;
+			for (; x + 4 <= TargetSize.Width; x += 4)
+			{
+				__m128i pairs[2];
+				for (u32 i=0; i<2; ++i)
+				{
+					// both rows of 2 target pixels, 4 channels of 2 source pixels each
+					const __m128i c0 = loadSource4(row0, x*2 + i*4);
+					const __m128i c1 = loadSource4(row1, x*2 + i*4);
+					const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(c0, zero), _mm_unpacklo_epi8(c1, zero));
+					const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(c0, zero), _mm_unpackhi_epi8(c1, zero));
+					const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+					pairs[i] = _mm_add_epi16(_mm_srli_epi16(sum, 2), bias);
+				}
+				const __m128i color = _mm_packus_epi16(pairs[0], pairs[1]);
+
+				if (TargetFormat == ECF_A8R8G8B8)
+					_mm_storeu_si128((__m128i*)(target + x*4), color);
+				else
+				{
+					const __m128i c = signExtend16(reduceToA1R5G5B5(color));
+					_mm_storel_epi64((__m128i*)(target + x*2), _mm_packs_epi32(c, c));
+				}
+			}
+			return x;
+		}
+#endif
+
+		void filterRow(u32 y)
+		{
+			u8* target = TargetData + y*TargetPitch;
+			const s32 sy = Y[y];
+
+			u32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			if (Half)
+				x = filterRowHalf(target, y);
+#endif
+			for (; x<TargetSize.Width; ++x)
+			{
+				const s32 sx = X[x];
+				s32 a, r, g, b;
+
+				if (Packed)
+				{
+					u32 rb = 0;
+					u32 ag = 0;
+					for (s32 dy=0; dy!=FY; ++dy)
+					{
+						const u8* row = SourceData + core::s32_min(sy + dy, SourceHeight - 1)*SourcePitch;
+						for (s32 dx=0; dx!=FX; ++dx)
+						{
+							const u32 c = getSourcePixel(row, core::s32_min(sx + dx, SourceWidth - 1));
+							rb += c & 0x00FF00FF;
+							ag += (c >> 8) & 0x00FF00FF;
+						}
+					}
+					a = ag >> 16;
+					r = rb >> 16;
+					g = ag & 0xFFFF;
+					b = rb & 0xFFFF;
+				}
+				else
+				{
+					a = r = g = b = 0;
+					for (s32 dy=0; dy!=FY; ++dy)
+					{
+						const u8* row = SourceData + core::s32_min(sy + dy, SourceHeight - 1)*SourcePitch;
+						for (s32 dx=0; dx!=FX; ++dx)
+						{
+							const u32 c = getSourcePixel(row, core::s32_min(sx + dx, SourceWidth - 1));
+							a += c >> 24;
+							r += (c >> 16) & 0xFF;
+							g += (c >> 8) & 0xFF;
+							b += c & 0xFF;
+						}
+					}
+				}
+
+				a = core::s32_clamp( ( a >> Shift ) + Bias, 0, 255 );
+				r = core::s32_clamp( ( r >> Shift ) + Bias, 0, 255 );
+				g = core::s32_clamp( ( g >> Shift ) + Bias, 0, 255 );
+				b = core::s32_clamp( ( b >> Shift ) + Bias, 0, 255 );
+
+				const u32 color = (a << 24) | (r << 16) | (g << 8) | b;
+				if (TargetFormat == ECF_A8R8G8B8)
+					((u32*)target)[x] = color;
+				else
+					((u16*)target)[x] = A8R8G8B8toA1R5G5B5(color);
+			}
+		}
+
+		const u8* SourceData;
+		u32 SourcePitch;
+		s32 SourceWidth;
+		s32 SourceHeight;
+		ECOLOR_FORMAT SourceFormat;
+		u8* TargetData;
+		u32 TargetPitch;
+		core::dimension2d<u32> TargetSize;
+		ECOLOR_FORMAT TargetFormat;
+		const core::array<s32>& X;
+		const core::array<s32>& Y;
+		s32 FX;
+		s32 FY;
+		s32 Bias;
+		s32 Shift;
+		bool Packed;
+		bool Half;
+		u32 RowsPerPart;
+	};
+}
+
+
 //! copies this surface into another, scaling it to fit it.
 void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 {
@@ -278,6 +468,30 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 	f32 sx;
 	f32 sy;
 
+	if (!blend && isDirectBoxFilterFormat(Format) && isDirectBoxFilterFormat(target->getColorFormat()))
+	{
+		// box positions are calculated exactly like in the generic loop below
+		core::array<s32> boxX(destSize.Width);
+		core::array<s32> boxY(destSize.Height);
+		sx = 0.f;
+		for ( u32 x = 0; x != destSize.Width; ++x )
+		{
+			boxX.push_back(core::floor32(sx));
+			sx += sourceXStep;
+		}
+		sy = 0.f;
+		for ( u32 y = 0; y != destSize.Height; ++y )
+		{
+			boxY.push_back(core::floor32(sy));
+			sy += sourceYStep;
+		}
+
+		const u32 rowsPerPart = getRowsPerPart(destSize.Width*fx*fy);
+		CBoxFilterJob job(this, target, boxX, boxY, fx, fy, bias, rowsPerPart);
+		os::Parallel::run(job, (destSize.Height + rowsPerPart - 1) / rowsPerPart);
+		return;
+	}
+
 	sy = 0.f;
 	for ( u32 y = 0; y != destSize.Height; ++y )
 	{
@@ -293,6 +507,260 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 }
 
 
+namespace
+{
+	//! Source pixels and their weights for each target pixel along one axis
+	struct SFilterTaps
+	{
+		//! Taps per target pixel
+		u32 Count;
+
+		//! Source pixel of each tap, already clamped to the image
+		core::array<s32> Index;
+
+		//! Normalized weight of each tap
+		core::array<f32> Weight;
+	};
+
+	f32 getFilterRadius(E_IMAGE_SCALING_FILTER filter)
+	{
+		return filter == EISF_LANCZOS ? 3.f : 1.f;
+	}
+
+	f32 getFilterWeight(E_IMAGE_SCALING_FILTER filter, f32 x)
+	{
+		x = core::abs_(x);
+		if (filter == EISF_LANCZOS)
+		{
+			if (x < 0.00001f)
+				return 1.f;
+			if (x >= 3.f)
+				return 0.f;
+			const f32 px = core::PI * x;
+			return 3.f * sinf(px) * sinf(px / 3.f) / (px * px);
+		}
+		return x < 1.f ? 1.f - x : 0.f;
+	}
+
+	//! Calculates the taps of a separable filter for scaling sourceSize pixels to targetSize pixels
+	void calculateFilterTaps(SFilterTaps& taps, u32 sourceSize, u32 targetSize, E_IMAGE_SCALING_FILTER filter)
+	{
+		const f32 scale = (f32)targetSize / (f32)sourceSize;
+
+		// filters are stretched over several source pixels when scaling down
+		const f32 stretch = scale < 1.f ? 1.f / scale : 1.f;
+		const f32 radius = getFilterRadius(filter) * stretch;
+
+		taps.Count = (u32)core::ceil32(radius) * 2 + 1;
+		taps.Index.set_used(targetSize * taps.Count);
+		taps.Weight.set_used(targetSize * taps.Count);
+
+		for (u32 t=0; t<targetSize; ++t)
+		{
+			const f32 center = ((f32)t + 0.5f) / scale - 0.5f;
+			const s32 first = core::ceil32(center - radius);
+			s32* index = &taps.Index[t * taps.Count];
+			f32* weight = &taps.Weight[t * taps.Count];
+
+			f32 sum = 0.f;
+			for (u32 k=0; k<taps.Count; ++k)
+			{
+				const s32 s = first + (s32)k;
+				index[k] = core::s32_clamp(s, 0, (s32)sourceSize - 1);
+				weight[k] = getFilterWeight(filter, ((f32)s - center) / stretch);
+				sum += weight[k];
+			}
+
+			if (sum != 0.f)
+			{
+				for (u32 k=0; k<taps.Count; ++k)
+					weight[k] /= sum;
+			}
+			else
+			{
+				for (u32 k=0; k<taps.Count; ++k)
+					weight[k] = 0.f;
+				index[0] = core::s32_clamp(core::round32(center), 0, (s32)sourceSize - 1);
+				weight[0] = 1.f;
+			}
+		}
+	}
+
+	//! One pass of a separable filter
+	/** The horizontal pass filters A8R8G8B8 source rows into rows of 4 floats per pixel.
+	The vertical pass filters these rows into the target image. */
+	class CSeparableFilterJob : public os::IParallelJob
+	{
+	public:
+
+		CSeparableFilterJob(const SFilterTaps& taps, u32 rowsPerPart)
+			: Source(0), SourceWidth(0), Temp(0), TempWidth(0), Rows(0),
+			Target(0), TargetPitch(0), TargetFormat(ECF_A8R8G8B8),
+			Taps(taps), RowsPerPart(rowsPerPart)
+		{
+		}
+
+		virtual void run(u32 index) _IRR_OVERRIDE_
+		{
+			const u32 end = core::min_((index+1)*RowsPerPart, Rows);
+			if (Target)
+			{
+				core::array<u32> row;
+				row.set_used(TempWidth);
+				for (u32 y=index*RowsPerPart; y<end; ++y)
+					filterColumns(y, row.pointer());
+			}
+			else
+			{
+				for (u32 y=index*RowsPerPart; y<end; ++y)
+					filterRow(y);
+			}
+		}
+
+		//! Source of the horizontal pass
+		const u32* Source;
+		u32 SourceWidth;
+
+		//! Result of the horizontal pass, 4 floats per pixel
+		f32* Temp;
+		u32 TempWidth;
+
+		//! Rows to create in this pass
+		u32 Rows;
+
+		//! Target of the vertical pass
+		u8* Target;
+		u32 TargetPitch;
+		ECOLOR_FORMAT TargetFormat;
+
+	private:
+
+		void filterRow(u32 y)
+		{
+			const u32* source = Source + y*SourceWidth;
+			f32* temp = Temp + y*TempWidth*4;
+
+			for (u32 x=0; x<TempWidth; ++x)
+			{
+				const s32* index = &Taps.Index[x*Taps.Count];
+				const f32* weight = &Taps.Weight[x*Taps.Count];
+				f32 a = 0.f, r = 0.f, g = 0.f, b = 0.f;
+				for (u32 k=0; k<Taps.Count; ++k)
+				{
+					const u32 c = source[index[k]];
+					const f32 w = weight[k];
+					a += w * (f32)(c >> 24);
+					r += w * (f32)((c >> 16) & 0xFF);
+					g += w * (f32)((c >> 8) & 0xFF);
+					b += w * (f32)(c & 0xFF);
+				}
+				temp[x*4] = a;
+				temp[x*4+1] = r;
+				temp[x*4+2] = g;
+				temp[x*4+3] = b;
+			}
+		}
+
+		void filterColumns(u32 y, u32* row)
+		{
+			const s32* index = &Taps.Index[y*Taps.Count];
+			const f32* weight = &Taps.Weight[y*Taps.Count];
+
+			for (u32 x=0; x<TempWidth; ++x)
+			{
+				f32 a = 0.f, r = 0.f, g = 0.f, b = 0.f;
+				for (u32 k=0; k<Taps.Count; ++k)
+				{
+					const f32* c = Temp + (index[k]*TempWidth + x)*4;
+					const f32 w = weight[k];
+					a += w * c[0];
+					r += w * c[1];
+					g += w * c[2];
+					b += w * c[3];
+				}
+				row[x] = (toColorChannel(a) << 24) | (toColorChannel(r) << 16) |
+					(toColorChannel(g) << 8) | toColorChannel(b);
+			}
+
+			CColorConverter::convert_viaFormat(row, ECF_A8R8G8B8, TempWidth,
+				Target + y*TargetPitch, TargetFormat);
+		}
+
+		static inline u32 toColorChannel(f32 value)
+		{
+			return (u32)core::s32_clamp(core::round32(value), 0, 255);
+		}
+
+		const SFilterTaps& Taps;
+		u32 RowsPerPart;
+	};
+}
+
+
+//! copies this surface into another, scaling it to fit it with the given filter.
+void CImage::copyToScalingFiltered(IImage* target, E_IMAGE_SCALING_FILTER filter)
+{
+	if (IImage::isCompressedFormat(Format) || IImage::isCompressedFormat(target->getColorFormat()))
+	{
+		os::Printer::log("IImage::copyToScalingFiltered method doesn't work with compressed images.", ELL_WARNING);
+		return;
+	}
+
+	const core::dimension2d<u32> destSize = target->getDimension();
+	if (!destSize.Width || !destSize.Height || !Size.Width || !Size.Height)
+		return;
+
+	switch (filter)
+	{
+	case EISF_NEAREST:
+		copyToScaling(target);
+		return;
+	case EISF_BOX:
+		copyToScalingBoxFilter(target);
+		return;
+	default:
+		break;
+	}
+
+	// both passes work on A8R8G8B8 source pixels
+	core::array<u32> converted;
+	const u32* source = (const u32*)Data;
+	if (Format != ECF_A8R8G8B8)
+	{
+		converted.set_used(Size.Width*Size.Height);
+		CColorConverter::convert_viaFormat(Data, Format, Size.Width*Size.Height, converted.pointer(), ECF_A8R8G8B8);
+		source = converted.const_pointer();
+	}
+
+	SFilterTaps horizontal;
+	SFilterTaps vertical;
+	calculateFilterTaps(horizontal, Size.Width, destSize.Width, filter);
+	calculateFilterTaps(vertical, Size.Height, destSize.Height, filter);
+
+	core::array<f32> temp;
+	temp.set_used(destSize.Width*Size.Height*4);
+
+	u32 rowsPerPart = getRowsPerPart(destSize.Width*horizontal.Count);
+	CSeparableFilterJob rows(horizontal, rowsPerPart);
+	rows.Source = source;
+	rows.SourceWidth = Size.Width;
+	rows.Temp = temp.pointer();
+	rows.TempWidth = destSize.Width;
+	rows.Rows = Size.Height;
+	os::Parallel::run(rows, (Size.Height + rowsPerPart - 1) / rowsPerPart);
+
+	rowsPerPart = getRowsPerPart(destSize.Width*vertical.Count);
+	CSeparableFilterJob columns(vertical, rowsPerPart);
+	columns.Temp = temp.pointer();
+	columns.TempWidth = destSize.Width;
+	columns.Rows = destSize.Height;
+	columns.Target = (u8*)target->getData();
+	columns.TargetPitch = target->getPitch();
+	columns.TargetFormat = target->getColorFormat();
+	os::Parallel::run(columns, (destSize.Height + rowsPerPart - 1) / rowsPerPart);
+}
+
+
 //! fills the surface with given color
 void CImage::fill(const SColor &color)
 {
@@ -0,0 +1,617 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInstancedMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "S3DVertex.h"
+#include "ICameraSceneNode.h"
+#include "IMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IMaterialRenderer.h"
+#include "IFileSystem.h"
+#include "FrustumBoxCulling.h"
+
+#include <string.h>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! Multiplies two colors channel by channel
+	inline video::SColor modulateColor(const video::SColor& a, const video::SColor& b)
+	{
+		return video::SColor((a.getAlpha() * b.getAlpha()) / 255, (a.getRed() * b.getRed()) / 255,
+			(a.getGreen() * b.getGreen()) / 255, (a.getBlue() * b.getBlue()) / 255);
+	}
+
+	//! Lists of primitives can be joined into one draw call, strips and fans not
+	inline bool isPrimitiveList(E_PRIMITIVE_TYPE type)
+	{
+		return type == EPT_TRIANGLES || type == EPT_LINES || type == EPT_POINTS;
+	}
+}
+
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale), Box(core::vector3df(0.f, 0.f, 0.f)),
+	LastInstanceID(0), Mesh(0), PassCount(0), ReadOnlyMaterials(false), BoxesChanged(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+	{
+		// the scene manager culls the node with the box of all instances
+		if (BoxesChanged)
+			updateBoxes();
+
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+		PassCount = 0;
+		int transparentCount = 0;
+		int solidCount = 0;
+
+		if (Mesh && Transformations.size())
+		{
+			for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+			{
+				const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+				video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+				if ((rnd && rnd->isTransparent()) || material.isTransparent())
+					++transparentCount;
+				else
+					++solidCount;
+
+				if (solidCount && transparentCount)
+					break;
+			}
+		}
+
+		if (solidCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparentCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	// the instances are culled and copied once per frame, also for nodes with solid and transparent buffers
+	if (PassCount == 1)
+		cullInstances();
+
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	for (u32 i=0; i<Batches.size(); ++i)
+	{
+		scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		const bool transparent = (rnd && rnd->isTransparent()) || material.isTransparent();
+		if (transparent != isTransparentPass || Visible.empty())
+			continue;
+
+		driver->setMaterial(material);
+
+		const SBatch& batch = Batches[i];
+		if (batch.InstancesPerDraw)
+		{
+			const u32 vertexCount = mb->getVertexCount();
+			const u32 size = vertexCount * video::getVertexPitchFromType(mb->getVertexType());
+			const u32 primitiveCount = mb->getPrimitiveCount();
+
+			for (u32 first=0; first<Visible.size(); first+=batch.InstancesPerDraw)
+			{
+				const u32 count = core::min_(batch.InstancesPerDraw, Visible.size() - first);
+				driver->drawVertexPrimitiveList(batch.Vertices.const_pointer() + first * size, count * vertexCount,
+					batch.Indices.const_pointer(), count * primitiveCount,
+					mb->getVertexType(), mb->getPrimitiveType(), video::EIT_16BIT);
+			}
+		}
+		else
+		{
+			// strips and fans are drawn one instance after the other
+			for (u32 v=0; v<Visible.size(); ++v)
+			{
+				driver->setTransform(video::ETS_WORLD, AbsoluteTransformation * Transformations[Visible[v]]);
+				driver->drawMeshBuffer(mb);
+			}
+			driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+		}
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (u32 v=0; v<Visible.size(); ++v)
+			{
+				core::aabbox3df box(Mesh->getBoundingBox());
+				Transformations[Visible[v]].transformBoxEx(box);
+				driver->draw3DBox(box, video::SColor(255,190,128,128));
+			}
+		}
+	}
+}
+
+
+//! finds the instances inside the view frustum
+void CInstancedMeshSceneNode::cullInstances()
+{
+	const u32 count = Transformations.size();
+	if (BoxesChanged)
+		updateBoxes();
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	Visible.set_used(count);
+	u32 visible = 0;
+	if (camera && AutomaticCullingState != EAC_OFF)
+	{
+		// test the boxes in node space, like CSceneManager::isCulled
+		SViewFrustum frustum = *camera->getViewFrustum();
+		core::matrix4 invTrans(AbsoluteTransformation, core::matrix4::EM4CONST_INVERSE);
+		frustum.transform(invTrans);
+
+		Culled.set_used(count);
+		cullOrientedBoxes(frustum, BoxData.const_pointer(), count, Culled.pointer());
+		for (u32 i=0; i<count; ++i)
+		{
+			if (!Culled[i])
+				Visible[visible++] = i;
+		}
+	}
+	else
+	{
+		for (u32 i=0; i<count; ++i)
+			Visible[visible++] = i;
+	}
+	Visible.set_used(visible);
+
+	for (u32 i=0; i<Batches.size(); ++i)
+		fillBatch(i);
+}
+
+
+//! copies the vertices of the visible instances into the batch of a mesh buffer
+void CInstancedMeshSceneNode::fillBatch(u32 buffer)
+{
+	const IMeshBuffer* mb = Mesh->getMeshBuffer(buffer);
+	SBatch& batch = Batches[buffer];
+	if (batch.ChangedID != mb->getChangedID_Vertex())
+	{
+		// changed mesh buffer vertices, all instances are copied again
+		batch.ChangedID = mb->getChangedID_Vertex();
+		batch.CopiedIDs.clear();
+	}
+	if (!batch.InstancesPerDraw)
+		return;
+
+	const video::E_VERTEX_TYPE type = mb->getVertexType();
+	const u32 pitch = video::getVertexPitchFromType(type);
+	const u32 vertexCount = mb->getVertexCount();
+	const u32 size = vertexCount * pitch;
+
+	batch.Vertices.set_used(Visible.size() * size);
+	const u32 copied = core::min_(batch.CopiedIDs.size(), Visible.size());
+	batch.CopiedIDs.set_used(Visible.size());
+	for (u32 v=copied; v<Visible.size(); ++v)
+		batch.CopiedIDs[v] = 0;
+
+	for (u32 v=0; v<Visible.size(); ++v)
+	{
+		// only places which got another instance or a changed one are copied
+		const u32 instance = Visible[v];
+		if (batch.CopiedIDs[v] == InstanceIDs[instance])
+			continue;
+		batch.CopiedIDs[v] = InstanceIDs[instance];
+
+		const core::matrix4& m = Transformations[instance];
+		// normals need the inverse transpose, so they stay perpendicular with non uniform scale
+		core::matrix4 inverse;
+		const bool hasInverse = m.getInverse(inverse);
+		const bool normalize = !m.getScale().equals(core::vector3df(1.f, 1.f, 1.f));
+		const video::SColor color = Colors[instance];
+		const bool modulate = color.color != 0xFFFFFFFF;
+
+		// all vertex types start with the members of S3DVertex
+		u8* dst = batch.Vertices.pointer() + v * size;
+		memcpy(dst, mb->getVertices(), size);
+		for (u32 i=0; i<vertexCount; ++i, dst+=pitch)
+		{
+			video::S3DVertex& vertex = *(video::S3DVertex*)dst;
+			m.transformVect(vertex.Pos);
+			if (hasInverse)
+				inverse.inverseRotateVect(vertex.Normal);
+			else
+				m.rotateVect(vertex.Normal);
+			vertex.Normal.normalize();
+			if (modulate)
+				vertex.Color = modulateColor(vertex.Color, color);
+
+			if (type == video::EVT_TANGENTS)
+			{
+				video::S3DVertexTangents& tangents = *(video::S3DVertexTangents*)dst;
+				m.rotateVect(tangents.Tangent);
+				m.rotateVect(tangents.Binormal);
+				if (normalize)
+				{
+					tangents.Tangent.normalize();
+					tangents.Binormal.normalize();
+				}
+			}
+		}
+	}
+}
+
+
+//! builds the indices of the batches for the mesh buffers
+void CInstancedMeshSceneNode::prepareBatches()
+{
+	Batches.clear();
+	if (!Mesh)
+		return;
+
+	for (u32 b=0; b<Mesh->getMeshBufferCount(); ++b)
+	{
+		Batches.push_back(SBatch());
+		SBatch& batch = Batches.getLast();
+
+		const IMeshBuffer* mb = Mesh->getMeshBuffer(b);
+		const u32 vertexCount = mb->getVertexCount();
+		if (!isPrimitiveList(mb->getPrimitiveType()) || vertexCount == 0 || vertexCount > 65536)
+			continue;
+
+		// as many copies as 16 bit indices can address
+		batch.InstancesPerDraw = 65536 / vertexCount;
+		const u32 indexCount = mb->getIndexCount();
+		batch.Indices.set_used(batch.InstancesPerDraw * indexCount);
+		u16* dst = batch.Indices.pointer();
+		for (u32 k=0; k<batch.InstancesPerDraw; ++k)
+		{
+			const u32 offset = k * vertexCount;
+			if (mb->getIndexType() == video::EIT_16BIT)
+			{
+				const u16* indices = mb->getIndices();
+				for (u32 i=0; i<indexCount; ++i)
+					*dst++ = (u16)(indices[i] + offset);
+			}
+			else
+			{
+				const u32* indices = (const u32*)mb->getIndices();
+				for (u32 i=0; i<indexCount; ++i)
+					*dst++ = (u16)(indices[i] + offset);
+			}
+		}
+	}
+}
+
+
+//! calculates the boxes of the instances and the node again
+void CInstancedMeshSceneNode::updateBoxes()
+{
+	const u32 count = Transformations.size();
+	const core::aabbox3df meshBox = Mesh ? Mesh->getBoundingBox() : core::aabbox3df(core::vector3df(0.f, 0.f, 0.f));
+
+	BoxData.set_used(count * 12);
+	Box.reset(0.f, 0.f, 0.f);
+	for (u32 i=0; i<count; ++i)
+	{
+		setOrientedBox(BoxData.pointer(), count, i, Transformations[i], meshBox);
+
+		core::aabbox3df box(meshBox);
+		Transformations[i].transformBoxEx(box);
+		if (i == 0)
+			Box = box;
+		else
+			Box.addInternalBox(box);
+	}
+	BoxesChanged = false;
+}
+
+
+//! Adds an instance of the mesh
+u32 CInstancedMeshSceneNode::addInstance(const core::matrix4& transformation, video::SColor color)
+{
+	Transformations.push_back(transformation);
+	Colors.push_back(color);
+	InstanceIDs.push_back(newInstanceID());
+
+	// the box grows at once, the boxes for culling are calculated before the next frame
+	core::aabbox3df box(Mesh ? Mesh->getBoundingBox() : core::aabbox3df(core::vector3df(0.f, 0.f, 0.f)));
+	transformation.transformBoxEx(box);
+	if (Transformations.size() == 1)
+		Box = box;
+	else
+		Box.addInternalBox(box);
+
+	BoxesChanged = true;
+	return Transformations.size() - 1;
+}
+
+
+//! Changes the transformation and color of an instance
+void CInstancedMeshSceneNode::setInstance(u32 index, const core::matrix4& transformation, video::SColor color)
+{
+	if (index >= Transformations.size())
+		return;
+
+	Transformations[index] = transformation;
+	Colors[index] = color;
+	InstanceIDs[index] = newInstanceID();
+
+	core::aabbox3df box(Mesh ? Mesh->getBoundingBox() : core::aabbox3df(core::vector3df(0.f, 0.f, 0.f)));
+	transformation.transformBoxEx(box);
+	Box.addInternalBox(box);
+
+	BoxesChanged = true;
+}
+
+
+//! Removes an instance, the last one takes its index
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Transformations.size())
+		return;
+
+	const u32 last = Transformations.size() - 1;
+	Transformations[index] = Transformations[last];
+	Colors[index] = Colors[last];
+	// the moved instance keeps its id, its vertices are the same
+	InstanceIDs[index] = InstanceIDs[last];
+	Transformations.set_used(last);
+	Colors.set_used(last);
+	InstanceIDs.set_used(last);
+
+	BoxesChanged = true;
+}
+
+
+//! Removes all instances
+void CInstancedMeshSceneNode::clearInstances()
+{
+	Transformations.clear();
+	Colors.clear();
+	InstanceIDs.clear();
+	Visible.clear();
+	for (u32 i=0; i<Batches.size(); ++i)
+	{
+		Batches[i].Vertices.clear();
+		Batches[i].CopiedIDs.clear();
+	}
+	updateBoxes();
+}
+
+
+//! returns a new id for changed instance data
+u32 CInstancedMeshSceneNode::newInstanceID()
+{
+	// 0 marks places of the batches without an instance
+	if (++LastInstanceID == 0)
+		++LastInstanceID;
+	return LastInstanceID;
+}
+
+
+//! returns the axis aligned bounding box of all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		copyMaterials();
+		prepareBatches();
+		updateBoxes();
+	}
+}
+
+
+void CInstancedMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Writes attributes of the scene node.
+void CInstancedMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	IInstancedMeshSceneNode::serializeAttributes(out, options);
+
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(Mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(Mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+
+	out->addInt("InstanceCount", Transformations.size());
+	for (u32 i=0; i<Transformations.size(); ++i)
+	{
+		out->addMatrix((core::stringc("Transformation") + core::stringc(i)).c_str(), Transformations[i]);
+		out->addColor((core::stringc("Color") + core::stringc(i)).c_str(), Colors[i]);
+	}
+}
+
+
+//! Reads attributes of the scene node.
+void CInstancedMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(Mesh);
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IMesh* newMesh = 0;
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+
+		if (newAnimatedMesh)
+			newMesh = newAnimatedMesh->getMesh(0);
+
+		if (newMesh)
+			setMesh(newMesh);
+	}
+
+	if (in->existsAttribute("InstanceCount"))
+	{
+		clearInstances();
+		const s32 count = in->getAttributeAsInt("InstanceCount");
+		for (s32 i=0; i<count; ++i)
+		{
+			addInstance(in->getAttributeAsMatrix((core::stringc("Transformation") + core::stringc(i)).c_str()),
+				in->getAttributeAsColor((core::stringc("Color") + core::stringc(i)).c_str(), video::SColor(255,255,255,255)));
+		}
+	}
+
+	IInstancedMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CInstancedMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CInstancedMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CInstancedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CInstancedMeshSceneNode* nb = new CInstancedMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->Transformations = Transformations;
+	nb->Colors = Colors;
+	nb->InstanceIDs = InstanceIDs;
+	nb->LastInstanceID = LastInstanceID;
+	nb->updateBoxes();
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
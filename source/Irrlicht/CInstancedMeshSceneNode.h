@@ -0,0 +1,162 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of all instances
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0) _IRR_OVERRIDE_;
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh
+		virtual void setMesh(IMesh* mesh) _IRR_OVERRIDE_;
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) _IRR_OVERRIDE_ { return Mesh; }
+
+		//! Shadow volumes are not supported for instances, returns 0
+		virtual IShadowVolumeSceneNode* addShadowVolumeSceneNode(const IMesh* shadowMesh,
+			s32 id, bool zfailmethod=true, f32 infinity=10000.0f) _IRR_OVERRIDE_ { return 0; }
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly) _IRR_OVERRIDE_;
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+		//! Adds an instance of the mesh
+		virtual u32 addInstance(const core::matrix4& transformation, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Changes the transformation and color of an instance
+		virtual void setInstance(u32 index, const core::matrix4& transformation, video::SColor color) _IRR_OVERRIDE_;
+
+		//! Removes an instance, the last one takes its index
+		virtual void removeInstance(u32 index) _IRR_OVERRIDE_;
+
+		//! Removes all instances
+		virtual void clearInstances() _IRR_OVERRIDE_;
+
+		//! Get the number of instances
+		virtual u32 getInstanceCount() const _IRR_OVERRIDE_ { return Transformations.size(); }
+
+		//! Get the transformation of an instance relative to the node
+		virtual const core::matrix4& getInstanceTransformation(u32 index) const _IRR_OVERRIDE_ { return Transformations[index]; }
+
+		//! Get the color of an instance
+		virtual video::SColor getInstanceColor(u32 index) const _IRR_OVERRIDE_ { return Colors[index]; }
+
+		//! Get the number of instances which were not culled when the node was drawn the last time
+		virtual u32 getVisibleInstanceCount() const _IRR_OVERRIDE_ { return Visible.size(); }
+
+	private:
+
+		//! vertices of the visible instances for one mesh buffer
+		struct SBatch
+		{
+			SBatch() : InstancesPerDraw(0), ChangedID(0) {}
+
+			//! copies of the mesh buffer vertices, one instance after the other
+			core::array<u8> Vertices;
+			//! indices for InstancesPerDraw copies of the mesh buffer
+			core::array<u16> Indices;
+			//! instances drawn with one call, 0 if the mesh buffer can't be batched
+			u32 InstancesPerDraw;
+			//! changed id of the mesh buffer vertices when they were copied
+			u32 ChangedID;
+			//! InstanceIDs of the instances copied into each place of the batch, 0 for none
+			core::array<u32> CopiedIDs;
+		};
+
+		void copyMaterials();
+
+		//! builds the indices of the batches for the mesh buffers
+		void prepareBatches();
+
+		//! calculates the boxes of the instances and the node again
+		void updateBoxes();
+
+		//! finds the instances inside the view frustum
+		void cullInstances();
+
+		//! copies the vertices of the visible instances into the batch of a mesh buffer
+		void fillBatch(u32 buffer);
+
+		//! returns a new id for changed instance data
+		u32 newInstanceID();
+
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+		core::aabbox3d<f32> Box;
+
+		core::array<core::matrix4> Transformations;
+		core::array<video::SColor> Colors;
+		//! ids of the transformations and colors, a new one for each change
+		core::array<u32> InstanceIDs;
+		u32 LastInstanceID;
+
+		//! oriented boxes of the instances in node space, as used by cullOrientedBoxes
+		core::array<f32> BoxData;
+		core::array<u8> Culled;
+
+		//! indices of the instances which are drawn
+		core::array<u32> Visible;
+		core::array<SBatch> Batches;
+
+		IMesh* Mesh;
+
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+		//! the boxes of the instances have to be calculated again
+		bool BoxesChanged;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -33,6 +33,14 @@
 #include <X11/Xcursor/Xcursor.h>
 #endif
 
+#ifdef _IRR_LINUX_X11_SHM_
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
+#include "EProfileIDs.h"
+#include "IProfiler.h"
+
 #if defined _IRR_COMPILE_WITH_JOYSTICK_EVENTS_
 #include <fcntl.h>
 #include <unistd.h>
@@ -83,7 +91,7 @@ const char wmDeleteWindow[] = "WM_DELETE_WINDOW";
 CIrrDeviceLinux::CIrrDeviceLinux(const SIrrlichtCreationParameters& param)
 	: CIrrDeviceStub(param),
 #ifdef _IRR_COMPILE_WITH_X11_
-	XDisplay(0), VisualInfo(0), Screennr(0), XWindow(0), StdHints(0), SoftwareImage(0),
+	XDisplay(0), VisualInfo(0), Screennr(0), XWindow(0), StdHints(0), SoftwareImageIndex(0),
 	XInputMethod(0), XInputContext(0),
 	HasNetWM(false),
 #ifdef _IRR_COMPILE_WITH_OPENGL_
@@ -100,6 +108,26 @@ CIrrDeviceLinux::CIrrDeviceLinux(const SIrrlichtCreationParameters& param)
 	setDebugName("CIrrDeviceLinux");
 	#endif
 
+#ifdef _IRR_COMPILE_WITH_X11_
+	SoftwareImages[0] = SoftwareImages[1] = 0;
+	#ifdef _IRR_LINUX_X11_SHM_
+	ShmAttached[0] = ShmAttached[1] = false;
+	ShmBusy[0] = ShmBusy[1] = false;
+	ShmInfo[0].shmaddr = ShmInfo[1].shmaddr = 0;
+	ShmCompletionType = 0;
+	UseShm = false;
+	#endif
+#endif
+
+	IRR_PROFILE(
+		static bool initProfile = false;
+		if (!initProfile )
+		{
+			initProfile = true;
+			getProfiler().add(EPID_DEVICE_PRESENT, L"present", L"Irrlicht device");
+		}
+	)
+
 	// print version, distribution etc.
 	// thx to LynxLuna for pointing me to the uname function
 	core::stringc linuxversion;
@@ -201,8 +229,7 @@ CIrrDeviceLinux::~CIrrDeviceLinux()
 		// Reset fullscreen resolution change
 		switchToFullscreen(true);
 
-		if (SoftwareImage)
-			XDestroyImage(SoftwareImage);
+		destroySoftwareImages();
 
 		if (!ExternalWindow)
 		{
@@ -552,14 +579,12 @@ bool CIrrDeviceLinux::createWindow()
 
 	if (CreationParams.DriverType == video::EDT_SOFTWARE || CreationParams.DriverType == video::EDT_BURNINGSVIDEO)
 	{
-		SoftwareImage = XCreateImage(XDisplay,
-			VisualInfo->visual, VisualInfo->depth,
-			ZPixmap, 0, 0, Width, Height,
-			BitmapPad(XDisplay), 0);
-
-		// use malloc because X will free it later on
-		if (SoftwareImage)
-			SoftwareImage->data = (char*) malloc(SoftwareImage->bytes_per_line * SoftwareImage->height * sizeof(char));
+#ifdef _IRR_LINUX_X11_SHM_
+		UseShm = (XShmQueryExtension(XDisplay) == True);
+		if (UseShm)
+			ShmCompletionType = XShmGetEventBase(XDisplay) + ShmCompletion;
+#endif
+		createSoftwareImages();
 	}
 
 	initXAtoms();
@@ -780,19 +805,8 @@ bool CIrrDeviceLinux::run()
 					Height = event.xconfigure.height;
 
 					// resize image data
-					if (SoftwareImage)
-					{
-						XDestroyImage(SoftwareImage);
-
-						SoftwareImage = XCreateImage(XDisplay,
-							VisualInfo->visual, VisualInfo->depth,
-							ZPixmap, 0, 0, Width, Height,
-							BitmapPad(XDisplay), 0);
-
-						// use malloc because X will free it later on
-						if (SoftwareImage)
-							SoftwareImage->data = (char*) malloc(SoftwareImage->bytes_per_line * SoftwareImage->height * sizeof(char));
-					}
+					if (SoftwareImages[0])
+						createSoftwareImages();
 
 					if (VideoDriver)
 						VideoDriver->OnResize(core::dimension2d<u32>(Width, Height));
@@ -1060,6 +1074,10 @@ bool CIrrDeviceLinux::run()
 				break;
 
 			default:
+#ifdef _IRR_LINUX_X11_SHM_
+				if (UseShm && event.type == ShmCompletionType)
+					shmImageCompleted(reinterpret_cast<XShmCompletionEvent*>(&event)->shmseg);
+#endif
 				break;
 			} // end switch
 
@@ -1125,21 +1143,34 @@ bool CIrrDeviceLinux::present(video::IImage* image, void* windowId, core::rect<s
 {
 #ifdef _IRR_COMPILE_WITH_X11_
 	// this is only necessary for software drivers.
-	if (!SoftwareImage)
+	XImage* softwareImage = SoftwareImages[SoftwareImageIndex];
+	if (!softwareImage)
 		return true;
 
+	IRR_PROFILE(CProfileScope p1(EPID_DEVICE_PRESENT);)
+
+#ifdef _IRR_LINUX_X11_SHM_
+	// the X server might still read the shared memory image sent two frames ago
+	if (UseShm)
+		waitForShmImage(SoftwareImageIndex);
+#endif
+
 	// thx to Nadav, who send me some clues of how to display the image
 	// to the X Server.
+	// The drivers keep their own back buffer, its content has to survive
+	// present() and the images here are swapped every frame. So the frame
+	// is copied into the shared memory, which is a plain row copy when the
+	// color formats match.
 
-	const u32 destwidth = SoftwareImage->width;
+	const u32 destwidth = softwareImage->width;
 	const u32 minWidth = core::min_(image->getDimension().Width, destwidth);
-	const u32 destPitch = SoftwareImage->bytes_per_line;
+	const u32 destPitch = softwareImage->bytes_per_line;
 
 	video::ECOLOR_FORMAT destColor;
-	switch (SoftwareImage->bits_per_pixel)
+	switch (softwareImage->bits_per_pixel)
 	{
 		case 16:
-			if (SoftwareImage->depth==16)
+			if (softwareImage->depth==16)
 				destColor = video::ECF_R5G6B5;
 			else
 				destColor = video::ECF_A1R5G5B5;
@@ -1152,9 +1183,9 @@ bool CIrrDeviceLinux::present(video::IImage* image, void* windowId, core::rect<s
 	}
 
 	u8* srcdata = reinterpret_cast<u8*>(image->getData());
-	u8* destData = reinterpret_cast<u8*>(SoftwareImage->data);
+	u8* destData = reinterpret_cast<u8*>(softwareImage->data);
 
-	const u32 destheight = SoftwareImage->height;
+	const u32 destheight = softwareImage->height;
 	const u32 srcheight = core::min_(image->getDimension().Height, destheight);
 	const u32 srcPitch = image->getPitch();
 	for (u32 y=0; y!=srcheight; ++y)
@@ -1168,12 +1199,189 @@ bool CIrrDeviceLinux::present(video::IImage* image, void* windowId, core::rect<s
 	Window myWindow=XWindow;
 	if (windowId)
 		myWindow = reinterpret_cast<Window>(windowId);
-	XPutImage(XDisplay, myWindow, gc, SoftwareImage, 0, 0, 0, 0, destwidth, destheight);
+
+#ifdef _IRR_LINUX_X11_SHM_
+	if (UseShm)
+	{
+		// the server sends a ShmCompletion event once it read the image
+		XShmPutImage(XDisplay, myWindow, gc, softwareImage, 0, 0, 0, 0, destwidth, destheight, True);
+		XFlush(XDisplay);
+		ShmBusy[SoftwareImageIndex] = true;
+		SoftwareImageIndex ^= 1;
+		return true;
+	}
+#endif
+
+	XPutImage(XDisplay, myWindow, gc, softwareImage, 0, 0, 0, 0, destwidth, destheight);
 #endif
 	return true;
 }
 
 
+#ifdef _IRR_COMPILE_WITH_X11_
+
+#ifdef _IRR_LINUX_X11_SHM_
+namespace
+{
+	bool ShmAttachFailed = false;
+
+	//! XShmAttach fails on remote displays, this catches the error
+	int IrrShmAttachError(Display *display, XErrorEvent *event)
+	{
+		ShmAttachFailed = true;
+		return 0;
+	}
+
+	//! matches the ShmCompletion events, arg points to their event type
+	Bool IrrIsShmCompletion(Display *display, XEvent *event, XPointer arg)
+	{
+		return event->type == *reinterpret_cast<int*>(arg) ? True : False;
+	}
+}
+
+
+//! creates a shared memory image
+bool CIrrDeviceLinux::createShmImage(u32 index)
+{
+	XShmSegmentInfo& info = ShmInfo[index];
+	ShmBusy[index] = false;
+	info.shmid = -1;
+	info.shmaddr = 0;
+	info.readOnly = False;
+
+	XImage* image = XShmCreateImage(XDisplay, VisualInfo->visual, VisualInfo->depth,
+		ZPixmap, 0, &info, Width, Height);
+	if (!image)
+		return false;
+	SoftwareImages[index] = image;
+
+	info.shmid = shmget(IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+	if (info.shmid == -1)
+		return false;
+
+	void* data = shmat(info.shmid, 0, 0);
+	if (data == (void*)-1)
+	{
+		shmctl(info.shmid, IPC_RMID, 0);
+		return false;
+	}
+	info.shmaddr = image->data = (char*)data;
+
+	ShmAttachFailed = false;
+	XErrorHandler oldHandler = XSetErrorHandler(IrrShmAttachError);
+	ShmAttached[index] = (XShmAttach(XDisplay, &info) == True);
+	XSync(XDisplay, False);
+	XSetErrorHandler(oldHandler);
+
+	// the segment is released once both sides detached
+	shmctl(info.shmid, IPC_RMID, 0);
+
+	if (ShmAttachFailed)
+		ShmAttached[index] = false;
+	return ShmAttached[index];
+}
+
+
+//! waits until the X server finished reading a shared memory image
+void CIrrDeviceLinux::waitForShmImage(u32 index)
+{
+	XEvent event;
+	while (ShmBusy[index])
+	{
+		// leaves all other events in the queue for run()
+		XIfEvent(XDisplay, &event, IrrIsShmCompletion, reinterpret_cast<XPointer>(&ShmCompletionType));
+		shmImageCompleted(reinterpret_cast<XShmCompletionEvent*>(&event)->shmseg);
+	}
+}
+
+
+//! marks the image of a finished XShmPutImage as free
+void CIrrDeviceLinux::shmImageCompleted(ShmSeg segment)
+{
+	for (u32 i=0; i<2; ++i)
+	{
+		if (ShmAttached[i] && ShmInfo[i].shmseg == segment)
+			ShmBusy[i] = false;
+	}
+}
+#endif
+
+
+//! creates the images the software drivers present into, in the size of the window
+void CIrrDeviceLinux::createSoftwareImages()
+{
+	destroySoftwareImages();
+
+#ifdef _IRR_LINUX_X11_SHM_
+	if (UseShm)
+	{
+		if (createShmImage(0) && createShmImage(1))
+		{
+			os::Printer::log("Presenting software frames with MIT-SHM.", ELL_INFORMATION);
+			return;
+		}
+
+		// try XPutImage from now on
+		os::Printer::log("Could not use MIT-SHM, presenting software frames with XPutImage.", ELL_INFORMATION);
+		destroySoftwareImages();
+		UseShm = false;
+	}
+#endif
+
+	SoftwareImages[0] = XCreateImage(XDisplay,
+		VisualInfo->visual, VisualInfo->depth,
+		ZPixmap, 0, 0, Width, Height,
+		BitmapPad(XDisplay), 0);
+
+	// use malloc because X will free it later on
+	if (SoftwareImages[0])
+		SoftwareImages[0]->data = (char*) malloc(SoftwareImages[0]->bytes_per_line * SoftwareImages[0]->height * sizeof(char));
+}
+
+
+void CIrrDeviceLinux::destroySoftwareImages()
+{
+#ifdef _IRR_LINUX_X11_SHM_
+	bool synced = false;
+#endif
+	for (u32 i=0; i<2; ++i)
+	{
+		if (!SoftwareImages[i])
+			continue;
+
+#ifdef _IRR_LINUX_X11_SHM_
+		if (ShmAttached[i])
+		{
+			// wait until the server finished reading, completions of old images are not needed anymore
+			if (!synced)
+			{
+				XSync(XDisplay, False);
+				XEvent event;
+				while (XCheckIfEvent(XDisplay, &event, IrrIsShmCompletion, reinterpret_cast<XPointer>(&ShmCompletionType)))
+					;
+				synced = true;
+			}
+			XShmDetach(XDisplay, &ShmInfo[i]);
+			ShmAttached[i] = false;
+			ShmBusy[i] = false;
+		}
+		if (ShmInfo[i].shmaddr)
+		{
+			shmdt(ShmInfo[i].shmaddr);
+			ShmInfo[i].shmaddr = 0;
+			// shared memory must not be freed by XDestroyImage
+			SoftwareImages[i]->data = 0;
+		}
+#endif
+		XDestroyImage(SoftwareImages[i]);
+		SoftwareImages[i] = 0;
+	}
+	SoftwareImageIndex = 0;
+}
+
+#endif // _IRR_COMPILE_WITH_X11_
+
+
 //! notifies the device that it should close itself
 void CIrrDeviceLinux::closeDevice()
 {
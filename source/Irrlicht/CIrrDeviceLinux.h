@@ -35,6 +35,9 @@
 #ifdef _IRR_LINUX_X11_RANDR_
 #include <X11/extensions/Xrandr.h>
 #endif
+#ifdef _IRR_LINUX_X11_SHM_
+#include <X11/extensions/XShm.h>
+#endif
 #include <X11/keysym.h>
 
 #else
@@ -161,6 +164,15 @@ namespace irr
 		bool createInputContext();
 		void destroyInputContext();
 		EKEY_CODE getKeyCode(XEvent &event);
+
+		//! creates the images the software drivers present into, in the size of the window
+		void createSoftwareImages();
+		void destroySoftwareImages();
+#ifdef _IRR_LINUX_X11_SHM_
+		bool createShmImage(u32 index);
+		void waitForShmImage(u32 index);
+		void shmImageCompleted(ShmSeg segment);
+#endif
 #endif
 
 		//! Implementation of the linux cursor control
@@ -390,7 +402,22 @@ namespace irr
 		Window XWindow;
 		XSetWindowAttributes WndAttributes;
 		XSizeHints* StdHints;
-		XImage* SoftwareImage;
+		//! images for presenting frames of the software drivers
+		/** With MIT-SHM two shared memory images are written alternately,
+		so the X server can still read one while the next frame is copied.
+		An image is only waited for when its XShmPutImage from two frames
+		ago has not completed yet. Otherwise only the first one is used and
+		sent with XPutImage. */
+		XImage* SoftwareImages[2];
+		u32 SoftwareImageIndex;
+		#ifdef _IRR_LINUX_X11_SHM_
+		XShmSegmentInfo ShmInfo[2];
+		bool ShmAttached[2];
+		//! true while the X server has not sent the ShmCompletion event of an image
+		bool ShmBusy[2];
+		int ShmCompletionType;
+		bool UseShm;
+		#endif
 		XIM XInputMethod;
 		XIC XInputContext;
 		bool HasNetWM;
@@ -0,0 +1,245 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CIrrDeviceOffscreen.h"
+
+#ifdef _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+
+#include "CImage.h"
+#include "CColorConverter.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
+
+#ifdef _IRR_WINDOWS_API_
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#endif
+#include <stdio.h>
+
+namespace irr
+{
+
+//! constructor
+CIrrDeviceOffscreen::CIrrDeviceOffscreen(const SIrrlichtCreationParameters& params)
+	: CIrrDeviceStub(params), FrameCount(0), Writer(this),
+	StreamFailed(false), StreamFailureReported(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CIrrDeviceOffscreen");
+	#endif
+
+	Frames[0] = 0;
+	Frames[1] = 0;
+	FrameNumbers[0] = 0;
+	FrameNumbers[1] = 0;
+
+	IRR_PROFILE(
+		static bool initProfile = false;
+		if (!initProfile )
+		{
+			initProfile = true;
+			getProfiler().add(EPID_DEVICE_PRESENT, L"present", L"Irrlicht device");
+		}
+	)
+
+	switch (params.DriverType)
+	{
+	case video::EDT_SOFTWARE:
+		#ifdef _IRR_COMPILE_WITH_SOFTWARE_
+		VideoDriver = video::createSoftwareDriver(CreationParams.WindowSize, CreationParams.Fullscreen, FileSystem, this);
+		#else
+		os::Printer::log("Software driver was not compiled in.", ELL_ERROR);
+		#endif
+		break;
+
+	case video::EDT_BURNINGSVIDEO:
+		#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
+		VideoDriver = video::createBurningVideoDriver(CreationParams, FileSystem, this);
+		#else
+		os::Printer::log("Burning's Video driver was not compiled in.", ELL_ERROR);
+		#endif
+		break;
+
+	case video::EDT_NULL:
+		VideoDriver = video::createNullDriver(FileSystem, CreationParams.WindowSize);
+		break;
+
+	default:
+		os::Printer::log("The offscreen device can only use the software drivers.", ELL_ERROR);
+		break;
+	}
+
+	if (!CreationParams.FrameReceiver && CreationParams.FrameStreamFile < 0)
+		os::Printer::log("Offscreen device has neither frame receiver nor frame stream, frames are only kept by the driver.", ELL_WARNING);
+
+	if (VideoDriver)
+		createGUIAndScene();
+}
+
+
+//! destructor
+CIrrDeviceOffscreen::~CIrrDeviceOffscreen()
+{
+	WriterThread.wait();
+
+	for (u32 i=0; i<2; ++i)
+	{
+		if (Frames[i])
+			Frames[i]->drop();
+	}
+}
+
+
+//! runs the device. Returns false if device wants to be deleted
+bool CIrrDeviceOffscreen::run()
+{
+	os::Timer::tick();
+
+	if (StreamFailed && !StreamFailureReported)
+	{
+		StreamFailureReported = true;
+		os::Printer::log("Could not write frame to stream, streaming stopped.", ELL_ERROR);
+	}
+
+	return !Close;
+}
+
+
+//! Cause the device to temporarily pause execution and let other processes to run
+void CIrrDeviceOffscreen::yield()
+{
+#ifdef _IRR_WINDOWS_API_
+	Sleep(1);
+#else
+	struct timespec ts = {0,0};
+	nanosleep(&ts, NULL);
+#endif
+}
+
+
+//! Pause execution and let other processes to run for a specified amount of time.
+void CIrrDeviceOffscreen::sleep(u32 timeMs, bool pauseTimer)
+{
+	const bool wasStopped = Timer ? Timer->isStopped() : true;
+
+	if (pauseTimer && !wasStopped)
+		Timer->stop();
+
+#ifdef _IRR_WINDOWS_API_
+	Sleep(timeMs);
+#else
+	struct timespec ts;
+	ts.tv_sec = (time_t) (timeMs / 1000);
+	ts.tv_nsec = (long) (timeMs % 1000) * 1000000;
+	nanosleep(&ts, NULL);
+#endif
+
+	if (pauseTimer && !wasStopped)
+		Timer->start();
+}
+
+
+//! presents a surface in the client area
+bool CIrrDeviceOffscreen::present(video::IImage* surface, void* windowId, core::rect<s32>* src)
+{
+	if (!surface)
+		return false;
+
+	if (!CreationParams.FrameReceiver && (CreationParams.FrameStreamFile < 0 || StreamFailed))
+		return true;
+
+	IRR_PROFILE(CProfileScope p1(EPID_DEVICE_PRESENT);)
+
+	// the writer thread might still work on the other image
+	const u32 index = FrameCount & 1;
+	const core::dimension2du& size = surface->getDimension();
+	if (!Frames[index] || Frames[index]->getDimension() != size)
+	{
+		if (Frames[index])
+			Frames[index]->drop();
+		Frames[index] = new video::CImage(video::ECF_R8G8B8, size);
+	}
+
+	const u8* srcData = (const u8*)surface->getData();
+	u8* dstData = (u8*)Frames[index]->getData();
+	for (u32 y=0; y<size.Height; ++y)
+	{
+		video::CColorConverter::convert_viaFormat(srcData, surface->getColorFormat(), size.Width, dstData, video::ECF_R8G8B8);
+		srcData += surface->getPitch();
+		dstData += Frames[index]->getPitch();
+	}
+	FrameNumbers[index] = FrameCount++;
+
+	// waits for the previous frame, so frames are written in order and its result can be read
+	WriterThread.wait();
+	StreamFailed = Writer.StreamFailed;
+	WriterThread.start(Writer, index);
+	return true;
+}
+
+
+//! notifies the device that it should close itself
+void CIrrDeviceOffscreen::closeDevice()
+{
+	Close = true;
+}
+
+
+void CIrrDeviceOffscreen::CFrameWriter::run(u32 index)
+{
+	const video::IImage* frame = Device->Frames[index];
+	const SIrrlichtCreationParameters& params = Device->CreationParams;
+
+	if (params.FrameStreamFile >= 0 && !StreamFailed)
+	{
+		bool written = true;
+		if (params.FrameStreamFormat == EFSF_PPM)
+		{
+			c8 header[64];
+			const s32 length = snprintf_irr(header, 64, "P6\n%u %u\n255\n",
+				frame->getDimension().Width, frame->getDimension().Height);
+			written = Device->writeToStream(header, (u32)length);
+		}
+		if (written)
+			written = Device->writeToStream(frame->getData(), frame->getImageDataSizeInBytes());
+		if (!written)
+			StreamFailed = true;
+	}
+
+	if (params.FrameReceiver)
+		params.FrameReceiver->OnFrame(frame, Device->FrameNumbers[index]);
+}
+
+
+//! Writes all bytes to the frame stream, returns false on errors
+bool CIrrDeviceOffscreen::writeToStream(const void* data, u32 size)
+{
+	const c8* p = (const c8*)data;
+	while (size)
+	{
+#ifdef _IRR_WINDOWS_API_
+		const int written = _write(CreationParams.FrameStreamFile, p, size);
+#else
+		const ssize_t written = write(CreationParams.FrameStreamFile, p, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+#endif
+		if (written <= 0)
+			return false;
+		p += written;
+		size -= (u32)written;
+	}
+	return true;
+}
+
+
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+
@@ -0,0 +1,121 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IRR_DEVICE_OFFSCREEN_H_INCLUDED__
+#define __C_IRR_DEVICE_OFFSCREEN_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+
+#include "SIrrCreationParameters.h"
+#include "CIrrDeviceStub.h"
+#include "IImagePresenter.h"
+#include "IFrameReceiver.h"
+#include "os.h"
+
+namespace irr
+{
+
+	//! Device without window, presented frames go to a frame receiver or a file descriptor
+	/** Converting and writing a frame is done by a background thread while
+	the next frame is rendered, so two frame images are used in turn. */
+	class CIrrDeviceOffscreen : public CIrrDeviceStub, video::IImagePresenter
+	{
+	public:
+
+		//! constructor
+		CIrrDeviceOffscreen(const SIrrlichtCreationParameters& params);
+
+		//! destructor
+		virtual ~CIrrDeviceOffscreen();
+
+		//! runs the device. Returns false if device wants to be deleted
+		virtual bool run() _IRR_OVERRIDE_;
+
+		//! Cause the device to temporarily pause execution and let other processes to run
+		virtual void yield() _IRR_OVERRIDE_;
+
+		//! Pause execution and let other processes to run for a specified amount of time.
+		virtual void sleep(u32 timeMs, bool pauseTimer) _IRR_OVERRIDE_;
+
+		//! sets the caption of the window
+		virtual void setWindowCaption(const wchar_t* text) _IRR_OVERRIDE_ {}
+
+		//! returns if window is active. if not, nothing need to be drawn
+		virtual bool isWindowActive() const _IRR_OVERRIDE_ { return true; }
+
+		//! returns if window has focus
+		virtual bool isWindowFocused() const _IRR_OVERRIDE_ { return true; }
+
+		//! returns if window is minimized
+		virtual bool isWindowMinimized() const _IRR_OVERRIDE_ { return false; }
+
+		//! returns current window position (not supported for this device)
+		virtual core::position2di getWindowPosition() _IRR_OVERRIDE_
+		{
+			return core::position2di(-1, -1);
+		}
+
+		//! presents a surface in the client area
+		virtual bool present(video::IImage* surface, void* windowId=0, core::rect<s32>* src=0) _IRR_OVERRIDE_;
+
+		//! notifies the device that it should close itself
+		virtual void closeDevice() _IRR_OVERRIDE_;
+
+		//! Sets if the window should be resizable in windowed mode.
+		virtual void setResizable(bool resize=false) _IRR_OVERRIDE_ {}
+
+		//! Minimizes the window.
+		virtual void minimizeWindow() _IRR_OVERRIDE_ {}
+
+		//! Maximizes the window.
+		virtual void maximizeWindow() _IRR_OVERRIDE_ {}
+
+		//! Restores the window size.
+		virtual void restoreWindow() _IRR_OVERRIDE_ {}
+
+		//! Get the device type
+		virtual E_DEVICE_TYPE getType() const _IRR_OVERRIDE_
+		{
+			return EIDT_OFFSCREEN;
+		}
+
+	private:
+
+		//! Writes one frame image and passes it to the frame receiver
+		class CFrameWriter : public os::IParallelJob
+		{
+		public:
+			CFrameWriter(CIrrDeviceOffscreen* device) : StreamFailed(false), Device(device) {}
+
+			//! index is the frame image to write
+			virtual void run(u32 index) _IRR_OVERRIDE_;
+
+			//! only used by the writer thread, the device reads it after WriterThread.wait()
+			bool StreamFailed;
+
+		private:
+			CIrrDeviceOffscreen* Device;
+		};
+
+		//! Writes all bytes to the frame stream, returns false on errors
+		bool writeToStream(const void* data, u32 size);
+
+		video::IImage* Frames[2];
+		u32 FrameNumbers[2];
+		u32 FrameCount;
+
+		CFrameWriter Writer;
+		os::BackgroundJob WriterThread;
+
+		//! copy of Writer.StreamFailed for the device thread, taken when the writer is idle
+		bool StreamFailed;
+		bool StreamFailureReported;
+	};
+
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+#endif // __C_IRR_DEVICE_OFFSCREEN_H_INCLUDED__
+
@@ -39,6 +39,8 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 	Logger->setLogLevel(CreationParams.LoggingLevel);
 
 	os::Printer::Logger = Logger;
+	// process wide like the logger, the last created device sets it for all devices
+	os::Parallel::setThreadCount(CreationParams.WorkerThreads);
 	Randomizer = createDefaultRandomizer();
 
 	FileSystem = io::createFileSystem();
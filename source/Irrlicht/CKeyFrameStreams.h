@@ -0,0 +1,166 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_KEY_FRAME_STREAMS_H_INCLUDED__
+#define __C_KEY_FRAME_STREAMS_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "irrArray.h"
+#include "S3DVertex.h"
+#include "CMeshBuffer.h"
+#include <string.h>
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+	//! Decoded positions and normals of all key frames of a vertex animated mesh buffer
+	/** Used by the MD2 and MD3 meshes. Each frame holds six streams of
+	getStride() floats: X, Y and Z of the positions, then X, Y and Z of the
+	normals. The stride is the vertex count rounded up to a multiple of four,
+	the padding is zero. */
+	class CKeyFrameStreams
+	{
+	public:
+
+		CKeyFrameStreams() : FrameCount(0), VertexCount(0), Stride(0) {}
+
+		//! Allocates zeroed streams for a number of frames and vertices
+		void reset(u32 frameCount, u32 vertexCount)
+		{
+			FrameCount = frameCount;
+			VertexCount = vertexCount;
+			Stride = (vertexCount + 3) & ~3u;
+			Data.set_used(FrameCount * Stride * 6);
+			if (Data.size())
+				memset(Data.pointer(), 0, Data.size() * sizeof(f32));
+		}
+
+		//! Stores position and normal of a vertex in a frame
+		void setVertex(u32 frame, u32 vertex, const core::vector3df& pos, const core::vector3df& normal)
+		{
+			f32* s = getFrame(frame) + vertex;
+			s[0] = pos.X;
+			s[Stride] = pos.Y;
+			s[Stride * 2] = pos.Z;
+			s[Stride * 3] = normal.X;
+			s[Stride * 4] = normal.Y;
+			s[Stride * 5] = normal.Z;
+		}
+
+		//! Interpolates two frames into the positions and normals of vertices
+		/** \param frameA Frame returned for amount 0.
+		\param frameB Frame returned for amount 1.
+		\param amount Position between the frames, 0 to 1.
+		\param dest First vertex. Pos and Normal of S3DVertex and the
+		vertex types derived from it are written.
+		\param vertexSize Size of the vertex type in bytes. */
+		void interpolate(u32 frameA, u32 frameB, f32 amount,
+				video::S3DVertex* dest, u32 vertexSize) const
+		{
+			const f32* a = getFrame(frameA);
+			const f32* b = getFrame(frameB);
+			u8* out = (u8*)dest;
+			u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			const __m128 t = _mm_set1_ps(amount);
+			for (; i + 4 <= VertexCount; i += 4, out += 4 * vertexSize)
+			{
+				__m128 x = lerp(a + i, b + i, t);
+				__m128 y = lerp(a + Stride + i, b + Stride + i, t);
+				__m128 z = lerp(a + Stride * 2 + i, b + Stride * 2 + i, t);
+				__m128 nx = lerp(a + Stride * 3 + i, b + Stride * 3 + i, t);
+				const __m128 ny = lerp(a + Stride * 4 + i, b + Stride * 4 + i, t);
+				const __m128 nz = lerp(a + Stride * 5 + i, b + Stride * 5 + i, t);
+
+				// Pos and Normal.X of each vertex are one row after the transpose,
+				// Normal.Y and Normal.Z are written as pairs
+				_MM_TRANSPOSE4_PS(x, y, z, nx);
+				const __m128 low = _mm_unpacklo_ps(ny, nz);
+				const __m128 high = _mm_unpackhi_ps(ny, nz);
+
+				_mm_storeu_ps((f32*)out, x);
+				_mm_storel_pi((__m64*)(out + 16), low);
+				_mm_storeu_ps((f32*)(out + vertexSize), y);
+				_mm_storeh_pi((__m64*)(out + vertexSize + 16), low);
+				_mm_storeu_ps((f32*)(out + vertexSize * 2), z);
+				_mm_storel_pi((__m64*)(out + vertexSize * 2 + 16), high);
+				_mm_storeu_ps((f32*)(out + vertexSize * 3), nx);
+				_mm_storeh_pi((__m64*)(out + vertexSize * 3 + 16), high);
+			}
+#endif
+			for (; i < VertexCount; ++i, out += vertexSize)
+			{
+				video::S3DVertex* v = (video::S3DVertex*)out;
+				v->Pos.X = a[i] + amount * (b[i] - a[i]);
+				v->Pos.Y = a[Stride + i] + amount * (b[Stride + i] - a[Stride + i]);
+				v->Pos.Z = a[Stride * 2 + i] + amount * (b[Stride * 2 + i] - a[Stride * 2 + i]);
+				v->Normal.X = a[Stride * 3 + i] + amount * (b[Stride * 3 + i] - a[Stride * 3 + i]);
+				v->Normal.Y = a[Stride * 4 + i] + amount * (b[Stride * 4 + i] - a[Stride * 4 + i]);
+				v->Normal.Z = a[Stride * 5 + i] + amount * (b[Stride * 5 + i] - a[Stride * 5 + i]);
+			}
+		}
+
+		//! Copies what is not animated from one interpolated buffer into another
+		/** Colors, texture coordinates and indices are the same in all key
+		frames, but may have been changed by the user. Only what differs is
+		copied, and only then dest is set dirty. */
+		template <class T>
+		static void copyUnanimated(CMeshBuffer<T>* dest, const CMeshBuffer<T>* source)
+		{
+			const u32 count = core::min_(dest->Vertices.size(), source->Vertices.size());
+			bool changed = false;
+			for (u32 i=0; i<count; ++i)
+			{
+				T v = source->Vertices[i];
+				v.Pos = dest->Vertices[i].Pos;
+				v.Normal = dest->Vertices[i].Normal;
+				if (v != dest->Vertices[i])
+				{
+					dest->Vertices[i] = v;
+					changed = true;
+				}
+			}
+			if (changed)
+				dest->setDirty(EBT_VERTEX);
+
+			if (dest->Indices != source->Indices)
+			{
+				dest->Indices = source->Indices;
+				dest->setDirty(EBT_INDEX);
+			}
+		}
+
+		u32 getFrameCount() const { return FrameCount; }
+		u32 getVertexCount() const { return VertexCount; }
+		u32 getStride() const { return Stride; }
+
+	private:
+
+		f32* getFrame(u32 frame) { return Data.pointer() + frame * Stride * 6; }
+		const f32* getFrame(u32 frame) const { return Data.const_pointer() + frame * Stride * 6; }
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		static inline __m128 lerp(const f32* a, const f32* b, __m128 t)
+		{
+			const __m128 va = _mm_loadu_ps(a);
+			return _mm_add_ps(va, _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(b), va)));
+		}
+#endif
+
+		core::array<f32> Data;
+		u32 FrameCount;
+		u32 VertexCount;
+		u32 Stride;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
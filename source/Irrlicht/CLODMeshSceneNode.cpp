@@ -0,0 +1,781 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CLODMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IMaterialRenderer.h"
+#include "IMeshManipulator.h"
+#include "IMeshWriter.h"
+#include "IFileSystem.h"
+#include "IWriteFile.h"
+#include "IXMLWriter.h"
+#include "IAttributes.h"
+#include "SMesh.h"
+#include "CDynamicMeshBuffer.h"
+#include "CShadowVolumeSceneNode.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! FNV-1a hash of a block of memory, continuing from hash
+	inline u32 hashBytes(u32 hash, const void* data, u32 size)
+	{
+		const u8* p = (const u8*)data;
+		for (u32 i=0; i<size; ++i)
+		{
+			hash ^= p[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	//! Hash of the vertices and indices of all mesh buffers, the key of the cached levels
+	u32 hashMesh(const IMesh* mesh)
+	{
+		u32 hash = 2166136261u;
+		for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+		{
+			const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+			hash = hashBytes(hash, mb->getVertices(), mb->getVertexCount() * video::getVertexPitchFromType(mb->getVertexType()));
+			hash = hashBytes(hash, mb->getIndices(), mb->getIndexCount() *
+				(mb->getIndexType() == video::EIT_16BIT ? sizeof(u16) : sizeof(u32)));
+		}
+		return hash;
+	}
+
+	//! Number of vertices in all mesh buffers
+	u32 countVertices(const IMesh* mesh)
+	{
+		u32 count = 0;
+		for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+			count += mesh->getMeshBuffer(b)->getVertexCount();
+		return count;
+	}
+}
+
+//! constructor
+CLODMeshSceneNode::CLODMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: ILODMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0), Shadow(0),
+	FadeMesh(0), FadeMeshLevel(0), FadeAlpha(0), MaxScreenError(1.f), FadeTime(0),
+	FadeStart(0), Time(0), CurrentLOD(0), FadeLOD(0), PassCount(0),
+	ReadOnlyMaterials(false), Fading(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CLODMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CLODMeshSceneNode::~CLODMeshSceneNode()
+{
+	if (Shadow)
+		Shadow->drop();
+	clearLODs();
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! animates the node and remembers the time for fading
+void CLODMeshSceneNode::OnAnimate(u32 timeMs)
+{
+	Time = timeMs;
+	ILODMeshSceneNode::OnAnimate(timeMs);
+}
+
+
+//! chooses the level of detail and registers the node
+void CLODMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && Mesh)
+	{
+		const u32 level = selectLOD();
+		if (level != CurrentLOD)
+		{
+			// when the previous level is still fading, it is replaced by the current one
+			FadeLOD = CurrentLOD;
+			FadeStart = Time;
+			CurrentLOD = level;
+		}
+		Fading = FadeTime && FadeLOD != CurrentLOD && Time - FadeStart < FadeTime;
+		if (!Fading && FadeMesh)
+		{
+			FadeMesh->drop();
+			FadeMesh = 0;
+		}
+
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+		PassCount = 0;
+		int transparentCount = Fading ? 1 : 0;
+		int solidCount = 0;
+
+		// count transparent and solid materials in this scene node
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+			video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+			if ((rnd && rnd->isTransparent()) || material.isTransparent())
+				++transparentCount;
+			else
+				++solidCount;
+
+			if (solidCount && transparentCount)
+				break;
+		}
+
+		// register according to material types counted
+
+		if (solidCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparentCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! finds the simplest level whose error on screen is small enough
+u32 CLODMeshSceneNode::selectLOD() const
+{
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera || Levels.size() < 2)
+		return 0;
+
+	// pixels on screen for one unit at a distance of one
+	f32 pixelsPerUnit = core::abs_(camera->getProjectionMatrix()[5]) *
+		SceneManager->getVideoDriver()->getViewPort().getHeight() * 0.5f;
+
+	if (!camera->isOrthogonal())
+	{
+		// distance to the nearest point of the bounding sphere
+		core::aabbox3df box = Mesh->getBoundingBox();
+		AbsoluteTransformation.transformBoxEx(box);
+		const f32 distance = camera->getAbsolutePosition().getDistanceFrom(box.getCenter()) -
+			box.getExtent().getLength() * 0.5f;
+		if (distance <= camera->getNearValue())
+			return 0;
+		pixelsPerUnit /= distance;
+	}
+
+	const core::vector3df scale = AbsoluteTransformation.getScale();
+	pixelsPerUnit *= core::max_(core::abs_(scale.X), core::abs_(scale.Y), core::abs_(scale.Z));
+
+	u32 level = 0;
+	while (level+1 < Levels.size() && Levels[level+1].Error * pixelsPerUnit <= MaxScreenError)
+		++level;
+	return level;
+}
+
+
+//! renders the node.
+void CLODMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+	Box = Mesh->getBoundingBox();
+	IMesh* mesh = Levels[CurrentLOD].Mesh;
+
+	if (Shadow && PassCount==1)
+		Shadow->updateShadowVolumes();
+
+	// all levels use the materials of the mesh of the node
+	const u32 count = core::min_(mesh->getMeshBufferCount(), Mesh->getMeshBufferCount());
+	for (u32 i=0; i<count; ++i)
+	{
+		const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		const bool transparent = (rnd && rnd->isTransparent());
+
+		// only render transparent buffer if this is the transparent render pass
+		// and solid only in solid pass
+		if (transparent == isTransparentPass)
+		{
+			driver->setMaterial(material);
+			driver->drawMeshBuffer(mesh->getMeshBuffer(i));
+		}
+	}
+
+	if (Fading && isTransparentPass)
+		renderFadeMesh(driver);
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+		}
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (u32 g=0; g<mesh->getMeshBufferCount(); ++g)
+			{
+				driver->draw3DBox(
+					mesh->getMeshBuffer(g)->getBoundingBox(),
+					video::SColor(255,190,128,128));
+			}
+		}
+
+		if (DebugDataVisible & scene::EDS_NORMALS)
+		{
+			// draw normals
+			const f32 debugNormalLength = SceneManager->getParameters()->getAttributeAsFloat(DEBUG_NORMAL_LENGTH);
+			const video::SColor debugNormalColor = SceneManager->getParameters()->getAttributeAsColor(DEBUG_NORMAL_COLOR);
+
+			for (u32 g=0; g<mesh->getMeshBufferCount(); ++g)
+			{
+				driver->drawMeshBufferNormals(mesh->getMeshBuffer(g), debugNormalLength, debugNormalColor);
+			}
+		}
+
+		// show mesh
+		if (DebugDataVisible & scene::EDS_MESH_WIRE_OVERLAY)
+		{
+			m.Wireframe = true;
+			driver->setMaterial(m);
+
+			for (u32 g=0; g<mesh->getMeshBufferCount(); ++g)
+			{
+				driver->drawMeshBuffer(mesh->getMeshBuffer(g));
+			}
+		}
+	}
+}
+
+
+//! copies a level for fading it out with vertex alpha
+void CLODMeshSceneNode::copyFadeMesh(u32 level)
+{
+	if (FadeMesh)
+		FadeMesh->drop();
+	FadeMesh = new SMesh();
+	FadeMeshLevel = level;
+	FadeAlpha = 255;
+
+	const IMesh* mesh = Levels[level].Mesh;
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(mb->getVertexType(), mb->getIndexType());
+		buffer->setPrimitiveType(mb->getPrimitiveType());
+
+		const u8* vertices = (const u8*)mb->getVertices();
+		const u32 pitch = video::getVertexPitchFromType(mb->getVertexType());
+		IVertexBuffer& vertexBuffer = buffer->getVertexBuffer();
+		vertexBuffer.reallocate(mb->getVertexCount());
+		for (u32 i=0; i<mb->getVertexCount(); ++i)
+			vertexBuffer.push_back(*(const video::S3DVertex*)(vertices + i*pitch));
+
+		IIndexBuffer& indexBuffer = buffer->getIndexBuffer();
+		indexBuffer.reallocate(mb->getIndexCount());
+		if (mb->getIndexType() == video::EIT_32BIT)
+		{
+			const u32* indices = (const u32*)mb->getIndices();
+			for (u32 i=0; i<mb->getIndexCount(); ++i)
+				indexBuffer.push_back(indices[i]);
+		}
+		else
+		{
+			const u16* indices = mb->getIndices();
+			for (u32 i=0; i<mb->getIndexCount(); ++i)
+				indexBuffer.push_back(indices[i]);
+		}
+
+		buffer->setBoundingBox(mb->getBoundingBox());
+		FadeMesh->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+}
+
+
+//! draws the copy of the previous level with the alpha of the current time
+void CLODMeshSceneNode::renderFadeMesh(video::IVideoDriver* driver)
+{
+	if (!FadeMesh || FadeMeshLevel != FadeLOD)
+		copyFadeMesh(FadeLOD);
+
+	const u32 alpha = 255 - core::min_(255u, (Time - FadeStart) * 255 / FadeTime);
+	if (alpha != FadeAlpha)
+	{
+		FadeAlpha = alpha;
+		for (u32 b=0; b<FadeMesh->getMeshBufferCount(); ++b)
+		{
+			IMeshBuffer* mb = FadeMesh->getMeshBuffer(b);
+			u8* vertices = (u8*)mb->getVertices();
+			const u32 pitch = video::getVertexPitchFromType(mb->getVertexType());
+			for (u32 i=0; i<mb->getVertexCount(); ++i)
+				((video::S3DVertex*)(vertices + i*pitch))->Color.setAlpha(alpha);
+			mb->setDirty(EBT_VERTEX);
+		}
+	}
+
+	// only solid materials can be faded with the vertex alpha
+	const u32 count = core::min_(FadeMesh->getMeshBufferCount(), Mesh->getMeshBufferCount());
+	for (u32 i=0; i<count; ++i)
+	{
+		video::SMaterial material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		if ((rnd && rnd->isTransparent()) || material.isTransparent())
+			continue;
+
+		material.MaterialType = video::EMT_TRANSPARENT_VERTEX_ALPHA;
+		material.ZWriteEnable = false;
+		driver->setMaterial(material);
+		driver->drawMeshBuffer(FadeMesh->getMeshBuffer(i));
+	}
+}
+
+
+//! Removes a child from this scene node.
+//! Implemented here, to be able to remove the shadow properly, if there is one,
+//! or to remove attached childs.
+bool CLODMeshSceneNode::removeChild(ISceneNode* child)
+{
+	if (child && Shadow == child)
+	{
+		Shadow->drop();
+		Shadow = 0;
+	}
+
+	return ISceneNode::removeChild(child);
+}
+
+
+//! returns the axis aligned bounding box of this node
+const core::aabbox3d<f32>& CLODMeshSceneNode::getBoundingBox() const
+{
+	return Mesh ? Mesh->getBoundingBox() : Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CLODMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CLODMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh, and removes the levels of detail
+void CLODMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		clearLODs();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		Levels.set_used(1);
+		Levels[0].Mesh = Mesh;
+		Levels[0].Error = 0.f;
+		copyMaterials();
+	}
+}
+
+
+//! Creates shadow volume scene node as child of this node
+//! and returns a pointer to it.
+IShadowVolumeSceneNode* CLODMeshSceneNode::addShadowVolumeSceneNode(
+		const IMesh* shadowMesh, s32 id, bool zfailmethod, f32 infinity)
+{
+	if (!SceneManager->getVideoDriver()->queryFeature(video::EVDF_STENCIL_BUFFER))
+		return 0;
+
+	// the simplest level makes a cheaper shadow
+	if (!shadowMesh)
+		shadowMesh = Levels.size() ? Levels.getLast().Mesh : Mesh;
+
+	if (Shadow)
+		Shadow->drop();
+
+	Shadow = new CShadowVolumeSceneNode(shadowMesh, this, SceneManager, id,  zfailmethod, infinity);
+	return Shadow;
+}
+
+
+void CLODMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Adds a level of detail
+void CLODMeshSceneNode::addLOD(IMesh* mesh, f32 error)
+{
+	if (!mesh || !Mesh)
+		return;
+
+	if (mesh->getMeshBufferCount() != Mesh->getMeshBufferCount())
+	{
+		os::Printer::log("Level of detail needs the mesh buffers of the mesh", ELL_WARNING);
+		return;
+	}
+
+	mesh->grab();
+	SLevel level;
+	level.Mesh = mesh;
+	level.Error = error;
+	Levels.push_back(level);
+}
+
+
+//! Creates levels of detail by simplifying the mesh again and again
+u32 CLODMeshSceneNode::generateLODs(u32 count, f32 reduction, const io::path& cacheFile)
+{
+	if (!Mesh)
+		return 0;
+
+	if (cacheFile.size() && loadLODs(cacheFile))
+		return Levels.size();
+
+	clearLODs();
+	const IMeshManipulator* manipulator = SceneManager->getMeshManipulator();
+	s32 triangles = manipulator->getPolyCount(Mesh);
+	f32 error = 0.f;
+
+	for (u32 i=0; i<count; ++i)
+	{
+		f32 levelError = 0.f;
+		IMesh* lod = manipulator->createSimplifiedMesh(Levels.getLast().Mesh, reduction, &levelError);
+		if (!lod)
+			break;
+
+		// stop when the simplification gets stuck
+		const s32 lodTriangles = manipulator->getPolyCount(lod);
+		if (lodTriangles == 0 || lodTriangles >= triangles - triangles / 10)
+		{
+			lod->drop();
+			break;
+		}
+
+		// the errors of the chained simplifications add up
+		error += levelError;
+		addLOD(lod, error);
+		lod->drop();
+		triangles = lodTriangles;
+	}
+
+	if (cacheFile.size())
+		writeLODs(cacheFile);
+
+	return Levels.size();
+}
+
+
+//! Removes all levels of detail except the mesh of the node
+/** Level 0 is Mesh, which holds its own reference. */
+void CLODMeshSceneNode::clearLODs()
+{
+	for (u32 i=1; i<Levels.size(); ++i)
+		Levels[i].Mesh->drop();
+	if (Levels.size() > 1)
+		Levels.set_used(1);
+
+	CurrentLOD = 0;
+	FadeLOD = 0;
+	Fading = false;
+	if (FadeMesh)
+	{
+		FadeMesh->drop();
+		FadeMesh = 0;
+	}
+}
+
+
+//! Writes the levels of detail to files
+bool CLODMeshSceneNode::writeLODs(const io::path& filename)
+{
+	if (!Mesh)
+		return false;
+
+	IMeshWriter* writer = SceneManager->createMeshWriter(EMWT_IRR_MESH);
+	if (!writer)
+		return false;
+
+	io::IFileSystem* fileSystem = SceneManager->getFileSystem();
+	io::IAttributes* attributes = fileSystem->createEmptyAttributes();
+	// the key of the mesh the levels belong to
+	attributes->addInt("MeshBuffers", Mesh->getMeshBufferCount());
+	attributes->addInt("Vertices", countVertices(Mesh));
+	attributes->addInt("Triangles", SceneManager->getMeshManipulator()->getPolyCount(Mesh));
+	attributes->addBox3d("Box", Mesh->getBoundingBox());
+	attributes->addInt("Hash", (s32)hashMesh(Mesh));
+	attributes->addInt("LODCount", Levels.size()-1);
+
+	io::path base;
+	core::cutFilenameExtension(base, filename);
+	bool result = true;
+
+	for (u32 i=1; i<Levels.size(); ++i)
+	{
+		io::path meshFile = base + "_lod";
+		meshFile += i;
+		meshFile += ".irrmesh";
+
+		io::IWriteFile* file = fileSystem->createAndWriteFile(meshFile);
+		if (file)
+		{
+			result &= writer->writeMesh(file, Levels[i].Mesh);
+			file->drop();
+		}
+		else
+			result = false;
+
+		// the meshes are found next to the list
+		core::stringc name("Mesh");
+		name += i;
+		attributes->addString(name.c_str(), fileSystem->getFileBasename(meshFile).c_str());
+		name = "Error";
+		name += i;
+		attributes->addFloat(name.c_str(), Levels[i].Error);
+	}
+	writer->drop();
+
+	io::IXMLWriter* xml = fileSystem->createXMLWriter(filename);
+	if (xml)
+	{
+		attributes->write(xml, true);
+		xml->drop();
+	}
+	else
+		result = false;
+
+	attributes->drop();
+
+	if (!result)
+		os::Printer::log("Could not write levels of detail", filename, ELL_WARNING);
+	return result;
+}
+
+
+//! Replaces the levels of detail with those stored by writeLODs()
+bool CLODMeshSceneNode::loadLODs(const io::path& filename)
+{
+	io::IFileSystem* fileSystem = SceneManager->getFileSystem();
+	if (!Mesh || !fileSystem->existFile(filename))
+		return false;
+
+	io::IXMLReader* xml = fileSystem->createXMLReader(filename);
+	if (!xml)
+		return false;
+
+	io::IAttributes* attributes = fileSystem->createEmptyAttributes();
+	attributes->read(xml);
+	xml->drop();
+
+	// levels written for another mesh are outdated, the box only went through text
+	const core::aabbox3df box = attributes->getAttributeAsBox3d("Box");
+	bool result = attributes->existsAttribute("LODCount") && attributes->existsAttribute("Hash") &&
+		attributes->getAttributeAsInt("MeshBuffers") == (s32)Mesh->getMeshBufferCount() &&
+		attributes->getAttributeAsInt("Vertices") == (s32)countVertices(Mesh) &&
+		attributes->getAttributeAsInt("Triangles") == SceneManager->getMeshManipulator()->getPolyCount(Mesh) &&
+		box.MinEdge.equals(Mesh->getBoundingBox().MinEdge, 0.001f) &&
+		box.MaxEdge.equals(Mesh->getBoundingBox().MaxEdge, 0.001f) &&
+		(u32)attributes->getAttributeAsInt("Hash") == hashMesh(Mesh);
+
+	core::array<SLevel> levels;
+	const io::path dir = fileSystem->getFileDir(filename);
+	const s32 count = result ? attributes->getAttributeAsInt("LODCount") : 0;
+
+	for (s32 i=1; i<=count && result; ++i)
+	{
+		core::stringc name("Mesh");
+		name += i;
+		io::path meshFile = dir + "/";
+		meshFile += attributes->getAttributeAsString(name.c_str());
+
+		// don't keep the levels in the mesh cache, they belong to this node
+		IAnimatedMesh* animatedMesh = SceneManager->getMesh(meshFile);
+		IMesh* mesh = animatedMesh ? animatedMesh->getMesh(0) : 0;
+		if (mesh && mesh->getMeshBufferCount() == Mesh->getMeshBufferCount())
+		{
+			name = "Error";
+			name += i;
+			SLevel level;
+			level.Mesh = mesh;
+			level.Error = attributes->getAttributeAsFloat(name.c_str());
+			mesh->grab();
+			levels.push_back(level);
+		}
+		else
+			result = false;
+
+		if (animatedMesh)
+			SceneManager->getMeshCache()->removeMesh(animatedMesh);
+	}
+	attributes->drop();
+
+	if (result)
+	{
+		clearLODs();
+		for (u32 i=0; i<levels.size(); ++i)
+			Levels.push_back(levels[i]);
+	}
+	else
+	{
+		for (u32 i=0; i<levels.size(); ++i)
+			levels[i].Mesh->drop();
+	}
+	return result;
+}
+
+
+//! Writes attributes of the scene node.
+void CLODMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	ILODMeshSceneNode::serializeAttributes(out, options);
+
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(Mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(Mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+	out->addFloat("MaxScreenError", MaxScreenError);
+	out->addInt("FadeTime", FadeTime);
+}
+
+
+//! Reads attributes of the scene node.
+void CLODMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(Mesh);
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+	if (in->existsAttribute("MaxScreenError"))
+		MaxScreenError = in->getAttributeAsFloat("MaxScreenError");
+	if (in->existsAttribute("FadeTime"))
+		FadeTime = in->getAttributeAsInt("FadeTime");
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IMesh* newMesh = 0;
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+
+		if (newAnimatedMesh)
+			newMesh = newAnimatedMesh->getMesh(0);
+
+		if (newMesh)
+			setMesh(newMesh);
+	}
+
+	ILODMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CLODMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CLODMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CLODMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CLODMeshSceneNode* nb = new CLODMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->MaxScreenError = MaxScreenError;
+	nb->FadeTime = FadeTime;
+	for (u32 i=1; i<Levels.size(); ++i)
+		nb->addLOD(Levels[i].Mesh, Levels[i].Error);
+	nb->Shadow = Shadow;
+	if ( nb->Shadow )
+		nb->Shadow->grab();
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
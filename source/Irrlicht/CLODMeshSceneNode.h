@@ -0,0 +1,172 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_LOD_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_LOD_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ILODMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+}
+namespace scene
+{
+	class SMesh;
+
+	class CLODMeshSceneNode : public ILODMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CLODMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CLODMeshSceneNode();
+
+		//! animates the node and remembers the time for fading
+		virtual void OnAnimate(u32 timeMs) _IRR_OVERRIDE_;
+
+		//! chooses the level of detail and registers the node
+		virtual void OnRegisterSceneNode() _IRR_OVERRIDE_;
+
+		//! renders the node.
+		virtual void render() _IRR_OVERRIDE_;
+
+		//! returns the axis aligned bounding box of this node
+		virtual const core::aabbox3d<f32>& getBoundingBox() const _IRR_OVERRIDE_;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i) _IRR_OVERRIDE_;
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const _IRR_OVERRIDE_;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const _IRR_OVERRIDE_;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0) _IRR_OVERRIDE_;
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const _IRR_OVERRIDE_ { return ESNT_LOD_MESH; }
+
+		//! Sets a new mesh, and removes the levels of detail
+		virtual void setMesh(IMesh* mesh) _IRR_OVERRIDE_;
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) _IRR_OVERRIDE_ { return Mesh; }
+
+		//! Creates shadow volume scene node as child of this node.
+		virtual IShadowVolumeSceneNode* addShadowVolumeSceneNode(const IMesh* shadowMesh,
+			s32 id, bool zfailmethod=true, f32 infinity=10000.0f) _IRR_OVERRIDE_;
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly) _IRR_OVERRIDE_;
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const _IRR_OVERRIDE_;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) _IRR_OVERRIDE_;
+
+		//! Removes a child from this scene node.
+		virtual bool removeChild(ISceneNode* child) _IRR_OVERRIDE_;
+
+		//! Adds a level of detail
+		virtual void addLOD(IMesh* mesh, f32 error) _IRR_OVERRIDE_;
+
+		//! Creates levels of detail by simplifying the mesh again and again
+		virtual u32 generateLODs(u32 count, f32 reduction=0.5f, const io::path& cacheFile="") _IRR_OVERRIDE_;
+
+		//! Removes all levels of detail except the mesh of the node
+		virtual void clearLODs() _IRR_OVERRIDE_;
+
+		//! Writes the levels of detail to files
+		virtual bool writeLODs(const io::path& filename) _IRR_OVERRIDE_;
+
+		//! Replaces the levels of detail with those stored by writeLODs()
+		virtual bool loadLODs(const io::path& filename) _IRR_OVERRIDE_;
+
+		//! Get the number of levels, including the mesh of the node
+		virtual u32 getLODCount() const _IRR_OVERRIDE_ { return Levels.size(); }
+
+		//! Get the mesh of a level
+		virtual IMesh* getLODMesh(u32 level) const _IRR_OVERRIDE_ { return Levels[level].Mesh; }
+
+		//! Get the geometric error of a level
+		virtual f32 getLODError(u32 level) const _IRR_OVERRIDE_ { return Levels[level].Error; }
+
+		//! Get the level chosen when the node was registered the last time
+		virtual u32 getCurrentLOD() const _IRR_OVERRIDE_ { return CurrentLOD; }
+
+		//! Sets the largest error on screen in pixels which is accepted
+		virtual void setMaxScreenError(f32 pixels) _IRR_OVERRIDE_ { MaxScreenError = pixels; }
+
+		//! Get the largest error on screen in pixels which is accepted
+		virtual f32 getMaxScreenError() const _IRR_OVERRIDE_ { return MaxScreenError; }
+
+		//! Sets the time in which the previous level fades out after a switch
+		virtual void setFadeTime(u32 milliseconds) _IRR_OVERRIDE_ { FadeTime = milliseconds; }
+
+		//! Get the time in which the previous level fades out
+		virtual u32 getFadeTime() const _IRR_OVERRIDE_ { return FadeTime; }
+
+	private:
+
+		struct SLevel
+		{
+			IMesh* Mesh;
+			f32 Error;
+		};
+
+		void copyMaterials();
+
+		//! finds the simplest level whose error on screen is small enough
+		u32 selectLOD() const;
+
+		//! copies a level for fading it out with vertex alpha
+		void copyFadeMesh(u32 level);
+
+		//! draws the copy of the previous level with the alpha of the current time
+		void renderFadeMesh(video::IVideoDriver* driver);
+
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+		core::aabbox3d<f32> Box;
+
+		//! levels of detail, the first one is Mesh
+		core::array<SLevel> Levels;
+
+		IMesh* Mesh;
+		IShadowVolumeSceneNode* Shadow;
+
+		//! copy of the level which fades out
+		SMesh* FadeMesh;
+		u32 FadeMeshLevel;
+		u32 FadeAlpha;
+
+		f32 MaxScreenError;
+		u32 FadeTime;
+		u32 FadeStart;
+		u32 Time;
+		u32 CurrentLOD;
+		u32 FadeLOD;
+
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+		bool Fading;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -9,6 +9,7 @@
 #include "os.h"
 #include "irrMap.h"
 #include "triangle3d.h"
+#include "CDynamicMeshBuffer.h"
 
 namespace irr
 {
@@ -36,6 +37,118 @@ static inline core::vector3df getAngleWeight(const core::vector3df& v1,
 }
 
 
+namespace
+{
+//! Triangles or vertices in each part of a large mesh buffer, the parts are spread over several threads
+const u32 MESH_PART_SIZE = 4096;
+
+//! Large mesh buffers have their triangles and vertices split into parts for several threads
+inline bool isLargeBuffer(const IMeshBuffer* buffer)
+{
+	return os::Parallel::getThreadCount() > 1 &&
+		core::max_(buffer->getIndexCount() / 3, buffer->getVertexCount()) > MESH_PART_SIZE;
+}
+
+//! Base for operations on the parts of a large mesh buffer
+/** Every pass over the triangles or vertices only writes to its own
+elements, everything which adds up or overwrites values of other elements is
+done between the passes in the order of the triangles. So the results are the
+same as those of the operations on one thread. */
+class CMeshBufferParts : public os::IParallelJob
+{
+public:
+	CMeshBufferParts() : Count(0) {}
+
+	virtual void run(u32 index) _IRR_OVERRIDE_
+	{
+		const u32 begin = index * MESH_PART_SIZE;
+		runPart(begin, core::min_(begin + MESH_PART_SIZE, Count));
+	}
+
+protected:
+	//! calls runPart for the parts of count elements on all threads
+	void runParts(u32 count)
+	{
+		Count = count;
+		os::Parallel::run(*this, (count + MESH_PART_SIZE - 1) / MESH_PART_SIZE);
+	}
+
+	virtual void runPart(u32 begin, u32 end) = 0;
+
+private:
+	u32 Count;
+};
+
+//! Calls an operation for a list of small mesh buffers
+template <class T>
+class CMeshBuffersJob : public os::IParallelJob
+{
+public:
+	CMeshBuffersJob(const T& operation, const core::array<IMeshBuffer*>& buffers)
+		: Operation(operation), Buffers(buffers) {}
+
+	virtual void run(u32 index) _IRR_OVERRIDE_
+	{
+		Operation(Buffers[index], false);
+	}
+
+private:
+	const T& Operation;
+	const core::array<IMeshBuffer*>& Buffers;
+};
+
+//! Calls operation(buffer, split) for all mesh buffers of a mesh
+/** Large buffers are processed one after the other with their parts on all
+threads, small buffers are spread whole over the threads. Meshes which hold
+a buffer more than once, or too few vertices to be worth it, are processed
+on the calling thread. */
+template <class T>
+void processMeshBuffers(IMesh* mesh, const T& operation)
+{
+	const u32 count = mesh->getMeshBufferCount();
+	core::array<IMeshBuffer*> small(count);
+	u32 smallSize = 0;
+	for (u32 b=0; b<count; ++b)
+	{
+		IMeshBuffer* buffer = mesh->getMeshBuffer(b);
+		if (!buffer)
+			continue;
+		if (isLargeBuffer(buffer))
+			operation(buffer, true);
+		else
+		{
+			small.push_back(buffer);
+			smallSize += buffer->getVertexCount() + buffer->getIndexCount();
+		}
+	}
+
+	bool parallel = small.size() > 1 && smallSize > MESH_PART_SIZE * 2 &&
+		os::Parallel::getThreadCount() > 1;
+	if (parallel)
+	{
+		core::array<IMeshBuffer*> sorted(small);
+		sorted.sort();
+		for (u32 i=1; i<sorted.size(); ++i)
+		{
+			if (sorted[i] == sorted[i-1])
+				parallel = false;
+		}
+	}
+
+	if (parallel)
+	{
+		CMeshBuffersJob<T> job(operation, small);
+		os::Parallel::run(job, small.size());
+	}
+	else
+	{
+		for (u32 i=0; i<small.size(); ++i)
+			operation(small[i], false);
+	}
+}
+}
+
+
 //! Flips the direction of surfaces. Changes backfacing triangles to frontfacing
 //! triangles and vice versa.
 //! \param mesh: Mesh on which the operation is performed.
@@ -75,9 +188,93 @@ void CMeshManipulator::flipSurfaces(scene::IMesh* mesh) const
 
 namespace
 {
+//! Recalculates the normals of a large mesh buffer on several threads
+template <typename T>
+class CNormalsParts : public CMeshBufferParts
+{
+public:
+	CNormalsParts(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
+		: Buffer(buffer), Indices(reinterpret_cast<const T*>(buffer->getIndices())),
+		Smooth(smooth), AngleWeighted(angleWeighted), Pass(0) {}
+
+	void process()
+	{
+		const u32 vtxcnt = Buffer->getVertexCount();
+		const u32 tricnt = Buffer->getIndexCount() / 3;
+
+		FaceNormals.set_used(tricnt);
+		Weights.set_used(Smooth && AngleWeighted ? tricnt : 0);
+		Pass = 0;
+		runParts(tricnt);
+
+		if (!Smooth)
+		{
+			for (u32 t=0; t<tricnt; ++t)
+			{
+				Buffer->getNormal(Indices[t*3+0]) = FaceNormals[t];
+				Buffer->getNormal(Indices[t*3+1]) = FaceNormals[t];
+				Buffer->getNormal(Indices[t*3+2]) = FaceNormals[t];
+			}
+			return;
+		}
+
+		for (u32 i=0; i!=vtxcnt; ++i)
+			Buffer->getNormal(i).set(0.f, 0.f, 0.f);
+
+		for (u32 t=0; t<tricnt; ++t)
+		{
+			const core::vector3df& normal = FaceNormals[t];
+			const core::vector3df weight = AngleWeighted ? Weights[t] : core::vector3df(1.f,1.f,1.f);
+			Buffer->getNormal(Indices[t*3+0]) += weight.X*normal;
+			Buffer->getNormal(Indices[t*3+1]) += weight.Y*normal;
+			Buffer->getNormal(Indices[t*3+2]) += weight.Z*normal;
+		}
+
+		Pass = 1;
+		runParts(vtxcnt);
+	}
+
+protected:
+	virtual void runPart(u32 begin, u32 end) _IRR_OVERRIDE_
+	{
+		if (Pass == 1)
+		{
+			for (u32 i=begin; i!=end; ++i)
+				Buffer->getNormal(i).normalize();
+			return;
+		}
+
+		for (u32 t=begin; t!=end; ++t)
+		{
+			const core::vector3df& v1 = Buffer->getPosition(Indices[t*3+0]);
+			const core::vector3df& v2 = Buffer->getPosition(Indices[t*3+1]);
+			const core::vector3df& v3 = Buffer->getPosition(Indices[t*3+2]);
+			FaceNormals[t] = core::plane3d<f32>(v1, v2, v3).Normal;
+			if (Weights.size())
+				Weights[t] = irr::scene::getAngleWeight(v1,v2,v3);
+		}
+	}
+
+private:
+	IMeshBuffer* Buffer;
+	const T* Indices;
+	core::array<core::vector3df> FaceNormals;
+	core::array<core::vector3df> Weights;
+	bool Smooth;
+	bool AngleWeighted;
+	u32 Pass;
+};
+
 template <typename T>
-void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
+void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted, bool split)
 {
+	if (split && isLargeBuffer(buffer))
+	{
+		CNormalsParts<T> parts(buffer, smooth, angleWeighted);
+		parts.process();
+		return;
+	}
+
 	const u32 vtxcnt = buffer->getVertexCount();
 	const u32 idxcnt = buffer->getIndexCount();
 	const T* idx = reinterpret_cast<T*>(buffer->getIndices());
@@ -122,6 +319,27 @@ void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
 			buffer->getNormal(i).normalize();
 	}
 }
+
+void recalculateBufferNormals(IMeshBuffer* buffer, bool smooth, bool angleWeighted, bool split)
+{
+	if (buffer->getIndexType()==video::EIT_16BIT)
+		recalculateNormalsT<u16>(buffer, smooth, angleWeighted, split);
+	else
+		recalculateNormalsT<u32>(buffer, smooth, angleWeighted, split);
+}
+
+struct SRecalculateNormals
+{
+	SRecalculateNormals(bool smooth, bool angleWeighted) : Smooth(smooth), AngleWeighted(angleWeighted) {}
+
+	void operator()(IMeshBuffer* buffer, bool split) const
+	{
+		recalculateBufferNormals(buffer, Smooth, AngleWeighted, split);
+	}
+
+	bool Smooth;
+	bool AngleWeighted;
+};
 }
 
 
@@ -132,10 +350,7 @@ void CMeshManipulator::recalculateNormals(IMeshBuffer* buffer, bool smooth, bool
 	if (!buffer)
 		return;
 
-	if (buffer->getIndexType()==video::EIT_16BIT)
-		recalculateNormalsT<u16>(buffer, smooth, angleWeighted);
-	else
-		recalculateNormalsT<u32>(buffer, smooth, angleWeighted);
+	recalculateBufferNormals(buffer, smooth, angleWeighted, true);
 }
 
 
@@ -146,9 +361,7 @@ void CMeshManipulator::recalculateNormals(scene::IMesh* mesh, bool smooth, bool
 	if (!mesh)
 		return;
 
-	const u32 bcount = mesh->getMeshBufferCount();
-	for ( u32 b=0; b<bcount; ++b)
-		recalculateNormals(mesh->getMeshBuffer(b), smooth, angleWeighted);
+	processMeshBuffers(mesh, SRecalculateNormals(smooth, angleWeighted));
 }
 
 
@@ -250,13 +463,156 @@ void calculateTangents(
 }
 
 
+//! Recalculates the tangents of a large tangent mesh buffer on several threads
+template <typename T>
+class CTangentsParts : public CMeshBufferParts
+{
+public:
+	CTangentsParts(IMeshBuffer* buffer, bool recalculateNormals, bool smooth, bool angleWeighted)
+		: Vertices((video::S3DVertexTangents*)buffer->getVertices()),
+		Indices(reinterpret_cast<const T*>(buffer->getIndices())),
+		VertexCount(buffer->getVertexCount()), TriangleCount(buffer->getIndexCount() / 3),
+		RecalculateNormals(recalculateNormals), Smooth(smooth), AngleWeighted(angleWeighted), Pass(0) {}
+
+	void process()
+	{
+		video::S3DVertexTangents* v = Vertices;
+		u32 i;
+
+		Corners.set_used(TriangleCount * 3);
+		Degenerate.set_used(Smooth ? TriangleCount : 0);
+		Pass = 0;
+		runParts(TriangleCount);
+
+		if (!Smooth)
+		{
+			for (i=0; i<TriangleCount*3; ++i)
+			{
+				video::S3DVertexTangents& vertex = v[Indices[i]];
+				vertex.Tangent = Corners[i].Tangent;
+				vertex.Binormal = Corners[i].Binormal;
+				if (RecalculateNormals)
+					vertex.Normal = Corners[i].Normal;
+			}
+			return;
+		}
+
+		for ( i = 0; i!= VertexCount; ++i )
+		{
+			if (RecalculateNormals)
+				v[i].Normal.set( 0.f, 0.f, 0.f );
+			v[i].Tangent.set( 0.f, 0.f, 0.f );
+			v[i].Binormal.set( 0.f, 0.f, 0.f );
+		}
+
+		//Each vertex gets the sum of the tangents and binormals from the faces around it
+		for (i=0; i<TriangleCount*3; ++i)
+		{
+			if (Degenerate[i/3])
+				continue;
+			video::S3DVertexTangents& vertex = v[Indices[i]];
+			if (RecalculateNormals)
+				vertex.Normal += Corners[i].Normal;
+			vertex.Tangent += Corners[i].Tangent;
+			vertex.Binormal += Corners[i].Binormal;
+		}
+
+		Pass = 1;
+		runParts(VertexCount);
+	}
+
+protected:
+	virtual void runPart(u32 begin, u32 end) _IRR_OVERRIDE_
+	{
+		video::S3DVertexTangents* v = Vertices;
+		if (Pass == 1)
+		{
+			for (u32 i=begin; i!=end; ++i)
+			{
+				if (RecalculateNormals)
+					v[i].Normal.normalize();
+				v[i].Tangent.normalize();
+				v[i].Binormal.normalize();
+			}
+			return;
+		}
+
+		for (u32 t=begin; t!=end; ++t)
+		{
+			const T* idx = Indices + t*3;
+			SCorner* c = &Corners[t*3];
+			if (!Smooth)
+			{
+				for (u32 o=0; o!=3; ++o)
+				{
+					calculateTangents(c[o].Normal, c[o].Tangent, c[o].Binormal,
+						v[idx[o]].Pos, v[idx[(o+1)%3]].Pos, v[idx[(o+2)%3]].Pos,
+						v[idx[o]].TCoords, v[idx[(o+1)%3]].TCoords, v[idx[(o+2)%3]].TCoords);
+				}
+				continue;
+			}
+
+			// if this triangle is degenerate, skip it!
+			Degenerate[t] = v[idx[0]].Pos == v[idx[1]].Pos ||
+				v[idx[0]].Pos == v[idx[2]].Pos ||
+				v[idx[1]].Pos == v[idx[2]].Pos;
+			if (Degenerate[t])
+				continue;
+
+			core::vector3df weight(1.f,1.f,1.f);
+			if (AngleWeighted)
+				weight = irr::scene::getAngleWeight(v[idx[0]].Pos,v[idx[1]].Pos,v[idx[2]].Pos);
+			for (u32 o=0; o!=3; ++o)
+			{
+				core::vector3df localNormal;
+				core::vector3df localTangent;
+				core::vector3df localBinormal;
+				calculateTangents(localNormal, localTangent, localBinormal,
+					v[idx[o]].Pos, v[idx[(o+1)%3]].Pos, v[idx[(o+2)%3]].Pos,
+					v[idx[o]].TCoords, v[idx[(o+1)%3]].TCoords, v[idx[(o+2)%3]].TCoords);
+				const f32 w = o == 0 ? weight.X : o == 1 ? weight.Y : weight.Z;
+				c[o].Normal = localNormal * w;
+				c[o].Tangent = localTangent * w;
+				c[o].Binormal = localBinormal * w;
+			}
+		}
+	}
+
+private:
+	//! results of a triangle for one of its vertices
+	struct SCorner
+	{
+		core::vector3df Normal;
+		core::vector3df Tangent;
+		core::vector3df Binormal;
+	};
+
+	video::S3DVertexTangents* Vertices;
+	const T* Indices;
+	core::array<SCorner> Corners;
+	core::array<u8> Degenerate;
+	u32 VertexCount;
+	u32 TriangleCount;
+	bool RecalculateNormals;
+	bool Smooth;
+	bool AngleWeighted;
+	u32 Pass;
+};
+
 //! Recalculates tangents for a tangent mesh buffer
 template <typename T>
-void recalculateTangentsT(IMeshBuffer* buffer, bool recalculateNormals, bool smooth, bool angleWeighted)
+void recalculateTangentsT(IMeshBuffer* buffer, bool recalculateNormals, bool smooth, bool angleWeighted, bool split)
 {
 	if (!buffer || (buffer->getVertexType()!= video::EVT_TANGENTS))
 		return;
 
+	if (split && isLargeBuffer(buffer))
+	{
+		CTangentsParts<T> parts(buffer, recalculateNormals, smooth, angleWeighted);
+		parts.process();
+		return;
+	}
+
 	const u32 vtxCnt = buffer->getVertexCount();
 	const u32 idxCnt = buffer->getIndexCount();
 
@@ -293,7 +649,7 @@ void recalculateTangentsT(IMeshBuffer* buffer, bool recalculateNormals, bool smo
 			//Angle-weighted normals look better, but are slightly more CPU intensive to calculate
 			core::vector3df weight(1.f,1.f,1.f);
 			if (angleWeighted)
-				weight = irr::scene::getAngleWeight(v[i+0].Pos,v[i+1].Pos,v[i+2].Pos);	// writing irr::scene:: necessary for borland
+				weight = irr::scene::getAngleWeight(v[idx[i+0]].Pos,v[idx[i+1]].Pos,v[idx[i+2]].Pos);	// writing irr::scene:: necessary for borland
 			core::vector3df localNormal;
 			core::vector3df localTangent;
 			core::vector3df localBinormal;
@@ -405,6 +761,30 @@ void recalculateTangentsT(IMeshBuffer* buffer, bool recalculateNormals, bool smo
 		}
 	}
 }
+
+void recalculateBufferTangents(IMeshBuffer* buffer, bool recalculateNormals, bool smooth, bool angleWeighted, bool split)
+{
+	if (buffer->getIndexType() == video::EIT_16BIT)
+		recalculateTangentsT<u16>(buffer, recalculateNormals, smooth, angleWeighted, split);
+	else
+		recalculateTangentsT<u32>(buffer, recalculateNormals, smooth, angleWeighted, split);
+}
+
+struct SRecalculateTangents
+{
+	SRecalculateTangents(bool recalculateNormals, bool smooth, bool angleWeighted)
+		: RecalculateNormals(recalculateNormals), Smooth(smooth), AngleWeighted(angleWeighted) {}
+
+	void operator()(IMeshBuffer* buffer, bool split) const
+	{
+		if (buffer->getVertexType() == video::EVT_TANGENTS)
+			recalculateBufferTangents(buffer, RecalculateNormals, Smooth, AngleWeighted, split);
+	}
+
+	bool RecalculateNormals;
+	bool Smooth;
+	bool AngleWeighted;
+};
 }
 
 
@@ -412,12 +792,7 @@ void recalculateTangentsT(IMeshBuffer* buffer, bool recalculateNormals, bool smo
 void CMeshManipulator::recalculateTangents(IMeshBuffer* buffer, bool recalculateNormals, bool smooth, bool angleWeighted) const
 {
 	if (buffer && (buffer->getVertexType() == video::EVT_TANGENTS))
-	{
-		if (buffer->getIndexType() == video::EIT_16BIT)
-			recalculateTangentsT<u16>(buffer, recalculateNormals, smooth, angleWeighted);
-		else
-			recalculateTangentsT<u32>(buffer, recalculateNormals, smooth, angleWeighted);
-	}
+		recalculateBufferTangents(buffer, recalculateNormals, smooth, angleWeighted, true);
 }
 
 
@@ -427,20 +802,110 @@ void CMeshManipulator::recalculateTangents(IMesh* mesh, bool recalculateNormals,
 	if (!mesh)
 		return;
 
-	const u32 meshBufferCount = mesh->getMeshBufferCount();
-	for (u32 b=0; b<meshBufferCount; ++b)
-	{
-		recalculateTangents(mesh->getMeshBuffer(b), recalculateNormals, smooth, angleWeighted);
-	}
+	processMeshBuffers(mesh, SRecalculateTangents(recalculateNormals, smooth, angleWeighted));
 }
 
 
 namespace
 {
+//! Creates the planar texture mappings of a large mesh buffer on several threads
+/** Each vertex gets the mapping of the last triangle using it. */
+template<typename T>
+class CPlanarMappingParts : public CMeshBufferParts
+{
+public:
+	CPlanarMappingParts(scene::IMeshBuffer* buffer, f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset)
+		: Buffer(buffer), Indices(reinterpret_cast<const T*>(buffer->getIndices())),
+		ResolutionS(resolutionS), ResolutionT(resolutionT), Axis(axis), Offset(offset), Pass(0) {}
+
+	void process()
+	{
+		const u32 idxcnt = Buffer->getIndexCount() - Buffer->getIndexCount() % 3;
+
+		// with an axis per triangle, 0 maps y and z, 1 maps x and z, 2 maps x and y
+		if (Axis > 2)
+		{
+			TriangleAxis.set_used(idxcnt / 3);
+			Pass = 0;
+			runParts(idxcnt / 3);
+		}
+
+		VertexAxis.set_used(Buffer->getVertexCount());
+		memset(VertexAxis.pointer(), 0xFF, VertexAxis.size());
+		for (u32 i=0; i<idxcnt; ++i)
+			VertexAxis[Indices[i]] = Axis > 2 ? TriangleAxis[i/3] : Axis;
+
+		Pass = 1;
+		runParts(Buffer->getVertexCount());
+	}
+
+protected:
+	virtual void runPart(u32 begin, u32 end) _IRR_OVERRIDE_
+	{
+		if (Pass == 0)
+		{
+			for (u32 t=begin; t!=end; ++t)
+			{
+				core::plane3df p(Buffer->getPosition(Indices[t*3+0]), Buffer->getPosition(Indices[t*3+1]), Buffer->getPosition(Indices[t*3+2]));
+				p.Normal.X = fabsf(p.Normal.X);
+				p.Normal.Y = fabsf(p.Normal.Y);
+				p.Normal.Z = fabsf(p.Normal.Z);
+				if (p.Normal.X > p.Normal.Y && p.Normal.X > p.Normal.Z)
+					TriangleAxis[t] = 0;
+				else if (p.Normal.Y > p.Normal.X && p.Normal.Y > p.Normal.Z)
+					TriangleAxis[t] = 1;
+				else
+					TriangleAxis[t] = 2;
+			}
+			return;
+		}
+
+		for (u32 i=begin; i!=end; ++i)
+		{
+			const core::vector3df& pos = Buffer->getPosition(i);
+			core::vector2df& tc = Buffer->getTCoords(i);
+			if (Axis > 2)
+			{
+				// one resolution, without offset
+				if (VertexAxis[i] == 0)
+					tc.set(pos.Y * ResolutionS, pos.Z * ResolutionS);
+				else if (VertexAxis[i] == 1)
+					tc.set(pos.X * ResolutionS, pos.Z * ResolutionS);
+				else if (VertexAxis[i] == 2)
+					tc.set(pos.X * ResolutionS, pos.Y * ResolutionS);
+			}
+			else if (VertexAxis[i] == 0)
+				tc.set(0.5f+(pos.Z + Offset.Z) * ResolutionS, 0.5f-(pos.Y + Offset.Y) * ResolutionT);
+			else if (VertexAxis[i] == 1)
+				tc.set(0.5f+(pos.X + Offset.X) * ResolutionS, 1.f-(pos.Z + Offset.Z) * ResolutionT);
+			else if (VertexAxis[i] == 2)
+				tc.set(0.5f+(pos.X + Offset.X) * ResolutionS, 0.5f-(pos.Y + Offset.Y) * ResolutionT);
+		}
+	}
+
+private:
+	scene::IMeshBuffer* Buffer;
+	const T* Indices;
+	core::array<u8> TriangleAxis;
+	core::array<u8> VertexAxis;
+	f32 ResolutionS;
+	f32 ResolutionT;
+	u8 Axis;
+	core::vector3df Offset;
+	u32 Pass;
+};
+
 //! Creates a planar texture mapping on the meshbuffer
 template<typename T>
-void makePlanarTextureMappingT(scene::IMeshBuffer* buffer, f32 resolution)
+void makePlanarTextureMappingT(scene::IMeshBuffer* buffer, f32 resolution, bool split)
 {
+	if (split && isLargeBuffer(buffer))
+	{
+		CPlanarMappingParts<T> parts(buffer, resolution, resolution, 0xFF, core::vector3df());
+		parts.process();
+		return;
+	}
+
 	u32 idxcnt = buffer->getIndexCount();
 	T* idx = reinterpret_cast<T*>(buffer->getIndices());
 
@@ -479,6 +944,21 @@ void makePlanarTextureMappingT(scene::IMeshBuffer* buffer, f32 resolution)
 		}
 	}
 }
+
+struct SPlanarMapping
+{
+	SPlanarMapping(f32 resolution) : Resolution(resolution) {}
+
+	void operator()(IMeshBuffer* buffer, bool split) const
+	{
+		if (buffer->getIndexType()==video::EIT_16BIT)
+			makePlanarTextureMappingT<u16>(buffer, Resolution, split);
+		else
+			makePlanarTextureMappingT<u32>(buffer, Resolution, split);
+	}
+
+	f32 Resolution;
+};
 }
 
 
@@ -488,10 +968,8 @@ void CMeshManipulator::makePlanarTextureMapping(scene::IMeshBuffer* buffer, f32
 	if (!buffer)
 		return;
 
-	if (buffer->getIndexType()==video::EIT_16BIT)
-		makePlanarTextureMappingT<u16>(buffer, resolution);
-	else
-		makePlanarTextureMappingT<u32>(buffer, resolution);
+	const SPlanarMapping mapping(resolution);
+	mapping(buffer, true);
 }
 
 
@@ -501,11 +979,7 @@ void CMeshManipulator::makePlanarTextureMapping(scene::IMesh* mesh, f32 resoluti
 	if (!mesh)
 		return;
 
-	const u32 bcount = mesh->getMeshBufferCount();
-	for ( u32 b=0; b<bcount; ++b)
-	{
-		makePlanarTextureMapping(mesh->getMeshBuffer(b), resolution);
-	}
+	processMeshBuffers(mesh, SPlanarMapping(resolution));
 }
 
 
@@ -513,8 +987,18 @@ namespace
 {
 //! Creates a planar texture mapping on the meshbuffer
 template <typename T>
-void makePlanarTextureMappingT(scene::IMeshBuffer* buffer, f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset)
+void makePlanarTextureMappingT(scene::IMeshBuffer* buffer, f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset, bool split)
 {
+	if (axis > 2)
+		return;
+
+	if (split && isLargeBuffer(buffer))
+	{
+		CPlanarMappingParts<T> parts(buffer, resolutionS, resolutionT, axis, offset);
+		parts.process();
+		return;
+	}
+
 	u32 idxcnt = buffer->getIndexCount();
 	T* idx = reinterpret_cast<T*>(buffer->getIndices());
 
@@ -547,39 +1031,123 @@ void makePlanarTextureMappingT(scene::IMeshBuffer* buffer, f32 resolutionS, f32
 		}
 	}
 }
-}
 
-
-//! Creates a planar texture mapping on the meshbuffer
-void CMeshManipulator::makePlanarTextureMapping(scene::IMeshBuffer* buffer, f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset) const
+struct SAxisPlanarMapping
 {
-	if (!buffer)
-		return;
+	SAxisPlanarMapping(f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset)
+		: ResolutionS(resolutionS), ResolutionT(resolutionT), Axis(axis), Offset(offset) {}
 
-	if (buffer->getIndexType()==video::EIT_16BIT)
-		makePlanarTextureMappingT<u16>(buffer, resolutionS, resolutionT, axis, offset);
-	else
-		makePlanarTextureMappingT<u32>(buffer, resolutionS, resolutionT, axis, offset);
-}
+	void operator()(IMeshBuffer* buffer, bool split) const
+	{
+		if (buffer->getIndexType()==video::EIT_16BIT)
+			makePlanarTextureMappingT<u16>(buffer, ResolutionS, ResolutionT, Axis, Offset, split);
+		else
+			makePlanarTextureMappingT<u32>(buffer, ResolutionS, ResolutionT, Axis, Offset, split);
+	}
 
+	f32 ResolutionS;
+	f32 ResolutionT;
+	u8 Axis;
+	core::vector3df Offset;
+};
 
-//! Creates a planar texture mapping on the mesh
-void CMeshManipulator::makePlanarTextureMapping(scene::IMesh* mesh, f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset) const
+//! Transforms the vertices of a large mesh buffer on several threads
+class CTransformParts : public CMeshBufferParts
 {
-	if (!mesh)
-		return;
+public:
+	CTransformParts(IMeshBuffer* buffer, const core::matrix4& m)
+		: Buffer(buffer), Transformation(m) {}
 
-	const u32 bcount = mesh->getMeshBufferCount();
-	for ( u32 b=0; b<bcount; ++b)
+	void process()
 	{
-		makePlanarTextureMapping(mesh->getMeshBuffer(b), resolutionS, resolutionT, axis, offset);
+		const u32 vtxcnt = Buffer->getVertexCount();
+		Boxes.set_used((vtxcnt + MESH_PART_SIZE - 1) / MESH_PART_SIZE);
+		runParts(vtxcnt);
+
+		core::aabbox3df bufferbox(Boxes[0]);
+		for (u32 i=1; i<Boxes.size(); ++i)
+			bufferbox.addInternalBox(Boxes[i]);
+		Buffer->setBoundingBox(bufferbox);
+	}
+
+protected:
+	virtual void runPart(u32 begin, u32 end) _IRR_OVERRIDE_
+	{
+		core::aabbox3df& box = Boxes[begin / MESH_PART_SIZE];
+		for (u32 i=begin; i!=end; ++i)
+		{
+			core::vector3df& pos = Buffer->getPosition(i);
+			Transformation.transformVect(pos);
+			if (i == begin)
+				box.reset(pos);
+			else
+				box.addInternalPoint(pos);
+		}
 	}
-}
 
+private:
+	IMeshBuffer* Buffer;
+	core::matrix4 Transformation;
+	core::array<core::aabbox3df> Boxes;
+};
 
-//! Clones a static IMesh into a modifyable SMesh.
-// not yet 32bit
-SMesh* CMeshManipulator::createMeshCopy(scene::IMesh* mesh) const
+struct STransform
+{
+	STransform(const core::matrix4& m) : Transformation(m) {}
+
+	void operator()(IMeshBuffer* buffer, bool split) const
+	{
+		if (split && isLargeBuffer(buffer))
+		{
+			CTransformParts parts(buffer, Transformation);
+			parts.process();
+		}
+		else
+		{
+			// like IMeshManipulator::apply with SVertexPositionTransformManipulator
+			core::aabbox3df bufferbox;
+			for (u32 i=0; i<buffer->getVertexCount(); ++i)
+			{
+				core::vector3df& pos = buffer->getPosition(i);
+				Transformation.transformVect(pos);
+				if (0==i)
+					bufferbox.reset(pos);
+				else
+					bufferbox.addInternalPoint(pos);
+			}
+			buffer->setBoundingBox(bufferbox);
+		}
+	}
+
+	core::matrix4 Transformation;
+};
+}
+
+
+//! Creates a planar texture mapping on the meshbuffer
+void CMeshManipulator::makePlanarTextureMapping(scene::IMeshBuffer* buffer, f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset) const
+{
+	if (!buffer)
+		return;
+
+	const SAxisPlanarMapping mapping(resolutionS, resolutionT, axis, offset);
+	mapping(buffer, true);
+}
+
+
+//! Creates a planar texture mapping on the mesh
+void CMeshManipulator::makePlanarTextureMapping(scene::IMesh* mesh, f32 resolutionS, f32 resolutionT, u8 axis, const core::vector3df& offset) const
+{
+	if (!mesh)
+		return;
+
+	processMeshBuffers(mesh, SAxisPlanarMapping(resolutionS, resolutionT, axis, offset));
+}
+
+
+//! Clones a static IMesh into a modifyable SMesh.
+// not yet 32bit
+SMesh* CMeshManipulator::createMeshCopy(scene::IMesh* mesh) const
 {
 	if (!mesh)
 		return 0;
@@ -947,85 +1515,121 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 }
 
 
-//! Creates a copy of the mesh, which will only consist of S3DVertexTangents vertices.
+namespace
+{
+//! Creates a copy of a mesh buffer with S3DVertexTangents vertices
 // not yet 32bit
-IMesh* CMeshManipulator::createMeshWithTangents(IMesh* mesh, bool recalculateNormals, bool smooth, bool angleWeighted, bool calculateTangents) const
+SMeshBufferTangents* createBufferWithTangents(const IMeshBuffer* original)
 {
-	if (!mesh)
-		return 0;
+	const u32 idxCnt = original->getIndexCount();
+	const u16* idx = original->getIndices();
 
-	// copy mesh and fill data into SMeshBufferTangents
+	SMeshBufferTangents* buffer = new SMeshBufferTangents();
 
-	SMesh* clone = new SMesh();
-	const u32 meshBufferCount = mesh->getMeshBufferCount();
-
-	for (u32 b=0; b<meshBufferCount; ++b)
-	{
-		const IMeshBuffer* const original = mesh->getMeshBuffer(b);
-		const u32 idxCnt = original->getIndexCount();
-		const u16* idx = original->getIndices();
+	buffer->Material = original->getMaterial();
+	buffer->Vertices.reallocate(idxCnt);
+	buffer->Indices.reallocate(idxCnt);
 
-		SMeshBufferTangents* buffer = new SMeshBufferTangents();
+	core::map<video::S3DVertexTangents, int> vertMap;
+	int vertLocation;
 
-		buffer->Material = original->getMaterial();
-		buffer->Vertices.reallocate(idxCnt);
-		buffer->Indices.reallocate(idxCnt);
+	// copy vertices
 
-		core::map<video::S3DVertexTangents, int> vertMap;
-		int vertLocation;
-
-		// copy vertices
-
-		const video::E_VERTEX_TYPE vType = original->getVertexType();
-		video::S3DVertexTangents vNew;
-		for (u32 i=0; i<idxCnt; ++i)
+	const video::E_VERTEX_TYPE vType = original->getVertexType();
+	video::S3DVertexTangents vNew;
+	for (u32 i=0; i<idxCnt; ++i)
+	{
+		switch(vType)
 		{
-			switch(vType)
+		case video::EVT_STANDARD:
 			{
-			case video::EVT_STANDARD:
-				{
-					const video::S3DVertex* v =
-						(const video::S3DVertex*)original->getVertices();
-					vNew = video::S3DVertexTangents(
-							v[idx[i]].Pos, v[idx[i]].Normal, v[idx[i]].Color, v[idx[i]].TCoords);
-				}
-				break;
-			case video::EVT_2TCOORDS:
-				{
-					const video::S3DVertex2TCoords* v =
-						(const video::S3DVertex2TCoords*)original->getVertices();
-					vNew = video::S3DVertexTangents(
-							v[idx[i]].Pos, v[idx[i]].Normal, v[idx[i]].Color, v[idx[i]].TCoords);
-				}
-				break;
-			case video::EVT_TANGENTS:
-				{
-					const video::S3DVertexTangents* v =
-						(const video::S3DVertexTangents*)original->getVertices();
-					vNew = v[idx[i]];
-				}
-				break;
+				const video::S3DVertex* v =
+					(const video::S3DVertex*)original->getVertices();
+				vNew = video::S3DVertexTangents(
+						v[idx[i]].Pos, v[idx[i]].Normal, v[idx[i]].Color, v[idx[i]].TCoords);
 			}
-			core::map<video::S3DVertexTangents, int>::Node* n = vertMap.find(vNew);
-			if (n)
+			break;
+		case video::EVT_2TCOORDS:
 			{
-				vertLocation = n->getValue();
+				const video::S3DVertex2TCoords* v =
+					(const video::S3DVertex2TCoords*)original->getVertices();
+				vNew = video::S3DVertexTangents(
+						v[idx[i]].Pos, v[idx[i]].Normal, v[idx[i]].Color, v[idx[i]].TCoords);
 			}
-			else
+			break;
+		case video::EVT_TANGENTS:
 			{
-				vertLocation = buffer->Vertices.size();
-				buffer->Vertices.push_back(vNew);
-				vertMap.insert(vNew, vertLocation);
+				const video::S3DVertexTangents* v =
+					(const video::S3DVertexTangents*)original->getVertices();
+				vNew = v[idx[i]];
 			}
-
-			// create new indices
-			buffer->Indices.push_back(vertLocation);
+			break;
 		}
-		buffer->recalculateBoundingBox();
+		core::map<video::S3DVertexTangents, int>::Node* n = vertMap.find(vNew);
+		if (n)
+		{
+			vertLocation = n->getValue();
+		}
+		else
+		{
+			vertLocation = buffer->Vertices.size();
+			buffer->Vertices.push_back(vNew);
+			vertMap.insert(vNew, vertLocation);
+		}
+
+		// create new indices
+		buffer->Indices.push_back(vertLocation);
+	}
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! Creates the tangent copies of several mesh buffers on several threads
+class CTangentBuffersJob : public os::IParallelJob
+{
+public:
+	CTangentBuffersJob(const core::array<const IMeshBuffer*>& originals, core::array<SMeshBufferTangents*>& buffers)
+		: Originals(originals), Buffers(buffers) {}
+
+	virtual void run(u32 index) _IRR_OVERRIDE_
+	{
+		Buffers[index] = createBufferWithTangents(Originals[index]);
+	}
 
+private:
+	const core::array<const IMeshBuffer*>& Originals;
+	core::array<SMeshBufferTangents*>& Buffers;
+};
+}
+
+
+//! Creates a copy of the mesh, which will only consist of S3DVertexTangents vertices.
+// not yet 32bit
+IMesh* CMeshManipulator::createMeshWithTangents(IMesh* mesh, bool recalculateNormals, bool smooth, bool angleWeighted, bool calculateTangents) const
+{
+	if (!mesh)
+		return 0;
+
+	// copy mesh and fill data into SMeshBufferTangents, the vertices of
+	// each buffer are joined on their own thread
+
+	SMesh* clone = new SMesh();
+	const u32 meshBufferCount = mesh->getMeshBufferCount();
+
+	core::array<const IMeshBuffer*> originals(meshBufferCount);
+	for (u32 b=0; b<meshBufferCount; ++b)
+		originals.push_back(mesh->getMeshBuffer(b));
+	core::array<SMeshBufferTangents*> buffers;
+	buffers.set_used(meshBufferCount);
+
+	CTangentBuffersJob job(originals, buffers);
+	os::Parallel::run(job, meshBufferCount);
+
+	for (u32 b=0; b<meshBufferCount; ++b)
+	{
 		// add new buffer
-		clone->addMeshBuffer(buffer);
-		buffer->drop();
+		clone->addMeshBuffer(buffers[b]);
+		buffers[b]->drop();
 	}
 
 	clone->recalculateBoundingBox();
@@ -1035,6 +1639,38 @@ IMesh* CMeshManipulator::createMeshWithTangents(IMesh* mesh, bool recalculateNor
 	return clone;
 }
 
+
+//! Applies a transformation to a meshbuffer
+void CMeshManipulator::transform(IMeshBuffer* buffer, const core::matrix4& m) const
+{
+	if (!buffer)
+		return;
+
+	const STransform transformation(m);
+	transformation(buffer, true);
+}
+
+
+//! Applies a transformation to a mesh
+void CMeshManipulator::transform(IMesh* mesh, const core::matrix4& m) const
+{
+	if (!mesh)
+		return;
+
+	processMeshBuffers(mesh, STransform(m));
+
+	// the same box as IMeshManipulator::apply
+	core::aabbox3df bufferbox;
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		if (0==i)
+			bufferbox.reset(mesh->getMeshBuffer(i)->getBoundingBox());
+		else
+			bufferbox.addInternalBox(mesh->getMeshBuffer(i)->getBoundingBox());
+	}
+	mesh->setBoundingBox(bufferbox);
+}
+
 namespace
 {
 
@@ -2145,6 +2781,887 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 	return newmesh;
 }
 
+namespace
+{
+
+//! Weighted sum of squared distances to planes, as symmetric 4x4 matrix
+struct SQuadric
+{
+	SQuadric() : A00(0), A01(0), A02(0), A03(0), A11(0), A12(0), A13(0),
+		A22(0), A23(0), A33(0), Weight(0) {}
+
+	//! Adds the plane n*p+d=0, n has to be normalized
+	void addPlane(const core::vector3df& n, f64 d, f64 weight)
+	{
+		const f64 x = n.X;
+		const f64 y = n.Y;
+		const f64 z = n.Z;
+		A00 += weight*x*x; A01 += weight*x*y; A02 += weight*x*z; A03 += weight*x*d;
+		A11 += weight*y*y; A12 += weight*y*z; A13 += weight*y*d;
+		A22 += weight*z*z; A23 += weight*z*d;
+		A33 += weight*d*d;
+		Weight += weight;
+	}
+
+	void add(const SQuadric& other)
+	{
+		A00 += other.A00; A01 += other.A01; A02 += other.A02; A03 += other.A03;
+		A11 += other.A11; A12 += other.A12; A13 += other.A13;
+		A22 += other.A22; A23 += other.A23;
+		A33 += other.A33;
+		Weight += other.Weight;
+	}
+
+	//! Mean squared distance of p to the planes
+	f64 getError(const core::vector3df& p) const
+	{
+		if (Weight <= 0.0)
+			return 0.0;
+		const f64 x = p.X;
+		const f64 y = p.Y;
+		const f64 z = p.Z;
+		const f64 e = x*(A00*x + 2.0*(A01*y + A02*z + A03)) +
+			y*(A11*y + 2.0*(A12*z + A13)) +
+			z*(A22*z + 2.0*A23) + A33;
+		return core::max_(e, 0.0) / Weight;
+	}
+
+	f64 A00, A01, A02, A03, A11, A12, A13, A22, A23, A33;
+	f64 Weight;
+};
+
+//! Sorts vertices by position, to find those at the same place
+struct SPositionKey
+{
+	bool operator<(const SPositionKey& other) const
+	{
+		if (Pos.X != other.Pos.X)
+			return Pos.X < other.Pos.X;
+		if (Pos.Y != other.Pos.Y)
+			return Pos.Y < other.Pos.Y;
+		if (Pos.Z != other.Pos.Z)
+			return Pos.Z < other.Pos.Z;
+		return Vertex < other.Vertex;
+	}
+
+	core::vector3df Pos;
+	u32 Vertex;
+};
+
+//! Sorts edges to count the triangles using them
+struct SEdgeKey
+{
+	bool operator<(const SEdgeKey& other) const
+	{
+		if (A != other.A)
+			return A < other.A;
+		if (B != other.B)
+			return B < other.B;
+		return Triangle < other.Triangle;
+	}
+
+	u32 A;
+	u32 B;
+	u32 Triangle;
+};
+
+//! Moving position From onto position To
+struct SCollapse
+{
+	bool operator<(const SCollapse& other) const
+	{
+		return Error < other.Error || (Error == other.Error && From < other.From);
+	}
+
+	f64 Error;
+	u32 From;
+	u32 To;
+};
+
+const u32 NO_VERTEX = 0xffffffff;
+
+// Border edges count more than faces, so open surfaces don't shrink
+const f64 BORDER_WEIGHT = 10.0;
+
+inline u32 getBufferIndex(const IMeshBuffer* mb, u32 i)
+{
+	if (mb->getIndexType() == video::EIT_32BIT)
+		return ((const u32*)mb->getIndices())[i];
+	return mb->getIndices()[i];
+}
+
+//! Copies a mesh buffer with other indices, keeping only the vertices they use
+/** The vertices are stored in the order of their first use. */
+CDynamicMeshBuffer* createIndexedCopy(const IMeshBuffer* mb, const core::array<u32>& indices, core::array<u32>& redirects)
+{
+	CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(mb->getVertexType(), mb->getIndexType());
+	buffer->Material = mb->getMaterial();
+	buffer->setPrimitiveType(mb->getPrimitiveType());
+	buffer->setHardwareMappingHint(mb->getHardwareMappingHint_Vertex(), EBT_VERTEX);
+	buffer->setHardwareMappingHint(mb->getHardwareMappingHint_Index(), EBT_INDEX);
+
+	const u8* vertices = (const u8*)mb->getVertices();
+	const u32 pitch = video::getVertexPitchFromType(mb->getVertexType());
+	IVertexBuffer& vertexBuffer = buffer->getVertexBuffer();
+	IIndexBuffer& indexBuffer = buffer->getIndexBuffer();
+	redirects.set_used(mb->getVertexCount());
+	for (u32 i=0; i<redirects.size(); ++i)
+		redirects[i] = NO_VERTEX;
+	indexBuffer.reallocate(indices.size());
+
+	for (u32 i=0; i<indices.size(); ++i)
+	{
+		const u32 v = indices[i];
+		if (redirects[v] == NO_VERTEX)
+		{
+			redirects[v] = vertexBuffer.size();
+			vertexBuffer.push_back(*(const video::S3DVertex*)(vertices + v*pitch));
+		}
+		indexBuffer.push_back(redirects[v]);
+	}
+
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! Edge collapses on the triangle list of one mesh buffer
+/** Vertices with the same position are collapsed together, so the
+topology is not broken at seams in the other vertex attributes. */
+class CTriangleSimplifier
+{
+public:
+	CTriangleSimplifier(const IMeshBuffer* mb) : LiveCount(0), Pass(0), Stamp(0)
+	{
+		const u32 vertexCount = mb->getVertexCount();
+		const u32 triangleCount = mb->getIndexCount() / 3;
+		Triangles.set_used(triangleCount*3);
+		for (u32 i=0; i<triangleCount*3; ++i)
+			Triangles[i] = getBufferIndex(mb, i);
+
+		// group the vertices by position
+		core::array<SPositionKey> keys;
+		keys.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			keys[i].Pos = mb->getPosition(i);
+			keys[i].Vertex = i;
+		}
+		keys.sort();
+
+		Cluster.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			const core::vector3df& p = keys[i].Pos;
+			if (i==0 || p.X != keys[i-1].Pos.X || p.Y != keys[i-1].Pos.Y || p.Z != keys[i-1].Pos.Z)
+				Positions.push_back(p);
+			Cluster[keys[i].Vertex] = Positions.size()-1;
+		}
+
+		const u32 clusterCount = Positions.size();
+		Quadrics.set_used(clusterCount);
+		Border.set_used(clusterCount);
+		Fixed.set_used(clusterCount);
+		Locked.set_used(clusterCount);
+		Marks.set_used(clusterCount);
+		for (u32 c=0; c<clusterCount; ++c)
+		{
+			Quadrics[c] = SQuadric();
+			Border[c] = 0;
+			Fixed[c] = 0;
+			Locked[c] = 0;
+			Marks[c] = 0;
+		}
+		MapTo.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+			MapTo[i] = NO_VERTEX;
+
+		// planes of the triangles
+		Alive.set_used(triangleCount);
+		core::array<core::vector3df> normals;
+		normals.set_used(triangleCount);
+		for (u32 t=0; t<triangleCount; ++t)
+		{
+			const u32 a = Cluster[Triangles[t*3]];
+			const u32 b = Cluster[Triangles[t*3+1]];
+			const u32 c = Cluster[Triangles[t*3+2]];
+			Alive[t] = (a != b && b != c && a != c);
+			normals[t].set(0.f, 0.f, 0.f);
+			if (!Alive[t])
+				continue;
+			++LiveCount;
+
+			core::vector3df n = (Positions[b] - Positions[a]).crossProduct(Positions[c] - Positions[a]);
+			const f64 length = n.getLength();
+			if (length <= 0.0)
+				continue;
+			n /= (f32)length;
+			normals[t] = n;
+			const f64 d = -n.dotProduct(Positions[a]);
+			Quadrics[a].addPlane(n, d, length * 0.5);
+			Quadrics[b].addPlane(n, d, length * 0.5);
+			Quadrics[c].addPlane(n, d, length * 0.5);
+		}
+
+		// edges with one triangle are borders, those with more are not collapsed
+		core::array<SEdgeKey> edges;
+		edges.reallocate(LiveCount*3);
+		for (u32 t=0; t<triangleCount; ++t)
+		{
+			if (!Alive[t])
+				continue;
+			for (u32 k=0; k<3; ++k)
+			{
+				const u32 a = Cluster[Triangles[t*3+k]];
+				const u32 b = Cluster[Triangles[t*3+(k+1)%3]];
+				SEdgeKey edge;
+				edge.A = core::min_(a, b);
+				edge.B = core::max_(a, b);
+				edge.Triangle = t;
+				edges.push_back(edge);
+			}
+		}
+		edges.sort();
+
+		for (u32 i=0; i<edges.size(); )
+		{
+			u32 j = i+1;
+			while (j<edges.size() && edges[j].A == edges[i].A && edges[j].B == edges[i].B)
+				++j;
+
+			const u32 a = edges[i].A;
+			const u32 b = edges[i].B;
+			if (j-i == 1)
+			{
+				Border[a] = 1;
+				Border[b] = 1;
+
+				// plane through the edge, perpendicular to the triangle
+				const core::vector3df e = Positions[b] - Positions[a];
+				core::vector3df n = e.crossProduct(normals[edges[i].Triangle]);
+				if (n.getLengthSQ() > 0.f)
+				{
+					n.normalize();
+					const f64 d = -n.dotProduct(Positions[a]);
+					const f64 weight = e.getLengthSQ() * BORDER_WEIGHT;
+					Quadrics[a].addPlane(n, d, weight);
+					Quadrics[b].addPlane(n, d, weight);
+				}
+			}
+			else if (j-i > 2)
+			{
+				Fixed[a] = 1;
+				Fixed[b] = 1;
+			}
+			i = j;
+		}
+	}
+
+	//! Collapses edges until targetCount triangles are left
+	/** \return Largest mean squared error of a collapse */
+	f64 simplify(u32 targetCount)
+	{
+		f64 maxError = 0.0;
+		const u32 clusterCount = Positions.size();
+
+		while (LiveCount > targetCount)
+		{
+			++Pass;
+			buildAdjacency();
+
+			// cheapest collapse of each position
+			Collapses.set_used(0);
+			for (u32 c=0; c<clusterCount; ++c)
+			{
+				if (Fixed[c])
+					continue;
+
+				SCollapse collapse;
+				collapse.From = c;
+				collapse.To = NO_VERTEX;
+				collapse.Error = 0.0;
+				for (u32 i=AdjacencyStart[c]; i<AdjacencyStart[c+1]; ++i)
+				{
+					const u32 t = Adjacency[i];
+					for (u32 k=0; k<3; ++k)
+					{
+						const u32 o = Cluster[Triangles[t*3+k]];
+						if (o == c || (Border[c] && !Border[o]))
+							continue;
+						const f64 error = Quadrics[c].getError(Positions[o]);
+						if (collapse.To == NO_VERTEX || error < collapse.Error)
+						{
+							collapse.To = o;
+							collapse.Error = error;
+						}
+					}
+				}
+				if (collapse.To != NO_VERTEX)
+					Collapses.push_back(collapse);
+			}
+			if (Collapses.empty())
+				break;
+			Collapses.sort();
+
+			// each collapse removes about two triangles, cheaper ones are
+			// done first even if they have to wait for the next pass
+			const u32 needed = core::min_((LiveCount - targetCount) / 2 + 1, Collapses.size());
+			const f64 limit = Collapses[needed-1].Error;
+
+			bool collapsed = false;
+			for (u32 i=0; i<Collapses.size() && LiveCount > targetCount; ++i)
+			{
+				const SCollapse& collapse = Collapses[i];
+				if (collapse.Error > limit)
+					break;
+				if (Locked[collapse.From] == Pass || Locked[collapse.To] == Pass)
+					continue;
+				if (!collapseEdge(collapse.From, collapse.To))
+					continue;
+				maxError = core::max_(maxError, collapse.Error);
+				collapsed = true;
+			}
+			if (!collapsed)
+				break;
+		}
+		return maxError;
+	}
+
+	//! Writes the vertex indices of the remaining triangles
+	void getTriangles(core::array<u32>& indices) const
+	{
+		indices.set_used(0);
+		indices.reallocate(LiveCount*3);
+		for (u32 t=0; t<Alive.size(); ++t)
+		{
+			if (!Alive[t])
+				continue;
+			indices.push_back(Triangles[t*3]);
+			indices.push_back(Triangles[t*3+1]);
+			indices.push_back(Triangles[t*3+2]);
+		}
+	}
+
+private:
+
+	//! Lists the living triangles of each position
+	void buildAdjacency()
+	{
+		const u32 clusterCount = Positions.size();
+		AdjacencyStart.set_used(clusterCount+1);
+		for (u32 c=0; c<=clusterCount; ++c)
+			AdjacencyStart[c] = 0;
+		for (u32 t=0; t<Alive.size(); ++t)
+		{
+			if (!Alive[t])
+				continue;
+			for (u32 k=0; k<3; ++k)
+				++AdjacencyStart[Cluster[Triangles[t*3+k]]+1];
+		}
+		for (u32 c=0; c<clusterCount; ++c)
+			AdjacencyStart[c+1] += AdjacencyStart[c];
+
+		Adjacency.set_used(AdjacencyStart[clusterCount]);
+		Fill.set_used(clusterCount);
+		for (u32 c=0; c<clusterCount; ++c)
+			Fill[c] = AdjacencyStart[c];
+		for (u32 t=0; t<Alive.size(); ++t)
+		{
+			if (!Alive[t])
+				continue;
+			for (u32 k=0; k<3; ++k)
+				Adjacency[Fill[Cluster[Triangles[t*3+k]]]++] = t;
+		}
+	}
+
+	//! Corner of triangle t at position c, 3 if it has none
+	u32 findCorner(u32 t, u32 c) const
+	{
+		for (u32 k=0; k<3; ++k)
+		{
+			if (Cluster[Triangles[t*3+k]] == c)
+				return k;
+		}
+		return 3;
+	}
+
+	//! Moves position a onto b, if this keeps the surface valid
+	bool collapseEdge(u32 a, u32 b)
+	{
+		Touched.set_used(0);
+		bool valid = true;
+
+		// each vertex at a moves to the vertex at b it shares a triangle with
+		u32 shared = 0;
+		for (u32 i=AdjacencyStart[a]; i<AdjacencyStart[a+1] && valid; ++i)
+		{
+			const u32 t = Adjacency[i];
+			if (!Alive[t])
+				continue;
+			const u32 kb = findCorner(t, b);
+			if (kb == 3)
+				continue;
+			++shared;
+			const u32 va = Triangles[t*3+findCorner(t, a)];
+			const u32 vb = Triangles[t*3+kb];
+			if (MapTo[va] == NO_VERTEX)
+			{
+				MapTo[va] = vb;
+				Touched.push_back(va);
+			}
+			else if (MapTo[va] != vb)
+				valid = false;
+		}
+
+		// borders are only collapsed along the border
+		if (shared == 0 || (Border[a] && shared != 1))
+			valid = false;
+
+		// the other triangles need a vertex at b and must not flip
+		for (u32 i=AdjacencyStart[a]; i<AdjacencyStart[a+1] && valid; ++i)
+		{
+			const u32 t = Adjacency[i];
+			if (!Alive[t] || findCorner(t, b) != 3)
+				continue;
+			const u32 ka = findCorner(t, a);
+			if (MapTo[Triangles[t*3+ka]] == NO_VERTEX)
+			{
+				valid = false;
+				break;
+			}
+
+			const core::vector3df& p1 = Positions[Cluster[Triangles[t*3+(ka+1)%3]]];
+			const core::vector3df& p2 = Positions[Cluster[Triangles[t*3+(ka+2)%3]]];
+			const core::vector3df before = (p1 - Positions[a]).crossProduct(p2 - Positions[a]);
+			const core::vector3df after = (p1 - Positions[b]).crossProduct(p2 - Positions[b]);
+			if (before.dotProduct(after) <= 0.f)
+				valid = false;
+		}
+
+		// a and b must not have other common neighbours than those of the
+		// removed triangles, otherwise the surface folds onto itself
+		if (valid)
+		{
+			const u32 neighbour = ++Stamp;
+			const u32 counted = ++Stamp;
+			for (u32 i=AdjacencyStart[a]; i<AdjacencyStart[a+1]; ++i)
+			{
+				const u32 t = Adjacency[i];
+				if (!Alive[t])
+					continue;
+				for (u32 k=0; k<3; ++k)
+					Marks[Cluster[Triangles[t*3+k]]] = neighbour;
+			}
+			u32 common = 0;
+			for (u32 i=AdjacencyStart[b]; i<AdjacencyStart[b+1]; ++i)
+			{
+				const u32 t = Adjacency[i];
+				if (!Alive[t])
+					continue;
+				for (u32 k=0; k<3; ++k)
+				{
+					const u32 o = Cluster[Triangles[t*3+k]];
+					if (o != a && o != b && Marks[o] == neighbour)
+					{
+						Marks[o] = counted;
+						++common;
+					}
+				}
+			}
+			valid = (common == shared);
+		}
+
+		if (valid)
+		{
+			for (u32 i=AdjacencyStart[a]; i<AdjacencyStart[a+1]; ++i)
+			{
+				const u32 t = Adjacency[i];
+				if (!Alive[t])
+					continue;
+				if (findCorner(t, b) != 3)
+				{
+					Alive[t] = 0;
+					--LiveCount;
+				}
+				else
+				{
+					u32& v = Triangles[t*3+findCorner(t, a)];
+					v = MapTo[v];
+				}
+				// the neighbourhood changed, so their costs are outdated
+				for (u32 k=0; k<3; ++k)
+					Locked[Cluster[Triangles[t*3+k]]] = Pass;
+			}
+			Locked[a] = Pass;
+			Locked[b] = Pass;
+			Quadrics[b].add(Quadrics[a]);
+		}
+
+		for (u32 i=0; i<Touched.size(); ++i)
+			MapTo[Touched[i]] = NO_VERTEX;
+		return valid;
+	}
+
+	//! Vertex indices, three per triangle
+	core::array<u32> Triangles;
+	core::array<u8> Alive;
+	//! Position index of each vertex
+	core::array<u32> Cluster;
+
+	// per position
+	core::array<core::vector3df> Positions;
+	core::array<SQuadric> Quadrics;
+	core::array<u8> Border;
+	core::array<u8> Fixed;
+	core::array<u32> Locked;
+	core::array<u32> Marks;
+
+	core::array<u32> AdjacencyStart;
+	core::array<u32> Adjacency;
+	core::array<u32> Fill;
+	core::array<SCollapse> Collapses;
+	core::array<u32> MapTo;
+	core::array<u32> Touched;
+
+	u32 LiveCount;
+	u32 Pass;
+	u32 Stamp;
+};
+
+
+//! Greedy grouping of the triangles of one mesh buffer into clusters
+/** A cluster starts next to the previous one and grows by the adjacent
+triangle nearest to its center, where triangles turned away from its average
+normal count as farther away. Vertices at the same position are one corner,
+so seams in the other vertex attributes don't split clusters. */
+class CTriangleClusterer
+{
+public:
+
+	CTriangleClusterer(const IMeshBuffer* mb) : MeshBuffer(mb)
+	{
+		const u32 vertexCount = mb->getVertexCount();
+		const u32 triangleCount = mb->getIndexCount() / 3;
+
+		core::array<SPositionKey> keys;
+		keys.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			keys[i].Pos = mb->getPosition(i);
+			keys[i].Vertex = i;
+		}
+		keys.sort();
+
+		Corners.set_used(vertexCount);
+		u32 cornerCount = 0;
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			const core::vector3df& p = keys[i].Pos;
+			if (i == 0 || p.X != keys[i-1].Pos.X || p.Y != keys[i-1].Pos.Y || p.Z != keys[i-1].Pos.Z)
+				++cornerCount;
+			Corners[keys[i].Vertex] = cornerCount - 1;
+		}
+
+		TriangleCorners.set_used(triangleCount * 3);
+		for (u32 i=0; i<TriangleCorners.size(); ++i)
+			TriangleCorners[i] = Corners[getBufferIndex(mb, i)];
+
+		// triangles around each corner
+		TriangleStart.set_used(cornerCount + 1);
+		for (u32 i=0; i<TriangleStart.size(); ++i)
+			TriangleStart[i] = 0;
+		for (u32 i=0; i<TriangleCorners.size(); ++i)
+			++TriangleStart[TriangleCorners[i] + 1];
+		for (u32 c=0; c<cornerCount; ++c)
+			TriangleStart[c+1] += TriangleStart[c];
+
+		core::array<u32> fill(TriangleStart);
+		CornerTriangles.set_used(triangleCount * 3);
+		for (u32 i=0; i<TriangleCorners.size(); ++i)
+			CornerTriangles[fill[TriangleCorners[i]]++] = i / 3;
+
+		Centers.set_used(triangleCount);
+		Normals.set_used(triangleCount);
+		for (u32 t=0; t<triangleCount; ++t)
+		{
+			const core::vector3df& a = mb->getPosition(getBufferIndex(mb, t*3));
+			const core::vector3df& b = mb->getPosition(getBufferIndex(mb, t*3+1));
+			const core::vector3df& c = mb->getPosition(getBufferIndex(mb, t*3+2));
+			Centers[t] = (a + b + c) / 3.f;
+			// zero for degenerated triangles
+			Normals[t] = (b - a).crossProduct(c - a).normalize();
+		}
+	}
+
+	//! Sorts the triangles into clusters
+	/** \param indices Receives the indices of the triangles, cluster after cluster
+	\param clusters The clusters of the mesh buffer are appended */
+	void build(u32 maxTriangles, u32 buffer, core::array<u32>& indices, core::array<SMeshCluster>& clusters)
+	{
+		const u32 triangleCount = Centers.size();
+		Used.set_used(triangleCount);
+		Stamps.set_used(triangleCount);
+		for (u32 t=0; t<triangleCount; ++t)
+		{
+			Used[t] = 0;
+			Stamps[t] = NO_VERTEX;
+		}
+		CornerStamps.set_used(TriangleStart.size() - 1);
+		for (u32 c=0; c<CornerStamps.size(); ++c)
+			CornerStamps[c] = NO_VERTEX;
+
+		indices.set_used(0);
+		indices.reallocate(triangleCount * 3);
+		Front.set_used(0);
+		u32 scan = 0;
+		u32 done = 0;
+
+		while (done < triangleCount)
+		{
+			// continue next to the previous cluster
+			u32 seed = NO_VERTEX;
+			for (u32 i=0; i<Front.size() && seed == NO_VERTEX; ++i)
+			{
+				if (!Used[Front[i]])
+					seed = Front[i];
+			}
+			if (seed == NO_VERTEX)
+			{
+				while (Used[scan])
+					++scan;
+				seed = scan;
+			}
+
+			Front.set_used(0);
+			Cluster.set_used(0);
+			CenterSum.set(0.f, 0.f, 0.f);
+			NormalSum.set(0.f, 0.f, 0.f);
+			addTriangle(seed, clusters.size());
+
+			while (Cluster.size() < maxTriangles)
+			{
+				const core::vector3df center = CenterSum / (f32)Cluster.size();
+				const core::vector3df axis = core::vector3df(NormalSum).normalize();
+
+				u32 best = NO_VERTEX;
+				u32 bestNewCorners = 0;
+				f32 bestScore = 0.f;
+				u32 live = 0;
+				for (u32 i=0; i<Front.size(); ++i)
+				{
+					const u32 t = Front[i];
+					if (Used[t])
+						continue;
+					Front[live++] = t;
+
+					// triangles filling holes come first, then those sharing an edge
+					u32 newCorners = 0;
+					for (u32 k=0; k<3; ++k)
+					{
+						if (CornerStamps[TriangleCorners[t*3 + k]] != clusters.size())
+							++newCorners;
+					}
+
+					const f32 score = Centers[t].getDistanceFromSQ(center) *
+						(1.f + CONE_WEIGHT * (1.f - Normals[t].dotProduct(axis)));
+					if (best == NO_VERTEX || newCorners < bestNewCorners ||
+						(newCorners == bestNewCorners && score < bestScore))
+					{
+						best = t;
+						bestNewCorners = newCorners;
+						bestScore = score;
+					}
+				}
+				Front.set_used(live);
+
+				if (best == NO_VERTEX)
+					break;
+				addTriangle(best, clusters.size());
+			}
+			done += Cluster.size();
+
+			SMeshCluster cluster;
+			cluster.MeshBuffer = buffer;
+			cluster.FirstIndex = indices.size();
+			cluster.IndexCount = Cluster.size() * 3;
+			for (u32 i=0; i<Cluster.size(); ++i)
+			{
+				for (u32 k=0; k<3; ++k)
+					indices.push_back(getBufferIndex(MeshBuffer, Cluster[i]*3 + k));
+			}
+			setBounds(cluster, indices);
+			clusters.push_back(cluster);
+		}
+	}
+
+private:
+
+	void addTriangle(u32 t, u32 stamp)
+	{
+		Used[t] = 1;
+		Cluster.push_back(t);
+		CenterSum += Centers[t];
+		NormalSum += Normals[t];
+
+		for (u32 k=0; k<3; ++k)
+		{
+			const u32 corner = TriangleCorners[t*3 + k];
+			CornerStamps[corner] = stamp;
+			for (u32 i=TriangleStart[corner]; i<TriangleStart[corner+1]; ++i)
+			{
+				const u32 n = CornerTriangles[i];
+				if (!Used[n] && Stamps[n] != stamp)
+				{
+					Stamps[n] = stamp;
+					Front.push_back(n);
+				}
+			}
+		}
+	}
+
+	//! Calculates the bounding sphere and the normal cone of a cluster
+	void setBounds(SMeshCluster& cluster, const core::array<u32>& indices) const
+	{
+		const u32 end = cluster.FirstIndex + cluster.IndexCount;
+		core::aabbox3df box(MeshBuffer->getPosition(indices[cluster.FirstIndex]));
+		for (u32 i=cluster.FirstIndex+1; i<end; ++i)
+			box.addInternalPoint(MeshBuffer->getPosition(indices[i]));
+
+		cluster.Center = box.getCenter();
+		f32 radius = 0.f;
+		for (u32 i=cluster.FirstIndex; i<end; ++i)
+			radius = core::max_(radius, MeshBuffer->getPosition(indices[i]).getDistanceFromSQ(cluster.Center));
+		cluster.Radius = sqrtf(radius);
+
+		cluster.ConeAxis = core::vector3df(NormalSum).normalize();
+		cluster.ConeCutoff = 1.f;
+		if (cluster.ConeAxis.getLengthSQ() == 0.f)
+			return;
+
+		f32 minDot = 1.f;
+		for (u32 i=0; i<Cluster.size(); ++i)
+		{
+			const core::vector3df& n = Normals[Cluster[i]];
+			if (n.getLengthSQ() != 0.f)
+				minDot = core::min_(minDot, n.dotProduct(cluster.ConeAxis));
+		}
+
+		// the sphere test is useless for cones wider than about 84 degrees
+		if (minDot > 0.1f)
+			cluster.ConeCutoff = sqrtf(1.f - minDot*minDot);
+	}
+
+	// turned triangles count as up to five times farther away
+	static const f32 CONE_WEIGHT;
+
+	const IMeshBuffer* MeshBuffer;
+
+	//! corner of each vertex
+	core::array<u32> Corners;
+	//! corners of each triangle
+	core::array<u32> TriangleCorners;
+	//! triangles around corner c are CornerTriangles[TriangleStart[c]] to CornerTriangles[TriangleStart[c+1]-1]
+	core::array<u32> TriangleStart;
+	core::array<u32> CornerTriangles;
+
+	core::array<core::vector3df> Centers;
+	core::array<core::vector3df> Normals;
+	core::array<u8> Used;
+	//! cluster which added a triangle to the front last
+	core::array<u32> Stamps;
+	//! cluster which used a corner last
+	core::array<u32> CornerStamps;
+
+	//! triangles next to the current cluster
+	core::array<u32> Front;
+	core::array<u32> Cluster;
+	core::vector3df CenterSum;
+	core::vector3df NormalSum;
+};
+
+const f32 CTriangleClusterer::CONE_WEIGHT = 2.f;
+
+} // end anonymous namespace
+
+
+//! Creates a copy of the mesh with fewer triangles
+IMesh* CMeshManipulator::createSimplifiedMesh(IMesh* mesh, f32 ratio, f32* error) const
+{
+	if (!mesh)
+		return 0;
+
+	SMesh* clone = new SMesh();
+	f64 maxError = 0.0;
+	core::array<u32> indices;
+	core::array<u32> redirects;
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* const mb = mesh->getMeshBuffer(b);
+
+		if (mb->getPrimitiveType() == EPT_TRIANGLES)
+		{
+			CTriangleSimplifier simplifier(mb);
+			const u32 target = (u32)(mb->getIndexCount() / 3 * core::clamp(ratio, 0.f, 1.f));
+			maxError = core::max_(maxError, simplifier.simplify(target));
+			simplifier.getTriangles(indices);
+		}
+		else
+		{
+			indices.set_used(mb->getIndexCount());
+			for (u32 i=0; i<indices.size(); ++i)
+				indices[i] = getBufferIndex(mb, i);
+		}
+
+		// copy the vertices which are still used
+		CDynamicMeshBuffer* buffer = createIndexedCopy(mb, indices, redirects);
+		clone->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+
+	clone->recalculateBoundingBox();
+	if (error)
+		*error = (f32)sqrt(maxError);
+	return clone;
+}
+
+
+//! Creates a copy of the mesh with its triangles sorted into small clusters for culling
+IMesh* CMeshManipulator::createClusteredMesh(IMesh* mesh, core::array<SMeshCluster>& clusters, u32 maxTriangles) const
+{
+	clusters.clear();
+	if (!mesh)
+		return 0;
+
+	SMesh* clone = new SMesh();
+	core::array<u32> indices;
+	core::array<u32> redirects;
+	maxTriangles = core::max_(maxTriangles, 1u);
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* const mb = mesh->getMeshBuffer(b);
+
+		if (mb->getPrimitiveType() == EPT_TRIANGLES)
+		{
+			CTriangleClusterer clusterer(mb);
+			clusterer.build(maxTriangles, b, indices, clusters);
+		}
+		else
+		{
+			indices.set_used(mb->getIndexCount());
+			for (u32 i=0; i<indices.size(); ++i)
+				indices[i] = getBufferIndex(mb, i);
+		}
+
+		CDynamicMeshBuffer* buffer = createIndexedCopy(mb, indices, redirects);
+		clone->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+
+	clone->recalculateBoundingBox();
+	return clone;
+}
+
 } // end namespace scene
 } // end namespace irr
 
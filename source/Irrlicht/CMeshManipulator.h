@@ -63,6 +63,12 @@ public:
 	//! Creates a copy of the mesh, which will only consist of S3DVertexTangents vertices.
 	virtual IMesh* createMeshWithTangents(IMesh* mesh, bool recalculateNormals=false, bool smooth=false, bool angleWeighted=false, bool recalculateTangents=true) const _IRR_OVERRIDE_;
 
+	//! Applies a transformation to a mesh
+	virtual void transform(IMesh* mesh, const core::matrix4& m) const _IRR_OVERRIDE_;
+
+	//! Applies a transformation to a meshbuffer
+	virtual void transform(IMeshBuffer* buffer, const core::matrix4& m) const _IRR_OVERRIDE_;
+
 	//! Creates a copy of the mesh, which will only consist of S3D2TCoords vertices.
 	virtual IMesh* createMeshWith2TCoords(IMesh* mesh) const _IRR_OVERRIDE_;
 
@@ -75,6 +81,12 @@ public:
 	//! Creates a copy of the mesh, which will have all duplicated vertices removed, i.e. maximal amount of vertices are shared via indexing.
 	virtual IMesh* createMeshWelded(IMesh *mesh, f32 tolerance=core::ROUNDING_ERROR_f32) const _IRR_OVERRIDE_;
 
+	//! Creates a copy of the mesh with fewer triangles, using quadric error edge collapses
+	virtual IMesh* createSimplifiedMesh(IMesh* mesh, f32 ratio, f32* error=0) const _IRR_OVERRIDE_;
+
+	//! Creates a copy of the mesh with its triangles sorted into small clusters for culling
+	virtual IMesh* createClusteredMesh(IMesh* mesh, core::array<SMeshCluster>& clusters, u32 maxTriangles=128) const _IRR_OVERRIDE_;
+
 	//! Returns amount of polygons in mesh.
 	virtual s32 getPolyCount(scene::IMesh* mesh) const _IRR_OVERRIDE_;
 
@@ -4,6 +4,7 @@
 
 #include "CNullDriver.h"
 #include "os.h"
+#include "irrHash.h"
 #include "CImage.h"
 #include "CAttributes.h"
 #include "IReadFile.h"
@@ -1867,7 +1868,7 @@ void CNullDriver::addOcclusionQuery(scene::ISceneNode* node, const scene::IMesh*
 	}
 
 	//search for query
-	s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	s32 index = findOcclusionQuery(node);
 	if (index != -1)
 	{
 		if (OcclusionQueries[index].Mesh != mesh)
@@ -1879,8 +1880,32 @@ void CNullDriver::addOcclusionQuery(scene::ISceneNode* node, const scene::IMesh*
 	}
 	else
 	{
-		OcclusionQueries.push_back(SOccQuery(node, mesh));
+		// a free slot is used again, the slots of the other queries never move
+		u32 slot;
+		if (!OcclusionQueryFreeSlots.empty())
+		{
+			slot = OcclusionQueryFreeSlots.getLast();
+			OcclusionQueryFreeSlots.erase(OcclusionQueryFreeSlots.size()-1);
+			OcclusionQueries[slot] = SOccQuery(node, mesh);
+		}
+		else
+		{
+			slot = OcclusionQueries.size();
+			OcclusionQueries.push_back(SOccQuery(node, mesh));
+		}
 		node->setAutomaticCulling(node->getAutomaticCulling() | scene::EAC_OCC_QUERY);
+
+		// keep the index at most half full
+		if (OcclusionQueries.size()*2 > OcclusionQueryIndex.size())
+			rebuildOcclusionQueryIndex();
+		else
+		{
+			const u32 mask = OcclusionQueryIndex.size() - 1;
+			u32 h = core::hashPointer(node) & mask;
+			while (OcclusionQueryIndex[h] >= 0)
+				h = (h + 1) & mask;
+			OcclusionQueryIndex[h] = (s32)slot;
+		}
 	}
 }
 
@@ -1889,22 +1914,22 @@ void CNullDriver::addOcclusionQuery(scene::ISceneNode* node, const scene::IMesh*
 void CNullDriver::removeOcclusionQuery(scene::ISceneNode* node)
 {
 	//search for query
-	s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = findOcclusionQuery(node);
 	if (index != -1)
-	{
-		node->setAutomaticCulling(node->getAutomaticCulling() & ~scene::EAC_OCC_QUERY);
-		OcclusionQueries.erase(index);
-	}
+		removeOcclusionQuerySlot((u32)index);
 }
 
 
 //! Remove all occlusion queries.
 void CNullDriver::removeAllOcclusionQueries()
 {
-	for (s32 i=OcclusionQueries.size()-1; i>=0; --i)
+	for (u32 i=0; i<OcclusionQueries.size(); ++i)
 	{
-		removeOcclusionQuery(OcclusionQueries[i].Node);
+		if (OcclusionQueries[i].Node)
+			removeOcclusionQuerySlot(i);
 	}
+	OcclusionQueries.clear();
+	OcclusionQueryFreeSlots.clear();
 }
 
 
@@ -1915,28 +1940,12 @@ void CNullDriver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 {
 	if(!node)
 		return;
-	s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = findOcclusionQuery(node);
 	if (index==-1)
 		return;
-	OcclusionQueries[index].Run=0;
 	if (!visible)
-	{
-		SMaterial mat;
-		mat.Lighting=false;
-		mat.AntiAliasing=0;
-		mat.ColorMask=ECP_NONE;
-		mat.GouraudShading=false;
-		mat.ZWriteEnable=false;
-		setMaterial(mat);
-	}
-	setTransform(video::ETS_WORLD, node->getAbsoluteTransformation());
-	const scene::IMesh* mesh = OcclusionQueries[index].Mesh;
-	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
-	{
-		if (visible)
-			setMaterial(mesh->getMeshBuffer(i)->getMaterial());
-		drawMeshBuffer(mesh->getMeshBuffer(i));
-	}
+		setOcclusionQueryMaterial();
+	runOcclusionQuerySlot((u32)index, visible);
 }
 
 
@@ -1945,8 +1954,15 @@ void CNullDriver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 overrideMaterial to disable the color and depth buffer. */
 void CNullDriver::runAllOcclusionQueries(bool visible)
 {
+	if (OcclusionQueries.empty())
+		return;
+	if (!visible)
+		setOcclusionQueryMaterial();
 	for (u32 i=0; i<OcclusionQueries.size(); ++i)
-		runOcclusionQuery(OcclusionQueries[i].Node, visible);
+	{
+		if (OcclusionQueries[i].Node)
+			runOcclusionQuerySlot(i, visible);
+	}
 }
 
 
@@ -1955,6 +1971,9 @@ void CNullDriver::runAllOcclusionQueries(bool visible)
 Update might not occur in this case, though */
 void CNullDriver::updateOcclusionQuery(scene::ISceneNode* node, bool block)
 {
+	const s32 index = findOcclusionQuery(node);
+	if (index != -1)
+		updateOcclusionQuerySlot((u32)index, block);
 }
 
 
@@ -1965,12 +1984,12 @@ void CNullDriver::updateAllOcclusionQueries(bool block)
 {
 	for (u32 i=0; i<OcclusionQueries.size(); ++i)
 	{
-		if (OcclusionQueries[i].Run==u32(~0))
+		if (!OcclusionQueries[i].Node || OcclusionQueries[i].Run==u32(~0))
 			continue;
-		updateOcclusionQuery(OcclusionQueries[i].Node, block);
+		updateOcclusionQuerySlot(i, block);
 		++OcclusionQueries[i].Run;
 		if (OcclusionQueries[i].Run>1000)
-			removeOcclusionQuery(OcclusionQueries[i].Node);
+			removeOcclusionQuerySlot(i);
 	}
 }
 
@@ -1981,7 +2000,105 @@ The value is a safe approximation, i.e. can be larger then the
 actual value of pixels. */
 u32 CNullDriver::getOcclusionQueryResult(scene::ISceneNode* node) const
 {
-	return ~0;
+	const s32 index = findOcclusionQuery(node);
+	if (index != -1)
+		return OcclusionQueries[index].Result;
+	else
+		return ~0;
+}
+
+
+//! Returns the slot of the occlusion query for the node, or -1 if there is none
+s32 CNullDriver::findOcclusionQuery(const scene::ISceneNode* node) const
+{
+	if (OcclusionQueryIndex.empty())
+		return -1;
+
+	const u32 mask = OcclusionQueryIndex.size() - 1;
+	for (u32 h = core::hashPointer(node) & mask; OcclusionQueryIndex[h] >= 0; h = (h + 1) & mask)
+	{
+		if (OcclusionQueries[OcclusionQueryIndex[h]].Node == node)
+			return OcclusionQueryIndex[h];
+	}
+	return -1;
+}
+
+
+//! Runs the occlusion query in the slot, the material is already set for invisible queries
+void CNullDriver::runOcclusionQuerySlot(u32 index, bool visible)
+{
+	SOccQuery& query = OcclusionQueries[index];
+	query.Run=0;
+	setTransform(video::ETS_WORLD, query.Node->getAbsoluteTransformation());
+	const scene::IMesh* mesh = query.Mesh;
+	for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		if (visible)
+			setMaterial(mesh->getMeshBuffer(i)->getMaterial());
+		drawMeshBuffer(mesh->getMeshBuffer(i));
+	}
+}
+
+
+//! Removes the occlusion query in the slot, which is kept free for the next query
+void CNullDriver::removeOcclusionQuerySlot(u32 index)
+{
+	scene::ISceneNode* node = OcclusionQueries[index].Node;
+	node->setAutomaticCulling(node->getAutomaticCulling() & ~scene::EAC_OCC_QUERY);
+
+	// remove the entry and close the gap for entries probed past it
+	const u32 mask = OcclusionQueryIndex.size() - 1;
+	u32 h = core::hashPointer(node) & mask;
+	while (OcclusionQueryIndex[h] != (s32)index)
+		h = (h + 1) & mask;
+	for (u32 next = (h + 1) & mask; OcclusionQueryIndex[next] >= 0; next = (next + 1) & mask)
+	{
+		const u32 home = core::hashPointer(OcclusionQueries[OcclusionQueryIndex[next]].Node) & mask;
+		// entry stays if its home lies cyclically in (h, next]
+		if ((h <= next) ? (h < home && home <= next) : (h < home || home <= next))
+			continue;
+		OcclusionQueryIndex[h] = OcclusionQueryIndex[next];
+		h = next;
+	}
+	OcclusionQueryIndex[h] = -1;
+
+	OcclusionQueries[index] = SOccQuery(0);
+	OcclusionQueryFreeSlots.push_back(index);
+}
+
+
+//! Sets the material used to draw invisible occlusion queries
+void CNullDriver::setOcclusionQueryMaterial()
+{
+	SMaterial mat;
+	mat.Lighting=false;
+	mat.AntiAliasing=0;
+	mat.ColorMask=ECP_NONE;
+	mat.GouraudShading=false;
+	mat.ZWriteEnable=false;
+	setMaterial(mat);
+}
+
+
+//! Rebuilds OcclusionQueryIndex for the current queries
+void CNullDriver::rebuildOcclusionQueryIndex()
+{
+	u32 size = 32;
+	while (size < OcclusionQueries.size()*4)
+		size <<= 1;
+	OcclusionQueryIndex.set_used(size);
+	for (u32 i=0; i<size; ++i)
+		OcclusionQueryIndex[i] = -1;
+	const u32 mask = size - 1;
+	for (u32 i=0; i<OcclusionQueries.size(); ++i)
+	{
+		if (!OcclusionQueries[i].Node)
+			continue;
+		u32 h = core::hashPointer(OcclusionQueries[i].Node) & mask;
+		while (OcclusionQueryIndex[h] >= 0)
+			h = (h + 1) & mask;
+		OcclusionQueryIndex[h] = (s32)i;
+	}
 }
 
 
@@ -239,7 +239,7 @@ namespace video
 		virtual const core::dimension2d<u32>& getScreenSize() const _IRR_OVERRIDE_;
 
 		//! get current render target
-		IRenderTarget* getCurrentRenderTarget() const;
+		virtual IRenderTarget* getCurrentRenderTarget() const _IRR_OVERRIDE_;
 
 		//! get render target size
 		virtual const core::dimension2d<u32>& getCurrentRenderTargetSize() const _IRR_OVERRIDE_;
@@ -705,6 +705,24 @@ namespace video
 		// prints renderer version
 		void printVersion();
 
+		//! Returns the slot of the occlusion query for the node, or -1 if there is none
+		s32 findOcclusionQuery(const scene::ISceneNode* node) const;
+
+		//! Runs the occlusion query in the slot, the material is already set for invisible queries
+		virtual void runOcclusionQuerySlot(u32 index, bool visible);
+
+		//! Retrieves the result of the occlusion query in the slot
+		virtual void updateOcclusionQuerySlot(u32 index, bool block) {}
+
+		//! Removes the occlusion query in the slot, which is kept free for the next query
+		virtual void removeOcclusionQuerySlot(u32 index);
+
+		//! Sets the material used to draw invisible occlusion queries
+		void setOcclusionQueryMaterial();
+
+		//! Rebuilds OcclusionQueryIndex for the current queries
+		void rebuildOcclusionQueryIndex();
+
 		//! normal map lookup 32 bit version
 		inline f32 nml32(int x, int y, int pitch, int height, s32 *p) const
 		{
@@ -808,15 +826,19 @@ namespace video
 
 			SOccQuery& operator=(const SOccQuery& other)
 			{
+				if (other.Node)
+					other.Node->grab();
+				if (other.Mesh)
+					other.Mesh->grab();
+				if (Node)
+					Node->drop();
+				if (Mesh)
+					Mesh->drop();
 				Node=other.Node;
 				Mesh=other.Mesh;
 				PID=other.PID;
 				Result=other.Result;
 				Run=other.Run;
-				if (Node)
-					Node->grab();
-				if (Mesh)
-					Mesh->grab();
 				return *this;
 			}
 
@@ -835,7 +857,12 @@ namespace video
 			u32 Result;
 			u32 Run;
 		};
+		//! queries by slot, a slot stays while its node is registered, free slots have no node
 		core::array<SOccQuery> OcclusionQueries;
+		//! slots of removed queries, used again by the next added ones
+		core::array<u32> OcclusionQueryFreeSlots;
+		//! hash table from node to slot in OcclusionQueries, -1 for empty entries
+		core::array<s32> OcclusionQueryIndex;
 
 		core::array<IRenderTarget*> RenderTargets;
 
@@ -29,6 +29,28 @@ namespace scene
 
 static const u32 WORD_BUFFER_LENGTH = 512;
 
+// smallest part of the file which is worth to be read by an own thread
+static const long PARALLEL_CHUNK_SIZE = 256*1024;
+
+
+//! Reads the vertex chunks of a file in the first pass of parallel loading
+class COBJMeshFileLoader::CReadVertexChunksJob : public os::IParallelJob
+{
+public:
+	CReadVertexChunksJob(COBJMeshFileLoader* loader, core::array<SVertexChunk>& chunks, const c8* const bufEnd)
+		: Loader(loader), Chunks(chunks), BufEnd(bufEnd) {}
+
+	virtual void run(u32 index) _IRR_OVERRIDE_
+	{
+		Loader->readVertexChunk(Chunks[index], BufEnd);
+	}
+
+private:
+	COBJMeshFileLoader* Loader;
+	core::array<SVertexChunk>& Chunks;
+	const c8* const BufEnd;
+};
+
 //! Constructor
 COBJMeshFileLoader::COBJMeshFileLoader(scene::ISceneManager* smgr, io::IFileSystem* fs)
 : SceneManager(smgr), FileSystem(fs)
@@ -100,11 +122,65 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	bool mtlChanged=false;
 	bool useGroups = !SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_GROUPS);
 	bool useMaterials = !SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_MATERIAL_FILES);
+	const bool parallelParsing = SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_PARALLEL_PARSING);
 	irr::u32 lineNr = 1;	// only counts non-empty lines, still useful in debugging to locate errors
 	core::array<int> faceCorners;
 	faceCorners.reallocate(32); // should be large enough
 	const core::stringc TAG_OFF = "off";
 
+	// Number of v, vn and vt lines seen so far. Faces can only reference those.
+	u32 vertexCount = 0;
+	u32 normalsCount = 0;
+	u32 textureCoordCount = 0;
+
+	// In parallel mode the vertex data of all line-aligned chunks is read by
+	// worker threads first and concatenated in file order. The second pass
+	// below then only counts those lines and builds the faces.
+	const u32 chunkCount = parallelParsing ?
+		core::min_((u32)(filesize / PARALLEL_CHUNK_SIZE), os::Parallel::getThreadCount()*4) : 0;
+	const bool vertexDataRead = chunkCount > 1;
+	if (vertexDataRead)
+	{
+		core::array<SVertexChunk> chunks(chunkCount);
+		const c8* chunkBegin = buf;
+		for (u32 i=0; i<chunkCount; ++i)
+		{
+			const c8* chunkEnd = (i+1 == chunkCount) ? bufEnd : buf + (filesize / chunkCount) * (i+1);
+			if (chunkEnd < chunkBegin)
+				chunkEnd = chunkBegin;
+			while (chunkEnd != bufEnd && *(chunkEnd-1) != '\n')
+				++chunkEnd;
+			chunks.push_back(SVertexChunk());
+			chunks[i].Begin = chunkBegin;
+			chunks[i].End = chunkEnd;
+			chunkBegin = chunkEnd;
+		}
+
+		CReadVertexChunksJob job(this, chunks, bufEnd);
+		os::Parallel::run(job, chunkCount);
+
+		u32 positions = 0, normals = 0, tcoords = 0;
+		for (u32 i=0; i<chunkCount; ++i)
+		{
+			positions += chunks[i].Positions.size();
+			normals += chunks[i].Normals.size();
+			tcoords += chunks[i].TCoords.size();
+		}
+		vertexBuffer.reallocate(positions);
+		normalsBuffer.reallocate(normals);
+		textureCoordBuffer.reallocate(tcoords);
+		for (u32 i=0; i<chunkCount; ++i)
+		{
+			const SVertexChunk& chunk = chunks[i];
+			for (u32 k=0; k<chunk.Positions.size(); ++k)
+				vertexBuffer.push_back(chunk.Positions[k]);
+			for (u32 k=0; k<chunk.Normals.size(); ++k)
+				normalsBuffer.push_back(chunk.Normals[k]);
+			for (u32 k=0; k<chunk.TCoords.size(); ++k)
+				textureCoordBuffer.push_back(chunk.TCoords[k]);
+		}
+	}
+
 	while(bufPtr != bufEnd)
 	{
 		switch(bufPtr[0])
@@ -127,27 +203,33 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 			switch(bufPtr[1])
 			{
 			case ' ':          // vertex
+				if (!vertexDataRead)
 				{
 					core::vector3df vec;
 					bufPtr = readVec3(bufPtr, vec, bufEnd);
 					vertexBuffer.push_back(vec);
 				}
+				++vertexCount;
 				break;
 
 			case 'n':       // normal
+				if (!vertexDataRead)
 				{
 					core::vector3df vec;
 					bufPtr = readVec3(bufPtr, vec, bufEnd);
 					normalsBuffer.push_back(vec);
 				}
+				++normalsCount;
 				break;
 
 			case 't':       // texcoord
+				if (!vertexDataRead)
 				{
 					core::vector2df vec;
 					bufPtr = readUV(bufPtr, vec, bufEnd);
 					textureCoordBuffer.push_back(vec);
 				}
+				++textureCoordCount;
 				break;
 			}
 			break;
@@ -234,8 +316,8 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 				// read in next vertex's data
 				u32 wlength = copyWord(vertexWord, linePtr, WORD_BUFFER_LENGTH, endPtr);
 				// this function will also convert obj's 1-based index to c++'s 0-based index
-				retrieveVertexIndices(vertexWord, Idx, vertexWord+wlength+1, vertexBuffer.size(), textureCoordBuffer.size(), normalsBuffer.size());
-				if ( -1 != Idx[0] && Idx[0] < (irr::s32)vertexBuffer.size() )
+				retrieveVertexIndices(vertexWord, Idx, vertexWord+wlength+1, vertexCount, textureCoordCount, normalsCount);
+				if ( -1 != Idx[0] && Idx[0] < (irr::s32)vertexCount )
 					v.Pos = vertexBuffer[Idx[0]];
 				else
 				{
@@ -243,30 +325,28 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 					delete [] buf;
 					return 0;
 				}
-				if ( -1 != Idx[1] && Idx[1] < (irr::s32)textureCoordBuffer.size() )
+				if ( -1 != Idx[1] && Idx[1] < (irr::s32)textureCoordCount )
 					v.TCoords = textureCoordBuffer[Idx[1]];
 				else
+				{
 					v.TCoords.set(0.0f,0.0f);
-				if ( -1 != Idx[2] && Idx[2] < (irr::s32)normalsBuffer.size() )
+					Idx[1] = -1;
+				}
+				if ( -1 != Idx[2] && Idx[2] < (irr::s32)normalsCount )
 					v.Normal = normalsBuffer[Idx[2]];
 				else
 				{
 					v.Normal.set(0.0f,0.0f,0.0f);
 					currMtl->RecalculateNormals=true;
+					Idx[2] = -1;
 				}
 
-				int vertLocation;
-				core::map<video::S3DVertex, int>::Node* n = currMtl->VertMap.find(v);
-				if (n)
-				{
-					vertLocation = n->getValue();
-				}
-				else
-				{
+				// Vertex color only depends on the material, so corners with the
+				// same indices always result in the same vertex.
+				const s32 newLocation = currMtl->Meshbuffer->Vertices.size();
+				const s32 vertLocation = currMtl->VertMap.insert(Idx, newLocation);
+				if (vertLocation == newLocation)
 					currMtl->Meshbuffer->Vertices.push_back(v);
-					vertLocation = currMtl->Meshbuffer->Vertices.size() -1;
-					currMtl->VertMap.insert(v, vertLocation);
-				}
 
 				faceCorners.push_back(vertLocation);
 
@@ -338,6 +418,44 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 }
 
 
+void COBJMeshFileLoader::readVertexChunk(SVertexChunk& chunk, const c8* const bufEnd)
+{
+	// Same line handling as in createMesh, so both passes see the same lines
+	const c8* bufPtr = goFirstWord(chunk.Begin, bufEnd);
+	while (bufPtr < chunk.End)
+	{
+		if (bufPtr[0] == 'v')
+		{
+			switch(bufPtr[1])
+			{
+			case ' ':
+				{
+					core::vector3df vec;
+					bufPtr = readVec3(bufPtr, vec, bufEnd);
+					chunk.Positions.push_back(vec);
+				}
+				break;
+			case 'n':
+				{
+					core::vector3df vec;
+					bufPtr = readVec3(bufPtr, vec, bufEnd);
+					chunk.Normals.push_back(vec);
+				}
+				break;
+			case 't':
+				{
+					core::vector2df vec;
+					bufPtr = readUV(bufPtr, vec, bufEnd);
+					chunk.TCoords.push_back(vec);
+				}
+				break;
+			}
+		}
+		bufPtr = goNextLine(bufPtr, bufEnd);
+	}
+}
+
+
 const c8* COBJMeshFileLoader::readTextures(const c8* bufPtr, const c8* const bufEnd, SObjMtl* currMaterial, const io::path& relPath)
 {
 	u8 type=0; // map_Kd - diffuse color texture map
@@ -936,6 +1054,55 @@ bool COBJMeshFileLoader::retrieveVertexIndices(c8* vertexData, s32* idx, const c
 }
 
 
+s32 COBJMeshFileLoader::CVertexIndexMap::insert(const s32* idx, s32 newVertex)
+{
+	// keep load factor below 1/2
+	if ((Used+1)*2 > Table.size())
+		rehash(core::max_(Table.size()*2, (u32)256));
+
+	u32 hash = (u32)idx[0]*73856093u ^ (u32)idx[1]*19349663u ^ (u32)idx[2]*83492791u;
+	hash ^= hash >> 16;
+	const u32 mask = Table.size()-1;
+	for (u32 slot = hash & mask; ; slot = (slot+1) & mask)
+	{
+		SEntry& entry = Table[slot];
+		if (entry.Vertex == -1)
+		{
+			entry.Idx[0] = idx[0];
+			entry.Idx[1] = idx[1];
+			entry.Idx[2] = idx[2];
+			entry.Vertex = newVertex;
+			++Used;
+			return newVertex;
+		}
+		if (entry.Idx[0] == idx[0] && entry.Idx[1] == idx[1] && entry.Idx[2] == idx[2])
+			return entry.Vertex;
+	}
+}
+
+
+void COBJMeshFileLoader::CVertexIndexMap::rehash(u32 size)
+{
+	core::array<SEntry> old;
+	old.swap(Table);
+
+	SEntry empty;
+	empty.Idx[0] = empty.Idx[1] = empty.Idx[2] = -1;
+	empty.Vertex = -1;
+	Table.set_used(0);
+	Table.reallocate(size);
+	for (u32 i=0; i<size; ++i)
+		Table.push_back(empty);
+
+	Used = 0;
+	for (u32 i=0; i<old.size(); ++i)
+	{
+		if (old[i].Vertex != -1)
+			insert(old[i].Idx, old[i].Vertex);
+	}
+}
+
+
 void COBJMeshFileLoader::cleanUp()
 {
 	for (u32 i=0; i < Materials.size(); ++i )
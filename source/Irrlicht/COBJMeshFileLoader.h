@@ -10,7 +10,6 @@
 #include "ISceneManager.h"
 #include "irrString.h"
 #include "SMeshBuffer.h"
-#include "irrMap.h"
 
 namespace irr
 {
@@ -40,6 +39,30 @@ public:
 
 private:
 
+	//! Maps the obj indices of a face corner (position, texcoord, normal) to a meshbuffer vertex
+	/** Open addressing hash with linear probing. */
+	class CVertexIndexMap
+	{
+	public:
+		CVertexIndexMap() : Used(0) {}
+
+		//! returns the vertex of the corner, or adds newVertex if the corner is not yet known
+		s32 insert(const s32* idx, s32 newVertex);
+
+	private:
+		struct SEntry
+		{
+			s32 Idx[3];
+			s32 Vertex; // -1 for unused entries
+		};
+
+		// resize table to given size, which has to be a power of 2
+		void rehash(u32 size);
+
+		core::array<SEntry> Table;
+		u32 Used;
+	};
+
 	struct SObjMtl
 	{
 		SObjMtl() : Meshbuffer(0), Bumpiness (1.0f), Illumination(0),
@@ -61,7 +84,7 @@ private:
 			Meshbuffer->Material = o.Meshbuffer->Material;
 		}
 
-		core::map<video::S3DVertex, int> VertMap;
+		CVertexIndexMap VertMap;
 		scene::SMeshBuffer *Meshbuffer;
 		core::stringc Name;
 		core::stringc Group;
@@ -70,6 +93,20 @@ private:
 		bool RecalculateNormals;
 	};
 
+	//! Vertex data of a line-aligned part of the file, read by the first pass of parallel loading
+	struct SVertexChunk
+	{
+		const c8* Begin;
+		const c8* End;
+		core::array<core::vector3df, core::irrAllocatorFast<core::vector3df> > Positions;
+		core::array<core::vector3df, core::irrAllocatorFast<core::vector3df> > Normals;
+		core::array<core::vector2df, core::irrAllocatorFast<core::vector2df> > TCoords;
+	};
+	class CReadVertexChunksJob;
+
+	// reads all v, vn and vt lines of the chunk
+	void readVertexChunk(SVertexChunk& chunk, const c8* const bufEnd);
+
 	// helper method for material reading
 	const c8* readTextures(const c8* bufPtr, const c8* const bufEnd, SObjMtl* currMaterial, const io::path& relPath);
 
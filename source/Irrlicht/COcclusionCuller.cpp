@@ -0,0 +1,427 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "COcclusionCuller.h"
+#include "ISceneNode.h"
+#include "ICameraSceneNode.h"
+#include "IMesh.h"
+#include "IMeshBuffer.h"
+#include "SViewFrustum.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! Width of the top level of the depth buffer, the height follows the aspect ratio of the camera
+	const u32 OCCLUSION_BUFFER_WIDTH = 256;
+}
+
+
+//! Constructor
+COcclusionCuller::COcclusionCuller()
+	: Valid(false)
+{
+}
+
+
+//! Destructor
+COcclusionCuller::~COcclusionCuller()
+{
+	removeAllOccluders();
+}
+
+
+//! Adds or replaces the occluder mesh of a node
+void COcclusionCuller::addOccluder(ISceneNode* node, const IMesh* mesh)
+{
+	mesh->grab();
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		if (Occluders[i].Node == node)
+		{
+			Occluders[i].Mesh->drop();
+			Occluders[i].Mesh = mesh;
+			return;
+		}
+	}
+
+	node->grab();
+	SOccluder occluder;
+	occluder.Node = node;
+	occluder.Mesh = mesh;
+	Occluders.push_back(occluder);
+}
+
+
+//! Removes the occluder of a node
+void COcclusionCuller::removeOccluder(ISceneNode* node)
+{
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		if (Occluders[i].Node == node)
+		{
+			Occluders[i].Mesh->drop();
+			Occluders[i].Node->drop();
+			Occluders.erase(i);
+			return;
+		}
+	}
+}
+
+
+//! Removes all occluders
+void COcclusionCuller::removeAllOccluders()
+{
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		Occluders[i].Mesh->drop();
+		Occluders[i].Node->drop();
+	}
+	Occluders.clear();
+	Valid = false;
+}
+
+
+//! Draws all visible occluders as seen by the camera
+void COcclusionCuller::render(const ICameraSceneNode* camera, const ISceneNode* root)
+{
+	Valid = false;
+
+	// nodes removed from the scene are only kept alive by the grab of the culler
+	for (u32 i=0; i<Occluders.size();)
+	{
+		const ISceneNode* node = Occluders[i].Node;
+		while (node && node != root)
+			node = node->getParent();
+		if (!node)
+		{
+			Occluders[i].Mesh->drop();
+			Occluders[i].Node->drop();
+			Occluders.erase(i);
+		}
+		else
+			++i;
+	}
+
+	if (!camera || Occluders.empty())
+		return;
+
+	ViewProjection = camera->getProjectionMatrix() * camera->getViewMatrix();
+	NearPlane = camera->getViewFrustum()->planes[SViewFrustum::VF_NEAR_PLANE];
+
+	// level sizes
+	const f32 aspect = camera->getAspectRatio();
+	LevelSize[0].Width = OCCLUSION_BUFFER_WIDTH;
+	LevelSize[0].Height = core::s32_clamp(core::round32(OCCLUSION_BUFFER_WIDTH / (aspect > 0.f ? aspect : 1.f)),
+		16, OCCLUSION_BUFFER_WIDTH*2);
+	for (u32 i=1; i<LEVEL_COUNT; ++i)
+	{
+		LevelSize[i].Width = (LevelSize[i-1].Width + 1) / 2;
+		LevelSize[i].Height = (LevelSize[i-1].Height + 1) / 2;
+	}
+
+	const u32 size = LevelSize[0].getArea();
+	Levels[0].set_used(size);
+	f32* depth = Levels[0].pointer();
+	for (u32 i=0; i<size; ++i)
+		depth[i] = FLT_MAX;
+
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		if (Occluders[i].Node->isTrulyVisible())
+			drawMesh(Occluders[i].Mesh, Occluders[i].Node->getAbsoluteTransformation());
+	}
+
+	buildLevels();
+	Valid = true;
+}
+
+
+//! Returns true if the box is completely hidden by the occluders
+bool COcclusionCuller::isOccluded(const core::aabbox3df& box, const core::matrix4& transformation) const
+{
+	if (!Valid)
+		return false;
+
+	// screen rectangle and nearest depth of the box
+	core::vector3df edges[8];
+	box.getEdges(edges);
+
+	f32 minX = FLT_MAX;
+	f32 minY = FLT_MAX;
+	f32 maxX = -FLT_MAX;
+	f32 maxY = -FLT_MAX;
+	f32 nearest = FLT_MAX;
+	for (u32 i=0; i<8; ++i)
+	{
+		core::vector3df point;
+		transformation.transformVect(point, edges[i]);
+
+		// boxes reaching in front of the near plane are never hidden
+		if (NearPlane.Normal.dotProduct(point) + NearPlane.D > 0.f)
+			return false;
+
+		SVertex v;
+		project(point, v);
+		minX = core::min_(minX, v.X);
+		minY = core::min_(minY, v.Y);
+		maxX = core::max_(maxX, v.X);
+		maxY = core::max_(maxY, v.Y);
+		nearest = core::min_(nearest, v.Z);
+	}
+
+	const s32 width = (s32)LevelSize[0].Width;
+	const s32 height = (s32)LevelSize[0].Height;
+	if (maxX < 0.f || maxY < 0.f || minX >= (f32)width || minY >= (f32)height)
+		return false;
+
+	const s32 x0 = core::s32_max(core::floor32(minX), 0);
+	const s32 y0 = core::s32_max(core::floor32(minY), 0);
+	const s32 x1 = core::s32_min(core::floor32(maxX), width - 1);
+	const s32 y1 = core::s32_min(core::floor32(maxY), height - 1);
+
+	// use the level where the box covers at most 4x4 texels
+	u32 level = 0;
+	while (level + 1 < LEVEL_COUNT && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3))
+		++level;
+
+	const f32* depth = Levels[level].const_pointer();
+	const u32 pitch = LevelSize[level].Width;
+	for (s32 y = y0 >> level; y <= (y1 >> level); ++y)
+	{
+		for (s32 x = x0 >> level; x <= (x1 >> level); ++x)
+		{
+			if (depth[y*pitch + x] >= nearest)
+				return false;
+		}
+	}
+	return true;
+}
+
+
+//! Draws all triangles of the mesh
+void COcclusionCuller::drawMesh(const IMesh* mesh, const core::matrix4& transformation)
+{
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		if (mb->getPrimitiveType() != EPT_TRIANGLES)
+			continue;
+
+		// transform and project each vertex only once
+		const u32 vertexCount = mb->getVertexCount();
+		WorldPositions.set_used(vertexCount);
+		NearDistances.set_used(vertexCount);
+		Projected.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			transformation.transformVect(WorldPositions[i], mb->getPosition(i));
+			NearDistances[i] = NearPlane.Normal.dotProduct(WorldPositions[i]) + NearPlane.D;
+			if (NearDistances[i] <= 0.f)
+				project(WorldPositions[i], Projected[i]);
+		}
+
+		const u16* indices16 = mb->getIndexType() == video::EIT_16BIT ? mb->getIndices() : 0;
+		const u32* indices32 = indices16 ? 0 : (const u32*)mb->getIndices();
+		const u32 indexCount = mb->getIndexCount();
+		for (u32 i=0; i+2<indexCount; i+=3)
+		{
+			u32 index[3];
+			for (u32 k=0; k<3; ++k)
+				index[k] = indices16 ? indices16[i+k] : indices32[i+k];
+
+			const f32 distances[3] = { NearDistances[index[0]], NearDistances[index[1]], NearDistances[index[2]] };
+			if (distances[0] <= 0.f && distances[1] <= 0.f && distances[2] <= 0.f)
+			{
+				drawTriangle(Projected[index[0]], Projected[index[1]], Projected[index[2]]);
+			}
+			else if (distances[0] <= 0.f || distances[1] <= 0.f || distances[2] <= 0.f)
+			{
+				const core::vector3df points[3] = { WorldPositions[index[0]], WorldPositions[index[1]], WorldPositions[index[2]] };
+				drawClippedTriangle(points, distances);
+			}
+		}
+	}
+}
+
+
+//! Clips a triangle given in world space against the near plane and draws it
+void COcclusionCuller::drawClippedTriangle(const core::vector3df* points, const f32* distances)
+{
+	core::vector3df clipped[4];
+	u32 count = 0;
+	for (u32 i=0; i<3; ++i)
+	{
+		const u32 j = (i == 2) ? 0 : i + 1;
+		if (distances[i] <= 0.f)
+			clipped[count++] = points[i];
+		if ((distances[i] <= 0.f) != (distances[j] <= 0.f))
+		{
+			const f32 t = distances[i] / (distances[i] - distances[j]);
+			clipped[count++] = points[i] + (points[j] - points[i]) * t;
+		}
+	}
+	if (count < 3)
+		return;
+
+	SVertex v[4];
+	for (u32 i=0; i<count; ++i)
+		project(clipped[i], v[i]);
+
+	drawTriangle(v[0], v[1], v[2]);
+	if (count == 4)
+		drawTriangle(v[0], v[2], v[3]);
+}
+
+
+//! Draws a triangle into the top level of the depth buffer
+/** Pixels are covered when their center lies inside the triangle. With SSE2
+four pixels of a span are tested and written at once. */
+void COcclusionCuller::drawTriangle(const SVertex& a, SVertex b, SVertex c)
+{
+	f32 area = (b.X - a.X) * (c.Y - a.Y) - (b.Y - a.Y) * (c.X - a.X);
+	if (area == 0.f)
+		return;
+	if (area < 0.f)
+	{
+		core::swap(b, c);
+		area = -area;
+	}
+
+	const s32 width = (s32)LevelSize[0].Width;
+	const s32 height = (s32)LevelSize[0].Height;
+	const s32 x0 = core::s32_max(core::floor32(core::min_(a.X, b.X, c.X)), 0);
+	const s32 y0 = core::s32_max(core::floor32(core::min_(a.Y, b.Y, c.Y)), 0);
+	const s32 x1 = core::s32_min(core::floor32(core::max_(a.X, b.X, c.X)), width - 1);
+	const s32 y1 = core::s32_min(core::floor32(core::max_(a.Y, b.Y, c.Y)), height - 1);
+	if (x0 > x1 || y0 > y1)
+		return;
+
+	// depth is linear in screen space
+	const f32 invArea = core::reciprocal(area);
+	const f32 dzdx = ((b.Z - a.Z) * (c.Y - a.Y) - (c.Z - a.Z) * (b.Y - a.Y)) * invArea;
+	const f32 dzdy = ((b.X - a.X) * (c.Z - a.Z) - (c.X - a.X) * (b.Z - a.Z)) * invArea;
+
+	// edge functions at the center of the first pixel, positive inside
+	const f32 px = (f32)x0 + 0.5f;
+	const f32 step0 = b.Y - a.Y;
+	const f32 step1 = c.Y - b.Y;
+	const f32 step2 = a.Y - c.Y;
+	f32 py = (f32)y0 + 0.5f;
+	f32* row = Levels[0].pointer() + y0 * width;
+	for (s32 y=y0; y<=y1; ++y, py+=1.f, row+=width)
+	{
+		f32 e0 = (b.X - a.X) * (py - a.Y) - step0 * (px - a.X);
+		f32 e1 = (c.X - b.X) * (py - b.Y) - step1 * (px - b.X);
+		f32 e2 = (a.X - c.X) * (py - c.Y) - step2 * (px - c.X);
+		f32 z = a.Z + dzdx * (px - a.X) + dzdy * (py - a.Y);
+		s32 x = x0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		// four pixels at once, the rest of the span is done below
+		if (x + 3 <= x1)
+		{
+			const __m128 lanes = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+			const __m128 zero = _mm_setzero_ps();
+			__m128 e0v = _mm_sub_ps(_mm_set1_ps(e0), _mm_mul_ps(lanes, _mm_set1_ps(step0)));
+			__m128 e1v = _mm_sub_ps(_mm_set1_ps(e1), _mm_mul_ps(lanes, _mm_set1_ps(step1)));
+			__m128 e2v = _mm_sub_ps(_mm_set1_ps(e2), _mm_mul_ps(lanes, _mm_set1_ps(step2)));
+			__m128 zv = _mm_add_ps(_mm_set1_ps(z), _mm_mul_ps(lanes, _mm_set1_ps(dzdx)));
+			const __m128 step0v = _mm_set1_ps(step0 * 4.f);
+			const __m128 step1v = _mm_set1_ps(step1 * 4.f);
+			const __m128 step2v = _mm_set1_ps(step2 * 4.f);
+			const __m128 dzdxv = _mm_set1_ps(dzdx * 4.f);
+			for (; x + 3 <= x1; x += 4)
+			{
+				const __m128 depth = _mm_loadu_ps(row + x);
+				const __m128 write = _mm_and_ps(
+					_mm_and_ps(_mm_cmpge_ps(e0v, zero), _mm_cmpge_ps(e1v, zero)),
+					_mm_and_ps(_mm_cmpge_ps(e2v, zero), _mm_cmplt_ps(zv, depth)));
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(write, zv), _mm_andnot_ps(write, depth)));
+				e0v = _mm_sub_ps(e0v, step0v);
+				e1v = _mm_sub_ps(e1v, step1v);
+				e2v = _mm_sub_ps(e2v, step2v);
+				zv = _mm_add_ps(zv, dzdxv);
+			}
+			e0 = _mm_cvtss_f32(e0v);
+			e1 = _mm_cvtss_f32(e1v);
+			e2 = _mm_cvtss_f32(e2v);
+			z = _mm_cvtss_f32(zv);
+		}
+#endif
+		for (; x<=x1; ++x)
+		{
+			if (e0 >= 0.f && e1 >= 0.f && e2 >= 0.f && z < row[x])
+				row[x] = z;
+			e0 -= step0;
+			e1 -= step1;
+			e2 -= step2;
+			z += dzdx;
+		}
+	}
+}
+
+
+//! Projects a point in front of the near plane into the depth buffer
+void COcclusionCuller::project(const core::vector3df& point, SVertex& out) const
+{
+	f32 clip[4];
+	ViewProjection.transformVect(clip, point);
+	const f32 invW = core::reciprocal(core::max_(clip[3], 0.000001f));
+	out.X = (clip[0] * invW + 1.f) * 0.5f * (f32)LevelSize[0].Width;
+	out.Y = (1.f - clip[1] * invW) * 0.5f * (f32)LevelSize[0].Height;
+	out.Z = clip[2] * invW;
+}
+
+
+//! Creates the coarser levels of the depth buffer
+/** Each texel keeps the farthest depth of the 2x2 texels it covers in the level before. */
+void COcclusionCuller::buildLevels()
+{
+	for (u32 level=1; level<LEVEL_COUNT; ++level)
+	{
+		const core::dimension2du& sourceSize = LevelSize[level-1];
+		const core::dimension2du& size = LevelSize[level];
+		Levels[level].set_used(size.getArea());
+
+		const f32* source = Levels[level-1].const_pointer();
+		f32* target = Levels[level].pointer();
+		for (u32 y=0; y<size.Height; ++y)
+		{
+			const u32 sy0 = y*2;
+			const u32 sy1 = core::min_(sy0 + 1, sourceSize.Height - 1);
+			u32 x = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			// four texels from eight source columns, as long as no column has to be clamped
+			const f32* row0 = source + sy0*sourceSize.Width;
+			const f32* row1 = source + sy1*sourceSize.Width;
+			for (; x*2 + 8 <= sourceSize.Width && x + 4 <= size.Width; x += 4)
+			{
+				const __m128 lo = _mm_max_ps(_mm_loadu_ps(row0 + x*2), _mm_loadu_ps(row1 + x*2));
+				const __m128 hi = _mm_max_ps(_mm_loadu_ps(row0 + x*2 + 4), _mm_loadu_ps(row1 + x*2 + 4));
+				_mm_storeu_ps(target + y*size.Width + x, _mm_max_ps(
+					_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)),
+					_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))));
+			}
+#endif
+			for (; x<size.Width; ++x)
+			{
+				const u32 sx0 = x*2;
+				const u32 sx1 = core::min_(sx0 + 1, sourceSize.Width - 1);
+				target[y*size.Width + x] = core::max_(
+					core::max_(source[sy0*sourceSize.Width + sx0], source[sy0*sourceSize.Width + sx1]),
+					core::max_(source[sy1*sourceSize.Width + sx0], source[sy1*sourceSize.Width + sx1]));
+			}
+		}
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,115 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_OCCLUSION_CULLER_H_INCLUDED__
+#define __C_OCCLUSION_CULLER_H_INCLUDED__
+
+#include "irrArray.h"
+#include "matrix4.h"
+#include "plane3d.h"
+#include "aabbox3d.h"
+#include "dimension2d.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class ISceneNode;
+class IMesh;
+class ICameraSceneNode;
+
+//! Culls scene nodes hidden behind occluder meshes on the CPU
+/** The occluders are drawn into a small depth buffer as seen by the camera.
+Coarser levels of the buffer keep the farthest depth of the pixels they cover,
+so a box only has to be compared against a few texels of the level which
+matches the size of the box on the screen. */
+class COcclusionCuller
+{
+public:
+
+	//! Constructor
+	COcclusionCuller();
+
+	//! Destructor
+	~COcclusionCuller();
+
+	//! Adds or replaces the occluder mesh of a node
+	void addOccluder(ISceneNode* node, const IMesh* mesh);
+
+	//! Removes the occluder of a node
+	void removeOccluder(ISceneNode* node);
+
+	//! Removes all occluders
+	void removeAllOccluders();
+
+	//! Returns true if there are occluders
+	bool hasOccluders() const { return !Occluders.empty(); }
+
+	//! Draws all visible occluders as seen by the camera
+	/** Occluders whose node is no longer attached below root are removed. */
+	void render(const ICameraSceneNode* camera, const ISceneNode* root);
+
+	//! Forgets the depth buffer, nothing is occluded until the next render
+	void clear() { Valid = false; }
+
+	//! Returns true if the box is completely hidden by the occluders
+	/** \param box Box in the space of transformation.
+	\param transformation Absolute transformation of the box. */
+	bool isOccluded(const core::aabbox3df& box, const core::matrix4& transformation) const;
+
+private:
+
+	//! Number of levels in the depth buffer, each half the size of the one before
+	enum { LEVEL_COUNT = 6 };
+
+	//! Vertex in pixel coordinates with depth
+	struct SVertex
+	{
+		f32 X;
+		f32 Y;
+		f32 Z;
+	};
+
+	struct SOccluder
+	{
+		ISceneNode* Node;
+		const IMesh* Mesh;
+	};
+
+	//! Draws all triangles of the mesh
+	void drawMesh(const IMesh* mesh, const core::matrix4& transformation);
+
+	//! Clips a triangle given in world space against the near plane and draws it
+	void drawClippedTriangle(const core::vector3df* points, const f32* distances);
+
+	//! Draws a triangle into the top level of the depth buffer
+	void drawTriangle(const SVertex& a, SVertex b, SVertex c);
+
+	//! Projects a point in front of the near plane into the depth buffer
+	void project(const core::vector3df& point, SVertex& out) const;
+
+	//! Creates the coarser levels of the depth buffer
+	void buildLevels();
+
+	core::array<SOccluder> Occluders;
+
+	core::matrix4 ViewProjection;
+	core::plane3df NearPlane;
+
+	core::array<f32> Levels[LEVEL_COUNT];
+	core::dimension2du LevelSize[LEVEL_COUNT];
+
+	//! vertices of the mesh buffer being drawn
+	core::array<core::vector3df> WorldPositions;
+	core::array<f32> NearDistances;
+	core::array<SVertex> Projected;
+
+	bool Valid;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -96,30 +96,61 @@ void COctreeSceneNode::OnRegisterSceneNode()
 	}
 }
 
+//! Copies the visible index ranges of a chunk into its visible indices
+/** Only done when the ranges changed, returns true in that case. */
+template <class VT>
+bool updateVisibleIndices(typename Octree<VT>::SMeshChunk& meshChunk, const typename Octree<VT>::SIndexData& indexData)
+{
+	if (meshChunk.VisibleRevision == indexData.Revision)
+		return false;
+
+	meshChunk.VisibleRevision = indexData.Revision;
+	meshChunk.VisibleIndices.set_used(indexData.CurrentSize);
+	u16* dst = meshChunk.VisibleIndices.pointer();
+	for (u32 r=0; r<indexData.Ranges.size(); ++r)
+	{
+		memcpy(dst, meshChunk.Indices.const_pointer() + indexData.Ranges[r].Offset,
+			indexData.Ranges[r].Count * sizeof(u16));
+		dst += indexData.Ranges[r].Count;
+	}
+	return true;
+}
+
 template <class VT>
 void renderMeshBuffer(video::IVideoDriver* driver, EOCTREENODE_VBO useVBO, typename Octree<VT>::SMeshChunk& meshChunk, const typename Octree<VT>::SIndexData& indexData)
 {
 	switch ( useVBO )
 	{
 		case EOV_NO_VBO:
-			driver->drawIndexedTriangleList(
-				&meshChunk.Vertices[0],
-				meshChunk.Vertices.size(),
-				indexData.Indices, indexData.CurrentSize / 3);
-				break;
+			// a single range is drawn from the indices of the chunk directly
+			if (indexData.Ranges.size() == 1)
+			{
+				driver->drawIndexedTriangleList(
+					&meshChunk.Vertices[0],
+					meshChunk.Vertices.size(),
+					meshChunk.Indices.const_pointer() + indexData.Ranges[0].Offset,
+					indexData.Ranges[0].Count / 3);
+			}
+			else
+			{
+				updateVisibleIndices<VT>(meshChunk, indexData);
+				driver->drawIndexedTriangleList(
+					&meshChunk.Vertices[0],
+					meshChunk.Vertices.size(),
+					meshChunk.VisibleIndices.const_pointer(), indexData.CurrentSize / 3);
+			}
+			break;
 		case EOV_USE_VBO:
 			driver->drawMeshBuffer ( &meshChunk );
 			break;
 		case EOV_USE_VBO_WITH_VISIBITLY:
 		{
-			u16* oldPointer = meshChunk.Indices.pointer();
-			const u32 oldSize = meshChunk.Indices.size();
-			meshChunk.Indices.set_free_when_destroyed(false);
-			meshChunk.Indices.set_pointer(indexData.Indices, indexData.CurrentSize, false, false);
-			meshChunk.setDirty(scene::EBT_INDEX);
+			// the index buffer is only updated when the visible ranges changed
+			if (updateVisibleIndices<VT>(meshChunk, indexData))
+				meshChunk.setDirty(scene::EBT_INDEX);
+			meshChunk.Indices.swap(meshChunk.VisibleIndices);
 			driver->drawMeshBuffer ( &meshChunk );
-			meshChunk.Indices.set_pointer(oldPointer, oldSize);
-			meshChunk.setDirty(scene::EBT_INDEX);
+			meshChunk.Indices.swap(meshChunk.VisibleIndices);
 			break;
 		}
 	}
@@ -360,8 +391,150 @@ const core::aabbox3d<f32>& COctreeSceneNode::getBoundingBox() const
 }
 
 
+//! Converts a vertex of a mesh buffer to the vertex type of the octree
+static void getVertex(const IMeshBuffer* b, u32 v, video::S3DVertex& out)
+{
+	switch (b->getVertexType())
+	{
+	case video::EVT_STANDARD:
+		out = ((video::S3DVertex*)b->getVertices())[v];
+		break;
+	case video::EVT_2TCOORDS:
+		out = ((video::S3DVertex2TCoords*)b->getVertices())[v];
+		break;
+	case video::EVT_TANGENTS:
+		out = ((video::S3DVertexTangents*)b->getVertices())[v];
+		break;
+	}
+}
+
+static void getVertex(const IMeshBuffer* b, u32 v, video::S3DVertex2TCoords& out)
+{
+	switch (b->getVertexType())
+	{
+	case video::EVT_STANDARD:
+		out = ((video::S3DVertex*)b->getVertices())[v];
+		break;
+	case video::EVT_2TCOORDS:
+		out = ((video::S3DVertex2TCoords*)b->getVertices())[v];
+		break;
+	case video::EVT_TANGENTS:
+		out = ((video::S3DVertexTangents*)b->getVertices())[v];
+		break;
+	}
+}
+
+static void getVertex(const IMeshBuffer* b, u32 v, video::S3DVertexTangents& out)
+{
+	switch (b->getVertexType())
+	{
+	case video::EVT_STANDARD:
+		{
+			const video::S3DVertex& tmpV = ((video::S3DVertex*)b->getVertices())[v];
+			out = video::S3DVertexTangents(tmpV.Pos, tmpV.Color, tmpV.TCoords);
+		}
+		break;
+	case video::EVT_2TCOORDS:
+		{
+			const video::S3DVertex2TCoords& tmpV = ((video::S3DVertex2TCoords*)b->getVertices())[v];
+			out = video::S3DVertexTangents(tmpV.Pos, tmpV.Color, tmpV.TCoords);
+		}
+		break;
+	case video::EVT_TANGENTS:
+		out = ((video::S3DVertexTangents*)b->getVertices())[v];
+		break;
+	}
+}
+
+//! Adds an empty chunk with the material of a mesh buffer
+template <class VT>
+typename Octree<VT>::SMeshChunk& addMeshChunk(const IMeshBuffer* b, core::array<typename Octree<VT>::SMeshChunk>& meshes,
+	core::array<video::SMaterial>& materials, EOCTREENODE_VBO useVBO)
+{
+	materials.push_back(b->getMaterial());
+	meshes.push_back(typename Octree<VT>::SMeshChunk());
+	typename Octree<VT>::SMeshChunk& chunk = meshes.getLast();
+	chunk.MaterialId = materials.size() - 1;
+
+	if (useVBO == EOV_USE_VBO_WITH_VISIBITLY)
+	{
+		chunk.setHardwareMappingHint(scene::EHM_STATIC, scene::EBT_VERTEX);
+		chunk.setHardwareMappingHint(scene::EHM_DYNAMIC, scene::EBT_INDEX);
+	}
+	else
+		chunk.setHardwareMappingHint(scene::EHM_STATIC);
+
+	return chunk;
+}
+
+//! Adds the chunks of a mesh buffer to the meshes of an octree
+/** The chunks have 16 bit indices, so buffers with 32 bit indices and more
+vertices are split into several chunks with the same material. */
+template <class VT>
+void addMeshChunks(const IMeshBuffer* b, core::array<typename Octree<VT>::SMeshChunk>& meshes,
+	core::array<video::SMaterial>& materials, EOCTREENODE_VBO useVBO)
+{
+	const u32 maxVertices = 0x10000;
+	const u32 vertexCount = b->getVertexCount();
+	const u32 indexCount = b->getIndexCount();
+	const u16* indices16 = b->getIndices();
+	const u32* indices32 = (const u32*)b->getIndices();
+	const bool is32Bit = b->getIndexType() == video::EIT_32BIT;
+	VT vertex;
+	u32 v;
+
+	if (vertexCount <= maxVertices)
+	{
+		typename Octree<VT>::SMeshChunk& chunk = addMeshChunk<VT>(b, meshes, materials, useVBO);
+
+		chunk.Vertices.reallocate(vertexCount);
+		for (v=0; v<vertexCount; ++v)
+		{
+			getVertex(b, v, vertex);
+			chunk.Vertices.push_back(vertex);
+		}
+
+		chunk.Indices.reallocate(indexCount);
+		for (v=0; v<indexCount; ++v)
+			chunk.Indices.push_back((u16)(is32Bit ? indices32[v] : indices16[v]));
+		return;
+	}
+
+	// index of each vertex in the current chunk, -1 if it is not in there
+	core::array<s32> remap;
+	remap.set_used(vertexCount);
+	for (v=0; v<vertexCount; ++v)
+		remap[v] = -1;
+	core::array<u32> used;
+
+	typename Octree<VT>::SMeshChunk* chunk = 0;
+	for (u32 i=0; i+2<indexCount; i+=3)
+	{
+		if (!chunk || chunk->Vertices.size() + 3 > maxVertices)
+		{
+			for (v=0; v<used.size(); ++v)
+				remap[used[v]] = -1;
+			used.set_used(0);
+			chunk = &addMeshChunk<VT>(b, meshes, materials, useVBO);
+		}
+
+		for (u32 k=0; k<3; ++k)
+		{
+			const u32 index = is32Bit ? indices32[i+k] : indices16[i+k];
+			if (remap[index] == -1)
+			{
+				remap[index] = chunk->Vertices.size();
+				used.push_back(index);
+				getVertex(b, index, vertex);
+				chunk->Vertices.push_back(vertex);
+			}
+			chunk->Indices.push_back((u16)remap[index]);
+		}
+	}
+}
+
 //! creates the tree
-/* This method has a lot of duplication and overhead. Moreover, the tangents mesh conversion does not really work. I think we need a a proper mesh implementation for octrees, which handle all vertex types internally. Converting all structures to just one vertex type is always problematic.
+/* The tangents mesh conversion does not really work. I think we need a a proper mesh implementation for octrees, which handle all vertex types internally. Converting all structures to just one vertex type is always problematic.
 Thanks to Auria for fixing major parts of this method. */
 bool COctreeSceneNode::createTree(IMesh* mesh)
 {
@@ -409,151 +582,49 @@ bool COctreeSceneNode::createTree(IMesh* mesh)
 		switch(VertexType)
 		{
 		case video::EVT_STANDARD:
+			StdMeshes.reallocate(StdMeshes.size() + meshReserve);
+			for (i=0; i<mesh->getMeshBufferCount(); ++i)
 			{
-				StdMeshes.reallocate(StdMeshes.size() + meshReserve);
-				for (i=0; i<mesh->getMeshBufferCount(); ++i)
+				IMeshBuffer* b = mesh->getMeshBuffer(i);
+				if (b->getVertexCount() && b->getIndexCount())
 				{
-					IMeshBuffer* b = mesh->getMeshBuffer(i);
-
-					if (b->getVertexCount() && b->getIndexCount())
-					{
-						Materials.push_back(b->getMaterial());
-
-						StdMeshes.push_back(Octree<video::S3DVertex>::SMeshChunk());
-						Octree<video::S3DVertex>::SMeshChunk &nchunk = StdMeshes.getLast();
-						nchunk.MaterialId = Materials.size() - 1;
-
-						u32 v;
-						nchunk.Vertices.reallocate(b->getVertexCount());
-						switch (b->getVertexType())
-						{
-						case video::EVT_STANDARD:
-							for (v=0; v<b->getVertexCount(); ++v)
-								nchunk.Vertices.push_back(((video::S3DVertex*)b->getVertices())[v]);
-							break;
-						case video::EVT_2TCOORDS:
-							for (v=0; v<b->getVertexCount(); ++v)
-								nchunk.Vertices.push_back(((video::S3DVertex2TCoords*)b->getVertices())[v]);
-							break;
-						case video::EVT_TANGENTS:
-							for (v=0; v<b->getVertexCount(); ++v)
-								nchunk.Vertices.push_back(((video::S3DVertexTangents*)b->getVertices())[v]);
-							break;
-						}
-
-						polyCount += b->getIndexCount();
-
-						nchunk.Indices.reallocate(b->getIndexCount());
-						for (v=0; v<b->getIndexCount(); ++v)
-							nchunk.Indices.push_back(b->getIndices()[v]);
-					}
+					polyCount += b->getIndexCount();
+					addMeshChunks<video::S3DVertex>(b, StdMeshes, Materials, UseVBOs);
 				}
-
-				StdOctree = new Octree<video::S3DVertex>(StdMeshes, MinimalPolysPerNode);
-				nodeCount = StdOctree->getNodeCount();
 			}
+
+			StdOctree = new Octree<video::S3DVertex>(StdMeshes, MinimalPolysPerNode);
+			nodeCount = StdOctree->getNodeCount();
 			break;
 		case video::EVT_2TCOORDS:
+			LightMapMeshes.reallocate(LightMapMeshes.size() + meshReserve);
+			for (i=0; i<mesh->getMeshBufferCount(); ++i)
 			{
-				LightMapMeshes.reallocate(LightMapMeshes.size() + meshReserve);
-
-				for ( i=0; i < mesh->getMeshBufferCount(); ++i)
+				IMeshBuffer* b = mesh->getMeshBuffer(i);
+				if (b->getVertexCount() && b->getIndexCount())
 				{
-					IMeshBuffer* b = mesh->getMeshBuffer(i);
-
-					if (b->getVertexCount() && b->getIndexCount())
-					{
-						Materials.push_back(b->getMaterial());
-						LightMapMeshes.push_back(Octree<video::S3DVertex2TCoords>::SMeshChunk());
-						Octree<video::S3DVertex2TCoords>::SMeshChunk& nchunk = LightMapMeshes.getLast();
-						nchunk.MaterialId = Materials.size() - 1;
-
-						if (UseVBOs == EOV_USE_VBO_WITH_VISIBITLY)
-						{
-							nchunk.setHardwareMappingHint(scene::EHM_STATIC, scene::EBT_VERTEX);
-							nchunk.setHardwareMappingHint(scene::EHM_DYNAMIC, scene::EBT_INDEX);
-						}
-						else
-							nchunk.setHardwareMappingHint(scene::EHM_STATIC);
-
-						u32 v;
-						nchunk.Vertices.reallocate(b->getVertexCount());
-						switch (b->getVertexType())
-						{
-						case video::EVT_STANDARD:
-							for (v=0; v<b->getVertexCount(); ++v)
-								nchunk.Vertices.push_back(((video::S3DVertex*)b->getVertices())[v]);
-							break;
-						case video::EVT_2TCOORDS:
-							for (v=0; v<b->getVertexCount(); ++v)
-								nchunk.Vertices.push_back(((video::S3DVertex2TCoords*)b->getVertices())[v]);
-							break;
-						case video::EVT_TANGENTS:
-							for (v=0; v<b->getVertexCount(); ++v)
-								nchunk.Vertices.push_back(((video::S3DVertexTangents*)b->getVertices())[v]);
-							break;
-						}
-
-						polyCount += b->getIndexCount();
-						nchunk.Indices.reallocate(b->getIndexCount());
-						for (v=0; v<b->getIndexCount(); ++v)
-							nchunk.Indices.push_back(b->getIndices()[v]);
-					}
+					polyCount += b->getIndexCount();
+					addMeshChunks<video::S3DVertex2TCoords>(b, LightMapMeshes, Materials, UseVBOs);
 				}
-
-				LightMapOctree = new Octree<video::S3DVertex2TCoords>(LightMapMeshes, MinimalPolysPerNode);
-				nodeCount = LightMapOctree->getNodeCount();
 			}
+
+			LightMapOctree = new Octree<video::S3DVertex2TCoords>(LightMapMeshes, MinimalPolysPerNode);
+			nodeCount = LightMapOctree->getNodeCount();
 			break;
 		case video::EVT_TANGENTS:
+			TangentsMeshes.reallocate(TangentsMeshes.size() + meshReserve);
+			for (i=0; i<mesh->getMeshBufferCount(); ++i)
 			{
-				TangentsMeshes.reallocate(TangentsMeshes.size() + meshReserve);
-
-				for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+				IMeshBuffer* b = mesh->getMeshBuffer(i);
+				if (b->getVertexCount() && b->getIndexCount())
 				{
-					IMeshBuffer* b = mesh->getMeshBuffer(i);
-
-					if (b->getVertexCount() && b->getIndexCount())
-					{
-						Materials.push_back(b->getMaterial());
-						TangentsMeshes.push_back(Octree<video::S3DVertexTangents>::SMeshChunk());
-						Octree<video::S3DVertexTangents>::SMeshChunk& nchunk = TangentsMeshes.getLast();
-						nchunk.MaterialId = Materials.size() - 1;
-
-						u32 v;
-						nchunk.Vertices.reallocate(b->getVertexCount());
-						switch (b->getVertexType())
-						{
-						case video::EVT_STANDARD:
-							for (v=0; v<b->getVertexCount(); ++v)
-							{
-								const video::S3DVertex& tmpV = ((video::S3DVertex*)b->getVertices())[v];
-								nchunk.Vertices.push_back(video::S3DVertexTangents(tmpV.Pos, tmpV.Color, tmpV.TCoords));
-							}
-							break;
-						case video::EVT_2TCOORDS:
-							for (v=0; v<b->getVertexCount(); ++v)
-							{
-								const video::S3DVertex2TCoords& tmpV = ((video::S3DVertex2TCoords*)b->getVertices())[v];
-								nchunk.Vertices.push_back(video::S3DVertexTangents(tmpV.Pos, tmpV.Color, tmpV.TCoords));
-							}
-							break;
-						case video::EVT_TANGENTS:
-							for (v=0; v<b->getVertexCount(); ++v)
-								nchunk.Vertices.push_back(((video::S3DVertexTangents*)b->getVertices())[v]);
-							break;
-						}
-
-						polyCount += b->getIndexCount();
-						nchunk.Indices.reallocate(b->getIndexCount());
-						for (v=0; v<b->getIndexCount(); ++v)
-							nchunk.Indices.push_back(b->getIndices()[v]);
-					}
+					polyCount += b->getIndexCount();
+					addMeshChunks<video::S3DVertexTangents>(b, TangentsMeshes, Materials, UseVBOs);
 				}
-
-				TangentsOctree = new Octree<video::S3DVertexTangents>(TangentsMeshes, MinimalPolysPerNode);
-				nodeCount = TangentsOctree->getNodeCount();
 			}
+
+			TangentsOctree = new Octree<video::S3DVertexTangents>(TangentsMeshes, MinimalPolysPerNode);
+			nodeCount = TangentsOctree->getNodeCount();
 			break;
 		}
 	}
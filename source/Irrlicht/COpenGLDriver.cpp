@@ -721,110 +721,77 @@ void COpenGLDriver::addOcclusionQuery(scene::ISceneNode* node,
 		return;
 
 	CNullDriver::addOcclusionQuery(node, mesh);
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = findOcclusionQuery(node);
 	if ((index != -1) && (OcclusionQueries[index].UID == 0))
 		extGlGenQueries(1, reinterpret_cast<GLuint*>(&OcclusionQueries[index].UID));
 }
 
 
-//! Remove occlusion query.
-void COpenGLDriver::removeOcclusionQuery(scene::ISceneNode* node)
+//! Deletes the hardware query in the slot
+void COpenGLDriver::removeOcclusionQuerySlot(u32 index)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
-	{
-		if (OcclusionQueries[index].UID != 0)
-			extGlDeleteQueries(1, reinterpret_cast<GLuint*>(&OcclusionQueries[index].UID));
-		CNullDriver::removeOcclusionQuery(node);
-	}
+	if (OcclusionQueries[index].UID != 0)
+		extGlDeleteQueries(1, reinterpret_cast<GLuint*>(&OcclusionQueries[index].UID));
+	CNullDriver::removeOcclusionQuerySlot(index);
 }
 
 
-//! Run occlusion query. Draws mesh stored in query.
-/** If the mesh shall not be rendered visible, use
-overrideMaterial to disable the color and depth buffer. */
-void COpenGLDriver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
+//! Runs the occlusion query in the slot inside a hardware query
+void COpenGLDriver::runOcclusionQuerySlot(u32 index, bool visible)
 {
-	if (!node)
-		return;
-
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
-	{
-		if (OcclusionQueries[index].UID)
-			extGlBeginQuery(
+	if (OcclusionQueries[index].UID)
+		extGlBeginQuery(
 #ifdef GL_ARB_occlusion_query
-				GL_SAMPLES_PASSED_ARB,
+			GL_SAMPLES_PASSED_ARB,
 #else
-				0,
+			0,
 #endif
-				OcclusionQueries[index].UID);
-		CNullDriver::runOcclusionQuery(node,visible);
-		if (OcclusionQueries[index].UID)
-			extGlEndQuery(
+			OcclusionQueries[index].UID);
+	CNullDriver::runOcclusionQuerySlot(index, visible);
+	if (OcclusionQueries[index].UID)
+		extGlEndQuery(
 #ifdef GL_ARB_occlusion_query
-				GL_SAMPLES_PASSED_ARB);
+			GL_SAMPLES_PASSED_ARB);
 #else
-				0);
+			0);
 #endif
-		testGLError(__LINE__);
-	}
+	testGLError(__LINE__);
 }
 
 
-//! Update occlusion query. Retrieves results from GPU.
-/** If the query shall not block, set the flag to false.
-Update might not occur in this case, though */
-void COpenGLDriver::updateOcclusionQuery(scene::ISceneNode* node, bool block)
+//! Retrieves the result of the hardware query in the slot
+void COpenGLDriver::updateOcclusionQuerySlot(u32 index, bool block)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
-	{
-		// not yet started
-		if (OcclusionQueries[index].Run==u32(~0))
-			return;
-		GLint available = block?GL_TRUE:GL_FALSE;
-		if (!block)
-			extGlGetQueryObjectiv(OcclusionQueries[index].UID,
+	// not yet started
+	if (OcclusionQueries[index].Run==u32(~0))
+		return;
+	GLint available = block?GL_TRUE:GL_FALSE;
+	if (!block)
+		extGlGetQueryObjectiv(OcclusionQueries[index].UID,
 #ifdef GL_ARB_occlusion_query
-						GL_QUERY_RESULT_AVAILABLE_ARB,
+					GL_QUERY_RESULT_AVAILABLE_ARB,
 #elif defined(GL_NV_occlusion_query)
-						GL_PIXEL_COUNT_AVAILABLE_NV,
+					GL_PIXEL_COUNT_AVAILABLE_NV,
 #else
-						0,
+					0,
 #endif
-						&available);
-		testGLError(__LINE__);
-		if (available==GL_TRUE)
-		{
-			extGlGetQueryObjectiv(OcclusionQueries[index].UID,
+					&available);
+	testGLError(__LINE__);
+	if (available==GL_TRUE)
+	{
+		extGlGetQueryObjectiv(OcclusionQueries[index].UID,
 #ifdef GL_ARB_occlusion_query
-						GL_QUERY_RESULT_ARB,
+					GL_QUERY_RESULT_ARB,
 #elif defined(GL_NV_occlusion_query)
-						GL_PIXEL_COUNT_NV,
+					GL_PIXEL_COUNT_NV,
 #else
-						0,
+					0,
 #endif
-						&available);
-			if (queryFeature(EVDF_OCCLUSION_QUERY))
-				OcclusionQueries[index].Result = available;
-		}
-		testGLError(__LINE__);
+					&available);
+		if (queryFeature(EVDF_OCCLUSION_QUERY))
+			OcclusionQueries[index].Result = available;
 	}
-}
-
-
-//! Return query result.
-/** Return value is the number of visible pixels/fragments.
-The value is a safe approximation, i.e. can be larger than the
-actual value of pixels. */
-u32 COpenGLDriver::getOcclusionQueryResult(scene::ISceneNode* node) const
-{
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
-	if (index != -1)
-		return OcclusionQueries[index].Result;
-	else
-		return ~0;
+	testGLError(__LINE__);
 }
 
 
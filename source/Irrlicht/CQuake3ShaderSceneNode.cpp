@@ -15,6 +15,141 @@
 #include "SMesh.h"
 #include "IMaterialRenderer.h"
 #include "CShadowVolumeSceneNode.h"
+#include "FastSinCos.h"
+
+namespace
+{
+	using namespace irr;
+	using namespace irr::scene::quake3;
+
+	//! getAsFloat, which stops at the end of the string
+	inline f32 readFloat ( const core::stringc &string, u32 &pos )
+	{
+		return pos < string.size() ? getAsFloat( string, pos ) : 0.f;
+	}
+
+	//! Value of a wave function for x between 0 and 1
+	inline f32 waveValue ( eQ3ModifierFunction func, f32 x )
+	{
+		switch ( func )
+		{
+			case SINUS:
+			case COSINUS:
+			{
+				// quarter turns, and the rest of the turn between -pi/4 and pi/4
+				const s32 j = core::round32( x * 4.f );
+				f32 s, c;
+				core::sinCosQuadrant( ( x - j * 0.25f ) * ( 2.f * core::PI ), func == SINUS ? j : j + 1, s, c );
+				return s;
+			}
+			case SQUARE:
+				return x < 0.5f ? 1.f : -1.f;
+			case TRIANGLE:
+				return x < 0.5f ? ( 4.f * x ) - 1.f : ( -4.f * x ) + 3.f;
+			case SAWTOOTH:
+				return x;
+			case SAWTOOTH_INVERSE:
+				return 1.f - x;
+			case NOISE:
+				return Noiser::get();
+			default:
+				return 0.f;
+		}
+	}
+
+	//! Evaluates a modifier function for many vertices, like SModifierFunction::evaluate
+	/** Vertex i has the phase function.phase + phases[i] * scale, and the base
+	bases[i] if bases are given. */
+	void evaluateWaves ( const SModifierFunction &function, f32 dt, const f32 *phases, f32 scale,
+		const f32 *bases, f32 *out, u32 count )
+	{
+		u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		// the noise is a sequence, which the vertices get in order
+		if ( function.func != NOISE )
+		{
+			const __m128 time = _mm_set1_ps( dt );
+			const __m128 phase = _mm_set1_ps( function.phase );
+			const __m128 phaseScale = _mm_set1_ps( scale );
+			const __m128 frequency = _mm_set1_ps( function.frequency );
+			const __m128 base = _mm_set1_ps( function.base );
+			const __m128 amp = _mm_set1_ps( function.amp );
+			const __m128 one = _mm_set1_ps( 1.f );
+			const __m128 half = _mm_set1_ps( 0.5f );
+			const __m128 four = _mm_set1_ps( 4.f );
+
+			for ( ; i + 4 <= count; i += 4 )
+			{
+				const __m128 t = _mm_mul_ps( _mm_add_ps( time,
+					_mm_add_ps( phase, _mm_mul_ps( _mm_loadu_ps( phases + i ), phaseScale ) ) ), frequency );
+
+				// fract, with the floor from the truncated value
+				__m128 floor = _mm_cvtepi32_ps( _mm_cvttps_epi32( t ) );
+				floor = _mm_sub_ps( floor, _mm_and_ps( _mm_cmpgt_ps( floor, t ), one ) );
+				const __m128 x = _mm_sub_ps( t, floor );
+
+				__m128 y;
+				switch ( function.func )
+				{
+					case SINUS:
+					case COSINUS:
+					{
+						__m128i j = _mm_cvtps_epi32( _mm_mul_ps( x, four ) );
+						const __m128 r = _mm_mul_ps( _mm_sub_ps( x, _mm_mul_ps( _mm_cvtepi32_ps( j ), _mm_set1_ps( 0.25f ) ) ),
+							_mm_set1_ps( 2.f * core::PI ) );
+						if ( function.func == COSINUS )
+							j = _mm_add_epi32( j, _mm_set1_epi32( 1 ) );
+						__m128 c;
+						core::sinCosQuadrant( r, j, y, c );
+					} break;
+					case SQUARE:
+					{
+						const __m128 low = _mm_cmplt_ps( x, half );
+						y = _mm_or_ps( _mm_and_ps( low, one ), _mm_andnot_ps( low, _mm_set1_ps( -1.f ) ) );
+					} break;
+					case TRIANGLE:
+					{
+						const __m128 low = _mm_cmplt_ps( x, half );
+						const __m128 x4 = _mm_mul_ps( four, x );
+						y = _mm_or_ps( _mm_and_ps( low, _mm_sub_ps( x4, one ) ),
+							_mm_andnot_ps( low, _mm_sub_ps( _mm_set1_ps( 3.f ), x4 ) ) );
+					} break;
+					case SAWTOOTH:
+						y = x;
+						break;
+					case SAWTOOTH_INVERSE:
+						y = _mm_sub_ps( one, x );
+						break;
+					default:
+						y = _mm_setzero_ps();
+						break;
+				}
+
+				_mm_storeu_ps( out + i, _mm_add_ps( bases ? _mm_loadu_ps( bases + i ) : base, _mm_mul_ps( y, amp ) ) );
+			}
+		}
+#endif
+		for ( ; i < count; ++i )
+		{
+			const f32 x = core::fract( ( dt + ( function.phase + phases[i] * scale ) ) * function.frequency );
+			out[i] = ( bases ? bases[i] : function.base ) + waveValue( function.func, x ) * function.amp;
+		}
+	}
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	//! Normalizes four vectors, leaving zero vectors unchanged like vector3d::normalize
+	inline void normalize ( __m128 &x, __m128 &y, __m128 &z )
+	{
+		const __m128 one = _mm_set1_ps( 1.f );
+		const __m128 length = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) );
+		const __m128 zero = _mm_cmpeq_ps( length, _mm_setzero_ps() );
+		const __m128 scale = _mm_or_ps( _mm_andnot_ps( zero, _mm_div_ps( one, _mm_sqrt_ps( length ) ) ), _mm_and_ps( zero, one ) );
+		x = _mm_mul_ps( x, scale );
+		y = _mm_mul_ps( y, scale );
+		z = _mm_mul_ps( z, scale );
+	}
+#endif
+}
 
 namespace irr
 {
@@ -34,7 +169,8 @@ CQuake3ShaderSceneNode::CQuake3ShaderSceneNode(
 		core::vector3df(0.f, 0.f, 0.f),
 		core::vector3df(0.f, 0.f, 0.f),
 		core::vector3df(1.f, 1.f, 1.f)),
-	Shader(shader), Mesh(0), Shadow(0), Original(0), MeshBuffer(0), TimeAbs(0.f)
+	Shader(shader), Mesh(0), Shadow(0), Original(0), MeshBuffer(0),
+	ConstantColor(0xFFFFFFFF), ColorsConstant(true), TCoordSource(TEXTURE), TimeAbs(0.f)
 {
 	#ifdef _DEBUG
 		core::stringc dName = "CQuake3ShaderSceneNode ";
@@ -64,7 +200,10 @@ CQuake3ShaderSceneNode::CQuake3ShaderSceneNode(
 	// load all Textures in all stages
 	loadTextures( fileSystem );
 
-	setAutomaticCulling( scene::EAC_OFF );
+	// parse the modifiers once, and copy the vertices to streams for them
+	compileModifiers();
+	prepareStreams();
+	prepareCulling();
 }
 
 
@@ -129,6 +268,307 @@ void CQuake3ShaderSceneNode::cloneBuffer( scene::SMeshBuffer *dest, const scene:
 }
 
 
+/*
+	parse the numbers of the modifiers of all stages, animate only evaluates them
+*/
+void CQuake3ShaderSceneNode::compileModifiers()
+{
+	static const c8 * const modifierList[] =
+	{
+		"tcmod","deformvertexes","rgbgen","tcgen","map","alphagen"
+	};
+	static const c8 * const funclist[] =
+	{
+		"scroll","scale","rotate","stretch","turb",
+		"wave","identity","vertex",
+		"texture","lightmap","environment","$lightmap",
+		"bulge","autosprite","autosprite2","transform",
+		"exactvertex","const","lightingspecular","move","normal",
+		"identitylighting"
+	};
+	static const c8 * const wavelist[] =
+	{
+		"sin","cos","square",
+		"triangle", "sawtooth","inversesawtooth", "noise"
+	};
+	static const c8 * const groupToken[] = { "(", ")" };
+
+	for ( u32 stage = 0; stage != Q3Texture.size(); ++stage )
+	{
+		const SVarGroup *group = Shader->getGroup( stage );
+		core::array< SQ3Modifier > &modifiers = Q3Texture[stage].Modifiers;
+		modifiers.clear();
+
+		for ( u32 g = 0; g != group->Variable.size(); ++g )
+		{
+			const SVariable &v = group->Variable[g];
+
+			SQ3Modifier m;
+			u32 pos = 0;
+			m.Type = (eQ3ModifierFunction) isEqual( v.name, pos, modifierList, 6 );
+			if ( UNKNOWN == m.Type )
+				continue;
+
+			pos = 0;
+			m.Function = (eQ3ModifierFunction) isEqual( v.content, pos, funclist, 22 );
+			if ( m.Function != UNKNOWN )
+				m.Function = (eQ3ModifierFunction) ((u32) m.Function + FUNCTION2 + 1);
+			m.WaveFunction = UNKNOWN;
+
+			// numbers in front of the wave function
+			u32 count = 0;
+			bool wave = false;
+			switch ( m.Function )
+			{
+				case SCROLL:
+				case SCALE:
+				case NORMAL:
+					count = 2;
+					break;
+				case ROTATE:
+					count = 1;
+					break;
+				case BULGE:
+					count = 3;
+					break;
+				case TRANSFORM:
+					count = 6;
+					break;
+				case STRETCH:
+				case TURBULENCE:
+				case WAVE:
+				case MOVE:
+					if ( m.Type == DEFORMVERTEXES )
+						count = m.Function == WAVE ? 1 : m.Function == MOVE ? 3 : 0;
+					wave = v.content.size() != 0;
+					break;
+				case CONSTANT:
+					if ( m.Type == RGBGEN )
+					{
+						isEqual( v.content, pos, groupToken, 2 );
+						count = 3;
+					}
+					else if ( m.Type == ALPHAGEN )
+					{
+						count = 1;
+					}
+					break;
+				default:
+					break;
+			}
+
+			u32 i = 0;
+			for ( ; i != count; ++i )
+				m.Values[i] = readFloat( v.content, pos );
+
+			// like getModifierFunc
+			if ( wave )
+			{
+				m.WaveFunction = (eQ3ModifierFunction) isEqual( v.content, pos, wavelist, 7 );
+				m.WaveFunction = m.WaveFunction == UNKNOWN ? SINUS :
+					(eQ3ModifierFunction) ((u32) m.WaveFunction + WAVE_MODIFIER_FUNCTION + 1);
+				for ( u32 k = 0; k != 4; ++k )
+					m.Values[i++] = readFloat( v.content, pos );
+			}
+
+			modifiers.push_back( m );
+		}
+	}
+}
+
+
+/*
+	copy the original vertices to the streams
+*/
+void CQuake3ShaderSceneNode::prepareStreams()
+{
+	const u32 vsize = Original->Vertices.size();
+	Streams.set_used( vsize * EVS_COUNT );
+
+	f32 *x = getStream( EVS_POSITION_X );
+	f32 *y = getStream( EVS_POSITION_Y );
+	f32 *z = getStream( EVS_POSITION_Z );
+	f32 *nx = getStream( EVS_NORMAL_X );
+	f32 *ny = getStream( EVS_NORMAL_Y );
+	f32 *nz = getStream( EVS_NORMAL_Z );
+	f32 *tx = getStream( EVS_TCOORD_X );
+	f32 *latBase = getStream( EVS_LATITUDE_BASE );
+	f32 *latPhase = getStream( EVS_LATITUDE_PHASE );
+	f32 *lngPhase = getStream( EVS_LONGITUDE_PHASE );
+
+	for ( u32 i = 0; i != vsize; ++i )
+	{
+		const video::S3DVertex2TCoords &src = Original->Vertices[i];
+		x[i] = src.Pos.X;
+		y[i] = src.Pos.Y;
+		z[i] = src.Pos.Z;
+		nx[i] = src.Normal.X;
+		ny[i] = src.Normal.Y;
+		nz[i] = src.Normal.Z;
+		tx[i] = src.TCoords.X;
+		latBase[i] = atan2f ( src.Pos.X, src.Pos.Y );
+		latPhase[i] = src.Pos.X + src.Pos.Z;
+		lngPhase[i] = src.Normal.Z + src.Normal.X;
+	}
+
+	resetDeformed();
+}
+
+
+/*
+	bounding box of all positions the deformations can move the vertices to
+*/
+void CQuake3ShaderSceneNode::prepareCulling()
+{
+	const u32 vsize = Original->Vertices.size();
+	const f32 *x = getStream( EVS_POSITION_X );
+	const f32 *y = getStream( EVS_POSITION_Y );
+	const f32 *z = getStream( EVS_POSITION_Z );
+
+	f32 normalLength = 0.f;
+	for ( u32 i = 0; i != vsize; ++i )
+		normalLength = core::max_( normalLength, Original->Vertices[i].Normal.getLength() );
+
+	// the functions are between -1 and 1, so the vertices move by base + amplitude at most
+	bool bounded = true;
+	f32 distance = 0.f;
+	f32 spriteRadius = 0.f;
+	for ( u32 stage = 0; stage != Q3Texture.size(); ++stage )
+	{
+		const core::array< SQ3Modifier > &modifiers = Q3Texture[stage].Modifiers;
+		for ( u32 g = 0; g != modifiers.size(); ++g )
+		{
+			const SQ3Modifier &m = modifiers[g];
+			if ( m.Type != DEFORMVERTEXES )
+				continue;
+
+			switch ( m.Function )
+			{
+				case WAVE:
+					bounded &= m.WaveFunction != UNKNOWN;
+					distance += ( core::abs_( m.Values[1] ) + core::abs_( m.Values[2] ) ) * normalLength;
+					break;
+				case MOVE:
+					bounded &= m.WaveFunction != UNKNOWN;
+					distance += ( core::abs_( m.Values[3] ) + core::abs_( m.Values[4] ) ) *
+						core::vector3df( m.Values[0], m.Values[1], m.Values[2] ).getLength();
+					break;
+				case BULGE:
+					distance += ( core::abs_( m.Values[0] ) + core::abs_( m.Values[1] ) ) * normalLength;
+					break;
+				case AUTOSPRITE:
+				case AUTOSPRITE2:
+				{
+					// the quads turn around their centers
+					for ( u32 i = 0; i + 4 <= vsize; i += 4 )
+					{
+						const core::vector3df center = 0.25f * ( Original->Vertices[i+0].Pos + Original->Vertices[i+1].Pos +
+							Original->Vertices[i+2].Pos + Original->Vertices[i+3].Pos );
+						for ( u32 k = 0; k != 4; ++k )
+							spriteRadius = core::max_( spriteRadius, center.getDistanceFrom( Original->Vertices[i+k].Pos ) );
+					}
+				} break;
+				default:
+					break;
+			}
+		}
+	}
+
+	if ( vsize )
+		CullingBox.reset( core::vector3df( x[0], y[0], z[0] ) - MeshOffset );
+	else
+		CullingBox.reset( 0.f, 0.f, 0.f );
+	for ( u32 i = 1; i < vsize; ++i )
+		CullingBox.addInternalPoint( core::vector3df( x[i], y[i], z[i] ) - MeshOffset );
+	distance += spriteRadius;
+	CullingBox.MinEdge -= core::vector3df( distance, distance, distance );
+	CullingBox.MaxEdge += core::vector3df( distance, distance, distance );
+
+	setAutomaticCulling( bounded ? scene::EAC_BOX : scene::EAC_OFF );
+}
+
+
+/*
+	start the deformations of a stage at the original positions
+*/
+void CQuake3ShaderSceneNode::resetDeformed()
+{
+	const u32 vsize = Original->Vertices.size();
+	const f32 *x = getStream( EVS_POSITION_X );
+	const f32 *y = getStream( EVS_POSITION_Y );
+	const f32 *z = getStream( EVS_POSITION_Z );
+	f32 *dx = getStream( EVS_DEFORMED_X );
+	f32 *dy = getStream( EVS_DEFORMED_Y );
+	f32 *dz = getStream( EVS_DEFORMED_Z );
+
+	for ( u32 i = 0; i != vsize; ++i )
+	{
+		dx[i] = x[i] - MeshOffset.X;
+		dy[i] = y[i] - MeshOffset.Y;
+		dz[i] = z[i] - MeshOffset.Z;
+	}
+}
+
+
+/*
+	move the vertices once for all deformations of a stage
+*/
+void CQuake3ShaderSceneNode::storeDeformed()
+{
+	const u32 vsize = Original->Vertices.size();
+	const f32 *x = getStream( EVS_DEFORMED_X );
+	const f32 *y = getStream( EVS_DEFORMED_Y );
+	const f32 *z = getStream( EVS_DEFORMED_Z );
+	video::S3DVertex *dv = MeshBuffer->Vertices.pointer();
+
+	for ( u32 i = 0; i != vsize; ++i )
+	{
+		dv[i].Pos.set( x[i], y[i], z[i] );
+
+		if ( i == 0 )
+			MeshBuffer->BoundingBox.reset ( dv[i].Pos );
+		else
+			MeshBuffer->BoundingBox.addInternalPoint ( dv[i].Pos );
+	}
+}
+
+
+/*
+	set the color of all vertices, unless they have it already
+*/
+void CQuake3ShaderSceneNode::fillColor( video::SColor color )
+{
+	if ( ColorsConstant && ConstantColor == color )
+		return;
+
+	const u32 vsize = MeshBuffer->Vertices.size();
+	for ( u32 i = 0; i != vsize; ++i )
+		MeshBuffer->Vertices[i].Color = color;
+
+	ConstantColor = color;
+	ColorsConstant = true;
+}
+
+
+/*
+	set the alpha of all vertices
+*/
+void CQuake3ShaderSceneNode::fillAlpha( u32 alpha )
+{
+	if ( ColorsConstant )
+	{
+		video::SColor color = ConstantColor;
+		color.setAlpha( alpha );
+		fillColor( color );
+		return;
+	}
+
+	const u32 vsize = MeshBuffer->Vertices.size();
+	for ( u32 i = 0; i != vsize; ++i )
+		MeshBuffer->Vertices[i].Color.setAlpha ( alpha );
+}
+
+
 /*
 	load the textures for all stages
 */
@@ -542,31 +982,36 @@ void CQuake3ShaderSceneNode::deformvertexes_wave( f32 dt, SModifierFunction &fun
 {
 	function.wave = core::reciprocal( function.wave );
 
-	const f32 phase = function.phase;
+	if ( 0 == function.count )
+		resetDeformed();
 
 	const u32 vsize = Original->Vertices.size();
-	for ( u32 i = 0; i != vsize; ++i )
-	{
-		const video::S3DVertex2TCoords &src = Original->Vertices[i];
-		video::S3DVertex &dst = MeshBuffer->Vertices[i];
-
-		if ( 0 == function.count )
-			dst.Pos = src.Pos - MeshOffset;
-
-		const f32 wavephase = (dst.Pos.X + dst.Pos.Y + dst.Pos.Z) * function.wave;
-		function.phase = phase + wavephase;
-
-		const f32 f = function.evaluate( dt );
+	f32 *x = getStream( EVS_DEFORMED_X );
+	f32 *y = getStream( EVS_DEFORMED_Y );
+	f32 *z = getStream( EVS_DEFORMED_Z );
+	const f32 *nx = getStream( EVS_NORMAL_X );
+	const f32 *ny = getStream( EVS_NORMAL_Y );
+	const f32 *nz = getStream( EVS_NORMAL_Z );
+	f32 *phases = getStream( EVS_PHASE );
+	f32 *values = getStream( EVS_VALUE );
+
+	// the phase of a vertex comes from its position
+	u32 i;
+	for ( i = 0; i != vsize; ++i )
+		phases[i] = x[i] + y[i] + z[i];
 
-		dst.Pos.X += f * src.Normal.X;
-		dst.Pos.Y += f * src.Normal.Y;
-		dst.Pos.Z += f * src.Normal.Z;
+	evaluateWaves( function, dt, phases, function.wave, 0, values, vsize );
 
-		if ( i == 0 )
-			MeshBuffer->BoundingBox.reset ( dst.Pos );
-		else
-			MeshBuffer->BoundingBox.addInternalPoint ( dst.Pos );
+	for ( i = 0; i != vsize; ++i )
+	{
+		x[i] += values[i] * nx[i];
+		y[i] += values[i] * ny[i];
+		z[i] += values[i] * nz[i];
 	}
+
+	// later modifiers see the phase of the last vertex
+	if ( vsize )
+		function.phase += phases[vsize-1] * function.wave;
 	function.count = 1;
 }
 
@@ -596,26 +1041,21 @@ void CQuake3ShaderSceneNode::deformvertexes_move( f32 dt, SModifierFunction &fun
 	function.wave = core::reciprocal( function.wave );
 	const f32 f = function.evaluate( dt );
 
+	if ( 0 == function.count )
+		resetDeformed();
+
 	const u32 vsize = Original->Vertices.size();
+	f32 *x = getStream( EVS_DEFORMED_X );
+	f32 *y = getStream( EVS_DEFORMED_Y );
+	f32 *z = getStream( EVS_DEFORMED_Z );
+
 	for ( u32 i = 0; i != vsize; ++i )
 	{
-		const video::S3DVertex2TCoords &src = Original->Vertices[i];
-		video::S3DVertex &dst = MeshBuffer->Vertices[i];
-
-		if ( 0 == function.count )
-			dst.Pos = src.Pos - MeshOffset;
-
-		dst.Pos.X += f * function.x;
-		dst.Pos.Y += f * function.y;
-		dst.Pos.Z += f * function.z;
-
-		if ( i == 0 )
-			MeshBuffer->BoundingBox.reset ( dst.Pos );
-		else
-			MeshBuffer->BoundingBox.addInternalPoint ( dst.Pos );
+		x[i] += f * function.x;
+		y[i] += f * function.y;
+		z[i] += f * function.z;
 	}
 	function.count = 1;
-
 }
 
 /*!
@@ -632,26 +1072,48 @@ void CQuake3ShaderSceneNode::deformvertexes_move( f32 dt, SModifierFunction &fun
 void CQuake3ShaderSceneNode::deformvertexes_normal( f32 dt, SModifierFunction &function )
 {
 	function.func = SINUS;
+
 	const u32 vsize = Original->Vertices.size();
-	for ( u32 i = 0; i != vsize; ++i )
+	f32 *lat = getStream( EVS_VALUE );
+	f32 *lng = getStream( EVS_VALUE2 );
+
+	// base and phase of each vertex come from its original position and normal
+	SModifierFunction vertexFunction = function;
+	vertexFunction.phase = 0.f;
+	evaluateWaves( vertexFunction, dt, getStream( EVS_LATITUDE_PHASE ), 1.f, getStream( EVS_LATITUDE_BASE ), lat, vsize );
+	evaluateWaves( vertexFunction, dt, getStream( EVS_LONGITUDE_PHASE ), 1.f, getStream( EVS_NORMAL_Y ), lng, vsize );
+
+	video::S3DVertex *dv = MeshBuffer->Vertices.pointer();
+	u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	for ( ; i + 4 <= vsize; i += 4 )
 	{
-		const video::S3DVertex2TCoords &src = Original->Vertices[i];
-		video::S3DVertex &dst = MeshBuffer->Vertices[i];
-
-		function.base = atan2f ( src.Pos.X, src.Pos.Y );
-		function.phase = src.Pos.X + src.Pos.Z;
-
-		const f32 lat = function.evaluate( dt );
+		__m128 sinLat, cosLat, sinLng, cosLng;
+		core::sinCos( _mm_loadu_ps( lat + i ), sinLat, cosLat );
+		core::sinCos( _mm_loadu_ps( lng + i ), sinLng, cosLng );
+
+		f32 nx[4], ny[4], nz[4];
+		_mm_storeu_ps( nx, _mm_mul_ps( cosLat, sinLng ) );
+		_mm_storeu_ps( ny, _mm_mul_ps( sinLat, sinLng ) );
+		_mm_storeu_ps( nz, cosLng );
+		for ( u32 k = 0; k != 4; ++k )
+			dv[i+k].Normal.set( nx[k], ny[k], nz[k] );
+	}
+#endif
+	for ( ; i < vsize; ++i )
+	{
+		f32 sinLat, cosLat, sinLng, cosLng;
+		core::sinCos( lat[i], sinLat, cosLat );
+		core::sinCos( lng[i], sinLng, cosLng );
+		dv[i].Normal.set( cosLat * sinLng, sinLat * sinLng, cosLng );
+	}
 
+	// later modifiers see the values of the last vertex
+	if ( vsize )
+	{
+		const video::S3DVertex2TCoords &src = Original->Vertices[vsize-1];
 		function.base = src.Normal.Y;
 		function.phase = src.Normal.Z + src.Normal.X;
-
-		const f32 lng = function.evaluate( dt );
-
-		dst.Normal.X = cosf ( lat ) * sinf ( lng );
-		dst.Normal.Y = sinf ( lat ) * sinf ( lng );
-		dst.Normal.Z = cosf ( lng );
-
 	}
 }
 
@@ -706,32 +1168,31 @@ void CQuake3ShaderSceneNode::deformvertexes_bulge( f32 dt, SModifierFunction &fu
 	function.wave = core::reciprocal( function.bulgewidth );
 
 	dt *= function.bulgespeed * 0.1f;
-	const f32 phase = function.phase;
 
 	const u32 vsize = Original->Vertices.size();
-	for ( u32 i = 0; i != vsize; ++i )
-	{
-		const video::S3DVertex2TCoords &src = Original->Vertices[i];
-		video::S3DVertex &dst = MeshBuffer->Vertices[i];
+	f32 *values = getStream( EVS_VALUE );
+	evaluateWaves( function, dt, getStream( EVS_TCOORD_X ), function.wave, 0, values, vsize );
 
-		const f32 wavephase = (Original->Vertices[i].TCoords.X ) * function.wave;
-		function.phase = phase + wavephase;
+	if ( 0 == function.count )
+		resetDeformed();
 
-		const f32 f = function.evaluate( dt );
+	f32 *x = getStream( EVS_DEFORMED_X );
+	f32 *y = getStream( EVS_DEFORMED_Y );
+	f32 *z = getStream( EVS_DEFORMED_Z );
+	const f32 *nx = getStream( EVS_NORMAL_X );
+	const f32 *ny = getStream( EVS_NORMAL_Y );
+	const f32 *nz = getStream( EVS_NORMAL_Z );
 
-		if ( 0 == function.count )
-			dst.Pos = src.Pos - MeshOffset;
-
-		dst.Pos.X += f * src.Normal.X;
-		dst.Pos.Y += f * src.Normal.Y;
-		dst.Pos.Z += f * src.Normal.Z;
-
-		if ( i == 0 )
-			MeshBuffer->BoundingBox.reset ( dst.Pos );
-		else
-			MeshBuffer->BoundingBox.addInternalPoint ( dst.Pos );
+	for ( u32 i = 0; i != vsize; ++i )
+	{
+		x[i] += values[i] * nx[i];
+		y[i] += values[i] * ny[i];
+		z[i] += values[i] * nz[i];
 	}
 
+	// later modifiers see the phase of the last vertex
+	if ( vsize )
+		function.phase += Original->Vertices[vsize-1].TCoords.X * function.wave;
 	function.count = 1;
 }
 
@@ -759,9 +1220,17 @@ void CQuake3ShaderSceneNode::deformvertexes_autosprite( f32 dt, SModifierFunctio
 	video::S3DVertex * dv = MeshBuffer->Vertices.pointer();
 	const video::S3DVertex2TCoords * vin = Original->Vertices.const_pointer();
 
+	if ( 0 == function.count )
+		resetDeformed();
+
+	f32 *x = getStream( EVS_DEFORMED_X );
+	f32 *y = getStream( EVS_DEFORMED_Y );
+	f32 *z = getStream( EVS_DEFORMED_Z );
+	core::vector3df pos;
+
 	core::matrix4 lookat ( core::matrix4::EM4CONST_NOTHING );
 	core::quaternion q;
-	for ( i = 0; i < vsize; i += 4 )
+	for ( i = 0; i + 4 <= vsize; i += 4 )
 	{
 		// quad-plane
 		core::vector3df center = 0.25f * ( vin[i+0].Pos + vin[i+1].Pos + vin[i+2].Pos + vin[i+3].Pos );
@@ -772,7 +1241,10 @@ void CQuake3ShaderSceneNode::deformvertexes_autosprite( f32 dt, SModifierFunctio
 
 		for ( g = 0; g < 4; ++g )
 		{
-			lookat.transformVect ( dv[i+g].Pos, vin[i+g].Pos );
+			lookat.transformVect ( pos, vin[i+g].Pos );
+			x[i+g] = pos.X;
+			y[i+g] = pos.Y;
+			z[i+g] = pos.Z;
 			lookat.rotateVect ( dv[i+g].Normal, vin[i+g].Normal );
 		}
 
@@ -814,7 +1286,15 @@ void CQuake3ShaderSceneNode::deformvertexes_autosprite2( f32 dt, SModifierFuncti
 	core::array < sortaxis > axis;
 	axis.set_used ( 3 );
 
-	for ( i = 0; i < vsize; i += 4 )
+	if ( 0 == function.count )
+		resetDeformed();
+
+	f32 *x = getStream( EVS_DEFORMED_X );
+	f32 *y = getStream( EVS_DEFORMED_Y );
+	f32 *z = getStream( EVS_DEFORMED_Z );
+	core::vector3df pos;
+
+	for ( i = 0; i + 4 <= vsize; i += 4 )
 	{
 		// quad-plane
 		core::vector3df center = 0.25f * ( vin[i+0].Pos + vin[i+1].Pos + vin[i+2].Pos + vin[i+3].Pos );
@@ -830,7 +1310,10 @@ void CQuake3ShaderSceneNode::deformvertexes_autosprite2( f32 dt, SModifierFuncti
 
 		for ( g = 0; g < 4; ++g )
 		{
-			lookat.transformVect ( dv[i+g].Pos, vin[i+g].Pos );
+			lookat.transformVect ( pos, vin[i+g].Pos );
+			x[i+g] = pos.X;
+			y[i+g] = pos.Y;
+			z[i+g] = pos.Z;
 			lookat.rotateVect ( dv[i+g].Normal, vin[i+g].Normal );
 		}
 	}
@@ -849,14 +1332,12 @@ void CQuake3ShaderSceneNode::vertextransform_rgbgen( f32 dt, SModifierFunction &
 	{
 		case IDENTITY:
 			//rgbgen identity
-			for ( i = 0; i != vsize; ++i )
-				MeshBuffer->Vertices[i].Color.set(0xFFFFFFFF);
+			fillColor(0xFFFFFFFF);
 			break;
 
 		case IDENTITYLIGHTING:
 			// rgbgen identitylighting TODO: overbright
-			for ( i = 0; i != vsize; ++i )
-				MeshBuffer->Vertices[i].Color.set(0xFF7F7F7F);
+			fillColor(0xFF7F7F7F);
 			break;
 
 		case EXACTVERTEX:
@@ -865,6 +1346,7 @@ void CQuake3ShaderSceneNode::vertextransform_rgbgen( f32 dt, SModifierFunction &
 			// rgbgen vertex
 			for ( i = 0; i != vsize; ++i )
 				MeshBuffer->Vertices[i].Color=Original->Vertices[i].Color;
+			ColorsConstant = false;
 			break;
 		case WAVE:
 		{
@@ -873,16 +1355,13 @@ void CQuake3ShaderSceneNode::vertextransform_rgbgen( f32 dt, SModifierFunction &
 			s32 value = core::clamp( core::floor32(f), 0, 255 );
 			value = 0xFF000000 | value << 16 | value << 8 | value;
 
-			for ( i = 0; i != vsize; ++i )
-				MeshBuffer->Vertices[i].Color.set(value);
+			fillColor(value);
 		} break;
 		case CONSTANT:
 		{
 			//rgbgen const ( x y z )
 			video::SColorf cf( function.x, function.y, function.z );
-			video::SColor col = cf.toSColor();
-			for ( i = 0; i != vsize; ++i )
-				MeshBuffer->Vertices[i].Color=col;
+			fillColor(cf.toSColor());
 		} break;
 		default:
 			break;
@@ -901,8 +1380,7 @@ void CQuake3ShaderSceneNode::vertextransform_alphagen( f32 dt, SModifierFunction
 	{
 		case IDENTITY:
 			//alphagen identity
-			for ( i = 0; i != vsize; ++i )
-				MeshBuffer->Vertices[i].Color.setAlpha ( 0xFF );
+			fillAlpha ( 0xFF );
 			break;
 
 		case EXACTVERTEX:
@@ -911,13 +1389,13 @@ void CQuake3ShaderSceneNode::vertextransform_alphagen( f32 dt, SModifierFunction
 			// alphagen vertex
 			for ( i = 0; i != vsize; ++i )
 				MeshBuffer->Vertices[i].Color.setAlpha ( Original->Vertices[i].Color.getAlpha() );
+			ColorsConstant = false;
 			break;
 		case CONSTANT:
 		{
 			// alphagen const
 			u32 a = (u32) ( function.x * 255.f );
-			for ( i = 0; i != vsize; ++i )
-				MeshBuffer->Vertices[i].Color.setAlpha ( a );
+			fillAlpha ( a );
 		} break;
 
 		case LIGHTINGSPECULAR:
@@ -933,6 +1411,7 @@ void CQuake3ShaderSceneNode::vertextransform_alphagen( f32 dt, SModifierFunction
 				const core::vector3df &n = Original->Vertices[i].Normal;
 				MeshBuffer->Vertices[i].Color.setAlpha ((u32)( 128.f *(1.f+(n.X*m[0]+n.Y*m[1]+n.Z*m[2]))));
 			}
+			ColorsConstant = false;
 
 		} break;
 
@@ -943,8 +1422,7 @@ void CQuake3ShaderSceneNode::vertextransform_alphagen( f32 dt, SModifierFunction
 			f32 f = function.evaluate( dt ) * 255.f;
 			s32 value = core::clamp( core::floor32(f), 0, 255 );
 
-			for ( i = 0; i != vsize; ++i )
-				MeshBuffer->Vertices[i].Color.setAlpha ( value );
+			fillAlpha ( value );
 		} break;
 		default:
 			break;
@@ -983,18 +1461,25 @@ void CQuake3ShaderSceneNode::vertextransform_tcgen( f32 dt, SModifierFunction &f
 				dst.TCoords.X = src.TCoords.X + f * src.Normal.X;
 				dst.TCoords.Y = src.TCoords.Y + f * src.Normal.Y;
 			}
+			TCoordSource = TURBULENCE;
 		}
 		break;
 
 		case TEXTURE:
 			// tcgen texture
+			if ( TCoordSource == TEXTURE )
+				break;
 			for ( i = 0; i != vsize; ++i )
 				MeshBuffer->Vertices[i].TCoords = Original->Vertices[i].TCoords;
+			TCoordSource = TEXTURE;
 			break;
 		case LIGHTMAP:
 			// tcgen lightmap
+			if ( TCoordSource == LIGHTMAP )
+				break;
 			for ( i = 0; i != vsize; ++i )
 				MeshBuffer->Vertices[i].TCoords = Original->Vertices[i].TCoords2;
+			TCoordSource = LIGHTMAP;
 			break;
 		case ENVIRONMENT:
 		{
@@ -1004,19 +1489,55 @@ void CQuake3ShaderSceneNode::vertextransform_tcgen( f32 dt, SModifierFunction &f
 
 			const f32 *m = view.pointer();
 
+			const f32 *px = getStream( EVS_POSITION_X );
+			const f32 *py = getStream( EVS_POSITION_Y );
+			const f32 *pz = getStream( EVS_POSITION_Z );
+			const f32 *nx = getStream( EVS_NORMAL_X );
+			const f32 *ny = getStream( EVS_NORMAL_Y );
+			const f32 *nz = getStream( EVS_NORMAL_Z );
+			video::S3DVertex *dv = MeshBuffer->Vertices.pointer();
+
+			i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			const __m128 camX = _mm_set1_ps( frustum->cameraPosition.X );
+			const __m128 camY = _mm_set1_ps( frustum->cameraPosition.Y );
+			const __m128 camZ = _mm_set1_ps( frustum->cameraPosition.Z );
+			const __m128 half = _mm_set1_ps( 0.5f );
+			const __m128 one = _mm_set1_ps( 1.f );
+			for ( ; i + 4 <= vsize; i += 4 )
+			{
+				__m128 x = _mm_sub_ps( camX, _mm_loadu_ps( px + i ) );
+				__m128 y = _mm_sub_ps( camY, _mm_loadu_ps( py + i ) );
+				__m128 z = _mm_sub_ps( camZ, _mm_loadu_ps( pz + i ) );
+				normalize( x, y, z );
+				x = _mm_add_ps( x, _mm_loadu_ps( nx + i ) );
+				y = _mm_add_ps( y, _mm_loadu_ps( ny + i ) );
+				z = _mm_add_ps( z, _mm_loadu_ps( nz + i ) );
+				normalize( x, y, z );
+
+				f32 u[4], v[4];
+				_mm_storeu_ps( u, _mm_mul_ps( half, _mm_add_ps( one, _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( m[0] ) ),
+					_mm_mul_ps( y, _mm_set1_ps( m[1] ) ) ), _mm_mul_ps( z, _mm_set1_ps( m[2] ) ) ) ) ) );
+				_mm_storeu_ps( v, _mm_mul_ps( half, _mm_add_ps( one, _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( m[4] ) ),
+					_mm_mul_ps( y, _mm_set1_ps( m[5] ) ) ), _mm_mul_ps( z, _mm_set1_ps( m[6] ) ) ) ) ) );
+				for ( u32 k = 0; k != 4; ++k )
+					dv[i+k].TCoords.set( u[k], v[k] );
+			}
+#endif
 			core::vector3df n;
-			for ( i = 0; i != vsize; ++i )
+			for ( ; i < vsize; ++i )
 			{
-				//const core::vector3df &n = Original->Vertices[i].Normal;
-
-				n = frustum->cameraPosition - Original->Vertices[i].Pos;
+				n.set( frustum->cameraPosition.X - px[i], frustum->cameraPosition.Y - py[i], frustum->cameraPosition.Z - pz[i] );
 				n.normalize();
-				n += Original->Vertices[i].Normal;
+				n.X += nx[i];
+				n.Y += ny[i];
+				n.Z += nz[i];
 				n.normalize();
 
-				MeshBuffer->Vertices[i].TCoords.X = 0.5f*(1.f+(n.X*m[0]+n.Y*m[1]+n.Z*m[2]));
-				MeshBuffer->Vertices[i].TCoords.Y = 0.5f*(1.f+(n.X*m[4]+n.Y*m[5]+n.Z*m[6]));
+				dv[i].TCoords.X = 0.5f*(1.f+(n.X*m[0]+n.Y*m[1]+n.Z*m[2]));
+				dv[i].TCoords.Y = 0.5f*(1.f+(n.X*m[4]+n.Y*m[5]+n.Z*m[6]));
 			}
+			TCoordSource = ENVIRONMENT;
 
 		} break;
 		default:
@@ -1081,8 +1602,6 @@ void CQuake3ShaderSceneNode::transformtex( const core::matrix4 &m, const u32 add
 */
 void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 {
-	const SVarGroup *group = Shader->getGroup( stage );
-
 	// select current texture
 	SQ3Texture &q3Tex = Q3Texture [ stage ];
 	if ( q3Tex.TextureFrequency != 0.f )
@@ -1096,22 +1615,13 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 
 	f32 f[16];
 
-	// walk group for all modifiers
-	for ( u32 g = 0; g != group->Variable.size(); ++g )
+	// walk all modifiers of the stage, their numbers are parsed by compileModifiers
+	for ( u32 g = 0; g != q3Tex.Modifiers.size(); ++g )
 	{
-		const SVariable &v = group->Variable[g];
-
-		// get the modifier
-		static const c8 * const modifierList[] =
-		{
-			"tcmod","deformvertexes","rgbgen","tcgen","map","alphagen"
-		};
-
-		u32 pos = 0;
-		function.masterfunc0 = (eQ3ModifierFunction) isEqual( v.name, pos, modifierList, 6 );
+		const SQ3Modifier &v = q3Tex.Modifiers[g];
+		const f32 *value = v.Values;
 
-		if ( UNKNOWN == function.masterfunc0 )
-			continue;
+		function.masterfunc0 = v.Type;
 
 		switch ( function.masterfunc0 )
 		{
@@ -1123,40 +1633,25 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 				break;
 		}
 
-		// get the modifier function
-		static const c8 * const funclist[] =
-		{
-			"scroll","scale","rotate","stretch","turb",
-			"wave","identity","vertex",
-			"texture","lightmap","environment","$lightmap",
-			"bulge","autosprite","autosprite2","transform",
-			"exactvertex","const","lightingspecular","move","normal",
-			"identitylighting"
-		};
-		static const c8 * const groupToken[] = { "(", ")" };
-
-		pos = 0;
-		function.masterfunc1 = (eQ3ModifierFunction) isEqual( v.content, pos, funclist, 22 );
-		if ( function.masterfunc1 != UNKNOWN )
-			function.masterfunc1 = (eQ3ModifierFunction) ((u32) function.masterfunc1 + FUNCTION2 + 1);
+		function.masterfunc1 = v.Function;
 
 		switch ( function.masterfunc1 )
 		{
 			case SCROLL:
 				// tcMod scroll <sSpeed> <tSpeed>
-				f[0] = getAsFloat( v.content, pos ) * TimeAbs;
-				f[1] = getAsFloat( v.content, pos ) * TimeAbs;
+				f[0] = value[0] * TimeAbs;
+				f[1] = value[1] * TimeAbs;
 				m2.setTextureTranslate( f[0], f[1] );
 				break;
 			case SCALE:
 				// tcmod scale <sScale> <tScale>
-				f[0] = getAsFloat( v.content, pos );
-				f[1] = getAsFloat( v.content, pos );
+				f[0] = value[0];
+				f[1] = value[1];
 				m2.setTextureScale( f[0], f[1] );
 				break;
 			case ROTATE:
 				// tcmod rotate <degrees per second>
-				m2.setTextureRotationCenter(	getAsFloat( v.content, pos ) *
+				m2.setTextureRotationCenter(	value[0] *
 												core::DEGTORAD *
 												TimeAbs
 											);
@@ -1166,12 +1661,12 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 				memset(f, 0, sizeof ( f ));
 				f[10] = f[15] = 1.f;
 
-				f[0] = getAsFloat( v.content, pos );
-				f[1] = getAsFloat( v.content, pos );
-				f[4] = getAsFloat( v.content, pos );
-				f[5] = getAsFloat( v.content, pos );
-				f[8] = getAsFloat( v.content, pos );
-				f[9] = getAsFloat( v.content, pos );
+				f[0] = value[0];
+				f[1] = value[1];
+				f[4] = value[2];
+				f[5] = value[3];
+				f[8] = value[4];
+				f[9] = value[5];
 				m2.setM ( f );
 				break;
 
@@ -1193,13 +1688,13 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 					{
 						case WAVE:
 							// deformvertexes wave
-							function.wave = getAsFloat( v.content, pos );
+							function.wave = *value++;
 							break;
 						case MOVE:
 							//deformvertexes move
-							function.x = getAsFloat( v.content, pos );
-							function.z = getAsFloat( v.content, pos );
-							function.y = getAsFloat( v.content, pos );
+							function.x = *value++;
+							function.z = *value++;
+							function.y = *value++;
 							break;
 						default:
 							break;
@@ -1212,7 +1707,15 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 					case TURBULENCE:
 					case WAVE:
 					case MOVE:
-						getModifierFunc( function, v.content, pos );
+						// like getModifierFunc
+						if ( v.WaveFunction != UNKNOWN )
+						{
+							function.func = v.WaveFunction;
+							function.base = value[0];
+							function.amp = value[1];
+							function.phase = value[2];
+							function.frequency = value[3];
+						}
 						break;
 					default:
 						break;
@@ -1260,10 +1763,9 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 								function.rgbgen = function.masterfunc1;
 								if ( function.rgbgen == CONSTANT )
 								{
-									isEqual ( v.content, pos, groupToken, 2 );
-									function.x = getAsFloat( v.content, pos );
-									function.y = getAsFloat( v.content, pos );
-									function.z = getAsFloat( v.content, pos );
+									function.x = value[0];
+									function.y = value[1];
+									function.z = value[2];
 								}
 								//vertextransform_rgbgen( TimeAbs, function );
 								break;
@@ -1271,7 +1773,7 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 								function.alphagen = function.masterfunc1;
 								if ( function.alphagen == CONSTANT )
 								{
-									function.x = getAsFloat( v.content, pos );
+									function.x = value[0];
 								}
 
 								//vertextransform_alphagen( TimeAbs, function );
@@ -1297,17 +1799,17 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 				break;
 			case BULGE:
 				// deformvertexes bulge
-				function.bulgewidth = getAsFloat( v.content, pos );
-				function.bulgeheight = getAsFloat( v.content, pos );
-				function.bulgespeed = getAsFloat( v.content, pos );
+				function.bulgewidth = value[0];
+				function.bulgeheight = value[1];
+				function.bulgespeed = value[2];
 
 				deformvertexes_bulge(TimeAbs, function);
 				break;
 
 			case NORMAL:
 				// deformvertexes normal
-				function.amp = getAsFloat( v.content, pos );
-				function.frequency = getAsFloat( v.content, pos );
+				function.amp = value[0];
+				function.frequency = value[1];
 
 				deformvertexes_normal(TimeAbs, function);
 				break;
@@ -1336,6 +1838,10 @@ void CQuake3ShaderSceneNode::animate( u32 stage,core::matrix4 &texture )
 
 	} // group
 
+	// move the vertices once for all deformations of the stage
+	if ( function.count )
+		storeDeformed();
+
 	vertextransform_rgbgen( TimeAbs, function );
 	vertextransform_alphagen( TimeAbs, function );
 	vertextransform_tcgen( TimeAbs, function );
@@ -1350,7 +1856,7 @@ void CQuake3ShaderSceneNode::OnAnimate(u32 timeMs)
 
 const core::aabbox3d<f32>& CQuake3ShaderSceneNode::getBoundingBox() const
 {
-	return MeshBuffer->getBoundingBox();
+	return CullingBox;
 }
 
 
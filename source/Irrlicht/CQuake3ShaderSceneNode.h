@@ -65,6 +65,17 @@ private:
 	SMeshBuffer* MeshBuffer;
 	core::vector3df MeshOffset;
 
+	//! A modifier of a stage, with the numbers of its variable parsed once
+	struct SQ3Modifier
+	{
+		quake3::eQ3ModifierFunction Type;
+		quake3::eQ3ModifierFunction Function;
+		//! wave function of the variable, UNKNOWN if it has none
+		quake3::eQ3ModifierFunction WaveFunction;
+		//! numbers in the order animate() uses them
+		f32 Values[8];
+	};
+
 	struct SQ3Texture
 	{
 		SQ3Texture () :
@@ -80,11 +91,57 @@ private:
 		u32 TextureIndex;
 		f32 TextureFrequency;
 		video::E_TEXTURE_CLAMP TextureAddressMode;	// Wrapping/Clamping
+
+		core::array< SQ3Modifier > Modifiers;
 	};
 
 	core::array< SQ3Texture > Q3Texture;
 
+	//! Streams of the vertex data used by the modifiers, each with one value per vertex
+	enum E_VERTEX_STREAM
+	{
+		EVS_POSITION_X = 0,
+		EVS_POSITION_Y,
+		EVS_POSITION_Z,
+		EVS_NORMAL_X,
+		EVS_NORMAL_Y,
+		EVS_NORMAL_Z,
+		EVS_TCOORD_X,
+		//! phases of deformvertexes normal
+		EVS_LATITUDE_BASE,
+		EVS_LATITUDE_PHASE,
+		EVS_LONGITUDE_PHASE,
+		//! positions moved by the deformvertexes modifiers of a stage
+		EVS_DEFORMED_X,
+		EVS_DEFORMED_Y,
+		EVS_DEFORMED_Z,
+		//! temporary values of a modifier
+		EVS_PHASE,
+		EVS_VALUE,
+		EVS_VALUE2,
+		EVS_COUNT
+	};
+
+	core::array< f32 > Streams;
+
+	f32* getStream ( E_VERTEX_STREAM stream ) { return Streams.pointer() + stream * Original->Vertices.size(); }
+
+	//! bounding box of the vertices with all deformations, used for culling
+	core::aabbox3df CullingBox;
+
+	//! colors and texture coordinates are only written when they change
+	video::SColor ConstantColor;
+	bool ColorsConstant;
+	quake3::eQ3ModifierFunction TCoordSource;
+
 	void loadTextures ( io::IFileSystem * fileSystem );
+	void compileModifiers ();
+	void prepareStreams ();
+	void prepareCulling ();
+	void resetDeformed ();
+	void storeDeformed ();
+	void fillColor ( video::SColor color );
+	void fillAlpha ( u32 alpha );
 	void addBuffer ( scene::SMeshBufferLightMap * buffer );
 	void cloneBuffer ( scene::SMeshBuffer *dest, const scene::SMeshBufferLightMap * buffer, bool translateCenter );
 
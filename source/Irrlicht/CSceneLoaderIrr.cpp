@@ -8,6 +8,7 @@
 #include "ISceneManager.h"
 #include "IVideoDriver.h"
 #include "IFileSystem.h"
+#include "coreutil.h"
 #include "os.h"
 
 namespace irr
@@ -40,8 +41,17 @@ bool CSceneLoaderIrr::isALoadableFileExtension(const io::path& filename) const
 //! Returns true if the class might be able to load this file.
 bool CSceneLoaderIrr::isALoadableFileFormat(io::IReadFile *file) const
 {
-	// todo: check inside the file
-	return true;
+	if (!file)
+		return false;
+
+	// xml starts with a tag, white space or a byte order mark, or a 0 of 16 and 32 bit big endian text.
+	// Other files like binary scenes which failed to load are not taken for an empty xml scene.
+	u8 first = 0;
+	const long pos = file->getPos();
+	const bool read = file->read(&first, 1) == 1;
+	file->seek(pos);
+	return read && (first == '<' || core::isspace(first) || first == 0xEF || first == 0xFE ||
+		first == 0xFF || first == 0);
 }
 
 //! Loads the scene into the scene manager.
@@ -0,0 +1,560 @@
+// Copyright (C) 2010-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneLoaderIrrb.h"
+
+#ifdef _IRR_COMPILE_WITH_IRRB_SCENE_
+
+#include "ISceneNodeAnimatorFactory.h"
+#include "ISceneNodeFactory.h"
+#include "ISceneUserDataSerializer.h"
+#include "ISceneManager.h"
+#include "IVideoDriver.h"
+#include "IFileSystem.h"
+#include "IReadFile.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Constructor
+CSceneLoaderIrrb::CSceneLoaderIrrb(ISceneManager *smgr, io::IFileSystem* fs)
+ : SceneManager(smgr), FileSystem(fs), Attributes(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CSceneLoaderIrrb");
+	#endif
+}
+
+
+//! Returns true if the class might be able to load this file.
+bool CSceneLoaderIrrb::isALoadableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension(filename, "irrb");
+}
+
+
+//! Returns true if the class might be able to load this file.
+bool CSceneLoaderIrrb::isALoadableFileFormat(io::IReadFile *file) const
+{
+	if (!file)
+		return false;
+
+	u8 id[4];
+	const long pos = file->getPos();
+	const bool result = file->read(id, 4) == 4 &&
+		(id[0] | (id[1]<<8) | (id[2]<<16) | ((u32)id[3]<<24)) == IRRB_SCENE_MAGIC;
+	file->seek(pos);
+	return result;
+}
+
+
+//! Loads the scene into the scene manager.
+bool CSceneLoaderIrrb::loadScene(io::IReadFile* file, ISceneUserDataSerializer* userDataSerializer,
+	ISceneNode* rootNode)
+{
+	if (!file)
+	{
+		os::Printer::log("Unable to open scene file", ELL_ERROR);
+		return false;
+	}
+
+	const long size = file->getSize() - file->getPos();
+	Data.set_used(size > 0 ? (u32)size : 0);
+	if (size <= 0 || file->read(Data.pointer(), (size_t)size) != (size_t)size)
+	{
+		os::Printer::log("Could not read scene file", file->getFileName(), ELL_ERROR);
+		Data.clear();
+		return false;
+	}
+
+	SReader reader(Data.const_pointer(), Data.const_pointer()+Data.size());
+	const u32 magic = reader.readU32();
+	const u32 version = reader.readU32();
+	if (magic != IRRB_SCENE_MAGIC || version > IRRB_SCENE_VERSION)
+	{
+		os::Printer::log("Unsupported binary scene file", file->getFileName(), ELL_ERROR);
+		Data.clear();
+		return false;
+	}
+
+	// the strings are used in place, they are stored with terminating 0
+	const u32 stringCount = reader.readU32();
+	Strings.reallocate(stringCount);
+	StringLengths.reallocate(stringCount);
+	for (u32 i=0; i<stringCount && !reader.Error; ++i)
+	{
+		const u32 length = reader.readU32();
+		if ((u32)(reader.End-reader.P) <= length || reader.P[length] != 0)
+		{
+			reader.Error = true;
+			break;
+		}
+		Strings.push_back((const c8*)reader.P);
+		StringLengths.push_back(length);
+		reader.P += length+1;
+	}
+
+	if (reader.Error)
+	{
+		os::Printer::log("Binary scene file has a broken string table", file->getFileName(), ELL_ERROR);
+		Strings.clear();
+		StringLengths.clear();
+		Data.clear();
+		return false;
+	}
+
+	// the scene has its own nodes, COLLADA files it references are loaded as meshes
+	bool oldColladaSingleMesh = SceneManager->getParameters()->getAttributeAsBool(COLLADA_CREATE_SCENE_INSTANCES);
+	SceneManager->getParameters()->setAttribute(COLLADA_CREATE_SCENE_INSTANCES, false);
+
+	Attributes = FileSystem->createEmptyAttributes(SceneManager->getVideoDriver());
+
+	while (!reader.atEnd() && !reader.Error)
+	{
+		const u8 chunk = reader.readU8();
+		SReader data = reader.subReader(reader.readU32());
+		if (reader.Error)
+			break;
+
+		if (chunk == EIRRBC_SCENE || chunk == EIRRBC_NODE)
+			readSceneNode(data, chunk, rootNode, userDataSerializer);
+	}
+
+	const bool result = !reader.Error;
+	if (!result)
+		os::Printer::log("Binary scene file is truncated", file->getFileName(), ELL_ERROR);
+
+	// restore old collada parameters
+	SceneManager->getParameters()->setAttribute(COLLADA_CREATE_SCENE_INSTANCES, oldColladaSingleMesh);
+
+	// clean up
+	Attributes->drop();
+	Attributes = 0;
+	Strings.clear();
+	StringLengths.clear();
+	Data.clear();
+	return result;
+}
+
+
+//! Reads a node chunk and all its children
+void CSceneLoaderIrrb::readSceneNode(SReader& reader, u8 chunk, ISceneNode* parent,
+	ISceneUserDataSerializer* userDataSerializer)
+{
+	scene::ISceneNode* node = 0;
+
+	if (chunk == EIRRBC_NODE)
+	{
+		const u32 type = reader.readU32();
+		const u32 typeName = reader.readU32();
+
+		if (parent)
+		{
+			node = createSceneNode(type, typeName, parent);
+			if (!node)
+				os::Printer::log("Could not create scene node of unknown type", getString(typeName));
+		}
+		else
+			node = parent;
+	}
+	else if (!parent)
+		node = SceneManager->getRootSceneNode();
+	else
+		node = parent;
+
+	while (!reader.atEnd() && !reader.Error)
+	{
+		const u8 subChunk = reader.readU8();
+		SReader data = reader.subReader(reader.readU32());
+		if (reader.Error)
+			break;
+
+		switch (subChunk)
+		{
+		case EIRRBC_ATTRIBUTES:
+			if (node)
+			{
+				Attributes->clear();
+				readAttributes(data, Attributes);
+				node->deserializeAttributes(Attributes);
+			}
+			break;
+		case EIRRBC_MATERIALS:
+			readMaterials(data, node);
+			break;
+		case EIRRBC_ANIMATORS:
+			readAnimators(data, node);
+			break;
+		case EIRRBC_USERDATA:
+			readUserData(data, node, userDataSerializer);
+			break;
+		case EIRRBC_SCENE:
+		case EIRRBC_NODE:
+			readSceneNode(data, subChunk, node, userDataSerializer);
+			break;
+		default:
+			os::Printer::log("Found unknown chunk in binary scene file", core::stringc(subChunk).c_str());
+			break;
+		}
+	}
+
+	if (node && userDataSerializer)
+		userDataSerializer->OnCreateNode(node);
+}
+
+
+//! Creates a scene node from the factories
+ISceneNode* CSceneLoaderIrrb::createSceneNode(u32 type, u32 typeName, ISceneNode* parent)
+{
+	ISceneNode* node = 0;
+
+	// The type id avoids the name lookups of ISceneManager::addSceneNode.
+	// Nodes which don't report their own type are created by name.
+	if (type != ESNT_UNKNOWN)
+	{
+		for (s32 i=(s32)SceneManager->getRegisteredSceneNodeFactoryCount()-1; i>=0 && !node; --i)
+			node = SceneManager->getSceneNodeFactory(i)->addSceneNode((ESCENE_NODE_TYPE)type, parent);
+	}
+
+	if (!node)
+		node = SceneManager->addSceneNode(getString(typeName), parent);
+
+	return node;
+}
+
+
+//! Reads an attribute list into attr
+void CSceneLoaderIrrb::readAttributes(SReader& reader, io::IAttributes* attr)
+{
+	const u32 count = reader.readU32();
+
+	for (u32 i=0; i<count && !reader.Error; ++i)
+	{
+		const io::E_ATTRIBUTE_TYPE type = (io::E_ATTRIBUTE_TYPE)reader.readU8();
+		const c8* name = getString(reader.readU32());
+		SReader value = reader.subReader(reader.readU32());
+		if (reader.Error)
+			break;
+
+		switch (type)
+		{
+		case io::EAT_INT:
+			attr->addInt(name, value.readS32());
+			break;
+		case io::EAT_FLOAT:
+			attr->addFloat(name, value.readF32());
+			break;
+		case io::EAT_STRING:
+			attr->addString(name, getStringW(value.readU32()));
+			break;
+		case io::EAT_BOOL:
+			attr->addBool(name, value.readU8() != 0);
+			break;
+		case io::EAT_ENUM:
+			attr->addEnum(name, getString(value.readU32()), 0);
+			break;
+		case io::EAT_COLOR:
+			attr->addColor(name, video::SColor(value.readU32()));
+			break;
+		case io::EAT_COLORF:
+			{
+				video::SColorf c;
+				c.r = value.readF32();
+				c.g = value.readF32();
+				c.b = value.readF32();
+				c.a = value.readF32();
+				attr->addColorf(name, c);
+			}
+			break;
+		case io::EAT_VECTOR3D:
+			{
+				core::vector3df v;
+				v.X = value.readF32();
+				v.Y = value.readF32();
+				v.Z = value.readF32();
+				attr->addVector3d(name, v);
+			}
+			break;
+		case io::EAT_POSITION2D:
+			{
+				core::position2di p;
+				p.X = value.readS32();
+				p.Y = value.readS32();
+				attr->addPosition2d(name, p);
+			}
+			break;
+		case io::EAT_VECTOR2D:
+			{
+				core::vector2df v;
+				v.X = value.readF32();
+				v.Y = value.readF32();
+				attr->addVector2d(name, v);
+			}
+			break;
+		case io::EAT_RECT:
+			{
+				core::rect<s32> r;
+				r.UpperLeftCorner.X = value.readS32();
+				r.UpperLeftCorner.Y = value.readS32();
+				r.LowerRightCorner.X = value.readS32();
+				r.LowerRightCorner.Y = value.readS32();
+				attr->addRect(name, r);
+			}
+			break;
+		case io::EAT_MATRIX:
+			{
+				core::matrix4 m(core::matrix4::EM4CONST_NOTHING);
+				for (u32 k=0; k<16; ++k)
+					m[k] = value.readF32();
+				attr->addMatrix(name, m);
+			}
+			break;
+		case io::EAT_QUATERNION:
+			{
+				core::quaternion q;
+				q.X = value.readF32();
+				q.Y = value.readF32();
+				q.Z = value.readF32();
+				q.W = value.readF32();
+				attr->addQuaternion(name, q);
+			}
+			break;
+		case io::EAT_BBOX:
+			{
+				core::aabbox3df b;
+				b.MinEdge.X = value.readF32();
+				b.MinEdge.Y = value.readF32();
+				b.MinEdge.Z = value.readF32();
+				b.MaxEdge.X = value.readF32();
+				b.MaxEdge.Y = value.readF32();
+				b.MaxEdge.Z = value.readF32();
+				attr->addBox3d(name, b);
+			}
+			break;
+		case io::EAT_PLANE:
+			{
+				core::plane3df p;
+				p.Normal.X = value.readF32();
+				p.Normal.Y = value.readF32();
+				p.Normal.Z = value.readF32();
+				p.D = value.readF32();
+				attr->addPlane3d(name, p);
+			}
+			break;
+		case io::EAT_TRIANGLE3D:
+			{
+				core::triangle3df t;
+				t.pointA.X = value.readF32();
+				t.pointA.Y = value.readF32();
+				t.pointA.Z = value.readF32();
+				t.pointB.X = value.readF32();
+				t.pointB.Y = value.readF32();
+				t.pointB.Z = value.readF32();
+				t.pointC.X = value.readF32();
+				t.pointC.Y = value.readF32();
+				t.pointC.Z = value.readF32();
+				attr->addTriangle3d(name, t);
+			}
+			break;
+		case io::EAT_LINE2D:
+			{
+				core::line2df l;
+				l.start.X = value.readF32();
+				l.start.Y = value.readF32();
+				l.end.X = value.readF32();
+				l.end.Y = value.readF32();
+				attr->addLine2d(name, l);
+			}
+			break;
+		case io::EAT_LINE3D:
+			{
+				core::line3df l;
+				l.start.X = value.readF32();
+				l.start.Y = value.readF32();
+				l.start.Z = value.readF32();
+				l.end.X = value.readF32();
+				l.end.Y = value.readF32();
+				l.end.Z = value.readF32();
+				attr->addLine3d(name, l);
+			}
+			break;
+		case io::EAT_STRINGWARRAY:
+			{
+				const u32 size = value.readU32();
+				core::array<core::stringw> a(size < 1024 ? size : 1024);
+				for (u32 k=0; k<size && !value.Error; ++k)
+					a.push_back(getStringW(value.readU32()));
+				attr->addArray(name, a);
+			}
+			break;
+		case io::EAT_DIMENSION2D:
+			{
+				core::dimension2du d;
+				d.Width = value.readU32();
+				d.Height = value.readU32();
+				attr->addDimension2d(name, d);
+			}
+			break;
+		case io::EAT_BINARY:
+			// stored in their string form like in .irr files
+			attr->addBinary(name, 0, 0);
+			attr->setAttribute(attr->getAttributeCount()-1, getStringW(value.readU32()));
+			break;
+		case io::EAT_TEXTURE:
+			attr->addTexture(name, 0);
+			attr->setAttribute(attr->getAttributeCount()-1, getStringW(value.readU32()));
+			break;
+		default:
+			// unknown attributes are skipped
+			break;
+		}
+	}
+}
+
+
+//! reads materials of a node
+void CSceneLoaderIrrb::readMaterials(SReader& reader, ISceneNode* node)
+{
+	u32 nr = 0;
+
+	while (!reader.atEnd() && !reader.Error)
+	{
+		const u8 chunk = reader.readU8();
+		SReader data = reader.subReader(reader.readU32());
+		if (reader.Error || chunk != EIRRBC_ATTRIBUTES)
+			continue;
+
+		if (node && node->getMaterialCount() > nr)
+		{
+			Attributes->clear();
+			readAttributes(data, Attributes);
+			SceneManager->getVideoDriver()->fillMaterialStructureFromAttributes(
+				node->getMaterial(nr), Attributes);
+		}
+		++nr;
+	}
+}
+
+
+//! reads animators of a node
+void CSceneLoaderIrrb::readAnimators(SReader& reader, ISceneNode* node)
+{
+	while (!reader.atEnd() && !reader.Error)
+	{
+		const u8 chunk = reader.readU8();
+		SReader data = reader.subReader(reader.readU32());
+		if (reader.Error || chunk != EIRRBC_ATTRIBUTES || !node)
+			continue;
+
+		Attributes->clear();
+		readAttributes(data, Attributes);
+
+		core::stringc typeName = Attributes->getAttributeAsString("Type");
+		ISceneNodeAnimator* anim = SceneManager->createSceneNodeAnimator(typeName.c_str(), node);
+
+		if (anim)
+		{
+			anim->deserializeAttributes(Attributes);
+			anim->drop();
+		}
+	}
+}
+
+
+//! reads user data of a node
+void CSceneLoaderIrrb::readUserData(SReader& reader, ISceneNode* node,
+	ISceneUserDataSerializer* userDataSerializer)
+{
+	while (!reader.atEnd() && !reader.Error)
+	{
+		const u8 chunk = reader.readU8();
+		SReader data = reader.subReader(reader.readU32());
+		if (reader.Error || chunk != EIRRBC_ATTRIBUTES)
+			continue;
+
+		// user data gets its own attributes, the serializer may keep them
+		io::IAttributes* attr = FileSystem->createEmptyAttributes(SceneManager->getVideoDriver());
+		readAttributes(data, attr);
+
+		if (node && userDataSerializer)
+			userDataSerializer->OnReadUserData(node, attr);
+
+		attr->drop();
+	}
+}
+
+
+//! Returns a string from the string table
+const c8* CSceneLoaderIrrb::getString(u32 index) const
+{
+	return index < Strings.size() ? Strings[index] : "";
+}
+
+
+//! Returns a string from the string table converted to a wide string
+const wchar_t* CSceneLoaderIrrb::getStringW(u32 index)
+{
+	if (index >= Strings.size())
+		return L"";
+
+	const u32 length = StringLengths[index];
+	WideBuffer.set_used(length+1);
+	core::utf8ToWchar(Strings[index], WideBuffer.pointer(), (length+1)*sizeof(wchar_t));
+	return WideBuffer.const_pointer();
+}
+
+
+u8 CSceneLoaderIrrb::SReader::readU8()
+{
+	if (P+1 > End)
+	{
+		Error = true;
+		return 0;
+	}
+	return *P++;
+}
+
+
+u32 CSceneLoaderIrrb::SReader::readU32()
+{
+	if (P+4 > End)
+	{
+		Error = true;
+		P = End;
+		return 0;
+	}
+	const u32 value = P[0] | (P[1]<<8) | (P[2]<<16) | ((u32)P[3]<<24);
+	P += 4;
+	return value;
+}
+
+
+f32 CSceneLoaderIrrb::SReader::readF32()
+{
+	const u32 value = readU32();
+	return FR(value);
+}
+
+
+CSceneLoaderIrrb::SReader CSceneLoaderIrrb::SReader::subReader(u32 size)
+{
+	if (Error || size > (u32)(End-P))
+	{
+		Error = true;
+		P = End;
+		return SReader(End, End);
+	}
+	SReader sub(P, P+size);
+	P += size;
+	return sub;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_IRRB_SCENE_
@@ -0,0 +1,149 @@
+// Copyright (C) 2010-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_LOADER_IRRB_H_INCLUDED__
+#define __C_SCENE_LOADER_IRRB_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_IRRB_SCENE_
+
+#include "ISceneLoader.h"
+#include "irrArray.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+	class IFileSystem;
+	class IAttributes;
+}
+
+namespace scene
+{
+
+class ISceneManager;
+
+//! Magic number at the start of .irrb files
+const u32 IRRB_SCENE_MAGIC = MAKE_IRR_ID('I','R','R','B');
+
+//! Current version of the .irrb format
+const u32 IRRB_SCENE_VERSION = 1;
+
+//! Chunks of .irrb files
+/** A .irrb file contains the same information as an .irr file, but stores
+it binary. All numbers are little endian.
+The file starts with the magic number, the version and a table of all strings
+used in the file. Each string is stored as u32 length followed by the
+characters and a terminating 0. Wide strings are stored utf-8 encoded.
+Everywhere else strings are referenced by their index in this table.
+After the string table follows one EIRRBC_SCENE or EIRRBC_NODE chunk.
+Each chunk starts with an u8 id and the u32 size of the following data, so
+readers can skip chunks they don't know. */
+enum E_IRRB_CHUNK
+{
+	//! The scene root. Data: sub chunks
+	EIRRBC_SCENE = 1,
+
+	//! A scene node. Data: u32 ESCENE_NODE_TYPE, u32 type name, sub chunks
+	EIRRBC_NODE,
+
+	//! An attribute list. Data: u32 count, followed by count attributes.
+	/** Each attribute is stored as u8 E_ATTRIBUTE_TYPE, u32 name, u32 size
+	of the value and the value itself. */
+	EIRRBC_ATTRIBUTES,
+
+	//! Materials of a node. Data: one EIRRBC_ATTRIBUTES chunk per material
+	EIRRBC_MATERIALS,
+
+	//! Animators of a node. Data: one EIRRBC_ATTRIBUTES chunk per animator
+	EIRRBC_ANIMATORS,
+
+	//! User data of a node. Data: EIRRBC_ATTRIBUTES chunks
+	EIRRBC_USERDATA
+};
+
+//! Class which can load a binary .irrb scene into the scene manager.
+/** .irrb files are written by ISceneManager::saveScene when the filename
+has the extension .irrb */
+class CSceneLoaderIrrb : public virtual ISceneLoader
+{
+public:
+
+	//! Constructor
+	CSceneLoaderIrrb(ISceneManager *smgr, io::IFileSystem* fs);
+
+	//! Returns true if the class might be able to load this file.
+	virtual bool isALoadableFileExtension(const io::path& filename) const _IRR_OVERRIDE_;
+
+	//! Returns true if the class might be able to load this file.
+	virtual bool isALoadableFileFormat(io::IReadFile *file) const _IRR_OVERRIDE_;
+
+	//! Loads the scene into the scene manager.
+	virtual bool loadScene(io::IReadFile* file,
+		ISceneUserDataSerializer* userDataSerializer=0,
+		ISceneNode* rootNode=0) _IRR_OVERRIDE_;
+
+private:
+
+	//! Bounds checked read position inside the file data
+	struct SReader
+	{
+		SReader(const u8* begin, const u8* end) : P(begin), End(end), Error(false) {}
+
+		u8 readU8();
+		u32 readU32();
+		s32 readS32() { return (s32)readU32(); }
+		f32 readF32();
+
+		//! Returns a reader for the next size bytes and skips them
+		SReader subReader(u32 size);
+
+		bool atEnd() const { return P >= End; }
+
+		const u8* P;
+		const u8* End;
+		bool Error;
+	};
+
+	//! Reads a node chunk and all its children
+	void readSceneNode(SReader& reader, u8 chunk, ISceneNode* parent,
+		ISceneUserDataSerializer* userDataSerializer);
+
+	//! Creates a scene node from the factories
+	ISceneNode* createSceneNode(u32 type, u32 typeName, ISceneNode* parent);
+
+	//! Reads an attribute list into attr
+	void readAttributes(SReader& reader, io::IAttributes* attr);
+
+	//! Reads all attribute chunks in the data of a materials, animators or user data chunk
+	void readMaterials(SReader& reader, ISceneNode* node);
+	void readAnimators(SReader& reader, ISceneNode* node);
+	void readUserData(SReader& reader, ISceneNode* node,
+		ISceneUserDataSerializer* userDataSerializer);
+
+	//! Returns a string from the string table
+	const c8* getString(u32 index) const;
+
+	//! Returns a string from the string table converted to a wide string
+	const wchar_t* getStringW(u32 index);
+
+	ISceneManager* SceneManager;
+	io::IFileSystem* FileSystem;
+
+	core::array<u8> Data;
+	core::array<const c8*> Strings;
+	core::array<u32> StringLengths;
+	core::array<wchar_t> WideBuffer;
+	io::IAttributes* Attributes;
+};
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_IRRB_SCENE_
+
+#endif
@@ -17,6 +17,8 @@
 #include "ISceneLoader.h"
 #include "EProfileIDs.h"
 #include "IProfiler.h"
+#include "FrustumBoxCulling.h"
+#include "irrHash.h"
 
 #include "os.h"
 
@@ -114,6 +116,11 @@
 #include "CSceneLoaderIrr.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_IRRB_SCENE_
+#include "CSceneLoaderIrrb.h"
+#include "CSceneWriterIrrb.h"
+#endif
+
 #ifdef _IRR_COMPILE_WITH_COLLADA_WRITER_
 #include "CColladaMeshWriter.h"
 #endif
@@ -144,8 +151,12 @@
 #include "COctreeSceneNode.h"
 #include "CCameraSceneNode.h"
 #include "CLightSceneNode.h"
+#include "CGridLightManager.h"
 #include "CBillboardSceneNode.h"
 #include "CMeshSceneNode.h"
+#include "CInstancedMeshSceneNode.h"
+#include "CLODMeshSceneNode.h"
+#include "CClusteredMeshSceneNode.h"
 #include "CSkyBoxSceneNode.h"
 #include "CSkyDomeSceneNode.h"
 
@@ -311,6 +322,9 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	#ifdef _IRR_COMPILE_WITH_IRR_SCENE_LOADER_
 	SceneLoaderList.push_back(new CSceneLoaderIrr(this, FileSystem));
 	#endif
+	#ifdef _IRR_COMPILE_WITH_IRRB_SCENE_
+	SceneLoaderList.push_back(new CSceneLoaderIrrb(this, FileSystem));
+	#endif
 
 	// factories
 	ISceneNodeFactory* factory = new CDefaultSceneNodeFactory(this);
@@ -632,6 +646,63 @@ IMeshSceneNode* CSceneManager::addMeshSceneNode(IMesh* mesh, ISceneNode* parent,
 }
 
 
+//! adds a scene node for rendering many instances of a static mesh
+//! the returned pointer must not be dropped.
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, bool alsoAddIfMeshPointerZero)
+{
+	if (!alsoAddIfMeshPointerZero && !mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
+//! adds a scene node for rendering a static mesh with levels of detail
+//! the returned pointer must not be dropped.
+ILODMeshSceneNode* CSceneManager::addLODMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, bool alsoAddIfMeshPointerZero)
+{
+	if (!alsoAddIfMeshPointerZero && !mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	ILODMeshSceneNode* node = new CLODMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
+//! adds a scene node for rendering the visible clusters of a large static mesh
+//! the returned pointer must not be dropped.
+IClusteredMeshSceneNode* CSceneManager::addClusteredMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, bool alsoAddIfMeshPointerZero)
+{
+	if (!alsoAddIfMeshPointerZero && !mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	IClusteredMeshSceneNode* node = new CClusteredMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
 //! Adds a scene node for rendering a animated water surface mesh.
 ISceneNode* CSceneManager::addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 waveLength,
 	ISceneNode* parent, s32 id, const core::vector3df& position,
@@ -1223,40 +1294,185 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 	// can be seen by cam pyramid planes ?
 	if (!result && (node->getAutomaticCulling() & scene::EAC_FRUSTUM_BOX))
 	{
-		SViewFrustum frust = *cam->getViewFrustum();
+		// already tested by cullFrustumBoxes
+		const s32 batched = getFrustumBoxResult(node);
+		if (batched >= 0)
+		{
+			result = batched != 0;
+		}
+		else
+		{
+			SViewFrustum frust = *cam->getViewFrustum();
 
-		//transform the frustum to the node's current absolute transformation
-		core::matrix4 invTrans(node->getAbsoluteTransformation(), core::matrix4::EM4CONST_INVERSE);
-		//invTrans.makeInverse();
-		frust.transform(invTrans);
+			//transform the frustum to the node's current absolute transformation
+			core::matrix4 invTrans(node->getAbsoluteTransformation(), core::matrix4::EM4CONST_INVERSE);
+			//invTrans.makeInverse();
+			frust.transform(invTrans);
 
-		core::vector3df edges[8];
-		node->getBoundingBox().getEdges(edges);
+			core::vector3df edges[8];
+			node->getBoundingBox().getEdges(edges);
 
-		for (s32 i=0; i<scene::SViewFrustum::VF_PLANE_COUNT; ++i)
-		{
-			bool boxInFrustum=false;
-			for (u32 j=0; j<8; ++j)
+			for (s32 i=0; i<scene::SViewFrustum::VF_PLANE_COUNT; ++i)
 			{
-				if (frust.planes[i].classifyPointRelation(edges[j]) != core::ISREL3D_FRONT)
+				bool boxInFrustum=false;
+				for (u32 j=0; j<8; ++j)
 				{
-					boxInFrustum=true;
-					break;
+					if (frust.planes[i].classifyPointRelation(edges[j]) != core::ISREL3D_FRONT)
+					{
+						boxInFrustum=true;
+						break;
+					}
 				}
-			}
 
-			if (!boxInFrustum)
-			{
-				result = true;
-				break;
+				if (!boxInFrustum)
+				{
+					result = true;
+					break;
+				}
 			}
 		}
 	}
 
+	// hidden behind occluders ?
+	if (!result && (node->getAutomaticCulling() & scene::EAC_OCC_SOFTWARE))
+	{
+		result = OcclusionCuller.isOccluded(node->getBoundingBox(), node->getAbsoluteTransformation());
+	}
+
 	return result;
 }
 
 
+//! Adds an occluder for software occlusion culling
+void CSceneManager::addOccluder(ISceneNode* node, const IMesh* mesh)
+{
+	if (!node)
+		return;
+	if (!mesh)
+	{
+		const ESCENE_NODE_TYPE type = node->getType();
+		if (type == ESNT_MESH || type == ESNT_OCTREE || type == ESNT_CUBE || type == ESNT_SPHERE)
+			mesh = static_cast<IMeshSceneNode*>(node)->getMesh();
+		else if (type == ESNT_ANIMATED_MESH && static_cast<IAnimatedMeshSceneNode*>(node)->getMesh())
+			mesh = static_cast<IAnimatedMeshSceneNode*>(node)->getMesh()->getMesh(0);
+		if (!mesh)
+			return;
+	}
+	OcclusionCuller.addOccluder(node, mesh);
+}
+
+
+//! Removes the occluder of a scene node
+void CSceneManager::removeOccluder(ISceneNode* node)
+{
+	OcclusionCuller.removeOccluder(node);
+}
+
+
+//! Removes all occluders
+void CSceneManager::removeAllOccluders()
+{
+	OcclusionCuller.removeAllOccluders();
+}
+
+
+//! Tests all visible nodes using EAC_FRUSTUM_BOX against the frustum of the active camera at once
+void CSceneManager::cullFrustumBoxes()
+{
+	clearFrustumBoxes();
+
+	const ICameraSceneNode* cam = getActiveCamera();
+	if (!cam)
+		return;
+
+	collectFrustumBoxes(this);
+
+	const u32 count = FrustumBoxes.size();
+	if (!count)
+		return;
+
+	// oriented boxes in world space
+	FrustumBoxData.set_used(count*12);
+	f32* data = FrustumBoxData.pointer();
+	for (u32 i=0; i<count; ++i)
+		setOrientedBox(data, count, i, FrustumBoxes[i].Transformation, FrustumBoxes[i].Box);
+
+	FrustumBoxCulled.set_used(count);
+	cullOrientedBoxes(*cam->getViewFrustum(), data, count, FrustumBoxCulled.pointer());
+
+	// index for isCulled, at most half full
+	u32 size = 32;
+	while (size < count*2)
+		size <<= 1;
+	FrustumBoxIndex.set_used(size);
+	for (u32 i=0; i<size; ++i)
+		FrustumBoxIndex[i] = -1;
+	const u32 mask = size - 1;
+	for (u32 i=0; i<count; ++i)
+	{
+		u32 h = core::hashPointer(FrustumBoxes[i].Node) & mask;
+		while (FrustumBoxIndex[h] >= 0)
+			h = (h + 1) & mask;
+		FrustumBoxIndex[h] = (s32)i;
+	}
+}
+
+
+//! adds node and its visible children to the nodes tested by cullFrustumBoxes
+void CSceneManager::collectFrustumBoxes(ISceneNode* node)
+{
+	const ISceneNodeList& children = node->getChildren();
+	for (ISceneNodeList::ConstIterator it = children.begin(); it != children.end(); ++it)
+	{
+		ISceneNode* child = *it;
+		if (!child->isVisible())
+			continue;
+
+		if (child->getAutomaticCulling() & scene::EAC_FRUSTUM_BOX)
+		{
+			FrustumBoxEntry entry;
+			entry.Node = child;
+			entry.Transformation = child->getAbsoluteTransformation();
+			entry.Box = child->getBoundingBox();
+			FrustumBoxes.push_back(entry);
+		}
+
+		collectFrustumBoxes(child);
+	}
+}
+
+
+//! forgets the results of cullFrustumBoxes
+void CSceneManager::clearFrustumBoxes()
+{
+	FrustumBoxes.set_used(0);
+	FrustumBoxIndex.set_used(0);
+}
+
+
+//! returns 1 if cullFrustumBoxes culled the node, 0 if not and -1 if it has no valid result for the node
+s32 CSceneManager::getFrustumBoxResult(const ISceneNode* node) const
+{
+	if (FrustumBoxIndex.empty())
+		return -1;
+
+	const u32 mask = FrustumBoxIndex.size() - 1;
+	for (u32 h = core::hashPointer(node) & mask; FrustumBoxIndex[h] >= 0; h = (h + 1) & mask)
+	{
+		const u32 i = (u32)FrustumBoxIndex[h];
+		if (FrustumBoxes[i].Node == node)
+		{
+			// node was moved or changed its box since the test
+			if (FrustumBoxes[i].Transformation != node->getAbsoluteTransformation() ||
+				!(FrustumBoxes[i].Box == node->getBoundingBox()))
+				return -1;
+			return FrustumBoxCulled[i];
+		}
+	}
+	return -1;
+}
+
+
 //! registers a node for rendering it at a specific time.
 u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
 {
@@ -1432,9 +1648,19 @@ void CSceneManager::drawAll()
 	}
 	IRR_PROFILE(getProfiler().stop(EPID_SM_RENDER_CAMERAS));
 
+	// test the frustum boxes of all nodes at once, results are used while the nodes register
+	cullFrustumBoxes();
+
+	// draw the occluders for EAC_OCC_SOFTWARE
+	if (OcclusionCuller.hasOccluders())
+		OcclusionCuller.render(ActiveCamera, this);
+
 	// let all nodes register themselves
 	OnRegisterSceneNode();
 
+	clearFrustumBoxes();
+	OcclusionCuller.clear();
+
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
 
@@ -1683,6 +1909,13 @@ void CSceneManager::setLightManager(ILightManager* lightManager)
 }
 
 
+//! Creates a light manager which lights each scene node with the most relevant lights.
+ILightManager* CSceneManager::createGridLightManager(u32 lightsPerNode, f32 cellSize)
+{
+	return new CGridLightManager(this, lightsPerNode, cellSize);
+}
+
+
 //! Sets the color of stencil buffers shadows drawn by the scene manager.
 void CSceneManager::setShadowColor(video::SColor color)
 {
@@ -2059,6 +2292,7 @@ bool CSceneManager::postEventFromUser(const SEvent& event)
 //! Removes all children of this scene node
 void CSceneManager::removeAll()
 {
+	removeAllOccluders();
 	ISceneNode::removeAll();
 	setActiveCamera(0);
 	// Make sure the driver is reset, might need a more complex method at some point
@@ -2202,6 +2436,15 @@ bool CSceneManager::saveScene(io::IWriteFile* file, ISceneUserDataSerializer* us
 		return false;
 	}
 
+#ifdef _IRR_COMPILE_WITH_IRRB_SCENE_
+	if (core::hasFileExtension(file->getFileName(), "irrb"))
+	{
+		CSceneWriterIrrb writer(this, FileSystem);
+		return writer.writeScene(file, node ? node : this, userDataSerializer,
+			FileSystem->getFileDir(FileSystem->getAbsolutePath(file->getFileName())).c_str());
+	}
+#endif
+
 	bool result=false;
 	io::IXMLWriter* writer = FileSystem->createXMLWriter(file);
 	if (!writer)
@@ -12,6 +12,7 @@
 #include "irrArray.h"
 #include "IMeshLoader.h"
 #include "CAttributes.h"
+#include "COcclusionCuller.h"
 #include "ILightManager.h"
 
 namespace irr
@@ -97,6 +98,30 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
 
+		//! adds a scene node for rendering many instances of a static mesh
+		//! the returned pointer must not be dropped.
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
+
+		//! adds a scene node for rendering a static mesh with levels of detail
+		//! the returned pointer must not be dropped.
+		virtual ILODMeshSceneNode* addLODMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
+
+		//! adds a scene node for rendering the visible clusters of a large static mesh
+		//! the returned pointer must not be dropped.
+		virtual IClusteredMeshSceneNode* addClusteredMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) _IRR_OVERRIDE_;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		virtual ISceneNode* addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 wlength, ISceneNode* parent=0, s32 id=-1,
 			const core::vector3df& position = core::vector3df(0,0,0),
@@ -520,6 +545,9 @@ namespace scene
 		//! Register a custom callbacks manager which gets callbacks during scene rendering.
 		virtual void setLightManager(ILightManager* lightManager) _IRR_OVERRIDE_;
 
+		//! Creates a light manager which lights each scene node with the most relevant lights.
+		virtual ILightManager* createGridLightManager(u32 lightsPerNode=0, f32 cellSize=0.f) _IRR_OVERRIDE_;
+
 		//! Get current render time.
 		virtual E_SCENE_NODE_RENDER_PASS getCurrentRenderPass() const _IRR_OVERRIDE_ { return CurrentRenderPass; }
 
@@ -532,6 +560,15 @@ namespace scene
 		//! returns if node is culled
 		virtual bool isCulled(const ISceneNode* node) const _IRR_OVERRIDE_;
 
+		//! Adds an occluder for software occlusion culling
+		virtual void addOccluder(ISceneNode* node, const IMesh* mesh=0) _IRR_OVERRIDE_;
+
+		//! Removes the occluder of a scene node
+		virtual void removeOccluder(ISceneNode* node) _IRR_OVERRIDE_;
+
+		//! Removes all occluders
+		virtual void removeAllOccluders() _IRR_OVERRIDE_;
+
 	private:
 
 		// load and create a mesh which we know already isn't in the cache and put it in there
@@ -543,6 +580,19 @@ namespace scene
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
+		//! Tests all visible nodes using EAC_FRUSTUM_BOX against the frustum of the active camera at once
+		/** The results are used by isCulled until clearFrustumBoxes is called. */
+		void cullFrustumBoxes();
+
+		//! adds node and its visible children to the nodes tested by cullFrustumBoxes
+		void collectFrustumBoxes(ISceneNode* node);
+
+		//! forgets the results of cullFrustumBoxes
+		void clearFrustumBoxes();
+
+		//! returns 1 if cullFrustumBoxes culled the node, 0 if not and -1 if it has no valid result for the node
+		s32 getFrustumBoxResult(const ISceneNode* node) const;
+
 		struct DefaultNodeEntry
 		{
 			DefaultNodeEntry(ISceneNode* n) :
@@ -607,6 +657,15 @@ namespace scene
 			f64 Distance;
 		};
 
+		//! node tested by cullFrustumBoxes
+		/** Transformation and box are kept to notice nodes changed after the test. */
+		struct FrustumBoxEntry
+		{
+			const ISceneNode* Node;
+			core::matrix4 Transformation;
+			core::aabbox3df Box;
+		};
+
 		//! video driver
 		video::IVideoDriver* Driver;
 
@@ -631,6 +690,15 @@ namespace scene
 		core::array<TransparentNodeEntry> TransparentNodeList;
 		core::array<TransparentNodeEntry> TransparentEffectNodeList;
 
+		//! nodes tested by cullFrustumBoxes
+		core::array<FrustumBoxEntry> FrustumBoxes;
+		//! oriented boxes of FrustumBoxes as 12 arrays: center xyz, then the three half axes xyz
+		core::array<f32> FrustumBoxData;
+		//! results of cullFrustumBoxes, 1 for culled nodes
+		core::array<u8> FrustumBoxCulled;
+		//! hash table over node pointers into FrustumBoxes, -1 for empty slots
+		core::array<s32> FrustumBoxIndex;
+
 		core::array<IMeshLoader*> MeshLoaderList;
 		core::array<ISceneLoader*> SceneLoaderList;
 		core::array<ISceneNode*> DeletionList;
@@ -657,6 +725,9 @@ namespace scene
 		//! over the scene lighting and rendering.
 		ILightManager* LightManager;
 
+		//! draws the occluders for EAC_OCC_SOFTWARE
+		COcclusionCuller OcclusionCuller;
+
 		//! constants for reading and writing XML.
 		//! Not made static due to portability problems.
 		const core::stringw IRR_XML_FORMAT_SCENE;
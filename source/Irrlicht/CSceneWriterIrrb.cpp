@@ -0,0 +1,436 @@
+// Copyright (C) 2010-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneWriterIrrb.h"
+
+#ifdef _IRR_COMPILE_WITH_IRRB_SCENE_
+
+#include "CSceneLoaderIrrb.h"
+#include "ISceneManager.h"
+#include "ISceneUserDataSerializer.h"
+#include "IVideoDriver.h"
+#include "IFileSystem.h"
+#include "IWriteFile.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Constructor
+CSceneWriterIrrb::CSceneWriterIrrb(ISceneManager* smgr, io::IFileSystem* fs)
+	: SceneManager(smgr), FileSystem(fs)
+{
+}
+
+
+//! Writes the scene below node, or the whole scene if node is the root scene node
+bool CSceneWriterIrrb::writeScene(io::IWriteFile* file, ISceneNode* node,
+	ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath)
+{
+	if (!file || !node)
+		return false;
+
+	io::SAttributeReadWriteOptions options;
+	if (currentPath)
+	{
+		options.Filename=currentPath;
+		options.Flags|=io::EARWF_USE_RELATIVE_PATHS;
+	}
+
+	Data.clear();
+	Strings.clear();
+	StringIndices.clear();
+
+	writeSceneNode(node, userDataSerializer, &options, true);
+
+	// header and string table are written once all strings are known
+	core::array<u8> header;
+	writeU32(header, IRRB_SCENE_MAGIC);
+	writeU32(header, IRRB_SCENE_VERSION);
+	writeU32(header, Strings.size());
+	for (u32 i=0; i<Strings.size(); ++i)
+	{
+		writeU32(header, Strings[i].size());
+		for (u32 k=0; k<=Strings[i].size(); ++k)
+			writeU8(header, (u8)Strings[i].c_str()[k]);
+	}
+
+	const bool result = file->write(header.const_pointer(), header.size()) == header.size() &&
+		file->write(Data.const_pointer(), Data.size()) == Data.size();
+	if (!result)
+		os::Printer::log("Could not write binary scene file", file->getFileName(), ELL_ERROR);
+
+	Data.clear();
+	Strings.clear();
+	StringIndices.clear();
+	return result;
+}
+
+
+//! Appends a node chunk and the chunks of all children
+void CSceneWriterIrrb::writeSceneNode(ISceneNode* node, ISceneUserDataSerializer* userDataSerializer,
+	io::SAttributeReadWriteOptions* options, bool init)
+{
+	if (!node || node->isDebugObject())
+		return;
+
+	ISceneNode* root = SceneManager->getRootSceneNode();
+	ISceneNode* tmpNode = node;
+	u32 chunk;
+
+	if (init)
+	{
+		chunk = beginChunk(EIRRBC_SCENE);
+		node = root;
+	}
+	else
+	{
+		chunk = beginChunk(EIRRBC_NODE);
+		writeU32(node->getType());
+		writeU32(addString(SceneManager->getSceneNodeTypeName(node->getType())));
+	}
+
+	// write properties
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	io::IAttributes* attr = FileSystem->createEmptyAttributes(driver);
+	node->serializeAttributes(attr, options);
+
+	if (attr->getAttributeCount() != 0)
+		writeAttributes(attr);
+
+	// write materials
+
+	if (node->getMaterialCount() && driver)
+	{
+		const u32 materials = beginChunk(EIRRBC_MATERIALS);
+
+		for (u32 i=0; i < node->getMaterialCount(); ++i)
+		{
+			io::IAttributes* tmp_attr =
+				driver->createAttributesFromMaterial(node->getMaterial(i), options);
+			writeAttributes(tmp_attr);
+			tmp_attr->drop();
+		}
+
+		endChunk(materials);
+	}
+
+	// write animators
+
+	if (!node->getAnimators().empty())
+	{
+		const u32 animators = beginChunk(EIRRBC_ANIMATORS);
+
+		ISceneNodeAnimatorList::ConstIterator it = node->getAnimators().begin();
+		for (; it != node->getAnimators().end(); ++it)
+		{
+			attr->clear();
+			attr->addString("Type", SceneManager->getAnimatorTypeName((*it)->getType()));
+
+			(*it)->serializeAttributes(attr);
+
+			writeAttributes(attr);
+		}
+
+		endChunk(animators);
+	}
+
+	// write possible user data
+
+	if (userDataSerializer)
+	{
+		io::IAttributes* userData = userDataSerializer->createUserData(node);
+		if (userData)
+		{
+			const u32 userDataChunk = beginChunk(EIRRBC_USERDATA);
+			writeAttributes(userData);
+			endChunk(userDataChunk);
+
+			userData->drop();
+		}
+	}
+
+	attr->drop();
+
+	// reset to actual root node
+	if (init)
+		node=tmpNode;
+
+	// write children once root node is written
+	// if parent is not the root, we need to write out node first
+	if (init && (node != root))
+	{
+		writeSceneNode(node, userDataSerializer, options);
+	}
+	else
+	{
+		ISceneNodeList::ConstIterator it = node->getChildren().begin();
+		for (; it != node->getChildren().end(); ++it)
+			writeSceneNode((*it), userDataSerializer, options);
+	}
+
+	endChunk(chunk);
+}
+
+
+//! Appends an attributes chunk
+void CSceneWriterIrrb::writeAttributes(io::IAttributes* attr)
+{
+	const u32 chunk = beginChunk(EIRRBC_ATTRIBUTES);
+	const u32 countPosition = Data.size();
+	writeU32(0);
+
+	u32 count = 0;
+	for (u32 i=0; i<attr->getAttributeCount(); ++i)
+	{
+		const io::E_ATTRIBUTE_TYPE type = attr->getAttributeType(i);
+
+		// user pointers are not loaded from .irr files either
+		if (type == io::EAT_USER_POINTER || type >= io::EAT_COUNT)
+			continue;
+
+		writeU8(Data, (u8)type);
+		writeU32(addString(attr->getAttributeName(i)));
+		const u32 sizePosition = Data.size();
+		writeU32(0);
+
+		switch (type)
+		{
+		case io::EAT_INT:
+			writeU32((u32)attr->getAttributeAsInt(i));
+			break;
+		case io::EAT_FLOAT:
+			writeF32(attr->getAttributeAsFloat(i));
+			break;
+		case io::EAT_STRING:
+			writeU32(addStringW(attr->getAttributeAsStringW(i)));
+			break;
+		case io::EAT_BOOL:
+			writeU8(Data, attr->getAttributeAsBool(i) ? 1 : 0);
+			break;
+		case io::EAT_ENUM:
+			writeU32(addString(attr->getAttributeAsEnumeration(i)));
+			break;
+		case io::EAT_COLOR:
+			writeU32(attr->getAttributeAsColor(i).color);
+			break;
+		case io::EAT_COLORF:
+			{
+				const video::SColorf c = attr->getAttributeAsColorf(i);
+				writeF32(c.r);
+				writeF32(c.g);
+				writeF32(c.b);
+				writeF32(c.a);
+			}
+			break;
+		case io::EAT_VECTOR3D:
+			{
+				const core::vector3df v = attr->getAttributeAsVector3d(i);
+				writeF32(v.X);
+				writeF32(v.Y);
+				writeF32(v.Z);
+			}
+			break;
+		case io::EAT_POSITION2D:
+			{
+				const core::position2di p = attr->getAttributeAsPosition2d(i);
+				writeU32((u32)p.X);
+				writeU32((u32)p.Y);
+			}
+			break;
+		case io::EAT_VECTOR2D:
+			{
+				const core::vector2df v = attr->getAttributeAsVector2d(i);
+				writeF32(v.X);
+				writeF32(v.Y);
+			}
+			break;
+		case io::EAT_RECT:
+			{
+				const core::rect<s32> r = attr->getAttributeAsRect(i);
+				writeU32((u32)r.UpperLeftCorner.X);
+				writeU32((u32)r.UpperLeftCorner.Y);
+				writeU32((u32)r.LowerRightCorner.X);
+				writeU32((u32)r.LowerRightCorner.Y);
+			}
+			break;
+		case io::EAT_MATRIX:
+			{
+				const core::matrix4 m = attr->getAttributeAsMatrix(i);
+				for (u32 k=0; k<16; ++k)
+					writeF32(m[k]);
+			}
+			break;
+		case io::EAT_QUATERNION:
+			{
+				const core::quaternion q = attr->getAttributeAsQuaternion(i);
+				writeF32(q.X);
+				writeF32(q.Y);
+				writeF32(q.Z);
+				writeF32(q.W);
+			}
+			break;
+		case io::EAT_BBOX:
+			{
+				const core::aabbox3df b = attr->getAttributeAsBox3d(i);
+				writeF32(b.MinEdge.X);
+				writeF32(b.MinEdge.Y);
+				writeF32(b.MinEdge.Z);
+				writeF32(b.MaxEdge.X);
+				writeF32(b.MaxEdge.Y);
+				writeF32(b.MaxEdge.Z);
+			}
+			break;
+		case io::EAT_PLANE:
+			{
+				const core::plane3df p = attr->getAttributeAsPlane3d(i);
+				writeF32(p.Normal.X);
+				writeF32(p.Normal.Y);
+				writeF32(p.Normal.Z);
+				writeF32(p.D);
+			}
+			break;
+		case io::EAT_TRIANGLE3D:
+			{
+				const core::triangle3df t = attr->getAttributeAsTriangle3d(i);
+				writeF32(t.pointA.X);
+				writeF32(t.pointA.Y);
+				writeF32(t.pointA.Z);
+				writeF32(t.pointB.X);
+				writeF32(t.pointB.Y);
+				writeF32(t.pointB.Z);
+				writeF32(t.pointC.X);
+				writeF32(t.pointC.Y);
+				writeF32(t.pointC.Z);
+			}
+			break;
+		case io::EAT_LINE2D:
+			{
+				const core::line2df l = attr->getAttributeAsLine2d(i);
+				writeF32(l.start.X);
+				writeF32(l.start.Y);
+				writeF32(l.end.X);
+				writeF32(l.end.Y);
+			}
+			break;
+		case io::EAT_LINE3D:
+			{
+				const core::line3df l = attr->getAttributeAsLine3d(i);
+				writeF32(l.start.X);
+				writeF32(l.start.Y);
+				writeF32(l.start.Z);
+				writeF32(l.end.X);
+				writeF32(l.end.Y);
+				writeF32(l.end.Z);
+			}
+			break;
+		case io::EAT_STRINGWARRAY:
+			{
+				const core::array<core::stringw> a = attr->getAttributeAsArray(i);
+				writeU32(a.size());
+				for (u32 k=0; k<a.size(); ++k)
+					writeU32(addStringW(a[k]));
+			}
+			break;
+		case io::EAT_DIMENSION2D:
+			{
+				const core::dimension2du d = attr->getAttributeAsDimension2d(i);
+				writeU32(d.Width);
+				writeU32(d.Height);
+			}
+			break;
+		default:
+			// binary data, textures and other types are stored in their string form like in .irr files
+			writeU32(addStringW(attr->getAttributeAsStringW(i)));
+			break;
+		}
+
+		patchU32(sizePosition, Data.size() - sizePosition - 4);
+		++count;
+	}
+
+	patchU32(countPosition, count);
+	endChunk(chunk);
+}
+
+
+//! Appends the id and a placeholder for the size of a chunk
+u32 CSceneWriterIrrb::beginChunk(u8 chunk)
+{
+	writeU8(Data, chunk);
+	const u32 sizePosition = Data.size();
+	writeU32(0);
+	return sizePosition;
+}
+
+
+//! Fills in the size of the data written since beginChunk
+void CSceneWriterIrrb::endChunk(u32 sizePosition)
+{
+	patchU32(sizePosition, Data.size() - sizePosition - 4);
+}
+
+
+//! Overwrites a placeholder written before
+void CSceneWriterIrrb::patchU32(u32 position, u32 value)
+{
+	Data[position] = (u8)value;
+	Data[position+1] = (u8)(value>>8);
+	Data[position+2] = (u8)(value>>16);
+	Data[position+3] = (u8)(value>>24);
+}
+
+
+void CSceneWriterIrrb::writeU8(core::array<u8>& out, u8 value)
+{
+	out.push_back(value);
+}
+
+
+void CSceneWriterIrrb::writeU32(core::array<u8>& out, u32 value)
+{
+	out.push_back((u8)value);
+	out.push_back((u8)(value>>8));
+	out.push_back((u8)(value>>16));
+	out.push_back((u8)(value>>24));
+}
+
+
+void CSceneWriterIrrb::writeF32(f32 value)
+{
+	writeU32(IR(value));
+}
+
+
+//! Returns the index of a string in the string table, adds it if necessary
+u32 CSceneWriterIrrb::addString(const c8* str)
+{
+	const core::stringc s(str ? str : "");
+	core::map<core::stringc, u32>::Node* n = StringIndices.find(s);
+	if (n)
+		return n->getValue();
+
+	const u32 index = Strings.size();
+	Strings.push_back(s);
+	StringIndices.insert(s, index);
+	return index;
+}
+
+
+u32 CSceneWriterIrrb::addStringW(const core::stringw& str)
+{
+	const u32 size = str.size()*4+1;
+	Utf8Buffer.set_used(size);
+	core::wcharToUtf8(str.c_str(), Utf8Buffer.pointer(), size);
+	return addString(Utf8Buffer.const_pointer());
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_IRRB_SCENE_
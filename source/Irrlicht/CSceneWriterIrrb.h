@@ -0,0 +1,90 @@
+// Copyright (C) 2010-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_WRITER_IRRB_H_INCLUDED__
+#define __C_SCENE_WRITER_IRRB_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_IRRB_SCENE_
+
+#include "irrArray.h"
+#include "irrString.h"
+#include "irrMap.h"
+#include "path.h"
+
+namespace irr
+{
+
+namespace io
+{
+	class IFileSystem;
+	class IWriteFile;
+	class IAttributes;
+	struct SAttributeReadWriteOptions;
+}
+
+namespace scene
+{
+
+class ISceneManager;
+class ISceneNode;
+class ISceneUserDataSerializer;
+
+//! Writes a scene into a binary .irrb file.
+/** Writes the same data as the .irr scene writer of CSceneManager.
+See E_IRRB_CHUNK for the file layout. */
+class CSceneWriterIrrb
+{
+public:
+
+	//! Constructor
+	CSceneWriterIrrb(ISceneManager* smgr, io::IFileSystem* fs);
+
+	//! Writes the scene below node, or the whole scene if node is the root scene node
+	bool writeScene(io::IWriteFile* file, ISceneNode* node,
+		ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath);
+
+private:
+
+	//! Appends a node chunk and the chunks of all children
+	void writeSceneNode(ISceneNode* node, ISceneUserDataSerializer* userDataSerializer,
+		io::SAttributeReadWriteOptions* options, bool init=false);
+
+	//! Appends an attributes chunk
+	void writeAttributes(io::IAttributes* attr);
+
+	//! Appends the id and a placeholder for the size of a chunk
+	u32 beginChunk(u8 chunk);
+
+	//! Fills in the size of the data written since beginChunk
+	void endChunk(u32 sizePosition);
+
+	//! Overwrites a placeholder written before
+	void patchU32(u32 position, u32 value);
+
+	void writeU8(core::array<u8>& out, u8 value);
+	void writeU32(core::array<u8>& out, u32 value);
+	void writeF32(f32 value);
+	void writeU32(u32 value) { writeU32(Data, value); }
+
+	//! Returns the index of a string in the string table, adds it if necessary
+	u32 addString(const c8* str);
+	u32 addStringW(const core::stringw& str);
+
+	ISceneManager* SceneManager;
+	io::IFileSystem* FileSystem;
+
+	core::array<u8> Data;
+	core::array<core::stringc> Strings;
+	core::map<core::stringc, u32> StringIndices;
+	core::array<c8> Utf8Buffer;
+};
+
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_IRRB_SCENE_
+
+#endif
@@ -10,8 +10,30 @@
 #include "IAnimatedMeshSceneNode.h"
 #include "os.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
 namespace
 {
+	// Binary search for the first key at or after a frame, keys are sorted by frame
+	// return -1 if all keys are before the frame
+	template <class T> // T = objects containing a "frame" variable
+	irr::s32 findKey(const irr::core::array<T>& keys, irr::f32 frame)
+	{
+		irr::u32 first = 0;
+		irr::u32 last = keys.size();
+		while (first < last)
+		{
+			const irr::u32 middle = first + (last - first) / 2;
+			if (keys[middle].frame < frame)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+		return first < keys.size() ? (irr::s32)first : -1;
+	}
+
 	// Frames must always be increasing, so we remove objects where this isn't the case
 	// return number of kicked keys
 	template <class T> // T = objects containing a "frame" variable
@@ -82,6 +104,255 @@ namespace
 	{
 		return a.rotation == b.rotation;
 	}
+
+	// quantized range of the smallest three quaternion components
+	const irr::f32 ROTATION_RANGE = 0.70710678f;
+	const irr::f32 ROTATION_STEPS = 32767.f;
+
+	// stores the three smallest components of a rotation with 15 bit each,
+	// the 2 bit index of the largest one is in the high bits of the first two
+	void encodeRotation(irr::core::quaternion rotation, irr::u16* out)
+	{
+		rotation.normalize();
+		irr::f32 c[4] = { rotation.X, rotation.Y, rotation.Z, rotation.W };
+
+		irr::u32 largest = 0;
+		for (irr::u32 i=1; i<4; ++i)
+		{
+			if (irr::core::abs_(c[i]) > irr::core::abs_(c[largest]))
+				largest = i;
+		}
+		// q and -q are the same rotation, so the largest one is positive
+		if (c[largest] < 0.f)
+		{
+			for (irr::u32 i=0; i<4; ++i)
+				c[i] = -c[i];
+		}
+
+		irr::u32 n = 0;
+		for (irr::u32 i=0; i<4; ++i)
+		{
+			if (i == largest)
+				continue;
+			const irr::f32 v = (c[i] / ROTATION_RANGE + 1.f) * 0.5f * ROTATION_STEPS;
+			out[n++] = (irr::u16)irr::core::clamp(irr::core::round32(v), 0, (irr::s32)ROTATION_STEPS);
+		}
+		out[0] |= (largest & 1) << 15;
+		out[1] |= (largest >> 1) << 15;
+	}
+
+	void decodeRotation(const irr::u16* in, irr::core::quaternion& rotation)
+	{
+		// components stored for each index of the largest one
+		static const irr::u8 stored[4][3] = { {1,2,3}, {0,2,3}, {0,1,3}, {0,1,2} };
+		const irr::u32 largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+		irr::f32 c[4];
+		irr::f32 sum = 0.f;
+		for (irr::u32 i=0; i<3; ++i)
+		{
+			const irr::f32 v = ((in[i] & 0x7fff) * (2.f / ROTATION_STEPS) - 1.f) * ROTATION_RANGE;
+			c[stored[largest][i]] = v;
+			sum += v * v;
+		}
+		c[largest] = irr::core::squareroot(irr::core::max_(1.f - sum, 0.f));
+		rotation.set(c[0], c[1], c[2], c[3]);
+	}
+
+	// interpolates two rows of quantized values and scales them back into their range
+	void dequantize(const irr::u16* a, const irr::u16* b, irr::f32 t,
+		const irr::f32* step, const irr::f32* min, irr::f32* out, irr::u32 count)
+	{
+		irr::u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 vt = _mm_set1_ps(t);
+		for (; i+8<=count; i+=8)
+		{
+			const __m128i qa = _mm_loadu_si128((const __m128i*)(a+i));
+			const __m128i qb = _mm_loadu_si128((const __m128i*)(b+i));
+			for (irr::u32 half=0; half<2; ++half)
+			{
+				const __m128 fa = _mm_cvtepi32_ps(half ? _mm_unpackhi_epi16(qa, zero) : _mm_unpacklo_epi16(qa, zero));
+				const __m128 fb = _mm_cvtepi32_ps(half ? _mm_unpackhi_epi16(qb, zero) : _mm_unpacklo_epi16(qb, zero));
+				const irr::u32 j = i + half*4;
+				__m128 v = _mm_add_ps(fa, _mm_mul_ps(_mm_sub_ps(fb, fa), vt));
+				v = _mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(step+j)), _mm_loadu_ps(min+j));
+				_mm_storeu_ps(out+j, v);
+			}
+		}
+#endif
+		for (; i<count; ++i)
+		{
+			const irr::f32 fa = (irr::f32)a[i];
+			const irr::f32 fb = (irr::f32)b[i];
+			out[i] = (fa + (fb - fa) * t) * step[i] + min[i];
+		}
+	}
+
+	// streams of a pose in structure of arrays layout, see CSkinnedMesh::E_POSE_STREAM
+	const irr::u32 POSE_VECTORS = 6;
+	const irr::u32 POSE_ROTATION = 6;
+
+	// adds a pose to a weighted sum, the rotations are flipped into the same hemisphere
+	void accumulatePose(irr::f32* sum, const irr::f32* pose, const irr::f32* weights, irr::u32 stride)
+	{
+		irr::f32* sq = sum + POSE_ROTATION*stride;
+		const irr::f32* pq = pose + POSE_ROTATION*stride;
+		irr::u32 j = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		const __m128 signBit = _mm_set1_ps(-0.f);
+		for (; j<stride; j+=4)
+		{
+			const __m128 w = _mm_loadu_ps(weights+j);
+			for (irr::u32 s=0; s<POSE_VECTORS; ++s)
+				_mm_storeu_ps(sum+s*stride+j, _mm_add_ps(_mm_loadu_ps(sum+s*stride+j), _mm_mul_ps(w, _mm_loadu_ps(pose+s*stride+j))));
+
+			__m128 dot = _mm_mul_ps(_mm_loadu_ps(sq+j), _mm_loadu_ps(pq+j));
+			for (irr::u32 c=1; c<4; ++c)
+				dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(sq+c*stride+j), _mm_loadu_ps(pq+c*stride+j)));
+			const __m128 signedWeight = _mm_xor_ps(w, _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), signBit));
+			for (irr::u32 c=0; c<4; ++c)
+				_mm_storeu_ps(sq+c*stride+j, _mm_add_ps(_mm_loadu_ps(sq+c*stride+j), _mm_mul_ps(signedWeight, _mm_loadu_ps(pq+c*stride+j))));
+		}
+#endif
+		for (; j<stride; ++j)
+		{
+			const irr::f32 w = weights[j];
+			for (irr::u32 s=0; s<POSE_VECTORS; ++s)
+				sum[s*stride+j] += w * pose[s*stride+j];
+
+			irr::f32 dot = sq[j] * pq[j];
+			for (irr::u32 c=1; c<4; ++c)
+				dot += sq[c*stride+j] * pq[c*stride+j];
+			const irr::f32 signedWeight = dot < 0.f ? -w : w;
+			for (irr::u32 c=0; c<4; ++c)
+				sq[c*stride+j] += signedWeight * pq[c*stride+j];
+		}
+	}
+
+	// divides a weighted sum by the weights and normalizes the rotations
+	void normalizePose(irr::f32* pose, const irr::f32* weights, irr::u32 stride)
+	{
+		irr::f32* q = pose + POSE_ROTATION*stride;
+		irr::u32 j = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		for (; j<stride; j+=4)
+		{
+			const __m128 w = _mm_loadu_ps(weights+j);
+			const __m128 used = _mm_cmpgt_ps(w, zero);
+			const __m128 invWeight = _mm_and_ps(used, _mm_div_ps(one, _mm_or_ps(w, _mm_andnot_ps(used, one))));
+			for (irr::u32 s=0; s<POSE_VECTORS; ++s)
+				_mm_storeu_ps(pose+s*stride+j, _mm_mul_ps(_mm_loadu_ps(pose+s*stride+j), invWeight));
+
+			__m128 length = _mm_mul_ps(_mm_loadu_ps(q+j), _mm_loadu_ps(q+j));
+			for (irr::u32 c=1; c<4; ++c)
+				length = _mm_add_ps(length, _mm_mul_ps(_mm_loadu_ps(q+c*stride+j), _mm_loadu_ps(q+c*stride+j)));
+			const __m128 valid = _mm_cmpgt_ps(length, zero);
+			const __m128 invLength = _mm_and_ps(valid, _mm_div_ps(one, _mm_sqrt_ps(_mm_or_ps(length, _mm_andnot_ps(valid, one)))));
+			for (irr::u32 c=0; c<4; ++c)
+				_mm_storeu_ps(q+c*stride+j, _mm_mul_ps(_mm_loadu_ps(q+c*stride+j), invLength));
+		}
+#endif
+		for (; j<stride; ++j)
+		{
+			const irr::f32 invWeight = weights[j] > 0.f ? 1.f / weights[j] : 0.f;
+			for (irr::u32 s=0; s<POSE_VECTORS; ++s)
+				pose[s*stride+j] *= invWeight;
+
+			irr::f32 length = q[j] * q[j];
+			for (irr::u32 c=1; c<4; ++c)
+				length += q[c*stride+j] * q[c*stride+j];
+			const irr::f32 invLength = length > 0.f ? 1.f / sqrtf(length) : 0.f;
+			for (irr::u32 c=0; c<4; ++c)
+				q[c*stride+j] *= invLength;
+		}
+	}
+
+	// adds the weighted difference between a pose and its reference pose,
+	// rotations are multiplied with the weighted rotation from the reference to the pose
+	void addPose(irr::f32* result, const irr::f32* pose, const irr::f32* reference, const irr::f32* weights, irr::u32 stride)
+	{
+		irr::f32* q = result + POSE_ROTATION*stride;
+		const irr::f32* p = pose + POSE_ROTATION*stride;
+		const irr::f32* r = reference + POSE_ROTATION*stride;
+		irr::u32 j = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.f);
+		const __m128 signBit = _mm_set1_ps(-0.f);
+		for (; j<stride; j+=4)
+		{
+			const __m128 w = _mm_loadu_ps(weights+j);
+			for (irr::u32 s=0; s<POSE_VECTORS; ++s)
+			{
+				const __m128 difference = _mm_sub_ps(_mm_loadu_ps(pose+s*stride+j), _mm_loadu_ps(reference+s*stride+j));
+				_mm_storeu_ps(result+s*stride+j, _mm_add_ps(_mm_loadu_ps(result+s*stride+j), _mm_mul_ps(w, difference)));
+			}
+
+			// delta = conjugate(reference) * pose
+			const __m128 rx = _mm_xor_ps(_mm_loadu_ps(r+j), signBit);
+			const __m128 ry = _mm_xor_ps(_mm_loadu_ps(r+stride+j), signBit);
+			const __m128 rz = _mm_xor_ps(_mm_loadu_ps(r+2*stride+j), signBit);
+			const __m128 rw = _mm_loadu_ps(r+3*stride+j);
+			const __m128 px = _mm_loadu_ps(p+j);
+			const __m128 py = _mm_loadu_ps(p+stride+j);
+			const __m128 pz = _mm_loadu_ps(p+2*stride+j);
+			const __m128 pw = _mm_loadu_ps(p+3*stride+j);
+			__m128 dw = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(pw, rw), _mm_mul_ps(px, rx)), _mm_mul_ps(py, ry)), _mm_mul_ps(pz, rz));
+			__m128 dx = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(pw, rx), _mm_mul_ps(px, rw)), _mm_mul_ps(py, rz)), _mm_mul_ps(pz, ry));
+			__m128 dy = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(pw, ry), _mm_mul_ps(py, rw)), _mm_mul_ps(pz, rx)), _mm_mul_ps(px, rz));
+			__m128 dz = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(pw, rz), _mm_mul_ps(pz, rw)), _mm_mul_ps(px, ry)), _mm_mul_ps(py, rx));
+
+			// shortest way, weighted from the identity and normalized
+			const __m128 weight = _mm_xor_ps(w, _mm_and_ps(_mm_cmplt_ps(dw, zero), signBit));
+			dx = _mm_mul_ps(dx, weight);
+			dy = _mm_mul_ps(dy, weight);
+			dz = _mm_mul_ps(dz, weight);
+			dw = _mm_add_ps(_mm_sub_ps(one, w), _mm_mul_ps(dw, weight));
+			const __m128 length = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)), _mm_mul_ps(dw, dw));
+			const __m128 valid = _mm_cmpgt_ps(length, zero);
+			const __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_or_ps(_mm_and_ps(valid, length), _mm_andnot_ps(valid, one))));
+			dx = _mm_mul_ps(dx, invLength);
+			dy = _mm_mul_ps(dy, invLength);
+			dz = _mm_mul_ps(dz, invLength);
+			dw = _mm_mul_ps(dw, invLength);
+
+			// result = result * delta
+			const __m128 qx = _mm_loadu_ps(q+j);
+			const __m128 qy = _mm_loadu_ps(q+stride+j);
+			const __m128 qz = _mm_loadu_ps(q+2*stride+j);
+			const __m128 qw = _mm_loadu_ps(q+3*stride+j);
+			_mm_storeu_ps(q+j, _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dw, qx), _mm_mul_ps(dx, qw)), _mm_mul_ps(dy, qz)), _mm_mul_ps(dz, qy)));
+			_mm_storeu_ps(q+stride+j, _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dw, qy), _mm_mul_ps(dy, qw)), _mm_mul_ps(dz, qx)), _mm_mul_ps(dx, qz)));
+			_mm_storeu_ps(q+2*stride+j, _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dw, qz), _mm_mul_ps(dz, qw)), _mm_mul_ps(dx, qy)), _mm_mul_ps(dy, qx)));
+			_mm_storeu_ps(q+3*stride+j, _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(dw, qw), _mm_mul_ps(dx, qx)), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+		}
+#endif
+		for (; j<stride; ++j)
+		{
+			const irr::f32 w = weights[j];
+			for (irr::u32 s=0; s<POSE_VECTORS; ++s)
+				result[s*stride+j] += w * (pose[s*stride+j] - reference[s*stride+j]);
+
+			const irr::core::quaternion inverse(-r[j], -r[stride+j], -r[2*stride+j], r[3*stride+j]);
+			irr::core::quaternion delta = inverse * irr::core::quaternion(p[j], p[stride+j], p[2*stride+j], p[3*stride+j]);
+
+			const irr::f32 weight = delta.W < 0.f ? -w : w;
+			delta.set(delta.X * weight, delta.Y * weight, delta.Z * weight, (1.f - w) + delta.W * weight);
+			const irr::f32 length = delta.X * delta.X + delta.Y * delta.Y + delta.Z * delta.Z + delta.W * delta.W;
+			const irr::f32 invLength = 1.f / sqrtf(length > 0.f ? length : 1.f);
+			delta.set(delta.X * invLength, delta.Y * invLength, delta.Z * invLength, delta.W * invLength);
+
+			const irr::core::quaternion rotation = irr::core::quaternion(q[j], q[stride+j], q[2*stride+j], q[3*stride+j]) * delta;
+			q[j] = rotation.X;
+			q[stride+j] = rotation.Y;
+			q[2*stride+j] = rotation.Z;
+			q[3*stride+j] = rotation.W;
+		}
+	}
 };
 
 namespace irr
@@ -92,8 +363,8 @@ namespace scene
 
 //! constructor
 CSkinnedMesh::CSkinnedMesh()
-: SkinningBuffers(0), EndFrame(0.f), FramesPerSecond(25.f),
-	LastAnimatedFrame(-1), SkinnedLastFrame(false),
+: SkinningBuffers(0), AnimationSource(0), AnimationUsers(0), EndFrame(0.f), FramesPerSecond(25.f),
+	LastAnimatedFrame(-1), PoseStride(0), SkinnedLastFrame(false),
 	InterpolationMode(EIM_LINEAR),
 	HasAnimation(false), PreparedForSkinning(false),
 	AnimateNormals(true), HardwareSkinning(false)
@@ -109,6 +380,12 @@ CSkinnedMesh::CSkinnedMesh()
 //! destructor
 CSkinnedMesh::~CSkinnedMesh()
 {
+	if (AnimationSource)
+	{
+		--AnimationSource->AnimationUsers;
+		AnimationSource->drop();
+	}
+
 	for (u32 i=0; i<AllJoints.size(); ++i)
 		delete AllJoints[i];
 
@@ -176,6 +453,9 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 	if (blend<=0.f)
 		return; //No need to animate
 
+	if (Baked.SampleCount)
+		sampleBakedAnimation(frame);
+
 	for (u32 i=0; i<AllJoints.size(); ++i)
 	{
 		//The joints can be animated here with no input from their
@@ -191,10 +471,7 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 		core::vector3df scale = oldScale;
 		core::quaternion rotation = oldRotation;
 
-		getFrameData(frame, joint,
-				position, joint->positionHint,
-				scale, joint->scaleHint,
-				rotation, joint->rotationHint);
+		getJointFrame(i, frame, position, scale, rotation, true);
 
 		if (blend==1.0f)
 		{
@@ -226,18 +503,175 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 }
 
 
+//! Gets the transformation of a joint at a frame, the baked samples must be at this frame
+void CSkinnedMesh::getJointFrame(u32 i, f32 frame, core::vector3df& position,
+		core::vector3df& scale, core::quaternion& rotation, bool useHints)
+{
+	if (Baked.SampleCount)
+	{
+		const u8 channels = Baked.Channels[i];
+		const f32* pose = Baked.Pose.const_pointer() + i*3;
+		if (channels & EBC_POSITION)
+			position.set(pose[0], pose[1], pose[2]);
+		if (channels & EBC_SCALE)
+			scale.set(pose[AllJoints.size()*3], pose[AllJoints.size()*3+1], pose[AllJoints.size()*3+2]);
+		if (channels & EBC_ROTATION)
+			rotation = Baked.Rotations[i];
+	}
+	else if (useHints)
+	{
+		SJoint *joint = AllJoints[i];
+		getFrameData(frame, joint,
+				position, joint->positionHint,
+				scale, joint->scaleHint,
+				rotation, joint->rotationHint);
+	}
+	else
+	{
+		// the hints belong to the frame of animateMesh, searching the keys leaves them alone
+		s32 positionHint = -1;
+		s32 scaleHint = -1;
+		s32 rotationHint = -1;
+		getFrameData(frame, AllJoints[i],
+				position, positionHint,
+				scale, scaleHint,
+				rotation, rotationHint);
+	}
+}
+
+
+//! Animates the joints with a blend of several layers
+void CSkinnedMesh::animateMeshLayers(const SAnimationLayer* layers, u32 layerCount)
+{
+	if (!HasAnimation)
+		return;
+
+	// the next call of animateMesh has to sample its frame again
+	LastAnimatedFrame=-1;
+	SkinnedLastFrame=false;
+
+	const u32 jointCount = AllJoints.size();
+	const u32 stride = (jointCount + 3) & ~3;
+	PoseStride = stride;
+	BlendPose.set_used(stride * EPS_COUNT);
+	LayerPose.set_used(stride * EPS_COUNT);
+	ReferencePose.set_used(stride * EPS_COUNT);
+	LayerWeights.set_used(stride);
+	BlendWeights.set_used(stride);
+
+	// padding joints keep a weight of 0
+	for (u32 j=0; j<stride * EPS_COUNT; ++j)
+		BlendPose[j] = LayerPose[j] = ReferencePose[j] = 0.f;
+	for (u32 j=0; j<stride; ++j)
+		BlendWeights[j] = LayerWeights[j] = 0.f;
+
+	// weighted sum of all layers which are not additive
+	for (u32 l=0; l<layerCount; ++l)
+	{
+		if (layers[l].Additive || !setLayerWeights(layers[l]))
+			continue;
+
+		samplePose(layers[l].Frame, LayerPose.pointer());
+		accumulatePose(BlendPose.pointer(), LayerPose.const_pointer(), LayerWeights.const_pointer(), stride);
+		for (u32 j=0; j<jointCount; ++j)
+			BlendWeights[j] += LayerWeights[j];
+	}
+	normalizePose(BlendPose.pointer(), BlendWeights.const_pointer(), stride);
+
+	// joints without weight keep their current transformation
+	for (u32 j=0; j<jointCount; ++j)
+	{
+		if (BlendWeights[j] > 0.f)
+			continue;
+
+		const SJoint *joint = AllJoints[j];
+		storePose(BlendPose.pointer(), stride, j, joint->Animatedposition, joint->Animatedscale, joint->Animatedrotation);
+	}
+
+	// additive layers add their difference to the reference frame in the given order
+	for (u32 l=0; l<layerCount; ++l)
+	{
+		if (!layers[l].Additive || !setLayerWeights(layers[l]))
+			continue;
+
+		samplePose(layers[l].Frame, LayerPose.pointer());
+		samplePose(layers[l].ReferenceFrame, ReferencePose.pointer());
+		addPose(BlendPose.pointer(), LayerPose.const_pointer(), ReferencePose.const_pointer(),
+			LayerWeights.const_pointer(), stride);
+	}
+
+	const f32* pose = BlendPose.const_pointer();
+	for (u32 j=0; j<jointCount; ++j)
+	{
+		SJoint *joint = AllJoints[j];
+		joint->Animatedposition.set(pose[EPS_POSITION_X*stride+j], pose[EPS_POSITION_Y*stride+j], pose[EPS_POSITION_Z*stride+j]);
+		joint->Animatedscale.set(pose[EPS_SCALE_X*stride+j], pose[EPS_SCALE_Y*stride+j], pose[EPS_SCALE_Z*stride+j]);
+		joint->Animatedrotation.set(pose[EPS_ROTATION_X*stride+j], pose[EPS_ROTATION_Y*stride+j],
+			pose[EPS_ROTATION_Z*stride+j], pose[EPS_ROTATION_W*stride+j]);
+	}
+
+	buildAllLocalAnimatedMatrices();
+	updateBoundingBox();
+}
+
+
+//! Writes the transformation of a joint into a pose
+void CSkinnedMesh::storePose(f32* pose, u32 stride, u32 j, const core::vector3df& position,
+		const core::vector3df& scale, const core::quaternion& rotation)
+{
+	pose[EPS_POSITION_X*stride+j] = position.X;
+	pose[EPS_POSITION_Y*stride+j] = position.Y;
+	pose[EPS_POSITION_Z*stride+j] = position.Z;
+	pose[EPS_SCALE_X*stride+j] = scale.X;
+	pose[EPS_SCALE_Y*stride+j] = scale.Y;
+	pose[EPS_SCALE_Z*stride+j] = scale.Z;
+	pose[EPS_ROTATION_X*stride+j] = rotation.X;
+	pose[EPS_ROTATION_Y*stride+j] = rotation.Y;
+	pose[EPS_ROTATION_Z*stride+j] = rotation.Z;
+	pose[EPS_ROTATION_W*stride+j] = rotation.W;
+}
+
+
+//! Sets LayerWeights for a layer, returns false if no joint has a weight
+bool CSkinnedMesh::setLayerWeights(const SAnimationLayer& layer)
+{
+	bool used = false;
+	for (u32 j=0; j<AllJoints.size(); ++j)
+	{
+		const f32 weight = layer.JointWeights ? layer.Weight * layer.JointWeights[j] : layer.Weight;
+		LayerWeights[j] = core::max_(weight, 0.f);
+		if (weight > 0.f)
+			used = true;
+	}
+	return used;
+}
+
+
+//! Samples the transformation of all joints at a frame into a pose
+void CSkinnedMesh::samplePose(f32 frame, f32* pose)
+{
+	if (Baked.SampleCount)
+		sampleBakedAnimation(frame);
+
+	for (u32 j=0; j<AllJoints.size(); ++j)
+	{
+		const SJoint *joint = AllJoints[j];
+		core::vector3df position = joint->Animatedposition;
+		core::vector3df scale = joint->Animatedscale;
+		core::quaternion rotation = joint->Animatedrotation;
+		getJointFrame(j, frame, position, scale, rotation, false);
+		storePose(pose, PoseStride, j, position, scale, rotation);
+	}
+}
+
+
 void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 {
 	for (u32 i=0; i<AllJoints.size(); ++i)
 	{
 		SJoint *joint = AllJoints[i];
 
-		//Could be faster:
-
-		if (joint->UseAnimationFrom &&
-			(joint->UseAnimationFrom->PositionKeys.size() ||
-			 joint->UseAnimationFrom->ScaleKeys.size() ||
-			 joint->UseAnimationFrom->RotationKeys.size() ))
+		if (isJointAnimated(i))
 		{
 			joint->GlobalSkinningSpace=false;
 
@@ -262,7 +696,7 @@ void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 			m1[14] += Pos.Z*m1[15];
 			// -----------------------------------
 
-			if (joint->ScaleKeys.size())
+			if (isJointScaled(i))
 			{
 				/*
 				core::matrix4 scaleMatrix;
@@ -296,6 +730,27 @@ void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 }
 
 
+//! Returns if the local matrix of a joint is animated
+bool CSkinnedMesh::isJointAnimated(u32 i) const
+{
+	if (Baked.SampleCount)
+		return (Baked.Channels[i] & (EBC_POSITION | EBC_SCALE | EBC_ROTATION)) != 0;
+
+	const SJoint *from = AllJoints[i]->UseAnimationFrom;
+	return from && (from->PositionKeys.size() || from->ScaleKeys.size() || from->RotationKeys.size());
+}
+
+
+//! Returns if the local matrix of a joint is scaled
+bool CSkinnedMesh::isJointScaled(u32 i) const
+{
+	if (Baked.SampleCount)
+		return (Baked.Channels[i] & EBC_OWN_SCALE) != 0;
+
+	return AllJoints[i]->ScaleKeys.size() != 0;
+}
+
+
 void CSkinnedMesh::buildAllGlobalAnimatedMatrices(SJoint *joint, SJoint *parentJoint)
 {
 	if (!joint)
@@ -355,18 +810,12 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 				}
 			}
 
-			//The hint test failed, do a full scan...
+			//The hint test failed, search all keys...
 			if (foundPositionIndex==-1)
 			{
-				for (u32 i=0; i<PositionKeys.size(); ++i)
-				{
-					if (PositionKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundPositionIndex=i;
-						positionHint=i;
-						break;
-					}
-				}
+				foundPositionIndex=findKey(PositionKeys, frame);
+				if (foundPositionIndex!=-1)
+					positionHint=foundPositionIndex;
 			}
 
 			//Do interpolation...
@@ -413,18 +862,12 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 			}
 
 
-			//The hint test failed, do a full scan...
+			//The hint test failed, search all keys...
 			if (foundScaleIndex==-1)
 			{
-				for (u32 i=0; i<ScaleKeys.size(); ++i)
-				{
-					if (ScaleKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundScaleIndex=i;
-						scaleHint=i;
-						break;
-					}
-				}
+				foundScaleIndex=findKey(ScaleKeys, frame);
+				if (foundScaleIndex!=-1)
+					scaleHint=foundScaleIndex;
 			}
 
 			//Do interpolation...
@@ -471,18 +914,12 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 			}
 
 
-			//The hint test failed, do a full scan...
+			//The hint test failed, search all keys...
 			if (foundRotationIndex==-1)
 			{
-				for (u32 i=0; i<RotationKeys.size(); ++i)
-				{
-					if (RotationKeys[i].frame >= frame) //Keys should be sorted by frame
-					{
-						foundRotationIndex=i;
-						rotationHint=i;
-						break;
-					}
-				}
+				foundRotationIndex=findKey(RotationKeys, frame);
+				if (foundRotationIndex!=-1)
+					rotationHint=foundRotationIndex;
 			}
 
 			//Do interpolation...
@@ -723,6 +1160,32 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 {
 	bool unmatched=false;
 
+	if (mesh->isAnimationBaked())
+	{
+		os::Printer::log("Can't use the animation of a mesh with a baked animation, it has no keys.", ELL_WARNING);
+		return false;
+	}
+
+	// the other mesh is kept and can't bake its keys away while they are used
+	const CSkinnedMesh* source = (mesh == this) ? 0 : static_cast<const CSkinnedMesh*>(mesh);
+	if (source != AnimationSource)
+	{
+		if (source)
+		{
+			source->grab();
+			++source->AnimationUsers;
+		}
+		if (AnimationSource)
+		{
+			--AnimationSource->AnimationUsers;
+			AnimationSource->drop();
+		}
+		AnimationSource = source;
+	}
+
+	// the baked samples belong to the old animation
+	Baked = SBakedAnimation();
+
 	for(u32 i=0;i<AllJoints.size();++i)
 	{
 		SJoint *joint=AllJoints[i];
@@ -865,6 +1328,10 @@ void CSkinnedMesh::checkForAnimation()
 		}
 	}
 
+	// the keys were removed when baking, the samples keep the animation
+	if (Baked.SampleCount)
+		HasAnimation = true;
+
 	//meshes with weights, are still counted as animated for ragdolls, etc
 	if (!HasAnimation)
 	{
@@ -875,7 +1342,7 @@ void CSkinnedMesh::checkForAnimation()
 		}
 	}
 
-	if (HasAnimation)
+	if (HasAnimation && !Baked.SampleCount)
 	{
 		//--- Find the length of the animation ---
 		EndFrame=0;
@@ -1261,6 +1728,206 @@ bool CSkinnedMesh::isStatic()
 }
 
 
+//! Bakes the animation keys into compressed samples
+bool CSkinnedMesh::bakeAnimation(f32 samplesPerFrame)
+{
+	if (samplesPerFrame <= 0.f)
+		return false;
+
+	if (AnimationUsers)
+	{
+		os::Printer::log("Can't bake an animation which other meshes use, it would remove their keys.", ELL_WARNING);
+		return false;
+	}
+
+	const u32 jointCount = AllJoints.size();
+	SBakedAnimation baked;
+	baked.SamplesPerFrame = samplesPerFrame;
+	baked.Channels.set_used(jointCount);
+
+	bool animated = false;
+	for (u32 i=0; i<jointCount; ++i)
+	{
+		const SJoint *from = AllJoints[i]->UseAnimationFrom;
+		u8 channels = 0;
+		if (from && from->PositionKeys.size())
+			channels |= EBC_POSITION;
+		if (from && from->ScaleKeys.size())
+			channels |= EBC_SCALE;
+		if (from && from->RotationKeys.size())
+			channels |= EBC_ROTATION;
+		if (channels)
+			animated = true;
+		if (AllJoints[i]->ScaleKeys.size())
+			channels |= EBC_OWN_SCALE;
+		baked.Channels[i] = channels;
+	}
+	if (!animated)
+		return false;
+
+	baked.SampleCount = core::ceil32(EndFrame * samplesPerFrame) + 1;
+
+	// evaluate the keys for all samples, one joint after the other so the hints stay valid
+	const u32 valueCount = baked.SampleCount * jointCount;
+	core::array<core::vector3df> positions;
+	core::array<core::vector3df> scales;
+	core::array<core::quaternion> rotations;
+	positions.set_used(valueCount);
+	scales.set_used(valueCount);
+	rotations.set_used(valueCount);
+
+	for (u32 i=0; i<jointCount; ++i)
+	{
+		SJoint *joint = AllJoints[i];
+		s32 positionHint = -1;
+		s32 scaleHint = -1;
+		s32 rotationHint = -1;
+		core::vector3df position;
+		core::vector3df scale(1.f, 1.f, 1.f);
+		core::quaternion rotation;
+
+		for (u32 s=0; s<baked.SampleCount; ++s)
+		{
+			getFrameData(core::min_(s / samplesPerFrame, EndFrame), joint,
+				position, positionHint, scale, scaleHint, rotation, rotationHint);
+			positions[s*jointCount+i] = position;
+			scales[s*jointCount+i] = scale;
+			rotations[s*jointCount+i] = rotation;
+		}
+	}
+
+	// constant components are set once, the others get a lane in the samples
+	baked.Pose.set_used(jointCount*6);
+	for (u32 c=0; c<jointCount*6; ++c)
+	{
+		const u32 joint = (c % (jointCount*3)) / 3;
+		const bool isScale = c >= jointCount*3;
+		const core::array<core::vector3df>& values = isScale ? scales : positions;
+
+		f32 low = (&values[joint].X)[c % 3];
+		f32 high = low;
+		for (u32 s=1; s<baked.SampleCount; ++s)
+		{
+			const f32 v = (&values[s*jointCount+joint].X)[c % 3];
+			low = core::min_(low, v);
+			high = core::max_(high, v);
+		}
+
+		baked.Pose[c] = low;
+		if (low != high && (baked.Channels[joint] & (isScale ? EBC_SCALE : EBC_POSITION)))
+		{
+			baked.Lanes.push_back(c);
+			baked.Min.push_back(low);
+			baked.Step.push_back((high - low) / 65535.f);
+		}
+	}
+
+	baked.Rotations.set_used(jointCount);
+	for (u32 i=0; i<jointCount; ++i)
+	{
+		baked.Rotations[i] = rotations[i];
+		baked.Rotations[i].normalize();
+		if (!(baked.Channels[i] & EBC_ROTATION))
+			continue;
+
+		for (u32 s=1; s<baked.SampleCount; ++s)
+		{
+			if (!(rotations[s*jointCount+i] == rotations[i]))
+			{
+				baked.RotatingJoints.push_back(i);
+				break;
+			}
+		}
+	}
+
+	// quantize the lanes and rotations of each sample
+	const u32 laneCount = baked.Lanes.size();
+	baked.SampleSize = laneCount + baked.RotatingJoints.size()*3;
+	baked.Samples.set_used(baked.SampleCount * baked.SampleSize);
+	for (u32 s=0; s<baked.SampleCount; ++s)
+	{
+		u16* sample = baked.Samples.pointer() + s*baked.SampleSize;
+		for (u32 l=0; l<laneCount; ++l)
+		{
+			const u32 c = baked.Lanes[l];
+			const u32 joint = (c % (jointCount*3)) / 3;
+			const core::vector3df& v = c >= jointCount*3 ? scales[s*jointCount+joint] : positions[s*jointCount+joint];
+			const s32 q = core::round32(((&v.X)[c % 3] - baked.Min[l]) / baked.Step[l]);
+			sample[l] = (u16)core::clamp(q, 0, 65535);
+		}
+		for (u32 r=0; r<baked.RotatingJoints.size(); ++r)
+			encodeRotation(rotations[s*jointCount+baked.RotatingJoints[r]], sample + laneCount + r*3);
+	}
+	baked.Values.set_used(laneCount);
+
+	// the samples replace the keys
+	for (u32 i=0; i<jointCount; ++i)
+	{
+		AllJoints[i]->PositionKeys.clear();
+		AllJoints[i]->ScaleKeys.clear();
+		AllJoints[i]->RotationKeys.clear();
+	}
+
+	Baked = baked;
+	HasAnimation = true;
+	LastAnimatedFrame = -1;
+	SkinnedLastFrame = false;
+	return true;
+}
+
+
+//! Returns if the animation was baked
+bool CSkinnedMesh::isAnimationBaked() const
+{
+	return Baked.SampleCount != 0;
+}
+
+
+//! Decompresses the baked samples around a frame
+void CSkinnedMesh::sampleBakedAnimation(f32 frame)
+{
+	const f32 position = core::clamp(frame, 0.f, EndFrame) * Baked.SamplesPerFrame;
+	u32 first = core::min_((u32)core::floor32(position), Baked.SampleCount-1);
+	f32 t = position - first;
+	if (InterpolationMode == EIM_CONSTANT)
+	{
+		// like the keys, the next sample is used until it is reached
+		if (t > 0.f && first+1 < Baked.SampleCount)
+			++first;
+		t = 0.f;
+	}
+	const u32 second = core::min_(first+1, Baked.SampleCount-1);
+	if (second == first)
+		t = 0.f;
+
+	const u16* a = Baked.Samples.const_pointer() + first * Baked.SampleSize;
+	const u16* b = Baked.Samples.const_pointer() + second * Baked.SampleSize;
+
+	const u32 laneCount = Baked.Lanes.size();
+	dequantize(a, b, t, Baked.Step.const_pointer(), Baked.Min.const_pointer(), Baked.Values.pointer(), laneCount);
+	for (u32 l=0; l<laneCount; ++l)
+		Baked.Pose[Baked.Lanes[l]] = Baked.Values[l];
+
+	for (u32 r=0; r<Baked.RotatingJoints.size(); ++r)
+	{
+		core::quaternion& rotation = Baked.Rotations[Baked.RotatingJoints[r]];
+		decodeRotation(a + laneCount + r*3, rotation);
+		if (t == 0.f)
+			continue;
+
+		// the samples are close, so a normalized lerp is enough
+		core::quaternion next;
+		decodeRotation(b + laneCount + r*3, next);
+		const f32 s = rotation.dotProduct(next) < 0.f ? -t : t;
+		rotation.set(rotation.X + (next.X * s - rotation.X * t),
+			rotation.Y + (next.Y * s - rotation.Y * t),
+			rotation.Z + (next.Z * s - rotation.Z * t),
+			rotation.W + (next.W * s - rotation.W * t));
+		rotation.normalize();
+	}
+}
+
+
 void CSkinnedMesh::normalizeWeights()
 {
 	// note: unsure if weights ids are going to be used.
@@ -51,6 +51,9 @@ namespace scene
 		//! blend: {0-old position, 1-New position}
 		virtual void animateMesh(f32 frame, f32 blend) _IRR_OVERRIDE_;
 
+		//! Animates the joints with a blend of several layers
+		virtual void animateMeshLayers(const SAnimationLayer* layers, u32 layerCount) _IRR_OVERRIDE_;
+
 		//! Preforms a software skin on this mesh based of joint positions
 		virtual void skinMesh() _IRR_OVERRIDE_;
 
@@ -104,6 +107,12 @@ namespace scene
 		//! Sets Interpolation Mode
 		virtual void setInterpolationMode(E_INTERPOLATION_MODE mode) _IRR_OVERRIDE_;
 
+		//! Bakes the animation keys into compressed samples
+		virtual bool bakeAnimation(f32 samplesPerFrame=1.f) _IRR_OVERRIDE_;
+
+		//! Returns if the animation was baked
+		virtual bool isAnimationBaked() const _IRR_OVERRIDE_;
+
 		//! Convertes the mesh to contain tangent information
 		virtual void convertMeshToTangents() _IRR_OVERRIDE_;
 
@@ -174,6 +183,31 @@ private:
 				core::vector3df &scale, s32 &scaleHint,
 				core::quaternion &rotation, s32 &rotationHint);
 
+		//! Gets the transformation of a joint at a frame, the baked samples must be at this frame
+		/** \param useHints Start the key search at the joint's key hints and update them.
+		Layers sample other frames than animateMesh and must not move the hints. */
+		void getJointFrame(u32 joint, f32 frame, core::vector3df& position,
+				core::vector3df& scale, core::quaternion& rotation, bool useHints);
+
+		//! Sets LayerWeights for a layer, returns false if no joint has a weight
+		bool setLayerWeights(const SAnimationLayer& layer);
+
+		//! Samples the transformation of all joints at a frame into a pose
+		void samplePose(f32 frame, f32* pose);
+
+		//! Writes the transformation of a joint into a pose
+		static void storePose(f32* pose, u32 stride, u32 joint, const core::vector3df& position,
+				const core::vector3df& scale, const core::quaternion& rotation);
+
+		//! Decompresses the baked samples around a frame
+		void sampleBakedAnimation(f32 frame);
+
+		//! Returns if the local matrix of a joint is animated
+		bool isJointAnimated(u32 joint) const;
+
+		//! Returns if the local matrix of a joint is scaled
+		bool isJointScaled(u32 joint) const;
+
 		void calculateGlobalMatrices(SJoint *Joint,SJoint *ParentJoint);
 
 		void skinJoint(SJoint *Joint, SJoint *ParentJoint);
@@ -192,12 +226,89 @@ private:
 
 		core::array< core::array<bool> > Vertices_Moved;
 
+		//! channels of a joint in the baked animation
+		enum E_BAKED_CHANNEL
+		{
+			EBC_POSITION = 1,
+			EBC_SCALE = 2,
+			EBC_ROTATION = 4,
+			//! the joint has scale keys itself, which enables scaling its matrix
+			EBC_OWN_SCALE = 8
+		};
+
+		//! Animation keys resampled at a fixed rate and quantized to 16 bit
+		/** Only values which change over the animation are stored in the samples,
+		the others are set once when baking. */
+		struct SBakedAnimation
+		{
+			SBakedAnimation() : SamplesPerFrame(1.f), SampleCount(0), SampleSize(0) {}
+
+			f32 SamplesPerFrame;
+			u32 SampleCount;
+			//! u16 values per sample
+			u32 SampleSize;
+
+			//! E_BAKED_CHANNEL flags per joint
+			core::array<u8> Channels;
+
+			//! index in Pose of each changing position and scale component
+			core::array<u32> Lanes;
+			//! value = quantized * Step + Min, per lane
+			core::array<f32> Step;
+			core::array<f32> Min;
+			//! joints with changing rotations
+			core::array<u32> RotatingJoints;
+
+			//! each sample has the quantized lanes followed by the
+			//! smallest three components of each changing rotation
+			core::array<u16> Samples;
+
+			//! decompressed positions of all joints, followed by their scales
+			core::array<f32> Pose;
+			core::array<core::quaternion> Rotations;
+			//! decompressed lanes before they are moved into Pose
+			core::array<f32> Values;
+		};
+
+		SBakedAnimation Baked;
+
+		//! mesh whose animation is used by useAnimationFrom, 0 for the own one
+		const CSkinnedMesh* AnimationSource;
+		//! number of other meshes using the animation of this mesh
+		mutable u32 AnimationUsers;
+
+		//! streams of a pose, each has a value for all joints, padded to a multiple of 4
+		enum E_POSE_STREAM
+		{
+			EPS_POSITION_X = 0,
+			EPS_POSITION_Y,
+			EPS_POSITION_Z,
+			EPS_SCALE_X,
+			EPS_SCALE_Y,
+			EPS_SCALE_Z,
+			EPS_ROTATION_X,
+			EPS_ROTATION_Y,
+			EPS_ROTATION_Z,
+			EPS_ROTATION_W,
+			EPS_COUNT
+		};
+
+		//! poses for animateMeshLayers
+		core::array<f32> BlendPose;
+		core::array<f32> LayerPose;
+		core::array<f32> ReferencePose;
+		//! weights per joint of the current layer and the sum of all layers
+		core::array<f32> LayerWeights;
+		core::array<f32> BlendWeights;
+
 		core::aabbox3d<f32> BoundingBox;
 
 		f32 EndFrame;
 		f32 FramesPerSecond;
 
 		f32 LastAnimatedFrame;
+		//! joints in each stream of the poses
+		u32 PoseStride;
 		bool SkinnedLastFrame;
 
 		E_INTERPOLATION_MODE InterpolationMode:8;
@@ -276,6 +276,8 @@ bool CSoftwareDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SC
 		setRenderTargetImage(BackBuffer);
 	}
 
+	CurrentRenderTarget = target;
+
 	clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
 
 	return true;
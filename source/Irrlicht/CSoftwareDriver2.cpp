@@ -87,6 +87,7 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 
 	BurningShader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
 	BurningShader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
+	BurningShader[ETR_OCCLUSION_QUERY] = createTROcclusionQuery ( this );
 	BurningShader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
 
 	BurningShader[ETR_REFERENCE] = createTriangleRendererReference ( this );
@@ -321,6 +322,9 @@ bool CBurningVideoDriver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 	case EVDF_STENCIL_BUFFER:
 		return StencilBuffer != 0;
 
+	case EVDF_OCCLUSION_QUERY:
+		return BurningShader[ETR_OCCLUSION_QUERY] != 0;
+
 	case EVDF_RENDER_TO_TARGET:
 	case EVDF_MULTITEXTURE:
 	case EVDF_HARDWARE_TL:
@@ -433,6 +437,8 @@ bool CBurningVideoDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag
 		setRenderTargetImage(BackBuffer);
 	}
 
+	CurrentRenderTarget = target;
+
 	clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
 
 	return true;
@@ -1630,6 +1636,7 @@ s32 CBurningVideoDriver::addDynamicLight(const SLight& dl)
 			break;
 	}
 
+	LightSpace.LightOn.push_back ( LightSpace.Light.size() );
 	LightSpace.Light.push_back ( l );
 	return LightSpace.Light.size() - 1;
 }
@@ -1637,9 +1644,19 @@ s32 CBurningVideoDriver::addDynamicLight(const SLight& dl)
 //! Turns a dynamic light on or off
 void CBurningVideoDriver::turnLightOn(s32 lightIndex, bool turnOn)
 {
-	if(lightIndex > -1 && lightIndex < (s32)LightSpace.Light.size())
+	if(lightIndex > -1 && lightIndex < (s32)LightSpace.Light.size()
+		&& LightSpace.Light[lightIndex].LightIsOn != turnOn)
 	{
 		LightSpace.Light[lightIndex].LightIsOn = turnOn;
+
+		// lights are lit in the order they were added
+		u32 pos = 0;
+		while ( pos < LightSpace.LightOn.size() && LightSpace.LightOn[pos] < (u32) lightIndex )
+			++pos;
+		if ( turnOn )
+			LightSpace.LightOn.insert ( (u32) lightIndex, pos );
+		else
+			LightSpace.LightOn.erase ( pos );
 	}
 }
 
@@ -1775,12 +1792,9 @@ void CBurningVideoDriver::lightVertex ( s4DVertex *dest, u32 vertexargb )
 	sVec4 vp;			// unit vector vertex to light
 	sVec4 lightHalf;	// blinn-phong reflection
 
-	for ( i = 0; i!= LightSpace.Light.size (); ++i )
+	for ( i = 0; i!= LightSpace.LightOn.size (); ++i )
 	{
-		const SBurningShaderLight &light = LightSpace.Light[i];
-
-		if ( !light.LightIsOn )
-			continue;
+		const SBurningShaderLight &light = LightSpace.Light[LightSpace.LightOn[i]];
 
 		// accumulate ambient
 		ambient.add ( light.AmbientColor );
@@ -1893,12 +1907,15 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 			clipRect = &clip;
 		}
 #endif
-		if (useAlphaChannelOfTexture)
-			((CSoftwareTexture2*)texture)->getImage()->copyToWithAlpha(
-			RenderTargetSurface, destPos, sourceRect, color, clipRect);
-		else
+		if (!useAlphaChannelOfTexture)
 			((CSoftwareTexture2*)texture)->getImage()->copyTo(
 				RenderTargetSurface, destPos, sourceRect, clipRect);
+		else if (getBlend2D() == EB2D_PREMULTIPLIED)
+			Blit(BLITTER_TEXTURE_PREMULTIPLIED_BLEND, RenderTargetSurface, clipRect, &destPos,
+				((CSoftwareTexture2*)texture)->getImage(), &sourceRect, color.color);
+		else
+			((CSoftwareTexture2*)texture)->getImage()->copyToWithAlpha(
+			RenderTargetSurface, destPos, sourceRect, color, clipRect, getBlend2D() == EB2D_COMBINE_ALPHA);
 	}
 }
 
@@ -1916,7 +1933,11 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 			return;
 		}
 
-	if (useAlphaChannelOfTexture)
+	if (useAlphaChannelOfTexture && getBlend2D() != EB2D_ALPHA)
+		StretchBlit(getBlend2D() == EB2D_PREMULTIPLIED ? BLITTER_TEXTURE_PREMULTIPLIED_BLEND : BLITTER_TEXTURE_COMBINE_ALPHA,
+			    RenderTargetSurface, &destRect, &sourceRect,
+			    ((CSoftwareTexture2*)texture)->getImage(), (colors ? colors[0].color : 0xFFFFFFFF));
+	else if (useAlphaChannelOfTexture)
 		StretchBlit(BLITTER_TEXTURE_ALPHA_BLEND, RenderTargetSurface, &destRect, &sourceRect,
 			    ((CSoftwareTexture2*)texture)->getImage(), (colors ? colors[0].color : 0));
 	else
@@ -1930,14 +1951,14 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
 					SColor color)
 {
-	drawLine(BackBuffer, start, end, color );
+	drawLine(RenderTargetSurface, start, end, color );
 }
 
 
 //! Draws a pixel
 void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
-	BackBuffer->setPixel(x, y, color, true);
+	RenderTargetSurface->setPixel(x, y, color, true);
 }
 
 
@@ -1945,24 +1966,43 @@ void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 void CBurningVideoDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos,
 									 const core::rect<s32>* clip)
 {
-	if (clip)
-	{
-		core::rect<s32> p(pos);
+	core::rect<s32> p(pos);
 
+	if (clip)
 		p.clipAgainst(*clip);
 
-		if(!p.isValid())
-			return;
+	if(!p.isValid())
+		return;
 
-		drawRectangle(BackBuffer, p, color);
-	}
+	const E_BLEND_2D blend = color.getAlpha() == 0xFF ? EB2D_ALPHA : getBlend2D();
+	if (blend == EB2D_ALPHA)
+		drawRectangle(RenderTargetSurface, p, color);
 	else
-	{
-		if(!pos.isValid())
-			return;
+		Blit(blend == EB2D_COMBINE_ALPHA ? BLITTER_COLOR_COMBINE_ALPHA : BLITTER_COLOR_PREMULTIPLIED_BLEND,
+			RenderTargetSurface, 0, &p.UpperLeftCorner, 0, &p, color.color);
+}
 
-		drawRectangle(BackBuffer, pos, color);
-	}
+
+//! returns the blending of the 2d methods
+CBurningVideoDriver::E_BLEND_2D CBurningVideoDriver::getBlend2D() const
+{
+	if (!OverrideMaterial2DEnabled || !(IR(OverrideMaterial2D.BlendFactor) & 0xFFFFFFFF))
+		return EB2D_ALPHA;
+
+	E_BLEND_FACTOR srcRGBFact, dstRGBFact, srcAlphaFact, dstAlphaFact;
+	E_MODULATE_FUNC modulate;
+	u32 alphaSource;
+	unpack_textureBlendFuncSeparate(srcRGBFact, dstRGBFact, srcAlphaFact, dstAlphaFact,
+		modulate, alphaSource, OverrideMaterial2D.BlendFactor);
+
+	// other factors are not supported, they blend as without the override material
+	if (dstRGBFact != EBF_ONE_MINUS_SRC_ALPHA || dstAlphaFact != EBF_ONE_MINUS_SRC_ALPHA)
+		return EB2D_ALPHA;
+	if (srcRGBFact == EBF_ONE && srcAlphaFact == EBF_ONE)
+		return EB2D_PREMULTIPLIED;
+	if (srcRGBFact == EBF_SRC_ALPHA && srcAlphaFact == EBF_ONE)
+		return EB2D_COMBINE_ALPHA;
+	return EB2D_ALPHA;
 }
 
 
@@ -2076,6 +2116,7 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 
 	render = BurningShader [ ETR_GOURAUD_ALPHA_NOZ ];
 	render->setRenderTarget(RenderTargetSurface, ViewPort);
+	render->setParam ( 0, getBlend2D() == EB2D_COMBINE_ALPHA ? 1.f : 0.f );
 
 	static const s16 indexList[6] = {0,1,2,0,2,3};
 
@@ -2265,6 +2306,32 @@ ITexture* CBurningVideoDriver::createDeviceDependentTexture(const io::path& name
 }
 
 
+//! Counts the samples of the query mesh passing the depth test, the result is available at once
+void CBurningVideoDriver::runOcclusionQuerySlot(u32 index, bool visible)
+{
+	IBurningShader* shader = BurningShader[ETR_OCCLUSION_QUERY];
+	if (!shader || !DepthBuffer)
+	{
+		CNullDriver::runOcclusionQuerySlot(index, visible);
+		return;
+	}
+
+	// count before drawing, so the mesh does not occlude itself
+	if (visible)
+		setOcclusionQueryMaterial();
+	CurrentShader = shader;
+	shader->setRenderTarget(RenderTargetSurface, ViewPort);
+	shader->getSamplesPassed();
+	CNullDriver::runOcclusionQuerySlot(index, false);
+	OcclusionQueries[index].Result = shader->getSamplesPassed();
+
+	if (visible)
+		CNullDriver::runOcclusionQuerySlot(index, true);
+	else
+		setCurrentShader();
+}
+
+
 //! Returns the maximum amount of primitives (mostly vertices) which
 //! the device is able to render with one drawIndexedTriangleList
 //! call.
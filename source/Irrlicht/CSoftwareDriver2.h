@@ -172,11 +172,28 @@ namespace video
 		//! sets a render target
 		void setRenderTargetImage(video::CImage* image);
 
+		//! blending of the 2d methods, which the blend factor of the 2d override material can change
+		enum E_BLEND_2D
+		{
+			//! color = dest * ( 1 - sourceAlpha ) + source * sourceAlpha, alpha = sourceAlpha
+			EB2D_ALPHA = 0,
+			//! color as EB2D_ALPHA, alpha = destAlpha * ( 1 - sourceAlpha ) + sourceAlpha
+			EB2D_COMBINE_ALPHA,
+			//! all channels = dest * ( 1 - sourceAlpha ) + source
+			EB2D_PREMULTIPLIED
+		};
+
+		//! returns the blending of the 2d methods
+		E_BLEND_2D getBlend2D() const;
+
 		//! sets the current Texture
 		//bool setTexture(u32 stage, video::ITexture* texture);
 
 		virtual ITexture* createDeviceDependentTexture(const io::path& name, IImage* image) _IRR_OVERRIDE_;
 
+		//! Counts the samples of the query mesh passing the depth test, the result is available at once
+		virtual void runOcclusionQuerySlot(u32 index, bool visible) _IRR_OVERRIDE_;
+
 		video::CImage* BackBuffer;
 		video::IImagePresenter* Presenter;
 
@@ -158,8 +158,8 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* data, u32 layer)
 			MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
 
 			//static u32 color[] = { 0, 0xFFFF0000, 0xFF00FF00,0xFF0000FF,0xFFFFFF00,0xFFFF00FF,0xFF00FFFF,0xFF0F0F0F };
-			MipMap[i]->fill ( 0 );
-			MipMap[0]->copyToScalingBoxFilter( MipMap[i], 0, false );
+			// each level is filtered from the previous one, so the work shrinks with every level
+			MipMap[i-1]->copyToScalingBoxFilter( MipMap[i], 0, false );
 		}
 	}
 }
@@ -86,17 +86,21 @@ public:
 	//! draws an indexed triangle list
 	virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
 
+	//! param 0: 1 combines the alpha with the alpha of the target, 0 writes full alpha
+	virtual void setParam ( u32 index, f32 value);
+
 
 private:
 	void scanline_bilinear ();
 	sScanConvertData scan;
 	sScanLineData line;
 
+	bool CombineAlpha;
 };
 
 //! constructor
 CTRGouraudAlphaNoZ2::CTRGouraudAlphaNoZ2(CBurningVideoDriver* driver)
-: IBurningShader(driver)
+: IBurningShader(driver), CombineAlpha(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CTRGouraudAlphaNoZ2");
@@ -104,6 +108,15 @@ CTRGouraudAlphaNoZ2::CTRGouraudAlphaNoZ2(CBurningVideoDriver* driver)
 }
 
 
+/*!
+*/
+void CTRGouraudAlphaNoZ2::setParam ( u32 index, f32 value)
+{
+	if ( 0 == index )
+		CombineAlpha = value != 0.f;
+}
+
+
 
 /*!
 */
@@ -237,6 +250,17 @@ void CTRGouraudAlphaNoZ2::scanline_bilinear ()
 			g2 = g1 + imulFix ( a0, g0 - g1 );
 			b2 = b1 + imulFix ( a0, b0 - b1 );
 
+#ifdef SOFTWARE_DRIVER_2_32BIT
+			if ( CombineAlpha )
+			{
+				// alpha = destAlpha * ( 1 - sourceAlpha ) + sourceAlpha, as PixelCombine32
+				const u32 sa = core::min_ ( (u32) ( a0 * COLOR_MAX ) >> FIX_POINT_PRE, (u32) COLOR_MAX );
+				const u32 da = dst[i] >> SHIFT_A;
+				const u32 alpha = sa + ( ( da * ( 256 - sa - ( sa >> 7 ) ) ) >> 8 );
+				dst[i] = ( fix_to_color ( r2, g2, b2 ) & ~MASK_A ) | ( alpha << SHIFT_A );
+			}
+			else
+#endif
 			dst[i] = fix_to_color ( r2, g2, b2 );
 #else
 			dst[i] = COLOR_BRIGHT_WHITE;
@@ -9,6 +9,67 @@
 #include "S3DVertex.h"
 #include "SMesh.h"
 #include "os.h"
+#include "FastSinCos.h"
+
+namespace
+{
+	using namespace irr;
+
+	//! Moves the vertices to the wave and sets the normals of the wave
+	/** The wave is y + sin(x/length + time)*height + cos(z/length + time)*height,
+	its normal is the one of the height field. */
+	void moveToWave(u8* vertices, u32 pitch, const f32* x, const f32* y, const f32* z,
+		u32 count, f32 time, f32 invLength, f32 height)
+	{
+		const f32 slope = height * invLength;
+		u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		const __m128 t = _mm_set1_ps(time);
+		const __m128 l = _mm_set1_ps(invLength);
+		const __m128 h = _mm_set1_ps(height);
+		const __m128 k = _mm_set1_ps(slope);
+		const __m128 one = _mm_set1_ps(1.f);
+		for (; i+4<=count; i+=4)
+		{
+			__m128 sx, cx, sz, cz;
+			core::sinCos(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x+i), l), t), sx, cx);
+			core::sinCos(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(z+i), l), t), sz, cz);
+
+			const __m128 py = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(y+i), _mm_mul_ps(sx, h)), _mm_mul_ps(cz, h));
+			const __m128 nx = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), k), cx);
+			const __m128 nz = _mm_mul_ps(k, sz);
+			const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), one), _mm_mul_ps(nz, nz)));
+			const __m128 scale = _mm_div_ps(one, length);
+
+			f32 outY[4], outX[4], outN[4], outZ[4];
+			_mm_storeu_ps(outY, py);
+			_mm_storeu_ps(outX, _mm_mul_ps(nx, scale));
+			_mm_storeu_ps(outN, scale);
+			_mm_storeu_ps(outZ, _mm_mul_ps(nz, scale));
+			for (u32 v=0; v<4; ++v)
+			{
+				video::S3DVertex& vertex = *(video::S3DVertex*)(vertices + (i+v)*pitch);
+				vertex.Pos.Y = outY[v];
+				vertex.Normal.set(outX[v], outN[v], outZ[v]);
+			}
+		}
+#endif
+		for (; i<count; ++i)
+		{
+			f32 sx, cx, sz, cz;
+			core::sinCos(x[i] * invLength + time, sx, cx);
+			core::sinCos(z[i] * invLength + time, sz, cz);
+
+			const f32 nx = -slope * cx;
+			const f32 nz = slope * sz;
+			const f32 scale = 1.f / core::squareroot(nx * nx + 1.f + nz * nz);
+
+			video::S3DVertex& vertex = *(video::S3DVertex*)(vertices + i*pitch);
+			vertex.Pos.Y = (y[i] + sx * height) + cz * height;
+			vertex.Normal.set(nx * scale, scale, nz * scale);
+		}
+	}
+}
 
 namespace irr
 {
@@ -22,7 +83,7 @@ CWaterSurfaceSceneNode::CWaterSurfaceSceneNode(f32 waveHeight, f32 waveSpeed, f3
 		const core::vector3df& scale)
 	: CMeshSceneNode(mesh, parent, mgr, id, position, rotation, scale),
 	WaveLength(waveLength), WaveSpeed(waveSpeed), WaveHeight(waveHeight),
-	OriginalMesh(0)
+	OriginalMesh(0), WaveTime(0.f), SurfaceTime(0.f), SurfaceValid(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CWaterSurfaceSceneNode");
@@ -44,30 +105,18 @@ CWaterSurfaceSceneNode::~CWaterSurfaceSceneNode()
 //! frame
 void CWaterSurfaceSceneNode::OnRegisterSceneNode()
 {
+	// the waves are only computed for frames in which the node is drawn
+	if (IsVisible && Mesh && (!SurfaceValid || SurfaceTime != WaveTime) &&
+		!SceneManager->isCulled(this))
+		animateSurface();
+
 	CMeshSceneNode::OnRegisterSceneNode();
 }
 
 
 void CWaterSurfaceSceneNode::OnAnimate(u32 timeMs)
 {
-	if (Mesh && IsVisible)
-	{
-		const u32 meshBufferCount = Mesh->getMeshBufferCount();
-		const f32 time = timeMs / WaveSpeed;
-
-		for (u32 b=0; b<meshBufferCount; ++b)
-		{
-			const u32 vtxCnt = Mesh->getMeshBuffer(b)->getVertexCount();
-
-			for (u32 i=0; i<vtxCnt; ++i)
-				Mesh->getMeshBuffer(b)->getPosition(i).Y = addWave(
-					OriginalMesh->getMeshBuffer(b)->getPosition(i),
-					time);
-		}// end for all mesh buffers
-		Mesh->setDirty(scene::EBT_VERTEX);
-
-		SceneManager->getMeshManipulator()->recalculateNormals(Mesh);
-	}
+	WaveTime = timeMs / WaveSpeed;
 	CMeshSceneNode::OnAnimate(timeMs);
 }
 
@@ -84,6 +133,7 @@ void CWaterSurfaceSceneNode::setMesh(IMesh* mesh)
 	Mesh = clone;
 	Mesh->setHardwareMappingHint(scene::EHM_STATIC, scene::EBT_INDEX);
 //	Mesh->setHardwareMappingHint(scene::EHM_STREAM, scene::EBT_VERTEX);
+	prepareSurface();
 }
 
 
@@ -122,14 +172,69 @@ void CWaterSurfaceSceneNode::deserializeAttributes(io::IAttributes* in, io::SAtt
 		OriginalMesh = Mesh;
 		Mesh = clone;
 	}
+	prepareSurface();
+}
+
+
+//! Copies the original positions and makes the bounding boxes include the waves
+void CWaterSurfaceSceneNode::prepareSurface()
+{
+	OriginalX.set_used(0);
+	OriginalY.set_used(0);
+	OriginalZ.set_used(0);
+	SurfaceValid = false;
+	if (!Mesh || !OriginalMesh)
+		return;
+
+	// the vertices move up and down by twice the wave height at most
+	const f32 range = 2.f * core::abs_(WaveHeight);
+	core::aabbox3df meshBox;
+	for (u32 b=0; b<OriginalMesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* original = OriginalMesh->getMeshBuffer(b);
+		const u32 vtxCnt = original->getVertexCount();
+		for (u32 i=0; i<vtxCnt; ++i)
+		{
+			const core::vector3df& pos = original->getPosition(i);
+			OriginalX.push_back(pos.X);
+			OriginalY.push_back(pos.Y);
+			OriginalZ.push_back(pos.Z);
+		}
+
+		core::aabbox3df box = original->getBoundingBox();
+		box.MinEdge.Y -= range;
+		box.MaxEdge.Y += range;
+		Mesh->getMeshBuffer(b)->setBoundingBox(box);
+		if (b)
+			meshBox.addInternalBox(box);
+		else
+			meshBox = box;
+	}
+	Mesh->setBoundingBox(meshBox);
 }
 
 
-f32 CWaterSurfaceSceneNode::addWave(const core::vector3df &source, f32 time) const
+//! Moves the vertices to the wave at the time of the last OnAnimate and sets their normals
+void CWaterSurfaceSceneNode::animateSurface()
 {
-	return source.Y +
-		(sinf(((source.X/WaveLength) + time)) * WaveHeight) +
-		(cosf(((source.Z/WaveLength) + time)) * WaveHeight);
+	const f32 invLength = 1.f / WaveLength;
+	u32 first = 0;
+	for (u32 b=0; b<Mesh->getMeshBufferCount(); ++b)
+	{
+		IMeshBuffer* buffer = Mesh->getMeshBuffer(b);
+		const u32 vtxCnt = buffer->getVertexCount();
+		if (first + vtxCnt > OriginalX.size())
+			break;
+
+		moveToWave((u8*)buffer->getVertices(), video::getVertexPitchFromType(buffer->getVertexType()),
+			OriginalX.const_pointer() + first, OriginalY.const_pointer() + first, OriginalZ.const_pointer() + first,
+			vtxCnt, WaveTime, invLength, WaveHeight);
+		first += vtxCnt;
+	}// end for all mesh buffers
+	Mesh->setDirty(scene::EBT_VERTEX);
+
+	SurfaceTime = WaveTime;
+	SurfaceValid = true;
 }
 
 } // end namespace scene
@@ -46,12 +46,26 @@ namespace scene
 
 	private:
 
-		inline f32 addWave(const core::vector3df &source, f32 time) const;
+		//! Moves the vertices to the wave at the time of the last OnAnimate and sets their normals
+		void animateSurface();
+
+		//! Copies the original positions and makes the bounding boxes include the waves
+		void prepareSurface();
 
 		f32 WaveLength;
 		f32 WaveSpeed;
 		f32 WaveHeight;
 		IMesh* OriginalMesh;
+
+		//! original positions of the vertices of all mesh buffers
+		core::array<f32> OriginalX;
+		core::array<f32> OriginalY;
+		core::array<f32> OriginalZ;
+
+		//! wave time set by OnAnimate, and the one the vertices are at
+		f32 WaveTime;
+		f32 SurfaceTime;
+		bool SurfaceValid;
 	};
 
 } // end namespace scene
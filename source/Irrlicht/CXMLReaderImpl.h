@@ -24,6 +24,10 @@ namespace io
 
 
 //! implementation of the IrrXMLReader
+/** The text is parsed in place: node names, attributes and text data are
+terminated inside the text buffer and returned as pointers into it, so
+reading nodes does not allocate any strings. Returned strings stay valid
+as long as the reader exists. */
 template<class char_type, class superclass>
 class CXMLReaderImpl : public IIrrXMLReader<char_type, superclass>
 {
@@ -32,8 +36,11 @@ public:
 	//! Constructor
 	CXMLReaderImpl(IFileReadCallBack* callback, bool deleteCallBack = true)
 		: IgnoreWhitespaceText(true), TextData(0), P(0), TextBegin(0), TextSize(0), CurrentNodeType(EXN_NONE),
-		SourceFormat(ETF_ASCII), TargetFormat(ETF_ASCII), IsEmptyElement(false)
+		SourceFormat(ETF_ASCII), TargetFormat(ETF_ASCII), IsEmptyElement(false), TagStartTerminated(false)
 	{
+		EmptyString[0] = 0;
+		NodeName = EmptyString;
+
 		if (!callback)
 			return;
 
@@ -69,7 +76,7 @@ public:
 	virtual bool read() _IRR_OVERRIDE_
 	{
 		// if not end reached, parse the node
-		if (P && ((unsigned int)(P - TextBegin) < TextSize - 1) && (*P != 0))
+		if (P && ((unsigned int)(P - TextBegin) < TextSize - 1) && (*P != 0 || TagStartTerminated))
 		{
 			return parseCurrentNode();
 		}
@@ -98,7 +105,7 @@ public:
 		if ((u32)idx >= Attributes.size())
 			return 0;
 
-		return Attributes[idx].Name.c_str();
+		return Attributes[idx].Name;
 	}
 
 
@@ -108,7 +115,7 @@ public:
 		if ((unsigned int)idx >= Attributes.size())
 			return 0;
 
-		return Attributes[idx].Value.c_str();
+		return Attributes[idx].Value;
 	}
 
 
@@ -119,7 +126,7 @@ public:
 		if (!attr)
 			return 0;
 
-		return attr->Value.c_str();
+		return attr->Value;
 	}
 
 
@@ -128,9 +135,9 @@ public:
 	{
 		const SAttribute* attr = getAttributeByName(name);
 		if (!attr)
-			return EmptyString.c_str();
+			return EmptyString;
 
-		return attr->Value.c_str();
+		return attr->Value;
 	}
 
 
@@ -142,8 +149,7 @@ public:
 		if (!attr)
 			return defaultNotFound;
 
-		core::stringc c(attr->Value.c_str());
-		return core::strtol10(c.c_str());
+		return toInt(attr->Value);
 	}
 
 
@@ -154,8 +160,7 @@ public:
 		if (!attrvalue)
 			return defaultNotFound;
 
-		core::stringc c(attrvalue);
-		return core::strtol10(c.c_str());
+		return toInt(attrvalue);
 	}
 
 
@@ -166,8 +171,7 @@ public:
 		if (!attr)
 			return defaultNotFound;
 
-		core::stringc c = attr->Value.c_str();
-		return core::fast_atof(c.c_str());
+		return toFloat(attr->Value);
 	}
 
 
@@ -178,22 +182,21 @@ public:
 		if (!attrvalue)
 			return defaultNotFound;
 
-		core::stringc c = attrvalue;
-		return core::fast_atof(c.c_str());
+		return toFloat(attrvalue);
 	}
 
 
 	//! Returns the name of the current node.
 	virtual const char_type* getNodeName() const _IRR_OVERRIDE_
 	{
-		return NodeName.c_str();
+		return NodeName;
 	}
 
 
 	//! Returns data of the current node.
 	virtual const char_type* getNodeData() const _IRR_OVERRIDE_
 	{
-		return NodeName.c_str();
+		return NodeName;
 	}
 
 
@@ -221,21 +224,27 @@ private:
 	// return false if no further node is found
 	bool parseCurrentNode()
 	{
-		char_type* start = P;
+		// the '<' of this tag was overwritten to terminate the text before
+		if (TagStartTerminated)
+			TagStartTerminated = false;
+		else
+		{
+			char_type* start = P;
 
-		// more forward until '<' found
-		while(*P != L'<' && *P)
-			++P;
+			// more forward until '<' found
+			while(*P != L'<' && *P)
+				++P;
 
-		// not a node, so return false
-		if (!*P)
-			return false;
+			// not a node, so return false
+			if (!*P)
+				return false;
 
-		if (P - start > 0)
-		{
-			// we found some text, store it
-			if (setText(start, P))
-				return true;
+			if (P - start > 0)
+			{
+				// we found some text, store it
+				if (setText(start, P))
+					return true;
+			}
 		}
 
 		++P;
@@ -279,8 +288,9 @@ private:
 		}
 
 		// set current text to the parsed text, and replace xml special characters
-		core::string<char_type> s(start, (int)(end - start));
-		NodeName = replaceSpecialCharacters(s);
+		// end is the '<' of the next tag, which is remembered before terminating the text
+		NodeName = replaceSpecialCharacters(start, end);
+		TagStartTerminated = true;
 
 		// current XML node type is text
 		CurrentNodeType = EXN_TEXT;
@@ -326,7 +336,7 @@ private:
 		}
 
 		P -= 3;
-		NodeName = core::string<char_type>(pCommentBegin+2, (int)(P - pCommentBegin-2));
+		NodeName = terminate(pCommentBegin+2, P);
 		P += 3;
 	}
 
@@ -336,16 +346,16 @@ private:
 	{
 		CurrentNodeType = EXN_ELEMENT;
 		IsEmptyElement = false;
-		Attributes.clear();
+		Attributes.set_used(0);
 
 		// find name
-		const char_type* startName = P;
+		char_type* startName = P;
 
 		// find end of element
 		while(*P != L'>' && !isWhiteSpace(*P))
 			++P;
 
-		const char_type* endName = P;
+		char_type* endName = P;
 
 		// find Attributes
 		while(*P != L'>')
@@ -359,12 +369,12 @@ private:
 					// we've got an attribute
 
 					// read the attribute names
-					const char_type* attributeNameBegin = P;
+					char_type* attributeNameBegin = P;
 
 					while(!isWhiteSpace(*P) && *P != L'=')
 						++P;
 
-					const char_type* attributeNameEnd = P;
+					char_type* attributeNameEnd = P;
 					++P;
 
 					// read the attribute value
@@ -378,7 +388,7 @@ private:
 					const char_type attributeQuoteChar = *P;
 
 					++P;
-					const char_type* attributeValueBegin = P;
+					char_type* attributeValueBegin = P;
 
 					while(*P != attributeQuoteChar && *P)
 						++P;
@@ -386,17 +396,14 @@ private:
 					if (!*P) // malformatted xml file
 						return;
 
-					const char_type* attributeValueEnd = P;
+					char_type* attributeValueEnd = P;
 					++P;
 
+					// Both ends are already passed, so they can be terminated.
+					// The name end is either whitespace or the '='.
 					SAttribute attr;
-					attr.Name = core::string<char_type>(attributeNameBegin,
-						(int)(attributeNameEnd - attributeNameBegin));
-
-					core::string<char_type> s(attributeValueBegin,
-						(int)(attributeValueEnd - attributeValueBegin));
-
-					attr.Value = replaceSpecialCharacters(s);
+					attr.Name = terminate(attributeNameBegin, attributeNameEnd);
+					attr.Value = replaceSpecialCharacters(attributeValueBegin, attributeValueEnd);
 					Attributes.push_back(attr);
 				}
 				else
@@ -417,7 +424,7 @@ private:
 			endName--;
 		}
 
-		NodeName = core::string<char_type>(startName, (int)(endName - startName));
+		NodeName = terminate(startName, endName);
 
 		++P;
 	}
@@ -428,15 +435,15 @@ private:
 	{
 		CurrentNodeType = EXN_ELEMENT_END;
 		IsEmptyElement = false;
-		Attributes.clear();
+		Attributes.set_used(0);
 
 		++P;
-		const char_type* pBeginClose = P;
+		char_type* pBeginClose = P;
 
 		while(*P != L'>')
 			++P;
 
-		NodeName = core::string<char_type>(pBeginClose, (int)(P - pBeginClose));
+		NodeName = terminate(pBeginClose, P);
 		++P;
 	}
 
@@ -476,19 +483,19 @@ private:
 		}
 
 		if ( cDataEnd )
-			NodeName = core::string<char_type>(cDataBegin, (int)(cDataEnd - cDataBegin));
+			NodeName = terminate(cDataBegin, cDataEnd);
 		else
-			NodeName = "";
+			NodeName = EmptyString;
 
 		return true;
 	}
 
 
-	// structure for storing attribute-name pairs
+	// structure for storing attribute-name pairs, both point into the text
 	struct SAttribute
 	{
-		core::string<char_type> Name;
-		core::string<char_type> Value;
+		const char_type* Name;
+		const char_type* Value;
 	};
 
 	// finds a current attribute by name, returns 0 if not found
@@ -497,64 +504,100 @@ private:
 		if (!name)
 			return 0;
 
-		core::string<char_type> n = name;
-
-		for (int i=0; i<(int)Attributes.size(); ++i)
-			if (Attributes[i].Name == n)
+		for (u32 i=0; i<Attributes.size(); ++i)
+		{
+			const char_type* a = Attributes[i].Name;
+			const char_type* b = name;
+			while (*a && *a == *b)
+			{
+				++a;
+				++b;
+			}
+			if (*a == *b)
 				return &Attributes[i];
+		}
 
 		return 0;
 	}
 
-	// replaces xml special characters in a string and creates a new one
-	core::string<char_type> replaceSpecialCharacters(
-		core::string<char_type>& origstr)
+	//! terminates the string [begin, end) inside the text and returns begin
+	/** end has to point to a character which was already parsed. */
+	const char_type* terminate(char_type* begin, char_type* end)
 	{
-		int pos = origstr.findFirst(L'&');
-		int oldPos = 0;
-
-		if (pos == -1)
-			return origstr;
-
-		core::string<char_type> newstr;
+		*end = 0;
+		return begin;
+	}
 
-		while(pos != -1 && pos < (int)origstr.size()-2)
+	// replaces xml special characters in the string [begin, end) inside the text
+	// and terminates it. The result is never longer, so this works in place.
+	const char_type* replaceSpecialCharacters(char_type* begin, char_type* end)
+	{
+		char_type* out = begin;
+		for (char_type* in = begin; in != end; )
 		{
-			// check if it is one of the special characters
-
-			int specialChar = -1;
-			for (int i=0; i<(int)SpecialCharacters.size(); ++i)
+			if (*in == L'&')
 			{
-				const char_type* p = &origstr.c_str()[pos]+1;
+				// check if it is one of the special characters
+				int specialChar = -1;
+				for (int i=0; i<(int)SpecialCharacters.size(); ++i)
+				{
+					const int len = (int)SpecialCharacters[i].size()-1;
+					if (end - (in+1) >= len && equalsn(&SpecialCharacters[i][1], in+1, len))
+					{
+						specialChar = i;
+						break;
+					}
+				}
 
-				if (equalsn(&SpecialCharacters[i][1], p, SpecialCharacters[i].size()-1))
+				if (specialChar != -1)
 				{
-					specialChar = i;
-					break;
+					*out++ = SpecialCharacters[specialChar][0];
+					in += SpecialCharacters[specialChar].size();
+					continue;
 				}
 			}
+			*out++ = *in++;
+		}
+		return terminate(begin, out);
+	}
 
-			if (specialChar != -1)
-			{
-				newstr.append(origstr.subString(oldPos, pos - oldPos));
-				newstr.append(SpecialCharacters[specialChar][0]);
-				pos += SpecialCharacters[specialChar].size();
-			}
-			else
-			{
-				newstr.append(origstr.subString(oldPos, pos - oldPos + 1));
-				pos += 1;
-			}
+	//! converts a string from the text to a number
+	static int toInt(const char* value)
+	{
+		return core::strtol10(value);
+	}
 
-			// find next &
-			oldPos = pos;
-			pos = origstr.findNext(L'&', pos);
-		}
+	//! converts a string from the text to a number
+	static float toFloat(const char* value)
+	{
+		return core::fast_atof(value);
+	}
 
-		if (oldPos < (int)origstr.size()-1)
-			newstr.append(origstr.subString(oldPos, origstr.size()-oldPos));
+	//! converts a string from the text to a number, only numbers need to be narrowed
+	template<class src_char_type>
+	static int toInt(const src_char_type* value)
+	{
+		c8 number[64];
+		return core::strtol10(narrowNumber(value, number, 64));
+	}
 
-		return newstr;
+	//! converts a string from the text to a number, only numbers need to be narrowed
+	template<class src_char_type>
+	static float toFloat(const src_char_type* value)
+	{
+		c8 number[64];
+		return core::fast_atof(narrowNumber(value, number, 64));
+	}
+
+	//! copies a number into a char buffer without allocating
+	template<class src_char_type>
+	static const c8* narrowNumber(const src_char_type* value, c8* out, u32 size)
+	{
+		u32 i=0;
+		for (; i<size-1 && value[i]; ++i)
+			out[i] = (c8)value[i];
+		out[i] = 0;
+		return out;
 	}
 
 
@@ -803,10 +846,11 @@ private:
 	ETEXT_FORMAT SourceFormat;   // source format of the xml file
 	ETEXT_FORMAT TargetFormat;   // output format of this parser
 
-	core::string<char_type> NodeName;    // name of the node currently in - also used for text
-	core::string<char_type> EmptyString; // empty string to be returned by getSafe() methods
+	const char_type* NodeName;   // name of the node currently in - also used for text
+	char_type EmptyString[1];    // empty string to be returned by getSafe() methods
 
 	bool IsEmptyElement;       // is the currently parsed node empty?
+	bool TagStartTerminated;   // the '<' at P was overwritten to terminate a text node
 
 	core::array< core::string<char_type> > SpecialCharacters; // see createSpecialCharacterList()
 
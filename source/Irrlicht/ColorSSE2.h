@@ -0,0 +1,75 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_COLOR_SSE2_H_INCLUDED__
+#define __IRR_COLOR_SSE2_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "irrTypes.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+
+namespace irr
+{
+namespace video
+{
+
+/*
+	SSE2 versions of the 16 bit color conversions in SColor.h, used by the
+	blitters, the color converter and the image filters. They work on four
+	colors in 32 bit lanes and give the same results as the scalar functions.
+*/
+
+//! sign extends the lower 16 bits of each 32 bit lane, so packing to 16 bit keeps them
+inline __m128i signExtend16(const __m128i& v)
+{
+	return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+}
+
+//! A1R5G5B5toA8R8G8B8 for four colors in the lower 16 bits of each lane
+inline __m128i expandA1R5G5B5(const __m128i& c)
+{
+	const __m128i alpha = _mm_and_si128(_mm_srai_epi32(_mm_slli_epi32(c, 16), 31), _mm_set1_epi32((s32)0xFF000000));
+	const __m128i r = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x7C00)), 9),
+		_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x7000)), 4));
+	const __m128i g = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x03E0)), 6),
+		_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0380)), 1));
+	const __m128i b = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x001F)), 3),
+		_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x001C)), 2));
+	return _mm_or_si128(_mm_or_si128(alpha, r), _mm_or_si128(g, b));
+}
+
+//! R5G6B5toA8R8G8B8 for four colors in the lower 16 bits of each lane
+inline __m128i expandR5G6B5(const __m128i& c)
+{
+	return _mm_or_si128(_mm_or_si128(_mm_set1_epi32((s32)0xFF000000),
+			_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0xF800)), 8)),
+		_mm_or_si128(_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x07E0)), 5),
+			_mm_slli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x001F)), 3)));
+}
+
+//! A8R8G8B8toA1R5G5B5 for four colors, result in the lower 16 bits of each lane
+inline __m128i reduceToA1R5G5B5(const __m128i& c)
+{
+	return _mm_or_si128(_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32((s32)0x80000000)), 16),
+			_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00F80000)), 9)),
+		_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000F800)), 6),
+			_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000F8)), 3)));
+}
+
+//! A8R8G8B8toR5G6B5 for four colors, result in the lower 16 bits of each lane
+inline __m128i reduceToR5G6B5(const __m128i& c)
+{
+	return _mm_or_si128(_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x00F80000)), 8),
+		_mm_or_si128(_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x0000FC00)), 5),
+			_mm_srli_epi32(_mm_and_si128(c, _mm_set1_epi32(0x000000F8)), 3)));
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_SSE2_
+
+#endif
@@ -29,7 +29,10 @@ namespace irr
 
 		//! octrees
 		EPID_OC_RENDER,
-		EPID_OC_CALCPOLYS
+		EPID_OC_CALCPOLYS,
+
+		//! devices
+		EPID_DEVICE_PRESENT
     };
 #endif
 } // end namespace irr
@@ -0,0 +1,107 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_FAST_SIN_COS_H_INCLUDED__
+#define __IRR_FAST_SIN_COS_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "irrMath.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace core
+{
+	//! Sine and cosine for scene nodes which move many vertices each frame
+	/** The angle is reduced to quarter turns and a rest between -pi/4 and pi/4,
+	which is evaluated with polynomials. The SSE2 versions take the same steps,
+	so a scalar tail after groups of four values gives the same results. */
+	namespace sincos
+	{
+		// pi/2 split in three parts, so the angle is reduced without losing precision
+		const f32 TWO_BY_PI = 0.636619772367581f;
+		const f32 PI_BY_2_A = 1.5703125f;
+		const f32 PI_BY_2_B = 4.837512969970703125e-4f;
+		const f32 PI_BY_2_C = 7.54978995489188216e-8f;
+
+		// polynomials of sine and cosine between -pi/4 and pi/4
+		const f32 SIN_1 = -1.6666654611e-1f;
+		const f32 SIN_2 = 8.3321608736e-3f;
+		const f32 SIN_3 = -1.9515295891e-4f;
+		const f32 COS_1 = 4.166664568298827e-2f;
+		const f32 COS_2 = -1.388731625493765e-3f;
+		const f32 COS_3 = 2.443315711809948e-5f;
+	}
+
+	//! Sine and cosine of r + j*pi/2, for r between -pi/4 and pi/4
+	inline void sinCosQuadrant(f32 r, s32 j, f32& s, f32& c)
+	{
+		using namespace sincos;
+		const f32 r2 = r * r;
+		const f32 ps = ((SIN_3 * r2 + SIN_2) * r2 + SIN_1) * r2 * r + r;
+		const f32 pc = ((COS_3 * r2 + COS_2) * r2 + COS_1) * r2 * r2 - 0.5f * r2 + 1.f;
+
+		// the quadrant swaps sine and cosine and flips their signs
+		s = (j & 1) ? pc : ps;
+		c = (j & 1) ? ps : pc;
+		if (j & 2)
+			s = -s;
+		if ((j + 1) & 2)
+			c = -c;
+	}
+
+	//! Sine and cosine of an angle
+	inline void sinCos(f32 a, f32& s, f32& c)
+	{
+		using namespace sincos;
+		const s32 j = core::round32(a * TWO_BY_PI);
+		const f32 q = (f32)j;
+		sinCosQuadrant(((a - q * PI_BY_2_A) - q * PI_BY_2_B) - q * PI_BY_2_C, j, s, c);
+	}
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	//! Sine and cosine of four angles r + j*pi/2, for r between -pi/4 and pi/4
+	inline void sinCosQuadrant(__m128 r, __m128i j, __m128& s, __m128& c)
+	{
+		using namespace sincos;
+		const __m128 r2 = _mm_mul_ps(r, r);
+
+		__m128 ps = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_3), r2), _mm_set1_ps(SIN_2));
+		ps = _mm_add_ps(_mm_mul_ps(ps, r2), _mm_set1_ps(SIN_1));
+		ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, r2), r), r);
+		__m128 pc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_3), r2), _mm_set1_ps(COS_2));
+		pc = _mm_add_ps(_mm_mul_ps(pc, r2), _mm_set1_ps(COS_1));
+		pc = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(pc, r2), r2), _mm_mul_ps(_mm_set1_ps(0.5f), r2));
+		pc = _mm_add_ps(pc, _mm_set1_ps(1.f));
+
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i two = _mm_set1_epi32(2);
+		const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, one), one));
+		const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, two), 30));
+		const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, one), two), 30));
+		s = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps)), sinSign);
+		c = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc)), cosSign);
+	}
+
+	//! Sine and cosine of four angles
+	inline void sinCos(__m128 a, __m128& s, __m128& c)
+	{
+		using namespace sincos;
+		const __m128i j = _mm_cvtps_epi32(_mm_mul_ps(a, _mm_set1_ps(TWO_BY_PI)));
+		const __m128 q = _mm_cvtepi32_ps(j);
+		__m128 r = _mm_sub_ps(a, _mm_mul_ps(q, _mm_set1_ps(PI_BY_2_A)));
+		r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(PI_BY_2_B)));
+		r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(PI_BY_2_C)));
+		sinCosQuadrant(r, j, s, c);
+	}
+#endif
+
+} // end namespace core
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,121 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_FRUSTUM_BOX_CULLING_H_INCLUDED__
+#define __IRR_FRUSTUM_BOX_CULLING_H_INCLUDED__
+
+#include "SViewFrustum.h"
+#include "matrix4.h"
+#include "aabbox3d.h"
+#include "irrMath.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+	//! Marks boxes which lie completely in front of one of the frustum planes
+	/** Gives the same results as the box corner test in CSceneManager::isCulled.
+	Boxes are oriented and given as 12 arrays of count floats: the center and the
+	three half axes, all in the space of the frustum. With SSE2 four boxes are
+	tested at once, with the same operations in the same order as the scalar loop
+	which tests the rest. */
+	inline void cullOrientedBoxes(const SViewFrustum& frustum, const f32* data, u32 count, u8* culled)
+	{
+		const f32* cx = data;
+		const f32* cy = cx + count;
+		const f32* cz = cy + count;
+		const f32* ux = cz + count;
+		const f32* uy = ux + count;
+		const f32* uz = uy + count;
+		const f32* vx = uz + count;
+		const f32* vy = vx + count;
+		const f32* vz = vy + count;
+		const f32* wx = vz + count;
+		const f32* wy = wx + count;
+		const f32* wz = wy + count;
+
+		for (u32 i=0; i<count; ++i)
+			culled[i] = 0;
+
+		for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			const f32 nx = frustum.planes[p].Normal.X;
+			const f32 ny = frustum.planes[p].Normal.Y;
+			const f32 nz = frustum.planes[p].Normal.Z;
+			const f32 d = frustum.planes[p].D;
+
+			u32 i = 0;
+#ifdef _IRR_COMPILE_WITH_SSE2_
+			const __m128 nx4 = _mm_set1_ps(nx);
+			const __m128 ny4 = _mm_set1_ps(ny);
+			const __m128 nz4 = _mm_set1_ps(nz);
+			const __m128 d4 = _mm_set1_ps(d);
+			const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+			const __m128 epsilon = _mm_set1_ps(core::ROUNDING_ERROR_f32);
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(nx4, _mm_loadu_ps(cx + i)), _mm_mul_ps(ny4, _mm_loadu_ps(cy + i))),
+					_mm_mul_ps(nz4, _mm_loadu_ps(cz + i))), d4);
+				const __m128 u = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(nx4, _mm_loadu_ps(ux + i)), _mm_mul_ps(ny4, _mm_loadu_ps(uy + i))),
+					_mm_mul_ps(nz4, _mm_loadu_ps(uz + i)));
+				const __m128 v = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(nx4, _mm_loadu_ps(vx + i)), _mm_mul_ps(ny4, _mm_loadu_ps(vy + i))),
+					_mm_mul_ps(nz4, _mm_loadu_ps(vz + i)));
+				const __m128 w = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(nx4, _mm_loadu_ps(wx + i)), _mm_mul_ps(ny4, _mm_loadu_ps(wy + i))),
+					_mm_mul_ps(nz4, _mm_loadu_ps(wz + i)));
+				const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_and_ps(u, absMask), _mm_and_ps(v, absMask)),
+					_mm_and_ps(w, absMask));
+				const int outside = _mm_movemask_ps(_mm_cmpgt_ps(_mm_sub_ps(dist, radius), epsilon));
+				culled[i] |= (u8)(outside & 1);
+				culled[i+1] |= (u8)((outside >> 1) & 1);
+				culled[i+2] |= (u8)((outside >> 2) & 1);
+				culled[i+3] |= (u8)((outside >> 3) & 1);
+			}
+#endif
+			for (; i<count; ++i)
+			{
+				// distance of the center minus distance of the corner nearest to the plane
+				const f32 dist = nx*cx[i] + ny*cy[i] + nz*cz[i] + d;
+				const f32 radius = core::abs_(nx*ux[i] + ny*uy[i] + nz*uz[i]) +
+					core::abs_(nx*vx[i] + ny*vy[i] + nz*vz[i]) +
+					core::abs_(nx*wx[i] + ny*wy[i] + nz*wz[i]);
+				culled[i] |= (u8)(dist - radius > core::ROUNDING_ERROR_f32);
+			}
+		}
+	}
+
+	//! Writes an axis aligned box, transformed by a matrix, as entry i of count oriented boxes for cullOrientedBoxes
+	inline void setOrientedBox(f32* data, u32 count, u32 i, const core::matrix4& transformation, const core::aabbox3df& box)
+	{
+		const f32* m = transformation.pointer();
+		const core::vector3df extent = box.getExtent() * 0.5f;
+		core::vector3df center = box.getCenter();
+		transformation.transformVect(center);
+
+		data[i] = center.X;
+		data[i + count] = center.Y;
+		data[i + count*2] = center.Z;
+		data[i + count*3] = m[0] * extent.X;
+		data[i + count*4] = m[1] * extent.X;
+		data[i + count*5] = m[2] * extent.X;
+		data[i + count*6] = m[4] * extent.Y;
+		data[i + count*7] = m[5] * extent.Y;
+		data[i + count*8] = m[6] * extent.Y;
+		data[i + count*9] = m[8] * extent.Z;
+		data[i + count*10] = m[9] * extent.Z;
+		data[i + count*11] = m[10] * extent.Z;
+	}
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
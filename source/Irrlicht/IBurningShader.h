@@ -58,10 +58,13 @@ namespace video
 		void reset ()
 		{
 			Light.set_used ( 0 );
+			LightOn.set_used ( 0 );
 			Global_AmbientLight.set ( 0.f, 0.f, 0.f );
 			Flags = 0;
 		}
 		core::array<SBurningShaderLight> Light;
+		//! sorted indices of the lights which are switched on
+		core::array<u32> LightOn;
 		sVec3 Global_AmbientLight;
 		sVec4 FogColor;
 		sVec4 campos;
@@ -113,6 +116,7 @@ namespace video
 
 		ETR_NORMAL_MAP_SOLID,
 		ETR_STENCIL_SHADOW,
+		ETR_OCCLUSION_QUERY,
 
 		ETR_TEXTURE_BLEND,
 		ETR_REFERENCE,
@@ -144,6 +148,9 @@ namespace video
 
 		virtual void setMaterial ( const SBurningShaderMaterial &material ) {};
 
+		//! samples which passed the depth test since the last call, for occlusion queries
+		virtual u32 getSamplesPassed() { return 0; }
+
 	protected:
 
 		CBurningVideoDriver *Driver;
@@ -189,6 +196,7 @@ namespace video
 
 	IBurningShader* createTRNormalMap(CBurningVideoDriver* driver);
 	IBurningShader* createTRStencilShadow(CBurningVideoDriver* driver);
+	IBurningShader* createTROcclusionQuery(CBurningVideoDriver* driver);
 
 	IBurningShader* createTriangleRendererReference(CBurningVideoDriver* driver);
 
@@ -42,6 +42,10 @@ static const char* const copyright = "Irrlicht Engine (c) 2002-2017 Nikolaus Geb
 #include "CIrrDeviceConsole.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+#include "CIrrDeviceOffscreen.h"
+#endif
+
 namespace irr
 {
 	//! stub for calling createDeviceEx
@@ -104,6 +108,12 @@ namespace irr
 			dev = new CIrrDeviceConsole(params);
 #endif
 
+#ifdef _IRR_COMPILE_WITH_OFFSCREEN_DEVICE_
+		// only on request, as it has no output without frame receiver or stream
+		if (params.DeviceType == EIDT_OFFSCREEN)
+			dev = new CIrrDeviceOffscreen(params);
+#endif
+
 		if (dev && !dev->getVideoDriver() && params.DriverType != video::EDT_NULL)
 		{
 			dev->closeDevice(); // destroy window
@@ -31,7 +31,7 @@ public:
 	struct SMeshChunk : public scene::CMeshBuffer<T>
 	{
 		SMeshChunk ()
-			: scene::CMeshBuffer<T>(), MaterialId(0)
+			: scene::CMeshBuffer<T>(), MaterialId(0), VisibleRevision(0)
 		{
 			scene::CMeshBuffer<T>::grab();
 		}
@@ -42,6 +42,11 @@ public:
 		}
 
 		s32 MaterialId;
+
+		//! visible indices for hardware buffers, copied from the index ranges
+		core::array<u16> VisibleIndices;
+		//! revision of the index data the visible indices were copied from
+		u32 VisibleRevision;
 	};
 
 	struct SIndexChunk
@@ -50,19 +55,33 @@ public:
 		s32 MaterialId;
 	};
 
+	//! contiguous part of the indices of a mesh chunk
+	struct SIndexRange
+	{
+		u32 Offset;
+		u32 Count;
+	};
+
+	//! visible parts of a mesh chunk
 	struct SIndexData
 	{
-		u16* Indices;
+		//! ranges of Indices in the mesh chunk, sorted and merged where they touch
+		core::array<SIndexRange> Ranges;
+		//! number of indices in all ranges
 		s32 CurrentSize;
-		s32 MaxSize;
+		//! changes when the ranges change
+		u32 Revision;
 	};
 
 
 	//! Constructor
-	Octree(const core::array<SMeshChunk>& meshes, s32 minimalPolysPerNode=128) :
-		IndexData(0), IndexDataCount(meshes.size()), NodeCount(0)
+	/** The indices of the meshes are sorted by the tree, so the triangles
+	of each node and of each subtree are a contiguous range of them. */
+	Octree(core::array<SMeshChunk>& meshes, s32 minimalPolysPerNode=128) :
+		IndexData(0), IndexDataCount(meshes.size()), NodeCount(0), LastRanges(0), LastQuery(EOQ_NONE)
 	{
 		IndexData = new SIndexData[IndexDataCount];
+		LastRanges = new core::array<SIndexRange>[IndexDataCount];
 
 		// construct array of all indices
 
@@ -71,8 +90,8 @@ public:
 		for (u32 i=0; i!=meshes.size(); ++i)
 		{
 			IndexData[i].CurrentSize = 0;
-			IndexData[i].MaxSize = meshes[i].Indices.size();
-			IndexData[i].Indices = new u16[IndexData[i].MaxSize];
+			IndexData[i].Revision = 1;
+			meshes[i].VisibleRevision = 0;
 
 			indexChunks->push_back(SIndexChunk());
 			SIndexChunk& tic = indexChunks->getLast();
@@ -83,26 +102,49 @@ public:
 
 		// create tree
 		Root = new OctreeNode(NodeCount, 0, meshes, indexChunks, minimalPolysPerNode);
+
+		// store the indices in the order of the nodes
+		for (u32 i=0; i!=meshes.size(); ++i)
+			meshes[i].Indices.set_used(0);
+		Root->sortIndices(meshes);
+		for (u32 i=0; i!=meshes.size(); ++i)
+			meshes[i].setDirty(scene::EBT_INDEX);
 	}
 
 	//! returns all ids of polygons partially or fully enclosed
 	//! by this bounding box.
-	void calculatePolys(const core::aabbox3d<f32>& box)
+	/** \return True if the visible index ranges changed since the last call. */
+	bool calculatePolys(const core::aabbox3d<f32>& box)
 	{
-		for (u32 i=0; i!=IndexDataCount; ++i)
-			IndexData[i].CurrentSize = 0;
+		if (LastQuery == EOQ_BOX && box == LastBox)
+			return false;
+		LastQuery = EOQ_BOX;
+		LastBox = box;
 
+		beginRanges();
 		Root->getPolys(box, IndexData, 0);
+		return endRanges();
 	}
 
 	//! returns all ids of polygons partially or fully enclosed
 	//! by a view frustum.
-	void calculatePolys(const scene::SViewFrustum& frustum)
+	/** \return True if the visible index ranges changed since the last call. */
+	bool calculatePolys(const scene::SViewFrustum& frustum)
 	{
-		for (u32 i=0; i!=IndexDataCount; ++i)
-			IndexData[i].CurrentSize = 0;
+		if (LastQuery == EOQ_FRUSTUM)
+		{
+			u32 i=0;
+			while (i!=scene::SViewFrustum::VF_PLANE_COUNT && frustum.planes[i] == LastFrustum.planes[i])
+				++i;
+			if (i == scene::SViewFrustum::VF_PLANE_COUNT)
+				return false;
+		}
+		LastQuery = EOQ_FRUSTUM;
+		LastFrustum = frustum;
 
+		beginRanges();
 		Root->getPolys(frustum, IndexData, 0);
+		return endRanges();
 	}
 
 	const SIndexData* getIndexData() const
@@ -130,14 +172,67 @@ public:
 	//! destructor
 	~Octree()
 	{
-		for (u32 i=0; i<IndexDataCount; ++i)
-			delete [] IndexData[i].Indices;
-
 		delete [] IndexData;
+		delete [] LastRanges;
 		delete Root;
 	}
 
 private:
+
+	//! Appends a range of indices, merges it with the last one when they touch
+	static void addRange(SIndexData& data, u32 offset, u32 count)
+	{
+		if (!count)
+			return;
+
+		data.CurrentSize += count;
+		if (!data.Ranges.empty())
+		{
+			SIndexRange& last = data.Ranges.getLast();
+			if (last.Offset + last.Count == offset)
+			{
+				last.Count += count;
+				return;
+			}
+		}
+
+		SIndexRange range;
+		range.Offset = offset;
+		range.Count = count;
+		data.Ranges.push_back(range);
+	}
+
+	//! Keeps the ranges of the last query to find changes
+	void beginRanges()
+	{
+		for (u32 i=0; i!=IndexDataCount; ++i)
+		{
+			IndexData[i].Ranges.swap(LastRanges[i]);
+			IndexData[i].Ranges.set_used(0);
+			IndexData[i].CurrentSize = 0;
+		}
+	}
+
+	//! Compares the new ranges with the ones of the last query
+	bool endRanges()
+	{
+		bool changed = false;
+		for (u32 i=0; i!=IndexDataCount; ++i)
+		{
+			const core::array<SIndexRange>& ranges = IndexData[i].Ranges;
+			const core::array<SIndexRange>& last = LastRanges[i];
+			bool same = ranges.size() == last.size();
+			for (u32 r=0; same && r<ranges.size(); ++r)
+				same = ranges[r].Offset == last[r].Offset && ranges[r].Count == last[r].Count;
+
+			if (!same)
+			{
+				++IndexData[i].Revision;
+				changed = true;
+			}
+		}
+		return changed;
+	}
 	// private inner class
 	class OctreeNode
 	{
@@ -262,6 +357,39 @@ private:
 				delete Children[i];
 		}
 
+		// appends the indices of the node and then of its children to the meshes,
+		// so each subtree is one range of indices
+		void sortIndices(core::array<SMeshChunk>& meshes)
+		{
+			u32 i;
+			Ranges.set_used(meshes.size());
+			for (i=0; i<meshes.size(); ++i)
+			{
+				Ranges[i].Offset = meshes[i].Indices.size();
+				Ranges[i].Count = 0;
+				Ranges[i].SubtreeCount = 0;
+
+				if (IndexData && i<IndexData->size())
+				{
+					const core::array<u16>& indices = (*IndexData)[i].Indices;
+					Ranges[i].Count = indices.size();
+					for (u32 j=0; j<indices.size(); ++j)
+						meshes[i].Indices.push_back(indices[j]);
+				}
+			}
+
+			// the indices are in the meshes now
+			delete IndexData;
+			IndexData = 0;
+
+			for (i=0; i!=8; ++i)
+				if (Children[i])
+					Children[i]->sortIndices(meshes);
+
+			for (i=0; i<meshes.size(); ++i)
+				Ranges[i].SubtreeCount = meshes[i].Indices.size() - Ranges[i].Offset;
+		}
+
 		// returns all ids of polygons partially or full enclosed
 		// by this bounding box.
 		void getPolys(const core::aabbox3d<f32>& box, SIndexData* idxdata, u32 parentTest ) const
@@ -281,20 +409,21 @@ private:
 			if (Box.intersectsWithBox(box))
 #endif
 			{
-				const u32 cnt = IndexData->size();
+				const u32 cnt = Ranges.size();
 				u32 i; // new ISO for scoping problem in some compilers
 
-				for (i=0; i<cnt; ++i)
+#if defined (OCTREE_PARENTTEST )
+				// all children are inside as well
+				if ( parentTest == 2 )
 				{
-					const s32 idxcnt = (*IndexData)[i].Indices.size();
-
-					if (idxcnt)
-					{
-						memcpy(&idxdata[i].Indices[idxdata[i].CurrentSize],
-							&(*IndexData)[i].Indices[0], idxcnt * sizeof(s16));
-						idxdata[i].CurrentSize += idxcnt;
-					}
+					for (i=0; i<cnt; ++i)
+						addRange(idxdata[i], Ranges[i].Offset, Ranges[i].SubtreeCount);
+					return;
 				}
+#endif
+
+				for (i=0; i<cnt; ++i)
+					addRange(idxdata[i], Ranges[i].Offset, Ranges[i].Count);
 
 				for (i=0; i!=8; ++i)
 					if (Children[i])
@@ -329,19 +458,20 @@ private:
 			}
 
 
-			const u32 cnt = IndexData->size();
+			const u32 cnt = Ranges.size();
 
-			for (i=0; i!=cnt; ++i)
+#if defined (OCTREE_PARENTTEST )
+			// all children are inside as well
+			if ( parentTest == 2 )
 			{
-				s32 idxcnt = (*IndexData)[i].Indices.size();
-
-				if (idxcnt)
-				{
-					memcpy(&idxdata[i].Indices[idxdata[i].CurrentSize],
-						&(*IndexData)[i].Indices[0], idxcnt * sizeof(s16));
-					idxdata[i].CurrentSize += idxcnt;
-				}
+				for (i=0; i!=cnt; ++i)
+					addRange(idxdata[i], Ranges[i].Offset, Ranges[i].SubtreeCount);
+				return;
 			}
+#endif
+
+			for (i=0; i!=cnt; ++i)
+				addRange(idxdata[i], Ranges[i].Offset, Ranges[i].Count);
 
 			for (i=0; i!=8; ++i)
 				if (Children[i])
@@ -364,16 +494,43 @@ private:
 
 	private:
 
+		// indices of a mesh chunk belonging to the node
+		struct SNodeRange
+		{
+			u32 Offset;
+			// indices of the node itself
+			u32 Count;
+			// indices of the node and all its children
+			u32 SubtreeCount;
+		};
+
 		core::aabbox3df Box;
+		// only used while the tree is created
 		core::array<SIndexChunk>* IndexData;
+		core::array<SNodeRange> Ranges;
 		OctreeNode* Children[8];
 		u32 Depth;
 	};
 
+	enum E_OCTREE_QUERY
+	{
+		EOQ_NONE,
+		EOQ_BOX,
+		EOQ_FRUSTUM
+	};
+
 	OctreeNode* Root;
 	SIndexData* IndexData;
 	u32 IndexDataCount;
 	u32 NodeCount;
+
+	//! ranges of the last query
+	core::array<SIndexRange>* LastRanges;
+
+	//! the last query, ranges are only calculated again when it changes
+	E_OCTREE_QUERY LastQuery;
+	core::aabbox3df LastBox;
+	scene::SViewFrustum LastFrustum;
 };
 
 } // end namespace
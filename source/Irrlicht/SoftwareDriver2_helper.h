@@ -450,6 +450,26 @@ inline u32 PixelCombine32 ( const u32 c2, const u32 c1 )
 	return blendAlpha_fix8 << 24 | rb | xg;
 }
 
+/*!
+	Pixel = source + dest * ( 1 - SourceAlpha ) for all channels,
+	source color is premultiplied with its alpha
+*/
+inline u32 PixelBlendPremultiplied32 ( const u32 c2, const u32 c1 )
+{
+	u32 alpha = c1 >> 24;
+
+	// add highbit alpha, if ( alpha > 127 ) alpha += 1;
+	alpha += ( alpha >> 7);
+	alpha = 256 - alpha;
+
+	const u32 rb = ( ( ( c2 & 0x00FF00FF ) * alpha ) >> 8 ) & 0x00FF00FF;
+	const u32 ag = ( ( ( c2 >> 8 ) & 0x00FF00FF ) * alpha ) & 0xFF00FF00;
+	const u32 dest = ag | rb;
+
+	const u32 a = ( dest >> 24 ) + ( c1 >> 24 );
+	return ( a > 255 ? 0xFF000000 : a << 24 ) | PixelAdd32 ( dest, c1 );
+}
+
 
 
 // ------------------ Fix Point ----------------------------------
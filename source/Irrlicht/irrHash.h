@@ -0,0 +1,27 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_HASH_H_INCLUDED__
+#define __IRR_HASH_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace core
+{
+	//! Hash of a pointer for open addressing hash tables
+	/** Objects are aligned, so the low bits are dropped and the rest is mixed. */
+	inline u32 hashPointer(const void* pointer)
+	{
+		const size_t p = (size_t)pointer;
+		u32 h = (u32)(p >> 4) ^ (u32)(p >> 20);
+		h *= 0x9E3779B1;
+		return h ^ (h >> 15);
+	}
+
+} // end namespace core
+} // end namespace irr
+
+#endif
@@ -6,6 +6,7 @@
 #include "irrString.h"
 #include "IrrCompileConfig.h"
 #include "irrMath.h"
+#include "irrArray.h"
 
 #if defined(_IRR_COMPILE_WITH_SDL_DEVICE_)
 	#include <SDL/SDL_endian.h>
@@ -45,6 +46,17 @@ namespace os
 	// prevent accidental byte swapping of chars
 	u8  Byteswap::byteswap(u8 num)  {return num;}
 	c8  Byteswap::byteswap(c8 num)  {return num;}
+
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+	//! Code run by a thread from startParallelThread
+	class IParallelThread
+	{
+	public:
+		virtual ~IParallelThread() {}
+
+		virtual void runThread() = 0;
+	};
+#endif
 }
 }
 
@@ -126,6 +138,59 @@ namespace os
 		return GetTickCount();
 	}
 
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+	typedef HANDLE ParallelThread;
+
+	static u32 getCoreCount()
+	{
+		SYSTEM_INFO sysinfo;
+		GetSystemInfo(&sysinfo);
+		return sysinfo.dwNumberOfProcessors;
+	}
+
+	static long atomicIncrement(volatile long* value)
+	{
+		return InterlockedIncrement(value);
+	}
+
+	static bool atomicCompareAndSwap(volatile long* value, long expected, long desired)
+	{
+		return InterlockedCompareExchange(value, desired, expected) == expected;
+	}
+
+	//! Counts posts and lets as many waits return
+	class ParallelSemaphore
+	{
+	public:
+		ParallelSemaphore() { Handle = CreateSemaphore(0, 0, 0x7fffffff, 0); }
+		~ParallelSemaphore() { CloseHandle(Handle); }
+
+		void post() { ReleaseSemaphore(Handle, 1, 0); }
+		void wait() { WaitForSingleObject(Handle, INFINITE); }
+
+	private:
+		HANDLE Handle;
+	};
+
+	static DWORD WINAPI parallelThreadMain(void* data)
+	{
+		((IParallelThread*)data)->runThread();
+		return 0;
+	}
+
+	static bool startParallelThread(ParallelThread& thread, IParallelThread* body)
+	{
+		thread = CreateThread(0, 0, parallelThreadMain, body, 0, 0);
+		return thread != 0;
+	}
+
+	static void joinParallelThread(ParallelThread& thread)
+	{
+		WaitForSingleObject(thread, INFINITE);
+		CloseHandle(thread);
+	}
+#endif
+
 } // end namespace os
 
 
@@ -138,6 +203,10 @@ namespace os
 #include <stdio.h>
 #include <time.h>
 #include <sys/time.h>
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 namespace irr
 {
@@ -161,6 +230,81 @@ namespace os
 		gettimeofday(&tv, 0);
 		return (u32)(tv.tv_sec * 1000) + (tv.tv_usec / 1000);
 	}
+
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+	typedef pthread_t ParallelThread;
+
+	static u32 getCoreCount()
+	{
+		const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		return cores > 0 ? (u32)cores : 1;
+	}
+
+	static long atomicIncrement(volatile long* value)
+	{
+		return __sync_add_and_fetch(value, 1);
+	}
+
+	static bool atomicCompareAndSwap(volatile long* value, long expected, long desired)
+	{
+		return __sync_bool_compare_and_swap(value, expected, desired);
+	}
+
+	//! Counts posts and lets as many waits return
+	class ParallelSemaphore
+	{
+	public:
+		ParallelSemaphore() : Count(0)
+		{
+			pthread_mutex_init(&Mutex, 0);
+			pthread_cond_init(&Condition, 0);
+		}
+
+		~ParallelSemaphore()
+		{
+			pthread_cond_destroy(&Condition);
+			pthread_mutex_destroy(&Mutex);
+		}
+
+		void post()
+		{
+			pthread_mutex_lock(&Mutex);
+			++Count;
+			pthread_cond_signal(&Condition);
+			pthread_mutex_unlock(&Mutex);
+		}
+
+		void wait()
+		{
+			pthread_mutex_lock(&Mutex);
+			while (!Count)
+				pthread_cond_wait(&Condition, &Mutex);
+			--Count;
+			pthread_mutex_unlock(&Mutex);
+		}
+
+	private:
+		pthread_mutex_t Mutex;
+		pthread_cond_t Condition;
+		u32 Count;
+	};
+
+	static void* parallelThreadMain(void* data)
+	{
+		((IParallelThread*)data)->runThread();
+		return 0;
+	}
+
+	static bool startParallelThread(ParallelThread& thread, IParallelThread* body)
+	{
+		return pthread_create(&thread, 0, parallelThreadMain, body) == 0;
+	}
+
+	static void joinParallelThread(ParallelThread& thread)
+	{
+		pthread_join(thread, 0);
+	}
+#endif
 } // end namespace os
 
 #endif // end linux / windows
@@ -347,6 +491,237 @@ namespace os
 		StartRealTime = StaticTime;
 	}
 
+
+	// ------------------------------------------------------
+	// parallel jobs
+
+	u32 Parallel::ThreadCount = 0;
+
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+	struct SParallelRun
+	{
+		IParallelJob* Job;
+		u32 Count;
+		volatile long Next;
+	};
+
+	// each thread grabs the next unprocessed part until all are done
+	static void runParallelParts(SParallelRun* r)
+	{
+		for (;;)
+		{
+			const u32 index = (u32)(atomicIncrement(&r->Next) - 1);
+			if (index >= r->Count)
+				break;
+			r->Job->run(index);
+		}
+	}
+
+	//! Worker threads which are started once and then wait for the parts of the next run
+	/** Only one run at a time uses the pool. Runs started meanwhile, for
+	example from inside a job, do their parts on their own thread. */
+	class CParallelPool
+	{
+	public:
+		CParallelPool() : Run(0), Busy(0), Quit(false) {}
+
+		~CParallelPool()
+		{
+			Quit = true;
+			for (u32 i=0; i<Workers.size(); ++i)
+				Start.post();
+			for (u32 i=0; i<Workers.size(); ++i)
+			{
+				joinParallelThread(Workers[i]->Thread);
+				delete Workers[i];
+			}
+		}
+
+		//! takes the pool for one run, false while another run is using it
+		bool acquire()
+		{
+			return atomicCompareAndSwap(&Busy, 0, 1);
+		}
+
+		//! runs the parts with up to helpers workers and the calling thread, then releases the pool
+		void run(SParallelRun& r, u32 helpers)
+		{
+			while (Workers.size() < helpers)
+			{
+				SWorker* worker = new SWorker(this);
+				if (!startParallelThread(worker->Thread, worker))
+				{
+					delete worker;
+					break;
+				}
+				Workers.push_back(worker);
+			}
+			helpers = core::min_(helpers, Workers.size());
+
+			Run = &r;
+			for (u32 i=0; i<helpers; ++i)
+				Start.post();
+			runParallelParts(&r);
+			for (u32 i=0; i<helpers; ++i)
+				Done.wait();
+			Run = 0;
+
+			atomicCompareAndSwap(&Busy, 1, 0);
+		}
+
+	private:
+
+		struct SWorker : public IParallelThread
+		{
+			SWorker(CParallelPool* pool) : Pool(pool) {}
+
+			virtual void runThread() _IRR_OVERRIDE_
+			{
+				for (;;)
+				{
+					Pool->Start.wait();
+					if (Pool->Quit)
+						return;
+					runParallelParts(Pool->Run);
+					Pool->Done.post();
+				}
+			}
+
+			CParallelPool* Pool;
+			ParallelThread Thread;
+		};
+		friend struct SWorker;
+
+		core::array<SWorker*> Workers;
+		ParallelSemaphore Start;
+		ParallelSemaphore Done;
+		SParallelRun* volatile Run;
+		volatile long Busy;
+		volatile bool Quit;
+	};
+
+	static CParallelPool ParallelPool;
+#endif
+
+	void Parallel::run(IParallelJob& job, u32 count)
+	{
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+		const u32 threadCount = core::min_(getThreadCount(), count);
+		if (threadCount > 1 && ParallelPool.acquire())
+		{
+			SParallelRun r;
+			r.Job = &job;
+			r.Count = count;
+			r.Next = 0;
+
+			// the calling thread is working as well
+			ParallelPool.run(r, threadCount-1);
+			return;
+		}
+#endif
+		for (u32 i=0; i<count; ++i)
+			job.run(i);
+	}
+
+	u32 Parallel::getThreadCount()
+	{
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+		const u32 count = ThreadCount ? ThreadCount : getCoreCount();
+		return core::clamp(count, (u32)1, (u32)64);
+#else
+		return 1;
+#endif
+	}
+
+	void Parallel::setThreadCount(u32 count)
+	{
+		ThreadCount = count;
+	}
+
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+	// a parallel run with the single part index, done by a thread which is
+	// started with the first job and then waits for the next one
+	struct SBackgroundRun : public IParallelThread
+	{
+		SBackgroundRun() : Started(false), Busy(false), Quit(false) {}
+
+		virtual void runThread() _IRR_OVERRIDE_
+		{
+			for (;;)
+			{
+				Start.wait();
+				if (Quit)
+					return;
+				runParallelParts(&Parts);
+				Done.post();
+			}
+		}
+
+		SParallelRun Parts;
+		ParallelThread Thread;
+		ParallelSemaphore Start;
+		ParallelSemaphore Done;
+		bool Started;
+		bool Busy;
+		volatile bool Quit;
+	};
+#else
+	struct SBackgroundRun
+	{
+	};
+#endif
+
+	BackgroundJob::BackgroundJob() : Run(0)
+	{
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+		Run = new SBackgroundRun;
+#endif
+	}
+
+	BackgroundJob::~BackgroundJob()
+	{
+		wait();
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+		if (Run->Started)
+		{
+			Run->Quit = true;
+			Run->Start.post();
+			joinParallelThread(Run->Thread);
+		}
+#endif
+		delete Run;
+	}
+
+	void BackgroundJob::start(IParallelJob& job, u32 index)
+	{
+		wait();
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+		Run->Parts.Job = &job;
+		Run->Parts.Count = index+1;
+		Run->Parts.Next = index;
+		if (!Run->Started)
+			Run->Started = startParallelThread(Run->Thread, Run);
+		if (Run->Started)
+		{
+			Run->Busy = true;
+			Run->Start.post();
+			return;
+		}
+#endif
+		job.run(index);
+	}
+
+	void BackgroundJob::wait()
+	{
+#if defined(_IRR_COMPILE_WITH_PARALLEL_JOBS_)
+		if (Run->Busy)
+		{
+			Run->Done.wait();
+			Run->Busy = false;
+		}
+#endif
+	}
+
 } // end namespace os
 } // end namespace irr
 
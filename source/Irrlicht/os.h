@@ -76,6 +76,70 @@ namespace os
 
 
 
+	//! Work which can be split into independent parts
+	class IParallelJob
+	{
+	public:
+		virtual ~IParallelJob() {}
+
+		//! processes one part of the job
+		/** Can be called at the same time from several threads, but
+		each index is only passed once. */
+		virtual void run(u32 index) = 0;
+	};
+
+	//! Runs parallel jobs on worker threads
+	/** The workers are started by the first job which needs them and then
+	wait for the next job, so starting a job is cheap enough to do every frame.
+	Jobs started while another one is running, also from inside a job, run all
+	their parts on the calling thread. Without _IRR_COMPILE_WITH_PARALLEL_JOBS_
+	all parts run on the calling thread. */
+	class Parallel
+	{
+	public:
+
+		//! calls job.run(i) for every i in [0, count) and returns once all parts are finished
+		static void run(IParallelJob& job, u32 count);
+
+		//! returns the number of threads used for jobs, at least 1
+		static u32 getThreadCount();
+
+		//! sets the number of threads used for jobs of the whole process, 0 uses one thread per core
+		static void setThreadCount(u32 count);
+
+	private:
+
+		static u32 ThreadCount;
+	};
+
+	struct SBackgroundRun;
+
+	//! Runs one job at a time on a background thread
+	/** The thread is started by the first job and waits for the next one
+	until the BackgroundJob is destroyed. Without _IRR_COMPILE_WITH_PARALLEL_JOBS_
+	or when no thread can be started the job runs on the calling thread inside
+	start(). */
+	class BackgroundJob
+	{
+	public:
+
+		BackgroundJob();
+
+		//! waits for the running job and ends the thread
+		~BackgroundJob();
+
+		//! waits for the job started before, then calls job.run(index) on the background thread
+		void start(IParallelJob& job, u32 index);
+
+		//! returns once the job started last is finished
+		void wait();
+
+	private:
+
+		SBackgroundRun* Run;
+	};
+
+
 	class Timer
 	{
 	public:
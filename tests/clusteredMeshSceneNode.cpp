@@ -0,0 +1,308 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+
+u32 getIndex(const scene::IMeshBuffer* mb, u32 i)
+{
+	if (mb->getIndexType() == video::EIT_32BIT)
+		return ((const u32*)mb->getIndices())[i];
+	return mb->getIndices()[i];
+}
+
+f32 getArea(scene::IMesh* mesh)
+{
+	f32 area = 0.f;
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const scene::IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		for (u32 i=0; i<mb->getIndexCount(); i+=3)
+		{
+			area += core::triangle3df(mb->getPosition(getIndex(mb, i)), mb->getPosition(getIndex(mb, i+1)),
+				mb->getPosition(getIndex(mb, i+2))).getArea();
+		}
+	}
+	return area;
+}
+
+//! Sphere with colors from its normals, so wrong triangles show up in screenshots
+scene::IMesh* createColoredSphere(scene::ISceneManager* smgr, f32 radius, u32 polyCountX, u32 polyCountY)
+{
+	scene::IMesh* mesh = smgr->getGeometryCreator()->createSphereMesh(radius, polyCountX, polyCountY);
+	scene::IMeshBuffer* mb = mesh->getMeshBuffer(0);
+	video::S3DVertex* vertices = (video::S3DVertex*)mb->getVertices();
+	for (u32 i=0; i<mb->getVertexCount(); ++i)
+	{
+		const core::vector3df& n = vertices[i].Normal;
+		vertices[i].Color.set(255, (u32)(127.f + n.X*127.f), (u32)(127.f + n.Y*127.f), (u32)(127.f + n.Z*127.f));
+	}
+	mb->getMaterial().Lighting = false;
+	return mesh;
+}
+
+video::IImage* renderScene(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+	return driver->createScreenShot();
+}
+
+//! Counts the pixels which differ noticeably
+u32 countDifferences(video::IImage* image, video::IImage* reference)
+{
+	u32 differences = 0;
+	const core::dimension2du size = image->getDimension();
+	for (u32 y=0; y<size.Height; ++y)
+	{
+		for (u32 x=0; x<size.Width; ++x)
+		{
+			const video::SColor a = image->getPixel(x, y);
+			const video::SColor b = reference->getPixel(x, y);
+			if (core::abs_((s32)a.getRed() - (s32)b.getRed()) > 8 ||
+				core::abs_((s32)a.getGreen() - (s32)b.getGreen()) > 8 ||
+				core::abs_((s32)a.getBlue() - (s32)b.getBlue()) > 8)
+				++differences;
+		}
+	}
+	return differences;
+}
+
+//! The clusters cover all triangles, and their spheres and cones contain them
+bool splitSphere(IrrlichtDevice* device)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::IMesh* mesh = smgr->getGeometryCreator()->createSphereMesh(10.f, 64, 64);
+	const u32 maxTriangles = 64;
+
+	core::array<scene::SMeshCluster> clusters;
+	scene::IMesh* clustered = smgr->getMeshManipulator()->createClusteredMesh(mesh, clusters, maxTriangles);
+
+	bool result = clustered->getMeshBufferCount() == 1 &&
+		clustered->getMeshBuffer(0)->getIndexCount() == mesh->getMeshBuffer(0)->getIndexCount() &&
+		clustered->getMeshBuffer(0)->getVertexCount() <= mesh->getMeshBuffer(0)->getVertexCount();
+	if (!result)
+		logTestString("Clustered mesh has other triangles\n");
+
+	const f32 area = getArea(mesh);
+	if (!core::equals(getArea(clustered), area, area * 0.0001f))
+	{
+		logTestString("Clustered mesh has an area of %f instead of %f\n", getArea(clustered), area);
+		result = false;
+	}
+
+	const scene::IMeshBuffer* mb = clustered->getMeshBuffer(0);
+	u32 next = 0;
+	for (u32 c=0; c<clusters.size(); ++c)
+	{
+		const scene::SMeshCluster& cluster = clusters[c];
+		if (cluster.MeshBuffer != 0 || cluster.FirstIndex != next || cluster.IndexCount == 0 ||
+			cluster.IndexCount % 3 || cluster.IndexCount > maxTriangles*3)
+		{
+			logTestString("Cluster %d has indices %d to %d\n", c, cluster.FirstIndex, cluster.FirstIndex + cluster.IndexCount);
+			result = false;
+			break;
+		}
+		next += cluster.IndexCount;
+
+		const f32 minDot = cluster.ConeCutoff < 1.f ? sqrtf(1.f - cluster.ConeCutoff*cluster.ConeCutoff) : -1.f;
+		for (u32 i=cluster.FirstIndex; i<next; i+=3)
+		{
+			const core::vector3df& a = mb->getPosition(getIndex(mb, i));
+			const core::vector3df& b = mb->getPosition(getIndex(mb, i+1));
+			const core::vector3df& d = mb->getPosition(getIndex(mb, i+2));
+			if (a.getDistanceFrom(cluster.Center) > cluster.Radius + 0.001f ||
+				b.getDistanceFrom(cluster.Center) > cluster.Radius + 0.001f ||
+				d.getDistanceFrom(cluster.Center) > cluster.Radius + 0.001f)
+			{
+				logTestString("Triangle %d outside of the sphere of cluster %d\n", i/3, c);
+				result = false;
+			}
+
+			const core::vector3df n = (b - a).crossProduct(d - a).normalize();
+			if (n.getLengthSQ() > 0.f && n.dotProduct(cluster.ConeAxis) < minDot - 0.001f)
+			{
+				logTestString("Triangle %d outside of the normal cone of cluster %d\n", i/3, c);
+				result = false;
+			}
+		}
+		if (!result)
+			break;
+	}
+	if (next != mb->getIndexCount())
+	{
+		logTestString("Clusters end at index %d of %d\n", next, mb->getIndexCount());
+		result = false;
+	}
+
+	// the clusters should be almost full
+	const u32 triangles = mb->getIndexCount() / 3;
+	logTestString("%d triangles in %d clusters\n", triangles, clusters.size());
+	if (clusters.size() * maxTriangles > triangles * 3 / 2)
+		result = false;
+
+	clustered->drop();
+	mesh->drop();
+	return result;
+}
+
+//! Draws the same as a mesh scene node, with fewer clusters when parts are not visible
+bool compareWithMeshNode(IrrlichtDevice* device)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::IMesh* mesh = createColoredSphere(smgr, 10.f, 64, 64);
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode();
+
+	const u32 VIEWS = 5;
+	const core::vector3df positions[VIEWS] = { core::vector3df(0.f, 5.f, -30.f), core::vector3df(3.f, 0.f, -11.f),
+		core::vector3df(0.f, 0.f, 0.f), core::vector3df(0.f, 5.f, -30.f), core::vector3df(20.f, 20.f, 20.f) };
+	const core::vector3df targets[VIEWS] = { core::vector3df(0.f, 0.f, 0.f), core::vector3df(10.f, 0.f, -8.f),
+		core::vector3df(0.f, 0.f, 10.f), core::vector3df(0.f, 0.f, 0.f), core::vector3df(0.f, 0.f, 0.f) };
+	// the fourth view shows the node mirrored
+	const core::vector3df scales[VIEWS] = { core::vector3df(1.f, 1.f, 1.f), core::vector3df(1.f, 1.f, 1.f),
+		core::vector3df(1.f, 1.f, 1.f), core::vector3df(-1.f, 1.f, 1.f), core::vector3df(1.f, 2.f, 0.5f) };
+
+	scene::IMeshSceneNode* meshNode = smgr->addMeshSceneNode(mesh);
+	scene::IClusteredMeshSceneNode* node = smgr->addClusteredMeshSceneNode(mesh);
+	bool result = node->getClusterCount() > 0 && node->getMesh() == mesh;
+
+	for (u32 v=0; v<VIEWS; ++v)
+	{
+		camera->setPosition(positions[v]);
+		camera->setTarget(targets[v]);
+
+		meshNode->setVisible(true);
+		meshNode->setScale(scales[v]);
+		node->setVisible(false);
+		video::IImage* reference = renderScene(device);
+
+		meshNode->setVisible(false);
+		node->setVisible(true);
+		node->setScale(scales[v]);
+		video::IImage* image = renderScene(device);
+
+		logTestString("View %d: %d of %d clusters visible\n", v, node->getVisibleClusterCount(), node->getClusterCount());
+		if (image && reference)
+		{
+			const u32 differences = countDifferences(image, reference);
+			if (differences)
+			{
+				logTestString("View %d: clusters differ from the mesh scene node in %d pixels\n", v, differences);
+				result = false;
+			}
+		}
+		if (image)
+			image->drop();
+		if (reference)
+			reference->drop();
+	}
+
+	// back faces from inside, only clusters too close to the camera for the cone test are left
+	camera->setPosition(positions[2]);
+	camera->setTarget(targets[2]);
+	node->setScale(scales[2]);
+	renderScene(device)->drop();
+	result &= node->getVisibleClusterCount() < node->getClusterCount() / 10;
+
+	// from outside the back half is culled by the normal cones
+	camera->setPosition(positions[0]);
+	camera->setTarget(targets[0]);
+	node->setScale(scales[0]);
+	renderScene(device)->drop();
+	const u32 front = node->getVisibleClusterCount();
+	result &= front > 0 && front < node->getClusterCount() * 3 / 4;
+
+	// both sides are drawn without back face culling
+	node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, false);
+	renderScene(device)->drop();
+	result &= node->getVisibleClusterCount() == node->getClusterCount();
+	node->setMaterialFlag(video::EMF_BACK_FACE_CULLING, true);
+
+	// no culling at all
+	node->setAutomaticCulling(scene::EAC_OFF);
+	renderScene(device)->drop();
+	result &= node->getVisibleClusterCount() == node->getClusterCount();
+	node->setAutomaticCulling(scene::EAC_BOX);
+
+	// smaller clusters are culled more exactly
+	const u32 count = node->getClusterCount();
+	node->setClusterSize(32);
+	renderScene(device)->drop();
+	result &= node->getClusterSize() == 32 && node->getClusterCount() > count &&
+		node->getVisibleClusterCount() > front;
+
+	node->remove();
+	meshNode->remove();
+	camera->remove();
+	mesh->drop();
+	return result;
+}
+
+//! A large mesh seen from close by, drawn by a mesh scene node and by a clustered node
+void compareSpeed(IrrlichtDevice* device)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	ITimer* timer = device->getTimer();
+
+	// 16 spheres in one mesh
+	scene::SMesh* mesh = new scene::SMesh();
+	for (u32 i=0; i<16; ++i)
+	{
+		scene::IMesh* sphere = createColoredSphere(smgr, 10.f, 200, 160);
+		core::matrix4 m;
+		m.setTranslation(core::vector3df((i % 4) * 25.f - 37.5f, 0.f, (i / 4) * 25.f - 37.5f));
+		smgr->getMeshManipulator()->transform(sphere, m);
+		mesh->addMeshBuffer(sphere->getMeshBuffer(0));
+		sphere->drop();
+	}
+	mesh->recalculateBoundingBox();
+
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(-25.f, 5.f, -25.f), core::vector3df(0.f, 0.f, 0.f));
+
+	scene::IMeshSceneNode* meshNode = smgr->addMeshSceneNode(mesh);
+	u32 start = timer->getRealTime();
+	for (u32 frame=0; frame<5; ++frame)
+		renderScene(device)->drop();
+	logTestString("Drawing %d triangles with a mesh scene node 5 times took %d ms\n",
+		smgr->getMeshManipulator()->getPolyCount(mesh), timer->getRealTime() - start);
+	meshNode->remove();
+
+	start = timer->getRealTime();
+	scene::IClusteredMeshSceneNode* node = smgr->addClusteredMeshSceneNode(mesh);
+	logTestString("Sorting them into %d clusters took %d ms\n", node->getClusterCount(), timer->getRealTime() - start);
+
+	start = timer->getRealTime();
+	for (u32 frame=0; frame<5; ++frame)
+		renderScene(device)->drop();
+	logTestString("Drawing %d visible clusters 5 times took %d ms\n", node->getVisibleClusterCount(), timer->getRealTime() - start);
+
+	node->remove();
+	camera->remove();
+	mesh->drop();
+}
+}
+
+// clustered mesh scene nodes look like mesh scene nodes, but draw fewer triangles
+bool clusteredMeshSceneNode()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	bool result = splitSphere(device);
+	result &= compareWithMeshNode(device);
+	compareSpeed(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
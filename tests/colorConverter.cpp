@@ -0,0 +1,201 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+const video::ECOLOR_FORMAT Formats[] =
+{
+	video::ECF_A1R5G5B5,
+	video::ECF_R5G6B5,
+	video::ECF_A8R8G8B8,
+	video::ECF_R8G8B8
+};
+
+const char* const FormatNames[] =
+{
+	"A1R5G5B5",
+	"R5G6B5",
+	"A8R8G8B8",
+	"R8G8B8"
+};
+
+const u32 FormatBytes[] = { 2, 2, 4, 3 };
+
+const u32 FormatCount = sizeof(Formats) / sizeof(Formats[0]);
+
+// the scalar conversion of one pixel, as done by the color converter before it used SIMD
+void refConvert(const u8* s, u32 sF, u8* d, u32 dF)
+{
+	if (sF == dF)
+	{
+		memcpy(d, s, FormatBytes[sF]);
+		return;
+	}
+
+	u16 c16 = 0;
+	u32 c32 = 0;
+	memcpy(&c16, s, 2);
+	memcpy(&c32, s, 4);
+	u16 d16 = 0;
+	u32 d32 = 0;
+
+	switch (Formats[sF])
+	{
+	case video::ECF_A1R5G5B5:
+		if (Formats[dF] == video::ECF_R5G6B5)
+			d16 = video::A1R5G5B5toR5G6B5(c16);
+		else if (Formats[dF] == video::ECF_A8R8G8B8)
+			d32 = video::A1R5G5B5toA8R8G8B8(c16);
+		else
+		{
+			d[2] = (u8)((c16 & 0x7c00) >> 7);
+			d[1] = (u8)((c16 & 0x03e0) >> 2);
+			d[0] = (u8)((c16 & 0x1f) << 3);
+		}
+		break;
+	case video::ECF_R5G6B5:
+		if (Formats[dF] == video::ECF_A1R5G5B5)
+			d16 = video::R5G6B5toA1R5G5B5(c16);
+		else if (Formats[dF] == video::ECF_A8R8G8B8)
+			d32 = video::R5G6B5toA8R8G8B8(c16);
+		else
+		{
+			d[0] = (u8)((c16 & 0xf800) >> 8);
+			d[1] = (u8)((c16 & 0x07e0) >> 3);
+			d[2] = (u8)((c16 & 0x001f) << 3);
+		}
+		break;
+	case video::ECF_A8R8G8B8:
+		if (Formats[dF] == video::ECF_A1R5G5B5)
+			d16 = video::A8R8G8B8toA1R5G5B5(c32);
+		else if (Formats[dF] == video::ECF_R5G6B5)
+			d16 = video::A8R8G8B8toR5G6B5(c32);
+		else
+		{
+			d[0] = s[2];
+			d[1] = s[1];
+			d[2] = s[0];
+		}
+		break;
+	case video::ECF_R8G8B8:
+		if (Formats[dF] == video::ECF_A1R5G5B5)
+			d16 = (u16)(0x8000 | ((s[0] >> 3) << 10) | ((s[1] >> 3) << 5) | (s[2] >> 3));
+		else if (Formats[dF] == video::ECF_R5G6B5)
+			d16 = (u16)(((s[0] >> 3) << 11) | ((s[1] >> 2) << 5) | (s[2] >> 3));
+		else
+			d32 = 0xff000000 | (s[0] << 16) | (s[1] << 8) | s[2];
+		break;
+	default:
+		break;
+	}
+
+	if (FormatBytes[dF] == 2)
+		memcpy(d, &d16, 2);
+	else if (FormatBytes[dF] == 4)
+		memcpy(d, &d32, 4);
+}
+
+void refConvert(const u8* s, u32 sF, s32 count, u8* d, u32 dF)
+{
+	for (s32 i=0; i<count; ++i)
+		refConvert(s + i * FormatBytes[sF], sF, d + i * FormatBytes[dF], dF);
+}
+
+// converts random pixels and compares with the scalar conversion, the bytes behind the target stay untouched
+bool checkConversion(video::IVideoDriver* driver, u32 sF, u32 dF, s32 count, u32 offset)
+{
+	const u32 guard = 16;
+	core::array<u8> source;
+	source.set_used((count + offset) * FormatBytes[sF] + guard);
+	for (u32 i=0; i<source.size(); ++i)
+		source[i] = (u8)rand();
+
+	const u32 targetSize = (count + offset) * FormatBytes[dF] + guard;
+	core::array<u8> target;
+	core::array<u8> expected;
+	target.set_used(targetSize);
+	expected.set_used(targetSize);
+	for (u32 i=0; i<targetSize; ++i)
+		target[i] = expected[i] = 0xCD;
+
+	const u8* s = source.const_pointer() + offset * FormatBytes[sF];
+	driver->convertColor(s, Formats[sF], count, target.pointer() + offset * FormatBytes[dF], Formats[dF]);
+	refConvert(s, sF, count, expected.pointer() + offset * FormatBytes[dF], dF);
+
+	for (u32 i=0; i<targetSize; ++i)
+	{
+		if (target[i] != expected[i])
+		{
+			logTestString("%s to %s of %d pixels differs at byte %d: %d, expected %d\n",
+				FormatNames[sF], FormatNames[dF], count, i, target[i], expected[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+// only logs the time of the converter and the scalar conversion
+void conversionSpeed(IrrlichtDevice* device, u32 sF, u32 dF)
+{
+	const s32 count = 1024 * 1024;
+	const u32 runs = 10;
+	core::array<u8> source;
+	core::array<u8> target;
+	source.set_used(count * FormatBytes[sF]);
+	target.set_used(count * FormatBytes[dF]);
+	for (u32 i=0; i<source.size(); ++i)
+		source[i] = (u8)rand();
+
+	ITimer* timer = device->getTimer();
+	u32 start = timer->getRealTime();
+	for (u32 r=0; r<runs; ++r)
+		device->getVideoDriver()->convertColor(source.const_pointer(), Formats[sF], count, target.pointer(), Formats[dF]);
+	const u32 convertTime = timer->getRealTime() - start;
+
+	start = timer->getRealTime();
+	for (u32 r=0; r<runs; ++r)
+		refConvert(source.const_pointer(), sF, count, target.pointer(), dF);
+	const u32 referenceTime = timer->getRealTime() - start;
+
+	logTestString("%s to %s, %d times %d pixels: converter %d ms, scalar %d ms\n",
+		FormatNames[sF], FormatNames[dF], runs, count, convertTime, referenceTime);
+}
+}
+
+// the color converter gives the same results as the scalar conversion for all pairs of formats
+bool colorConverter()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return true; // could not create selected driver.
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	srand(11);
+
+	// sizes around the block sizes of the converters, large ones are converted on several threads
+	const s32 counts[] = { 1, 3, 4, 5, 6, 7, 8, 9, 15, 16, 17, 33, 1001, 300007 };
+	bool result = true;
+	for (u32 sF=0; sF<FormatCount; ++sF)
+	{
+		for (u32 dF=0; dF<FormatCount; ++dF)
+		{
+			for (u32 c=0; c<sizeof(counts)/sizeof(counts[0]); ++c)
+			{
+				result &= checkConversion(driver, sF, dF, counts[c], 0);
+				result &= checkConversion(driver, sF, dF, counts[c], 1);
+			}
+		}
+	}
+
+	conversionSpeed(device, 0, 2);
+	conversionSpeed(device, 2, 0);
+	conversionSpeed(device, 3, 2);
+	conversionSpeed(device, 2, 3);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -83,12 +83,149 @@ bool testImageFormats()
 
 	return result;
 }
+
+// box filter as documented for IImage::copyToScalingBoxFilter, using getPixel only
+video::SColor referenceBox(video::IImage* image, s32 x, s32 y, s32 fx, s32 fy, s32 bias)
+{
+	const core::dimension2du size = image->getDimension();
+	s32 a=0, r=0, g=0, b=0;
+	for (s32 dy=0; dy<fy; ++dy)
+	{
+		for (s32 dx=0; dx<fx; ++dx)
+		{
+			const video::SColor c = image->getPixel(core::s32_min(x+dx, size.Width-1), core::s32_min(y+dy, size.Height-1));
+			a += c.getAlpha();
+			r += c.getRed();
+			g += c.getGreen();
+			b += c.getBlue();
+		}
+	}
+	// the sums are divided by the largest power of 2 not above the sample count
+	s32 sdiv = 0;
+	while ((2 << sdiv) <= fx*fy)
+		++sdiv;
+	return video::SColor(core::s32_clamp((a>>sdiv)+bias, 0, 255), core::s32_clamp((r>>sdiv)+bias, 0, 255),
+		core::s32_clamp((g>>sdiv)+bias, 0, 255), core::s32_clamp((b>>sdiv)+bias, 0, 255));
+}
+
+bool compareBoxFilter(video::IVideoDriver* driver, video::ECOLOR_FORMAT format,
+	const core::dimension2du& sourceSize, const core::dimension2du& targetSize, s32 bias)
+{
+	video::IImage* source = driver->createImage(format, sourceSize);
+	video::IImage* target = driver->createImage(format, targetSize);
+	for (u32 y=0; y<sourceSize.Height; ++y)
+		for (u32 x=0; x<sourceSize.Width; ++x)
+			source->setPixel(x, y, video::SColor((x*7+y)&0xFF, (x*y)&0xFF, (x+y*3)&0xFF, (x^y)&0xFF));
+
+	source->copyToScalingBoxFilter(target, bias);
+
+	const f32 stepX = (f32)sourceSize.Width / targetSize.Width;
+	const f32 stepY = (f32)sourceSize.Height / targetSize.Height;
+	const s32 fx = core::ceil32(stepX);
+	const s32 fy = core::ceil32(stepY);
+
+	// expected values pass through the target format like the filtered ones
+	video::IImage* expected = driver->createImage(format, core::dimension2du(1,1));
+
+	bool result = true;
+	f32 sy = 0.f;
+	for (u32 y=0; y<targetSize.Height && result; ++y)
+	{
+		f32 sx = 0.f;
+		for (u32 x=0; x<targetSize.Width && result; ++x)
+		{
+			expected->setPixel(0, 0, referenceBox(source, core::floor32(sx), core::floor32(sy), fx, fy, bias));
+			if (target->getPixel(x, y) != expected->getPixel(0, 0))
+			{
+				logTestString("Box filter differs at %d,%d for %dx%d to %dx%d\n", x, y,
+					sourceSize.Width, sourceSize.Height, targetSize.Width, targetSize.Height);
+				result = false;
+			}
+			sx += stepX;
+		}
+		sy += stepY;
+	}
+
+	expected->drop();
+	target->drop();
+	source->drop();
+	return result;
+}
+
+bool testImageScaling()
+{
+	IrrlichtDevice *device = createDevice(video::EDT_NULL, core::dimension2d<u32>(160,120));
+
+	if (device == 0)
+		return true; // could not create selected driver.
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	bool result = true;
+
+	// the fast box filter must give the same results as the generic one
+	result &= compareBoxFilter(driver, video::ECF_A8R8G8B8, core::dimension2du(256,256), core::dimension2du(64,64), 0);
+	result &= compareBoxFilter(driver, video::ECF_A8R8G8B8, core::dimension2du(300,200), core::dimension2du(70,33), 3);
+	result &= compareBoxFilter(driver, video::ECF_A8R8G8B8, core::dimension2du(640,480), core::dimension2du(17,13), -2);
+	result &= compareBoxFilter(driver, video::ECF_A1R5G5B5, core::dimension2du(128,96), core::dimension2du(50,40), 0);
+	result &= compareBoxFilter(driver, video::ECF_A8R8G8B8, core::dimension2du(40,30), core::dimension2du(80,60), 0);
+	// halving like mipmap levels, with a width which is no multiple of 4 and biases beyond the color range
+	result &= compareBoxFilter(driver, video::ECF_A8R8G8B8, core::dimension2du(126,90), core::dimension2du(63,45), 0);
+	result &= compareBoxFilter(driver, video::ECF_A8R8G8B8, core::dimension2du(64,64), core::dimension2du(32,32), -300);
+	result &= compareBoxFilter(driver, video::ECF_A8R8G8B8, core::dimension2du(64,32), core::dimension2du(32,16), 40);
+	result &= compareBoxFilter(driver, video::ECF_A1R5G5B5, core::dimension2du(130,66), core::dimension2du(65,33), 0);
+	result &= compareBoxFilter(driver, video::ECF_A1R5G5B5, core::dimension2du(32,32), core::dimension2du(16,16), 300);
+
+	// filters keep constant colors and don't change images scaled to the same size
+	const video::SColor color(200, 10, 128, 250);
+	video::IImage* constant = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(97,61));
+	constant->fill(color);
+	video::IImage* pattern = driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(64,48));
+	for (u32 y=0; y<48; ++y)
+		for (u32 x=0; x<64; ++x)
+			pattern->setPixel(x, y, video::SColor(255, (x*4)&0xFF, (y*5)&0xFF, ((x+y)*3)&0xFF));
+
+	const video::E_IMAGE_SCALING_FILTER filters[] = { video::EISF_BILINEAR, video::EISF_LANCZOS };
+	for (u32 f=0; f<2; ++f)
+	{
+		const core::dimension2du sizes[] = { core::dimension2du(31,17), core::dimension2du(200,130) };
+		for (u32 s=0; s<2; ++s)
+		{
+			video::IImage* scaled = driver->createImage(video::ECF_A8R8G8B8, sizes[s]);
+			constant->copyToScalingFiltered(scaled, filters[f]);
+			for (u32 y=0; y<sizes[s].Height; ++y)
+				for (u32 x=0; x<sizes[s].Width; ++x)
+					if (scaled->getPixel(x, y) != color)
+						result = false;
+			scaled->drop();
+		}
+
+		video::IImage* same = driver->createImage(video::ECF_A8R8G8B8, pattern->getDimension());
+		pattern->copyToScalingFiltered(same, filters[f]);
+		for (u32 y=0; y<48; ++y)
+			for (u32 x=0; x<64; ++x)
+				if (same->getPixel(x, y) != pattern->getPixel(x, y))
+					result = false;
+		same->drop();
+	}
+	if (!result)
+		logTestString("Filtered image scaling failed\n");
+
+	pattern->drop();
+	constant->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
 }
 
 bool createImage()
 {
 	bool result = testImageCreation();
 	result &= testImageFormats();
+	result &= testImageScaling();
 	return result;
 }
 
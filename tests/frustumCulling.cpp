@@ -0,0 +1,164 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+//! Node which remembers if it passed culling when it registered
+class CCullingTestNode : public scene::ISceneNode
+{
+public:
+	CCullingTestNode(scene::ISceneNode* parent, scene::ISceneManager* smgr, const core::aabbox3df& box)
+		: ISceneNode(parent, smgr), Box(box), Registered(false), Move(false)
+	{
+		setAutomaticCulling(scene::EAC_FRUSTUM_BOX);
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		if (IsVisible)
+		{
+			// moves after the scene manager tested all boxes
+			if (Move)
+			{
+				setPosition(getPosition() + core::vector3df(0.f, 0.f, 200.f));
+				updateAbsolutePosition();
+			}
+			Registered = SceneManager->registerNodeForRendering(this) != 0;
+		}
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	virtual void render() {}
+
+	virtual const core::aabbox3df& getBoundingBox() const
+	{
+		return Box;
+	}
+
+	core::aabbox3df Box;
+	bool Registered;
+	bool Move;
+};
+
+f32 randomRange(f32 low, f32 high)
+{
+	return low + (high - low) * (f32)(rand() % 10000) / 9999.f;
+}
+
+void createNodes(scene::ISceneManager* smgr, core::array<CCullingTestNode*>& nodes, u32 count)
+{
+	for (u32 i=0; i<count; ++i)
+	{
+		scene::ISceneNode* parent = smgr->getRootSceneNode();
+		if (nodes.size() && rand() % 5 == 0)
+			parent = nodes[rand() % nodes.size()];
+
+		const core::vector3df extent(randomRange(0.1f, 20.f), randomRange(0.1f, 20.f), randomRange(0.1f, 20.f));
+		const core::vector3df center(randomRange(-5.f, 5.f), randomRange(-5.f, 5.f), randomRange(-5.f, 5.f));
+		CCullingTestNode* node = new CCullingTestNode(parent, smgr, core::aabbox3df(center - extent, center + extent));
+		node->setPosition(core::vector3df(randomRange(-300.f, 300.f), randomRange(-300.f, 300.f), randomRange(-300.f, 300.f)));
+		node->setRotation(core::vector3df(randomRange(0.f, 360.f), randomRange(0.f, 360.f), randomRange(0.f, 360.f)));
+		node->setScale(core::vector3df(randomRange(0.2f, 3.f), randomRange(0.2f, 3.f), randomRange(0.2f, 3.f)));
+		nodes.push_back(node);
+		node->drop();
+	}
+}
+
+// nodes registered by drawAll have to pass the culling test done for single nodes
+bool compareWithSingleNodeCulling()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return true; // could not create selected driver.
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, -50.f), core::vector3df(30.f, 10.f, 100.f));
+
+	srand(4);
+	core::array<CCullingTestNode*> nodes;
+	createNodes(smgr, nodes, 3000);
+	for (u32 i=0; i<nodes.size(); i+=97)
+		nodes[i]->setVisible(false);
+	for (u32 i=1; i<nodes.size(); i+=31)
+		nodes[i]->Move = true;
+
+	smgr->drawAll();
+
+	bool result = true;
+	u32 culled = 0;
+	u32 drawn = 0;
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		const bool expected = nodes[i]->isTrulyVisible() && !smgr->isCulled(nodes[i]);
+		if (nodes[i]->Registered != expected)
+		{
+			logTestString("Node %d was %s\n", i, nodes[i]->Registered ? "not culled" : "culled");
+			result = false;
+		}
+		if (nodes[i]->Registered)
+			++drawn;
+		else
+			++culled;
+	}
+
+	if (!culled || !drawn)
+	{
+		logTestString("Test scene should contain culled and drawn nodes, %d culled, %d drawn\n", culled, drawn);
+		result = false;
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+// only logs the time needed for both ways of culling
+void cullingSpeed()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return;
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, -50.f), core::vector3df(0.f, 0.f, 100.f));
+
+	srand(5);
+	core::array<CCullingTestNode*> nodes;
+	createNodes(smgr, nodes, 20000);
+	smgr->drawAll();
+
+	ITimer* timer = device->getTimer();
+	const u32 runs = 10;
+
+	u32 start = timer->getRealTime();
+	for (u32 r=0; r<runs; ++r)
+		smgr->drawAll();
+	const u32 batched = timer->getRealTime() - start;
+
+	u32 visible = 0;
+	start = timer->getRealTime();
+	for (u32 r=0; r<runs; ++r)
+	{
+		for (u32 i=0; i<nodes.size(); ++i)
+			visible += smgr->isCulled(nodes[i]) ? 0 : 1;
+	}
+	const u32 single = timer->getRealTime() - start;
+
+	logTestString("Culling %d nodes %d times: drawAll %d ms, single nodes %d ms (%d visible)\n",
+		nodes.size(), runs, batched, single, visible / runs);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+}
+}
+
+bool frustumCulling()
+{
+	bool result = compareWithSingleNodeCulling();
+	cullingSpeed();
+	return result;
+}
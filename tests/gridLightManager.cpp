@@ -0,0 +1,150 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+video::SColor getScreenColor(scene::ISceneManager* smgr, video::IImage* screen, const core::vector3df& position)
+{
+	const core::position2di pos = smgr->getSceneCollisionManager()->getScreenCoordinatesFrom3DPosition(position);
+	return screen->getPixel(pos.X, pos.Y);
+}
+
+//! Node rendered in the light pass which adds no driver light
+class CLightPassNode : public scene::ISceneNode
+{
+public:
+	CLightPassNode(scene::ISceneManager* smgr)
+		: ISceneNode(smgr->getRootSceneNode(), smgr, -1)
+	{
+		setAutomaticCulling(scene::EAC_OFF);
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		if (IsVisible)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_LIGHT);
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	virtual void render() {}
+
+	virtual const core::aabbox3df& getBoundingBox() const
+	{
+		return Box;
+	}
+
+	core::aabbox3df Box;
+};
+
+//! Only the brightest light is switched on for each sphere
+bool checkSpheres(scene::ISceneManager* smgr, video::IVideoDriver* driver, const c8* name)
+{
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+
+	bool result = true;
+	video::IImage* screen = driver->createScreenShot();
+	if (screen)
+	{
+		const video::SColor left = getScreenColor(smgr, screen, core::vector3df(-20.f, 0.f, -5.f));
+		const video::SColor right = getScreenColor(smgr, screen, core::vector3df(20.f, 0.f, -5.f));
+		if (left.getRed() == 0 || left.getGreen() != 0 || left.getBlue() != 0)
+		{
+			logTestString("%s: Left sphere has color %d,%d,%d, expected red only\n", name, left.getRed(), left.getGreen(), left.getBlue());
+			result = false;
+		}
+		if (right.getBlue() == 0 || right.getGreen() != 0 || right.getRed() != 0)
+		{
+			logTestString("%s: Right sphere has color %d,%d,%d, expected blue only\n", name, right.getRed(), right.getGreen(), right.getBlue());
+			result = false;
+		}
+		screen->drop();
+	}
+	return result;
+}
+}
+
+// each sphere is only lit by the most relevant light next to it
+bool gridLightManager()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, -60.f), core::vector3df(0.f, 0.f, 0.f));
+
+	smgr->addSphereSceneNode(5.f, 32, 0, -1, core::vector3df(-20.f, 0.f, 0.f));
+	smgr->addSphereSceneNode(5.f, 32, 0, -1, core::vector3df(20.f, 0.f, 0.f));
+	smgr->addLightSceneNode(0, core::vector3df(-20.f, 0.f, -10.f), video::SColorf(1.f, 0.f, 0.f), 15.f);
+	smgr->addLightSceneNode(0, core::vector3df(20.f, 0.f, -10.f), video::SColorf(0.f, 0.f, 1.f), 15.f);
+	// weaker lights reaching the spheres as well
+	smgr->addLightSceneNode(0, core::vector3df(-20.f, 8.f, -8.f), video::SColorf(0.f, 0.3f, 0.f), 15.f);
+	smgr->addLightSceneNode(0, core::vector3df(20.f, 8.f, -8.f), video::SColorf(0.f, 0.3f, 0.f), 15.f);
+
+	// many small lights far away, which are not selected
+	for (u32 i=0; i<300; ++i)
+	{
+		smgr->addLightSceneNode(0, core::vector3df((f32)(i % 20) * 10.f - 100.f, 200.f, (f32)(i / 20) * 10.f - 100.f),
+			video::SColorf(0.f, 1.f, 0.f), 5.f);
+	}
+
+	// without light manager both lights reach the left sphere
+	bool result = true;
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+	video::IImage* screen = driver->createScreenShot();
+	if (screen)
+	{
+		const video::SColor left = getScreenColor(smgr, screen, core::vector3df(-20.f, 0.f, -5.f));
+		if (left.getRed() == 0 || left.getGreen() == 0)
+		{
+			logTestString("Left sphere has color %d,%d,%d without light manager, expected red and green\n", left.getRed(), left.getGreen(), left.getBlue());
+			result = false;
+		}
+		screen->drop();
+	}
+
+	scene::ILightManager* lightManager = smgr->createGridLightManager(1);
+	smgr->setLightManager(lightManager);
+	lightManager->drop();
+
+	result &= checkSpheres(smgr, driver, "grid light manager");
+
+	// the light list does not match the driver lights anymore
+	CLightPassNode* lightPassNode = new CLightPassNode(smgr);
+	lightPassNode->drop();
+	result &= checkSpheres(smgr, driver, "node without light in the light pass");
+
+	// lights are still switched on as before when the manager is removed
+	smgr->setLightManager(0);
+	lightPassNode->remove();
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->endScene();
+	screen = driver->createScreenShot();
+	if (screen)
+	{
+		const video::SColor left = getScreenColor(smgr, screen, core::vector3df(-20.f, 0.f, -5.f));
+		if (left.getRed() == 0 || left.getGreen() == 0)
+		{
+			logTestString("Left sphere has color %d,%d,%d after removing the light manager, expected red and green\n", left.getRed(), left.getGreen(), left.getBlue());
+			result = false;
+		}
+		screen->drop();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,168 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+//! Fills its area with a color and counts how often it was drawn
+class CCountingElement : public gui::IGUIElement
+{
+public:
+	CCountingElement(gui::IGUIEnvironment* env, const core::rect<s32>& rect, video::SColor color)
+		: gui::IGUIElement(gui::EGUIET_ELEMENT, env, env->getRootGUIElement(), -1, rect), Color(color), Draws(0)
+	{
+	}
+
+	virtual void draw()
+	{
+		if (!IsVisible)
+			return;
+		++Draws;
+		Environment->getVideoDriver()->draw2DRectangle(Color, AbsoluteRect, &AbsoluteClippingRect);
+		Environment->getSkin()->getFont()->draw(Text, AbsoluteRect, video::SColor(255, 0, 0, 0), true, true, &AbsoluteClippingRect);
+		gui::IGUIElement::draw();
+	}
+
+	video::SColor Color;
+	u32 Draws;
+};
+
+bool checkDraws(const CCountingElement* element, u32 expected, const char* name)
+{
+	if (element->Draws == expected)
+		return true;
+	logTestString("%s was drawn %d times, expected %d\n", name, element->Draws, expected);
+	return false;
+}
+
+void drawFrame(IrrlichtDevice* device)
+{
+	device->getVideoDriver()->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 100, 101, 140));
+	device->getGUIEnvironment()->drawAll();
+	device->getVideoDriver()->endScene();
+}
+}
+
+// unchanged top level elements are drawn from their cached textures, and look like drawn directly.
+// the default skin has translucent colors, which must not be blended twice
+bool guiRetainedMode()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	gui::IGUIEnvironment* env = device->getGUIEnvironment();
+	if (!driver->queryFeature(video::EVDF_RENDER_TO_TARGET))
+	{
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return true;
+	}
+
+	CCountingElement* first = new CCountingElement(env, core::rect<s32>(10, 10, 70, 50), video::SColor(255, 200, 40, 40));
+	CCountingElement* second = new CCountingElement(env, core::rect<s32>(50, 30, 150, 80), video::SColor(255, 40, 200, 40));
+	env->addButton(core::rect<s32>(10, 90, 70, 110), 0, -1, L"Button");
+	env->addStaticText(L"Text", core::rect<s32>(80, 90, 150, 110), true);
+
+	env->setRetainedMode(true);
+	bool result = env->isRetainedMode();
+
+	drawFrame(device);
+	result &= checkDraws(first, 1, "First element");
+	result &= checkDraws(second, 1, "Second element");
+
+	// nothing changed
+	drawFrame(device);
+	result &= checkDraws(first, 1, "Unchanged first element");
+	result &= checkDraws(second, 1, "Unchanged second element");
+
+	// only the changed element is drawn again
+	first->setText(L"Changed");
+	drawFrame(device);
+	result &= checkDraws(first, 2, "Changed first element");
+	result &= checkDraws(second, 1, "Second element after change of first");
+
+	second->setRelativePosition(core::rect<s32>(60, 30, 150, 85));
+	drawFrame(device);
+	result &= checkDraws(first, 2, "First element after move of second");
+	result &= checkDraws(second, 2, "Moved second element");
+
+	// the composed screen matches the directly drawn one
+	video::IImage* retained = driver->createScreenShot();
+	env->setRetainedMode(false);
+	drawFrame(device);
+	result &= checkDraws(first, 3, "First element in immediate mode");
+	video::IImage* immediate = driver->createScreenShot();
+
+	if (retained && immediate)
+	{
+		u32 differences = 0;
+		for (u32 y=0; y<params.WindowSize.Height; ++y)
+		{
+			for (u32 x=0; x<params.WindowSize.Width; ++x)
+			{
+				// the software blending of the layers may round differently
+				const video::SColor r = retained->getPixel(x, y);
+				const video::SColor i = immediate->getPixel(x, y);
+				if (core::abs_((s32)r.getRed() - (s32)i.getRed()) > 1 ||
+					core::abs_((s32)r.getGreen() - (s32)i.getGreen()) > 1 ||
+					core::abs_((s32)r.getBlue() - (s32)i.getBlue()) > 1)
+					++differences;
+			}
+		}
+		if (differences)
+		{
+			logTestString("Retained and immediate GUI differ in %d pixels\n", differences);
+			result = false;
+		}
+	}
+	if (retained)
+		retained->drop();
+	if (immediate)
+		immediate->drop();
+
+	// the layers are as large as the elements, not as their distance to the corner of the screen
+	env->setRetainedMode(true);
+	drawFrame(device);
+	for (u32 i=0; i<driver->getTextureCount(); ++i)
+	{
+		const video::ITexture* texture = driver->getTextureByIndex(i);
+		if (core::stringc(texture->getName().getPath()).find("<GUI layer") == 0 && texture->getSize().Height > 64)
+		{
+			logTestString("Layer %s is %d pixels high\n", texture->getName().getPath().c_str(), texture->getSize().Height);
+			result = false;
+		}
+	}
+
+	// a render target set by the application is set again after drawing the layers
+	video::ITexture* texture = driver->addRenderTargetTexture(params.WindowSize, "rt", video::ECF_A8R8G8B8);
+	video::IRenderTarget* target = driver->addRenderTarget();
+	target->setTexture(texture, 0);
+	driver->beginScene(video::ECBF_COLOR, video::SColor(255, 100, 101, 140));
+	driver->setRenderTargetEx(target, video::ECBF_COLOR, video::SColor(255, 100, 101, 140));
+	first->setText(L"Target");
+	env->drawAll();
+	result &= checkDraws(first, 5, "First element drawn to a render target");
+	if (driver->getCurrentRenderTarget() != target)
+	{
+		logTestString("The render target was not set again after drawing the layers\n");
+		result = false;
+	}
+	driver->setRenderTargetEx(0, 0);
+	driver->endScene();
+
+	first->drop();
+	second->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
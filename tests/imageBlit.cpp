@@ -0,0 +1,299 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+// scalar reference of the software blitter pixel operations, alpha is stretched to [0;256]
+u32 stretchAlpha(u32 a)
+{
+	return a + (a >> 7);
+}
+
+u32 lerpChannels(u32 dst, u32 src, u32 alpha)
+{
+	u32 result = 0;
+	for (u32 shift=0; shift<24; shift+=8)
+	{
+		const u32 d = (dst >> shift) & 0xFF;
+		const u32 s = (src >> shift) & 0xFF;
+		result |= ((d * (256 - alpha) + s * alpha) >> 8) << shift;
+	}
+	return result;
+}
+
+u32 mulChannels(u32 c0, u32 c1)
+{
+	u32 result = 0;
+	for (u32 shift=0; shift<32; shift+=8)
+		result |= ((((c0 >> shift) & 0xFF) * ((c1 >> shift) & 0xFF)) >> 8) << shift;
+	return result;
+}
+
+u32 refBlend(u32 dst, u32 src)
+{
+	const u32 a = src >> 24;
+	if (a == 0)
+		return dst;
+	return (src & 0xFF000000) | lerpChannels(dst, src, stretchAlpha(a));
+}
+
+u32 refCombine(u32 dst, u32 src)
+{
+	const u32 alpha = stretchAlpha(src >> 24);
+	const u32 a = ((src >> 24) * 256 + (dst >> 24) * (256 - alpha)) >> 8;
+	return (a << 24) | lerpChannels(dst, src, alpha);
+}
+
+u32 refColorAlpha(u32 dst, u32 color)
+{
+	return (color & 0xFF000000) | lerpChannels(dst, color, stretchAlpha(color >> 24));
+}
+
+u16 refTo16(u32 src)
+{
+	const u32 alpha = stretchAlpha(src >> 24);
+	const u32 premultiplied = lerpChannels(0, src, alpha) | ((src >> 24) >= 128 ? 0x80000000 : 0);
+	return video::A8R8G8B8toA1R5G5B5(premultiplied);
+}
+
+// fills the image with random colors, the alpha is often fully transparent or opaque
+void fillRandom(video::IImage* image)
+{
+	const u32 size = image->getImageDataSizeInBytes();
+	u8* data = (u8*)image->getData();
+	for (u32 i=0; i<size; ++i)
+		data[i] = (u8)rand();
+
+	if (image->getColorFormat() == video::ECF_A8R8G8B8)
+	{
+		u32* pixels = (u32*)data;
+		for (u32 i=0; i<size/4; ++i)
+		{
+			const u32 r = rand() % 4;
+			if (r == 0)
+				pixels[i] &= 0x00FFFFFF;
+			else if (r == 1)
+				pixels[i] |= 0xFF000000;
+		}
+	}
+}
+
+enum EBlitTest
+{
+	EBT_COPY_16_TO_32,
+	EBT_COPY_32_TO_16,
+	EBT_BLEND,
+	EBT_BLEND_COLOR,
+	EBT_COMBINE_COLOR,
+	EBT_COUNT
+};
+
+const char* const BlitTestNames[] =
+{
+	"copy 16 to 32",
+	"copy 32 to 16",
+	"alpha blend",
+	"alpha blend with color",
+	"alpha combine with color"
+};
+
+const u32 BlitColor = 0xC0FF8040;
+
+// blits with the image functions
+void blitImage(EBlitTest test, video::IImage* source, video::IImage* target)
+{
+	const core::rect<s32> rect(core::position2di(0, 0), source->getDimension());
+	switch (test)
+	{
+	case EBT_COPY_16_TO_32:
+	case EBT_COPY_32_TO_16:
+		source->copyTo(target);
+		break;
+	case EBT_BLEND:
+		source->copyToWithAlpha(target, core::position2di(0, 0), rect, video::SColor(0xFFFFFFFF));
+		break;
+	case EBT_BLEND_COLOR:
+		source->copyToWithAlpha(target, core::position2di(0, 0), rect, video::SColor(BlitColor));
+		break;
+	case EBT_COMBINE_COLOR:
+		source->copyToWithAlpha(target, core::position2di(0, 0), rect, video::SColor(BlitColor), 0, true);
+		break;
+	default:
+		break;
+	}
+}
+
+// blits with the reference functions
+void blitReference(EBlitTest test, video::IImage* source, video::IImage* target)
+{
+	const u32 count = source->getDimension().getArea();
+	const u8* src = (const u8*)source->getData();
+	u8* dst = (u8*)target->getData();
+	for (u32 i=0; i<count; ++i)
+	{
+		switch (test)
+		{
+		case EBT_COPY_16_TO_32:
+			((u32*)dst)[i] = video::A1R5G5B5toA8R8G8B8(((const u16*)src)[i]);
+			break;
+		case EBT_COPY_32_TO_16:
+			((u16*)dst)[i] = refTo16(((const u32*)src)[i]);
+			break;
+		case EBT_BLEND:
+			((u32*)dst)[i] = refBlend(((u32*)dst)[i], ((const u32*)src)[i]);
+			break;
+		case EBT_BLEND_COLOR:
+			((u32*)dst)[i] = refBlend(((u32*)dst)[i], mulChannels(((const u32*)src)[i], BlitColor));
+			break;
+		case EBT_COMBINE_COLOR:
+			((u32*)dst)[i] = refCombine(((u32*)dst)[i], mulChannels(((const u32*)src)[i], BlitColor));
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+video::ECOLOR_FORMAT getSourceFormat(EBlitTest test)
+{
+	return test == EBT_COPY_16_TO_32 ? video::ECF_A1R5G5B5 : video::ECF_A8R8G8B8;
+}
+
+video::ECOLOR_FORMAT getTargetFormat(EBlitTest test)
+{
+	return test == EBT_COPY_32_TO_16 ? video::ECF_A1R5G5B5 : video::ECF_A8R8G8B8;
+}
+
+// compares the blit of random images with the reference, large sizes are blitted in bands
+bool checkBlit(video::IVideoDriver* driver, EBlitTest test, const core::dimension2du& size)
+{
+	video::IImage* source = driver->createImage(getSourceFormat(test), size);
+	video::IImage* target = driver->createImage(getTargetFormat(test), size);
+	video::IImage* expected = driver->createImage(getTargetFormat(test), size);
+	fillRandom(source);
+	fillRandom(target);
+	target->copyTo(expected);
+
+	blitImage(test, source, target);
+	blitReference(test, source, expected);
+
+	bool result = true;
+	const u32 bytes = target->getImageDataSizeInBytes();
+	const u8* a = (const u8*)target->getData();
+	const u8* b = (const u8*)expected->getData();
+	for (u32 i=0; i<bytes; ++i)
+	{
+		if (a[i] != b[i])
+		{
+			logTestString("%s of %dx%d differs at byte %d: %d, expected %d\n",
+				BlitTestNames[test], size.Width, size.Height, i, a[i], b[i]);
+			result = false;
+			break;
+		}
+	}
+
+	source->drop();
+	target->drop();
+	expected->drop();
+	return result;
+}
+
+// only logs the throughput of the blitter and the reference
+void blitSpeed(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ITimer* timer = device->getTimer();
+	const core::dimension2du size(1024, 1024);
+	const u32 runs = 10;
+
+	for (u32 t=0; t<EBT_COUNT; ++t)
+	{
+		const EBlitTest test = (EBlitTest)t;
+		video::IImage* source = driver->createImage(getSourceFormat(test), size);
+		video::IImage* target = driver->createImage(getTargetFormat(test), size);
+		fillRandom(source);
+		fillRandom(target);
+
+		u32 start = timer->getRealTime();
+		for (u32 r=0; r<runs; ++r)
+			blitImage(test, source, target);
+		const u32 blitTime = core::max_(timer->getRealTime() - start, 1u);
+
+		start = timer->getRealTime();
+		for (u32 r=0; r<runs; ++r)
+			blitReference(test, source, target);
+		const u32 referenceTime = core::max_(timer->getRealTime() - start, 1u);
+
+		const f32 megaBytes = (f32)(source->getImageDataSizeInBytes() + target->getImageDataSizeInBytes()) * runs / (1024.f * 1024.f);
+		logTestString("%s: blitter %.0f MB/s, reference %.0f MB/s\n", BlitTestNames[test],
+			megaBytes * 1000.f / blitTime, megaBytes * 1000.f / referenceTime);
+
+		source->drop();
+		target->drop();
+	}
+}
+
+// the software renderer blends 2d rectangles with a constant alpha
+bool checkColorAlpha()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	const video::SColor background(255, 30, 200, 90);
+	const video::SColor color(100, 250, 20, 140);
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, background);
+	driver->draw2DRectangle(color, core::rect<s32>(10, 10, 150, 110));
+	driver->endScene();
+
+	bool result = true;
+	video::IImage* screen = driver->createScreenShot();
+	if (screen)
+	{
+		const u32 expected = refColorAlpha(background.color, color.color) & 0x00FFFFFF;
+		const u32 pixel = screen->getPixel(80, 60).color & 0x00FFFFFF;
+		if (pixel != expected)
+		{
+			logTestString("Blended rectangle has color %08x, expected %08x\n", pixel, expected);
+			result = false;
+		}
+		screen->drop();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+}
+
+bool imageBlit()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return true; // could not create selected driver.
+
+	srand(7);
+	bool result = true;
+	for (u32 t=0; t<EBT_COUNT; ++t)
+	{
+		result &= checkBlit(device->getVideoDriver(), (EBlitTest)t, core::dimension2du(203, 77));
+		result &= checkBlit(device->getVideoDriver(), (EBlitTest)t, core::dimension2du(601, 500));
+	}
+	blitSpeed(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= checkColorAlpha();
+
+	return result;
+}
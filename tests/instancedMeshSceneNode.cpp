@@ -0,0 +1,289 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+const u32 GRID = 10;
+
+video::IImage* renderScene(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+	return driver->createScreenShot();
+}
+
+//! Position, rotation and scale of instance i of the grid
+void gridInstance(u32 i, core::vector3df& position, core::vector3df& rotation, core::vector3df& scale)
+{
+	position.set((i % GRID) * 8.f - 36.f, 0.f, (i / GRID) * 8.f - 36.f);
+	rotation.set(0.f, i * 17.f, i * 5.f);
+	scale.set(1.f + (i % 3) * 0.25f, 1.f, 1.f + (i % 2) * 0.5f);
+}
+
+//! Transformation of instance i of the grid, like the relative transformation of a scene node
+core::matrix4 gridTransformation(u32 i)
+{
+	core::vector3df position, rotation, scale;
+	gridInstance(i, position, rotation, scale);
+	core::matrix4 m;
+	m.setRotationDegrees(rotation);
+	m.setTranslation(position);
+	core::matrix4 s;
+	s.setScale(scale);
+	return m * s;
+}
+
+void drawFrame(IrrlichtDevice* device)
+{
+	device->getVideoDriver()->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	device->getSceneManager()->drawAll();
+	device->getVideoDriver()->endScene();
+}
+
+//! Counts the pixels which differ noticeably
+u32 countDifferences(video::IImage* image, video::IImage* reference)
+{
+	u32 differences = 0;
+	const core::dimension2du size = image->getDimension();
+	for (u32 y=0; y<size.Height; ++y)
+	{
+		for (u32 x=0; x<size.Width; ++x)
+		{
+			const video::SColor a = image->getPixel(x, y);
+			const video::SColor b = reference->getPixel(x, y);
+			if (core::abs_((s32)a.getRed() - (s32)b.getRed()) > 8 ||
+				core::abs_((s32)a.getGreen() - (s32)b.getGreen()) > 8 ||
+				core::abs_((s32)a.getBlue() - (s32)b.getBlue()) > 8)
+				++differences;
+		}
+	}
+	return differences;
+}
+
+//! Draws the grid with one mesh scene node per instance, and with an instanced node
+bool compareWithMeshNodes(IrrlichtDevice* device, scene::IMesh* mesh)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode();
+	const core::vector3df positions[2] = { core::vector3df(0.f, 40.f, -60.f), core::vector3df(-40.f, 10.f, -40.f) };
+	const core::vector3df targets[2] = { core::vector3df(0.f, 0.f, 0.f), core::vector3df(-20.f, 0.f, 20.f) };
+
+	core::array<scene::ISceneNode*> nodes;
+	for (u32 i=0; i<GRID*GRID; ++i)
+	{
+		core::vector3df position, rotation, scale;
+		gridInstance(i, position, rotation, scale);
+		scene::ISceneNode* node = smgr->addMeshSceneNode(mesh, 0, -1, position, rotation, scale);
+		node->setAutomaticCulling(scene::EAC_FRUSTUM_BOX);
+		nodes.push_back(node);
+	}
+
+	video::IImage* references[2];
+	u32 expectedVisible[2];
+	for (u32 c=0; c<2; ++c)
+	{
+		camera->setPosition(positions[c]);
+		camera->setTarget(targets[c]);
+		references[c] = renderScene(device);
+
+		expectedVisible[c] = 0;
+		for (u32 i=0; i<nodes.size(); ++i)
+		{
+			if (!smgr->isCulled(nodes[i]))
+				++expectedVisible[c];
+		}
+	}
+	for (u32 i=0; i<nodes.size(); ++i)
+		nodes[i]->remove();
+
+	scene::IInstancedMeshSceneNode* instanced = smgr->addInstancedMeshSceneNode(mesh);
+	for (u32 i=0; i<GRID*GRID; ++i)
+		instanced->addInstance(gridTransformation(i));
+	instanced->setAutomaticCulling(scene::EAC_FRUSTUM_BOX);
+
+	bool result = instanced->getInstanceCount() == GRID*GRID;
+	for (u32 frame=0; frame<4; ++frame)
+	{
+		// the second frame with the same camera draws the copied vertices again
+		const u32 c = frame / 2;
+		camera->setPosition(positions[c]);
+		camera->setTarget(targets[c]);
+		video::IImage* image = renderScene(device);
+
+		if (instanced->getVisibleInstanceCount() != expectedVisible[c])
+		{
+			logTestString("Frame %d: %d visible instances, but %d mesh scene nodes\n", frame,
+				instanced->getVisibleInstanceCount(), expectedVisible[c]);
+			result = false;
+		}
+
+		// vertices transformed before and by the driver may hit slightly different pixels at the borders
+		if (image && references[c])
+		{
+			const u32 differences = countDifferences(image, references[c]);
+			if (differences > 40)
+			{
+				logTestString("Frame %d: instances differ from the mesh scene nodes in %d pixels\n", frame, differences);
+				result = false;
+			}
+		}
+		if (image)
+			image->drop();
+	}
+
+	for (u32 c=0; c<2; ++c)
+	{
+		if (references[c])
+			references[c]->drop();
+	}
+	instanced->remove();
+	camera->remove();
+	return result;
+}
+
+//! Instance colors, changed and removed instances
+bool checkInstances(IrrlichtDevice* device, scene::IMesh* mesh)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, -30.f), core::vector3df(0.f, 0.f, 0.f));
+	scene::IInstancedMeshSceneNode* instanced = smgr->addInstancedMeshSceneNode(mesh);
+
+	core::matrix4 left;
+	left.setTranslation(core::vector3df(-6.f, 0.f, 0.f));
+	core::matrix4 right;
+	right.setTranslation(core::vector3df(6.f, 0.f, 0.f));
+	instanced->addInstance(left, video::SColor(255, 255, 0, 0));
+	instanced->addInstance(right);
+
+	bool result = true;
+	video::IImage* image = renderScene(device);
+	if (image)
+	{
+		const video::SColor red = image->getPixel(80 - 16, 60);
+		const video::SColor white = image->getPixel(80 + 16, 60);
+		if (red.getRed() < 200 || red.getGreen() > 20 || white.getGreen() < 200)
+		{
+			logTestString("Instance colors are %08x and %08x\n", red.color, white.color);
+			result = false;
+		}
+		image->drop();
+	}
+
+	// changed color of a visible instance
+	instanced->setInstance(1, right, video::SColor(255, 0, 0, 255));
+	image = renderScene(device);
+	if (image)
+	{
+		const video::SColor blue = image->getPixel(80 + 16, 60);
+		if (blue.getBlue() < 200 || blue.getRed() > 20)
+		{
+			logTestString("Changed instance color is %08x\n", blue.color);
+			result = false;
+		}
+		image->drop();
+	}
+
+	// the last instance takes the index of the removed one
+	instanced->removeInstance(0);
+	result &= instanced->getInstanceCount() == 1 && instanced->getInstanceTransformation(0) == right &&
+		instanced->getInstanceColor(0) == video::SColor(255, 0, 0, 255);
+	image = renderScene(device);
+	result &= instanced->getVisibleInstanceCount() == 1;
+	if (image)
+	{
+		const video::SColor empty = image->getPixel(80 - 16, 60);
+		if (empty.getRed() > 20)
+		{
+			logTestString("Removed instance still drawn, %08x\n", empty.color);
+			result = false;
+		}
+		image->drop();
+	}
+	if (!instanced->getBoundingBox().isFullInside(core::aabbox3df(3.9f, -2.1f, -2.1f, 8.1f, 2.1f, 2.1f)))
+	{
+		logTestString("Bounding box not updated after removing an instance\n");
+		result = false;
+	}
+
+	instanced->clearInstances();
+	drawFrame(device);
+	result &= instanced->getInstanceCount() == 0 && instanced->getVisibleInstanceCount() == 0;
+
+	instanced->remove();
+	camera->remove();
+	return result;
+}
+
+//! Many small meshes drawn by mesh scene nodes and by an instanced node
+void compareSpeed(IrrlichtDevice* device, scene::IMesh* mesh)
+{
+	const u32 count = 100 * 100;
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(0.f, 150.f, -250.f), core::vector3df(0.f, 0.f, 0.f));
+	ITimer* timer = device->getTimer();
+
+	core::array<scene::ISceneNode*> nodes;
+	for (u32 i=0; i<count; ++i)
+		nodes.push_back(smgr->addMeshSceneNode(mesh, 0, -1, core::vector3df((i % 100) * 5.f - 250.f, 0.f, (i / 100) * 5.f - 250.f)));
+	u32 start = timer->getRealTime();
+	for (u32 frame=0; frame<10; ++frame)
+		drawFrame(device);
+	logTestString("Drawing %d mesh scene nodes 10 times took %d ms\n", count, timer->getRealTime() - start);
+	for (u32 i=0; i<nodes.size(); ++i)
+		nodes[i]->remove();
+
+	scene::IInstancedMeshSceneNode* instanced = smgr->addInstancedMeshSceneNode(mesh);
+	for (u32 i=0; i<count; ++i)
+	{
+		core::matrix4 m;
+		m.setTranslation(core::vector3df((i % 100) * 5.f - 250.f, 0.f, (i / 100) * 5.f - 250.f));
+		instanced->addInstance(m);
+	}
+	start = timer->getRealTime();
+	for (u32 frame=0; frame<10; ++frame)
+		drawFrame(device);
+	logTestString("Drawing %d instances (%d visible) 10 times took %d ms\n", count, instanced->getVisibleInstanceCount(), timer->getRealTime() - start);
+
+	// moving camera, so the visible instances are copied each frame
+	start = timer->getRealTime();
+	for (u32 frame=0; frame<10; ++frame)
+	{
+		camera->setPosition(core::vector3df(frame * 5.f, 150.f, -250.f));
+		drawFrame(device);
+	}
+	logTestString("Drawing %d instances with a moving camera 10 times took %d ms\n", count, timer->getRealTime() - start);
+
+	instanced->remove();
+	camera->remove();
+}
+}
+
+// instanced mesh scene nodes look like one mesh scene node per instance
+bool instancedMeshSceneNode()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	scene::IMesh* mesh = device->getSceneManager()->getGeometryCreator()->createCubeMesh(core::vector3df(4.f, 4.f, 4.f));
+	mesh->getMeshBuffer(0)->getMaterial().Lighting = false;
+
+	bool result = compareWithMeshNodes(device, mesh);
+	result &= checkInstances(device, mesh);
+	compareSpeed(device, mesh);
+
+	mesh->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -124,9 +124,109 @@ static bool loadScene(void)
 	return result;
 }
 
+namespace
+{
+	// Writes the node id as user data and checks it when reading
+	class CUserDataCheck : public ISceneUserDataSerializer
+	{
+	public:
+		CUserDataCheck(IFileSystem* fs) : FileSystem(fs), Read(0), Wrong(0) {}
+
+		virtual void OnCreateNode(ISceneNode* node) {}
+
+		virtual void OnReadUserData(ISceneNode* node, IAttributes* userData)
+		{
+			++Read;
+			if (userData->getAttributeAsInt("NodeId") != node->getID() ||
+				userData->getAttributeAsStringW("Text") != stringw(L"\x00e4user data"))
+				++Wrong;
+		}
+
+		virtual IAttributes* createUserData(ISceneNode* node)
+		{
+			IAttributes* attr = FileSystem->createEmptyAttributes();
+			attr->addInt("NodeId", node->getID());
+			attr->addString("Text", L"\x00e4user data");
+			return attr;
+		}
+
+		IFileSystem* FileSystem;
+		u32 Read;
+		u32 Wrong;
+	};
+}
+
+// Saves a scene as .irrb, loads it again and compares it as .irr with the original scene
+static bool binaryScene(void)
+{
+	IrrlichtDevice *device = createDevice( EDT_NULL, dimension2d<u32>(160, 120), 32);
+	assert_log(device);
+	if (!device)
+		return false;
+
+	ISceneManager* smgr = device->getSceneManager();
+	IFileSystem* fs = device->getFileSystem();
+	CUserDataCheck userData(fs);
+
+	// load scene from example, with correct relative path
+	fs->changeWorkingDirectoryTo("results");
+	bool result = smgr->loadScene("../../media/example.irr");
+	result &= smgr->saveScene("binaryScene.irr", &userData);
+	result &= smgr->saveScene("binaryScene.irrb", &userData);
+
+	ISceneManager* loaded = smgr->createNewSceneManager();
+	result &= loaded->loadScene("binaryScene.irrb", &userData);
+	result &= loaded->saveScene("binaryScene2.irr", &userData);
+	const u32 nodes = loaded->getRootSceneNode()->getChildren().size();
+	loaded->drop();
+	fs->changeWorkingDirectoryTo("..");
+
+	if (!result || nodes == 0)
+	{
+		logTestString("Saving or loading binary scene failed.\n");
+		result = false;
+	}
+	if (userData.Read == 0 || userData.Wrong != 0)
+	{
+		logTestString("User data of binary scene is wrong.\n");
+		result = false;
+	}
+
+	result &= xmlCompareFiles(fs, "results/binaryScene.irr", "results/binaryScene2.irr");
+
+	// a truncated file is not loaded as a good scene
+	IReadFile* file = fs->createAndOpenFile("results/binaryScene.irrb");
+	IWriteFile* truncated = fs->createAndWriteFile("results/binaryScene3.irrb");
+	if (file && truncated)
+	{
+		core::array<u8> data;
+		data.set_used((u32)file->getSize());
+		file->read(data.pointer(), data.size());
+		truncated->write(data.const_pointer(), data.size() * 2 / 3);
+	}
+	if (file)
+		file->drop();
+	if (truncated)
+		truncated->drop();
+	loaded = smgr->createNewSceneManager();
+	if (loaded->loadScene("results/binaryScene3.irrb"))
+	{
+		logTestString("Truncated binary scene was loaded.\n");
+		result = false;
+	}
+	loaded->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
 bool ioScene(void)
 {
 	bool result = saveScene();
+	result &= binaryScene();
 	result &= loadScene();
 	return result;
 }
@@ -0,0 +1,381 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+
+//! Copies the vertices of the first mesh buffer, they change with the next frame
+void copyVertices(scene::IMesh* mesh, core::array<video::S3DVertex>& vertices)
+{
+	const scene::IMeshBuffer* mb = mesh->getMeshBuffer(0);
+	vertices.set_used(mb->getVertexCount());
+	for (u32 i=0; i<mb->getVertexCount(); ++i)
+	{
+		vertices[i].Pos = mb->getPosition(i);
+		vertices[i].Normal = mb->getNormal(i);
+	}
+}
+
+bool equals(const core::vector3df& a, const core::vector3df& b, f32 tolerance)
+{
+	return core::equals(a.X, b.X, tolerance) && core::equals(a.Y, b.Y, tolerance) && core::equals(a.Z, b.Z, tolerance);
+}
+
+//! Compares an interpolated mesh with the key frames it is interpolated from
+bool compareFrames(scene::IMesh* mesh, const core::array<video::S3DVertex>& a,
+		const core::array<video::S3DVertex>& b, f32 div, const c8* name, s32 frame)
+{
+	const scene::IMeshBuffer* mb = mesh->getMeshBuffer(0);
+	if (mb->getVertexCount() != a.size())
+	{
+		logTestString("%s frame %d has %d vertices instead of %d\n", name, frame, mb->getVertexCount(), a.size());
+		return false;
+	}
+	for (u32 i=0; i<a.size(); ++i)
+	{
+		const core::vector3df pos(a[i].Pos + (b[i].Pos - a[i].Pos) * div);
+		const core::vector3df normal(a[i].Normal + (b[i].Normal - a[i].Normal) * div);
+		if (!equals(mb->getPosition(i), pos, 0.001f) || !equals(mb->getNormal(i), normal, 0.0001f))
+		{
+			logTestString("%s frame %d vertex %d is (%f %f %f) (%f %f %f) instead of (%f %f %f) (%f %f %f)\n",
+				name, frame, i, mb->getPosition(i).X, mb->getPosition(i).Y, mb->getPosition(i).Z,
+				mb->getNormal(i).X, mb->getNormal(i).Y, mb->getNormal(i).Z,
+				pos.X, pos.Y, pos.Z, normal.X, normal.Y, normal.Z);
+			return false;
+		}
+	}
+	return true;
+}
+
+//! Frames which were interpolated before are returned again without interpolating them
+bool checkCache(scene::IAnimatedMesh* mesh, u32 frameA, u32 frameB,
+		scene::IMeshManipulator* manipulator, const c8* name)
+{
+	bool result = true;
+
+	scene::IMeshBuffer* a = mesh->getMesh(frameA)->getMeshBuffer(0);
+	const u32 changedA = a->getChangedID_Vertex();
+	scene::IMeshBuffer* b = mesh->getMesh(frameB)->getMeshBuffer(0);
+	if (a == b)
+	{
+		logTestString("%s frames %d and %d share a mesh buffer\n", name, frameA, frameB);
+		result = false;
+	}
+
+	// the material of the returned mesh buffer is kept
+	b->getMaterial().Wireframe = true;
+	scene::IMeshBuffer* again = mesh->getMesh(frameA)->getMeshBuffer(0);
+	if (again != a || again->getChangedID_Vertex() != changedA)
+	{
+		logTestString("%s frame %d was interpolated again\n", name, frameA);
+		result = false;
+	}
+	if (!again->getMaterial().Wireframe)
+	{
+		logTestString("%s material was not taken over\n", name);
+		result = false;
+	}
+	again->getMaterial().Wireframe = false;
+
+	// so are its vertex colors once it is set dirty, the other buffer is updated
+	const video::SColor color(255, 10, 20, 30);
+	const u32 changedB = b->getChangedID_Vertex();
+	manipulator->setVertexColors(again, color);
+	again->setDirty(scene::EBT_VERTEX);
+	if (mesh->getMesh(frameB)->getMeshBuffer(0) != b || b->getChangedID_Vertex() == changedB)
+	{
+		logTestString("%s buffer of frame %d was not updated\n", name, frameB);
+		result = false;
+	}
+	for (u32 i=0; i<b->getVertexCount(); ++i)
+	{
+		const u8* vertex = (const u8*)b->getVertices() + i * video::getVertexPitchFromType(b->getVertexType());
+		if (((const video::S3DVertex*)vertex)->Color != color)
+		{
+			logTestString("%s vertex colors were not taken over\n", name);
+			result = false;
+			break;
+		}
+	}
+	manipulator->setVertexColors(b, video::SColor(255, 255, 255, 255));
+	b->setDirty(scene::EBT_VERTEX);
+	return result;
+}
+
+bool md2Interpolation(scene::ISceneManager* smgr)
+{
+	scene::IAnimatedMesh* mesh = smgr->getMesh("./media/sydney.md2");
+	if (!mesh || mesh->getMeshType() != scene::EAMT_MD2)
+	{
+		logTestString("Could not load sydney.md2\n");
+		return false;
+	}
+	scene::IAnimatedMeshMD2* md2 = (scene::IAnimatedMeshMD2*)mesh;
+
+	bool result = true;
+	const u32 keyFrames = mesh->getFrameCount() / 4;
+	const u32 tests[] = { 0, 1, 7, 40, keyFrames - 2 };
+	core::array<video::S3DVertex> a;
+	core::array<video::S3DVertex> b;
+	for (u32 t=0; t<sizeof(tests)/sizeof(tests[0]); ++t)
+	{
+		copyVertices(mesh->getMesh(tests[t] * 4), a);
+		copyVertices(mesh->getMesh(tests[t] * 4 + 4), b);
+		for (u32 s=0; s<4; ++s)
+			result &= compareFrames(mesh->getMesh(tests[t] * 4 + s), a, b, s * 0.25f, "MD2", tests[t] * 4 + s);
+	}
+
+	result &= checkCache(mesh, 8, 13, smgr->getMeshManipulator(), "MD2");
+
+	// with one kept frame all frames share the mesh buffer
+	md2->setInterpolationCacheSize(1);
+	if (md2->getInterpolationCacheSize() != 1 ||
+		mesh->getMesh(8)->getMeshBuffer(0) != mesh->getMesh(13)->getMeshBuffer(0))
+	{
+		logTestString("MD2 keeps more than one frame\n");
+		result = false;
+	}
+	copyVertices(mesh->getMesh(20), a);
+	copyVertices(mesh->getMesh(24), b);
+	result &= compareFrames(mesh->getMesh(22), a, b, 0.5f, "MD2 without cache", 22);
+
+	md2->setInterpolationCacheSize(16);
+	smgr->getMeshCache()->removeMesh(mesh);
+	return result;
+}
+
+void write(core::array<u8>& data, const void* p, u32 size)
+{
+	for (u32 i=0; i<size; ++i)
+		data.push_back(((const u8*)p)[i]);
+}
+
+void write(core::array<u8>& data, s32 value)
+{
+	write(data, &value, 4);
+}
+
+void write(core::array<u8>& data, f32 value)
+{
+	write(data, &value, 4);
+}
+
+void writeName(core::array<u8>& data, const c8* name, u32 size)
+{
+	c8 buffer[68];
+	memset(buffer, 0, sizeof(buffer));
+	strcpy(buffer, name);
+	write(data, buffer, size);
+}
+
+//! A MD3 model with one mesh of 7 vertices in 3 frames and one tag
+const s32 MD3_FRAMES = 3;
+const s32 MD3_VERTICES = 7;
+const s32 MD3_TRIANGLES = 5;
+
+s16 getMD3Position(s32 frame, s32 vertex, s32 axis)
+{
+	return (s16)((vertex * 37 + axis * 101) % 256 - 128 + frame * (axis + 1) * 40);
+}
+
+u8 getMD3Normal(s32 frame, s32 vertex, s32 axis)
+{
+	return (u8)(vertex * 31 + axis * 60 + frame * 20);
+}
+
+scene::IAnimatedMesh* createMD3(IrrlichtDevice* device)
+{
+	core::array<u8> data;
+
+	// header
+	const s32 tagStart = 108;
+	const s32 tagEnd = tagStart + MD3_FRAMES * 112;
+	const s32 meshSize = 108 + 68 + MD3_TRIANGLES * 12 + MD3_VERTICES * 8 + MD3_FRAMES * MD3_VERTICES * 8;
+	write(data, "IDP3", 4);
+	write(data, 15);
+	writeName(data, "", 68);
+	write(data, MD3_FRAMES);
+	write(data, 1);
+	write(data, 1);
+	write(data, 1);
+	write(data, 108);
+	write(data, tagStart);
+	write(data, tagEnd);
+	write(data, tagEnd + meshSize);
+
+	// one tag in each frame, turned around the y axis
+	for (s32 f=0; f<MD3_FRAMES; ++f)
+	{
+		writeName(data, "tag_weapon", 64);
+		write(data, 10.f * f);
+		write(data, 2.f);
+		write(data, -5.f * f);
+		const f32 c = cosf(f * 0.5f);
+		const f32 s = sinf(f * 0.5f);
+		const f32 m[9] = { c, s, 0.f, -s, c, 0.f, 0.f, 0.f, 1.f };
+		write(data, m, sizeof(m));
+	}
+
+	// mesh
+	write(data, "IDP3", 4);
+	writeName(data, "mesh", 68);
+	write(data, MD3_FRAMES);
+	write(data, 1);
+	write(data, MD3_VERTICES);
+	write(data, MD3_TRIANGLES);
+	write(data, 108 + 68);
+	write(data, 108);
+	write(data, 108 + 68 + MD3_TRIANGLES * 12);
+	write(data, 108 + 68 + MD3_TRIANGLES * 12 + MD3_VERTICES * 8);
+	write(data, meshSize);
+
+	writeName(data, "$whiteimage", 64);
+	write(data, 0);
+	for (s32 t=0; t<MD3_TRIANGLES; ++t)
+	{
+		write(data, t);
+		write(data, t + 1);
+		write(data, t + 2);
+	}
+	for (s32 v=0; v<MD3_VERTICES; ++v)
+	{
+		write(data, v / 7.f);
+		write(data, 1.f - v / 7.f);
+	}
+	for (s32 f=0; f<MD3_FRAMES; ++f)
+	{
+		for (s32 v=0; v<MD3_VERTICES; ++v)
+		{
+			for (s32 axis=0; axis<3; ++axis)
+			{
+				const s16 p = getMD3Position(f, v, axis);
+				write(data, &p, 2);
+			}
+			const u8 n[2] = { getMD3Normal(f, v, 0), getMD3Normal(f, v, 1) };
+			write(data, n, 2);
+		}
+	}
+
+	io::IReadFile* file = device->getFileSystem()->createMemoryReadFile(data.pointer(), data.size(), "interpolation.md3", false);
+	scene::IAnimatedMesh* mesh = device->getSceneManager()->getMesh(file);
+	file->drop();
+	return mesh;
+}
+
+bool md3Interpolation(IrrlichtDevice* device)
+{
+	scene::IAnimatedMesh* mesh = createMD3(device);
+	if (!mesh || mesh->getMeshType() != scene::EAMT_MD3)
+	{
+		logTestString("Could not load the MD3 model\n");
+		return false;
+	}
+	scene::IAnimatedMeshMD3* md3 = (scene::IAnimatedMeshMD3*)mesh;
+
+	// four frames between the key frames, without looping
+	md3->setInterpolationShift(2, 0);
+
+	bool result = true;
+	core::array<video::S3DVertex> a;
+	core::array<video::S3DVertex> b;
+	for (s32 f=0; f<MD3_FRAMES; ++f)
+	{
+		// key frames of the file, with y and z swapped
+		const s32 g = core::min_(f + 1, MD3_FRAMES - 1);
+		a.set_used(MD3_VERTICES);
+		b.set_used(MD3_VERTICES);
+		for (s32 v=0; v<MD3_VERTICES; ++v)
+		{
+			a[v].Pos.set(getMD3Position(f, v, 0) / 64.f, getMD3Position(f, v, 2) / 64.f, getMD3Position(f, v, 1) / 64.f);
+			b[v].Pos.set(getMD3Position(g, v, 0) / 64.f, getMD3Position(g, v, 2) / 64.f, getMD3Position(g, v, 1) / 64.f);
+			const core::vector3df na(scene::quake3::getMD3Normal(getMD3Normal(f, v, 0), getMD3Normal(f, v, 1)));
+			const core::vector3df nb(scene::quake3::getMD3Normal(getMD3Normal(g, v, 0), getMD3Normal(g, v, 1)));
+			a[v].Normal.set(na.X, na.Z, na.Y);
+			b[v].Normal.set(nb.X, nb.Z, nb.Y);
+		}
+
+		for (s32 s=0; s<4; ++s)
+		{
+			const s32 frame = f * 4 + 2 + s;
+			result &= compareFrames(mesh->getMesh(frame, 255, 0, -1), a, b, s * 0.25f, "MD3", frame);
+
+			scene::SMD3QuaternionTagList* tags = md3->getTagList(frame, 255, 0, -1);
+			const core::vector3df position(core::vector3df(10.f * f, -5.f * f, 2.f).getInterpolated(
+				core::vector3df(10.f * g, -5.f * g, 2.f), 1.f - s * 0.25f));
+			if (!tags || tags->size() != 1 || !equals((*tags)[0].position, position, 0.0001f))
+			{
+				logTestString("MD3 tag of frame %d is wrong\n", frame);
+				result = false;
+			}
+		}
+	}
+
+	result &= checkCache(mesh, 3, 8, device->getSceneManager()->getMeshManipulator(), "MD3");
+
+	md3->setInterpolationCacheSize(1);
+	if (md3->getInterpolationCacheSize() != 1 ||
+		mesh->getMesh(3)->getMeshBuffer(0) != mesh->getMesh(8)->getMeshBuffer(0))
+	{
+		logTestString("MD3 keeps more than one frame\n");
+		result = false;
+	}
+
+	device->getSceneManager()->getMeshCache()->removeMesh(mesh);
+	return result;
+}
+
+//! Many nodes playing the same animation in a few groups
+void interpolationSpeed(IrrlichtDevice* device)
+{
+	scene::IAnimatedMesh* mesh = device->getSceneManager()->getMesh("./media/sydney.md2");
+	if (!mesh)
+		return;
+	scene::IAnimatedMeshMD2* md2 = (scene::IAnimatedMeshMD2*)mesh;
+	ITimer* timer = device->getTimer();
+
+	s32 begin, end, fps;
+	md2->getFrameLoop(scene::EMAT_RUN, begin, end, fps);
+	const u32 nodes = 256;
+	const u32 groups = 8;
+
+	const u32 sizes[] = { 1, 16 };
+	for (u32 c=0; c<2; ++c)
+	{
+		md2->setInterpolationCacheSize(sizes[c]);
+		const u32 start = timer->getRealTime();
+		for (u32 step=0; step<100; ++step)
+		{
+			for (u32 n=0; n<nodes; ++n)
+			{
+				const s32 frame = begin + (s32)((step + (n % groups) * 5) % (end - begin));
+				mesh->getMesh(frame, 255, begin, end);
+			}
+		}
+		logTestString("Interpolating %d MD2 nodes 100 times keeping %d frames took %d ms\n",
+			nodes, sizes[c], timer->getRealTime() - start);
+	}
+
+	md2->setInterpolationCacheSize(16);
+	device->getSceneManager()->getMeshCache()->removeMesh(mesh);
+}
+
+}
+
+// MD2 and MD3 meshes interpolate their key frames and keep them for other nodes
+bool keyFrameInterpolation()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return false;
+
+	bool result = md2Interpolation(device->getSceneManager());
+	result &= md3Interpolation(device);
+	interpolationSpeed(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,419 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+
+u32 countTriangles(scene::IMesh* mesh)
+{
+	u32 count = 0;
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+		count += mesh->getMeshBuffer(b)->getIndexCount() / 3;
+	return count;
+}
+
+u32 getIndex(const scene::IMeshBuffer* mb, u32 i)
+{
+	if (mb->getIndexType() == video::EIT_32BIT)
+		return ((const u32*)mb->getIndices())[i];
+	return mb->getIndices()[i];
+}
+
+//! Counts the edges between different positions which are not used by exactly two triangles
+u32 countOpenEdges(scene::IMesh* mesh)
+{
+	core::array<core::vector3df> positions;
+	core::array<u32> edges;
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const scene::IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		for (u32 i=0; i<mb->getIndexCount(); ++i)
+		{
+			// vertices at the same position are one corner
+			const core::vector3df& p = mb->getPosition(getIndex(mb, i));
+			u32 id = 0;
+			while (id<positions.size() && !positions[id].equals(p))
+				++id;
+			if (id == positions.size())
+				positions.push_back(p);
+			edges.push_back(id);
+		}
+	}
+
+	u32 open = 0;
+	for (u32 i=0; i<edges.size(); ++i)
+	{
+		const u32 t = i - i%3;
+		const u32 a = edges[i];
+		const u32 b = edges[t + (i+1)%3];
+		u32 used = 0;
+		for (u32 j=0; j<edges.size(); ++j)
+		{
+			const u32 s = j - j%3;
+			const u32 c = edges[j];
+			const u32 d = edges[s + (j+1)%3];
+			if ((a == c && b == d) || (a == d && b == c))
+				++used;
+		}
+		if (used != 2)
+			++open;
+	}
+	return open;
+}
+
+//! A closed sphere keeps its shape and stays closed
+bool simplifySphere(scene::ISceneManager* smgr)
+{
+	scene::IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(10.f, 32, 32);
+	const u32 triangles = countTriangles(sphere);
+
+	f32 error = -1.f;
+	scene::IMesh* simple = smgr->getMeshManipulator()->createSimplifiedMesh(sphere, 0.25f, &error);
+
+	bool result = true;
+	const u32 simpleTriangles = countTriangles(simple);
+	if (simpleTriangles > triangles * 3 / 10 || simpleTriangles < triangles / 8)
+	{
+		logTestString("Sphere with %d triangles simplified to %d\n", triangles, simpleTriangles);
+		result = false;
+	}
+	if (error <= 0.f || error > 0.5f)
+	{
+		logTestString("Simplified sphere has error %f\n", error);
+		result = false;
+	}
+	if (!simple->getBoundingBox().MinEdge.equals(sphere->getBoundingBox().MinEdge, 0.5f) ||
+		!simple->getBoundingBox().MaxEdge.equals(sphere->getBoundingBox().MaxEdge, 0.5f))
+	{
+		logTestString("Simplified sphere changed its bounding box\n");
+		result = false;
+	}
+
+	// the seam of the sphere is a border, which must not open wider
+	const u32 open = countOpenEdges(simple);
+	if (open > countOpenEdges(sphere))
+	{
+		logTestString("Simplified sphere has %d open edges\n", open);
+		result = false;
+	}
+
+	simple->drop();
+	sphere->drop();
+	return result;
+}
+
+//! A flat grid collapses to a few triangles without moving its border
+bool simplifyPlane(scene::ISceneManager* smgr)
+{
+	scene::IMesh* plane = smgr->getGeometryCreator()->createPlaneMesh(core::dimension2df(1.f, 1.f), core::dimension2du(20, 20));
+
+	f32 error = -1.f;
+	scene::IMesh* simple = smgr->getMeshManipulator()->createSimplifiedMesh(plane, 0.01f, &error);
+
+	bool result = true;
+	const u32 simpleTriangles = countTriangles(simple);
+	if (simpleTriangles > 8 || error > 0.001f)
+	{
+		logTestString("Plane simplified to %d triangles with error %f\n", simpleTriangles, error);
+		result = false;
+	}
+	if (!simple->getBoundingBox().MinEdge.equals(plane->getBoundingBox().MinEdge) ||
+		!simple->getBoundingBox().MaxEdge.equals(plane->getBoundingBox().MaxEdge))
+	{
+		logTestString("Simplified plane changed its border\n");
+		result = false;
+	}
+
+	// the area is still covered, each triangle keeps facing the same side
+	const scene::IMeshBuffer* original = plane->getMeshBuffer(0);
+	const f32 up = core::triangle3df(original->getPosition(getIndex(original, 0)),
+		original->getPosition(getIndex(original, 1)), original->getPosition(getIndex(original, 2))).getNormal().Y;
+	f32 area = 0.f;
+	for (u32 b=0; b<simple->getMeshBufferCount(); ++b)
+	{
+		const scene::IMeshBuffer* mb = simple->getMeshBuffer(b);
+		for (u32 i=0; i<mb->getIndexCount(); i+=3)
+		{
+			const core::triangle3df triangle(mb->getPosition(getIndex(mb, i)),
+				mb->getPosition(getIndex(mb, i+1)), mb->getPosition(getIndex(mb, i+2)));
+			const core::vector3df normal = triangle.getNormal();
+			if (normal.Y * up <= 0.f)
+			{
+				logTestString("Simplified plane has a flipped triangle\n");
+				result = false;
+			}
+			area += normal.getLength() * 0.5f;
+		}
+	}
+	if (!core::equals(area, 400.f, 0.01f))
+	{
+		logTestString("Simplified plane has an area of %f\n", area);
+		result = false;
+	}
+
+	simple->drop();
+	plane->drop();
+	return result;
+}
+
+video::IImage* renderScene(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+	return driver->createScreenShot();
+}
+
+//! Counts the pixels which differ noticeably
+u32 countDifferences(video::IImage* image, video::IImage* reference)
+{
+	u32 differences = 0;
+	const core::dimension2du size = image->getDimension();
+	for (u32 y=0; y<size.Height; ++y)
+	{
+		for (u32 x=0; x<size.Width; ++x)
+		{
+			const video::SColor a = image->getPixel(x, y);
+			const video::SColor b = reference->getPixel(x, y);
+			if (core::abs_((s32)a.getRed() - (s32)b.getRed()) > 24 ||
+				core::abs_((s32)a.getGreen() - (s32)b.getGreen()) > 24 ||
+				core::abs_((s32)a.getBlue() - (s32)b.getBlue()) > 24)
+				++differences;
+		}
+	}
+	return differences;
+}
+
+//! Simpler levels are chosen farther away, and look like the full mesh
+bool switchLevels(IrrlichtDevice* device, scene::IMesh* sphere)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, -30.f), core::vector3df(0.f, 0.f, 0.f));
+	scene::ILODMeshSceneNode* node = smgr->addLODMeshSceneNode(sphere);
+
+	bool result = true;
+	if (node->generateLODs(4) != 5)
+	{
+		logTestString("Generated %d levels instead of 5\n", node->getLODCount());
+		result = false;
+	}
+	for (u32 i=1; i<node->getLODCount(); ++i)
+	{
+		if (node->getLODError(i) <= node->getLODError(i-1) ||
+			countTriangles(node->getLODMesh(i)) >= countTriangles(node->getLODMesh(i-1)))
+		{
+			logTestString("Level %d is not simpler than the one before\n", i);
+			result = false;
+		}
+	}
+
+	u32 level = 0;
+	u32 nearLevel = 0;
+	for (u32 i=0; i<8; ++i)
+	{
+		camera->setPosition(core::vector3df(0.f, 0.f, -30.f * (1 << i)));
+		camera->updateAbsolutePosition();
+		video::IImage* image = renderScene(device);
+
+		if (node->getCurrentLOD() < level)
+		{
+			logTestString("Level %d chosen farther away than level %d\n", node->getCurrentLOD(), level);
+			result = false;
+		}
+		level = node->getCurrentLOD();
+		if (i == 0)
+			nearLevel = level;
+
+		// the same view with the full mesh
+		node->setMaxScreenError(0.f);
+		video::IImage* reference = renderScene(device);
+		node->setMaxScreenError(1.f);
+
+		if (image && reference)
+		{
+			const u32 differences = countDifferences(image, reference);
+			if (differences > 20)
+			{
+				logTestString("Level %d differs in %d pixels from the full mesh\n", level, differences);
+				result = false;
+			}
+		}
+		if (image)
+			image->drop();
+		if (reference)
+			reference->drop();
+	}
+	if (level != node->getLODCount()-1)
+	{
+		logTestString("Simplest level not chosen far away, but %d\n", level);
+		result = false;
+	}
+
+	// fading out the previous level draws it in the transparent pass
+	node->setFadeTime(100000);
+	camera->setPosition(core::vector3df(0.f, 0.f, -30.f));
+	camera->updateAbsolutePosition();
+	video::IImage* image = renderScene(device);
+	if (node->getCurrentLOD() != nearLevel)
+	{
+		logTestString("Level %d chosen close to the camera instead of %d\n", node->getCurrentLOD(), nearLevel);
+		result = false;
+	}
+	node->setFadeTime(0);
+	video::IImage* reference = renderScene(device);
+	if (image && reference)
+	{
+		const u32 differences = countDifferences(image, reference);
+		if (differences > 20)
+		{
+			logTestString("Fading level differs in %d pixels\n", differences);
+			result = false;
+		}
+	}
+	if (image)
+		image->drop();
+	if (reference)
+		reference->drop();
+
+	node->remove();
+	camera->remove();
+	return result;
+}
+
+//! Levels written to a file are loaded for the same mesh only
+bool cacheLevels(IrrlichtDevice* device, scene::IMesh* sphere)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::ILODMeshSceneNode* node = smgr->addLODMeshSceneNode(sphere);
+	const u32 count = node->generateLODs(3);
+	bool result = count == 4 && node->writeLODs("results/lodCache.xml");
+	result &= device->getFileSystem()->existFile("results/lodCache_lod3.irrmesh");
+
+	scene::ILODMeshSceneNode* loaded = smgr->addLODMeshSceneNode(sphere);
+	result &= loaded->loadLODs("results/lodCache.xml");
+	result &= loaded->getLODCount() == count;
+	for (u32 i=1; i<loaded->getLODCount() && result; ++i)
+	{
+		if (!core::equals(loaded->getLODError(i), node->getLODError(i)) ||
+			countTriangles(loaded->getLODMesh(i)) != countTriangles(node->getLODMesh(i)))
+		{
+			logTestString("Level %d changed when loaded\n", i);
+			result = false;
+		}
+	}
+
+	// generating with the same cache file loads the levels
+	result &= loaded->generateLODs(1, 0.5f, "results/lodCache.xml") == count;
+
+	// not for another mesh
+	scene::IMesh* other = smgr->getGeometryCreator()->createSphereMesh(10.f, 16, 16);
+	scene::ILODMeshSceneNode* otherNode = smgr->addLODMeshSceneNode(other);
+	if (otherNode->loadLODs("results/lodCache.xml") || otherNode->getLODCount() != 1)
+	{
+		logTestString("Levels of another mesh were loaded\n");
+		result = false;
+	}
+	other->drop();
+
+	// nor for a mesh with the same number of triangles
+	scene::IMesh* same = smgr->getGeometryCreator()->createSphereMesh(12.f, 32, 32);
+	scene::ILODMeshSceneNode* sameNode = smgr->addLODMeshSceneNode(same);
+	if (sameNode->loadLODs("results/lodCache.xml") || sameNode->getLODCount() != 1)
+	{
+		logTestString("Levels of another mesh with as many triangles were loaded\n");
+		result = false;
+	}
+	same->drop();
+
+	if (!result)
+		logTestString("Writing and loading levels of detail failed\n");
+
+	sameNode->remove();
+	otherNode->remove();
+	loaded->remove();
+	node->remove();
+	return result;
+}
+
+//! Many detailed meshes far away
+void compareSpeed(IrrlichtDevice* device)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	ITimer* timer = device->getTimer();
+	scene::IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(5.f, 64, 64);
+	sphere->getMeshBuffer(0)->getMaterial().Lighting = false;
+
+	u32 start = timer->getRealTime();
+	scene::IMesh* simple = smgr->getMeshManipulator()->createSimplifiedMesh(sphere, 0.01f);
+	logTestString("Simplifying %d to %d triangles took %d ms\n", countTriangles(sphere), countTriangles(simple), timer->getRealTime() - start);
+	simple->drop();
+
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(0.f, 100.f, -400.f), core::vector3df(0.f, 0.f, 0.f));
+	core::array<scene::ILODMeshSceneNode*> nodes;
+	for (u32 i=0; i<100; ++i)
+		nodes.push_back(smgr->addLODMeshSceneNode(sphere, 0, -1, core::vector3df((i % 10) * 20.f - 100.f, 0.f, (i / 10) * 20.f - 100.f)));
+
+	start = timer->getRealTime();
+	for (u32 frame=0; frame<10; ++frame)
+	{
+		video::IImage* image = renderScene(device);
+		image->drop();
+	}
+	logTestString("Drawing 100 full meshes 10 times took %d ms\n", timer->getRealTime() - start);
+
+	start = timer->getRealTime();
+	nodes[0]->generateLODs(5);
+	for (u32 i=1; i<nodes.size(); ++i)
+	{
+		for (u32 l=1; l<nodes[0]->getLODCount(); ++l)
+			nodes[i]->addLOD(nodes[0]->getLODMesh(l), nodes[0]->getLODError(l));
+	}
+	logTestString("Generating %d levels took %d ms\n", nodes[0]->getLODCount()-1, timer->getRealTime() - start);
+
+	start = timer->getRealTime();
+	for (u32 frame=0; frame<10; ++frame)
+	{
+		video::IImage* image = renderScene(device);
+		image->drop();
+	}
+	logTestString("Drawing 100 meshes with levels of detail 10 times took %d ms, level %d\n", timer->getRealTime() - start, nodes[0]->getCurrentLOD());
+
+	for (u32 i=0; i<nodes.size(); ++i)
+		nodes[i]->remove();
+	camera->remove();
+	sphere->drop();
+}
+
+}
+
+// quadric simplification and level of detail mesh scene nodes
+bool lodMeshSceneNode()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	bool result = simplifySphere(smgr);
+	result &= simplifyPlane(smgr);
+
+	scene::IMesh* sphere = smgr->getGeometryCreator()->createSphereMesh(10.f, 32, 32);
+	sphere->getMeshBuffer(0)->getMaterial().Lighting = false;
+	result &= switchLevels(device, sphere);
+	result &= cacheLevels(device, sphere);
+	sphere->drop();
+
+	compareSpeed(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
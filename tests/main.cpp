@@ -81,10 +81,28 @@ int main(int argumentCount, char * arguments[])
 	TEST(enumerateImageManipulators);
 	TEST(removeCustomAnimator);
 	TEST(sceneCollisionManager);
+	TEST(frustumCulling);
+	TEST(softwareOcclusionCulling);
 	TEST(sceneNodeAnimator);
 	TEST(meshLoaders);
 	TEST(testTimer);
 	TEST(testCoreutil);
+	TEST(offscreenDevice);
+	TEST(gridLightManager);
+	TEST(occlusionQueries);
+	TEST(imageBlit);
+	TEST(colorConverter);
+	TEST(guiRetainedMode);
+	TEST(octreeSceneNode);
+	TEST(skinnedMeshBaking);
+	TEST(skinnedMeshBlending);
+	TEST(waterSurface);
+	TEST(quake3ShaderDeform);
+	TEST(instancedMeshSceneNode);
+	TEST(lodMeshSceneNode);
+	TEST(clusteredMeshSceneNode);
+	TEST(keyFrameInterpolation);
+	TEST(meshManipulatorParallel);
 	// software drivers only
 	TEST(softwareDevice);
 	TEST(b3dAnimation);
@@ -2,9 +2,134 @@
 // No rights reserved: this software is in the public domain.
 
 #include "testUtils.h"
+#include <stdio.h>
 
 using namespace irr;
 
+namespace
+{
+
+void appendLine(core::array<c8>& obj, const c8* line)
+{
+	for (const c8* c=line; *c; ++c)
+		obj.push_back(*c);
+}
+
+// Creates an obj file in memory with several groups, materials and relative indices
+io::IReadFile* createObjFile(io::IFileSystem* fs, const io::path& name, u32 gridSize)
+{
+	core::array<c8> obj;
+	c8 line[256];
+	for (u32 z=0; z<gridSize; ++z)
+	{
+		for (u32 x=0; x<gridSize; ++x)
+		{
+			sprintf(line, "v %g %g %g\nvt %g %g\n", x*0.5f, ((x*z)%7)*0.25f, z*0.5f, (f32)x/gridSize, (f32)z/gridSize);
+			appendLine(obj, line);
+		}
+		appendLine(obj, "vn 0 1 0\r\n");
+	}
+	for (u32 z=0; z<gridSize-1; ++z)
+	{
+		if (z % 16 == 0)
+		{
+			sprintf(line, "g part%u\nusemtl mat%u\n", z/32, z%3);
+			appendLine(obj, line);
+		}
+		for (u32 x=0; x<gridSize-1; ++x)
+		{
+			const u32 i = z*gridSize+x+1;
+			sprintf(line, "f %u/%u/%u %u/%u/%u %u/%u %u//%u\n", i, i, z+1, i+1, i+1, z+1,
+				i+gridSize+1, i+gridSize+1, i+gridSize, z+1);
+			appendLine(obj, line);
+		}
+	}
+	// a vertex after all faces which is only referenced relative
+	appendLine(obj, "v 1 2 3\nf -1 1 2\n");
+
+	c8* data = new c8[obj.size()];
+	memcpy(data, obj.const_pointer(), obj.size());
+	return fs->createMemoryReadFile(data, obj.size(), name, true);
+}
+
+// Loading with OBJ_LOADER_PARALLEL_PARSING must give exactly the same mesh
+bool objParallelParsing(IrrlichtDevice* device)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	io::IFileSystem* fs = device->getFileSystem();
+
+	io::IReadFile* file = createObjFile(fs, "serial.obj", 250);
+	if (file->getSize() < 1024*1024)
+	{
+		logTestString("obj test file too small to be loaded in parallel\n");
+		file->drop();
+		return false;
+	}
+	scene::IAnimatedMesh* serial = smgr->getMesh(file);
+	file->drop();
+
+	smgr->getParameters()->setAttribute(scene::OBJ_LOADER_PARALLEL_PARSING, true);
+	file = createObjFile(fs, "parallel.obj", 250);
+	scene::IAnimatedMesh* parallel = smgr->getMesh(file);
+	file->drop();
+	smgr->getParameters()->setAttribute(scene::OBJ_LOADER_PARALLEL_PARSING, false);
+
+	assert_log(serial && parallel);
+	if (!serial || !parallel)
+		return false;
+
+	bool result = serial->getMeshBufferCount() == parallel->getMeshBufferCount();
+	for (u32 i=0; result && i<serial->getMeshBufferCount(); ++i)
+	{
+		const scene::IMeshBuffer* a = serial->getMeshBuffer(i);
+		const scene::IMeshBuffer* b = parallel->getMeshBuffer(i);
+		result &= a->getVertexCount() == b->getVertexCount();
+		result &= a->getIndexCount() == b->getIndexCount();
+		if (result)
+			result &= 0 == memcmp(a->getVertices(), b->getVertices(), a->getVertexCount()*sizeof(video::S3DVertex));
+		if (result)
+			result &= 0 == memcmp(a->getIndices(), b->getIndices(), a->getIndexCount()*sizeof(u16));
+	}
+	if (!result)
+		logTestString("obj parallel parsing created a different mesh\n");
+
+	smgr->getMeshCache()->removeMesh(serial);
+	smgr->getMeshCache()->removeMesh(parallel);
+	return result;
+}
+
+// Face corners with the same indices share a vertex, others don't
+bool objVertexSharing(IrrlichtDevice* device)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	io::IFileSystem* fs = device->getFileSystem();
+
+	const c8 obj[] =
+		"v 0 0 0\nv 1 0 0\nv 1 0 1\nv 0 0 1\n"
+		"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvt 0 0\n"
+		"f 1/1 2/2 3/3\n"
+		"f 1/1 3/3 4/4\n"
+		"f 1/5 3/3 4/4\n";
+	io::IReadFile* file = fs->createMemoryReadFile(obj, sizeof(obj)-1, "sharing.obj");
+	scene::IAnimatedMesh* mesh = smgr->getMesh(file);
+	file->drop();
+	assert_log(mesh);
+	if (!mesh)
+		return false;
+
+	bool result = (mesh->getMeshBufferCount() == 1);
+	// 4 corners plus one for 1/5, which has the same values as 1/1
+	if (result)
+		result = (mesh->getMeshBuffer(0)->getVertexCount() == 5) && (mesh->getMeshBuffer(0)->getIndexCount() == 9);
+	if (!result)
+		logTestString("obj vertex sharing failed\n");
+
+	smgr->getMeshCache()->removeMesh(mesh);
+	return result;
+}
+
+}
+
 // Tests mesh loading features and the mesh cache.
 /** This won't test render results. Currently, not all mesh loaders are tested. */
 bool meshLoaders(void)
@@ -29,6 +154,9 @@ bool meshLoaders(void)
 		}
 	}
 
+	result &= objVertexSharing(device);
+	result &= objParallelParsing(device);
+
 	device->closeDevice();
 	device->run();
 	device->drop();
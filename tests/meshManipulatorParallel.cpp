@@ -0,0 +1,293 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+
+//! Height of the wavy grids, so that smooth normals and tangents differ from face normals
+f32 height(u32 x, u32 z, u32 seed)
+{
+	return sinf(x * 0.37f + seed) * cosf(z * 0.23f - seed * 0.5f) * 3.f;
+}
+
+//! Adds a grid of quads with shared vertices to a buffer with any vertex and index type
+void fillGrid(scene::IDynamicMeshBuffer* buffer, u32 size, u32 seed)
+{
+	for (u32 z=0; z<size; ++z)
+	{
+		for (u32 x=0; x<size; ++x)
+		{
+			video::S3DVertexTangents v(core::vector3df((f32)x, height(x, z, seed), (f32)z + seed * 0.1f),
+				core::vector3df(0,1,0), video::SColor(255, x, z, seed), core::vector2df(x * 0.1f, z * 0.1f));
+			switch (buffer->getVertexType())
+			{
+			case video::EVT_STANDARD:
+				buffer->getVertexBuffer().push_back(video::S3DVertex(v.Pos, v.Normal, v.Color, v.TCoords));
+				break;
+			case video::EVT_2TCOORDS:
+				buffer->getVertexBuffer().push_back(video::S3DVertex2TCoords(v.Pos, v.Normal, v.Color, v.TCoords, v.TCoords));
+				break;
+			case video::EVT_TANGENTS:
+				buffer->getVertexBuffer().push_back(v);
+				break;
+			}
+		}
+	}
+	for (u32 z=0; z+1<size; ++z)
+	{
+		for (u32 x=0; x+1<size; ++x)
+		{
+			const u32 i = z * size + x;
+			buffer->getIndexBuffer().push_back(i);
+			buffer->getIndexBuffer().push_back(i + size);
+			buffer->getIndexBuffer().push_back(i + 1);
+			buffer->getIndexBuffer().push_back(i + 1);
+			buffer->getIndexBuffer().push_back(i + size);
+			buffer->getIndexBuffer().push_back(i + size + 1);
+		}
+	}
+	// a degenerated triangle
+	buffer->getIndexBuffer().push_back(0);
+	buffer->getIndexBuffer().push_back(0);
+	buffer->getIndexBuffer().push_back(1);
+	buffer->recalculateBoundingBox();
+}
+
+//! An imported level: many small mesh buffers and a few large ones of all types
+scene::SMesh* createLevel(u32 smallBuffers)
+{
+	scene::SMesh* mesh = new scene::SMesh();
+	const video::E_VERTEX_TYPE types[] = { video::EVT_STANDARD, video::EVT_2TCOORDS, video::EVT_TANGENTS };
+	for (u32 i=0; i<smallBuffers; ++i)
+	{
+		scene::CDynamicMeshBuffer* buffer = new scene::CDynamicMeshBuffer(types[i % 3], video::EIT_16BIT);
+		fillGrid(buffer, 12, i);
+		mesh->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+	for (u32 i=0; i<3; ++i)
+	{
+		// above the size at which a buffer is split into parts
+		scene::CDynamicMeshBuffer* buffer = new scene::CDynamicMeshBuffer(types[i],
+			i ? video::EIT_16BIT : video::EIT_32BIT);
+		fillGrid(buffer, 90 + i * 10, i + 7);
+		mesh->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+	mesh->recalculateBoundingBox();
+	return mesh;
+}
+
+enum EOperation
+{
+	EO_FLAT_NORMALS = 0,
+	EO_SMOOTH_NORMALS,
+	EO_ANGLE_WEIGHTED_NORMALS,
+	EO_TANGENTS,
+	EO_PLANAR_MAPPING,
+	EO_AXIS_PLANAR_MAPPING,
+	EO_TRANSFORM,
+	EO_MESH_WITH_TANGENTS,
+	EO_COUNT
+};
+
+const c8* const OperationNames[] =
+{
+	"flat normals", "smooth normals", "angle weighted normals", "tangents",
+	"planar mapping", "axis planar mapping", "transform", "mesh with tangents"
+};
+
+//! Runs an operation on a level and returns the changed mesh
+scene::IMesh* runOperation(const scene::IMeshManipulator* manipulator, EOperation operation, scene::SMesh* mesh)
+{
+	switch (operation)
+	{
+	case EO_FLAT_NORMALS:
+		manipulator->recalculateNormals(mesh, false);
+		break;
+	case EO_SMOOTH_NORMALS:
+		manipulator->recalculateNormals(mesh, true);
+		break;
+	case EO_ANGLE_WEIGHTED_NORMALS:
+		manipulator->recalculateNormals(mesh, true, true);
+		break;
+	case EO_TANGENTS:
+		manipulator->recalculateTangents(mesh, true, true, true);
+		break;
+	case EO_PLANAR_MAPPING:
+		manipulator->makePlanarTextureMapping(mesh, 0.05f);
+		break;
+	case EO_AXIS_PLANAR_MAPPING:
+		manipulator->makePlanarTextureMapping(mesh, 0.05f, 0.02f, 1, core::vector3df(1.f, 2.f, 3.f));
+		break;
+	case EO_TRANSFORM:
+		{
+			core::matrix4 m;
+			m.setRotationDegrees(core::vector3df(10.f, 45.f, -30.f));
+			m.setTranslation(core::vector3df(5.f, -2.f, 100.f));
+			m.setScale(1.5f);
+			manipulator->transform(mesh, m);
+		}
+		break;
+	case EO_MESH_WITH_TANGENTS:
+		{
+			scene::IMesh* tangents = manipulator->createMeshWithTangents(mesh, true, true);
+			mesh->drop();
+			return tangents;
+		}
+	default:
+		break;
+	}
+	return mesh;
+}
+
+//! Runs all operations with the given number of worker threads
+void runOperations(u32 workerThreads, u32 smallBuffers, core::array<scene::IMesh*>& results, u32* times)
+{
+	SIrrlichtCreationParameters params;
+	params.DriverType = video::EDT_NULL;
+	params.WindowSize = core::dimension2du(160, 120);
+	params.WorkerThreads = workerThreads;
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return;
+
+	const scene::IMeshManipulator* manipulator = device->getSceneManager()->getMeshManipulator();
+	ITimer* timer = device->getTimer();
+	for (u32 i=0; i<EO_COUNT; ++i)
+	{
+		scene::SMesh* mesh = createLevel(smallBuffers);
+		const u32 start = timer->getRealTime();
+		results.push_back(runOperation(manipulator, (EOperation)i, mesh));
+		if (times)
+			times[i] = timer->getRealTime() - start;
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+}
+
+//! Meshes must be the same to the last bit
+bool compareMeshes(const scene::IMesh* a, const scene::IMesh* b, const c8* operation)
+{
+	if (a->getMeshBufferCount() != b->getMeshBufferCount())
+	{
+		logTestString("%s: %d mesh buffers instead of %d\n", operation, b->getMeshBufferCount(), a->getMeshBufferCount());
+		return false;
+	}
+	if (a->getBoundingBox() != b->getBoundingBox())
+	{
+		logTestString("%s: mesh bounding boxes differ\n", operation);
+		return false;
+	}
+	for (u32 i=0; i<a->getMeshBufferCount(); ++i)
+	{
+		const scene::IMeshBuffer* ma = a->getMeshBuffer(i);
+		const scene::IMeshBuffer* mb = b->getMeshBuffer(i);
+		if (ma->getVertexType() != mb->getVertexType() || ma->getIndexType() != mb->getIndexType() ||
+			ma->getVertexCount() != mb->getVertexCount() || ma->getIndexCount() != mb->getIndexCount())
+		{
+			logTestString("%s: mesh buffer %d has a different layout\n", operation, i);
+			return false;
+		}
+		const u32 vertexSize = video::getVertexPitchFromType(ma->getVertexType());
+		if (memcmp(ma->getVertices(), mb->getVertices(), ma->getVertexCount() * vertexSize))
+		{
+			logTestString("%s: vertices of mesh buffer %d differ\n", operation, i);
+			return false;
+		}
+		const u32 indexSize = ma->getIndexType() == video::EIT_16BIT ? sizeof(u16) : sizeof(u32);
+		if (memcmp(ma->getIndices(), mb->getIndices(), ma->getIndexCount() * indexSize))
+		{
+			logTestString("%s: indices of mesh buffer %d differ\n", operation, i);
+			return false;
+		}
+		if (ma->getBoundingBox() != mb->getBoundingBox())
+		{
+			logTestString("%s: bounding boxes of mesh buffer %d differ\n", operation, i);
+			return false;
+		}
+	}
+	return true;
+}
+
+void dropMeshes(core::array<scene::IMesh*>& meshes)
+{
+	for (u32 i=0; i<meshes.size(); ++i)
+		meshes[i]->drop();
+	meshes.clear();
+}
+
+//! Smooth normals of a flat grid point up, also where the triangles are split into parts
+bool flatGridNormals()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return false;
+
+	scene::CDynamicMeshBuffer* buffer = new scene::CDynamicMeshBuffer(video::EVT_STANDARD, video::EIT_32BIT);
+	fillGrid(buffer, 100, 0);
+	for (u32 i=0; i<buffer->getVertexCount(); ++i)
+		buffer->getPosition(i).Y = 0.f;
+	device->getSceneManager()->getMeshManipulator()->recalculateNormals(buffer, true, true);
+
+	bool result = true;
+	for (u32 i=2; i<buffer->getVertexCount(); ++i)
+	{
+		if (!buffer->getNormal(i).equals(core::vector3df(0.f, 1.f, 0.f)))
+		{
+			logTestString("Normal %d of the flat grid is (%f %f %f)\n", i,
+				buffer->getNormal(i).X, buffer->getNormal(i).Y, buffer->getNormal(i).Z);
+			result = false;
+			break;
+		}
+	}
+	buffer->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+	return result;
+}
+
+}
+
+// Mesh manipulator operations split onto several threads give the same meshes as on one thread
+bool meshManipulatorParallel()
+{
+	bool result = flatGridNormals();
+
+	core::array<scene::IMesh*> serial;
+	core::array<scene::IMesh*> parallel;
+	runOperations(1, 60, serial, 0);
+	runOperations(4, 60, parallel, 0);
+	if (serial.size() != EO_COUNT || parallel.size() != EO_COUNT)
+	{
+		logTestString("Could not create the devices\n");
+		result = false;
+	}
+	else
+	{
+		for (u32 i=0; i<EO_COUNT; ++i)
+			result &= compareMeshes(serial[i], parallel[i], OperationNames[i]);
+	}
+	dropMeshes(serial);
+	dropMeshes(parallel);
+
+	// a level of 300 mesh buffers, as loaded by the application
+	u32 serialTimes[EO_COUNT];
+	u32 parallelTimes[EO_COUNT];
+	runOperations(1, 300, serial, serialTimes);
+	runOperations(0, 300, parallel, parallelTimes);
+	for (u32 i=0; i<serial.size() && i<parallel.size(); ++i)
+	{
+		logTestString("%s of 300 mesh buffers took %d ms on one thread and %d ms on all cores\n",
+			OperationNames[i], serialTimes[i], parallelTimes[i]);
+	}
+	dropMeshes(serial);
+	dropMeshes(parallel);
+
+	return result;
+}
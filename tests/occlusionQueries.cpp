@@ -0,0 +1,211 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+bool hasQueryFlag(const scene::ISceneNode* node)
+{
+	return (node->getAutomaticCulling() & scene::EAC_OCC_QUERY) != 0;
+}
+
+core::array<scene::ISceneNode*> createNodes(scene::ISceneManager* smgr, u32 count)
+{
+	scene::IMesh* mesh = smgr->getGeometryCreator()->createCubeMesh();
+	core::array<scene::ISceneNode*> nodes;
+	nodes.reallocate(count);
+	for (u32 i=0; i<count; ++i)
+		nodes.push_back(smgr->addMeshSceneNode(mesh, 0, -1, core::vector3df((f32)(i % 100), (f32)(i / 100), 0.f)));
+	mesh->drop();
+	return nodes;
+}
+
+// adds, removes and re-adds queries and checks which nodes are queried afterwards
+bool checkQueries(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+	core::array<scene::ISceneNode*> nodes = createNodes(device->getSceneManager(), 10000);
+
+	for (u32 i=0; i<nodes.size(); ++i)
+		driver->addOcclusionQuery(nodes[i]);
+	// adding twice keeps a single query
+	driver->addOcclusionQuery(nodes[0]);
+
+	// remove every third query, the remaining ones keep their slots
+	for (u32 i=0; i<nodes.size(); i+=3)
+		driver->removeOcclusionQuery(nodes[i]);
+
+	bool result = true;
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		const bool queried = (i % 3) != 0;
+		if (hasQueryFlag(nodes[i]) != queried)
+		{
+			logTestString("Node %d should %shave an occlusion query\n", i, queried ? "" : "not ");
+			result = false;
+			break;
+		}
+		// the null driver has no results, but known queries report the initial one
+		if (driver->getOcclusionQueryResult(nodes[i]) != ~0u)
+		{
+			logTestString("Node %d has occlusion query result %d\n", i, driver->getOcclusionQueryResult(nodes[i]));
+			result = false;
+			break;
+		}
+	}
+
+	driver->runAllOcclusionQueries(false);
+	driver->updateAllOcclusionQueries();
+
+	// a query which is not run for more than 1000 updates is removed
+	driver->runOcclusionQuery(nodes[1]);
+	driver->removeOcclusionQuery(nodes[2]);
+	for (u32 i=0; i<1000; ++i)
+	{
+		driver->runOcclusionQuery(nodes[1]);
+		driver->updateAllOcclusionQueries();
+	}
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		if (hasQueryFlag(nodes[i]) != (i == 1))
+		{
+			logTestString("Node %d should %shave an occlusion query after the updates\n", i, i == 1 ? "" : "not ");
+			result = false;
+			break;
+		}
+	}
+
+	for (u32 i=0; i<nodes.size(); i+=2)
+		driver->addOcclusionQuery(nodes[i]);
+	driver->removeAllOcclusionQueries();
+	for (u32 i=0; i<nodes.size(); ++i)
+	{
+		if (hasQueryFlag(nodes[i]))
+		{
+			logTestString("Node %d still has an occlusion query\n", i);
+			result = false;
+			break;
+		}
+	}
+
+	device->getSceneManager()->clear();
+	return result;
+}
+
+// the software renderer counts the samples of the queries against its depth buffer
+bool checkBurningQueries()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, 0.f), core::vector3df(0.f, 0.f, 100.f));
+
+	scene::ISceneNode* occluder = smgr->addCubeSceneNode(4.f, 0, -1, core::vector3df(0.f, 0.f, 20.f));
+	occluder->setMaterialFlag(video::EMF_LIGHTING, false);
+	scene::ISceneNode* hidden = smgr->addSphereSceneNode(2.f, 16, 0, -1, core::vector3df(0.f, 0.f, 60.f));
+	scene::ISceneNode* visible = smgr->addSphereSceneNode(2.f, 16, 0, -1, core::vector3df(20.f, 0.f, 60.f));
+	driver->addOcclusionQuery(hidden, static_cast<scene::IMeshSceneNode*>(hidden)->getMesh());
+	driver->addOcclusionQuery(visible, static_cast<scene::IMeshSceneNode*>(visible)->getMesh());
+
+	bool result = driver->queryFeature(video::EVDF_OCCLUSION_QUERY);
+	if (!result)
+		logTestString("Burning driver does not support occlusion queries\n");
+
+	// only the occluder is in the depth buffer when the queries run
+	hidden->setVisible(false);
+	visible->setVisible(false);
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	smgr->drawAll();
+	driver->runAllOcclusionQueries(false);
+	driver->updateAllOcclusionQueries();
+	driver->endScene();
+
+	const u32 hiddenSamples = driver->getOcclusionQueryResult(hidden);
+	const u32 visibleSamples = driver->getOcclusionQueryResult(visible);
+	if (hiddenSamples != 0 || visibleSamples == 0 || visibleSamples == ~0u)
+	{
+		logTestString("Query results are %d for the hidden and %d for the visible sphere\n", hiddenSamples, visibleSamples);
+		result = false;
+	}
+
+	// the hidden node is culled now, the visible one is drawn
+	hidden->setVisible(true);
+	visible->setVisible(true);
+	if (!smgr->isCulled(hidden) || smgr->isCulled(visible))
+	{
+		logTestString("Occlusion query culling is wrong\n");
+		result = false;
+	}
+
+	// without occluder the hidden sphere gets samples as well
+	occluder->setVisible(false);
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	driver->runOcclusionQuery(hidden, true);
+	driver->endScene();
+	if (driver->getOcclusionQueryResult(hidden) == 0)
+	{
+		logTestString("Sphere without occluder has no samples\n");
+		result = false;
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
+
+// only logs the time needed for increasing numbers of queries
+void querySpeed(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ITimer* timer = device->getTimer();
+
+	for (u32 count=2500; count<=10000; count*=2)
+	{
+		core::array<scene::ISceneNode*> nodes = createNodes(device->getSceneManager(), count);
+
+		const u32 start = timer->getRealTime();
+		for (u32 i=0; i<nodes.size(); ++i)
+			driver->addOcclusionQuery(nodes[i]);
+		for (u32 r=0; r<10; ++r)
+		{
+			driver->runAllOcclusionQueries(false);
+			driver->updateAllOcclusionQueries();
+			for (u32 i=0; i<nodes.size(); ++i)
+				driver->getOcclusionQueryResult(nodes[i]);
+		}
+		for (u32 i=0; i<nodes.size(); ++i)
+			driver->removeOcclusionQuery(nodes[i]);
+		const u32 time = timer->getRealTime() - start;
+
+		logTestString("%d occlusion queries added, run 10 times and removed in %d ms\n", count, time);
+		device->getSceneManager()->clear();
+	}
+}
+}
+
+bool occlusionQueries()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return true; // could not create selected driver.
+
+	bool result = checkQueries(device);
+	querySpeed(device);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	result &= checkBurningQueries();
+
+	return result;
+}
@@ -0,0 +1,158 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+//! A grid of quads with a color for each vertex
+scene::IMesh* createGrid(u32 size, video::E_INDEX_TYPE indexType)
+{
+	scene::CDynamicMeshBuffer* buffer = new scene::CDynamicMeshBuffer(video::EVT_STANDARD, indexType);
+	buffer->getMaterial().Lighting = false;
+
+	const f32 step = 200.f / (size - 1);
+	for (u32 z=0; z<size; ++z)
+	{
+		for (u32 x=0; x<size; ++x)
+		{
+			buffer->getVertexBuffer().push_back(video::S3DVertex(x * step - 100.f, 0.f, z * step - 100.f,
+				0.f, 1.f, 0.f, video::SColor(255, (x * 255) / size, (z * 255) / size, ((x + z) % 2) * 255), 0.f, 0.f));
+		}
+	}
+
+	for (u32 z=0; z+1<size; ++z)
+	{
+		for (u32 x=0; x+1<size; ++x)
+		{
+			const u32 i = z * size + x;
+			buffer->getIndexBuffer().push_back(i);
+			buffer->getIndexBuffer().push_back(i + size);
+			buffer->getIndexBuffer().push_back(i + 1);
+			buffer->getIndexBuffer().push_back(i + 1);
+			buffer->getIndexBuffer().push_back(i + size);
+			buffer->getIndexBuffer().push_back(i + size + 1);
+		}
+	}
+	buffer->recalculateBoundingBox();
+
+	scene::SMesh* mesh = new scene::SMesh();
+	mesh->addMeshBuffer(buffer);
+	mesh->recalculateBoundingBox();
+	buffer->drop();
+	return mesh;
+}
+
+video::IImage* renderScene(IrrlichtDevice* device)
+{
+	video::IVideoDriver* driver = device->getVideoDriver();
+	driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	device->getSceneManager()->drawAll();
+	driver->endScene();
+	return driver->createScreenShot();
+}
+
+bool compareImages(video::IImage* image, video::IImage* reference, const char* name)
+{
+	if (!image || !reference)
+		return true;
+
+	u32 differences = 0;
+	const core::dimension2du size = image->getDimension();
+	for (u32 y=0; y<size.Height; ++y)
+	{
+		for (u32 x=0; x<size.Width; ++x)
+		{
+			if (image->getPixel(x, y) != reference->getPixel(x, y))
+				++differences;
+		}
+	}
+
+	if (differences)
+		logTestString("%s differs from the mesh scene node in %d pixels\n", name, differences);
+	return differences == 0;
+}
+
+//! Renders a grid with an octree and a mesh scene node from two camera positions
+bool compareWithMeshNode(IrrlichtDevice* device, u32 gridSize, video::E_INDEX_TYPE indexType)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::IMesh* mesh = createGrid(gridSize, indexType);
+
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode();
+	const core::vector3df positions[2] = { core::vector3df(-60.f, 40.f, -60.f), core::vector3df(50.f, 30.f, 20.f) };
+	const core::vector3df targets[2] = { core::vector3df(-20.f, 0.f, 0.f), core::vector3df(90.f, 0.f, 90.f) };
+
+	// reference images
+	video::IImage* references[2];
+	scene::ISceneNode* node = smgr->addMeshSceneNode(mesh);
+	for (u32 c=0; c<2; ++c)
+	{
+		camera->setPosition(positions[c]);
+		camera->setTarget(targets[c]);
+		references[c] = renderScene(device);
+	}
+	node->remove();
+
+	bool result = true;
+	scene::IOctreeSceneNode* octree = smgr->addOctreeSceneNode(mesh, 0, -1, 64);
+	const scene::EOCTREENODE_VBO modes[3] = { scene::EOV_NO_VBO, scene::EOV_USE_VBO, scene::EOV_USE_VBO_WITH_VISIBITLY };
+	const char* modeNames[3] = { "no vbo", "vbo", "vbo with visibility" };
+	for (u32 m=0; m<3; ++m)
+	{
+		octree->setUseVBO(modes[m]);
+		for (u32 checks=0; checks<2; ++checks)
+		{
+			octree->setPolygonChecks(checks ? scene::EOPC_FRUSTUM : scene::EOPC_BOX);
+
+			// the second frame with the same camera uses the cached ranges
+			for (u32 frame=0; frame<4; ++frame)
+			{
+				const u32 c = frame / 2;
+				camera->setPosition(positions[c]);
+				camera->setTarget(targets[c]);
+				video::IImage* image = renderScene(device);
+
+				core::stringc name = core::stringc("Octree with ") + modeNames[m] + (checks ? ", frustum checks" : ", box checks") +
+					", " + core::stringc(indexType == video::EIT_32BIT ? "32" : "16") + " bit indices, frame " + core::stringc(frame);
+				result &= compareImages(image, references[c], name.c_str());
+				if (image)
+					image->drop();
+			}
+		}
+	}
+	octree->remove();
+	camera->remove();
+
+	for (u32 c=0; c<2; ++c)
+	{
+		if (references[c])
+			references[c]->drop();
+	}
+	mesh->drop();
+
+	return result;
+}
+}
+
+// octrees draw the visible ranges of their indices, for meshes with 16 and 32 bit indices
+bool octreeSceneNode()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	bool result = compareWithMeshNode(device, 64, video::EIT_16BIT);
+
+	// more vertices than 16 bit indices can address
+	result &= compareWithMeshNode(device, 300, video::EIT_32BIT);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,101 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+//! Checks that frames arrive in order and have the clear color
+class CFrameChecker : public IFrameReceiver
+{
+public:
+	CFrameChecker() : Frames(0), Failed(false) {}
+
+	virtual void OnFrame(const video::IImage* frame, u32 frameNumber)
+	{
+		if (frameNumber != Frames)
+		{
+			logTestString("Got frame %d, expected %d\n", frameNumber, Frames);
+			Failed = true;
+		}
+		++Frames;
+
+		if (frame->getColorFormat() != video::ECF_R8G8B8 || frame->getDimension() != core::dimension2du(160, 120))
+		{
+			logTestString("Frame has wrong format or size\n");
+			Failed = true;
+			return;
+		}
+
+		// frames are cleared with a color depending on the frame number
+		const u8* data = (const u8*)frame->getData();
+		const u8* pixel = data + 60 * frame->getPitch() + 80 * 3;
+		if (pixel[0] != 255 || pixel[1] != (u8)(frameNumber * 10) || pixel[2] != 0)
+		{
+			logTestString("Frame %d has pixel color %d,%d,%d\n", frameNumber, pixel[0], pixel[1], pixel[2]);
+			Failed = true;
+		}
+	}
+
+	u32 Frames;
+	bool Failed;
+};
+}
+
+// renders frames without window and streams them to a file
+bool offscreenDevice()
+{
+	const u32 frameCount = 10;
+	FILE* file = fopen("results/offscreenDevice.ppm", "wb");
+	if (!file)
+	{
+		logTestString("Could not open results/offscreenDevice.ppm\n");
+		return false;
+	}
+
+	CFrameChecker checker;
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	params.FrameReceiver = &checker;
+	params.FrameStreamFile = fileno(file);
+	params.FrameStreamFormat = EFSF_PPM;
+
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+	{
+		fclose(file);
+		return true; // could not create selected driver.
+	}
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	for (u32 i=0; i<frameCount && device->run(); ++i)
+	{
+		driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 255, (u8)(i * 10), 0));
+		driver->endScene();
+	}
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	bool result = !checker.Failed;
+	if (checker.Frames != frameCount)
+	{
+		logTestString("Received %d of %d frames\n", checker.Frames, frameCount);
+		result = false;
+	}
+
+	// all frames were written before the device was dropped
+	const long frameSize = (long)strlen("P6\n160 120\n255\n") + 160 * 120 * 3;
+	fseek(file, 0, SEEK_END);
+	const long fileSize = ftell(file);
+	fclose(file);
+	if (fileSize != frameSize * (long)frameCount)
+	{
+		logTestString("Stream has %ld bytes, expected %ld\n", fileSize, frameSize * (long)frameCount);
+		result = false;
+	}
+
+	return result;
+}
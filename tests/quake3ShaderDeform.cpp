@@ -0,0 +1,312 @@
+#include "testUtils.h"
+
+using namespace irr;
+using namespace scene::quake3;
+
+namespace
+{
+//! Vertices with different normals and colors, count not divisible by four
+scene::SMeshBufferLightMap* createPoints(u32 count, u32 width)
+{
+	scene::SMeshBufferLightMap* buffer = new scene::SMeshBufferLightMap();
+	for (u32 i=0; i<count; ++i)
+	{
+		video::S3DVertex2TCoords v;
+		v.Pos.set((i % width) * 7.f - 50.f, sinf(i * 0.5f) * 3.f + 10.f, (i / width) * 7.f - 40.f);
+		v.Normal.set(sinf(i * 0.3f), 1.f, cosf(i * 0.7f));
+		v.Normal.normalize();
+		v.Color.set(255 - i % 256, i % 256, (i * 7) % 256, (i * 3) % 256);
+		v.TCoords.set(i * 0.01f, i * 0.02f);
+		v.TCoords2.set(i * 0.03f, 1.f - i * 0.01f);
+		buffer->Vertices.push_back(v);
+	}
+	for (u32 i=0; i+2<count; i+=3)
+	{
+		buffer->Indices.push_back(i);
+		buffer->Indices.push_back(i + 1);
+		buffer->Indices.push_back(i + 2);
+	}
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! Squares facing in different directions
+scene::SMeshBufferLightMap* createQuads()
+{
+	scene::SMeshBufferLightMap* buffer = new scene::SMeshBufferLightMap();
+	const core::vector3df centers[2] = { core::vector3df(-20.f, 5.f, 10.f), core::vector3df(25.f, -5.f, 30.f) };
+	for (u32 q=0; q<2; ++q)
+	{
+		const f32 s = 5.f + q * 3.f;
+		const core::vector3df normal = q ? core::vector3df(1.f, 0.f, 0.f) : core::vector3df(0.f, 0.f, -1.f);
+		const core::vector3df side = q ? core::vector3df(0.f, 0.f, s) : core::vector3df(s, 0.f, 0.f);
+		const core::vector3df up(0.f, s, 0.f);
+		const core::vector3df corners[4] = { -side - up, side - up, side + up, -side + up };
+		for (u32 c=0; c<4; ++c)
+		{
+			buffer->Vertices.push_back(video::S3DVertex2TCoords(centers[q] + corners[c], normal,
+				video::SColor(255, 255, 255, 255), core::vector2df((c == 1 || c == 2) ? 1.f : 0.f, c < 2 ? 1.f : 0.f),
+				core::vector2df(0.f, 0.f)));
+		}
+		buffer->Indices.push_back(q * 4);
+		buffer->Indices.push_back(q * 4 + 1);
+		buffer->Indices.push_back(q * 4 + 2);
+		buffer->Indices.push_back(q * 4);
+		buffer->Indices.push_back(q * 4 + 2);
+		buffer->Indices.push_back(q * 4 + 3);
+	}
+	buffer->recalculateBoundingBox();
+	return buffer;
+}
+
+//! A shader without textures, its first stage only moves the vertices
+IShader* createShader(const c8* name, const c8* const* variables, u32 count)
+{
+	IShader* shader = new IShader();
+	shader->name = name;
+	shader->VarGroup = new SVarGroupList();
+	shader->VarGroup->VariableGroup.push_back(SVarGroup());
+	SVarGroup stage;
+	for (u32 i=0; i<count; ++i)
+		stage.Variable.push_back(SVariable(variables[2 * i], variables[2 * i + 1]));
+	shader->VarGroup->VariableGroup.push_back(stage);
+	return shader;
+}
+
+void dropShader(IShader* shader)
+{
+	shader->VarGroup->drop();
+	delete shader;
+}
+
+const c8* const DEFORM_SHADER[] =
+{
+	"deformvertexes", "wave 30 sin 1 2 0.25 0.5",
+	"deformvertexes", "move 1 2 3 triangle 0 1.5 0 0.7",
+	"deformvertexes", "bulge 3 2 1",
+	"deformvertexes", "normal 0.2 2",
+	"rgbgen", "wave sin 0.5 0.5 0 1",
+	"alphagen", "const 0.25",
+	"tcgen", "environment"
+};
+
+//! The vertices of DEFORM_SHADER, computed one vertex after the other
+void deformReference(const scene::SMeshBufferLightMap* original, const core::vector3df& offset,
+	const scene::SViewFrustum* frustum, f32 dt, core::array<video::S3DVertex>& result)
+{
+	const u32 count = original->Vertices.size();
+	result.set_used(count);
+	for (u32 i=0; i<count; ++i)
+		result[i].Pos = original->Vertices[i].Pos - offset;
+
+	// the modifiers of a stage share their state
+	SModifierFunction function;
+
+	// wave 30 sin 1 2 0.25 0.5
+	function.func = SINUS;
+	function.base = 1.f;
+	function.amp = 2.f;
+	function.frequency = 0.5f;
+	function.wave = 1.f / 30.f;
+	for (u32 i=0; i<count; ++i)
+	{
+		const core::vector3df& p = result[i].Pos;
+		function.phase = 0.25f + (p.X + p.Y + p.Z) * function.wave;
+		result[i].Pos += original->Vertices[i].Normal * function.evaluate(dt);
+	}
+
+	// move 1 2 3 triangle 0 1.5 0 0.7
+	function.func = TRIANGLE;
+	function.base = 0.f;
+	function.amp = 1.5f;
+	function.phase = 0.f;
+	function.frequency = 0.7f;
+	const f32 move = function.evaluate(dt);
+	for (u32 i=0; i<count; ++i)
+		result[i].Pos += core::vector3df(1.f, 3.f, 2.f) * move;
+
+	// bulge 3 2 1, phase of the move before
+	function.func = SINUS;
+	function.bulgewidth = 3.f;
+	function.bulgeheight = 2.f;
+	function.bulgespeed = 1.f;
+	function.wave = 1.f / 3.f;
+	for (u32 i=0; i<count; ++i)
+	{
+		function.phase = original->Vertices[i].TCoords.X * function.wave;
+		result[i].Pos += original->Vertices[i].Normal * function.evaluate(dt * 0.1f);
+	}
+
+	// normal 0.2 2
+	function.amp = 0.2f;
+	function.frequency = 2.f;
+	for (u32 i=0; i<count; ++i)
+	{
+		const video::S3DVertex2TCoords& src = original->Vertices[i];
+		function.base = atan2f(src.Pos.X, src.Pos.Y);
+		function.phase = src.Pos.X + src.Pos.Z;
+		const f32 lat = function.evaluate(dt);
+		function.base = src.Normal.Y;
+		function.phase = src.Normal.Z + src.Normal.X;
+		const f32 lng = function.evaluate(dt);
+		result[i].Normal.set(cosf(lat) * sinf(lng), sinf(lat) * sinf(lng), cosf(lng));
+	}
+
+	// rgbgen wave sin 0.5 0.5 0 1, alphagen const 0.25
+	function.base = 0.5f;
+	function.amp = 0.5f;
+	function.phase = 0.f;
+	function.frequency = 1.f;
+	const s32 value = core::clamp(core::floor32(function.evaluate(dt) * 255.f), 0, 255);
+	for (u32 i=0; i<count; ++i)
+		result[i].Color.set((u32)(0.25f * 255.f), value, value, value);
+
+	// tcgen environment
+	const f32* m = frustum->getTransform(video::ETS_VIEW).pointer();
+	for (u32 i=0; i<count; ++i)
+	{
+		core::vector3df n = frustum->cameraPosition - original->Vertices[i].Pos;
+		n.normalize();
+		n += original->Vertices[i].Normal;
+		n.normalize();
+		result[i].TCoords.X = 0.5f * (1.f + (n.X * m[0] + n.Y * m[1] + n.Z * m[2]));
+		result[i].TCoords.Y = 0.5f * (1.f + (n.X * m[4] + n.Y * m[5] + n.Z * m[6]));
+	}
+}
+
+//! The quads of autosprite turned to the camera
+void autospriteReference(const scene::SMeshBufferLightMap* original, const core::vector3df& offset,
+	const core::vector3df& camPos, core::array<video::S3DVertex>& result)
+{
+	const video::S3DVertex2TCoords* vin = original->Vertices.const_pointer();
+	result.set_used(original->Vertices.size());
+	core::matrix4 lookat;
+	core::quaternion q;
+	for (u32 i=0; i<original->Vertices.size(); i+=4)
+	{
+		const core::vector3df center = 0.25f * (vin[i].Pos + vin[i+1].Pos + vin[i+2].Pos + vin[i+3].Pos);
+		q.rotationFromTo(vin[i].Normal, camPos - center);
+		q.getMatrixCenter(lookat, center, offset);
+		for (u32 g=0; g<4; ++g)
+		{
+			lookat.transformVect(result[i+g].Pos, vin[i+g].Pos);
+			lookat.rotateVect(result[i+g].Normal, vin[i+g].Normal);
+		}
+	}
+}
+
+bool checkVertices(scene::IMeshSceneNode* node, const core::array<video::S3DVertex>& expected, bool attributes, const char* name)
+{
+	const scene::IMeshBuffer* buffer = node->getMesh()->getMeshBuffer(0);
+	const video::S3DVertex* vertices = (const video::S3DVertex*)buffer->getVertices();
+	const core::aabbox3df& box = node->getBoundingBox();
+
+	u32 errors = 0;
+	for (u32 i=0; i<expected.size(); ++i)
+	{
+		const video::S3DVertex& v = vertices[i];
+		const video::S3DVertex& e = expected[i];
+		const bool position = v.Pos.equals(e.Pos, 0.001f) && box.isPointInside(v.Pos);
+		const bool normal = v.Normal.equals(e.Normal, 0.001f);
+		bool other = true;
+		if (attributes)
+		{
+			// the colors come from rounded waves
+			other = core::abs_((s32)v.Color.getRed() - (s32)e.Color.getRed()) <= 1 &&
+				v.Color.getRed() == v.Color.getGreen() && v.Color.getRed() == v.Color.getBlue() &&
+				v.Color.getAlpha() == e.Color.getAlpha() && v.TCoords.equals(e.TCoords, 0.001f);
+		}
+		if (!position || !normal || !other)
+		{
+			if (!errors)
+			{
+				logTestString("%s: vertex %d at %f,%f,%f normal %f,%f,%f color %08x tcoords %f,%f\n", name, i,
+					v.Pos.X, v.Pos.Y, v.Pos.Z, v.Normal.X, v.Normal.Y, v.Normal.Z, v.Color.color, v.TCoords.X, v.TCoords.Y);
+				logTestString("%s: expected %f,%f,%f normal %f,%f,%f color %08x tcoords %f,%f\n", name,
+					e.Pos.X, e.Pos.Y, e.Pos.Z, e.Normal.X, e.Normal.Y, e.Normal.Z, e.Color.color, e.TCoords.X, e.TCoords.Y);
+			}
+			++errors;
+		}
+	}
+	if (errors)
+		logTestString("%s: %d of %d vertices wrong\n", name, errors, expected.size());
+	return errors == 0;
+}
+
+void drawFrame(IrrlichtDevice* device, u32 time)
+{
+	device->getTimer()->setTime(time);
+	device->getVideoDriver()->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	device->getSceneManager()->drawAll();
+	device->getVideoDriver()->endScene();
+}
+}
+
+// the vertex modifiers of quake3 shaders move the vertices like evaluated one by one
+bool quake3ShaderDeform()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	device->getTimer()->stop();
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(10.f, 60.f, -120.f), core::vector3df(0.f, 0.f, 0.f));
+
+	IShader* shader = createShader("test/deform", DEFORM_SHADER, sizeof(DEFORM_SHADER) / sizeof(DEFORM_SHADER[0]) / 2);
+	scene::SMeshBufferLightMap* points = createPoints(203, 15);
+	scene::IMeshSceneNode* node = smgr->addQuake3SceneNode(points, shader);
+
+	core::array<video::S3DVertex> expected;
+	drawFrame(device, 12345);
+	deformReference(points, node->getPosition(), camera->getViewFrustum(), 12.345f, expected);
+	bool result = checkVertices(node, expected, true, "Deformed vertices");
+
+	drawFrame(device, 20500);
+	deformReference(points, node->getPosition(), camera->getViewFrustum(), 20.5f, expected);
+	result &= checkVertices(node, expected, true, "Deformed vertices later");
+
+	// a culled node keeps its vertices
+	camera->setTarget(core::vector3df(10.f, 60.f, -300.f));
+	drawFrame(device, 30000);
+	result &= checkVertices(node, expected, true, "Culled node");
+	node->remove();
+	points->drop();
+
+	// autosprites face the camera
+	const c8* const spriteShader[] = { "deformvertexes", "autosprite" };
+	IShader* sprites = createShader("test/sprite", spriteShader, 1);
+	scene::SMeshBufferLightMap* quads = createQuads();
+	node = smgr->addQuake3SceneNode(quads, sprites);
+	camera->setTarget(core::vector3df(0.f, 0.f, 0.f));
+	drawFrame(device, 1000);
+	autospriteReference(quads, node->getPosition(), camera->getPosition(), expected);
+	result &= checkVertices(node, expected, false, "Autosprites");
+	node->remove();
+	quads->drop();
+	dropShader(sprites);
+
+	// many vertices
+	points = createPoints(256 * 256, 256);
+	node = smgr->addQuake3SceneNode(points, shader);
+	camera->setPosition(core::vector3df(800.f, 600.f, -800.f));
+	camera->setTarget(core::vector3df(800.f, 0.f, 800.f));
+	ITimer* timer = device->getTimer();
+	const u32 start = timer->getRealTime();
+	for (u32 i=0; i<100; ++i)
+		drawFrame(device, 40000 + i * 16);
+	logTestString("Deforming %d vertices 100 times took %d ms\n", points->Vertices.size(), timer->getRealTime() - start);
+	node->remove();
+	points->drop();
+	dropShader(shader);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
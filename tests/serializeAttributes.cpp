@@ -334,6 +334,107 @@ bool stringSerialization(io::IFileSystem * fs)
 	return true;
 }
 
+// Lookups by name must behave like a linear search, also for long lists
+bool nameLookup(io::IFileSystem * fs)
+{
+	io::IAttributes* attr = fs->createEmptyAttributes();
+	core::stringc name;
+
+	for ( s32 i=0; i<100; ++i )
+	{
+		name = "attr";
+		name += i;
+		attr->addInt(name.c_str(), i);
+	}
+
+	// a second attribute with the same name is found by index only
+	attr->addInt("attr5", 1000);
+	COMPARE(attr->getAttributeCount(), 101u);
+	COMPARE(attr->getAttributeAsInt("attr5"), 5);
+	COMPARE(attr->getAttributeAsInt(100), 1000);
+
+	for ( s32 i=0; i<100; ++i )
+	{
+		name = "attr";
+		name += i;
+		COMPARE(attr->findAttribute(name.c_str()), i);
+		COMPARE(core::stringc(attr->getAttributeName(i)), name);
+	}
+	COMPARE(attr->findAttribute("attr100"), -1);
+	COMPARE(attr->findAttribute(""), -1);
+	COMPARE(attr->existsAttribute("attr"), false);
+
+	// removing moves all following attributes
+	attr->setAttribute("attr3", (const c8*)0);
+	COMPARE(attr->getAttributeCount(), 100u);
+	COMPARE(attr->findAttribute("attr3"), -1);
+	COMPARE(attr->findAttribute("attr4"), 3);
+	COMPARE(attr->findAttribute("attr99"), 98);
+
+	// removing the first duplicate makes the second one visible
+	attr->setAttribute("attr5", (const c8*)0);
+	COMPARE(attr->getAttributeAsInt("attr5"), 1000);
+	COMPARE(attr->findAttribute("attr5"), 98);
+
+	// setting a missing attribute adds it
+	attr->setAttribute("new", 7);
+	COMPARE(attr->findAttribute("new"), 99);
+
+	attr->clear();
+	attr->addFloat("small", 1.f);
+	COMPARE(attr->findAttribute("small"), 0);
+	COMPARE(attr->findAttribute("attr4"), -1);
+
+	attr->drop();
+
+	return true;
+}
+
+// Speed of cloning scene nodes and reading their attributes, timings are only logged
+bool nodeSerializationSpeed(IrrlichtDevice * device)
+{
+	scene::ISceneManager* smgr = device->getSceneManager()->createNewSceneManager();
+	video::IVideoDriver* driver = device->getVideoDriver();
+	ITimer* timer = device->getTimer();
+
+	const u32 NODES = 1000;
+	scene::ISceneNode* parent = smgr->addEmptySceneNode();
+	for ( u32 i=0; i<NODES; ++i )
+	{
+		scene::ISceneNode* node = smgr->addCubeSceneNode(1.f, parent, i, core::vector3df((f32)i, 0, 0));
+		scene::ISceneNodeAnimator* anim = smgr->createRotationAnimator(core::vector3df(0, 1.f, 0));
+		node->addAnimator(anim);
+		anim->drop();
+	}
+
+	u32 then = timer->getRealTime();
+	for ( u32 i=0; i<10; ++i )
+		parent->clone()->remove();
+	const u32 cloneTime = timer->getRealTime() - then;
+
+	scene::ISceneNode* node = *parent->getChildren().begin();
+	io::IAttributes* nodeAttr = device->getFileSystem()->createEmptyAttributes(driver);
+	node->serializeAttributes(nodeAttr);
+	io::IAttributes* materialAttr = driver->createAttributesFromMaterial(node->getMaterial(0));
+
+	then = timer->getRealTime();
+	for ( u32 i=0; i<10*NODES; ++i )
+	{
+		node->deserializeAttributes(nodeAttr);
+		driver->fillMaterialStructureFromAttributes(node->getMaterial(0), materialAttr);
+	}
+	const u32 deserializeTime = timer->getRealTime() - then;
+
+	logTestString("Speed test\n  clone %d nodes = %d ms\n  deserialize %d nodes and materials = %d ms\n",
+		10*NODES, cloneTime, 10*NODES, deserializeTime);
+
+	nodeAttr->drop();
+	materialAttr->drop();
+	smgr->drop();
+
+	return true;
+}
+
 bool serializeAttributes()
 {
 	bool result = true;
@@ -370,6 +471,14 @@ bool serializeAttributes()
 		logTestString("stringSerialization failed in %s:%d\n", __FILE__, __LINE__ );
 	}
 
+	result &= nameLookup(fs);
+	if ( !result )
+	{
+		logTestString("nameLookup failed in %s:%d\n", __FILE__, __LINE__ );
+	}
+
+	result &= nodeSerializationSpeed(device);
+
 	device->closeDevice();
 	device->run();
 	device->drop();
@@ -0,0 +1,215 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+//! Loads a mesh which is not shared with earlier loads of the file
+scene::ISkinnedMesh* loadSkinnedMesh(scene::ISceneManager* smgr, const io::path& filename)
+{
+	scene::IAnimatedMesh* mesh = smgr->getMesh(filename);
+	if (!mesh || mesh->getMeshType() != scene::EAMT_SKINNED)
+		return 0;
+	mesh->grab();
+	smgr->getMeshCache()->removeMesh(mesh);
+	return static_cast<scene::ISkinnedMesh*>(mesh);
+}
+
+//! Returns if a frame is next to two keys on the same frame, such jumps are smoothed by the samples
+bool isNextToJump(const scene::ISkinnedMesh* mesh, f32 frame)
+{
+	for (u32 i=0; i<mesh->getJointCount(); ++i)
+	{
+		const scene::ISkinnedMesh::SJoint* joint = mesh->getAllJoints()[i];
+		for (u32 k=1; k<joint->PositionKeys.size(); ++k)
+		{
+			if (joint->PositionKeys[k].frame == joint->PositionKeys[k-1].frame && core::abs_(joint->PositionKeys[k].frame - frame) < 1.f)
+				return true;
+		}
+		for (u32 k=1; k<joint->ScaleKeys.size(); ++k)
+		{
+			if (joint->ScaleKeys[k].frame == joint->ScaleKeys[k-1].frame && core::abs_(joint->ScaleKeys[k].frame - frame) < 1.f)
+				return true;
+		}
+		for (u32 k=1; k<joint->RotationKeys.size(); ++k)
+		{
+			if (joint->RotationKeys[k].frame == joint->RotationKeys[k-1].frame && core::abs_(joint->RotationKeys[k].frame - frame) < 1.f)
+				return true;
+		}
+	}
+	return false;
+}
+
+//! Animates a mesh at pseudo random frames and returns the time it took
+u32 seekFrames(ITimer* timer, scene::ISkinnedMesh* mesh, u32 count)
+{
+	const u32 start = timer->getRealTime();
+	u32 seed = 1;
+	for (u32 i=0; i<count; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		mesh->animateMesh((seed >> 8) % 10000 * 0.0001f * mesh->getFrameCount(), 1.f);
+	}
+	return timer->getRealTime() - start;
+}
+
+//! Compares the baked animation of a mesh with the animation of its keys
+bool compareBaked(IrrlichtDevice* device, const io::path& filename)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::ISkinnedMesh* keys = loadSkinnedMesh(smgr, filename);
+	scene::ISkinnedMesh* baked = loadSkinnedMesh(smgr, filename);
+	if (!keys || !baked)
+	{
+		logTestString("Could not load %s.\n", filename.c_str());
+		if (keys)
+			keys->drop();
+		if (baked)
+			baked->drop();
+		return false;
+	}
+
+	bool result = !baked->isAnimationBaked() && baked->bakeAnimation() && baked->isAnimationBaked();
+	if (!result)
+		logTestString("Could not bake the animation of %s.\n", filename.c_str());
+
+	// the frame count stays the same
+	if (baked->getFrameCount() != keys->getFrameCount())
+	{
+		logTestString("%s has %d frames after baking, expected %d.\n", filename.c_str(), baked->getFrameCount(), keys->getFrameCount());
+		result = false;
+	}
+
+	// on frames and between them, also jumping backwards
+	const f32 endFrame = (f32)(keys->getFrameCount() - 1);
+	u32 errors = 0;
+	for (u32 i=0; i<200; ++i)
+	{
+		const f32 frame = core::min_(core::fract(i * 0.618034f) * endFrame + (i % 3 ? 0.f : 0.5f), endFrame);
+		if (isNextToJump(keys, frame))
+			continue;
+
+		keys->animateMesh(frame, 1.f);
+		baked->animateMesh(frame, 1.f);
+
+		for (u32 j=0; j<keys->getJointCount(); ++j)
+		{
+			const scene::ISkinnedMesh::SJoint* a = keys->getAllJoints()[j];
+			const scene::ISkinnedMesh::SJoint* b = baked->getAllJoints()[j];
+			const f32 tolerance = 0.001f * (1.f + a->Animatedposition.getLength());
+			// the keys are not normalized after interpolating
+			core::quaternion rotation = a->Animatedrotation;
+			rotation.normalize();
+			if (!a->Animatedposition.equals(b->Animatedposition, tolerance) ||
+				!a->Animatedscale.equals(b->Animatedscale, 0.001f) ||
+				core::abs_(rotation.dotProduct(b->Animatedrotation)) < 0.9999f)
+			{
+				if (!errors)
+				{
+					logTestString("%s joint %d differs at frame %f: position %f,%f,%f instead of %f,%f,%f\n", filename.c_str(), j, frame,
+						b->Animatedposition.X, b->Animatedposition.Y, b->Animatedposition.Z,
+						a->Animatedposition.X, a->Animatedposition.Y, a->Animatedposition.Z);
+				}
+				++errors;
+			}
+		}
+	}
+	if (errors)
+	{
+		logTestString("%s has %d joint differences after baking.\n", filename.c_str(), errors);
+		result = false;
+	}
+
+	const u32 keyTime = seekFrames(device->getTimer(), keys, 20000);
+	const u32 bakedTime = seekFrames(device->getTimer(), baked, 20000);
+	logTestString("Seeking 20000 frames of %s took %d ms with keys and %d ms baked.\n", filename.c_str(), keyTime, bakedTime);
+
+	// the animation of another mesh replaces the baked one
+	baked->useAnimationFrom(keys);
+	if (baked->isAnimationBaked())
+	{
+		logTestString("%s is still baked after useAnimationFrom.\n", filename.c_str());
+		result = false;
+	}
+
+	keys->drop();
+	baked->drop();
+	return result;
+}
+
+bool hasKeys(const scene::ISkinnedMesh* mesh)
+{
+	for (u32 i=0; i<mesh->getJointCount(); ++i)
+	{
+		const scene::ISkinnedMesh::SJoint* joint = mesh->getAllJoints()[i];
+		if (joint->PositionKeys.size() || joint->ScaleKeys.size() || joint->RotationKeys.size())
+			return true;
+	}
+	return false;
+}
+
+//! The keys of a mesh are not baked away while another mesh uses them
+bool bakeSharedAnimation(IrrlichtDevice* device, const io::path& filename)
+{
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::ISkinnedMesh* source = loadSkinnedMesh(smgr, filename);
+	scene::ISkinnedMesh* user = loadSkinnedMesh(smgr, filename);
+	if (!source || !user)
+	{
+		logTestString("Could not load %s.\n", filename.c_str());
+		if (source)
+			source->drop();
+		if (user)
+			user->drop();
+		return false;
+	}
+
+	bool result = true;
+	user->useAnimationFrom(source);
+	if (source->bakeAnimation() || !hasKeys(source))
+	{
+		logTestString("%s was baked while another mesh uses its animation.\n", filename.c_str());
+		result = false;
+	}
+
+	// without users it is baked, and can't be used by others anymore
+	user->useAnimationFrom(user);
+	if (!source->bakeAnimation())
+	{
+		logTestString("%s was not baked after the other mesh uses its own animation.\n", filename.c_str());
+		result = false;
+	}
+	if (user->useAnimationFrom(source))
+	{
+		logTestString("The baked animation of %s was used by another mesh.\n", filename.c_str());
+		result = false;
+	}
+	if (!hasKeys(user))
+	{
+		logTestString("The other mesh lost its keys.\n");
+		result = false;
+	}
+
+	source->drop();
+	user->drop();
+	return result;
+}
+}
+
+// baked animations are sampled in constant time and look like the keys
+bool skinnedMeshBaking()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return true;
+
+	bool result = compareBaked(device, "../media/ninja.b3d");
+	result &= compareBaked(device, "../media/dwarf.x");
+	result &= bakeSharedAnimation(device, "../media/ninja.b3d");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,244 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+typedef scene::ISkinnedMesh::SAnimationLayer SLayer;
+
+//! Stores the animated transformation of all joints
+struct SPose
+{
+	core::array<core::vector3df> Positions;
+	core::array<core::quaternion> Rotations;
+};
+
+SPose getPose(const scene::ISkinnedMesh* mesh)
+{
+	SPose pose;
+	for (u32 i=0; i<mesh->getJointCount(); ++i)
+	{
+		const scene::ISkinnedMesh::SJoint* joint = mesh->getAllJoints()[i];
+		pose.Positions.push_back(joint->Animatedposition);
+		core::quaternion rotation = joint->Animatedrotation;
+		rotation.normalize();
+		pose.Rotations.push_back(rotation);
+	}
+	return pose;
+}
+
+SPose getFramePose(scene::ISkinnedMesh* mesh, f32 frame)
+{
+	mesh->animateMesh(frame, 1.f);
+	return getPose(mesh);
+}
+
+//! Compares the joints, rotations only if requested since blended ones are not spherically interpolated
+bool comparePoses(const SPose& pose, const SPose& expected, bool rotations, const char* name)
+{
+	u32 errors = 0;
+	for (u32 i=0; i<pose.Positions.size(); ++i)
+	{
+		if (!pose.Positions[i].equals(expected.Positions[i], 0.001f * (1.f + expected.Positions[i].getLength())) ||
+			(rotations && core::abs_(pose.Rotations[i].dotProduct(expected.Rotations[i])) < 0.9999f))
+		{
+			if (!errors)
+			{
+				logTestString("%s: joint %d at %f,%f,%f instead of %f,%f,%f\n", name, i,
+					pose.Positions[i].X, pose.Positions[i].Y, pose.Positions[i].Z,
+					expected.Positions[i].X, expected.Positions[i].Y, expected.Positions[i].Z);
+			}
+			++errors;
+		}
+	}
+	if (errors)
+		logTestString("%s: %d joints differ\n", name, errors);
+	return errors == 0;
+}
+
+bool blendLayers(ITimer* timer, scene::ISkinnedMesh* mesh)
+{
+	const f32 a = 10.f;
+	const f32 b = 30.f;
+	const SPose poseA = getFramePose(mesh, a);
+	const SPose poseB = getFramePose(mesh, b);
+
+	// a single layer is the frame
+	SLayer layers[3];
+	layers[0] = SLayer(a, 0.5f);
+	mesh->animateMeshLayers(layers, 1);
+	bool result = comparePoses(getPose(mesh), poseA, true, "Single layer");
+
+	// positions are blended by the normalized weights
+	layers[0] = SLayer(a, 0.25f);
+	layers[1] = SLayer(b, 0.75f);
+	mesh->animateMeshLayers(layers, 2);
+	SPose expected = poseA;
+	for (u32 i=0; i<expected.Positions.size(); ++i)
+		expected.Positions[i] = poseA.Positions[i] * 0.25f + poseB.Positions[i] * 0.75f;
+	result &= comparePoses(getPose(mesh), expected, false, "Two layers");
+
+	// masked joints only get the first layer
+	core::array<f32> mask;
+	for (u32 i=0; i<mesh->getJointCount(); ++i)
+		mask.push_back(i % 2 ? 1.f : 0.f);
+	layers[1].JointWeights = mask.const_pointer();
+	mesh->animateMeshLayers(layers, 2);
+	const SPose masked = getPose(mesh);
+	SPose expectedMasked;
+	SPose maskedPose;
+	for (u32 i=0; i<mask.size(); ++i)
+	{
+		if (mask[i] != 0.f)
+			continue;
+		expectedMasked.Positions.push_back(poseA.Positions[i]);
+		expectedMasked.Rotations.push_back(poseA.Rotations[i]);
+		maskedPose.Positions.push_back(masked.Positions[i]);
+		maskedPose.Rotations.push_back(masked.Rotations[i]);
+	}
+	result &= comparePoses(maskedPose, expectedMasked, true, "Masked joints");
+
+	// an additive layer on its own reference changes nothing
+	layers[0] = SLayer(a, 1.f);
+	layers[1] = SLayer(b, 1.f);
+	layers[1].Additive = true;
+	layers[1].ReferenceFrame = b;
+	mesh->animateMeshLayers(layers, 2);
+	result &= comparePoses(getPose(mesh), poseA, true, "Additive layer without difference");
+
+	// adding the difference from a to b onto a gives b
+	layers[1].ReferenceFrame = a;
+	mesh->animateMeshLayers(layers, 2);
+	result &= comparePoses(getPose(mesh), poseB, true, "Additive layer");
+
+	// the difference of other frames is added to the rotation in the joint space
+	const f32 c = b + 12.f;
+	const SPose poseC = getFramePose(mesh, c);
+	layers[1].Frame = c;
+	layers[1].ReferenceFrame = b;
+	mesh->animateMeshLayers(layers, 2);
+	for (u32 i=0; i<expected.Positions.size(); ++i)
+	{
+		expected.Positions[i] = poseA.Positions[i] + poseC.Positions[i] - poseB.Positions[i];
+		core::quaternion inverse = poseB.Rotations[i];
+		inverse.makeInverse();
+		expected.Rotations[i] = poseA.Rotations[i] * (inverse * poseC.Rotations[i]);
+	}
+	result &= comparePoses(getPose(mesh), expected, true, "Additive layer of other frames");
+
+	// half of the difference
+	layers[1].Frame = b;
+	layers[1].ReferenceFrame = a;
+	layers[1].Weight = 0.5f;
+	mesh->animateMeshLayers(layers, 2);
+	for (u32 i=0; i<expected.Positions.size(); ++i)
+		expected.Positions[i] = (poseA.Positions[i] + poseB.Positions[i]) * 0.5f;
+	result &= comparePoses(getPose(mesh), expected, false, "Half additive layer");
+
+	// animateMesh works again afterwards
+	mesh->animateMesh(b, 1.f);
+	result &= comparePoses(getPose(mesh), poseB, true, "Frame after layers");
+
+	// lower body, upper body and an additive layer
+	core::array<f32> inverseMask;
+	for (u32 i=0; i<mask.size(); ++i)
+		inverseMask.push_back(1.f - mask[i]);
+	layers[0] = SLayer(a, 1.f);
+	layers[0].JointWeights = inverseMask.const_pointer();
+	layers[1] = SLayer(b, 1.f);
+	layers[1].JointWeights = mask.const_pointer();
+	layers[2] = SLayer(b + 5.f, 0.3f);
+	layers[2].Additive = true;
+	layers[2].ReferenceFrame = b;
+
+	const u32 time = timer->getRealTime();
+	for (u32 i=0; i<2000; ++i)
+	{
+		layers[0].Frame = a + (i % 20);
+		layers[1].Frame = b + (i % 20);
+		mesh->animateMeshLayers(layers, 3);
+	}
+	logTestString("Blending 2000 times 3 layers of %d joints took %d ms\n", mesh->getJointCount(), timer->getRealTime() - time);
+
+	return result;
+}
+//! Joints of the ninja only turn around one axis each, so this one turns around all of them
+bool addTurningJoint(scene::ISceneManager* smgr)
+{
+	scene::ISkinnedMesh* mesh = smgr->createSkinnedMesh();
+	scene::ISkinnedMesh::SJoint* joint = mesh->addJoint();
+	joint->Name = "joint";
+	const core::vector3df angles[3] = { core::vector3df(50.f, 0.f, 0.f), core::vector3df(0.f, 70.f, 0.f), core::vector3df(30.f, 0.f, 40.f) };
+	for (u32 k=0; k<3; ++k)
+	{
+		scene::ISkinnedMesh::SRotationKey* key = mesh->addRotationKey(joint);
+		key->frame = k * 10.f;
+		key->rotation.set(angles[k] * core::DEGTORAD);
+		scene::ISkinnedMesh::SPositionKey* positionKey = mesh->addPositionKey(joint);
+		positionKey->frame = k * 10.f;
+		positionKey->position.set(k * 3.f, 0.f, -(f32)k);
+	}
+	mesh->finalize();
+
+	const SPose poses[3] = { getFramePose(mesh, 0.f), getFramePose(mesh, 10.f), getFramePose(mesh, 20.f) };
+	SLayer layers[2];
+	layers[0] = SLayer(20.f);
+	layers[1] = SLayer(10.f);
+	layers[1].Additive = true;
+	mesh->animateMeshLayers(layers, 2);
+
+	SPose expected = poses[2];
+	core::quaternion inverse = poses[0].Rotations[0];
+	inverse.makeInverse();
+	expected.Rotations[0] = poses[2].Rotations[0] * (inverse * poses[1].Rotations[0]);
+	expected.Positions[0] = poses[2].Positions[0] + poses[1].Positions[0] - poses[0].Positions[0];
+	const bool result = comparePoses(getPose(mesh), expected, true, "Additive layer turning around all axes");
+
+	mesh->drop();
+	return result;
+}
+}
+
+// skinned meshes blend layers of animation with weights, joint masks and additive layers
+bool skinnedMeshBlending()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return true;
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	scene::IAnimatedMesh* mesh = smgr->getMesh("../media/ninja.b3d");
+	if (!mesh || mesh->getMeshType() != scene::EAMT_SKINNED)
+	{
+		logTestString("Could not load ninja.\n");
+		device->closeDevice();
+		device->run();
+		device->drop();
+		return false;
+	}
+	scene::ISkinnedMesh* skinnedMesh = static_cast<scene::ISkinnedMesh*>(mesh);
+
+	bool result = blendLayers(device->getTimer(), skinnedMesh);
+
+	// the same with baked samples
+	skinnedMesh->bakeAnimation();
+	result &= blendLayers(device->getTimer(), skinnedMesh);
+
+	result &= addTurningJoint(smgr);
+
+	// scene nodes animate the mesh with their layers
+	const SPose pose = getFramePose(skinnedMesh, 42.f);
+	skinnedMesh->animateMesh(0.f, 1.f);
+	scene::IAnimatedMeshSceneNode* node = smgr->addAnimatedMeshSceneNode(mesh);
+	core::array<SLayer> layers;
+	layers.push_back(SLayer(42.f));
+	node->setAnimationLayers(layers);
+	node->OnAnimate(100);
+	result &= comparePoses(getPose(skinnedMesh), pose, true, "Scene node with layers");
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -0,0 +1,133 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+//! Node which remembers if it passed culling when it registered
+class COcclusionTestNode : public scene::ISceneNode
+{
+public:
+	COcclusionTestNode(scene::ISceneManager* smgr, const core::vector3df& position, f32 size)
+		: ISceneNode(smgr->getRootSceneNode(), smgr, -1, position),
+		Box(-size, -size, -size, size, size, size), Registered(false)
+	{
+		setAutomaticCulling(scene::EAC_FRUSTUM_BOX | scene::EAC_OCC_SOFTWARE);
+	}
+
+	virtual void OnRegisterSceneNode()
+	{
+		Registered = false;
+		if (IsVisible)
+			Registered = SceneManager->registerNodeForRendering(this) != 0;
+		ISceneNode::OnRegisterSceneNode();
+	}
+
+	virtual void render() {}
+
+	virtual const core::aabbox3df& getBoundingBox() const
+	{
+		return Box;
+	}
+
+	core::aabbox3df Box;
+	bool Registered;
+};
+
+COcclusionTestNode* addTestNode(scene::ISceneManager* smgr, const core::vector3df& position, f32 size)
+{
+	COcclusionTestNode* node = new COcclusionTestNode(smgr, position, size);
+	node->drop();
+	return node;
+}
+
+bool checkRegistered(COcclusionTestNode* node, bool expected, const c8* name)
+{
+	if (node->Registered != expected)
+	{
+		logTestString("Node '%s' was %s\n", name, expected ? "culled" : "not culled");
+		return false;
+	}
+	return true;
+}
+}
+
+// nodes behind an occluder wall are culled, others not
+bool softwareOcclusionCulling()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_NULL, core::dimension2du(160, 120));
+	if (!device)
+		return true; // could not create selected driver.
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 0.f, -50.f), core::vector3df(0.f, 0.f, 0.f));
+
+	// wall of 40x40 units in the xy plane
+	scene::IMeshSceneNode* wall = smgr->addCubeSceneNode(1.f, 0, -1, core::vector3df(0.f, 0.f, 0.f),
+		core::vector3df(0.f, 0.f, 0.f), core::vector3df(40.f, 40.f, 1.f));
+	wall->setAutomaticCulling(scene::EAC_FRUSTUM_BOX | scene::EAC_OCC_SOFTWARE);
+	smgr->addOccluder(wall);
+
+	COcclusionTestNode* hidden = addTestNode(smgr, core::vector3df(0.f, 0.f, 50.f), 1.f);
+	COcclusionTestNode* hiddenAside = addTestNode(smgr, core::vector3df(30.f, -20.f, 50.f), 1.f);
+	COcclusionTestNode* inFront = addTestNode(smgr, core::vector3df(0.f, 0.f, -20.f), 1.f);
+	COcclusionTestNode* besideWall = addTestNode(smgr, core::vector3df(45.f, 0.f, 50.f), 1.f);
+	COcclusionTestNode* largerThanWall = addTestNode(smgr, core::vector3df(0.f, 0.f, 60.f), 45.f);
+	COcclusionTestNode* aroundCamera = addTestNode(smgr, core::vector3df(0.f, 0.f, -50.f), 5.f);
+	COcclusionTestNode* touchingWall = addTestNode(smgr, core::vector3df(0.f, 0.f, -1.f), 1.f);
+	// same box as the occluder, which must not hide itself
+	COcclusionTestNode* sameAsWall = addTestNode(smgr, core::vector3df(0.f, 0.f, 0.f), 1.f);
+	sameAsWall->Box = wall->getTransformedBoundingBox();
+
+	bool result = true;
+
+	smgr->drawAll();
+	result &= checkRegistered(hidden, false, "hidden");
+	result &= checkRegistered(hiddenAside, false, "hiddenAside");
+	result &= checkRegistered(inFront, true, "inFront");
+	result &= checkRegistered(besideWall, true, "besideWall");
+	result &= checkRegistered(largerThanWall, true, "largerThanWall");
+	result &= checkRegistered(aroundCamera, true, "aroundCamera");
+	result &= checkRegistered(touchingWall, true, "touchingWall");
+	result &= checkRegistered(sameAsWall, true, "sameAsWall");
+
+	// invisible occluders hide nothing
+	wall->setVisible(false);
+	smgr->drawAll();
+	result &= checkRegistered(hidden, true, "hidden, wall invisible");
+	wall->setVisible(true);
+
+	smgr->drawAll();
+	result &= checkRegistered(hidden, false, "hidden, wall visible again");
+
+	// the camera moved beside the wall
+	smgr->getActiveCamera()->setPosition(core::vector3df(80.f, 0.f, -50.f));
+	smgr->drawAll();
+	result &= checkRegistered(hidden, true, "hidden, camera moved");
+	smgr->getActiveCamera()->setPosition(core::vector3df(0.f, 0.f, -50.f));
+
+	smgr->removeOccluder(wall);
+	smgr->drawAll();
+	result &= checkRegistered(hidden, true, "hidden, occluder removed");
+
+	// occluders taken out of the scene hide nothing and are released
+	wall->grab();
+	smgr->addOccluder(wall);
+	smgr->drawAll();
+	result &= checkRegistered(hidden, false, "hidden, occluder added again");
+	wall->remove();
+	smgr->drawAll();
+	result &= checkRegistered(hidden, true, "hidden, occluder node removed");
+	if (wall->getReferenceCount() != 1)
+	{
+		logTestString("Removed occluder node is still referenced %d times\n", wall->getReferenceCount() - 1);
+		result = false;
+	}
+	wall->drop();
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}
@@ -148,6 +148,64 @@ bool attributeValues(irr::io::IFileSystem * fs)
 	return result;
 }
 
+// Strings are terminated inside the text, so they have to stay valid
+// while reading on and text must not swallow the following tag.
+bool inSituParsing(irr::io::IFileSystem * fs)
+{
+	const c8 xml[] = "<root a=\"x&amp;b\" b = '&lt;&gt;'>text&amp;more<child f=\"1.5\" i=\"-42\"/>tail</root>";
+	io::IReadFile* file = fs->createMemoryReadFile(xml, sizeof(xml)-1, "insitu.xml");
+	io::IXMLReaderUTF8* reader = fs->createXMLReaderUTF8(file);
+	file->seek(0);
+	io::IXMLReader* wreader = fs->createXMLReader(file);
+	file->drop();
+	if (!reader || !wreader)
+	{
+		logTestString("Could not create XML reader.\n");
+		return false;
+	}
+
+	bool result = reader->read() && reader->getNodeType() == io::EXN_ELEMENT;
+	const c8* rootName = reader->getNodeName();
+	const c8* valueA = reader->getAttributeValue("a");
+	const c8* valueB = reader->getAttributeValue("b");
+	result &= reader->read() && reader->getNodeType() == io::EXN_TEXT;
+	const c8* text = reader->getNodeData();
+	result &= reader->read() && reader->getNodeType() == io::EXN_ELEMENT && reader->isEmptyElement();
+	result &= core::stringc("child") == reader->getNodeName();
+	result &= core::equals(reader->getAttributeValueAsFloat("f"), 1.5f);
+	result &= reader->getAttributeValueAsInt("i") == -42;
+	result &= reader->getAttributeValue("missing") == 0;
+	result &= reader->read() && reader->getNodeType() == io::EXN_TEXT && core::stringc("tail") == reader->getNodeData();
+	result &= reader->read() && reader->getNodeType() == io::EXN_ELEMENT_END && core::stringc("root") == reader->getNodeName();
+	result &= !reader->read();
+
+	result &= core::stringc("root") == rootName;
+	result &= core::stringc("x&b") == valueA;
+	result &= core::stringc("<>") == valueB;
+	result &= core::stringc("text&more") == text;
+	if (!result)
+		logTestString("in-situ parsing of UTF-8 xml failed in %s:%d\n", __FILE__, __LINE__);
+
+	bool wresult = true;
+	while (wreader->read())
+	{
+		if (wreader->getNodeType() == io::EXN_ELEMENT && core::stringw(L"child") == wreader->getNodeName())
+		{
+			wresult &= core::equals(wreader->getAttributeValueAsFloat(L"f"), 1.5f);
+			wresult &= wreader->getAttributeValueAsInt(0) == 1;
+			wresult &= wreader->getAttributeValueAsInt(1) == -42;
+		}
+		else if (wreader->getNodeType() == io::EXN_TEXT)
+			wresult &= core::stringw(L"text&more") == wreader->getNodeData() || core::stringw(L"tail") == wreader->getNodeData();
+	}
+	if (!wresult)
+		logTestString("in-situ parsing of wide character xml failed in %s:%d\n", __FILE__, __LINE__);
+
+	reader->drop();
+	wreader->drop();
+	return result && wresult;
+}
+
 /** Tests for XML handling */
 bool testXML(void)
 {
@@ -161,6 +219,8 @@ bool testXML(void)
 	result &= cdata(device->getFileSystem());
 	logTestString("Test XML reader attribute support.\n");
 	result &= attributeValues(device->getFileSystem());	
+	logTestString("Test XML reader in-situ parsing.\n");
+	result &= inSituParsing(device->getFileSystem());
 
 	device->closeDevice();
 	device->run();
@@ -0,0 +1,129 @@
+#include "testUtils.h"
+
+using namespace irr;
+
+namespace
+{
+const f32 WAVE_HEIGHT = 2.f;
+const f32 WAVE_SPEED = 300.f;
+const f32 WAVE_LENGTH = 10.f;
+
+void drawFrame(IrrlichtDevice* device, u32 time)
+{
+	device->getTimer()->setTime(time);
+	device->getVideoDriver()->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 0, 0, 0));
+	device->getSceneManager()->drawAll();
+	device->getVideoDriver()->endScene();
+}
+
+//! Compares the vertices with the wave at the time, and the normals with the ones of the triangles
+bool checkWave(scene::ISceneManager* smgr, scene::IMesh* original, scene::IMesh* water, u32 timeMs, const char* name)
+{
+	scene::IMesh* recalculated = smgr->getMeshManipulator()->createMeshCopy(water);
+	smgr->getMeshManipulator()->recalculateNormals(recalculated, true);
+
+	const f32 time = timeMs / WAVE_SPEED;
+	u32 positionErrors = 0;
+	u32 normalErrors = 0;
+	f32 maxY = -FLT_MAX;
+	for (u32 b=0; b<water->getMeshBufferCount(); ++b)
+	{
+		const scene::IMeshBuffer* source = original->getMeshBuffer(b);
+		const scene::IMeshBuffer* buffer = water->getMeshBuffer(b);
+		for (u32 i=0; i<buffer->getVertexCount(); ++i)
+		{
+			const core::vector3df& pos = source->getPosition(i);
+			const f32 y = pos.Y + sinf(pos.X / WAVE_LENGTH + time) * WAVE_HEIGHT +
+				cosf(pos.Z / WAVE_LENGTH + time) * WAVE_HEIGHT;
+			if (!core::equals(buffer->getPosition(i).Y, y, 0.0005f))
+			{
+				if (!positionErrors)
+					logTestString("%s: vertex %d at height %f instead of %f\n", name, i, buffer->getPosition(i).Y, y);
+				++positionErrors;
+			}
+			maxY = core::max_(maxY, buffer->getPosition(i).Y);
+
+			// the triangles only approximate the normals, and at the border of the plane not even that
+			const core::vector3df& normal = buffer->getNormal(i);
+			const bool border = core::abs_(pos.X) > 38.f || core::abs_(pos.Z) > 38.f;
+			if (!core::equals(normal.getLength(), 1.f, 0.0001f) ||
+				(!border && normal.dotProduct(recalculated->getMeshBuffer(b)->getNormal(i)) < 0.999f))
+			{
+				if (!normalErrors)
+					logTestString("%s: vertex %d has normal %f,%f,%f\n", name, i, normal.X, normal.Y, normal.Z);
+				++normalErrors;
+			}
+		}
+	}
+	recalculated->drop();
+
+	if (maxY > water->getBoundingBox().MaxEdge.Y)
+	{
+		logTestString("%s: vertices up to %f, bounding box only to %f\n", name, maxY, water->getBoundingBox().MaxEdge.Y);
+		++positionErrors;
+	}
+	if (positionErrors || normalErrors)
+		logTestString("%s: %d wrong positions, %d wrong normals\n", name, positionErrors, normalErrors);
+	return positionErrors == 0 && normalErrors == 0;
+}
+}
+
+// water surfaces move their vertices to the waves only when they are drawn
+bool waterSurface()
+{
+	SIrrlichtCreationParameters params;
+	params.DeviceType = EIDT_OFFSCREEN;
+	params.DriverType = video::EDT_BURNINGSVIDEO;
+	params.WindowSize = core::dimension2du(160, 120);
+	IrrlichtDevice* device = createDeviceEx(params);
+	if (!device)
+		return true; // could not create selected driver.
+
+	scene::ISceneManager* smgr = device->getSceneManager();
+	device->getTimer()->stop();
+
+	// odd vertex count, so some vertices are left after the groups of four
+	scene::IMesh* mesh = smgr->addHillPlaneMesh("water", core::dimension2df(2.f, 2.f), core::dimension2du(40, 40))->getMesh(0);
+	scene::IMeshSceneNode* node = (scene::IMeshSceneNode*)smgr->addWaterSurfaceSceneNode(mesh, WAVE_HEIGHT, WAVE_SPEED, WAVE_LENGTH);
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0, core::vector3df(0.f, 30.f, -50.f), core::vector3df(0.f, 0.f, 0.f));
+
+	drawFrame(device, 1000);
+	bool result = checkWave(smgr, mesh, node->getMesh(), 1000, "Visible surface");
+
+	// a culled surface keeps its vertices
+	camera->setTarget(core::vector3df(0.f, 30.f, -100.f));
+	drawFrame(device, 5000);
+	result &= checkWave(smgr, mesh, node->getMesh(), 1000, "Culled surface");
+
+	// and is at the current wave when it is seen again
+	camera->setTarget(core::vector3df(0.f, 0.f, 0.f));
+	drawFrame(device, 7000);
+	result &= checkWave(smgr, mesh, node->getMesh(), 7000, "Surface seen again");
+
+	// a large surface, animated with and without being culled
+	node->setMesh(smgr->addHillPlaneMesh("large water", core::dimension2df(0.5f, 0.5f), core::dimension2du(255, 255))->getMesh(0));
+	const u32 vertexCount = node->getMesh()->getMeshBuffer(0)->getVertexCount();
+	ITimer* timer = device->getTimer();
+	u32 start = timer->getRealTime();
+	for (u32 i=0; i<100; ++i)
+		drawFrame(device, 8000 + i * 16);
+	logTestString("Drawing %d water vertices 100 times took %d ms\n", vertexCount, timer->getRealTime() - start);
+
+	camera->setPosition(core::vector3df(0.f, 30.f, -100.f));
+	camera->setTarget(core::vector3df(0.f, 30.f, -200.f));
+	start = timer->getRealTime();
+	for (u32 i=0; i<100; ++i)
+		drawFrame(device, 10000 + i * 16);
+	logTestString("Culling %d water vertices 100 times took %d ms\n", vertexCount, timer->getRealTime() - start);
+
+	start = timer->getRealTime();
+	for (u32 i=0; i<100; ++i)
+		smgr->getMeshManipulator()->recalculateNormals(node->getMesh());
+	logTestString("Recalculating the normals of %d water vertices 100 times took %d ms\n", vertexCount, timer->getRealTime() - start);
+
+	device->closeDevice();
+	device->run();
+	device->drop();
+
+	return result;
+}